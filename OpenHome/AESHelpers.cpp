@@ -2,7 +2,7 @@
 #include <OpenHome/AESHelpers.h>
 #include <OpenHome/Private/Converter.h>
 
-#include "openssl/aes.h"
+#include "openssl/evp.h"
 
 using namespace OpenHome;
 
@@ -44,15 +44,17 @@ TBool AESHelpers::Decrypt(unsigned char* aAesKeyData,
                           const Brx& aEncrypted,
                           Bwx& aDecrypted)
 {
-    AES_KEY aesKey;
-    AES_set_decrypt_key(aAesKeyData, 128, &aesKey);
+    if (aEncrypted.Bytes() > aDecrypted.MaxBytes())
+    {
+        Log::Print("AESHelpers::Decrypt - %u byte(s) of output space needed, only %u available.\n", aEncrypted.Bytes(), aDecrypted.MaxBytes());
+        return false;
+    }
 
-    AES_cbc_encrypt(aEncrypted.Ptr(),
-                    (unsigned char*)aDecrypted.PtrZ(),
-                    aEncrypted.Bytes(),
-                    &aesKey,
-                    &aInitVec[0],
-                    AES_DECRYPT);
+    if (!Cbc(aAesKeyData, aInitVec, aEncrypted, (unsigned char*)aDecrypted.Ptr(), false))
+    {
+        Log::Print("AESHelpers::Decrypt - Failed to decrypt value.\n");
+        return false;
+    }
 
     aDecrypted.SetBytes(aEncrypted.Bytes());
     return true;
@@ -71,15 +73,17 @@ TBool AESHelpers::Encrypt(unsigned char* aAesKeyData,
         return false;
     }
 
-    AES_KEY aesKey;
-    AES_set_encrypt_key(&aAesKeyData[0], 128, &aesKey);
+    if (aValue.Bytes() > aEncryptedValue.MaxBytes())
+    {
+        Log::Print("AESHelpers::Encrypt - %u byte(s) of output space needed, only %u available.\n", aValue.Bytes(), aEncryptedValue.MaxBytes());
+        return false;
+    }
 
-    AES_cbc_encrypt(aValue.Ptr(),
-                    (unsigned char*)aEncryptedValue.PtrZ(),
-                    aValue.Bytes(),
-                    &aesKey,
-                    &aInitVec[0],
-                    AES_ENCRYPT);
+    if (!Cbc(aAesKeyData, aInitVec, aValue, (unsigned char*)aEncryptedValue.Ptr(), true))
+    {
+        Log::Print("AESHelpers::Encrypt - Failed to encrypt value.\n");
+        return false;
+    }
 
     aEncryptedValue.SetBytes(aValue.Bytes());
 
@@ -98,6 +102,35 @@ TBool AESHelpers::Encrypt(unsigned char* aAesKeyData,
 
 
 
+TBool AESHelpers::Cbc(unsigned char* aAesKeyData,
+                      unsigned char* aInitVec,
+                      const Brx& aIn,
+                      unsigned char* aOut,
+                      TBool aEncrypt)
+{
+    // Uses the EVP interface so that any hardware support for AES is used.
+    // Values are padded by the caller (if at all) so padding is disabled here.
+    if (aIn.Bytes() % kBlockSizeInBytes != 0)
+    {
+        return false;
+    }
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (ctx == nullptr)
+    {
+        return false;
+    }
+
+    int outLen = 0;
+    TBool ok = EVP_CipherInit_ex(ctx, EVP_aes_128_cbc(), nullptr, aAesKeyData, aInitVec, aEncrypt? 1 : 0) == 1
+            && EVP_CIPHER_CTX_set_padding(ctx, 0) == 1
+            && EVP_CipherUpdate(ctx, aOut, &outLen, aIn.Ptr(), (int)aIn.Bytes()) == 1
+            && outLen == (int)aIn.Bytes();
+
+    EVP_CIPHER_CTX_free(ctx);
+    return ok;
+}
+
 TBool AESHelpers::PKCSPad(Bwx& aValue)
 {
     /* AES Encryption requires values to be padded into 8 byte blocks.
@@ -107,12 +140,12 @@ TBool AESHelpers::PKCSPad(Bwx& aValue)
      * NOTE: RFC defines PKCS#5. PKCS#7 has been later defined to work
      *       on inputs over 256bytes in length. */
     const TUint currentLength = aValue.Bytes();
-    TUint paddingRequired = AES_BLOCK_SIZE - (currentLength % AES_BLOCK_SIZE);
+    TUint paddingRequired = kBlockSizeInBytes - (currentLength % kBlockSizeInBytes);
 
-    // If we're already aligned to AES_BLOCK_SIZE we need to append a full block
+    // If we're already aligned to kBlockSizeInBytes we need to append a full block
     if (paddingRequired == 0)
     {
-        paddingRequired = AES_BLOCK_SIZE;
+        paddingRequired = kBlockSizeInBytes;
     }
 
     // PKCS requires you to set any padding bytes to the number
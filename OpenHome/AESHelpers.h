@@ -10,6 +10,7 @@ class AESHelpers
 {
     public:
         static const TInt kKeySizeInBytes = 16; //Means we use AES128. Other options: AES256 & AES512 are available
+        static const TUint kBlockSizeInBytes = 16;
 
         // Decrypt a value using provided AESKeys
         static TBool Decrypt(unsigned char* aAesKeyData,
@@ -25,7 +26,7 @@ class AESHelpers
                                                     Bwx& aDecrypted);
 
         /* Encrypt a value using provided AESKeys
-         * Encrypted value must be provided in a writable buffer (with at least AES_BLOCK_SIZE
+         * Encrypted value must be provided in a writable buffer (with at least kBlockSizeInBytes
          * space available) as value may need to be padded prior to encryption) */
         static TBool Encrypt(unsigned char* aAesKeyData,
                              unsigned char* aInitVec,
@@ -33,6 +34,11 @@ class AESHelpers
                              Bwx& aEncryptedValue);
 
     private:
+        static TBool Cbc(unsigned char* aAesKeyData,
+                         unsigned char* aInitVec,
+                         const Brx& aIn,
+                         unsigned char* aOut,
+                         TBool aEncrypt);
         static TBool PKCSPad(Bwx& aValue);
 };
 
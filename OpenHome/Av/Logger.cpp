@@ -110,6 +110,11 @@ RingBufferLogger& LoggerBuffered::LogBuffer()
     return *iLoggerRingBuffer;
 }
 
+void LoggerBuffered::SetSongcastResendReporter(ISongcastResendReporter& aReporter)
+{
+    iProviderDebug->SetSongcastResendReporter(aReporter);
+}
+
 void LoggerBuffered::HandleShellCommand(Brn /*aCommand*/, const std::vector<Brn>& aArgs, IWriter& aResponse)
 {
     if (aArgs.size() != 1) {
@@ -58,6 +58,7 @@ private:
 
 class Product;
 class ProviderDebug;
+class ISongcastResendReporter;
 
 class LoggerBuffered : private IShellCommandHandler
 {
@@ -68,6 +69,7 @@ public:
     ~LoggerBuffered();
     ILoggerSerial& LoggerSerial();
     RingBufferLogger& LogBuffer();
+    void SetSongcastResendReporter(ISongcastResendReporter& aReporter);
 private: // from IShellCommandHandler
     void HandleShellCommand(Brn aCommand, const std::vector<Brn>& aArgs, IWriter& aResponse) override;
     void DisplayHelp(IWriter& aResponse) override;
@@ -180,6 +180,7 @@ MediaPlayer::MediaPlayer(Net::DvStack& aDvStack, Net::CpStack& aCpStack, Net::Dv
     , iTransportPins(nullptr)
     , iDeviceAnnouncerMdns(nullptr)
     , iRadioPresets(nullptr)
+    , iSongcastResendReporter(nullptr)
     , iProviderReaction(nullptr)
 {
     iUnixTimestamp = new OpenHome::UnixTimestamp(iDvStack.Env());
@@ -350,6 +351,9 @@ void MediaPlayer::AddAttribute(const TChar* aAttribute)
 ILoggerSerial& MediaPlayer::BufferLogOutput(TUint aBytes, IShell& aShell, Optional<ILogPoster> aLogPoster)
 {
     iLoggerBuffered = new LoggerBuffered(aBytes, iDevice, *iProduct, aShell, aLogPoster);
+    if (iSongcastResendReporter != nullptr) {
+        iLoggerBuffered->SetSongcastResendReporter(*iSongcastResendReporter);
+    }
     return iLoggerBuffered->LoggerSerial();
 }
 
@@ -534,3 +538,12 @@ void MediaPlayer::SetRadioPresets(IRadioPresets& aPresets)
 {
     iRadioPresets = &aPresets;
 }
+
+void MediaPlayer::SetSongcastResendReporter(ISongcastResendReporter& aReporter)
+{
+    // BufferLogOutput may be called before or after the Songcast sender is created
+    iSongcastResendReporter = &aReporter;
+    if (iLoggerBuffered != nullptr) {
+        iLoggerBuffered->SetSongcastResendReporter(aReporter);
+    }
+}
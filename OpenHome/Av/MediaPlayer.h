@@ -76,6 +76,7 @@ class ProviderPins;
 class TransportPins;
 class DeviceAnnouncerMdns;
 class IRadioPresets;
+class ISongcastResendReporter;
 class ProviderReaction;
 class IReactionHandler;
 
@@ -121,6 +122,7 @@ public:
     virtual Optional<RingBufferLogger> LogBuffer() = 0;
     virtual Optional<IRadioPresets> RadioPresets() = 0;
     virtual void SetRadioPresets(IRadioPresets& aPresets) = 0; // internal use only
+    virtual void SetSongcastResendReporter(ISongcastResendReporter& aReporter) = 0; // internal use only
 };
 
 
@@ -218,6 +220,7 @@ public: // from IMediaPlayer
     Optional<RingBufferLogger> LogBuffer() override;
     Optional<IRadioPresets> RadioPresets() override;
     void SetRadioPresets(IRadioPresets& aPresets) override;
+    void SetSongcastResendReporter(ISongcastResendReporter& aReporter) override;
 private:
     Net::DvStack& iDvStack;
     Net::CpStack& iCpStack;
@@ -255,6 +258,7 @@ private:
     Av::TransportPins* iTransportPins;
     DeviceAnnouncerMdns* iDeviceAnnouncerMdns;
     IRadioPresets* iRadioPresets;
+    ISongcastResendReporter* iSongcastResendReporter;
     Av::ProviderReaction *iProviderReaction;
 };
 
@@ -281,31 +281,29 @@ PodcastPinsITunes::PodcastPinsITunes(Media::TrackFactory& aTrackFactory, Environ
         Log::Print("Store Key not found: %.*s\n", PBUF(kStoreKeyITunesPodcast));
     }
 
-    if (iListenedDates.Bytes() > 0) {
-        JsonParser parser;
-        auto parserItems = JsonParserArray::Create(iListenedDates);
-        try {
-            for (;;) {
-                parser.Parse(parserItems.NextObject());
-                Brn id = parser.String("id");
-                Brn date = parser.String("date");
-                TUint priority = parser.Num("pty");
-                if (id.Bytes() > 0 && date.Bytes() > 0) {
-                    // Value was found.
-                    if (mapCount >= kMaxEntries) {
-                        LOG(kMedia, "PodcastPinsITunes Loaded %u stored date mappings, but more values in store. Ignoring remaining values. iListenedDates:\n%.*s\n", mapCount, PBUF(iListenedDates));
-                        break;
-                    }
-                    else {
-                        ListenedDatePooled* m = new ListenedDatePooled();
-                        m->Set(id, date, priority);
-                        iMappings.push_back(m);
-                        mapCount++;
-                    }
+    if (iListenedDates.Bytes() > 0 && iListenedDates != WriterJson::kNull) { // an empty array is stored as null
+        JsonTape tape;
+        tape.Parse(iListenedDates);
+        JsonTapeIterator it = tape.Root().Iterate();
+        JsonTapeValue entry;
+        while (it.Next(entry) && !entry.IsNull()) {
+            Brn id = entry.String("id");
+            Brn date = entry.String("date");
+            TUint priority = entry.Num("pty");
+            if (id.Bytes() > 0 && date.Bytes() > 0) {
+                // Value was found.
+                if (mapCount >= kMaxEntries) {
+                    LOG(kMedia, "PodcastPinsITunes Loaded %u stored date mappings, but more values in store. Ignoring remaining values. iListenedDates:\n%.*s\n", mapCount, PBUF(iListenedDates));
+                    break;
+                }
+                else {
+                    ListenedDatePooled* m = new ListenedDatePooled();
+                    m->Set(id, date, priority);
+                    iMappings.push_back(m);
+                    mapCount++;
                 }
             }
         }
-        catch (JsonArrayEnumerationComplete&) {}
     }
 
     // If iMappings doesn't contain kMaxEntries from store, fill up with empty values
@@ -466,7 +464,7 @@ TBool PodcastPinsITunes::LoadByQuery(const Brx& aQuery, IPodcastTransportHandler
 TBool PodcastPinsITunes::LoadById(const Brx& aId, IPodcastTransportHandler& aHandler)
 {
     ITunesMetadata im(iTrackFactory);
-    JsonParser parser;
+    JsonTape tape;
     TBool isPlayable = false;
     Parser xmlParser;
     Brn date;
@@ -482,15 +480,19 @@ TBool PodcastPinsITunes::LoadById(const Brx& aId, IPodcastTransportHandler& aHan
             return false;
         }
 
-        parser.Reset();
-        parser.Parse(iJsonResponse.Buffer());
-        if (parser.HasKey(Brn("resultCount"))) { 
-            TUint results = parser.Num(Brn("resultCount"));
+        tape.Parse(iJsonResponse.Buffer());
+        const JsonTapeValue response = tape.Root();
+        if (response.HasKey(Brn("resultCount"))) { 
+            TUint results = response.Num(Brn("resultCount"));
             if (results == 0) {
                 return false;
             }
-            auto parserItems = JsonParserArray::Create(parser.String(Brn("results")));
-            podcast = new PodcastInfoITunes(parserItems.NextObject(), aId);
+            JsonTapeIterator items = response.Get(Brn("results")).Iterate();
+            JsonTapeValue item;
+            if (!items.Next(item) || item.IsNull()) {
+                THROW(JsonArrayEnumerationComplete);
+            }
+            podcast = new PodcastInfoITunes(item, aId);
 
             iXmlResponse.Reset();
             success = iITunes->TryGetPodcastEpisodeInfo(iXmlResponse, podcast->FeedUrl(), aHandler.SingleShot());
@@ -560,7 +562,7 @@ TBool PodcastPinsITunes::LoadById(const Brx& aId, IPodcastTransportHandler& aHan
 TBool PodcastPinsITunes::CheckForNewEpisodeById(const Brx& aId)
 {
     ITunesMetadata im(iTrackFactory);
-    JsonParser parser;
+    JsonTape tape;
     Parser xmlParser;
     PodcastInfoITunes* podcast = nullptr;
 
@@ -573,15 +575,19 @@ TBool PodcastPinsITunes::CheckForNewEpisodeById(const Brx& aId)
             return false;
         }
 
-        parser.Reset();
-        parser.Parse(iJsonResponse.Buffer());
-        if (parser.HasKey(Brn("resultCount"))) { 
-            TUint results = parser.Num(Brn("resultCount"));
+        tape.Parse(iJsonResponse.Buffer());
+        const JsonTapeValue response = tape.Root();
+        if (response.HasKey(Brn("resultCount"))) { 
+            TUint results = response.Num(Brn("resultCount"));
             if (results == 0) {
                 return false;
             }
-            auto parserItems = JsonParserArray::Create(parser.String(Brn("results")));
-            podcast = new PodcastInfoITunes(parserItems.NextObject(), aId);
+            JsonTapeIterator items = response.Get(Brn("results")).Iterate();
+            JsonTapeValue item;
+            if (!items.Next(item) || item.IsNull()) {
+                THROW(JsonArrayEnumerationComplete);
+            }
+            podcast = new PodcastInfoITunes(item, aId);
 
             iXmlResponse.Reset();
             success = iITunes->TryGetPodcastEpisodeInfo(iXmlResponse, podcast->FeedUrl(), true); // get latest episode info only
@@ -740,21 +746,26 @@ const Brx& ITunesMetadata::GetNextEpisodePublishedDate(const Brx& aXmlItem)
 Brn ITunesMetadata::FirstIdFromJson(const Brx& aJsonResponse)
 {
     try {
-        JsonParser parser;
-        parser.Parse(aJsonResponse);
-        if (parser.Num(Brn("resultCount")) == 0) {
+        JsonTape tape;
+        tape.Parse(aJsonResponse);
+        const JsonTapeValue response = tape.Root();
+        if (response.Num(Brn("resultCount")) == 0) {
             THROW(ITunesResponseInvalid);
         }
-        auto parserArray = JsonParserArray::Create(parser.String("results"));
-        if (parserArray.Type() == JsonParserArray::ValType::Null) {
+        JsonTapeValue results = response.Get("results");
+        if (results.IsNull()) {
             THROW(ITunesResponseInvalid);
         }
-        parser.Parse(parserArray.NextObject());
-        if (parser.HasKey(Brn("collectionId"))) {
-            return parser.String(Brn("collectionId"));
+        JsonTapeIterator it = results.Iterate();
+        JsonTapeValue result;
+        if (!it.Next(result) || result.IsNull()) {
+            THROW(JsonArrayEnumerationComplete);
         }
-        else if (parser.HasKey(Brn("trackId"))) {
-            return parser.String(Brn("trackId"));
+        if (result.HasKey(Brn("collectionId"))) {
+            return result.String(Brn("collectionId"));
+        }
+        else if (result.HasKey(Brn("trackId"))) {
+            return result.String(Brn("trackId"));
         }
     }
     catch (AssertionFailed&) {
@@ -1017,7 +1028,7 @@ void ITunes::WriteRequestHeaders(const Brx& aMethod, const Brx& aHost, const Brx
     iWriterRequest.WriteFlush();
 }
 
-PodcastInfoITunes::PodcastInfoITunes(const Brx& aJsonObj, const Brx& aId)
+PodcastInfoITunes::PodcastInfoITunes(const JsonTapeValue& aJsonObj, const Brx& aId)
     : iName(512)
     , iFeedUrl(1024)
     , iArtist(256)
@@ -1027,43 +1038,40 @@ PodcastInfoITunes::PodcastInfoITunes(const Brx& aJsonObj, const Brx& aId)
     Parse(aJsonObj);
 }
 
-void PodcastInfoITunes::Parse(const Brx& aJsonObj)
+void PodcastInfoITunes::Parse(const JsonTapeValue& aJsonObj)
 {
-    JsonParser parser;
-    parser.Parse(aJsonObj);
-
-    if (parser.HasKey("kind")) {
-        if (parser.String("kind") != ITunesMetadata::kMediaTypePodcast) {
+    if (aJsonObj.HasKey("kind")) {
+        if (aJsonObj.String("kind") != ITunesMetadata::kMediaTypePodcast) {
             THROW(ITunesResponseInvalid);
         }
     }
-    if (!parser.HasKey("feedUrl")) {
+    if (!aJsonObj.HasKey("feedUrl")) {
         THROW(ITunesResponseInvalid);
     }
 
     try {
-        iName.ReplaceThrow(parser.String("collectionName"));
+        iName.ReplaceThrow(aJsonObj.String("collectionName"));
     }
     catch (Exception&) {
         iName.ReplaceThrow(Brx::Empty());
     }
 
     try {
-        iFeedUrl.ReplaceThrow(parser.String("feedUrl"));
+        iFeedUrl.ReplaceThrow(aJsonObj.String("feedUrl"));
     }
     catch (Exception&) {
         iFeedUrl.ReplaceThrow(Brx::Empty());
     }
 
     try {
-        iArtist.ReplaceThrow(parser.String("artistName"));
+        iArtist.ReplaceThrow(aJsonObj.String("artistName"));
     }
     catch (Exception&) {
         iArtist.ReplaceThrow(Brx::Empty());
     }
 
     try {
-        iArtworkUrl.ReplaceThrow(parser.String("artworkUrl600"));
+        iArtworkUrl.ReplaceThrow(aJsonObj.String("artworkUrl600"));
     }
     catch (Exception&) {
         iArtworkUrl.ReplaceThrow(Brx::Empty());
@@ -23,7 +23,7 @@ namespace OpenHome {
     class Environment;
     class IThreadPool;
     class IThreadPoolHandle;
-    class JsonParser;
+    class JsonTapeValue;
     class Parser;
     class Timer;
 namespace Configuration {
@@ -39,7 +39,7 @@ namespace Av {
     class PodcastInfoITunes
     {
     public:
-        PodcastInfoITunes(const Brx& aJsonObj, const Brx& aId);
+        PodcastInfoITunes(const JsonTapeValue& aJsonObj, const Brx& aId);
         ~PodcastInfoITunes();
         const Brx& Name();
         const Brx& FeedUrl();
@@ -47,7 +47,7 @@ namespace Av {
         const Brx& ArtworkUrl();
         const Brx& Id();
     private:
-        void Parse(const Brx& aJsonObj);
+        void Parse(const JsonTapeValue& aJsonObj);
     private:
         Bwh iName;
         Bwh iFeedUrl;
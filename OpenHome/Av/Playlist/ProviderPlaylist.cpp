@@ -11,6 +11,7 @@
 #include <OpenHome/Private/Converter.h>
 #include <OpenHome/Private/Timer.h>
 #include <OpenHome/Media/Pipeline/Seeker.h>
+#include <OpenHome/Net/Private/XmlParser.h>
 
 #include <vector>
 
@@ -27,6 +28,17 @@ static const TUint kIndexNotFoundCode = 802;
 static const Brn kIndexNotFoundMsg("Index not found");
 static const TUint kSeekFailureCode = 803;
 static const Brn kSeekFailureMsg("Seek failed");
+static const TUint kTrackListInvalidCode = 804;
+static const Brn kTrackListInvalidMsg("Invalid track list");
+
+static Brn AppendXmlUnescaped(Bwx& aBuf, const Brx& aEscaped)
+{
+    Bwn value(aBuf.Ptr() + aBuf.Bytes(), 0, aBuf.MaxBytes() - aBuf.Bytes());
+    value.Replace(aEscaped);
+    Converter::FromXmlEscaped(value);
+    aBuf.SetBytes(aBuf.Bytes() + value.Bytes());
+    return Brn(value.Ptr(), value.Bytes());
+}
 
 // ProviderPlaylist
 
@@ -76,7 +88,9 @@ ProviderPlaylist::ProviderPlaylist(DvDevice& aDevice,
     EnableActionRead();
     EnableActionReadList();
     EnableActionInsert();
+    EnableActionInsertList();
     EnableActionDeleteId();
+    EnableActionDeleteList();
     EnableActionDeleteAll();
     EnableActionTracksMax();
     EnableActionIdArray();
@@ -121,6 +135,11 @@ void ProviderPlaylist::NotifyTrackInserted(Track& /*aTrack*/, TUint /*aIdBefore*
     TrackDatabaseChanged();
 }
 
+void ProviderPlaylist::NotifyTracksInserted(const std::vector<Track*>& /*aTracks*/, TUint /*aIdBefore*/, TUint /*aIdAfter*/)
+{
+    TrackDatabaseChanged();
+}
+
 void ProviderPlaylist::NotifyTrackDeleted(TUint /*aId*/, Track* aBefore, Track* aAfter)
 {
     /* Deleting one of many tracks in a playlist will result in a new track starting to play
@@ -132,6 +151,15 @@ void ProviderPlaylist::NotifyTrackDeleted(TUint /*aId*/, Track* aBefore, Track*
     TrackDatabaseChanged();
 }
 
+void ProviderPlaylist::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted)
+{
+    const TrackDbDeletion& last = aDeleted[aDeleted.size()-1];
+    if (last.iBefore == nullptr && last.iAfter == nullptr) {
+        NotifyTrack(ITrackDatabase::kTrackIdNone);
+    }
+    TrackDatabaseChanged();
+}
+
 void ProviderPlaylist::NotifyAllDeleted()
 {
     NotifyTrack(ITrackDatabase::kTrackIdNone);
@@ -388,6 +416,57 @@ void ProviderPlaylist::Insert(IDvInvocation& aInvocation, TUint aAfterId, const
     aInvocation.EndResponse();
 }
 
+void ProviderPlaylist::InsertList(IDvInvocation& aInvocation, TUint aAfterId, const Brx& aTrackList, IDvInvocationResponseString& aNewIdList)
+{
+    /* aTrackList uses the format ReadList returns, less the Id elements:
+       <TrackList><Entry><Uri>...</Uri><Metadata>...</Metadata></Entry>...</TrackList>
+       Uri and Metadata are xml escaped. */
+    Bwh values(aTrackList.Bytes()); // unescaped values are never longer than their escaped form
+    std::vector<TrackDbEntry> tracks;
+    try {
+        Brn entries = XmlParserBasic::Find("TrackList", aTrackList);
+        for (;;) {
+            Brn entry;
+            try {
+                entry.Set(XmlParserBasic::Find("Entry", entries, entries));
+            }
+            catch (XmlError&) {
+                break;
+            }
+            TrackDbEntry track;
+            track.iUri.Set(AppendXmlUnescaped(values, XmlParserBasic::Find("Uri", entry)));
+            track.iMetaData.Set(AppendXmlUnescaped(values, XmlParserBasic::Find("Metadata", entry)));
+            tracks.push_back(track);
+        }
+    }
+    catch (XmlError&) {
+        aInvocation.Error(kTrackListInvalidCode, kTrackListInvalidMsg);
+    }
+
+    std::vector<TUint> newIds;
+    try {
+        iDatabase.InsertList(aAfterId, tracks, newIds);
+    }
+    catch (TrackDbIdNotFound&) {
+        aInvocation.Error(kIdNotFoundCode, kIdNotFoundMsg);
+    }
+    catch (TrackDbFull&) {
+        aInvocation.Error(kPlaylistFull, kPlaylistFullMsg);
+    }
+    aInvocation.StartResponse();
+    Bws<Ascii::kMaxUintStringBytes + 1> idBuf;
+    for (TUint i=0; i<newIds.size(); i++) {
+        idBuf.SetBytes(0);
+        if (i > 0) {
+            idBuf.Append(' ');
+        }
+        Ascii::AppendDec(idBuf, newIds[i]);
+        aNewIdList.Write(idBuf);
+    }
+    aNewIdList.WriteFlush();
+    aInvocation.EndResponse();
+}
+
 void ProviderPlaylist::DeleteId(IDvInvocation& aInvocation, TUint aValue)
 {
     try {
@@ -403,6 +482,35 @@ void ProviderPlaylist::DeleteId(IDvInvocation& aInvocation, TUint aValue)
     aInvocation.EndResponse();
 }
 
+void ProviderPlaylist::DeleteList(IDvInvocation& aInvocation, const Brx& aIdList)
+{
+    std::vector<TUint> ids;
+    Parser parser(aIdList);
+    while (!parser.Finished()) {
+        Brn idBuf = parser.Next(' ');
+        if (idBuf.Bytes() == 0) {
+            continue;
+        }
+        try {
+            ids.push_back(Ascii::Uint(idBuf));
+        }
+        catch (AsciiError&) {
+            aInvocation.Error(kIdNotFoundCode, kIdNotFoundMsg);
+        }
+    }
+    try {
+        iDatabase.DeleteList(ids);
+        if (ids.size() > 0 && iDatabase.TrackCount() == 0) {
+            iSource.Stop();
+        }
+    }
+    catch (TrackDbIdNotFound&) {
+        aInvocation.Error(kIdNotFoundCode, kIdNotFoundMsg);
+    }
+    aInvocation.StartResponse();
+    aInvocation.EndResponse();
+}
+
 void ProviderPlaylist::DeleteAll(IDvInvocation& aInvocation)
 {
     iDatabase.DeleteAll();
@@ -52,7 +52,9 @@ public:
     void NotifyProtocolInfo(const Brx& aProtocolInfo);
 private: // from ITrackDatabaseObserver
     void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
     void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
     void NotifyAllDeleted() override;
 private: // from ITransportRepeatRandomObserver
     void TransportRepeatChanged(TBool aRepeat) override;
@@ -76,7 +78,9 @@ private: // from Net::DvProviderAvOpenhomeOrgPlaylist1
     void Read(Net::IDvInvocation& aInvocation, TUint aId, Net::IDvInvocationResponseString& aUri, Net::IDvInvocationResponseString& aMetadata) override;
     void ReadList(Net::IDvInvocation& aInvocation, const Brx& aIdList, Net::IDvInvocationResponseString& aTrackList) override;
     void Insert(Net::IDvInvocation& aInvocation, TUint aAfterId, const Brx& aUri, const Brx& aMetadata, Net::IDvInvocationResponseUint& aNewId) override;
+    void InsertList(Net::IDvInvocation& aInvocation, TUint aAfterId, const Brx& aTrackList, Net::IDvInvocationResponseString& aNewIdList) override;
     void DeleteId(Net::IDvInvocation& aInvocation, TUint aValue) override;
+    void DeleteList(Net::IDvInvocation& aInvocation, const Brx& aIdList) override;
     void DeleteAll(Net::IDvInvocation& aInvocation) override;
     void TracksMax(Net::IDvInvocation& aInvocation, Net::IDvInvocationResponseUint& aValue) override;
     void IdArray(Net::IDvInvocation& aInvocation, Net::IDvInvocationResponseUint& aToken, Net::IDvInvocationResponseBinary& aArray) override;
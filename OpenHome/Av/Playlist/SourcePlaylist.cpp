@@ -48,6 +48,7 @@ public:
 private:
     TBool StartedShuffled();
     void DoSeekToTrackId(Media::Track* aTrack);
+    void UpdateIfEmpty();
     void TracksMaxChanged(Configuration::KeyValuePair<TInt>& aKvp);
 private: // from ISource
     void Activate(TBool aAutoPlay, TBool aPrefetchAllowed) override;
@@ -68,7 +69,9 @@ private: // from ISourcePlaylist
     void SetShuffle(TBool aShuffle) override;
 private: // from ITrackDatabaseObserver
     void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
     void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
     void NotifyAllDeleted() override;
 private: // from Media::IPipelineObserver
     void NotifyPipelineState(Media::EPipelineState aState) override;
@@ -453,6 +456,11 @@ void SourcePlaylist::NotifyTrackInserted(Track& aTrack, TUint aIdBefore, TUint a
     }
 }
 
+void SourcePlaylist::NotifyTracksInserted(const std::vector<Track*>& aTracks, TUint aIdBefore, TUint aIdAfter)
+{
+    NotifyTrackInserted(*aTracks[0], aIdBefore, aIdAfter);
+}
+
 void SourcePlaylist::NotifyTrackDeleted(TUint aId, Track* /*aBefore*/, Track* aAfter)
 {
     if (IsActive() && iTransportState != EPipelinePlaying) {
@@ -461,6 +469,32 @@ void SourcePlaylist::NotifyTrackDeleted(TUint aId, Track* /*aBefore*/, Track* aA
             iPipeline.StopPrefetch(iUriProvider->Mode(), id);
         }
     }
+    UpdateIfEmpty();
+}
+
+void SourcePlaylist::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted)
+{
+    if (IsActive() && iTransportState != EPipelinePlaying) {
+        const TUint currentId = iUriProvider->CurrentTrackId();
+        for (TUint i=0; i<aDeleted.size(); i++) {
+            if (aDeleted[i].iId == currentId) {
+                // skip over any following tracks that were also deleted
+                TUint id = (aDeleted[i].iAfter==nullptr? ITrackDatabase::kTrackIdNone : aDeleted[i].iAfter->Id());
+                for (TUint j=i+1; j<aDeleted.size() && id != ITrackDatabase::kTrackIdNone; j++) {
+                    if (aDeleted[j].iId == id) {
+                        id = (aDeleted[j].iAfter==nullptr? ITrackDatabase::kTrackIdNone : aDeleted[j].iAfter->Id());
+                    }
+                }
+                iPipeline.StopPrefetch(iUriProvider->Mode(), id);
+                break;
+            }
+        }
+    }
+    UpdateIfEmpty();
+}
+
+void SourcePlaylist::UpdateIfEmpty()
+{
     iLock.Wait();
     if (static_cast<ITrackDatabase*>(iDatabase)->TrackCount() == 0) {
         iNewPlaylist = true;
@@ -37,15 +37,14 @@ TrackDatabase::TrackDatabase(TrackFactory& aTrackFactory, TUint aMaxTracks)
     : iLock("TDB1")
     , iObserverLock("TDB2")
     , iTrackFactory(aTrackFactory)
+    , iTrackList(aMaxTracks)
     , iMaxTracks(aMaxTracks)
     , iSeq(0)
 {
-    iTrackList.reserve(aMaxTracks);
 }
 
 TrackDatabase::~TrackDatabase()
 {
-    TrackListUtils::Clear(iTrackList);
 }
 
 void TrackDatabase::AddObserver(ITrackDatabaseObserver& aObserver)
@@ -56,12 +55,9 @@ void TrackDatabase::AddObserver(ITrackDatabaseObserver& aObserver)
 void TrackDatabase::GetIdArray(std::vector<TUint32>& aIdArray, TUint& aSeq) const
 {
     AutoMutex a(iLock);
-    TUint i;
     aIdArray.clear();
-    for (i=0; i<iTrackList.size(); i++) {
-        aIdArray.push_back(iTrackList[i]->Id());
-    }
-    for (i=iTrackList.size(); i<iMaxTracks; i++) {
+    iTrackList.GetIds(aIdArray);
+    for (TUint i=iTrackList.Count(); i<iMaxTracks; i++) {
         aIdArray.push_back(kTrackIdNone);
     }
     aSeq = iSeq;
@@ -75,8 +71,10 @@ void TrackDatabase::GetTrackById(TUint aId, Track*& aTrack) const
 
 void TrackDatabase::GetTrackByIdLocked(TUint aId, Track*& aTrack) const
 {
-    const TUint index = TrackListUtils::IndexFromId(iTrackList, aId);
-    aTrack = iTrackList[index];
+    aTrack = iTrackList.TrackFromId(aId);
+    if (aTrack == nullptr) {
+        THROW(TrackDbIdNotFound);
+    }
     aTrack->AddRef();
 }
 
@@ -88,12 +86,9 @@ void TrackDatabase::GetTrackById(TUint aId, TUint aSeq, Track*& aTrack, TUint& a
         GetTrackByIdLocked(aId, aTrack);
         return;
     }
-    if (!TryGetTrackById(aId, aTrack, aIndex, iTrackList.size(), aIndex)) {
-        TUint endIndex = std::min(aIndex, (TUint)iTrackList.size());
-        if (!TryGetTrackById(aId, aTrack, 0, endIndex, aIndex)) {
-            THROW(TrackDbIdNotFound);
-        }
-    }
+    aIndex = iTrackList.IndexFromId(aId);
+    aTrack = iTrackList.At(aIndex);
+    aTrack->AddRef();
 }
 
 void TrackDatabase::Insert(TUint aIdAfter, const Brx& aUri, const Brx& aMetaData, TUint& aIdInserted)
@@ -103,25 +98,68 @@ void TrackDatabase::Insert(TUint aIdAfter, const Brx& aUri, const Brx& aMetaData
     AutoMutex _(iObserverLock);
     {
         AutoMutex a(iLock);
-        if (iTrackList.size() == iMaxTracks) {
+        if (iTrackList.Count() == iMaxTracks) {
             THROW(TrackDbFull);
         }
         TUint index = 0;
         if (aIdAfter != kTrackIdNone) {
-            index = TrackListUtils::IndexFromId(iTrackList, aIdAfter) + 1;
+            index = iTrackList.IndexFromId(aIdAfter) + 1;
         }
         track = iTrackFactory.CreateTrack(aUri, aMetaData);
         aIdInserted = track->Id();
-        iTrackList.insert(iTrackList.begin() + index, track);
+        iTrackList.Insert(index, track);
         iSeq++;
         idBefore = aIdAfter;
-        idAfter = (index == iTrackList.size()-1? kTrackIdNone : index+1);
+        idAfter = (index == iTrackList.Count()-1? kTrackIdNone : iTrackList.At(index+1)->Id());
     }
     for (TUint i=0; i<iObservers.size(); i++) {
         iObservers[i]->NotifyTrackInserted(*track, idBefore, idAfter);
     }
 }
 
+void TrackDatabase::InsertList(TUint aIdAfter, const std::vector<TrackDbEntry>& aTracks, std::vector<TUint>& aIdsInserted)
+{
+    aIdsInserted.clear();
+    if (aTracks.size() == 0) {
+        return;
+    }
+    std::vector<Track*> tracks;
+    tracks.reserve(aTracks.size());
+    TUint idAfter;
+    AutoMutex _(iObserverLock);
+    {
+        AutoMutex a(iLock);
+        if (iTrackList.Count() + aTracks.size() > iMaxTracks) {
+            THROW(TrackDbFull);
+        }
+        TUint index = 0;
+        if (aIdAfter != kTrackIdNone) {
+            index = iTrackList.IndexFromId(aIdAfter) + 1;
+        }
+        try {
+            for (const auto& entry : aTracks) {
+                tracks.push_back(iTrackFactory.CreateTrack(entry.iUri, entry.iMetaData));
+            }
+        }
+        catch (Exception&) {
+            for (auto track : tracks) {
+                track->RemoveRef();
+            }
+            throw;
+        }
+        aIdsInserted.reserve(tracks.size());
+        for (auto track : tracks) {
+            aIdsInserted.push_back(track->Id());
+            iTrackList.Insert(index++, track);
+        }
+        iSeq++;
+        idAfter = (index == iTrackList.Count()? kTrackIdNone : iTrackList.At(index)->Id());
+    }
+    for (TUint i=0; i<iObservers.size(); i++) {
+        iObservers[i]->NotifyTracksInserted(tracks, aIdAfter, idAfter);
+    }
+}
+
 void TrackDatabase::DeleteId(TUint aId)
 {
     Track* before = nullptr;
@@ -129,17 +167,16 @@ void TrackDatabase::DeleteId(TUint aId)
     AutoMutex _(iObserverLock);
     {
         AutoMutex a(iLock);
-        TUint index = TrackListUtils::IndexFromId(iTrackList, aId);
+        TUint index = iTrackList.IndexFromId(aId);
         if (index > 0) {
-            before = iTrackList[index-1];
+            before = iTrackList.At(index-1);
             before->AddRef();
         }
-        if (index < iTrackList.size()-1) {
-            after = iTrackList[index+1];
+        if (index < iTrackList.Count()-1) {
+            after = iTrackList.At(index+1);
             after->AddRef();
         }
-        iTrackList[index]->RemoveRef();
-        (void)iTrackList.erase(iTrackList.begin() + index);
+        iTrackList.Remove(index)->RemoveRef();
         iSeq++;
     }
     for (TUint i=0; i<iObservers.size(); i++) {
@@ -149,13 +186,52 @@ void TrackDatabase::DeleteId(TUint aId)
     RemoveRefIfNonNull(after);
 }
 
+void TrackDatabase::DeleteList(const std::vector<TUint>& aIds)
+{
+    std::vector<TrackDbDeletion> deleted;
+    AutoMutex _(iObserverLock);
+    {
+        AutoMutex a(iLock);
+        for (auto id : aIds) {
+            if (iTrackList.TrackFromId(id) == nullptr) {
+                THROW(TrackDbIdNotFound);
+            }
+        }
+        deleted.reserve(aIds.size());
+        for (auto id : aIds) {
+            if (iTrackList.TrackFromId(id) == nullptr) {
+                continue; // id repeated in aIds
+            }
+            const TUint index = iTrackList.IndexFromId(id);
+            Track* before = (index == 0? nullptr : iTrackList.At(index-1));
+            Track* after = (index == iTrackList.Count()-1? nullptr : iTrackList.At(index+1));
+            AddRefIfNonNull(before);
+            AddRefIfNonNull(after);
+            deleted.push_back({ id, before, after });
+            iTrackList.Remove(index)->RemoveRef();
+        }
+        if (deleted.size() > 0) {
+            iSeq++;
+        }
+    }
+    if (deleted.size() > 0) {
+        for (TUint i=0; i<iObservers.size(); i++) {
+            iObservers[i]->NotifyTracksDeleted(deleted);
+        }
+    }
+    for (auto& d : deleted) {
+        RemoveRefIfNonNull(d.iBefore);
+        RemoveRefIfNonNull(d.iAfter);
+    }
+}
+
 void TrackDatabase::DeleteAll()
 {
     AutoMutex _(iObserverLock);
     iLock.Wait();
-    const TBool changed = (iTrackList.size() > 0);
+    const TBool changed = (iTrackList.Count() > 0);
     if (changed) {
-        TrackListUtils::Clear(iTrackList);
+        iTrackList.Clear();
         iSeq++;
     }
     iLock.Signal();
@@ -169,7 +245,7 @@ void TrackDatabase::DeleteAll()
 TUint TrackDatabase::TrackCount() const
 {
     iLock.Wait();
-    const TUint count = iTrackList.size();
+    const TUint count = iTrackList.Count();
     iLock.Signal();
     return count;
 }
@@ -188,14 +264,9 @@ void TrackDatabase::SetObserver(ITrackDatabaseObserver& aObserver)
 
 Track* TrackDatabase::TrackRef(TUint aId)
 {
-    Track* track = nullptr;
     AutoMutex a(iLock);
-    try {
-        const TUint index = TrackListUtils::IndexFromId(iTrackList, aId);
-        track = iTrackList[index];
-        track->AddRef();
-    }
-    catch (TrackDbIdNotFound&) { }
+    Track* track = iTrackList.TrackFromId(aId);
+    AddRefIfNonNull(track);
     return track;
 }
 
@@ -204,16 +275,16 @@ Track* TrackDatabase::NextTrackRef(TUint aId)
     Track* track = nullptr;
     AutoMutex a(iLock);
     if (aId == kTrackIdNone) {
-        if (iTrackList.size() > 0) {
-            track = iTrackList[0];
+        if (iTrackList.Count() > 0) {
+            track = iTrackList.At(0);
             track->AddRef();
         }
     }
     else {
         try {
-            const TUint index = TrackListUtils::IndexFromId(iTrackList, aId);
-            if (index < iTrackList.size()-1) {
-                track = iTrackList[index+1];
+            const TUint index = iTrackList.IndexFromId(aId);
+            if (index < iTrackList.Count()-1) {
+                track = iTrackList.At(index+1);
                 track->AddRef();
             }
         }
@@ -227,9 +298,9 @@ Track* TrackDatabase::PrevTrackRef(TUint aId)
     Track* track = nullptr;
     AutoMutex a(iLock);
     try {
-        const TUint index = TrackListUtils::IndexFromId(iTrackList, aId);
+        const TUint index = iTrackList.IndexFromId(aId);
         if (index > 0) {
-            track = iTrackList[index-1];
+            track = iTrackList.At(index-1);
             track->AddRef();
         }
     }
@@ -241,8 +312,8 @@ Track* TrackDatabase::TrackRefByIndex(TUint aIndex)
 {
     Track* track = nullptr;
     iLock.Wait();
-    if (aIndex < iTrackList.size()) {
-        track = iTrackList[aIndex];
+    if (aIndex < iTrackList.Count()) {
+        track = iTrackList.At(aIndex);
         track->AddRef();
     }
     iLock.Signal();
@@ -258,26 +329,7 @@ Track* TrackDatabase::TrackRefByIndexSorted(TUint /*aIndex*/)
 TBool TrackDatabase::IsValid(TUint aId) const
 {
     AutoMutex _(iLock);
-    try {
-        (void)TrackListUtils::IndexFromId(iTrackList, aId);
-        return true;
-    }
-    catch (TrackDbIdNotFound&) {
-        return false;
-    }
-}
-
-TBool TrackDatabase::TryGetTrackById(TUint aId, Track*& aTrack, TUint aStartIndex, TUint aEndIndex, TUint& aFoundIndex) const
-{
-    for (TUint i=aStartIndex; i<aEndIndex; i++) {
-        if (iTrackList[i]->Id() == aId) {
-            aTrack = iTrackList[i];
-            aTrack->AddRef();
-            aFoundIndex = i;
-            return true;
-        }
-    }
-    return false;
+    return iTrackList.TrackFromId(aId) != nullptr;
 }
 
 
@@ -288,11 +340,11 @@ Shuffler::Shuffler(Environment& aEnv, ITrackDatabaseReader& aReader, TUint aMaxT
     , iEnv(aEnv)
     , iReader(aReader)
     , iObserver(nullptr)
+    , iShuffleList(aMaxTracks)
     , iPrevTrackId(ITrackDatabase::kTrackIdNone)
     , iShuffle(false)
 {
     aReader.SetObserver(*this);
-    iShuffleList.reserve(aMaxTracks);
 }
 
 TBool Shuffler::Enabled() const
@@ -305,7 +357,6 @@ TBool Shuffler::Enabled() const
 
 Shuffler::~Shuffler()
 {
-    TrackListUtils::Clear(iShuffleList);
 }
 
 void Shuffler::SetShuffle(TBool aShuffle)
@@ -328,8 +379,8 @@ TBool Shuffler::TryMoveToStart(TUint aId)
     AutoMutex a(iLock);
     if (iShuffle) {
         try {
-            const TUint index = TrackListUtils::IndexFromId(iShuffleList, aId);
-            Track* track = iShuffleList[index];
+            const TUint index = iShuffleList.IndexFromId(aId);
+            Track* track = iShuffleList.At(index);
             MoveToStartOfUnplayed(track, "MoveToStart");
             return true;
         }
@@ -350,16 +401,15 @@ Track* Shuffler::TrackRef(TUint aId)
     Track* track = nullptr;
     AutoMutex a(iLock);
     if (iShuffle) {
-        try {
-            const TUint index = TrackListUtils::IndexFromId(iShuffleList, aId);
-            track = iShuffleList[index];
+        track = iShuffleList.TrackFromId(aId);
+        if (track == nullptr) {
+            iPrevTrackId = ITrackDatabase::kTrackIdNone;
+        }
+        else {
             track->AddRef();
             iPrevTrackId = track->Id();
             LogIds("TrackRef");
         }
-        catch (TrackDbIdNotFound&) {
-            iPrevTrackId = ITrackDatabase::kTrackIdNone;
-        }
     }
     else {
         track = iReader.TrackRef(aId);
@@ -376,22 +426,22 @@ Track* Shuffler::NextTrackRef(TUint aId)
     }
     else {
         if (aId == ITrackDatabase::kTrackIdNone) {
-            if (iShuffleList.size() > 0) {
-                track = iShuffleList[0];
+            if (iShuffleList.Count() > 0) {
+                track = iShuffleList.At(0);
                 track->AddRef();
             }
         }
         else {
             try {
-                const TUint index = TrackListUtils::IndexFromId(iShuffleList, aId);
-                if (index < iShuffleList.size()-1) {
-                    track = iShuffleList[index+1];
+                const TUint index = iShuffleList.IndexFromId(aId);
+                if (index < iShuffleList.Count()-1) {
+                    track = iShuffleList.At(index+1);
                     track->AddRef();
                 }
-                else if (index == iShuffleList.size()-1) {
+                else if (index == iShuffleList.Count()-1) {
                     // we've run through the entire list
                     // prefer re-shuffling over repeating the order of tracks if we play again
-                    std::random_shuffle(iShuffleList.begin(), iShuffleList.end());
+                    iShuffleList.Shuffle();
                     LogIds("NextTrackRef");
                 }
             }
@@ -411,9 +461,9 @@ Track* Shuffler::PrevTrackRef(TUint aId)
     }
     else {
         try {
-            const TUint index = TrackListUtils::IndexFromId(iShuffleList, aId);
+            const TUint index = iShuffleList.IndexFromId(aId);
             if (index != 0) {
-                track = iShuffleList[index-1];
+                track = iShuffleList.At(index-1);
                 track->AddRef();
             }
         }
@@ -449,8 +499,8 @@ Track* Shuffler::TrackRefByIndexSorted(TUint aIndex)
     if (!iShuffle) {
         track = iReader.TrackRefByIndex(aIndex);
     }
-    else if (aIndex < iShuffleList.size()) {
-        track = iShuffleList[aIndex];
+    else if (aIndex < iShuffleList.Count()) {
+        track = iShuffleList.At(aIndex);
         track->AddRef();
     }
     return track;
@@ -467,24 +517,10 @@ void Shuffler::NotifyTrackInserted(Track& aTrack, TUint aIdBefore, TUint aIdAfte
     TUint idAfter = aIdAfter;
     try {
         AutoMutex a(iLock);
-        TUint index = 0;
-        if (iShuffleList.size() > 0) {
-            TUint min = 0;
-            if (iPrevTrackId != ITrackDatabase::kTrackIdNone) {
-                min = TrackListUtils::IndexFromId(iShuffleList, iPrevTrackId) + 1;
-            }
-            if (min == iShuffleList.size()) {
-                index = min;
-            }
-            else {
-                index = iEnv.Random(iShuffleList.size(), min);
-            }
-        }
-        iShuffleList.insert(iShuffleList.begin() + index, &aTrack);
-        aTrack.AddRef();
+        const TUint index = InsertLocked(aTrack);
         if (iShuffle) {
-            idBefore = (index == 0? ITrackDatabase::kTrackIdNone : iShuffleList[index-1]->Id());
-            idAfter = (index == iShuffleList.size()-1? ITrackDatabase::kTrackIdNone : iShuffleList[index+1]->Id());
+            idBefore = (index == 0? ITrackDatabase::kTrackIdNone : iShuffleList.At(index-1)->Id());
+            idAfter = (index == iShuffleList.Count()-1? ITrackDatabase::kTrackIdNone : iShuffleList.At(index+1)->Id());
             LogIds("TrackInserted");
         }
     }
@@ -494,52 +530,134 @@ void Shuffler::NotifyTrackInserted(Track& aTrack, TUint aIdBefore, TUint aIdAfte
     iObserver->NotifyTrackInserted(aTrack, idBefore, idAfter);
 }
 
-void Shuffler::NotifyTrackDeleted(TUint aId, Track* aBefore, Track* aAfter)
+void Shuffler::NotifyTracksInserted(const std::vector<Track*>& aTracks, TUint aIdBefore, TUint aIdAfter)
 {
-    Track* before = aBefore;
-    Track* after = aAfter;
+    /* Tracks are scattered through the unplayed part of iShuffleList so, when shuffled,
+       don't form the contiguous block our observer expects from a batch notification.
+       Report them individually in that case, with the neighbours each had as it was added. */
+    std::vector<std::pair<TUint, TUint>> neighbours;
     try {
         AutoMutex a(iLock);
-        const TUint index = TrackListUtils::IndexFromId(iShuffleList, aId);
         if (iShuffle) {
-            before = (index==0? nullptr : iShuffleList[index-1]);
-            after = (index==iShuffleList.size()-1? nullptr : iShuffleList[index+1]);
-            if (iShuffleList[index]->Id() == iPrevTrackId) {
-                if (index == 0) {
-                    iPrevTrackId = ITrackDatabase::kTrackIdNone;
-                }
-                else {
-                    iPrevTrackId = iShuffleList[index-1]->Id();
-                }
+            neighbours.reserve(aTracks.size());
+        }
+        for (auto track : aTracks) {
+            const TUint index = InsertLocked(*track);
+            if (iShuffle) {
+                const TUint idBefore = (index == 0? ITrackDatabase::kTrackIdNone : iShuffleList.At(index-1)->Id());
+                const TUint idAfter = (index == iShuffleList.Count()-1? ITrackDatabase::kTrackIdNone : iShuffleList.At(index+1)->Id());
+                neighbours.push_back(std::pair<TUint, TUint>(idBefore, idAfter));
             }
         }
-        iShuffleList[index]->RemoveRef();
-        iShuffleList.erase(iShuffleList.begin() + index);
-        LogIds("TrackDeleted");
-        AddRefIfNonNull(before);
-        AddRefIfNonNull(after);
+        if (iShuffle) {
+            LogIds("TracksInserted");
+        }
     }
     catch (TrackDbIdNotFound&) {
         return;
     }
+    if (neighbours.size() == 0) {
+        iObserver->NotifyTracksInserted(aTracks, aIdBefore, aIdAfter);
+    }
+    else {
+        for (TUint i=0; i<neighbours.size(); i++) {
+            iObserver->NotifyTrackInserted(*aTracks[i], neighbours[i].first, neighbours[i].second);
+        }
+    }
+}
+
+void Shuffler::NotifyTrackDeleted(TUint aId, Track* aBefore, Track* aAfter)
+{
+    Track* before = aBefore;
+    Track* after = aAfter;
+    {
+        AutoMutex a(iLock);
+        if (!DeleteLocked(aId, before, after)) {
+            return;
+        }
+        LogIds("TrackDeleted");
+    }
     iObserver->NotifyTrackDeleted(aId, before, after);
     RemoveRefIfNonNull(before);
     RemoveRefIfNonNull(after);
 }
 
+void Shuffler::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted)
+{
+    std::vector<TrackDbDeletion> deleted;
+    deleted.reserve(aDeleted.size());
+    {
+        AutoMutex a(iLock);
+        for (auto d : aDeleted) {
+            if (DeleteLocked(d.iId, d.iBefore, d.iAfter)) {
+                deleted.push_back(d);
+            }
+        }
+        LogIds("TracksDeleted");
+    }
+    if (deleted.size() > 0) {
+        iObserver->NotifyTracksDeleted(deleted);
+    }
+    for (auto& d : deleted) {
+        RemoveRefIfNonNull(d.iBefore);
+        RemoveRefIfNonNull(d.iAfter);
+    }
+}
+
 void Shuffler::NotifyAllDeleted()
 {
     iLock.Wait();
     iPrevTrackId = ITrackDatabase::kTrackIdNone;
-    TrackListUtils::Clear(iShuffleList);
+    iShuffleList.Clear();
     iLock.Signal();
     iObserver->NotifyAllDeleted();
 }
 
+TUint Shuffler::InsertLocked(Track& aTrack)
+{
+    TUint index = 0;
+    if (iShuffleList.Count() > 0) {
+        TUint min = 0;
+        if (iPrevTrackId != ITrackDatabase::kTrackIdNone) {
+            min = iShuffleList.IndexFromId(iPrevTrackId) + 1;
+        }
+        if (min == iShuffleList.Count()) {
+            index = min;
+        }
+        else {
+            index = iEnv.Random(iShuffleList.Count(), min);
+        }
+    }
+    aTrack.AddRef();
+    iShuffleList.Insert(index, &aTrack);
+    return index;
+}
+
+TBool Shuffler::DeleteLocked(TUint aId, Track*& aBefore, Track*& aAfter)
+{
+    // on success, claims a reference to (possibly updated) aBefore, aAfter
+    Track* track = iShuffleList.TrackFromId(aId);
+    if (track == nullptr) {
+        return false;
+    }
+    const TUint index = iShuffleList.IndexFromId(aId);
+    if (iShuffle) {
+        aBefore = (index==0? nullptr : iShuffleList.At(index-1));
+        aAfter = (index==iShuffleList.Count()-1? nullptr : iShuffleList.At(index+1));
+        if (aId == iPrevTrackId) {
+            iPrevTrackId = (aBefore == nullptr? ITrackDatabase::kTrackIdNone : aBefore->Id());
+        }
+    }
+    iShuffleList.Remove(index)->RemoveRef();
+    AddRefIfNonNull(aBefore);
+    AddRefIfNonNull(aAfter);
+    return true;
+}
+
 void Shuffler::DoReshuffle(const TChar* aLogPrefix)
 {
     if (iShuffle) { // prefer re-shuffling over repeating the order of tracks if we play again
-        std::random_shuffle(iShuffleList.begin(), iShuffleList.end());
+        iShuffleList.Shuffle();
         LogIds(aLogPrefix);
         iPrevTrackId = ITrackDatabase::kTrackIdNone;
     }
@@ -547,12 +665,11 @@ void Shuffler::DoReshuffle(const TChar* aLogPrefix)
 
 void Shuffler::MoveToStartOfUnplayed(Track* aTrack, const TChar* aLogPrefix)
 {
-    const TUint index = TrackListUtils::IndexFromId(iShuffleList, aTrack->Id());
+    const TUint index = iShuffleList.IndexFromId(aTrack->Id());
     const TUint cursorIndex = (iPrevTrackId == ITrackDatabase::kTrackIdNone?
-            0 : TrackListUtils::IndexFromId(iShuffleList, iPrevTrackId));
+            0 : iShuffleList.IndexFromId(iPrevTrackId));
     if (index > cursorIndex+1) {
-        iShuffleList.erase(iShuffleList.begin() + index);
-        iShuffleList.insert(iShuffleList.begin() + cursorIndex, aTrack);
+        iShuffleList.Insert(cursorIndex, iShuffleList.Remove(index));
     }
     iPrevTrackId = aTrack->Id();
     LogIds(aLogPrefix);
@@ -560,11 +677,16 @@ void Shuffler::MoveToStartOfUnplayed(Track* aTrack, const TChar* aLogPrefix)
 
 void Shuffler::LogIds(const TChar* aPrefix)
 {
+    if (!Debug::TestLevel(Debug::kSources)) {
+        return;
+    }
+    std::vector<TUint32> ids;
+    iShuffleList.GetIds(ids);
     LOG(kSources, "%s.  New track order is: { ", aPrefix);
-    if (iShuffleList.size() > 0) {
-        LOG(kSources, "%u", iShuffleList[0]->Id());
-        for (TUint i=1; i<iShuffleList.size(); i++) {
-            LOG(kSources, ", %u", iShuffleList[i]->Id());
+    if (ids.size() > 0) {
+        LOG(kSources, "%u", ids[0]);
+        for (TUint i=1; i<ids.size(); i++) {
+            LOG(kSources, ", %u", ids[i]);
         }
     }
     LOG(kSources, "}\n");
@@ -647,6 +769,14 @@ void Repeater::NotifyTrackInserted(Track& aTrack, TUint aIdBefore, TUint aIdAfte
     iObserver->NotifyTrackInserted(aTrack, aIdBefore, aIdAfter);
 }
 
+void Repeater::NotifyTracksInserted(const std::vector<Track*>& aTracks, TUint aIdBefore, TUint aIdAfter)
+{
+    iLock.Wait();
+    iTrackCount += (TUint)aTracks.size();
+    iLock.Signal();
+    iObserver->NotifyTracksInserted(aTracks, aIdBefore, aIdAfter);
+}
+
 void Repeater::NotifyTrackDeleted(TUint aId, Track* aBefore, Track* aAfter)
 {
     iLock.Wait();
@@ -655,6 +785,14 @@ void Repeater::NotifyTrackDeleted(TUint aId, Track* aBefore, Track* aAfter)
     iObserver->NotifyTrackDeleted(aId, aBefore, aAfter);
 }
 
+void Repeater::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted)
+{
+    iLock.Wait();
+    iTrackCount -= (TUint)aDeleted.size();
+    iLock.Signal();
+    iObserver->NotifyTracksDeleted(aDeleted);
+}
+
 void Repeater::NotifyAllDeleted()
 {
     iLock.Wait();
@@ -664,22 +802,233 @@ void Repeater::NotifyAllDeleted()
 }
 
 
-// TrackListUtils
+// TrackList
 
-TUint TrackListUtils::IndexFromId(const std::vector<Track*>& aList, TUint aId)
-{ // static
-    for (TUint i=0; i<aList.size(); i++) {
-        if (aList[i]->Id() == aId) {
-            return i;
+TrackList::TrackList(TUint aMaxTracks)
+    : iNodes(aMaxTracks)
+    , iRoot(nullptr)
+    , iRandom(0x9e3779b9)
+{
+    iNodesFree.reserve(aMaxTracks);
+    for (TUint i=aMaxTracks; i>0; i--) {
+        iNodesFree.push_back(&iNodes[i-1]);
+    }
+    iIdToNode.reserve(aMaxTracks);
+}
+
+TrackList::~TrackList()
+{
+    Clear();
+}
+
+TUint TrackList::Count() const
+{
+    return Size(iRoot);
+}
+
+Track* TrackList::At(TUint aIndex) const
+{
+    ASSERT(aIndex < Size(iRoot));
+    const Node* node = iRoot;
+    for (;;) {
+        const TUint leftSize = Size(node->iLeft);
+        if (aIndex < leftSize) {
+            node = node->iLeft;
+        }
+        else if (aIndex == leftSize) {
+            return node->iTrack;
+        }
+        else {
+            aIndex -= leftSize + 1;
+            node = node->iRight;
         }
     }
-    THROW(TrackDbIdNotFound);
 }
 
-void TrackListUtils::Clear(std::vector<Track*>& aList)
+Track* TrackList::TrackFromId(TUint aId) const
+{
+    auto it = iIdToNode.find(aId);
+    if (it == iIdToNode.end()) {
+        return nullptr;
+    }
+    return it->second->iTrack;
+}
+
+TUint TrackList::IndexFromId(TUint aId) const
+{
+    auto it = iIdToNode.find(aId);
+    if (it == iIdToNode.end()) {
+        THROW(TrackDbIdNotFound);
+    }
+    return Rank(it->second);
+}
+
+void TrackList::Insert(TUint aIndex, Track* aTrack)
+{
+    ASSERT(aIndex <= Size(iRoot));
+    Node* node = NewNode(aTrack);
+    iIdToNode[aTrack->Id()] = node;
+    InsertNode(aIndex, node);
+}
+
+Track* TrackList::Remove(TUint aIndex)
+{
+    ASSERT(aIndex < Size(iRoot));
+    Node* left;
+    Node* mid;
+    Node* right;
+    Split(iRoot, aIndex, left, right);
+    Split(right, 1, mid, right);
+    iRoot = Merge(left, right);
+    if (iRoot != nullptr) {
+        iRoot->iParent = nullptr;
+    }
+    Track* track = mid->iTrack;
+    (void)iIdToNode.erase(track->Id());
+    iNodesFree.push_back(mid);
+    return track;
+}
+
+void TrackList::Clear()
+{
+    for (auto& kvp : iIdToNode) {
+        kvp.second->iTrack->RemoveRef();
+        iNodesFree.push_back(kvp.second);
+    }
+    iIdToNode.clear();
+    iRoot = nullptr;
+}
+
+void TrackList::Shuffle()
+{
+    std::vector<Track*> tracks;
+    tracks.reserve(Size(iRoot));
+    AppendInOrder(iRoot, tracks);
+    std::random_shuffle(tracks.begin(), tracks.end());
+    // re-use the existing nodes; ids don't change so iIdToNode remains valid
+    std::vector<Node*> nodes;
+    nodes.reserve(tracks.size());
+    for (auto track : tracks) {
+        nodes.push_back(iIdToNode[track->Id()]);
+    }
+    iRoot = nullptr;
+    for (TUint i=0; i<nodes.size(); i++) {
+        Node* node = nodes[i];
+        node->iLeft = node->iRight = node->iParent = nullptr;
+        node->iSize = 1;
+        InsertNode(i, node);
+    }
+}
+
+void TrackList::GetIds(std::vector<TUint32>& aIds) const
+{
+    std::vector<Track*> tracks;
+    tracks.reserve(Size(iRoot));
+    AppendInOrder(iRoot, tracks);
+    for (auto track : tracks) {
+        aIds.push_back(track->Id());
+    }
+}
+
+TUint TrackList::Size(const Node* aNode)
 { // static
-    for (TUint i=0; i<aList.size(); i++) {
-        aList[i]->RemoveRef();
+    return (aNode == nullptr? 0 : aNode->iSize);
+}
+
+void TrackList::Update(Node* aNode)
+{ // static
+    aNode->iSize = 1 + Size(aNode->iLeft) + Size(aNode->iRight);
+    if (aNode->iLeft != nullptr) {
+        aNode->iLeft->iParent = aNode;
+    }
+    if (aNode->iRight != nullptr) {
+        aNode->iRight->iParent = aNode;
+    }
+}
+
+void TrackList::Split(Node* aNode, TUint aCount, Node*& aLeft, Node*& aRight)
+{ // static
+    // aLeft receives the first aCount nodes in order, aRight the remainder
+    if (aNode == nullptr) {
+        aLeft = aRight = nullptr;
+        return;
+    }
+    if (Size(aNode->iLeft) < aCount) {
+        Split(aNode->iRight, aCount - Size(aNode->iLeft) - 1, aNode->iRight, aRight);
+        aLeft = aNode;
     }
-    aList.clear();
+    else {
+        Split(aNode->iLeft, aCount, aLeft, aNode->iLeft);
+        aRight = aNode;
+    }
+    Update(aNode);
+}
+
+TrackList::Node* TrackList::Merge(Node* aLeft, Node* aRight)
+{ // static
+    if (aLeft == nullptr) {
+        return aRight;
+    }
+    if (aRight == nullptr) {
+        return aLeft;
+    }
+    if (aLeft->iPriority > aRight->iPriority) {
+        aLeft->iRight = Merge(aLeft->iRight, aRight);
+        Update(aLeft);
+        return aLeft;
+    }
+    aRight->iLeft = Merge(aLeft, aRight->iLeft);
+    Update(aRight);
+    return aRight;
+}
+
+void TrackList::AppendInOrder(const Node* aNode, std::vector<Track*>& aTracks)
+{ // static
+    if (aNode != nullptr) {
+        AppendInOrder(aNode->iLeft, aTracks);
+        aTracks.push_back(aNode->iTrack);
+        AppendInOrder(aNode->iRight, aTracks);
+    }
+}
+
+TUint TrackList::Rank(const Node* aNode)
+{ // static
+    TUint rank = Size(aNode->iLeft);
+    while (aNode->iParent != nullptr) {
+        if (aNode == aNode->iParent->iRight) {
+            rank += Size(aNode->iParent->iLeft) + 1;
+        }
+        aNode = aNode->iParent;
+    }
+    return rank;
+}
+
+TrackList::Node* TrackList::NewNode(Track* aTrack)
+{
+    ASSERT(iNodesFree.size() > 0);
+    Node* node = iNodesFree.back();
+    iNodesFree.pop_back();
+    node->iTrack = aTrack;
+    node->iLeft = node->iRight = node->iParent = nullptr;
+    node->iSize = 1;
+    node->iPriority = NextPriority();
+    return node;
+}
+
+void TrackList::InsertNode(TUint aIndex, Node* aNode)
+{
+    Node* left;
+    Node* right;
+    Split(iRoot, aIndex, left, right);
+    iRoot = Merge(Merge(left, aNode), right);
+    iRoot->iParent = nullptr;
+}
+
+TUint TrackList::NextPriority()
+{
+    // xorshift32.  Priorities only need to be well distributed, not unpredictable.
+    iRandom ^= iRandom << 13;
+    iRandom ^= iRandom >> 17;
+    iRandom ^= iRandom << 5;
+    return iRandom;
 }
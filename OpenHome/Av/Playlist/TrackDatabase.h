@@ -3,9 +3,11 @@
 #include <OpenHome/Types.h>
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Exception.h>
+#include <OpenHome/Private/Standard.h>
 #include <OpenHome/Private/Thread.h>
 
 #include <vector>
+#include <unordered_map>
 
 EXCEPTION(TrackDbIdNotFound);
 EXCEPTION(TrackDbFull);
@@ -17,13 +19,28 @@ namespace Media {
     class TrackFactory;
 }
 namespace Av {
-    
+
+struct TrackDbEntry
+{
+    Brn iUri;
+    Brn iMetaData;
+};
+
+struct TrackDbDeletion
+{
+    TUint iId;
+    Media::Track* iBefore; // neighbours of iId at the point it was removed.  nullptr at either end of the list
+    Media::Track* iAfter;
+};
+
 class ITrackDatabaseObserver
 {
 public:
     virtual ~ITrackDatabaseObserver() {}
     virtual void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) = 0;
+    virtual void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) = 0; // aTracks are contiguous, in list order
     virtual void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) = 0;
+    virtual void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) = 0; // aDeleted is in order of removal
     virtual void NotifyAllDeleted() = 0;
 };
 
@@ -38,7 +55,9 @@ public:
     virtual void GetTrackById(TUint aId, Media::Track*& aTrack) const = 0;
     virtual void GetTrackById(TUint aId, TUint aSeq, Media::Track*& aTrack, TUint& aIndex) const = 0;
     virtual void Insert(TUint aIdAfter, const Brx& aUri, const Brx& aMetaData, TUint& aIdInserted) = 0;
+    virtual void InsertList(TUint aIdAfter, const std::vector<TrackDbEntry>& aTracks, std::vector<TUint>& aIdsInserted) = 0; // all or nothing
     virtual void DeleteId(TUint aId) = 0;
+    virtual void DeleteList(const std::vector<TUint>& aIds) = 0; // all or nothing
     virtual void DeleteAll() = 0;
     virtual TUint TrackCount() const = 0;
     virtual TUint TracksMax() const = 0;
@@ -64,6 +83,56 @@ public:
     virtual void SetRepeat(TBool aRepeat) = 0;
 };
 
+/*
+ * Ordered list of tracks.
+ *
+ * Lookup by id is O(1); lookup by index, index of an id, insertion and removal are O(log n).
+ * Tracks are held in an implicit treap (a binary tree ordered by position, balanced by random
+ * node priorities, with each node recording the size of its subtree) plus a hash of id to node.
+ * The list owns one reference to each track it holds.
+ */
+class TrackList : private INonCopyable
+{
+public:
+    TrackList(TUint aMaxTracks);
+    ~TrackList();
+    TUint Count() const;
+    Media::Track* At(TUint aIndex) const;       // no reference is claimed.  aIndex must be < Count()
+    Media::Track* TrackFromId(TUint aId) const; // no reference is claimed.  nullptr if aId not found
+    TUint IndexFromId(TUint aId) const;         // throws TrackDbIdNotFound
+    void Insert(TUint aIndex, Media::Track* aTrack); // takes ownership of the caller's reference
+    Media::Track* Remove(TUint aIndex);              // passes ownership of a reference to the caller
+    void Clear();
+    void Shuffle();
+    void GetIds(std::vector<TUint32>& aIds) const;
+private:
+    struct Node
+    {
+        Media::Track* iTrack;
+        Node* iLeft;
+        Node* iRight;
+        Node* iParent;
+        TUint iSize;
+        TUint iPriority;
+    };
+private:
+    static TUint Size(const Node* aNode);
+    static void Update(Node* aNode);
+    static void Split(Node* aNode, TUint aCount, Node*& aLeft, Node*& aRight);
+    static Node* Merge(Node* aLeft, Node* aRight);
+    static void AppendInOrder(const Node* aNode, std::vector<Media::Track*>& aTracks);
+    static TUint Rank(const Node* aNode);
+    Node* NewNode(Media::Track* aTrack);
+    void InsertNode(TUint aIndex, Node* aNode);
+    TUint NextPriority();
+private:
+    std::vector<Node> iNodes;
+    std::vector<Node*> iNodesFree;
+    std::unordered_map<TUint, Node*> iIdToNode;
+    Node* iRoot;
+    TUint iRandom;
+};
+
 class TrackDatabase : public ITrackDatabase, public ITrackDatabaseReader
 {
 public:
@@ -75,7 +144,9 @@ private: // from ITrackDatabase
     void GetTrackById(TUint aId, Media::Track*& aTrack) const override;
     void GetTrackById(TUint aId, TUint aSeq, Media::Track*& aTrack, TUint& aIndex) const override;
     void Insert(TUint aIdAfter, const Brx& aUri, const Brx& aMetaData, TUint& aIdInserted) override;
+    void InsertList(TUint aIdAfter, const std::vector<TrackDbEntry>& aTracks, std::vector<TUint>& aIdsInserted) override;
     void DeleteId(TUint aId) override;
+    void DeleteList(const std::vector<TUint>& aIds) override;
     void DeleteAll() override;
     TUint TrackCount() const override;
     TUint TracksMax() const override;
@@ -89,13 +160,12 @@ private: // from ITrackDatabaseReader
     TBool IsValid(TUint aId) const override;
 private:
     void GetTrackByIdLocked(TUint aId, Media::Track*& aTrack) const;
-    TBool TryGetTrackById(TUint aId, Media::Track*& aTrack, TUint aStartIndex, TUint aEndIndex, TUint& aFoundIndex) const;
 private:
     mutable Mutex iLock;
     Mutex iObserverLock;
     Media::TrackFactory& iTrackFactory;
     std::vector<ITrackDatabaseObserver*> iObservers;
-    std::vector<Media::Track*> iTrackList;
+    TrackList iTrackList;
     const TUint iMaxTracks;
     TUint iSeq;
 };
@@ -120,9 +190,13 @@ private: // from ITrackDatabaseReader
     TBool IsValid(TUint aId) const override;
 private: // from ITrackDatabaseObserver
     void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
     void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
     void NotifyAllDeleted() override;
 private:
+    TUint InsertLocked(Media::Track& aTrack); // returns index aTrack was inserted at
+    TBool DeleteLocked(TUint aId, Media::Track*& aBefore, Media::Track*& aAfter);
     void DoReshuffle(const TChar* aLogPrefix);
     void MoveToStartOfUnplayed(Media::Track* aTrack, const TChar* aLogPrefix);
     void LogIds(const TChar* aPrefix);
@@ -131,7 +205,7 @@ private:
     Environment& iEnv;
     ITrackDatabaseReader& iReader;
     ITrackDatabaseObserver* iObserver;
-    std::vector<Media::Track*> iShuffleList;
+    TrackList iShuffleList;
     TUint iPrevTrackId;
     TBool iShuffle;
 };
@@ -152,7 +226,9 @@ private: // from ITrackDatabaseReader
     TBool IsValid(TUint aId) const override;
 private: // from ITrackDatabaseObserver
     void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
     void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
     void NotifyAllDeleted() override;
 private:
     Mutex iLock;
@@ -162,13 +238,6 @@ private:
     TUint iTrackCount;
 };
 
-class TrackListUtils
-{
-public:
-    static TUint IndexFromId(const std::vector<Media::Track*>& aList, TUint aId);
-    static void Clear(std::vector<Media::Track*>& aList);
-};
-
 } // namespace Av
 } // namespace OpenHome
 
@@ -337,35 +337,9 @@ void UriProviderPlaylist::NotifyTrackInserted(Track& aTrack, TUint aIdBefore, TU
 {
     {
         AutoMutex a(iLock);
-        if (iPending != nullptr) {
-            if ((iPendingDirection == eForwards && iPending->Id() == aIdAfter) ||
-                (iPendingDirection == eBackwards && iPending->Id() == aIdBefore)) {
-                iPending->RemoveRef();
-                iPending = &aTrack;
-                iPending->AddRef();
-            }
-        }
-        if (iActive) {
-            iIdManager.InvalidateAfter(aIdBefore);
-        }
-        if (aIdBefore == iPlayingTrackId) {
-            iLastTrackId = iPlayingTrackId;
-        }
-
-        // allow additional loop round the playlist in case the new track is the only one that is playable
-        iFirstFailedTrackId = ITrackDatabase::kTrackIdNone;
-    }
-    TBool consumed = false;
-    {
-        AutoMutex _(iLockLoader);
-        if (iLoaderWait && aIdBefore == iLoaderIdBefore) {
-            iLoaderWait = false;
-            iSemLoader.Signal();
-            consumed = true;
-        }
+        TrackInsertedLocked(aTrack, aIdBefore, aIdAfter);
     }
-
-    if (!consumed) {
+    if (!TryConsumeLoaderInsert(aIdBefore)) {
         /* iDbObserver (SourcePlaylist) calls StopPrefetch for the first track added to an empty playlist.
            This conflicts with async loading of a saved playlist (the thing that caused iLoaderWait to be
            set).  Avoid this by now by not passing the notification on.
@@ -375,35 +349,97 @@ void UriProviderPlaylist::NotifyTrackInserted(Track& aTrack, TUint aIdBefore, TU
     }
 }
 
+void UriProviderPlaylist::NotifyTracksInserted(const std::vector<Track*>& aTracks, TUint aIdBefore, TUint aIdAfter)
+{
+    {
+        AutoMutex a(iLock);
+        TUint idBefore = aIdBefore;
+        for (auto track : aTracks) {
+            TrackInsertedLocked(*track, idBefore, aIdAfter);
+            idBefore = track->Id();
+        }
+    }
+    if (!TryConsumeLoaderInsert(aIdBefore)) {
+        iDbObserver.NotifyTracksInserted(aTracks, aIdBefore, aIdAfter);
+    }
+}
+
 void UriProviderPlaylist::NotifyTrackDeleted(TUint aId, Track* aBefore, Track* aAfter)
 {
     {
         AutoMutex a(iLock);
-        if (iPending != nullptr && iPending->Id() == aId) {
+        TrackDeletedLocked(aId, aBefore, aAfter);
+    }
+    iDbObserver.NotifyTrackDeleted(aId, aBefore, aAfter);
+}
+
+void UriProviderPlaylist::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted)
+{
+    {
+        AutoMutex a(iLock);
+        for (const auto& d : aDeleted) {
+            TrackDeletedLocked(d.iId, d.iBefore, d.iAfter);
+        }
+    }
+    iDbObserver.NotifyTracksDeleted(aDeleted);
+}
+
+void UriProviderPlaylist::TrackInsertedLocked(Track& aTrack, TUint aIdBefore, TUint aIdAfter)
+{
+    if (iPending != nullptr) {
+        if ((iPendingDirection == eForwards && iPending->Id() == aIdAfter) ||
+            (iPendingDirection == eBackwards && iPending->Id() == aIdBefore)) {
             iPending->RemoveRef();
-            iPending = nullptr;
-            if (iPendingDirection == eForwards) {
-                iLastTrackId = (aBefore==nullptr? ITrackDatabase::kTrackIdNone : aBefore->Id());
-            }
-            else { // eBackwards || eJumpTo
-                iPending = (aBefore!=nullptr? aAfter : aBefore);
-                if (iPending == nullptr) {
-                    iLastTrackId = ITrackDatabase::kTrackIdNone;
-                }
-                else {
-                    iPending->AddRef();
-                }
-            }
+            iPending = &aTrack;
+            iPending->AddRef();
         }
-        else if (iLastTrackId == aId) {
+    }
+    if (iActive) {
+        iIdManager.InvalidateAfter(aIdBefore);
+    }
+    if (aIdBefore == iPlayingTrackId) {
+        iLastTrackId = iPlayingTrackId;
+    }
+
+    // allow additional loop round the playlist in case the new track is the only one that is playable
+    iFirstFailedTrackId = ITrackDatabase::kTrackIdNone;
+}
+
+TBool UriProviderPlaylist::TryConsumeLoaderInsert(TUint aIdBefore)
+{
+    AutoMutex _(iLockLoader);
+    if (iLoaderWait && aIdBefore == iLoaderIdBefore) {
+        iLoaderWait = false;
+        iSemLoader.Signal();
+        return true;
+    }
+    return false;
+}
+
+void UriProviderPlaylist::TrackDeletedLocked(TUint aId, Track* aBefore, Track* aAfter)
+{
+    if (iPending != nullptr && iPending->Id() == aId) {
+        iPending->RemoveRef();
+        iPending = nullptr;
+        if (iPendingDirection == eForwards) {
             iLastTrackId = (aBefore==nullptr? ITrackDatabase::kTrackIdNone : aBefore->Id());
         }
-        if (iActive) {
-            iIdManager.InvalidateAt(aId);
+        else { // eBackwards || eJumpTo
+            iPending = (aBefore!=nullptr? aAfter : aBefore);
+            if (iPending == nullptr) {
+                iLastTrackId = ITrackDatabase::kTrackIdNone;
+            }
+            else {
+                iPending->AddRef();
+            }
         }
     }
-
-    iDbObserver.NotifyTrackDeleted(aId, aBefore, aAfter);
+    else if (iLastTrackId == aId) {
+        iLastTrackId = (aBefore==nullptr? ITrackDatabase::kTrackIdNone : aBefore->Id());
+    }
+    if (iActive) {
+        iIdManager.InvalidateAt(aId);
+    }
 }
 
 void UriProviderPlaylist::NotifyAllDeleted()
@@ -52,7 +52,9 @@ public: // from UriProvider
     void MoveTo(const Brx& aCommand) override;
 private: // from ITrackDatabaseObserver
     void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
     void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
     void NotifyAllDeleted() override;
 private: // from Media::IPipelineObserver
     void NotifyPipelineState(Media::EPipelineState aState) override;
@@ -66,6 +68,9 @@ private: // from Media::ITrackObserver
     void NotifyTrackPlay(Media::Track& aTrack) override;
     void NotifyTrackFail(Media::Track& aTrack) override;
 private:
+    void TrackInsertedLocked(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter);
+    TBool TryConsumeLoaderInsert(TUint aIdBefore);
+    void TrackDeletedLocked(TUint aId, Media::Track* aBefore, Media::Track* aAfter);
     void DoBegin(TUint aTrackId, Media::EStreamPlay aPendingCanPlay);
     TUint CurrentTrackIdLocked() const;
     TUint ParseCommand(const Brx& aCommand) const;
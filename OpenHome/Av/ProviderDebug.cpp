@@ -139,11 +139,18 @@ ProviderDebug::ProviderDebug(DvDevice& aDevice, RingBufferLogger& aLogger, Optio
     , iLogPoster(aLogPoster)
     , iDvStack(aDevice.Device().GetDvStack())
     , iMSearchObserver(iDvStack.Env())
+    , iSongcastResendReporter(nullptr)
 {
     EnableActionGetLog();
     EnableActionSendLog();
     EnableActionSendDeviceAnnouncements();
     EnableActionGetRecentMSearches();
+    EnableActionGetSongcastResends();
+}
+
+void ProviderDebug::SetSongcastResendReporter(ISongcastResendReporter& aReporter)
+{
+    iSongcastResendReporter = &aReporter;
 }
 
 void ProviderDebug::GetLog(IDvInvocation& aInvocation, IDvInvocationResponseString& aLog)
@@ -194,3 +201,15 @@ void ProviderDebug::GetRecentMSearches(IDvInvocation& aInvocation, IDvInvocation
     aJsonArray.WriteFlush();
     aInvocation.EndResponse();
 }
+
+void ProviderDebug::GetSongcastResends(IDvInvocation& aInvocation, IDvInvocationResponseString& aJsonArray)
+{
+    aInvocation.StartResponse();
+    WriterJsonArray writerArray(aJsonArray);
+    if (iSongcastResendReporter != nullptr) {
+        iSongcastResendReporter->WriteResendStats(writerArray);
+    }
+    writerArray.WriteEnd();
+    aJsonArray.WriteFlush();
+    aInvocation.EndResponse();
+}
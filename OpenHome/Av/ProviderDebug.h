@@ -5,6 +5,7 @@
 #include <OpenHome/Optional.h>
 #include <OpenHome/Private/Thread.h>
 #include <OpenHome/Net/Private/Discovery.h>
+#include <OpenHome/Av/Songcast/ResendReporter.h>
 
 #include <utility>
 #include <vector>
@@ -48,16 +49,19 @@ class ProviderDebug : public Net::DvProviderAvOpenhomeOrgDebug2
 {
 public:
     ProviderDebug(Net::DvDevice& aDevice, RingBufferLogger& aLogger, Optional<ILogPoster> aLogPoster);
+    void SetSongcastResendReporter(ISongcastResendReporter& aReporter);
 private: // from DvProviderAvOpenhomeOrgDebug2
     void GetLog(Net::IDvInvocation& aInvocation, Net::IDvInvocationResponseString& aLog) override;
     void SendLog(Net::IDvInvocation& aInvocation, const Brx& aData) override;
     void SendDeviceAnnouncements(Net::IDvInvocation& aInvocation) override;
     void GetRecentMSearches(Net::IDvInvocation& aInvocation, Net::IDvInvocationResponseString& aJsonArray) override;
+    void GetSongcastResends(Net::IDvInvocation& aInvocation, Net::IDvInvocationResponseString& aJsonArray) override;
 private:
     RingBufferLogger& iLogger;
     Optional<ILogPoster> iLogPoster;
     Net::DvStack& iDvStack;
     MSearchObserver iMSearchObserver;
+    ISongcastResendReporter* iSongcastResendReporter;
 };
 
 } // namespace Av
@@ -8,7 +8,6 @@
 #include <vector>
 
 #include "openssl/rsa.h"
-#include "openssl/aes.h"
 
 
 using namespace OpenHome;
@@ -396,9 +395,6 @@ void ProviderOAuth::SetToken(IDvInvocation& aInvocation,
         return;
     }
 
-    AES_KEY aesKey;
-    AES_set_decrypt_key(aesKeyData, 128, &aesKey);
-
     unsigned char initVector[16];
     decryptedLen = RSA_private_decrypt(aInitVectorRsaEncrypted.Bytes(),
                                        aInitVectorRsaEncrypted.Ptr(),
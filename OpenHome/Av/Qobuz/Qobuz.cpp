@@ -288,7 +288,7 @@ QobuzTrack* Qobuz::StreamableTrack(const Brx& aTrackId)
     if (!TryGetFileUrlLocked(aTrackId)) {
         return nullptr;
     }
-    JsonParser parser;
+    JsonParserTape parser;
     parser.Parse(iResponseBody.Buffer());
     const TUint trackId = (TUint)parser.Num("track_id");
     const Brn url = parser.String(kTagFileUrl);
@@ -322,7 +322,7 @@ TBool Qobuz::TryUpdateStreamUrl(QobuzTrack& aTrack)
     if (!TryGetFileUrlLocked(trackId)) {
         return false;
     }
-    JsonParser parser;
+    JsonParserTape parser;
     parser.Parse(iResponseBody.Buffer());
 
     const Brn url = parser.String(kTagFileUrl);
@@ -660,19 +660,17 @@ TBool Qobuz::TryLoginLocked()
         iReaderEntity.ReadAll(iResponseBody);
 		const Brx& resp = iResponseBody.Buffer();
         try {
-			JsonParser parser;
+			JsonParserTape parser;
 			parser.Parse(resp);
 			iAuthToken.Replace(parser.String(kUserAuthToken));
 			iUserId = 0;
 			iCredentialId = 0;
-            JsonParser parserUser;
-            parserUser.Parse(parser.String("user"));
-            iUserId = parserUser.Num("id");
-            JsonParser parserCred;
-            parserCred.Parse(parserUser.String("credential"));
-
-            if (!parserCred.IsNull("id")) {
-                iCredentialId = parserCred.Num("id");
+            const JsonTapeValue user = parser.Get("user");
+            iUserId = user.Num("id");
+            const JsonTapeValue cred = user.Get("credential");
+
+            if (!cred.IsNull("id")) {
+                iCredentialId = cred.Num("id");
             }
             else {
                 LOG(kPipeline, "Qobuz: Returned user has no 'CredentialId' present. Assuming no active subscription and defaulting to '%d'\n", iCredentialId);
@@ -1007,7 +1005,7 @@ TBool Qobuz::TryGetTrackFavouriteStatusLocked(const Brx& aTrackId, TBool& aIsFav
         iResponseBody.Reset();
         iReaderEntity.ReadAll(iResponseBody);
 
-        JsonParser parser;
+        JsonParserTape parser;
         parser.Parse(iResponseBody.Buffer());
         if (parser.HasKey("status")) {
             aIsFavourite = parser.Bool("status");
@@ -51,7 +51,7 @@ QobuzMetadata::QobuzMetadata(Media::TrackFactory& aTrackFactory)
 {
 }
 
-Media::Track* QobuzMetadata::TrackFromJson(TBool aHasParentMetadata, const ParentMetadata& aParentMetadata, const Brx& aTrackObj)
+Media::Track* QobuzMetadata::TrackFromJson(TBool aHasParentMetadata, const ParentMetadata& aParentMetadata, const JsonTapeValue& aTrackObj)
 {
     try {
         ParseQobuzMetadata(aHasParentMetadata, aParentMetadata, aTrackObj);
@@ -68,88 +68,81 @@ Media::Track* QobuzMetadata::TrackFromJson(TBool aHasParentMetadata, const Paren
     }
 }
 
-TBool QobuzMetadata::TryParseParentMetadata(const OpenHome::Brx& aJsonResponse, ParentMetadata& aParentMetadata)
+TBool QobuzMetadata::TryParseParentMetadata(const JsonTapeValue& aResponse, ParentMetadata& aParentMetadata)
 {
-    JsonParser parser;
-    JsonParser nestedParser;
-    parser.Parse(aJsonResponse);
+    JsonTapeValue nested;
 
-    if (!parser.HasKey("product_type")) {
+    if (!aResponse.HasKey("product_type")) {
         return false;
     }
 
     aParentMetadata.albumId = Brx::Empty();
     aParentMetadata.artistId = Brx::Empty();
 
-    if (parser.HasKey("id")) {
-        const Brx& productType = parser.String("product_type");
+    if (aResponse.HasKey("id")) {
+        const Brx& productType = aResponse.String("product_type");
         if (productType == Brn("artist")) {
-            aParentMetadata.artistId = parser.String("id");
+            aParentMetadata.artistId = aResponse.String("id");
         }
         else {
-            aParentMetadata.albumId = parser.String("id");
+            aParentMetadata.albumId = aResponse.String("id");
         }
     }
 
-    if (parser.HasKey("title")) {
-        aParentMetadata.title = UnescapeJsonInPlace(parser.String("title"));
+    if (aResponse.HasKey("title")) {
+        aParentMetadata.title = UnescapeJsonInPlace(aResponse.String("title"));
     }
 
-    if (parser.HasKey("artist")) {
-        nestedParser.Parse(parser.String("artist"));
-        if (nestedParser.HasKey("name")) {
-            aParentMetadata.artist = UnescapeJsonInPlace(nestedParser.String("name"));
+    if (aResponse.TryGet(Brn("artist"), nested)) {
+        if (nested.HasKey("name")) {
+            aParentMetadata.artist = UnescapeJsonInPlace(nested.String("name"));
         }
 
-        if (nestedParser.HasKey("id")) {
-            aParentMetadata.artistId = nestedParser.String("id");
+        if (nested.HasKey("id")) {
+            aParentMetadata.artistId = nested.String("id");
         }
     }
 
-    if (parser.HasKey("album")) {
-        nestedParser.Parse(parser.String("album"));
-        if (nestedParser.HasKey("id")) {
-            aParentMetadata.albumId = nestedParser.String("id");
+    if (aResponse.TryGet(Brn("album"), nested)) {
+        if (nested.HasKey("id")) {
+            aParentMetadata.albumId = nested.String("id");
         }
     }
 
-    if (parser.HasKey("image")) {
-        nestedParser.Parse(parser.String("image"));
-        if (nestedParser.HasKey("small")) {
-            aParentMetadata.smallArtworkUri = UnescapeJsonInPlace(nestedParser.String("small"));
+    if (aResponse.TryGet(Brn("image"), nested)) {
+        if (nested.HasKey("small")) {
+            aParentMetadata.smallArtworkUri = UnescapeJsonInPlace(nested.String("small"));
         }
 
-        if (nestedParser.HasKey("large")) {
-            aParentMetadata.largeArtworkUri = UnescapeJsonInPlace(nestedParser.String("large"));
+        if (nested.HasKey("large")) {
+            aParentMetadata.largeArtworkUri = UnescapeJsonInPlace(nested.String("large"));
         }
     }
 
     return true;
 }
 
-void QobuzMetadata::ParseQobuzMetadata(TBool aHasParentMetadata, const ParentMetadata& aParentMetadata, const Brx& aTrackObj)
+void QobuzMetadata::ParseQobuzMetadata(TBool aHasParentMetadata, const ParentMetadata& aParentMetadata, const JsonTapeValue& aTrackObj)
 {
     iTrackUri.Replace(Brx::Empty());
     iMetaDataDidl.Replace(Brx::Empty());
-    JsonParser parserTrack;             // Parses the track object - aTrackObj
-    JsonParser nestedParser;            // Parses object properties from the above
-    JsonParser nestedLevel2Parser;      // Sometimes there's another level of objects, so we need this parser as well. (Track -> Album -> Images)
+    JsonTapeValue nested;       // Object properties of aTrackObj
+    JsonTapeValue nestedLevel2; // Sometimes there's another level of objects (Track -> Album -> Images)
 
-    // First - parse the track object and ensure we have enough details to continue!
-    parserTrack.Parse(aTrackObj);
+    // First - ensure the track object has enough details to continue!
 
-    if (parserTrack.HasKey("streamable")) {
-        if (!parserTrack.Bool("streamable")) {
+    if (aTrackObj.HasKey("streamable")) {
+        if (!aTrackObj.Bool("streamable")) {
             THROW(QobuzResponseInvalid);
         }
     }
 
-    if (!parserTrack.HasKey("id")) {
+    if (!aTrackObj.HasKey("id")) {
         // track uri based on id, so will be invalid without one
         THROW(QobuzResponseInvalid);
     }
 
-    const Brx& itemId = parserTrack.String("id");
+    const Brn itemId = aTrackObj.String("id");
 
     // special linn style Qobuz url (non-streamable, gets converted later)
     iTrackUri.ReplaceThrow(Brn("qobuz://track?version=2&trackId="));
@@ -160,17 +153,17 @@ void QobuzMetadata::ParseQobuzMetadata(TBool aHasParentMetadata, const ParentMet
 
     // First - grab metadata from the track object directly.
     // We can use: Title, duration & track number
-    if (parserTrack.HasKey("title")) {
-        writer.WriteTitle(UnescapeJsonInPlace(parserTrack.String("title")));
+    if (aTrackObj.HasKey("title")) {
+        writer.WriteTitle(UnescapeJsonInPlace(aTrackObj.String("title")));
     }
 
-    if (parserTrack.HasKey("track_number")) {
-        writer.WriteTrackNumber(parserTrack.String("track_number"));
+    if (aTrackObj.HasKey("track_number")) {
+        writer.WriteTrackNumber(aTrackObj.String("track_number"));
     }
 
     WriterDIDLLite::StreamingDetails details;
     details.durationResolution = EDurationResolution::Seconds;
-    details.duration = parserTrack.HasKey("duration") ? parserTrack.Num("duration")
+    details.duration = aTrackObj.HasKey("duration") ? aTrackObj.Num("duration")
                                                       : 0;
     writer.WriteStreamingDetails(DIDLLite::kProtocolHttpGet, details, iTrackUri);
 
@@ -192,37 +185,32 @@ void QobuzMetadata::ParseQobuzMetadata(TBool aHasParentMetadata, const ParentMet
     else
     {
         // If no parent metadata, details are found in an 'Album' object
-        if (parserTrack.HasKey("album")) {
-            nestedParser.Parse(parserTrack.String("album"));
-
-            if (nestedParser.HasKey("id")) {
-                writer.WriteCustomMetadata("albumId", DIDLLite::kNameSpaceLinn, nestedParser.String("id"));
+        if (aTrackObj.TryGet(Brn("album"), nested)) {
+            if (nested.HasKey("id")) {
+                writer.WriteCustomMetadata("albumId", DIDLLite::kNameSpaceLinn, nested.String("id"));
             }
 
-            if (nestedParser.HasKey("title")) {
-                writer.WriteAlbum(UnescapeJsonInPlace(nestedParser.String("title")));
+            if (nested.HasKey("title")) {
+                writer.WriteAlbum(UnescapeJsonInPlace(nested.String("title")));
             }
 
-            if (nestedParser.HasKey("artist")) {
-                nestedLevel2Parser.Parse(nestedParser.String("artist"));
-                if (nestedLevel2Parser.HasKey("name")) {
-                    writer.WriteArtist(UnescapeJsonInPlace(nestedLevel2Parser.String("name")));
+            if (nested.TryGet(Brn("artist"), nestedLevel2)) {
+                if (nestedLevel2.HasKey("name")) {
+                    writer.WriteArtist(UnescapeJsonInPlace(nestedLevel2.String("name")));
                 }
 
-                if (nestedLevel2Parser.HasKey("id")) {
-                    writer.WriteCustomMetadata("artistId", DIDLLite::kNameSpaceLinn, nestedLevel2Parser.String("id"));
+                if (nestedLevel2.HasKey("id")) {
+                    writer.WriteCustomMetadata("artistId", DIDLLite::kNameSpaceLinn, nestedLevel2.String("id"));
                 }
             }
 
-            if (nestedParser.HasKey("image")) {
-                nestedLevel2Parser.Parse(nestedParser.String("image"));
-
-                if (nestedLevel2Parser.HasKey("small")) {
-                    writer.WriteArtwork(UnescapeJsonInPlace(nestedLevel2Parser.String("small")));
+            if (nested.TryGet(Brn("image"), nestedLevel2)) {
+                if (nestedLevel2.HasKey("small")) {
+                    writer.WriteArtwork(UnescapeJsonInPlace(nestedLevel2.String("small")));
                 }
 
-                if (nestedLevel2Parser.HasKey("large")) {
-                    writer.WriteArtwork(UnescapeJsonInPlace(nestedLevel2Parser.String("large")));
+                if (nestedLevel2.HasKey("large")) {
+                    writer.WriteArtwork(UnescapeJsonInPlace(nestedLevel2.String("large")));
                 }
             }
         }
@@ -10,7 +10,8 @@ EXCEPTION(QobuzRequestInvalid);
 
 namespace OpenHome {
     class Environment;
-    class JsonParser;
+    class JsonTape;
+    class JsonTapeValue;
 namespace Av {
 
 class QobuzMetadata : private OpenHome::INonCopyable
@@ -71,12 +72,12 @@ public:
 
 public:
     QobuzMetadata(OpenHome::Media::TrackFactory& aTrackFactory);
-    TBool TryParseParentMetadata(const OpenHome::Brx& aJsonResponse, ParentMetadata& aParentMetadata);
-    OpenHome::Media::Track* TrackFromJson(TBool aHasParentMetadata, const ParentMetadata& aJsonResponse, const OpenHome::Brx& aTrackObj);
+    TBool TryParseParentMetadata(const OpenHome::JsonTapeValue& aResponse, ParentMetadata& aParentMetadata);
+    OpenHome::Media::Track* TrackFromJson(TBool aHasParentMetadata, const ParentMetadata& aJsonResponse, const OpenHome::JsonTapeValue& aTrackObj);
     static const Brx& IdTypeToString(EIdType aType);
     static EIdType StringToIdType(const Brx& aString);
 private:
-    void ParseQobuzMetadata(TBool aHasParentMetadata, const ParentMetadata& aJsonResponse, const OpenHome::Brx& aTrackObj);
+    void ParseQobuzMetadata(TBool aHasParentMetadata, const ParentMetadata& aJsonResponse, const OpenHome::JsonTapeValue& aTrackObj);
 private:
     OpenHome::Media::TrackFactory& iTrackFactory;
     OpenHome::Media::BwsTrackUri iTrackUri;
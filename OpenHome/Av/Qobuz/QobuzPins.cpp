@@ -259,7 +259,7 @@ TBool QobuzPins::LoadTracks(const Brx& aPath, TBool aPinShuffle, EShuffleMode aS
 TBool QobuzPins::LoadContainers(const Brx& aPath, QobuzMetadata::EIdType aIdType, TBool aPinShuffled, EShuffleMode aShuffleMode)
 {
     AutoMutex _(iLock);
-    JsonParser parser;
+    JsonTape tape;
     InitPlaylist(aPinShuffled);
     TUint lastId = 0;
     TUint tracksFound = 0;
@@ -272,7 +272,7 @@ TBool QobuzPins::LoadContainers(const Brx& aPath, QobuzMetadata::EIdType aIdType
     const TBool shuffleLoadOrder = ShouldShuffleLoadOrder(aPinShuffled, aShuffleMode);
 
     TUint start, end;
-    TUint total = GetTotalItems(parser, aPath, QobuzMetadata::eNone, true, shuffleLoadOrder, start, end); // aIdType relevant to tracks, not containers
+    TUint total = GetTotalItems(tape, aPath, QobuzMetadata::eNone, true, shuffleLoadOrder, start, end); // aIdType relevant to tracks, not containers
     TUint offset = start;
 
     do {
@@ -284,23 +284,23 @@ TBool QobuzPins::LoadContainers(const Brx& aPath, QobuzMetadata::EIdType aIdType
             }
             UpdateOffset(total, end, true, offset);
             
-            parser.Reset();
-            parser.Parse(iJsonResponse.Buffer());
+            tape.Parse(iJsonResponse.Buffer());
             TUint idCount = 0;
 
-            FindResponse(parser);
+            const JsonTapeValue response = FindResponse(tape.Root());
 
-            auto parserItems = JsonParserArray::Create(parser.String(Brn("items")));
-            JsonParser parserItem;
+            JsonTapeIterator items = response.Get("items").Iterate();
+            JsonTapeValue item;
 
             for (TUint i = 0; i < kItemLimitPerRequest; i++) {
-                Brn obj;
-                if (!parserItems.TryNextObject(obj)) {
+                if (!items.Next(item) || item.IsNull()) {
                     break;
                 }
+                if (item.Type() != JsonTape::Type::Object) {
+                    THROW(JsonWrongType);
+                }
 
-                parserItem.Parse(obj);
-                containerIds[i].ReplaceThrow(parserItem.String(Brn("id"))); // parse response from Qobuz
+                containerIds[i].ReplaceThrow(item.String("id")); // parse response from Qobuz
                 idCount++;
                 if (containerIds[i].Bytes() == 0) {
                     return false;
@@ -344,14 +344,14 @@ TUint QobuzPins::LoadTracksById(const Brx& aId, QobuzMetadata::EIdType aIdType,
     TUint currId = aPlaylistId;
     TBool initPlay = (aPlaylistId == 0);
     TBool isPlayable = false;
-    JsonParser parser;
+    JsonTape tape;
     Media::Track* track = nullptr;
 
     const TBool shuffleLoadOrder = ShouldShuffleLoadOrder(aPinShuffled, aShuffleMode);
 
 
     TUint start, end;
-    TUint total = GetTotalItems(parser, aId, aIdType, false, shuffleLoadOrder, start, end);
+    TUint total = GetTotalItems(tape, aId, aIdType, false, shuffleLoadOrder, start, end);
     TUint offset = start;
 
     // id to list of tracks
@@ -372,25 +372,30 @@ TUint QobuzPins::LoadTracksById(const Brx& aId, QobuzMetadata::EIdType aIdType,
             }
             UpdateOffset(total, end, false, offset);
 
-            parser.Reset();
-            parser.Parse(iJsonResponse.Buffer());
+            tape.Parse(iJsonResponse.Buffer());
+            const JsonTapeValue root = tape.Root();
+            JsonTapeValue response = root;
 
-            if (parser.HasKey(kPropertyTracks)) {
-                parser.Parse(parser.String(kPropertyTracks));
+            if (root.HasKey(kPropertyTracks)) {
+                response = root.Get(kPropertyTracks);
             }
-            else if (parser.HasKey(kPropertyTracksAppearsOn)) {
-                parser.Parse(parser.String(kPropertyTracksAppearsOn));
+            else if (root.HasKey(kPropertyTracksAppearsOn)) {
+                response = root.Get(kPropertyTracksAppearsOn);
             }
 
             // Most Qobuz containers only provide required metadata in the parent container object, instead of the track objects directly.
             // We'll pre-parse the parent and provide that information when constructing tracks to reduce the amount of work we have to do.
-            const TBool hasParentMetadata = iQobuzMetadata.TryParseParentMetadata(iJsonResponse.Buffer(), iParentMetadata);
-
-            if (parser.HasKey("items")) {
-                auto parserItems = JsonParserArray::Create(parser.String("items"));
-                Brn obj;
-                while(parserItems.TryNextObject(obj)) {
-                    track = iQobuzMetadata.TrackFromJson(hasParentMetadata, iParentMetadata, obj);
+            const TBool hasParentMetadata = iQobuzMetadata.TryParseParentMetadata(root, iParentMetadata);
+
+            JsonTapeValue items;
+            if (response.TryGet(Brn("items"), items)) {
+                JsonTapeIterator it = items.Iterate();
+                JsonTapeValue item;
+                while(it.Next(item) && !item.IsNull()) {
+                    if (item.Type() != JsonTape::Type::Object) {
+                        THROW(JsonWrongType);
+                    }
+                    track = iQobuzMetadata.TrackFromJson(hasParentMetadata, iParentMetadata, item);
                     if (track != nullptr) {
                         aCount++;
                         iCpPlaylist->SyncInsert(currId, (*track).Uri(), (*track).MetaData(), newId);
@@ -406,7 +411,7 @@ TUint QobuzPins::LoadTracksById(const Brx& aId, QobuzMetadata::EIdType aIdType,
                 }
             }
             else {
-                track = iQobuzMetadata.TrackFromJson(hasParentMetadata, iParentMetadata, iJsonResponse.Buffer());
+                track = iQobuzMetadata.TrackFromJson(hasParentMetadata, iParentMetadata, root);
                 if (track != nullptr) {
                     aCount++;
                     iCpPlaylist->SyncInsert(currId, (*track).Uri(), (*track).MetaData(), newId);
@@ -441,7 +446,7 @@ TUint QobuzPins::LoadTracksById(const Brx& aId, QobuzMetadata::EIdType aIdType,
     return currId;
 }
 
-TUint QobuzPins::GetTotalItems(JsonParser& aParser, const Brx& aId, QobuzMetadata::EIdType aIdType, TBool aIsContainer, TBool aShouldShuffleLoadOrder, TUint& aStartIndex, TUint& aEndIndex)
+TUint QobuzPins::GetTotalItems(JsonTape& aTape, const Brx& aId, QobuzMetadata::EIdType aIdType, TBool aIsContainer, TBool aShouldShuffleLoadOrder, TUint& aStartIndex, TUint& aEndIndex)
 {
     // Track = single item
     if (aIdType == QobuzMetadata::eTrack) {
@@ -461,13 +466,12 @@ TUint QobuzPins::GetTotalItems(JsonParser& aParser, const Brx& aId, QobuzMetadat
             success = iQobuz.TryGetTracksById(iJsonResponse, aId, aIdType, 1, 0);
         }
         if (success) {
-            aParser.Reset();
-            aParser.Parse(iJsonResponse.Buffer());
+            aTape.Parse(iJsonResponse.Buffer());
 
-            FindResponse(aParser);
+            const JsonTapeValue response = FindResponse(aTape.Root());
 
-            if (aParser.HasKey(Brn("items"))) {
-                total = aParser.Num(Brn("total"));
+            if (response.HasKey(Brn("items"))) {
+                total = response.Num(Brn("total"));
             }
             else {
                 total = 1;
@@ -548,23 +552,25 @@ void QobuzPins::InitPlaylist(TBool aShuffle)
     iCpPlaylist->SyncSetShuffle(aShuffle);
 }
 
-void QobuzPins::FindResponse(JsonParser& aParser)
+JsonTapeValue QobuzPins::FindResponse(const JsonTapeValue& aResponse)
 {
-    if (aParser.HasKey(kPropertyAlbums)) {
-        aParser.Parse(aParser.String(kPropertyAlbums));
+    JsonTapeValue val;
+    if (aResponse.TryGet(kPropertyAlbums, val)) {
+        return val;
     }
-    else if (aParser.HasKey(kPropertyPlaylists)) {
-        aParser.Parse(aParser.String(kPropertyPlaylists));
+    else if (aResponse.TryGet(kPropertyPlaylists, val)) {
+        return val;
     }
-    else if (aParser.HasKey(kPropertyTracks)) {
-        aParser.Parse(aParser.String(kPropertyTracks));
+    else if (aResponse.TryGet(kPropertyTracks, val)) {
+        return val;
     }
-    else if (aParser.HasKey(kPropertyArtists)) {
-        aParser.Parse(aParser.String(kPropertyArtists));
+    else if (aResponse.TryGet(kPropertyArtists, val)) {
+        return val;
     }
-    else if (aParser.HasKey(kPropertyTracksAppearsOn)) {
-        aParser.Parse(aParser.String(kPropertyTracksAppearsOn));
+    else if (aResponse.TryGet(kPropertyTracksAppearsOn, val)) {
+        return val;
     }
+    return aResponse;
 }
 
 QobuzPins::EShuffleMode QobuzPins::GetShuffleMode(PinUri& aPinUri)
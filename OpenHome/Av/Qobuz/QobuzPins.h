@@ -18,6 +18,8 @@ namespace OpenHome {
     class Environment;
     class IThreadPool;
     class IThreadPoolHandle;
+    class JsonTape;
+    class JsonTapeValue;
 namespace Configuration {
     class IConfigInitialiser;
     class ConfigChoice;
@@ -62,11 +64,11 @@ private:
     TBool LoadByStringQuery(const Brx& aQuery, QobuzMetadata::EIdType aIdType, TBool aPinShuffle, EShuffleMode aShuffleMode);
     TUint LoadTracksById(const Brx& aId, QobuzMetadata::EIdType aIdType, TUint aPlaylistId, TUint& aCount, TBool aPinShuffle, EShuffleMode aShuffleMode);
 private: // helpers
-    TUint GetTotalItems(JsonParser& aParser, const Brx& aId, QobuzMetadata::EIdType aIdType, TBool aIsContainer, TBool aShouldShuffleLoadOrder, TUint& aStartIndex, TUint& aEndIndex);
+    TUint GetTotalItems(JsonTape& aTape, const Brx& aId, QobuzMetadata::EIdType aIdType, TBool aIsContainer, TBool aShouldShuffleLoadOrder, TUint& aStartIndex, TUint& aEndIndex);
     void UpdateOffset(TUint aTotalItems, TUint aEndIndex, TBool aIsContainer, TUint& aOffset);
     TBool IsValidId(const Brx& aRequest, QobuzMetadata::EIdType aIdType);
     void InitPlaylist(TBool aShuffle);
-    void FindResponse(JsonParser& aParser);
+    JsonTapeValue FindResponse(const JsonTapeValue& aResponse);
     EShuffleMode GetShuffleMode(PinUri& aPinUri);
     TBool ShouldShuffleLoadOrder(TBool aPinShuffled, EShuffleMode aShuffleMode);
 private:
@@ -1468,17 +1468,31 @@ void RaopAudioServer::Run()
 
 // RaopAudioDecryptor
 
+RaopAudioDecryptor::RaopAudioDecryptor()
+{
+    iCtx = EVP_CIPHER_CTX_new();
+    ASSERT(iCtx != nullptr);
+}
+
+RaopAudioDecryptor::~RaopAudioDecryptor()
+{
+    EVP_CIPHER_CTX_free(iCtx);
+}
+
 void RaopAudioDecryptor::Init(const Brx& aAesKey, const Brx& aAesInitVector)
 {
-    iKey.Replace(aAesKey);
+    ASSERT(aAesKey.Bytes() == kAesKeyBytes);
     iInitVector.Replace(aAesInitVector);
+    const int ret = EVP_DecryptInit_ex(iCtx, EVP_aes_128_cbc(), nullptr, aAesKey.Ptr(), nullptr);
+    ASSERT(ret == 1);
+    // Packets are a whole number of blocks of ciphertext followed by <16 bytes of clear audio; there is no padding.
+    (void)EVP_CIPHER_CTX_set_padding(iCtx, 0);
 }
 
 void RaopAudioDecryptor::Decrypt(const Brx& aEncryptedIn, Bwx& aAudioOut) const
 {
     //LOG(kMedia, ">RaopAudioDecryptor::Decrypt aEncryptedIn.Bytes(): %u\n", aEncryptedIn.Bytes());
-    ASSERT(iKey.Bytes() > 0);
-    ASSERT(iInitVector.Bytes() > 0);
+    ASSERT(iInitVector.Bytes() == kAesInitVectorBytes);
     ASSERT(aAudioOut.MaxBytes() >= kPacketSizeBytes+aEncryptedIn.Bytes());
 
     aAudioOut.SetBytes(0);
@@ -1486,14 +1500,18 @@ void RaopAudioDecryptor::Decrypt(const Brx& aEncryptedIn, Bwx& aAudioOut) const
     WriterBinary writerBinary(writerBuffer);
     writerBinary.WriteUint32Be(aEncryptedIn.Bytes());    // Write out payload size.
 
-    unsigned char* inBuf = const_cast<unsigned char*>(aEncryptedIn.Ptr());
+    const unsigned char* inBuf = aEncryptedIn.Ptr();
     unsigned char* outBuf = const_cast<unsigned char*>(aAudioOut.Ptr()+aAudioOut.Bytes());
-    unsigned char initVector[16];
-    memcpy(initVector, iInitVector.Ptr(), sizeof(initVector));  // Use same initVector at start of each decryption block.
-
-    AES_cbc_encrypt(inBuf, outBuf, aEncryptedIn.Bytes(), (AES_KEY*)iKey.Ptr(), initVector, AES_DECRYPT);
-    const TUint audioRemaining = aEncryptedIn.Bytes() % 16;
+    const TUint audioRemaining = aEncryptedIn.Bytes() % kAesBlockBytes;
     const TUint audioWritten = aEncryptedIn.Bytes()-audioRemaining;
+
+    // Use same initVector at start of each packet. The key schedule from Init() is reused.
+    int ret = EVP_DecryptInit_ex(iCtx, nullptr, nullptr, nullptr, iInitVector.Ptr());
+    ASSERT(ret == 1);
+    int decrypted = 0;
+    ret = EVP_DecryptUpdate(iCtx, outBuf, &decrypted, inBuf, (int)audioWritten);
+    ASSERT(ret == 1);
+    ASSERT(decrypted == (int)audioWritten);
     if (audioRemaining > 0) {
         // Copy remaining audio to outBuf if <16 bytes.
         memcpy(outBuf+audioWritten, inBuf+audioWritten, audioRemaining);
@@ -9,7 +9,7 @@
 #include <OpenHome/Media/Debug.h>
 
 #include  <openssl/rsa.h>
-#include  <openssl/aes.h>
+#include  <openssl/evp.h>
 
 EXCEPTION(InvalidRaopPacket)
 EXCEPTION(RepairerBufferFull)
@@ -200,17 +200,20 @@ private:
 // FIXME - this class currently writes out the packet length at the start of decoded audio.
 // That shouldn't be a responsibility of a generic decryptor.
 // Maybe have a chain of elements that write into the same buffer (i.e., one element to write the packet length at the start, then pass onto decryptor to decrypt the audio into the buffer).
-class RaopAudioDecryptor
+class RaopAudioDecryptor : private INonCopyable
 {
 private:
-    static const TUint kAesKeyBytes = sizeof(AES_KEY);
+    static const TUint kAesKeyBytes = 16;
+    static const TUint kAesBlockBytes = 16;
     static const TUint kAesInitVectorBytes = 16;
     static const TUint kPacketSizeBytes = sizeof(TUint);
 public:
+    RaopAudioDecryptor();
+    ~RaopAudioDecryptor();
     void Init(const Brx& aAesKey, const Brx& aAesInitVector);
     void Decrypt(const Brx& aEncryptedIn, Bwx& aAudioOut) const;
 private:
-    Bws<kAesKeyBytes> iKey;
+    EVP_CIPHER_CTX* iCtx; // holds the key schedule, set up once per session in Init()
     Bws<kAesInitVectorBytes> iInitVector;
 };
 
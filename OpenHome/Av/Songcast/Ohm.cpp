@@ -32,7 +32,7 @@ void OhmHeader::Internalise(IReader& aReader)
         THROW(OhmError);
     }
     iMsgType  = reader.ReadUintBe(1);
-    if(iMsgType > kMsgTypeResend && iMsgType != kMsgTypeAudioBlob) {
+    if(iMsgType > kMsgTypeFec && iMsgType != kMsgTypeAudioBlob) {
         THROW(OhmError);
     }
     iBytes = reader.ReadUintBe(2);
@@ -326,6 +326,133 @@ void OhmHeaderResend::Externalise(IWriter& aWriter) const
 
     writer.WriteUint32Be(iFramesCount);
 }
+
+
+
+// OhmHeaderCapabilities
+
+OhmHeaderCapabilities::OhmHeaderCapabilities()
+    : iMaxFecGroupFrames(0)
+    , iCodecs(0)
+{
+}
+
+OhmHeaderCapabilities::OhmHeaderCapabilities(TUint aMaxFecGroupFrames, TUint aCodecs)
+    : iMaxFecGroupFrames(aMaxFecGroupFrames)
+    , iCodecs(aCodecs)
+{
+}
+
+void OhmHeaderCapabilities::Internalise(IReader& aReader, const OhmHeader& aHeader)
+{
+    ASSERT (aHeader.MsgType() == OhmHeader::kMsgTypeJoin || aHeader.MsgType() == OhmHeader::kMsgTypeListen);
+
+    ReaderBinary readerBinary(aReader);
+
+    iMaxFecGroupFrames = readerBinary.ReadUintBe(1);
+    iCodecs = readerBinary.ReadUintBe(1);
+    (void)readerBinary.ReadUintBe(2); // reserved
+}
+
+void OhmHeaderCapabilities::Externalise(IWriter& aWriter) const
+{
+    WriterBinary writer(aWriter);
+
+    writer.WriteUint8(iMaxFecGroupFrames);
+    writer.WriteUint8(iCodecs);
+    writer.WriteUint16Be(0);
+}
+
+
+
+// OhmHeaderReception
+
+OhmHeaderReception::OhmHeaderReception()
+    : iJitterUs(0)
+    , iSpreadUs(0)
+    , iFramesExpected(0)
+    , iFramesLost(0)
+{
+}
+
+OhmHeaderReception::OhmHeaderReception(TUint aJitterUs, TUint aSpreadUs, TUint aFramesExpected, TUint aFramesLost)
+    : iJitterUs(aJitterUs)
+    , iSpreadUs(aSpreadUs)
+    , iFramesExpected(aFramesExpected > 0xffff? 0xffff : aFramesExpected)
+    , iFramesLost(aFramesLost > iFramesExpected? iFramesExpected : aFramesLost)
+{
+}
+
+void OhmHeaderReception::Internalise(IReader& aReader, const OhmHeader& aHeader)
+{
+    ASSERT (aHeader.MsgType() == OhmHeader::kMsgTypeListen);
+
+    ReaderBinary readerBinary(aReader);
+
+    iJitterUs = readerBinary.ReadUintBe(4);
+    iSpreadUs = readerBinary.ReadUintBe(4);
+    iFramesExpected = readerBinary.ReadUintBe(2);
+    iFramesLost = readerBinary.ReadUintBe(2);
+}
+
+void OhmHeaderReception::Externalise(IWriter& aWriter) const
+{
+    WriterBinary writer(aWriter);
+
+    writer.WriteUint32Be(iJitterUs);
+    writer.WriteUint32Be(iSpreadUs);
+    writer.WriteUint16Be(iFramesExpected);
+    writer.WriteUint16Be(iFramesLost);
+}
+
+
+
+// OhmHeaderFec
+
+OhmHeaderFec::OhmHeaderFec()
+    : iFrameFirst(0)
+    , iGroupFrames(0)
+    , iFrameBytesXor(0)
+    , iParityBytes(0)
+{
+}
+
+OhmHeaderFec::OhmHeaderFec(TUint aFrameFirst, TUint aGroupFrames, TUint aFrameBytesXor, TUint aParityBytes)
+    : iFrameFirst(aFrameFirst)
+    , iGroupFrames(aGroupFrames)
+    , iFrameBytesXor(aFrameBytesXor)
+    , iParityBytes(aParityBytes)
+{
+}
+
+void OhmHeaderFec::Internalise(IReader& aReader, const OhmHeader& aHeader)
+{
+    ASSERT (aHeader.MsgType() == OhmHeader::kMsgTypeFec);
+    if (aHeader.MsgBytes() < kHeaderBytes) {
+        THROW(OhmError);
+    }
+
+    ReaderBinary readerBinary(aReader);
+
+    iFrameFirst = readerBinary.ReadUintBe(4);
+    iGroupFrames = readerBinary.ReadUintBe(1);
+    (void)readerBinary.ReadUintBe(1); // reserved
+    iFrameBytesXor = readerBinary.ReadUintBe(2);
+    iParityBytes = aHeader.MsgBytes() - kHeaderBytes;
+    if (iGroupFrames < 2) {
+        THROW(OhmError);
+    }
+}
+
+void OhmHeaderFec::Externalise(IWriter& aWriter) const
+{
+    WriterBinary writer(aWriter);
+
+    writer.WriteUint32Be(iFrameFirst);
+    writer.WriteUint8(iGroupFrames);
+    writer.WriteUint8(0);
+    writer.WriteUint16Be(iFrameBytesXor);
+}
     
     
 
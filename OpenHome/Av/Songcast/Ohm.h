@@ -38,6 +38,7 @@ public:
     static const TUint kMsgTypeMetatext = 5;
     static const TUint kMsgTypeSlave = 6;
     static const TUint kMsgTypeResend = 7;
+    static const TUint kMsgTypeFec = 8;
     static const TUint kMsgTypeAudioBlob = 255; // locally generated, is never sent over the network
 
 public:
@@ -260,6 +261,98 @@ private:
     TUint iFramesCount;
 };
 
+class OhmHeaderCapabilities
+{
+public:
+    static const TUint kHeaderBytes = 4;
+    static const TUint kCodecFlac = 1 << 0;
+
+public:
+    OhmHeaderCapabilities();
+    OhmHeaderCapabilities(TUint aMaxFecGroupFrames, TUint aCodecs);
+
+    void Internalise(IReader& aReader, const OhmHeader& aHeader);
+    void Externalise(IWriter& aWriter) const;
+
+    TUint MaxFecGroupFrames() const {return iMaxFecGroupFrames;}
+    TUint Codecs() const {return iCodecs;}
+    TUint MsgBytes() const {return kHeaderBytes;}
+
+private:
+    // Optional payload of Join and Listen msgs, advertising optional features a receiver supports
+    //Offset    Bytes                   Desc
+    //0         1                       Max frames per Fec parity group (0 = Fec not supported)
+    //1         1                       Audio payload encodings supported, in addition to PCM (bitmask of kCodec*)
+    //2         2                       Reserved (0)
+
+    TUint iMaxFecGroupFrames;
+    TUint iCodecs;
+};
+
+class OhmHeaderReception
+{
+public:
+    static const TUint kHeaderBytes = 12;
+
+public:
+    OhmHeaderReception();
+    OhmHeaderReception(TUint aJitterUs, TUint aSpreadUs, TUint aFramesExpected, TUint aFramesLost);
+
+    void Internalise(IReader& aReader, const OhmHeader& aHeader);
+    void Externalise(IWriter& aWriter) const;
+
+    TUint JitterUs() const {return iJitterUs;}
+    TUint SpreadUs() const {return iSpreadUs;}
+    TUint FramesExpected() const {return iFramesExpected;}
+    TUint FramesLost() const {return iFramesLost;}
+    TUint MsgBytes() const {return kHeaderBytes;}
+
+private:
+    // Optional payload of Listen msgs, following OhmHeaderCapabilities.  Describes audio received since the previous Listen
+    //Offset    Bytes                   Desc
+    //0         4                       Interarrival jitter (us, as estimated by RFC 3550)
+    //4         4                       Difference between the longest and shortest transit times (us)
+    //8         2                       Frames expected
+    //10        2                       Frames lost (excluding resends)
+
+    TUint iJitterUs;
+    TUint iSpreadUs;
+    TUint iFramesExpected;
+    TUint iFramesLost;
+};
+
+class OhmHeaderFec
+{
+public:
+    static const TUint kHeaderBytes = 8;
+
+public:
+    OhmHeaderFec();
+    OhmHeaderFec(TUint aFrameFirst, TUint aGroupFrames, TUint aFrameBytesXor, TUint aParityBytes);
+
+    void Internalise(IReader& aReader, const OhmHeader& aHeader);
+    void Externalise(IWriter& aWriter) const;
+
+    TUint FrameFirst() const {return iFrameFirst;}
+    TUint GroupFrames() const {return iGroupFrames;}
+    TUint FrameBytesXor() const {return iFrameBytesXor;}
+    TUint ParityBytes() const {return iParityBytes;}
+    TUint MsgBytes() const {return (kHeaderBytes + iParityBytes);}
+
+private:
+    //Offset    Bytes                   Desc
+    //0         4                       First frame in parity group
+    //4         1                       Frames in parity group (k)
+    //5         1                       Reserved (0)
+    //6         2                       Xor of the sizes of all k audio msgs
+    //8         n                       Xor of all k audio msgs (resent flag cleared, zero padded to n bytes)
+
+    TUint iFrameFirst;
+    TUint iGroupFrames;
+    TUint iFrameBytesXor;
+    TUint iParityBytes;
+};
+
 class OhzHeader
 {
 public:
@@ -0,0 +1,260 @@
+#include <OpenHome/Av/Songcast/OhmFec.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Converter.h>
+#include <OpenHome/Av/Songcast/Ohm.h>
+#include <OpenHome/Av/Songcast/OhmMsg.h>
+
+#include <cstring>
+
+using namespace OpenHome;
+using namespace OpenHome::Av;
+
+// OhmFec
+
+void OhmFec::Accumulate(Bwx& aParity, const Brx& aBytes)
+{
+    const TUint bytes = aBytes.Bytes();
+    ASSERT(bytes <= aParity.MaxBytes());
+    TByte* dst = const_cast<TByte*>(aParity.Ptr());
+    if (bytes > aParity.Bytes()) {
+        // shorter msgs are treated as if zero padded to the length of the longest
+        (void)memset(dst + aParity.Bytes(), 0, bytes - aParity.Bytes());
+        aParity.SetBytes(bytes);
+    }
+    const TByte* src = aBytes.Ptr();
+    for (TUint i = 0; i < bytes; i++) {
+        dst[i] ^= src[i];
+    }
+}
+
+void OhmFec::AccumulateFrame(Bwx& aParity, const Brx& aFrameBytes)
+{
+    /* Resent copies of a frame differ from the original only in their flags byte.
+       Clear the resent flag so that the original and any resends contribute identical bytes. */
+    static const TUint kFlagsIndex = OhmHeader::kHeaderBytes + 1; // +1 to skip audio header length
+    Accumulate(aParity, aFrameBytes);
+    if (aFrameBytes.Bytes() > kFlagsIndex && (aFrameBytes[kFlagsIndex] & OhmMsgAudio::kFlagResent) != 0) {
+        aParity[kFlagsIndex] ^= OhmMsgAudio::kFlagResent;
+    }
+}
+
+
+// OhmFecEncoder
+
+OhmFecEncoder::OhmFecEncoder()
+    : iGroupFrames(0)
+{
+    Reset();
+}
+
+void OhmFecEncoder::SetGroupFrames(TUint aGroupFrames)
+{
+    ASSERT(aGroupFrames <= OhmFec::kMaxGroupFrames);
+    iGroupFrames = (aGroupFrames < 2? 0 : aGroupFrames);
+    Reset();
+}
+
+TUint OhmFecEncoder::GroupFrames() const
+{
+    return iGroupFrames;
+}
+
+void OhmFecEncoder::Reset()
+{
+    iFrameFirst = 0;
+    iFramesAdded = 0;
+    iFrameBytesXor = 0;
+    iParity.SetBytes(0);
+}
+
+TBool OhmFecEncoder::Add(TUint aFrame, const Brx& aFrameBytes)
+{
+    if (iGroupFrames == 0) {
+        return false;
+    }
+    if (aFrame % iGroupFrames == 0) {
+        Reset();
+        iFrameFirst = aFrame;
+    }
+    else if (iFramesAdded == 0 || aFrame != iFrameFirst + iFramesAdded) {
+        // joined part way through a group or frames were skipped; wait for the next group
+        iFramesAdded = 0;
+        return false;
+    }
+    if (aFrameBytes.Bytes() > OhmFec::kMaxFrameBytes) {
+        iFramesAdded = 0;
+        return false;
+    }
+    OhmFec::AccumulateFrame(iParity, aFrameBytes);
+    iFrameBytesXor ^= aFrameBytes.Bytes();
+    return (++iFramesAdded == iGroupFrames);
+}
+
+void OhmFecEncoder::Externalise(IWriter& aWriter) const
+{
+    ASSERT(iGroupFrames > 0 && iFramesAdded == iGroupFrames);
+    OhmHeaderFec headerFec(iFrameFirst, iGroupFrames, iFrameBytesXor, iParity.Bytes());
+    OhmHeader header(OhmHeader::kMsgTypeFec, headerFec.MsgBytes());
+    header.Externalise(aWriter);
+    headerFec.Externalise(aWriter);
+    aWriter.Write(iParity);
+}
+
+
+// OhmFecDecoder
+
+OhmFecDecoder::OhmFecDecoder()
+    : iGroupFrames(0)
+    , iFramesRecovered(0)
+{
+}
+
+void OhmFecDecoder::Reset()
+{
+    for (TUint i = 0; i < kMaxGroups; i++) {
+        iGroups[i].Clear();
+    }
+    iRecovered.Set(Brx::Empty());
+}
+
+TUint OhmFecDecoder::GroupFrames() const
+{
+    return iGroupFrames;
+}
+
+TBool OhmFecDecoder::AddFrame(TUint aFrame, const Brx& aFrameBytes)
+{
+    if (iGroupFrames == 0 || aFrameBytes.Bytes() > OhmFec::kMaxFrameBytes) {
+        return false;
+    }
+    Group* group = FindGroup(aFrame - (aFrame % iGroupFrames));
+    if (group == nullptr || group->iComplete) {
+        return false;
+    }
+    const TUint bit = 1 << (aFrame - group->iFrameFirst);
+    if ((group->iReceived & bit) != 0) {
+        return false; // duplicate
+    }
+    OhmFec::AccumulateFrame(group->iAccumulator, aFrameBytes);
+    group->iFrameBytesXor ^= aFrameBytes.Bytes();
+    group->iReceived |= bit;
+    if (++group->iReceivedCount == iGroupFrames) {
+        group->iComplete = true;
+        return false;
+    }
+    return TryRecover(*group);
+}
+
+TBool OhmFecDecoder::AddParity(const OhmHeaderFec& aHeader, const Brx& aParity)
+{
+    const TUint groupFrames = aHeader.GroupFrames();
+    if (groupFrames < 2 || groupFrames > OhmFec::kMaxGroupFrames ||
+        aParity.Bytes() > OhmFec::kMaxFrameBytes || aHeader.FrameFirst() % groupFrames != 0) {
+        return false;
+    }
+    if (groupFrames != iGroupFrames) {
+        Reset();
+        iGroupFrames = groupFrames;
+    }
+    Group* group = FindGroup(aHeader.FrameFirst());
+    if (group == nullptr || group->iComplete || group->iParity) {
+        return false;
+    }
+    OhmFec::Accumulate(group->iAccumulator, aParity);
+    group->iFrameBytesXor ^= aHeader.FrameBytesXor();
+    group->iParity = true;
+    return TryRecover(*group);
+}
+
+const Brx& OhmFecDecoder::Recovered() const
+{
+    return iRecovered;
+}
+
+TUint OhmFecDecoder::FramesRecovered() const
+{
+    return iFramesRecovered;
+}
+
+OhmFecDecoder::Group* OhmFecDecoder::FindGroup(TUint aFrameFirst)
+{
+    Group* unused = nullptr;
+    Group* oldest = nullptr;
+    for (TUint i = 0; i < kMaxGroups; i++) {
+        Group& group = iGroups[i];
+        if (!group.iInUse) {
+            unused = &group;
+        }
+        else if (group.iFrameFirst == aFrameFirst) {
+            return &group;
+        }
+        else if (oldest == nullptr || (TInt)(group.iFrameFirst - oldest->iFrameFirst) < 0) {
+            oldest = &group;
+        }
+    }
+    Group* group = unused;
+    if (group == nullptr) {
+        if ((TInt)(aFrameFirst - oldest->iFrameFirst) < 0) {
+            return nullptr; // older than any group we're tracking; it'll have been repaired by resend
+        }
+        group = oldest;
+    }
+    group->Reset(aFrameFirst);
+    return group;
+}
+
+TBool OhmFecDecoder::TryRecover(Group& aGroup)
+{
+    if (!aGroup.iParity || aGroup.iReceivedCount != iGroupFrames - 1) {
+        return false;
+    }
+    aGroup.iComplete = true;
+
+    TUint index = 0;
+    while ((aGroup.iReceived & (1 << index)) != 0) {
+        index++;
+    }
+    static const TUint kFrameIndex = OhmHeader::kHeaderBytes + 4; // Frame follows audio header length, flags and samples
+    const TUint bytes = aGroup.iFrameBytesXor;
+    if (bytes < kFrameIndex + 4 || bytes > aGroup.iAccumulator.Bytes()) {
+        return false;
+    }
+    Brn frame(aGroup.iAccumulator.Ptr(), bytes);
+    if (frame.Split(0, 4) != OhmHeader::kOhm ||
+        frame[5] != OhmHeader::kMsgTypeAudio ||
+        Converter::BeUint16At(frame, 6) != bytes ||
+        Converter::BeUint32At(frame, kFrameIndex) != aGroup.iFrameFirst + index) {
+        return false;
+    }
+    iRecovered.Set(frame);
+    iFramesRecovered++;
+    return true;
+}
+
+
+// OhmFecDecoder::Group
+
+OhmFecDecoder::Group::Group()
+{
+    Clear();
+}
+
+void OhmFecDecoder::Group::Reset(TUint aFrameFirst)
+{
+    iInUse = true;
+    iParity = false;
+    iComplete = false;
+    iFrameFirst = aFrameFirst;
+    iReceived = 0;
+    iReceivedCount = 0;
+    iFrameBytesXor = 0;
+    iAccumulator.SetBytes(0);
+}
+
+void OhmFecDecoder::Group::Clear()
+{
+    Reset(0);
+    iInUse = false;
+}
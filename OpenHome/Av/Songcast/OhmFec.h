@@ -0,0 +1,100 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Av/Songcast/Ohm.h>
+#include <OpenHome/Av/Songcast/OhmMsg.h>
+
+namespace OpenHome {
+namespace Av {
+
+/*
+ * Forward error correction for Songcast audio.
+ *
+ * Audio frames are split into parity groups of k consecutive frames, the first of
+ * which has a frame number that is a multiple of k.  Once all k frames of a group have
+ * been sent, the sender also sends a single Fec msg holding the xor of the serialised
+ * frames.  A receiver that has seen any k-1 frames of a group, plus its Fec msg, can
+ * rebuild the remaining frame without waiting for a resend.
+ *
+ * Receivers advertise the largest group they can decode in Join/Listen msgs.  Senders
+ * only generate Fec msgs once every receiver heard from recently has advertised support.
+ */
+
+class OhmFec
+{
+public:
+    static const TUint kMaxGroupFrames = 16;
+    static const TUint kMaxFrameBytes = OhmMsgAudio::kStreamHeaderBytes + OhmMsgAudio::kMaxAudioBytes;
+    static const TUint kMaxMsgBytes = OhmHeader::kHeaderBytes + OhmHeaderFec::kHeaderBytes + kMaxFrameBytes;
+public:
+    static void Accumulate(Bwx& aParity, const Brx& aBytes);
+    static void AccumulateFrame(Bwx& aParity, const Brx& aFrameBytes); // ignores any resent flag in aFrameBytes
+};
+
+class OhmFecEncoder
+{
+public:
+    OhmFecEncoder();
+    void SetGroupFrames(TUint aGroupFrames); // 0 disables encoding
+    TUint GroupFrames() const;
+    void Reset();
+    /*
+     * Add a serialised audio frame.  Returns true if this completes a parity group,
+     * in which case Externalise() should be called before the next frame is added.
+     */
+    TBool Add(TUint aFrame, const Brx& aFrameBytes);
+    void Externalise(IWriter& aWriter) const;
+private:
+    TUint iGroupFrames;
+    TUint iFrameFirst;
+    TUint iFramesAdded;
+    TUint iFrameBytesXor;
+    Bws<OhmFec::kMaxFrameBytes> iParity;
+};
+
+class OhmFecDecoder
+{
+    static const TUint kMaxGroups = 4;
+public:
+    OhmFecDecoder();
+    void Reset();
+    TUint GroupFrames() const; // 0 if no Fec msgs have been seen
+    /*
+     * Both Add functions return true if they allowed a missing frame to be rebuilt.
+     * The serialised frame is then available from Recovered() until the next call to either.
+     */
+    TBool AddFrame(TUint aFrame, const Brx& aFrameBytes);
+    TBool AddParity(const OhmHeaderFec& aHeader, const Brx& aParity);
+    const Brx& Recovered() const;
+    TUint FramesRecovered() const;
+private:
+    class Group
+    {
+    public:
+        Group();
+        void Reset(TUint aFrameFirst);
+        void Clear();
+    public:
+        TBool iInUse;
+        TBool iParity;
+        TBool iComplete;
+        TUint iFrameFirst;
+        TUint iReceived; // bitmask of frames in group
+        TUint iReceivedCount;
+        TUint iFrameBytesXor;
+        Bws<OhmFec::kMaxFrameBytes> iAccumulator;
+    };
+private:
+    Group* FindGroup(TUint aFrameFirst);
+    TBool TryRecover(Group& aGroup);
+private:
+    TUint iGroupFrames;
+    Group iGroups[kMaxGroups];
+    Brn iRecovered;
+    TUint iFramesRecovered;
+};
+
+} // namespace Av
+} // namespace OpenHome
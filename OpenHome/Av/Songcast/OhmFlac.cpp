@@ -0,0 +1,159 @@
+#include <OpenHome/Av/Songcast/OhmFlac.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Printer.h>
+#include <OpenHome/Av/Debug.h>
+#include <OpenHome/Av/Songcast/OhmMsg.h>
+
+#include <FLAC/format.h>
+#include <FLAC/stream_encoder.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Av;
+
+// OhmFlac
+
+const Brn OhmFlac::kCodecName("Ohm-FLAC");
+
+TBool OhmFlac::IsSupported(TUint aBitDepth, TUint aChannels)
+{ // static
+    if (aBitDepth != 16 && aBitDepth != 24) {
+        return false;
+    }
+    return (aChannels > 0 && aChannels <= FLAC__MAX_CHANNELS);
+}
+
+void OhmFlac::WriteStreamHeader(Bwx& aBuf, TUint aSampleRate, TUint aBitDepth, TUint aChannels, TUint64 aSamplesTotal)
+{ // static
+    static const TUint kStreamInfoBytes = 34;
+    static const TUint kLastMetadataBlock = 0x80;
+    static const TUint64 kMaxSamplesTotal = (1LL << 36) - 1;
+
+    aBuf.SetBytes(0);
+    WriterBuffer wb(aBuf);
+    WriterBinary writer(wb);
+    writer.Write(Brn("fLaC"));
+    writer.WriteUint8(kLastMetadataBlock | FLAC__METADATA_TYPE_STREAMINFO);
+    writer.WriteUint8(0);
+    writer.WriteUint16Be(kStreamInfoBytes);
+
+    // Senders size each frame independently so advertise the widest range of block sizes.
+    // Frame sizes are unknown (0).
+    writer.WriteUint16Be(FLAC__MIN_BLOCK_SIZE);
+    writer.WriteUint16Be(FLAC__MAX_BLOCK_SIZE);
+    writer.WriteUint8(0);
+    writer.WriteUint16Be(0);
+    writer.WriteUint8(0);
+    writer.WriteUint16Be(0);
+
+    // sample rate (20 bits), channels-1 (3 bits), bit depth-1 (5 bits), total samples (36 bits; 0 = unknown)
+    const TUint64 samplesTotal = (aSamplesTotal > kMaxSamplesTotal? 0 : aSamplesTotal);
+    TUint64 packed = static_cast<TUint64>(aSampleRate) << 44;
+    packed |= static_cast<TUint64>(aChannels - 1) << 41;
+    packed |= static_cast<TUint64>(aBitDepth - 1) << 36;
+    packed |= samplesTotal;
+    writer.WriteUint64Be(packed);
+
+    // MD5 of the decoded audio is not known in advance; all zeros tells decoders not to check it
+    for (TUint i = 0; i < 4; i++) {
+        writer.WriteUint32Be(0);
+    }
+}
+
+
+// OhmFlacEncoder
+
+OhmFlacEncoder::OhmFlacEncoder()
+    : iSampleRate(0)
+    , iBitDepth(0)
+    , iChannels(0)
+    , iOutput(nullptr)
+    , iOverflow(false)
+{
+    iEncoder = FLAC__stream_encoder_new();
+    ASSERT(iEncoder != nullptr);
+}
+
+OhmFlacEncoder::~OhmFlacEncoder()
+{
+    FLAC__stream_encoder_delete(iEncoder);
+}
+
+void OhmFlacEncoder::SetFormat(TUint aSampleRate, TUint aBitDepth, TUint aChannels)
+{
+    iSampleRate = aSampleRate;
+    iBitDepth = aBitDepth;
+    iChannels = aChannels;
+}
+
+TBool OhmFlacEncoder::Encode(const Brx& aPcm, Bwx& aFlac)
+{
+    if (!OhmFlac::IsSupported(iBitDepth, iChannels)) {
+        return false;
+    }
+    const TUint bytesPerSample = iBitDepth / 8;
+    const TUint values = aPcm.Bytes() / bytesPerSample;
+    const TUint samples = values / iChannels;
+    if (samples == 0 || values > kMaxSamples) {
+        return false;
+    }
+
+    const TByte* src = aPcm.Ptr();
+    if (iBitDepth == 16) {
+        for (TUint i = 0; i < values; i++, src += 2) {
+            iSamples[i] = static_cast<TInt16>((src[0] << 8) | src[1]);
+        }
+    }
+    else {
+        for (TUint i = 0; i < values; i++, src += 3) {
+            const TInt32 subsample = (src[0] << 24) | (src[1] << 16) | (src[2] << 8);
+            iSamples[i] = subsample >> 8;
+        }
+    }
+
+    /* libFLAC holds back each block until it has seen the first sample of the next one.
+       Songcast can't wait for a later msg so run a complete (metadata-less) encode per msg,
+       with the block size matching the msg.  finish() flushes the only block. */
+    (void)FLAC__stream_encoder_set_verify(iEncoder, false);
+    (void)FLAC__stream_encoder_set_streamable_subset(iEncoder, false);
+    (void)FLAC__stream_encoder_set_compression_level(iEncoder, kCompressionLevel);
+    (void)FLAC__stream_encoder_set_channels(iEncoder, iChannels);
+    (void)FLAC__stream_encoder_set_bits_per_sample(iEncoder, iBitDepth);
+    (void)FLAC__stream_encoder_set_sample_rate(iEncoder, iSampleRate);
+    (void)FLAC__stream_encoder_set_blocksize(iEncoder, samples);
+
+    aFlac.SetBytes(0);
+    iOutput = &aFlac;
+    iOverflow = false;
+    if (FLAC__stream_encoder_init_stream(iEncoder, WriteCallback, nullptr, nullptr, nullptr, this) != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
+        LOG_ERROR(kSongcast, "OhmFlacEncoder: failed to initialise encoder (%u/%u/%u)\n", iSampleRate, iBitDepth, iChannels);
+        iOutput = nullptr;
+        return false;
+    }
+    TBool ok = FLAC__stream_encoder_process_interleaved(iEncoder, iSamples, samples);
+    ok = FLAC__stream_encoder_finish(iEncoder) && ok;
+    iOutput = nullptr;
+    return (ok && !iOverflow && aFlac.Bytes() > 0);
+}
+
+FLAC__StreamEncoderWriteStatus OhmFlacEncoder::WriteCallback(const FLAC__StreamEncoder* /*aEncoder*/, const FLAC__byte aBuffer[],
+                                                             size_t aBytes, unsigned aSamples, unsigned /*aCurrentFrame*/,
+                                                             void* aClientData)
+{ // static
+    return reinterpret_cast<OhmFlacEncoder*>(aClientData)->Write(aBuffer, aBytes, aSamples);
+}
+
+FLAC__StreamEncoderWriteStatus OhmFlacEncoder::Write(const FLAC__byte aBuffer[], size_t aBytes, unsigned aSamples)
+{
+    if (aSamples == 0) {
+        // stream marker and metadata.  Receivers synthesise their own so these aren't sent.
+        return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+    }
+    if (iOutput->Bytes() + aBytes > iOutput->MaxBytes()) {
+        iOverflow = true;
+        return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+    }
+    iOutput->Append(aBuffer, static_cast<TUint>(aBytes));
+    return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
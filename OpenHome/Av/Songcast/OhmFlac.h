@@ -0,0 +1,63 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Av/Songcast/OhmMsg.h>
+
+#include <FLAC/stream_encoder.h>
+
+namespace OpenHome {
+namespace Av {
+
+/*
+ * Lossless compression of Songcast audio.
+ *
+ * Each compressed audio msg carries a single FLAC frame holding exactly the samples the
+ * msg describes.  Frames therefore remain independently decodable, so resends and Fec
+ * work unchanged.  Compressed msgs are identified by a codec name of kCodecName.
+ *
+ * Receivers advertise support in Join/Listen msgs.  Senders only compress while every
+ * receiver heard from recently has advertised support.  Receivers prefix the frames they
+ * receive with a synthesised stream header and pass them to the pipeline's FLAC codec.
+ */
+
+class OhmFlac
+{
+public:
+    static const Brn kCodecName;
+    static const TUint kStreamHeaderBytes = 42; // "fLaC" marker, metadata block header, STREAMINFO
+public:
+    static TBool IsSupported(TUint aBitDepth, TUint aChannels);
+    static void WriteStreamHeader(Bwx& aBuf, TUint aSampleRate, TUint aBitDepth, TUint aChannels, TUint64 aSamplesTotal);
+};
+
+class OhmFlacEncoder
+{
+    static const TUint kCompressionLevel = 1;
+    static const TUint kMaxSamples = OhmMsgAudio::kMaxSampleBytes / 2; // all channels, assuming 16-bit
+public:
+    OhmFlacEncoder();
+    ~OhmFlacEncoder();
+    void SetFormat(TUint aSampleRate, TUint aBitDepth, TUint aChannels);
+    /*
+     * Encode a msg's worth of interleaved, big endian PCM as a single FLAC frame.
+     * Returns false if aPcm could not be encoded or the frame would not fit in aFlac.
+     */
+    TBool Encode(const Brx& aPcm, Bwx& aFlac);
+private:
+    static FLAC__StreamEncoderWriteStatus WriteCallback(const FLAC__StreamEncoder* aEncoder, const FLAC__byte aBuffer[],
+                                                        size_t aBytes, unsigned aSamples, unsigned aCurrentFrame,
+                                                        void* aClientData);
+    FLAC__StreamEncoderWriteStatus Write(const FLAC__byte aBuffer[], size_t aBytes, unsigned aSamples);
+private:
+    FLAC__StreamEncoder* iEncoder;
+    TUint iSampleRate;
+    TUint iBitDepth;
+    TUint iChannels;
+    FLAC__int32 iSamples[kMaxSamples];
+    Bwx* iOutput;
+    TBool iOverflow;
+};
+
+} // namespace Av
+} // namespace OpenHome
@@ -0,0 +1,294 @@
+#include <OpenHome/Av/Songcast/OhmLatency.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Av/Songcast/Ohm.h>
+
+#include <algorithm>
+
+using namespace OpenHome;
+using namespace OpenHome::Av;
+
+// OhmLatency
+
+TUint OhmLatency::RequiredMs(const OhmHeaderReception& aReception)
+{ // static
+    static const TUint kMaxNetworkUs = 10 * 1000 * 1000;
+    const TUint expected = aReception.FramesExpected();
+    if (expected == 0) {
+        return 0;
+    }
+    /* Audio must be buffered for long enough to cover the worst variation in arrival time.
+       The RFC 3550 estimate is an average so allow a multiple of it in case the reporting
+       period was too short to see the full range of delays. */
+    const TUint jitterUs = std::min(aReception.JitterUs(), kMaxNetworkUs);
+    const TUint networkUs = std::min(std::max(aReception.SpreadUs(), 4 * jitterUs), kMaxNetworkUs);
+    const TUint networkMs = (networkUs + 999) / 1000;
+
+    // each round of resend requests costs a further round trip over the same network
+    const TUint lost = aReception.FramesLost();
+    const TUint lossPerMille = lost * 1000 / expected;
+    TUint repairs = 0;
+    if (lost > 0) {
+        repairs = (lossPerMille < 10? 1 : (lossPerMille < 50? 2 : 3));
+    }
+    return kHeadroomMs + networkMs + repairs * (kRepairMs + networkMs);
+}
+
+
+// OhmReceptionMonitor
+
+OhmReceptionMonitor::OhmReceptionMonitor()
+    : iLock("OHRM")
+{
+    Reset();
+}
+
+void OhmReceptionMonitor::Reset()
+{
+    AutoMutex _(iLock);
+    iSampleRate = 0;
+    iSampleStart = 0;
+    iFrameValid = false;
+    iFrameNext = 0;
+    iFramesExpected = 0;
+    iFramesReceived = 0;
+    iTransitValid = false;
+    iTransit = 0;
+    iTransitMin = 0;
+    iTransitMax = 0;
+    iSpreadUs = 0;
+    iJitterUs16 = 0;
+}
+
+void OhmReceptionMonitor::Add(TUint aFrame, TUint64 aSampleStart, TUint aSampleRate, TBool aHalt, TUint64 aArrivalUs)
+{
+    if (aSampleRate == 0) {
+        return;
+    }
+    AutoMutex _(iLock);
+    const TInt frameDiff = (TInt)(aFrame - iFrameNext);
+    const TBool discontinuity = (!iFrameValid || aSampleRate != iSampleRate ||
+                                 frameDiff > (TInt)kMaxFrameGap || frameDiff < -(TInt)kMaxFrameGap ||
+                                 (frameDiff >= 0 && aSampleStart < iSampleStart));
+    if (discontinuity) {
+        iFrameValid = true;
+        iFrameNext = aFrame + 1;
+        iFramesExpected++;
+    }
+    else if (frameDiff >= 0) {
+        iFramesExpected += frameDiff + 1;
+        iFrameNext = aFrame + 1;
+    }
+    // else a frame that arrived out of order, already counted as expected
+    iFramesReceived++;
+    if (discontinuity || frameDiff >= 0) {
+        iSampleRate = aSampleRate;
+        iSampleStart = aSampleStart;
+    }
+
+    // transit time includes an unknown offset between sender and receiver clocks; only its variation is used
+    const TInt64 mediaUs = (TInt64)(aSampleStart * 1000000 / aSampleRate);
+    const TInt64 transit = (TInt64)aArrivalUs - mediaUs;
+    if (discontinuity || !iTransitValid) {
+        StartTransit(transit);
+    }
+    else {
+        TInt64 diff = transit - iTransit;
+        if (diff < 0) {
+            diff = -diff;
+        }
+        if (diff > kMaxTransitStepUs) {
+            StartTransit(transit);
+        }
+        else {
+            // J += (|D| - J) / 16
+            iJitterUs16 = iJitterUs16 - (iJitterUs16 >> 4) + (TUint)diff;
+            iTransit = transit;
+            iTransitMin = std::min(iTransitMin, transit);
+            iTransitMax = std::max(iTransitMax, transit);
+        }
+    }
+    iTransitValid = !aHalt; // the sender may leave a gap of any length after a halt
+}
+
+TUint OhmReceptionMonitor::RequiredLatencyMs() const
+{
+    AutoMutex _(iLock);
+    return OhmLatency::RequiredMs(ReportLocked());
+}
+
+OhmHeaderReception OhmReceptionMonitor::Report()
+{
+    AutoMutex _(iLock);
+    const OhmHeaderReception report = ReportLocked();
+    iFramesExpected = 0;
+    iFramesReceived = 0;
+    iSpreadUs = 0;
+    iTransitMin = iTransitMax = iTransit;
+    return report;
+}
+
+void OhmReceptionMonitor::StartTransit(TInt64 aTransit)
+{
+    // transit times from before a discontinuity can't be compared with those after it
+    iSpreadUs = std::max(iSpreadUs, (TUint)(iTransitMax - iTransitMin));
+    iTransit = iTransitMin = iTransitMax = aTransit;
+}
+
+OhmHeaderReception OhmReceptionMonitor::ReportLocked() const
+{
+    const TUint spreadUs = std::max(iSpreadUs, (TUint)(iTransitMax - iTransitMin));
+    const TUint lost = (iFramesExpected > iFramesReceived? iFramesExpected - iFramesReceived : 0);
+    return OhmHeaderReception(iJitterUs16 >> 4, spreadUs, iFramesExpected, lost);
+}
+
+
+// OhmLatencyController
+
+OhmLatencyController::OhmLatencyController()
+    : iCount(0)
+    , iMinMs(0)
+    , iMaxMs(0)
+    , iDefaultMs(0)
+    , iLatencyMs(0)
+    , iDecreasePending(false)
+    , iDecreaseStartMs(0)
+    , iDecreaseTargetMs(0)
+{
+}
+
+void OhmLatencyController::SetRange(TUint aMinMs, TUint aMaxMs, TUint aDefaultMs)
+{
+    const TBool wasEnabled = Enabled();
+    iMinMs = aMinMs;
+    iMaxMs = aMaxMs;
+    iDefaultMs = aDefaultMs;
+    iDecreasePending = false;
+    if (!Enabled()) {
+        iCount = 0;
+        iLatencyMs = 0;
+    }
+    else if (!wasEnabled) {
+        iLatencyMs = Clamp(aDefaultMs);
+    }
+    else {
+        iLatencyMs = Clamp(iLatencyMs);
+    }
+}
+
+TBool OhmLatencyController::Enabled() const
+{
+    return (iMaxMs > iMinMs);
+}
+
+TUint OhmLatencyController::LatencyMs() const
+{
+    return iLatencyMs;
+}
+
+void OhmLatencyController::Add(const Endpoint& aReceiver, const OhmHeaderReception& aReception, TUint aNowMs)
+{
+    const TUint requiredMs = OhmLatency::RequiredMs(aReception);
+    if (requiredMs > 0) { // ignore reports from receivers that haven't received any audio
+        Add(aReceiver, requiredMs, aNowMs);
+    }
+}
+
+void OhmLatencyController::AddLegacy(const Endpoint& aReceiver, TUint aNowMs)
+{
+    Add(aReceiver, iDefaultMs, aNowMs);
+}
+
+TBool OhmLatencyController::Update(TUint aNowMs)
+{
+    if (!Enabled()) {
+        return false;
+    }
+    TUint targetMs = 0;
+    for (TUint i = 0; i < iCount; ) {
+        Receiver& receiver = iReceivers[i];
+        if ((TInt)(aNowMs - receiver.iTimeMs) > (TInt)kReportLifetimeMs) {
+            iCount--;
+            receiver.iEndpoint.Replace(iReceivers[iCount].iEndpoint);
+            receiver.iRequiredMs = iReceivers[iCount].iRequiredMs;
+            receiver.iTimeMs = iReceivers[iCount].iTimeMs;
+        }
+        else {
+            targetMs = std::max(targetMs, receiver.iRequiredMs);
+            i++;
+        }
+    }
+    if (iCount == 0) {
+        // nothing to base a decision on.  Hold the current latency until receivers report again
+        iDecreasePending = false;
+        return false;
+    }
+    targetMs = Clamp(((targetMs + kStepMs - 1) / kStepMs) * kStepMs);
+
+    /* Raise latency as soon as any receiver needs it.  Only reduce it once reports have allowed
+       a useful reduction for some time, avoiding repeated changes for receivers whose reception varies. */
+    if (targetMs > iLatencyMs) {
+        iLatencyMs = targetMs;
+        iDecreasePending = false;
+        return true;
+    }
+    if (targetMs + kDecreaseMarginMs > iLatencyMs) {
+        iDecreasePending = false;
+        return false;
+    }
+    if (!iDecreasePending) {
+        iDecreasePending = true;
+        iDecreaseStartMs = aNowMs;
+        iDecreaseTargetMs = targetMs;
+        return false;
+    }
+    iDecreaseTargetMs = std::max(iDecreaseTargetMs, targetMs);
+    if ((TInt)(aNowMs - iDecreaseStartMs) < (TInt)kDecreaseHoldMs) {
+        return false;
+    }
+    iLatencyMs = iDecreaseTargetMs;
+    iDecreasePending = false;
+    return true;
+}
+
+void OhmLatencyController::Add(const Endpoint& aReceiver, TUint aRequiredMs, TUint aNowMs)
+{
+    if (!Enabled()) {
+        return;
+    }
+    Receiver* receiver = nullptr;
+    for (TUint i = 0; i < iCount; i++) {
+        if (iReceivers[i].iEndpoint.Equals(aReceiver)) {
+            receiver = &iReceivers[i];
+            break;
+        }
+    }
+    if (receiver == nullptr) {
+        if (iCount < kMaxReceivers) {
+            receiver = &iReceivers[iCount++];
+        }
+        else { // replace whichever receiver we've heard from least recently
+            receiver = &iReceivers[0];
+            for (TUint i = 1; i < iCount; i++) {
+                if ((TInt)(iReceivers[i].iTimeMs - receiver->iTimeMs) < 0) {
+                    receiver = &iReceivers[i];
+                }
+            }
+        }
+        receiver->iEndpoint.Replace(aReceiver);
+    }
+    receiver->iRequiredMs = aRequiredMs;
+    receiver->iTimeMs = aNowMs;
+}
+
+TUint OhmLatencyController::Clamp(TUint aLatencyMs) const
+{
+    if (aLatencyMs < iMinMs) {
+        return iMinMs;
+    }
+    if (aLatencyMs > iMaxMs) {
+        return iMaxMs;
+    }
+    return aLatencyMs;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Av/Songcast/Ohm.h>
+
+namespace OpenHome {
+namespace Av {
+
+/*
+ * Adaptive Songcast latency.
+ *
+ * Receivers measure how regularly audio arrives and how much of it is lost, reporting this
+ * to the sender in their Listen msgs (OhmHeaderReception).  The sender converts each report
+ * into the latency that receiver needs and advertises the highest of these, within bounds
+ * set by its owner.  Receivers already apply any change in advertised latency by ramping
+ * through their VariableDelay elements.
+ */
+
+class OhmLatency
+{
+public:
+    static const TUint kHeadroomMs = 20; // allows for scheduling delays on receivers
+    static const TUint kRepairMs = 40;   // time for one round of resend requests, excluding network delays
+public:
+    static TUint RequiredMs(const OhmHeaderReception& aReception); // 0 if aReception describes no audio
+};
+
+class IOhmLatencyObserver
+{
+public:
+    virtual void NotifySongcastLatency(TUint aLatencyMs) = 0;
+    virtual ~IOhmLatencyObserver() {}
+};
+
+class OhmReceptionMonitor
+{
+    static const TUint kMaxFrameGap = 100;              // larger jumps in frame numbers start a new stream
+    static const TUint kMaxTransitStepUs = 1000 * 1000; // larger changes in transit time imply the sender paused
+public:
+    OhmReceptionMonitor();
+    void Reset();
+    // Called for the first copy of each audio msg received.  Resent msgs should not be added.
+    void Add(TUint aFrame, TUint64 aSampleStart, TUint aSampleRate, TBool aHalt, TUint64 aArrivalUs);
+    TUint RequiredLatencyMs() const; // based on audio received since the last call to Report()
+    OhmHeaderReception Report();     // describes audio received since the previous call
+private:
+    void StartTransit(TInt64 aTransit);
+    OhmHeaderReception ReportLocked() const;
+private:
+    mutable Mutex iLock;
+    TUint iSampleRate;
+    TUint64 iSampleStart;
+    TBool iFrameValid;
+    TUint iFrameNext;
+    TUint iFramesExpected;
+    TUint iFramesReceived;
+    TBool iTransitValid;
+    TInt64 iTransit;
+    TInt64 iTransitMin;
+    TInt64 iTransitMax;
+    TUint iSpreadUs;   // widest spread of any earlier stream since the previous report
+    TUint iJitterUs16; // RFC 3550 jitter estimate, scaled by 16
+};
+
+class OhmLatencyController
+{
+public:
+    static const TUint kMaxReceivers = 64;
+    static const TUint kReportLifetimeMs = 15 * 1000;
+    static const TUint kStepMs = 10;
+    static const TUint kDecreaseMarginMs = 20;      // don't bother reducing latency by less than this
+    static const TUint kDecreaseHoldMs = 30 * 1000; // only reduce latency after reports have allowed this for this long
+public:
+    OhmLatencyController();
+    /*
+     * Latency adapts between aMinMs and aMaxMs, starting at aDefaultMs.  aDefaultMs is also used for
+     * receivers that don't report on their reception.  Adaptation is disabled if aMaxMs <= aMinMs.
+     */
+    void SetRange(TUint aMinMs, TUint aMaxMs, TUint aDefaultMs);
+    TBool Enabled() const;
+    TUint LatencyMs() const;
+    void Add(const Endpoint& aReceiver, const OhmHeaderReception& aReception, TUint aNowMs);
+    void AddLegacy(const Endpoint& aReceiver, TUint aNowMs); // aReceiver doesn't report reception
+    TBool Update(TUint aNowMs); // returns true if LatencyMs() changed
+private:
+    void Add(const Endpoint& aReceiver, TUint aRequiredMs, TUint aNowMs);
+    TUint Clamp(TUint aLatencyMs) const;
+private:
+    struct Receiver
+    {
+        Endpoint iEndpoint;
+        TUint iRequiredMs;
+        TUint iTimeMs;
+    };
+private:
+    Receiver iReceivers[kMaxReceivers];
+    TUint iCount;
+    TUint iMinMs;
+    TUint iMaxMs;
+    TUint iDefaultMs;
+    TUint iLatencyMs;
+    TBool iDecreasePending;
+    TUint iDecreaseStartMs;
+    TUint iDecreaseTargetMs;
+};
+
+} // namespace Av
+} // namespace OpenHome
@@ -88,7 +88,7 @@ void OhmMsgTimestamped::Create()
 
 OhmMsgAudio::OhmMsgAudio(OhmMsgFactory& aFactory)
     : OhmMsgTimestamped(aFactory)
-    , iAudio(iUnifiedBuffer.Ptr() + kStreamHeaderBytes, kMaxSampleBytes)
+    , iAudio(iUnifiedBuffer.Ptr() + kStreamHeaderBytes, kMaxAudioBytes)
     , iHeaderSerialised(false)
 {
 }
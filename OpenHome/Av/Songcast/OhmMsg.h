@@ -64,6 +64,8 @@ class OhmMsgAudio : public OhmMsgTimestamped
     friend class OhmMsgFactory;
 public:
     static const TUint kMaxSampleBytes    = 5760; // 5ms of 192/24 stereo
+    static const TUint kMaxEncodingBytes  = 32;   // worst case growth of incompressible audio when FLAC encoded
+    static const TUint kMaxAudioBytes     = kMaxSampleBytes + kMaxEncodingBytes;
     static const TUint kMaxCodecBytes     = 30-1;
     static const TUint kFlagHalt          = 1 << 0;
     static const TUint kFlagLossless      = 1 << 1;
@@ -134,7 +136,7 @@ private:
     TUint iBitDepth;
     TUint iChannels;
     Bws<kMaxCodecBytes> iCodec;
-    Bws<kStreamHeaderBytes+kMaxSampleBytes> iUnifiedBuffer;
+    Bws<kStreamHeaderBytes+kMaxAudioBytes> iUnifiedBuffer;
     Bwn iAudio;
     TUint iStreamHeaderOffset;
     TBool iHeaderSerialised;
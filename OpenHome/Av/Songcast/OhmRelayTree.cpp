@@ -0,0 +1,91 @@
+#include <OpenHome/Av/Songcast/OhmRelayTree.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Private/Standard.h>
+
+using namespace OpenHome;
+using namespace OpenHome::Av;
+
+// OhmRelayTree
+
+TUint OhmRelayTree::MaxDepthForLatency(TUint aLatencyMs)
+{ // static
+    // Allow up to half the latency for relaying, leaving the rest to cover resends.
+    // A single level of relaying has always been supported so allow this regardless.
+    const TUint depth = (aLatencyMs / 2) / kHopBudgetMs;
+    return (depth < 1? 1 : depth);
+}
+
+OhmRelayTree::OhmRelayTree()
+{
+    Configure(kMaxFanOut, 0);
+}
+
+void OhmRelayTree::Configure(TUint aFanOut, TUint aLatencyMs)
+{
+    ASSERT(aFanOut > 0 && aFanOut <= kMaxFanOut);
+    iFanOut = aFanOut;
+    iMaxDepth = MaxDepthForLatency(aLatencyMs);
+    iCapacity = 1;
+    TUint level = 1;
+    for (TUint depth = 1; depth <= iMaxDepth && iCapacity < kMaxReceivers; depth++) {
+        level *= iFanOut;
+        iCapacity += level;
+    }
+    if (iCapacity > kMaxReceivers) {
+        iCapacity = kMaxReceivers;
+    }
+}
+
+TUint OhmRelayTree::FanOut() const
+{
+    return iFanOut;
+}
+
+TUint OhmRelayTree::MaxDepth() const
+{
+    return iMaxDepth;
+}
+
+TUint OhmRelayTree::Capacity() const
+{
+    return iCapacity;
+}
+
+TUint OhmRelayTree::Depth(TUint aIndex) const
+{
+    TUint depth = 0;
+    while (aIndex > 0) {
+        aIndex = Parent(aIndex);
+        depth++;
+    }
+    return depth;
+}
+
+TUint OhmRelayTree::Parent(TUint aIndex) const
+{
+    ASSERT(aIndex > 0);
+    return (aIndex - 1) / iFanOut;
+}
+
+TUint OhmRelayTree::FirstChild(TUint aIndex) const
+{
+    return (aIndex * iFanOut) + 1;
+}
+
+TUint OhmRelayTree::ChildCount(TUint aIndex, TUint aReceivers) const
+{
+    const TUint first = FirstChild(aIndex);
+    if (first >= aReceivers) {
+        return 0;
+    }
+    const TUint count = aReceivers - first;
+    return (count < iFanOut? count : iFanOut);
+}
+
+TUint OhmRelayTree::RelayCount(TUint aReceivers) const
+{
+    if (aReceivers < 2) {
+        return 0;
+    }
+    return ((aReceivers - 2) / iFanOut) + 1;
+}
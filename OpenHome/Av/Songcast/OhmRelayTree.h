@@ -0,0 +1,46 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+
+namespace OpenHome {
+namespace Av {
+
+/*
+ * Topology used by unicast senders to reach more receivers than they could by sending to
+ * each directly.
+ *
+ * The sender sends to a single receiver (index 0).  Every receiver relays all it receives
+ * to the receivers listed in the most recent Slave msg the sender sent it, so receivers form
+ * a tree with up to FanOut() children per node.  Receivers are numbered in breadth first
+ * order so the children of receiver n are FanOut()*n+1 .. FanOut()*n+FanOut().  Each level
+ * of relaying delays audio a little more so the depth of the tree is limited by latency.
+ */
+
+class OhmRelayTree
+{
+public:
+    static const TUint kMaxFanOut = 4;      // each receiver relays to at most this many others
+    static const TUint kMaxReceivers = 64;
+    static const TUint kHopBudgetMs = 25;   // latency reserved for each level of relaying
+public:
+    static TUint MaxDepthForLatency(TUint aLatencyMs);
+public:
+    OhmRelayTree();
+    void Configure(TUint aFanOut, TUint aLatencyMs);
+    TUint FanOut() const;
+    TUint MaxDepth() const;
+    TUint Capacity() const; // max receivers, including the one the sender sends to
+    TUint Depth(TUint aIndex) const; // number of relays between the sender and receiver aIndex
+    TUint Parent(TUint aIndex) const; // aIndex must be non-zero
+    TUint FirstChild(TUint aIndex) const;
+    TUint ChildCount(TUint aIndex, TUint aReceivers) const;
+    TUint RelayCount(TUint aReceivers) const; // relays are always receivers [0, RelayCount)
+private:
+    TUint iFanOut;
+    TUint iMaxDepth;
+    TUint iCapacity;
+};
+
+} // namespace Av
+} // namespace OpenHome
+
@@ -14,6 +14,7 @@
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Optional.h>
 #include <OpenHome/Private/TIpAddressUtils.h>
+#include <OpenHome/Json.h>
 
 #include <stdio.h>
 
@@ -311,10 +312,28 @@ OhmSenderDriver::OhmSenderDriver(Environment& aEnv, Optional<IOhmTimestamper> aT
     , iLatencyMs(0)
     , iLatencyOhm(0)
     , iSocket(aEnv)
-    , iFactory(110, 10, 10) // FIXME - rationale for msg counts??
+    , iFactory(kMaxHistoryFrames + 10, 10, 10) // history plus a few in flight
+    , iHistoryFrames(kDefaultHistoryFrames)
+    , iHistoryFirst(0)
+    , iHistoryCount(0)
     , iTimestamper(aTimestamper.Ptr())
     , iFirstFrame(true)
+    , iCompressAllowed(false)
+    , iCompressFormat(false)
 {
+    for (TUint i = 0; i < kMaxHistoryFrames; i++) {
+        iHistory[i] = nullptr;
+    }
+}
+
+void OhmSenderDriver::SetHistoryFrames(TUint aFrames)
+{
+    ASSERT(aFrames > 0 && aFrames <= kMaxHistoryFrames);
+    AutoMutex mutex(iMutex);
+    iHistoryFrames = aFrames;
+    while (iHistoryCount > 0 && (iFrame - 1) - iHistoryFirst >= iHistoryFrames) {
+        RemoveHistory(iHistoryFirst++);
+    }
 }
 
 inline void OhmSenderDriver::UpdateLatencyOhm()
@@ -335,6 +354,10 @@ void OhmSenderDriver::SetAudioFormat(TUint aSampleRate, TUint aBitRate, TUint aC
 
     iStreamHeader.Replace(Brx::Empty());
     OhmMsgAudio::GetStreamHeader(iStreamHeader, iSamplesTotal, aSampleRate, aBitRate, 0/*VolumeOffset*/, aBitDepth, aChannels, aCodecName);
+    iStreamHeaderFlac.Replace(Brx::Empty());
+    OhmMsgAudio::GetStreamHeader(iStreamHeaderFlac, iSamplesTotal, aSampleRate, aBitRate, 0/*VolumeOffset*/, aBitDepth, aChannels, OhmFlac::kCodecName);
+    iCompressFormat = OhmFlac::IsSupported(aBitDepth, aChannels);
+    iFlacEncoder.SetFormat(aSampleRate, aBitDepth, aChannels);
 
     if (iTimestamper != nullptr) {
         // ignore return value below - false just implies iTimestamper->Timestamp will throw
@@ -346,9 +369,6 @@ void OhmSenderDriver::SetAudioFormat(TUint aSampleRate, TUint aBitRate, TUint aC
 OhmMsgAudio* OhmSenderDriver::CreateAudio()
 {
     AutoMutex mutex(iMutex);
-    if (iFifoHistory.SlotsUsed() == kMaxHistoryFrames) {
-        iFifoHistory.Read()->RemoveRef();
-    }
     return iFactory.CreateAudio();
 }
 
@@ -371,10 +391,6 @@ void OhmSenderDriver::SendAudio(const TByte* aData, TUint aBytes, TBool aHalt)
         // nothing to usefully communicate to receivers
         return;
     }
-    if (iFifoHistory.SlotsUsed() == kMaxHistoryFrames) {
-        iFifoHistory.Read()->RemoveRef();
-    }
-
     TBool isTimeStamped = false;
     TUint timeStamp = 0;
     if (iFirstFrame) {
@@ -388,6 +404,13 @@ void OhmSenderDriver::SendAudio(const TByte* aData, TUint aBytes, TBool aHalt)
         catch (OhmTimestampNotFound&) {}
     }
 
+    Brn audio(aData, aBytes);
+    const Brx* streamHeader = &iStreamHeader;
+    if (Compress(audio)) {
+        audio.Set(iFlacBuffer);
+        streamHeader = &iStreamHeaderFlac;
+    }
+
     OhmMsgAudio* msg = iFactory.CreateAudio(
         aHalt,
         iLossless,
@@ -398,17 +421,18 @@ void OhmSenderDriver::SendAudio(const TByte* aData, TUint aBytes, TBool aHalt)
         timeStamp, // network timestamp
         iLatencyOhm,
         iSampleStart,
-        iStreamHeader,
-        Brn(aData, aBytes)
+        *streamHeader,
+        audio
     );
 
     msg->Serialise();
-    iFifoHistory.Write(msg);
+    AddHistory(msg);
     try {
         iSocket.Send(msg->SendableBuffer(), iEndpoint);
     }
     catch (NetworkError&) {
     }
+    SendFec(*msg);
 
     msg->SetResent(true);
     iSampleStart += samples;
@@ -436,10 +460,6 @@ void OhmSenderDriver::SendAudio(OhmMsgAudio* aMsg, TBool aHalt)
         aMsg->RemoveRef();
         return;
     }
-    if (iFifoHistory.SlotsUsed() == kMaxHistoryFrames) {
-        iFifoHistory.Read()->RemoveRef();
-    }
-
     TBool isTimeStamped = false;
     TUint timeStamp = 0;
     if (iFirstFrame) {
@@ -453,6 +473,12 @@ void OhmSenderDriver::SendAudio(OhmMsgAudio* aMsg, TBool aHalt)
         catch (OhmTimestampNotFound&) {}
     }
 
+    const Brx* streamHeader = &iStreamHeader;
+    if (Compress(aMsg->Audio())) {
+        aMsg->Audio().Replace(iFlacBuffer);
+        streamHeader = &iStreamHeaderFlac;
+    }
+
     aMsg->ReinitialiseFields(
         aHalt,
         iLossless,
@@ -463,16 +489,17 @@ void OhmSenderDriver::SendAudio(OhmMsgAudio* aMsg, TBool aHalt)
         timeStamp, // network timestamp
         iLatencyOhm,
         iSampleStart,
-        iStreamHeader
+        *streamHeader
     );
 
     aMsg->Serialise();
-    iFifoHistory.Write(aMsg);
+    AddHistory(aMsg);
     try {
         iSocket.Send(aMsg->SendableBuffer(), iEndpoint);
     }
     catch (NetworkError&) {
     }
+    SendFec(*aMsg);
 
     aMsg->SetResent(true);
     iSampleStart += samples;
@@ -485,6 +512,7 @@ void OhmSenderDriver::StreamInterrupted()
     iFrame += 250; /* Any gap in audio frame numbers will cause receivers to retry.
                       A gap larger than their history (retry) buffer should force them to
                       skip retries and move straight to re-syncing instead. */
+    iFecEncoder.Reset();
 }
 
 void OhmSenderDriver::SetEnabled(TBool aValue)
@@ -565,59 +593,111 @@ void OhmSenderDriver::Resend(OhmMsgAudio& aMsg)
     }
 }
 
-void OhmSenderDriver::Resend(const Brx& aFrames)
+TUint OhmSenderDriver::Resend(const Brx& aFrames)
 {
     AutoMutex mutex(iMutex);
     LOG(kSongcast, "RESEND");
 
     ReaderBuffer buffer(aFrames);
     ReaderBinary reader(buffer);
-    TUint frames = aFrames.Bytes() / 4;
-    TUint frame = reader.ReadUintBe(4);
-    frames--;
-    LOG(kSongcast, " %lu", (unsigned long)frame);
-    TBool found = false;
-    TUint count = iFifoHistory.SlotsUsed();
-    for (TUint i = 0; i < count; i++) {
-        OhmMsgAudio* msg = iFifoHistory.Read();
-        if (!found) {
-            TInt diff = frame - msg->Frame();
-            if (diff == 0) {
-                Resend(*msg);
-                if (frames-- > 0) {
-                    frame = reader.ReadUintBe(4);
-                }
-                else {
-                    found = true;
-                }
-            }
-            else {
-                while (diff < 0) {
-                    if (frames-- > 0) {
-                        frame = reader.ReadUintBe(4);
-                    }
-                    else {
-                        found = true;
-                        break;
-                    }
-                    diff = frame - msg->Frame();
-                    if (diff == 0) {
-                        Resend(*msg);
-                        if (frames-- > 0) {
-                            frame = reader.ReadUintBe(4);
-                        }
-                        else {
-                            found = true;
-                        }
-                        break;
-                    }
-                }
-            }
+    const TUint frames = aFrames.Bytes() / 4;
+    TUint resent = 0;
+    for (TUint i = 0; i < frames; i++) {
+        const TUint frame = reader.ReadUintBe(4);
+        LOG(kSongcast, " %lu", (unsigned long)frame);
+        OhmMsgAudio* msg = iHistory[frame % kMaxHistoryFrames];
+        if (msg != nullptr && msg->Frame() == frame) {
+            Resend(*msg);
+            resent++;
         }
-
-        iFifoHistory.Write(msg);
     }
     LOG(kSongcast, "\n");
+    return resent;
+}
+
+void OhmSenderDriver::AddHistory(OhmMsgAudio* aMsg)
+{
+    // called with iMutex held
+    const TUint frame = aMsg->Frame();
+    if (iHistoryCount == 0 || frame - iHistoryFirst > kMaxHistoryFrames) {
+        // first frame, large jump in frame numbers or frame numbers reset
+        ClearHistory();
+        iHistoryFirst = frame;
+    }
+    while (frame - iHistoryFirst >= iHistoryFrames) {
+        RemoveHistory(iHistoryFirst++);
+    }
+    OhmMsgAudio*& slot = iHistory[frame % kMaxHistoryFrames];
+    ASSERT(slot == nullptr);
+    slot = aMsg;
+    iHistoryCount++;
+}
+
+void OhmSenderDriver::RemoveHistory(TUint aFrame)
+{
+    OhmMsgAudio*& slot = iHistory[aFrame % kMaxHistoryFrames];
+    if (slot != nullptr && slot->Frame() == aFrame) {
+        slot->RemoveRef();
+        slot = nullptr;
+        iHistoryCount--;
+    }
+}
+
+void OhmSenderDriver::ClearHistory()
+{
+    for (TUint i = 0; i < kMaxHistoryFrames && iHistoryCount > 0; i++) {
+        if (iHistory[i] != nullptr) {
+            iHistory[i]->RemoveRef();
+            iHistory[i] = nullptr;
+            iHistoryCount--;
+        }
+    }
+}
+
+void OhmSenderDriver::SetFec(TUint aGroupFrames)
+{
+    AutoMutex mutex(iMutex);
+    if (iFecEncoder.GroupFrames() != aGroupFrames) {
+        LOG(kSongcast, "OHM SENDER DRIVER FEC GROUP FRAMES %u\n", aGroupFrames);
+        iFecEncoder.SetGroupFrames(aGroupFrames);
+    }
+}
+
+void OhmSenderDriver::SendFec(OhmMsgAudio& aMsg)
+{
+    if (iFecEncoder.Add(aMsg.Frame(), aMsg.SendableBuffer())) {
+        iFecBuffer.Replace(Brx::Empty());
+        WriterBuffer writer(iFecBuffer);
+        iFecEncoder.Externalise(writer);
+        try {
+            iSocket.Send(iFecBuffer, iEndpoint);
+        }
+        catch (NetworkError&) {
+        }
+    }
+}
+
+void OhmSenderDriver::SetCompression(TBool aEnable)
+{
+    AutoMutex mutex(iMutex);
+    if (iCompressAllowed != aEnable) {
+        LOG(kSongcast, "OHM SENDER DRIVER COMPRESSION %u\n", aEnable);
+        iCompressAllowed = aEnable;
+    }
+}
+
+TBool OhmSenderDriver::Compress(const Brx& aAudio)
+{
+    /* Receivers start a new stream whenever the codec changes so empty (halt) msgs are
+       marked as compressed too.  Only fall back to PCM if the encoder fails. */
+    if (!iCompressAllowed || !iCompressFormat) {
+        return false;
+    }
+    if (aAudio.Bytes() == 0) {
+        iFlacBuffer.SetBytes(0);
+        return true;
+    }
+    return iFlacEncoder.Encode(aAudio, iFlacBuffer);
 }
 
 void OhmSenderDriver::ResetLocked()
@@ -625,12 +705,80 @@ void OhmSenderDriver::ResetLocked()
     iSend = false;
     iFrame = 0;
     iFirstFrame = true;
+    iFecEncoder.Reset();
     if (iTimestamper != nullptr) {
         iTimestamper->Stop();
     }
-    const TUint count = iFifoHistory.SlotsUsed();
-    for (TUint i = 0; i < count; i++) {
-        iFifoHistory.Read()->RemoveRef();
+    ClearHistory();
+}
+
+
+// OhmResendStats
+
+OhmResendStats::OhmResendStats(Environment& aEnv)
+    : iEnv(aEnv)
+    , iLock("OHRS")
+    , iCount(0)
+{
+}
+
+void OhmResendStats::Add(const Endpoint& aReceiver, TUint aFramesRequested, TUint aFramesResent)
+{
+    const TUint now = Time::Now(iEnv);
+    AutoMutex _(iLock);
+    Receiver* receiver = nullptr;
+    for (TUint i = 0; i < iCount; i++) {
+        if (iReceivers[i].iEndpoint.Equals(aReceiver)) {
+            receiver = &iReceivers[i];
+            break;
+        }
+    }
+    if (receiver == nullptr) {
+        if (iCount < kMaxReceivers) {
+            receiver = &iReceivers[iCount++];
+        }
+        else { // replace whichever receiver we've heard from least recently
+            receiver = &iReceivers[0];
+            for (TUint i = 1; i < iCount; i++) {
+                if ((TInt)(iReceivers[i].iLastMs - receiver->iLastMs) < 0) {
+                    receiver = &iReceivers[i];
+                }
+            }
+        }
+        receiver->iEndpoint.Replace(aReceiver);
+        receiver->iRequests = 0;
+        receiver->iFramesRequested = 0;
+        receiver->iFramesResent = 0;
+        receiver->iFirstMs = now;
+    }
+    receiver->iRequests++;
+    receiver->iFramesRequested += aFramesRequested;
+    receiver->iFramesResent += aFramesResent;
+    receiver->iLastMs = now;
+}
+
+void OhmResendStats::Write(WriterJsonArray& aWriter) const
+{
+    static const TUint kMinPeriodMs = 1000;
+    const TUint now = Time::Now(iEnv);
+    AutoMutex _(iLock);
+    for (TUint i = 0; i < iCount; i++) {
+        const Receiver& receiver = iReceivers[i];
+        Endpoint::EndpointBuf buf;
+        receiver.iEndpoint.AppendEndpoint(buf);
+        TUint periodMs = now - receiver.iFirstMs;
+        if (periodMs < kMinPeriodMs) {
+            periodMs = kMinPeriodMs;
+        }
+        const TUint perMinute = (TUint)(((TUint64)receiver.iFramesRequested * 60000) / periodMs);
+        auto writerObj = aWriter.CreateObject();
+        writerObj.WriteString("receiver", buf);
+        writerObj.WriteUint("requests", receiver.iRequests);
+        writerObj.WriteUint("frames_requested", receiver.iFramesRequested);
+        writerObj.WriteUint("frames_resent", receiver.iFramesResent);
+        writerObj.WriteUint("frames_per_minute", perMinute);
+        writerObj.WriteUint("age_seconds", (now - receiver.iLastMs) / 1000);
+        writerObj.WriteEnd();
     }
 }
 
@@ -661,9 +809,22 @@ OhmSender::OhmSender(Environment& aEnv, Net::DvDeviceStandard& aDevice, IOhmSend
     , iActive(false)
     , iAliveJoined(false)
     , iAliveBlocked(false)
+    , iRelayFanOut(OhmRelayTree::kMaxFanOut)
+    , iRelaysNotified(0)
     , iSequenceTrack(0)
     , iSequenceMetatext(0)
     , iClientControllingTrackMetadata(false)
+    , iFecGroupFrames(0)
+    , iFecReceiverMaxGroupFrames(0)
+    , iFecLegacyReceiver(false)
+    , iFecLegacyReceiverExpiry(0)
+    , iCompression(false)
+    , iCapabilitiesHeard(false)
+    , iFlacUnsupportedReceiver(true)
+    , iFlacUnsupportedReceiverExpiry(0)
+    , iResendStats(aEnv)
+    , iLatencyAdvertised(aLatency)
+    , iLatencyObserver(nullptr)
 {
     iProvider = new ProviderSender(aEnv, iDevice);
     CurrentSubnetChanged(); // roundabout way of initialising iInterface
@@ -764,19 +925,28 @@ void OhmSender::SetLatency(TUint aValue)
     if (iLatency != aValue) {
         if (iStarted) {
             Stop();
-            iLatency = aValue;
-            iDriver.SetLatency(iLatency);
-            LOG(kSongcast, "OHM SENDER DRIVER LATENCY %d\n", iLatency);
+            UpdateLatency(aValue);
             Start();
         }
         else {
-            iLatency = aValue;
-            iDriver.SetLatency(iLatency);
-            LOG(kSongcast, "OHM SENDER DRIVER LATENCY %d\n", iLatency);
+            UpdateLatency(aValue);
         }
     }
 }
 
+void OhmSender::SetLatencyRange(TUint aMinMs, TUint aMaxMs, TUint aDefaultMs)
+{
+    AutoMutex mutex(iMutexActive);
+    iLatencyController.SetRange(aMinMs, aMaxMs, aDefaultMs);
+    UpdateLatencyLocked();
+}
+
+void OhmSender::SetLatencyObserver(IOhmLatencyObserver& aObserver)
+{
+    AutoMutex mutex(iMutexActive);
+    iLatencyObserver = &aObserver;
+}
+
 void OhmSender::SetMulticast(TBool aValue)
 {
     AutoMutex mutex(iMutexStartStop);
@@ -952,6 +1122,28 @@ void OhmSender::EnableUnicastOverride(TBool aEnable)
     }
 }
 
+void OhmSender::SetFecGroupFrames(TUint aValue)
+{
+    ASSERT(aValue <= OhmFec::kMaxGroupFrames);
+    AutoMutex mutex(iMutexActive);
+    iFecGroupFrames = aValue;
+    UpdateCapabilitiesLocked();
+}
+
+void OhmSender::SetCompression(TBool aEnable)
+{
+    AutoMutex mutex(iMutexActive);
+    iCompression = aEnable;
+    UpdateCapabilitiesLocked();
+}
+
+void OhmSender::SetRelayFanOut(TUint aValue)
+{
+    ASSERT(aValue > 0 && aValue <= OhmRelayTree::kMaxFanOut);
+    AutoMutex mutex(iMutexActive);
+    iRelayFanOut = aValue; // applied by RunUnicast next time it updates the slave lists
+}
+
 //  This runs a little state machine where the current state is reflected by:
 //
 //  iAliveJoined: Indicates that someone is listening to us (we received a join recently)
@@ -978,6 +1170,7 @@ void OhmSender::RunMulticast()
                     
                     if (header.MsgType() <= OhmHeader::kMsgTypeListen) {
                         LOG(kSongcast, "OhmSender::RunMulticast join/listen received\n");
+                        NegotiateCapabilities(header);
                         
                         AutoMutex mutex(iMutexActive);
                         
@@ -996,14 +1189,7 @@ void OhmSender::RunMulticast()
                     }
                     else if (header.MsgType() == OhmHeader::kMsgTypeResend) {
                         LOG(kSongcast, "OhmSender::RunMulticast resend received\n");
-
-                        OhmHeaderResend headerResend;
-                        headerResend.Internalise(iRxBuffer, header);
-
-                        TUint frames = headerResend.FramesCount();
-                        if (frames > 0) {
-                            iDriver.Resend(iRxBuffer.Read(frames * 4));
-                        }
+                        HandleResend(header);
                     }
                     else if (header.MsgType() == OhmHeader::kMsgTypeAudio) {
                         // Check sender not us
@@ -1056,6 +1242,11 @@ void OhmSender::RunMulticast()
             iAliveBlocked = false;
             iProvider->NotifyListeners(false);
             iProvider->SetStatusBlocked(iAliveBlocked);
+            iFecReceiverMaxGroupFrames = 0;
+            iFecLegacyReceiver = false;
+            iCapabilitiesHeard = false;
+            iFlacUnsupportedReceiver = true;
+            UpdateCapabilitiesLocked();
         }
         
         iNetworkDeactivated.Signal();
@@ -1081,6 +1272,7 @@ void OhmSender::RunUnicast()
                         
                         if (header.MsgType() <= OhmHeader::kMsgTypeListen) {
                             LOG(kSongcast, "OhmSender::RunUnicast ready/join or listen (%u)\n", header.MsgType());
+                            NegotiateCapabilities(header);
                             break;                        
                         }
                     }
@@ -1099,6 +1291,8 @@ void OhmSender::RunUnicast()
                 iSlaveCount = 0;
                 { // scope for AutoMutex
                     AutoMutex mutex(iMutexActive);
+                    iRelaysNotified = 0;
+                    ConfigureRelayTree();
                     iActive = true;
                     iAliveJoined = true;
                     iDriver.SetActive(true);
@@ -1112,6 +1306,9 @@ void OhmSender::RunUnicast()
                         OhmHeader header;
                         header.Internalise(iRxBuffer);
                         
+                        if (header.MsgType() <= OhmHeader::kMsgTypeListen) {
+                            NegotiateCapabilities(header);
+                        }
                         if (header.MsgType() == OhmHeader::kMsgTypeJoin) {
                             Endpoint sender(iSocketOhm.Sender());
                             if (Debug::TestLevel(Debug::kSongcast)) {
@@ -1128,8 +1325,8 @@ void OhmSender::RunUnicast()
                                     iSlaveExpiry[slave] = Time::Now(iEnv) + kTimerExpiryTimeoutMs;
                                 }
                                 else {
-                                    if (slave >= kMaxSlaveCount) {
-                                        LOG(kSongcast, "OhmSender::RunUnicast ignoring join request - already have %u slaves\n", slave-1);
+                                    if (slave + 1 >= iRelayTree.Capacity()) {
+                                        LOG(kSongcast, "OhmSender::RunUnicast ignoring join request - already have %u slaves\n", slave);
                                     }
                                     else {
                                         iSlaveList[slave].Replace(sender);
@@ -1167,7 +1364,7 @@ void OhmSender::RunUnicast()
                                 }
                                 else {
                                     // unknown slave, probably temporarily physically disconnected receiver
-                                    if (slave < kMaxSlaveCount) {
+                                    if (slave + 1 < iRelayTree.Capacity()) {
                                         iSlaveList[slave].Replace(sender);
                                         iSlaveExpiry[slave] = Time::Now(iEnv) + kTimerExpiryTimeoutMs;
                                         iSlaveCount++;
@@ -1220,12 +1417,7 @@ void OhmSender::RunUnicast()
                         }
                         else if (header.MsgType() == OhmHeader::kMsgTypeResend) {
                             LOG(kSongcast, "OhmSender::RunUnicast resend received\n");
-                            OhmHeaderResend headerResend;
-                            headerResend.Internalise(iRxBuffer, header);
-                            TUint frames = headerResend.FramesCount();
-                            if (frames > 0) {
-                                iDriver.Resend(iRxBuffer.Read(frames * 4));
-                            }
+                            HandleResend(header);
                         }
                     }
                     catch (OhmError&) {
@@ -1262,6 +1454,11 @@ void OhmSender::RunUnicast()
             iAliveBlocked = false;
             iProvider->NotifyListeners(false);
             iProvider->SetStatusBlocked(iAliveBlocked);
+            iFecReceiverMaxGroupFrames = 0;
+            iFecLegacyReceiver = false;
+            iCapabilitiesHeard = false;
+            iFlacUnsupportedReceiver = true;
+            UpdateCapabilitiesLocked();
         }
 
         iNetworkDeactivated.Signal();
@@ -1422,16 +1619,51 @@ void OhmSender::SendMetatext()
 void OhmSender::SendSlaveList()
 {
     // called with alive mutex locked;
-    OhmHeaderSlave headerSlave(iSlaveCount);
-    OhmHeader header(OhmHeader::kMsgTypeSlave, headerSlave.MsgBytes());
-    WriterBuffer writer(iTxBuffer);
-    writer.Flush();
-    header.Externalise(writer);
-    headerSlave.Externalise(writer);
-    for (TUint i = 0; i < iSlaveCount; i++) {
-        iSlaveList[i].Externalise(writer);
+    // Each relay is sent a list of just its own children.  Relays are always the first
+    // receivers in the tree; any that have stopped relaying are sent an empty list.
+    ConfigureRelayTree();
+    const TUint receivers = iSlaveCount + 1;
+    const TUint relays = iRelayTree.RelayCount(receivers);
+    TUint notify = (iRelaysNotified < receivers? iRelaysNotified : receivers);
+    if (notify < relays) {
+        notify = relays;
+    }
+    if (notify == 0) {
+        notify = 1; // always update the receiver we send to directly
+    }
+    for (TUint i = 0; i < notify; i++) {
+        const TUint first = iRelayTree.FirstChild(i);
+        const TUint children = iRelayTree.ChildCount(i, receivers);
+        OhmHeaderSlave headerSlave(children);
+        OhmHeader header(OhmHeader::kMsgTypeSlave, headerSlave.MsgBytes());
+        WriterBuffer writer(iTxBuffer);
+        writer.Flush();
+        header.Externalise(writer);
+        headerSlave.Externalise(writer);
+        for (TUint j = 0; j < children; j++) {
+            iSlaveList[first + j - 1].Externalise(writer);
+        }
+        const Endpoint& relay = (i == 0? iTargetEndpoint : iSlaveList[i - 1]);
+        try {
+            iSocketOhm.Send(iTxBuffer, relay);
+        }
+        catch (NetworkError&) {
+        }
+    }
+    iRelaysNotified = relays;
+}
+
+void OhmSender::ConfigureRelayTree()
+{
+    // called with alive mutex locked;
+    // If the tree shrinks (e.g. latency reduced), existing slaves are kept so none stop
+    // receiving audio.  Join/Listen refuse new slaves until enough have left.
+    const TUint capacityPrev = iRelayTree.Capacity();
+    iRelayTree.Configure(iRelayFanOut, iLatency);
+    const TUint capacity = iRelayTree.Capacity();
+    if (capacity != capacityPrev && iSlaveCount + 1 > capacity) {
+        LOG(kSongcast, "OhmSender: relay tree now holds %u receivers, keeping %u existing slaves beyond this\n", capacity, iSlaveCount + 1 - capacity);
     }
-    Send();
 }
 
 void OhmSender::SendListen(const Endpoint& aEndpoint)
@@ -1483,12 +1715,124 @@ TBool OhmSender::CheckSlaveExpiry()
     return changed;
 }
 
+void OhmSender::HandleResend(const OhmHeader& aHeader)
+{
+    OhmHeaderResend headerResend;
+    headerResend.Internalise(iRxBuffer, aHeader);
+    const TUint frames = headerResend.FramesCount();
+    if (frames > 0) {
+        const TUint resent = iDriver.Resend(iRxBuffer.Read(frames * 4));
+        iResendStats.Add(iSocketOhm.Sender(), frames, resent);
+    }
+}
+
+void OhmSender::WriteResendStats(WriterJsonArray& aWriter) const
+{
+    iResendStats.Write(aWriter);
+}
+
+void OhmSender::NegotiateCapabilities(const OhmHeader& aHeader)
+{
+    /* Receivers advertise the optional features they support in their Join/Listen msgs.
+       Older receivers reject unknown msg types so don't send Fec msgs while we've
+       recently heard from one of these.
+       Receivers that can't decode compressed audio would play it as noise so be more
+       cautious here, only compressing once we've been listening for long enough to
+       have heard from every receiver. */
+    OhmHeaderCapabilities capabilities;
+    if (aHeader.MsgBytes() >= OhmHeaderCapabilities::kHeaderBytes) {
+        capabilities.Internalise(iRxBuffer, aHeader);
+    }
+    OhmHeaderReception reception;
+    const TBool hasReception = (aHeader.MsgType() == OhmHeader::kMsgTypeListen &&
+                                aHeader.MsgBytes() >= OhmHeaderCapabilities::kHeaderBytes + OhmHeaderReception::kHeaderBytes);
+    if (hasReception) {
+        reception.Internalise(iRxBuffer, aHeader);
+    }
+    AutoMutex mutex(iMutexActive);
+    const TUint expiry = Time::Now(iEnv) + kTimerAliveJoinTimeoutMs;
+    if (capabilities.MaxFecGroupFrames() == 0) {
+        iFecLegacyReceiver = true;
+        iFecLegacyReceiverExpiry = expiry;
+    }
+    else {
+        if (iFecLegacyReceiver && Time::IsInPastOrNow(iEnv, iFecLegacyReceiverExpiry)) {
+            iFecLegacyReceiver = false;
+        }
+        iFecReceiverMaxGroupFrames = capabilities.MaxFecGroupFrames();
+    }
+    if (!iCapabilitiesHeard || (capabilities.Codecs() & OhmHeaderCapabilities::kCodecFlac) == 0) {
+        iCapabilitiesHeard = true;
+        iFlacUnsupportedReceiver = true;
+        iFlacUnsupportedReceiverExpiry = expiry;
+    }
+    else if (iFlacUnsupportedReceiver && Time::IsInPastOrNow(iEnv, iFlacUnsupportedReceiverExpiry)) {
+        iFlacUnsupportedReceiver = false;
+    }
+    UpdateCapabilitiesLocked();
+
+    /* Listen msgs from current receivers may also report on their reception.  Joins are
+       ignored here - a receiver that has only just joined has nothing to report yet. */
+    if (aHeader.MsgType() == OhmHeader::kMsgTypeListen) {
+        const TUint now = Time::Now(iEnv);
+        if (hasReception) {
+            iLatencyController.Add(iSocketOhm.Sender(), reception, now);
+        }
+        else {
+            iLatencyController.AddLegacy(iSocketOhm.Sender(), now);
+        }
+        if (iLatencyController.Update(now)) {
+            UpdateLatencyLocked();
+        }
+    }
+}
+
+void OhmSender::UpdateCapabilitiesLocked()
+{
+    TUint groupFrames = 0;
+    if (!iFecLegacyReceiver) {
+        groupFrames = iFecGroupFrames;
+        if (groupFrames > iFecReceiverMaxGroupFrames) {
+            groupFrames = iFecReceiverMaxGroupFrames;
+        }
+    }
+    iDriver.SetFec(groupFrames);
+    iDriver.SetCompression(iCompression && !iFlacUnsupportedReceiver);
+}
+
+void OhmSender::UpdateLatency(TUint aLatency)
+{
+    AutoMutex mutex(iMutexActive);
+    iLatency = aLatency;
+    UpdateLatencyLocked();
+}
+
+void OhmSender::UpdateLatencyLocked()
+{
+    /* Receivers pick up a change in advertised latency from the next audio msg, ramping
+       through any difference, so there's no need to restart the sender here. */
+    TUint latency = iLatency;
+    if (iLatencyController.Enabled() && iLatencyController.LatencyMs() > latency) {
+        latency = iLatencyController.LatencyMs();
+    }
+    if (latency != iLatencyAdvertised) {
+        iLatencyAdvertised = latency;
+        iDriver.SetLatency(latency);
+        LOG(kSongcast, "OHM SENDER DRIVER LATENCY %d\n", latency);
+        if (iLatencyObserver != nullptr) {
+            iLatencyObserver->NotifySongcastLatency(latency);
+        }
+    }
+}
+
 void OhmSender::RemoveSlave(TUint aIndex)
 {
+    /* Move the last slave (which never relays) into the gap.  This re-parents only
+       the removed slave's children, leaving the rest of the relay tree unchanged. */
     iSlaveCount--;
-    for (TUint i = aIndex; i < iSlaveCount; i++) {
-        iSlaveList[i].Replace(iSlaveList[i + 1]);
-        iSlaveExpiry[i] = iSlaveExpiry[i + 1];
+    if (aIndex < iSlaveCount) {
+        iSlaveList[aIndex].Replace(iSlaveList[iSlaveCount]);
+        iSlaveExpiry[aIndex] = iSlaveExpiry[iSlaveCount];
     }
 }
 
@@ -13,11 +13,16 @@
 
 #include "Ohm.h"
 #include "OhmMsg.h"
+#include "OhmFec.h"
+#include "OhmFlac.h"
+#include "OhmLatency.h"
+#include "OhmRelayTree.h"
 #include "OhmSocket.h"
 #include "OhmSenderDriver.h"
 
 namespace OpenHome {
 class Environment;
+class WriterJsonArray;
 namespace Av {
 
 class ProviderSender;
@@ -26,9 +31,12 @@ class IOhmTimestamper;
 class OhmSenderDriver : public IOhmSenderDriver
 {
     static const TUint kMaxAudioFrameBytes = 6 * 1024;
-    static const TUint kMaxHistoryFrames = 100;
+public:
+    static const TUint kMaxHistoryFrames = 200;
+    static const TUint kDefaultHistoryFrames = 100;
 public:
     OhmSenderDriver(Environment& aEnv, Optional<IOhmTimestamper> aTimestamper);
+    void SetHistoryFrames(TUint aFrames); // number of recently sent frames available for resending
     void SetAudioFormat(TUint aSampleRate, TUint aBitRate, TUint aChannels, TUint aBitDepth, TBool aLossless, const Brx& aCodecName, TUint64 aSampleStart);
     void SendAudio(const TByte* aData, TUint aBytes, TBool aHalt = false);
     OhmMsgAudio* CreateAudio();
@@ -40,12 +48,19 @@ private: // from IOhmSenderDriver
     void SetTtl(TUint aValue) override;
     void SetLatency(TUint aValue) override;
     void SetTrackPosition(TUint64 aSampleStart, TUint64 aSamplesTotal) override;
-    void Resend(const Brx& aFrames) override;
+    TUint Resend(const Brx& aFrames) override;
+    void SetFec(TUint aGroupFrames) override;
+    void SetCompression(TBool aEnable) override;
     void StreamInterrupted() override;
 private:
     inline void UpdateLatencyOhm();
     void ResetLocked();
     void Resend(OhmMsgAudio& aMsg);
+    void AddHistory(OhmMsgAudio* aMsg);
+    void RemoveHistory(TUint aFrame);
+    void ClearHistory();
+    void SendFec(OhmMsgAudio& aMsg);
+    TBool Compress(const Brx& aAudio);
 private:
     Mutex iMutex;
     TBool iEnabled;
@@ -54,6 +69,7 @@ private:
     Endpoint iEndpoint;
     TIpAddress iAdapter;
     Bws<OhmMsgAudio::kStreamHeaderBytes> iStreamHeader;
+    Bws<OhmMsgAudio::kStreamHeaderBytes> iStreamHeaderFlac;
     TUint iFrame;
     TUint iSampleRate;
     TUint iTimestampMultiplier;
@@ -65,9 +81,42 @@ private:
     TUint iLatencyOhm;
     SocketUdp iSocket;
     OhmMsgFactory iFactory;
-    FifoLite<OhmMsgAudio*, kMaxHistoryFrames> iFifoHistory;
+    OhmMsgAudio* iHistory[kMaxHistoryFrames]; // indexed by frame % kMaxHistoryFrames
+    TUint iHistoryFrames;
+    TUint iHistoryFirst; // oldest frame that may still be held in iHistory
+    TUint iHistoryCount;
     IOhmTimestamper* iTimestamper;
     TBool iFirstFrame;
+    OhmFecEncoder iFecEncoder;
+    Bws<OhmFec::kMaxMsgBytes> iFecBuffer;
+    TBool iCompressAllowed;
+    TBool iCompressFormat;
+    OhmFlacEncoder iFlacEncoder;
+    Bws<OhmMsgAudio::kMaxAudioBytes> iFlacBuffer;
+};
+
+class OhmResendStats
+{
+    static const TUint kMaxReceivers = 16;
+public:
+    OhmResendStats(Environment& aEnv);
+    void Add(const Endpoint& aReceiver, TUint aFramesRequested, TUint aFramesResent);
+    void Write(WriterJsonArray& aWriter) const;
+private:
+    struct Receiver
+    {
+        Endpoint iEndpoint;
+        TUint iRequests;
+        TUint iFramesRequested;
+        TUint iFramesResent;
+        TUint iFirstMs;
+        TUint iLastMs;
+    };
+private:
+    Environment& iEnv;
+    mutable Mutex iLock;
+    Receiver iReceivers[kMaxReceivers];
+    TUint iCount;
 };
 
 class OhmSender
@@ -78,7 +127,7 @@ class OhmSender
     static const TUint kTimerAliveJoinTimeoutMs = 10000;
     static const TUint kTimerAliveAudioTimeoutMs = 3000;
     static const TUint kTimerExpiryTimeoutMs = 10000;
-    static const TUint kMaxSlaveCount = 4;
+    static const TUint kMaxSlaveCount = OhmRelayTree::kMaxReceivers - 1;
     static const TUint kTtl = 1;
 public:
     static const TUint kMaxNameBytes = 64;
@@ -105,6 +154,16 @@ public:
     void NotifyAudioPlaying(TBool aPlaying);
     void NotifyBroadcastAllowed(TBool aAllowed);
     void EnableUnicastOverride(TBool aEnable);
+    void SetFecGroupFrames(TUint aValue); // 0 disables forward error correction
+    void SetCompression(TBool aEnable); // FLAC encode audio for receivers that support this
+    void SetRelayFanOut(TUint aValue); // max receivers each unicast receiver relays to
+    /*
+     * Adapt latency to the reception receivers report, between aMinMs and aMaxMs.  The latency
+     * set via the ctor or SetLatency() remains a lower bound.  aMaxMs <= aMinMs disables adaptation.
+     */
+    void SetLatencyRange(TUint aMinMs, TUint aMaxMs, TUint aDefaultMs);
+    void SetLatencyObserver(IOhmLatencyObserver& aObserver); // notified whenever advertised latency changes
+    void WriteResendStats(WriterJsonArray& aWriter) const;
 private:
     void RunMulticast();
     void RunUnicast();
@@ -124,11 +183,17 @@ private:
     void SendTrack();
     void SendMetatext();
     void SendSlaveList();
+    void ConfigureRelayTree();
     void SendListen(const Endpoint& aEndpoint);
     void SendLeave(const Endpoint& aEndpoint);
     TUint FindSlave(const Endpoint& aEndpoint);
     void RemoveSlave(TUint aIndex);
     TBool CheckSlaveExpiry();
+    void NegotiateCapabilities(const OhmHeader& aHeader);
+    void HandleResend(const OhmHeader& aHeader);
+    void UpdateCapabilitiesLocked();
+    void UpdateLatency(TUint aLatency);
+    void UpdateLatencyLocked();
 private:
     Environment& iEnv;
     Net::DvDeviceStandard& iDevice;
@@ -166,6 +231,9 @@ private:
     TUint iSlaveCount;
     Endpoint iSlaveList[kMaxSlaveCount];
     TUint iSlaveExpiry[kMaxSlaveCount];
+    OhmRelayTree iRelayTree;
+    TUint iRelayFanOut;
+    TUint iRelaysNotified;
     Timer* iTimerAliveJoin;
     Timer* iTimerAliveAudio;
     Timer* iTimerExpiry;
@@ -175,6 +243,18 @@ private:
     TUint iSequenceTrack;
     TUint iSequenceMetatext;
     TBool iClientControllingTrackMetadata;
+    TUint iFecGroupFrames;
+    TUint iFecReceiverMaxGroupFrames;
+    TBool iFecLegacyReceiver;
+    TUint iFecLegacyReceiverExpiry;
+    TBool iCompression;
+    TBool iCapabilitiesHeard;
+    TBool iFlacUnsupportedReceiver;
+    TUint iFlacUnsupportedReceiverExpiry;
+    OhmResendStats iResendStats;
+    OhmLatencyController iLatencyController;
+    TUint iLatencyAdvertised;
+    IOhmLatencyObserver* iLatencyObserver;
 };
 
 } // namespace Av
@@ -16,7 +16,9 @@ public:
     virtual void SetTtl(TUint aValue) = 0;
     virtual void SetLatency(TUint aValue) = 0;
     virtual void SetTrackPosition(TUint64 aSampleStart, TUint64 aSamplesTotal) = 0;
-    virtual void Resend(const Brx& aFrames) = 0;
+    virtual TUint Resend(const Brx& aFrames) = 0; // returns number of frames resent
+    virtual void SetFec(TUint aGroupFrames) = 0; // 0 disables forward error correction
+    virtual void SetCompression(TBool aEnable) = 0;
     virtual void StreamInterrupted() = 0;
     virtual ~IOhmSenderDriver() {}
 };
@@ -11,6 +11,7 @@ using namespace OpenHome::Av;
 
 OhmSocket::OhmSocket(Environment& aEnv)
     : iEnv(aEnv)
+    , iUnicastSocket(nullptr)
     , iRxSocket(0)
     , iTxSocket(0)
     , iReader(0)
@@ -21,7 +22,7 @@ OhmSocket::OhmSocket(Environment& aEnv)
 
 OhmSocket::~OhmSocket()
 {
-    if (iRxSocket != 0) {
+    if (iRxSocket != 0 || iUnicastSocket != nullptr) {
         Close();
     }
 }
@@ -29,23 +30,23 @@ OhmSocket::~OhmSocket()
 void OhmSocket::OpenUnicast(TIpAddress aInterface, TUint aTtl)
 {
     AutoMutex _(iLock);
+    ASSERT(!iUnicastSocket);
     ASSERT(!iRxSocket);
     ASSERT(!iTxSocket);
     ASSERT(!iReader);
-    iRxSocket = new SocketUdp(iEnv, 0, aInterface);
-    iRxSocket->SetTtl(aTtl);
-    iRxSocket->SetRecvBufBytes(kReceiveBufBytes);
+    iUnicastSocket = new SocketUdpBatch(iEnv, kMaxDatagramBytes, 0, aInterface);
+    iUnicastSocket->SetTtl(aTtl);
+    iUnicastSocket->SetRecvBufBytes(kReceiveBufBytes);
     if (iInterrupt) {
-        iRxSocket->Interrupt(true);
+        iUnicastSocket->Interrupt(true);
     }
-//    iRxSocket->SetSendBufBytes(kSendBufBytes);    // hangs in lwip, use default allocation for now - ToDo
-    iReader = new UdpReader(*iRxSocket);
-    iThis.Replace(Endpoint(iRxSocket->Port(), aInterface));
+    iThis.Replace(Endpoint(iUnicastSocket->Port(), aInterface));
 }
 
 void OhmSocket::OpenMulticast(TIpAddress aInterface, TUint aTtl, const Endpoint& aEndpoint)
 {
     AutoMutex _(iLock);
+    ASSERT(!iUnicastSocket);
     ASSERT(!iRxSocket);
     ASSERT(!iTxSocket);
     ASSERT(!iReader);
@@ -67,11 +68,31 @@ void OhmSocket::Send(const Brx& aBuffer, const Endpoint& aEndpoint)
     if (iTxSocket != nullptr) {
         iTxSocket->Send(aBuffer, aEndpoint);
     }
-    else if (iRxSocket != nullptr) {
-        iRxSocket->Send(aBuffer, aEndpoint);
+    else if (iUnicastSocket != nullptr) {
+        iUnicastSocket->Send(aBuffer, aEndpoint);
     }
 }
 
+TUint OhmSocket::Send(const Brx& aBuffer, const Endpoint* aEndpoints, TUint aCount)
+{
+    ASSERT(aCount <= SocketUdpBatch::kMaxEndpoints);
+    if (iUnicastSocket != nullptr) {
+        return iUnicastSocket->Send(aBuffer, aEndpoints, aCount);
+    }
+    TUint failed = 0;
+    if (iTxSocket != nullptr) {
+        for (TUint i = 0; i < aCount; i++) {
+            try {
+                iTxSocket->Send(aBuffer, aEndpoints[i]);
+            }
+            catch (NetworkError&) {
+                failed |= 1u << i;
+            }
+        }
+    }
+    return failed;
+}
+
 Endpoint OhmSocket::This() const
 {
     return iThis;
@@ -79,6 +100,9 @@ Endpoint OhmSocket::This() const
 
 Endpoint OhmSocket::Sender() const
 {
+    if (iUnicastSocket != nullptr) {
+        return iSender;
+    }
     ASSERT(iReader);
     return iReader->Sender();
 }
@@ -89,6 +113,8 @@ void OhmSocket::Close()
     iInterrupt = false;
     delete iReader;
     iReader = nullptr;
+    delete iUnicastSocket;
+    iUnicastSocket = nullptr;
     delete iRxSocket;
     iRxSocket = nullptr;
     delete iTxSocket;
@@ -99,6 +125,9 @@ void OhmSocket::Interrupt(TBool aInterrupt)
 {
     AutoMutex _(iLock);
     iInterrupt = aInterrupt;
+    if (iUnicastSocket != nullptr) {
+        iUnicastSocket->Interrupt(aInterrupt);
+    }
     if (iRxSocket != nullptr) {
         iRxSocket->Interrupt(aInterrupt);
     }
@@ -109,12 +138,22 @@ void OhmSocket::Interrupt(TBool aInterrupt)
 
 void OhmSocket::Read(Bwx& aBuffer)
 {
+    if (iUnicastSocket != nullptr) {
+        try {
+            iSender.Replace(iUnicastSocket->Receive(aBuffer));
+        }
+        catch (NetworkError&) {
+            THROW(ReaderError);
+        }
+        return;
+    }
     ASSERT(iReader);
     iReader->Read(aBuffer);
 }
 
 void OhmSocket::ReadFlush()
 {
+    // each Read() from iUnicastSocket returns a whole datagram so there's nothing to discard
     if (iReader != nullptr) {
         iReader->ReadFlush();
     }
@@ -122,7 +161,10 @@ void OhmSocket::ReadFlush()
 
 void OhmSocket::ReadInterrupt()
 {
-    if (iReader != nullptr) {
+    if (iUnicastSocket != nullptr) {
+        iUnicastSocket->Interrupt(true);
+    }
+    else if (iReader != nullptr) {
         iReader->ReadInterrupt();
     }
 }
@@ -4,6 +4,7 @@
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Private/Stream.h>
 #include <OpenHome/Private/Network.h>
+#include <OpenHome/SocketUdpBatch.h>
 
 #include "Ohm.h"
 
@@ -11,10 +12,16 @@ namespace OpenHome {
 class Environment;
 namespace Av {
 
+/*
+ * In unicast mode, datagrams are read and written through a SocketUdpBatch so that
+ * a receiver relaying to its slaves, or catching up on a burst of audio/resends,
+ * makes one system call for several datagrams.  Multicast mode uses ohNet sockets.
+ */
 class OhmSocket : public IReaderSource, public INonCopyable
 {
     static const TUint kSendBufBytes = 16 * 1024;
     static const TUint kReceiveBufBytes = 64 * 1024;
+    static const TUint kMaxDatagramBytes = 8 * 1024;
 public:
     OhmSocket(Environment& aEnv);
     ~OhmSocket();
@@ -23,6 +30,13 @@ public:
     Endpoint This() const;
     Endpoint Sender() const;
     void Send(const Brx& aBuffer, const Endpoint& aEndpoint);
+    /*
+     * Send the same datagram to each of aCount (<= SocketUdpBatch::kMaxEndpoints) endpoints,
+     * e.g. a unicast receiver relaying to its slaves.  A failure for one endpoint doesn't
+     * prevent sends to the remainder.
+     * Returns a bitmask of endpoints that could not be sent to (bit n => aEndpoints[n]).
+     */
+    TUint Send(const Brx& aBuffer, const Endpoint* aEndpoints, TUint aCount);
     void Close();
     void Interrupt(TBool aInterrupt);
 public: // from IReaderSource
@@ -31,10 +45,12 @@ public: // from IReaderSource
     void ReadInterrupt() override;
 private:
     Environment& iEnv;
+    SocketUdpBatch* iUnicastSocket;
     SocketUdpBase* iRxSocket;
     SocketUdpBase* iTxSocket;
     UdpReader* iReader;
     Endpoint iThis;
+    Endpoint iSender;
     Mutex iLock;
     TBool iInterrupt;
 };
@@ -4,6 +4,7 @@
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Av/Songcast/OhmMsg.h>
 #include <OpenHome/Av/Songcast/Ohm.h>
+#include <OpenHome/Av/Songcast/OhmFlac.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Av/Debug.h>
 #include <OpenHome/Media/Debug.h>
@@ -48,8 +49,10 @@ ProtocolOhBase::ProtocolOhBase(Environment& aEnv, IOhmMsgFactory& aFactory, Medi
     , iBitDepth(0)
     , iSampleRate(0)
     , iNumChannels(0)
+    , iFlac(false)
     , iLatency(0)
     , iRepairFirst(nullptr)
+    , iResendFramesRequested(0)
     , iPipelineEmpty("OHBS", 0)
     , iOhmMsgProcessor(aOhmMsgProcessor)
 {
@@ -125,10 +128,28 @@ void ProtocolOhBase::SendListen()
 
 void ProtocolOhBase::Send(TUint aType)
 {
-    Bws<OhmHeader::kHeaderBytes> buffer;
+    Bws<OhmHeader::kHeaderBytes + OhmHeaderCapabilities::kHeaderBytes + OhmHeaderReception::kHeaderBytes> buffer;
     WriterBuffer writer(buffer);
-    OhmHeader msg(aType, 0);
-    msg.Externalise(writer);
+    if (aType == OhmHeader::kMsgTypeJoin) {
+        // advertise Fec and compressed audio support.  Older senders ignore any payload to these msgs
+        OhmHeaderCapabilities capabilities(OhmFec::kMaxGroupFrames, OhmHeaderCapabilities::kCodecFlac);
+        OhmHeader msg(aType, capabilities.MsgBytes());
+        msg.Externalise(writer);
+        capabilities.Externalise(writer);
+    }
+    else if (aType == OhmHeader::kMsgTypeListen) {
+        // as Join, plus a report on reception which the sender uses to choose its latency
+        OhmHeaderCapabilities capabilities(OhmFec::kMaxGroupFrames, OhmHeaderCapabilities::kCodecFlac);
+        const OhmHeaderReception reception = iReception.Report();
+        OhmHeader msg(aType, capabilities.MsgBytes() + reception.MsgBytes());
+        msg.Externalise(writer);
+        capabilities.Externalise(writer);
+        reception.Externalise(writer);
+    }
+    else {
+        OhmHeader msg(aType, 0);
+        msg.Externalise(writer);
+    }
     try {
         iSocket.Send(buffer, iEndpoint);
     }
@@ -136,6 +157,45 @@ void ProtocolOhBase::Send(TUint aType)
     }
 }
 
+TBool ProtocolOhBase::DeferListen(const OhmHeader& aHeader)
+{
+    /* Hearing another receiver's Listen msg normally lets us skip sending our own.
+       Send ours anyway if our reception is worse than they reported; senders choose a
+       latency that suits their worst receiver. */
+    OhmHeaderReception reception;
+    if (aHeader.MsgBytes() >= OhmHeaderCapabilities::kHeaderBytes + OhmHeaderReception::kHeaderBytes) {
+        OhmHeaderCapabilities capabilities;
+        capabilities.Internalise(iReadBuffer, aHeader);
+        reception.Internalise(iReadBuffer, aHeader);
+    }
+    return (iReception.RequiredLatencyMs() <= OhmLatency::RequiredMs(reception));
+}
+
+void ProtocolOhBase::ReadFec(const OhmHeader& aHeader)
+{
+    iHeaderFec.Internalise(iReadBuffer, aHeader);
+    if (iHeaderFec.ParityBytes() > iFecParity.MaxBytes()) {
+        THROW(OhmError);
+    }
+    ReaderBinary reader(iReadBuffer);
+    reader.ReadReplace(iHeaderFec.ParityBytes(), iFecParity);
+}
+
+void ProtocolOhBase::ExternaliseFec(IWriter& aWriter) const
+{
+    OhmHeader header(OhmHeader::kMsgTypeFec, iHeaderFec.MsgBytes());
+    header.Externalise(aWriter);
+    iHeaderFec.Externalise(aWriter);
+    aWriter.Write(iFecParity);
+}
+
+void ProtocolOhBase::AddFec()
+{
+    if (iFecDecoder.AddParity(iHeaderFec, iFecParity)) {
+        AddFecRecovered();
+    }
+}
+
 TBool ProtocolOhBase::IsCurrentStream(TUint aStreamId) const
 {
     if (iStreamId != aStreamId || aStreamId == IPipelineIdProvider::kStreamIdInvalid) {
@@ -211,7 +271,9 @@ ProtocolStreamResult ProtocolOhBase::Stream(const Brx& aUri)
     iSeqTrack = UINT_MAX;
     iLastSampleStart = UINT_MAX;
     iBitDepth = iSampleRate = iNumChannels = 0;
+    iFlac = false;
     iLatency = 0;
+    iReception.Reset();
     iStreamId = IPipelineIdProvider::kStreamIdInvalid;
     iTrackUri.Replace(Brx::Empty());
     iTrackMetadata.Replace(Brx::Empty());
@@ -255,7 +317,7 @@ TBool ProtocolOhBase::RepairBegin(OhmMsgAudio& aMsg)
 {
     LOG(kSongcast, "BEGIN ON %d\n", aMsg.Frame());
     iRepairFirst = &aMsg;
-    iTimerRepair->FireIn(iEnv.Random(kInitialRepairTimeoutMs));
+    iTimerRepair->FireIn(iEnv.Random(kInitialRepairTimeoutMs) + FecHoldoffMs(aMsg));
     return true;
 }
 
@@ -275,6 +337,7 @@ void ProtocolOhBase::RepairReset()
         iRepairFrames[i]->RemoveRef();
     }
     iRepairFrames.clear();
+    iFecDecoder.Reset();
     iRunning = false;
     iRepairing = false; // FIXME - not absolutely required as test for iRunning takes precedence in Process(OhmMsgAudio&
     iStreamMsgDue = true; // a failed repair implies a discontinuity in audio.  This should be noted as a new stream.
@@ -441,6 +504,7 @@ void ProtocolOhBase::TimerRepairExpired()
         }
         LOG(kSongcast, "\n");
 
+        iResendFramesRequested += count;
         RequestResend(missed);
         iTimerRepair->FireIn(kSubsequentRepairTimeoutMs);
     }
@@ -458,11 +522,43 @@ void ProtocolOhBase::AddRxTimestamp(OhmMsgAudio& aMsg)
     }
 }
 
+TUint ProtocolOhBase::FecHoldoffMs(const OhmMsgAudio& aMsg) const
+{
+    /* A missing frame may be rebuilt once the Fec msg for its group arrives.
+       Delay requesting a resend until then, but not so long that a resend wouldn't arrive in time. */
+    const TUint groupFrames = iFecDecoder.GroupFrames();
+    if (groupFrames == 0 || aMsg.SampleRate() == 0) {
+        return 0;
+    }
+    const TUint holdoffMs = groupFrames * aMsg.Samples() * 1000 / aMsg.SampleRate();
+    if (holdoffMs > kMaxFecHoldoffMs) {
+        return kMaxFecHoldoffMs;
+    }
+    return holdoffMs;
+}
+
+void ProtocolOhBase::AddFecRecovered()
+{
+    if (iFecDecoder.Recovered().Bytes() == 0) {
+        return; // decoder was reset while processing the frame that allowed recovery
+    }
+    ReaderBuffer reader(iFecDecoder.Recovered());
+    OhmHeader header;
+    header.Internalise(reader);
+    OhmMsgAudio* msg = iMsgFactory.CreateAudio(reader, header);
+    // treat as a resend so that it is quietly discarded if a resend has already filled the gap
+    msg->SetResent(true);
+    LOG(kSongcast, "FEC RECOVERED %u (recovered: %u, resend requested: %u)\n",
+                   msg->Frame(), iFecDecoder.FramesRecovered(), iResendFramesRequested);
+    Add(msg);
+}
+
 void ProtocolOhBase::OutputAudio(OhmMsgAudio& aMsg)
 {
     TBool startOfStream = false;
+    const TBool flac = (aMsg.Codec() == OhmFlac::kCodecName);
     if (aMsg.SampleStart() < iLastSampleStart || iBitDepth != aMsg.BitDepth() ||
-        iSampleRate != aMsg.SampleRate() || iNumChannels != aMsg.Channels()) {
+        iSampleRate != aMsg.SampleRate() || iNumChannels != aMsg.Channels() || iFlac != flac) {
         startOfStream = true;
         iStreamMsgDue = true;
 
@@ -475,16 +571,27 @@ void ProtocolOhBase::OutputAudio(OhmMsgAudio& aMsg)
     }
     iLastSampleStart = aMsg.SampleStart();
     if (iStreamMsgDue) {
-        const TUint64 totalBytes = static_cast<TUint64>(aMsg.SamplesTotal()) * aMsg.Channels() * aMsg.BitDepth()/8;
         iStreamId = iIdProvider->NextStreamId();
-        PcmStreamInfo pcmStream;
-        pcmStream.Set(aMsg.BitDepth(), aMsg.SampleRate(), aMsg.Channels(), AudioDataEndian::Big, SpeakerProfile((aMsg.Channels() == 1) ? 1 : 2), aMsg.SampleStart());
-        pcmStream.SetCodec(aMsg.Codec(), true);
-        iSupply->OutputPcmStream(iTrackUri, totalBytes, false/*seekable*/, false/*live*/, Multiroom::Forbidden, *this, iStreamId, pcmStream);
+        if (flac) {
+            /* Each msg holds a single FLAC frame.  Prefix these with a stream header so the
+               pipeline's FLAC codec can decode them. */
+            iSupply->OutputStream(iTrackUri, 0/*totalBytes*/, 0/*startPos*/, false/*seekable*/, false/*live*/, Multiroom::Forbidden, *this, iStreamId);
+            Bws<OhmFlac::kStreamHeaderBytes> flacHeader;
+            OhmFlac::WriteStreamHeader(flacHeader, aMsg.SampleRate(), aMsg.BitDepth(), aMsg.Channels(), aMsg.SamplesTotal());
+            iSupply->OutputData(flacHeader);
+        }
+        else {
+            const TUint64 totalBytes = static_cast<TUint64>(aMsg.SamplesTotal()) * aMsg.Channels() * aMsg.BitDepth()/8;
+            PcmStreamInfo pcmStream;
+            pcmStream.Set(aMsg.BitDepth(), aMsg.SampleRate(), aMsg.Channels(), AudioDataEndian::Big, SpeakerProfile((aMsg.Channels() == 1) ? 1 : 2), aMsg.SampleStart());
+            pcmStream.SetCodec(aMsg.Codec(), true);
+            iSupply->OutputPcmStream(iTrackUri, totalBytes, false/*seekable*/, false/*live*/, Multiroom::Forbidden, *this, iStreamId, pcmStream);
+        }
         iStreamMsgDue = false;
         iBitDepth = aMsg.BitDepth();
         // iSampleRate updated below
         iNumChannels = aMsg.Channels();
+        iFlac = flac;
     }
     if (iSampleRate != aMsg.SampleRate() || iLatency != aMsg.MediaLatency()) {
         iSampleRate = aMsg.SampleRate();
@@ -500,7 +607,9 @@ void ProtocolOhBase::OutputAudio(OhmMsgAudio& aMsg)
         iPendingMetatext.Replace(Brx::Empty());
         iMetatextMsgDue = false;
     }
-    iSupply->OutputData(aMsg.Audio());
+    if (aMsg.Audio().Bytes() > 0) {
+        iSupply->OutputData(aMsg.Audio());
+    }
     const TBool halt = aMsg.Halt();
     if (halt) {
         iSupply->OutputWait();
@@ -515,6 +624,10 @@ void ProtocolOhBase::OutputAudio(OhmMsgAudio& aMsg)
 void ProtocolOhBase::Process(OhmMsgAudio& aMsg)
 {
     AddRxTimestamp(aMsg);
+    if (!aMsg.Resent()) {
+        iReception.Add(aMsg.Frame(), aMsg.SampleStart(), aMsg.SampleRate(), aMsg.Halt(), Os::TimeInUs(iEnv.OsCtx()));
+    }
+    const TBool fecRecovered = iFecDecoder.AddFrame(aMsg.Frame(), aMsg.SendableBuffer());
 
     TBool outputAudio = false;
     {
@@ -550,6 +663,9 @@ void ProtocolOhBase::Process(OhmMsgAudio& aMsg)
     if (outputAudio) {
         OutputAudio(aMsg);
     }
+    if (fecRecovered) {
+        AddFecRecovered();
+    }
 }
 
 void ProtocolOhBase::Process(OhmMsgTrack& aMsg)
@@ -8,6 +8,8 @@
 #include <OpenHome/Private/Standard.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Av/Songcast/OhmMsg.h>
+#include <OpenHome/Av/Songcast/OhmFec.h>
+#include <OpenHome/Av/Songcast/OhmLatency.h>
 #include <OpenHome/Av/Songcast/OhmSocket.h>
 #include <OpenHome/Av/Songcast/OhmTimestamp.h>
 #include <OpenHome/Private/Stream.h>
@@ -28,6 +30,7 @@ class ProtocolOhBase : public Media::Protocol, private IOhmMsgProcessor
     static const TUint kMaxRepairMissedFrames = 20;
     static const TUint kInitialRepairTimeoutMs = 10;
     static const TUint kSubsequentRepairTimeoutMs = 30;
+    static const TUint kMaxFecHoldoffMs = 100;
     static const TUint kTimerJoinTimeoutMs = 300;
     static const TUint kTtl = 2;
 protected:
@@ -41,9 +44,13 @@ protected:
     void SendJoin();
     void SendListen();
     void Send(TUint aType);
+    TBool DeferListen(const OhmHeader& aHeader);
     TBool IsCurrentStream(TUint aStreamId) const;
     void WaitForPipelineToEmpty();
     void AddRxTimestamp(OhmMsgAudio& aMsg);
+    void ReadFec(const OhmHeader& aHeader);
+    void ExternaliseFec(IWriter& aWriter) const;
+    void AddFec();
 private:
     virtual Media::ProtocolStreamResult Play(TIpAddress aInterface, TUint aTtl, const Endpoint& aEndpoint) = 0;
 protected: // from Media::Protocol
@@ -62,6 +69,8 @@ private:
     TBool RepairBegin(OhmMsgAudio& aMsg);
     TBool Repair(OhmMsgAudio& aMsg);
     void OutputAudio(OhmMsgAudio& aMsg);
+    TUint FecHoldoffMs(const OhmMsgAudio& aMsg) const;
+    void AddFecRecovered();
 private: // from IOhmMsgProcessor
     void Process(OhmMsgAudio& aMsg) override;
     void Process(OhmMsgTrack& aMsg) override;
@@ -103,10 +112,16 @@ private:
     TUint iBitDepth;
     TUint iSampleRate;
     TUint iNumChannels;
+    TBool iFlac;
     TUint64 iLatency;
     OhmMsgAudio* iRepairFirst;
     std::vector<OhmMsgAudio*> iRepairFrames;
     Timer* iTimerRepair;
+    OhmFecDecoder iFecDecoder;
+    OhmHeaderFec iHeaderFec;
+    Bws<OhmFec::kMaxFrameBytes> iFecParity;
+    TUint iResendFramesRequested;
+    OhmReceptionMonitor iReception;
     Media::BwsTrackUri iTrackUri;
     Media::BwsTrackMetaData iTrackMetadata;
     Semaphore iPipelineEmpty;
@@ -133,6 +133,7 @@ ProtocolStreamResult ProtocolOhm::Play(TIpAddress aInterface, TUint aTtl, const
                     case OhmHeader::kMsgTypeListen:
                     case OhmHeader::kMsgTypeLeave:
                     case OhmHeader::kMsgTypeSlave:
+                    case OhmHeader::kMsgTypeFec:
                         break;
                     case OhmHeader::kMsgTypeAudio:
                     {
@@ -188,7 +189,9 @@ ProtocolStreamResult ProtocolOhm::Play(TIpAddress aInterface, TUint aTtl, const
                     case OhmHeader::kMsgTypeSlave:
                         break;
                     case OhmHeader::kMsgTypeListen:
-                        iTimerListen->FireIn((kTimerListenTimeoutMs >> 1) - iEnv.Random(kTimerListenTimeoutMs >> 3)); // listen secondary timeout
+                        if (DeferListen(header)) {
+                            iTimerListen->FireIn((kTimerListenTimeoutMs >> 1) - iEnv.Random(kTimerListenTimeoutMs >> 3)); // listen secondary timeout
+                        }
                         break;
                     case OhmHeader::kMsgTypeAudio:
                         Add(iMsgFactory.CreateAudio(iReadBuffer, header));
@@ -202,6 +205,10 @@ ProtocolStreamResult ProtocolOhm::Play(TIpAddress aInterface, TUint aTtl, const
                     case OhmHeader::kMsgTypeResend:
                         ResendSeen();
                         break;
+                    case OhmHeader::kMsgTypeFec:
+                        ReadFec(header);
+                        AddFec();
+                        break;
                     }
 
                     iReadBuffer.ReadFlush();
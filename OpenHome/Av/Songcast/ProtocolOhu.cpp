@@ -64,6 +64,10 @@ void ProtocolOhu::HandleSlave(const OhmHeader& aHeader)
     OhmHeaderSlave headerSlave;
     headerSlave.Internalise(iReadBuffer, aHeader);
     iSlaveCount = headerSlave.SlaveCount();
+    if (iSlaveCount > kMaxSlaveCount) {
+        LOG_ERROR(kSongcast, "ProtocolOhu - ignoring %u of %u slaves\n", iSlaveCount - kMaxSlaveCount, iSlaveCount);
+        iSlaveCount = kMaxSlaveCount;
+    }
 
     for (TUint i = 0; i < iSlaveCount; i++) {
         iSlaveList[i].Internalise(iReadBuffer);
@@ -75,27 +79,42 @@ void ProtocolOhu::HandleSlave(const OhmHeader& aHeader)
     }
 }
 
+void ProtocolOhu::HandleFec(const OhmHeader& aHeader)
+{
+    ReadFec(aHeader);
+    if (iSlaveCount > 0) {
+        WriterBuffer writer(iMessageBuffer);
+        writer.Flush();
+        ExternaliseFec(writer);
+        SendToSlaves("HandleFec");
+    }
+    AddFec();
+}
+
 void ProtocolOhu::Broadcast(OhmMsg* aMsg)
 {
     if (iSlaveCount > 0) {
         WriterBuffer writer(iMessageBuffer);
         writer.Flush();
         aMsg->Externalise(writer);
-        for (TUint i = 0; i < iSlaveCount; i++) {
-            try {
-                iSocket.Send(iMessageBuffer, iSlaveList[i]);
-            }
-            catch (NetworkError&) {
-                Endpoint::EndpointBuf buf;
-                iSlaveList[i].AppendEndpoint(buf);
-                LOG_ERROR(kApplication6, "NetworkError in ProtocolOhu::Broadcast for slave %s\n", buf.Ptr());
-            }
-        }
+        SendToSlaves("Broadcast");
     }
 
     Add(aMsg);
 }
 
+void ProtocolOhu::SendToSlaves(const TChar* aCaller)
+{
+    const TUint failed = iSocket.Send(iMessageBuffer, iSlaveList, iSlaveCount);
+    for (TUint i = 0; failed != 0 && i < iSlaveCount; i++) {
+        if ((failed & (1 << i)) != 0) {
+            Endpoint::EndpointBuf buf;
+            iSlaveList[i].AppendEndpoint(buf);
+            LOG_ERROR(kApplication6, "NetworkError in ProtocolOhu::%s for slave %s\n", aCaller, buf.Ptr());
+        }
+    }
+}
+
 ProtocolStreamResult ProtocolOhu::Play(TIpAddress /*aInterface*/, TUint aTtl, const Endpoint& aEndpoint)
 {
     LOG(kSongcast, "OHU: Play(%08x, %u, %08x:%u\n", iAddr, aTtl, aEndpoint.Address(), aEndpoint.Port());
@@ -160,6 +179,7 @@ ProtocolStreamResult ProtocolOhu::Play(TIpAddress /*aInterface*/, TUint aTtl, co
                     case OhmHeader::kMsgTypeJoin:
                     case OhmHeader::kMsgTypeListen:
                     case OhmHeader::kMsgTypeLeave:
+                    case OhmHeader::kMsgTypeFec:
                         break;
                     case OhmHeader::kMsgTypeAudio:
                     {
@@ -240,6 +260,9 @@ ProtocolStreamResult ProtocolOhu::Play(TIpAddress /*aInterface*/, TUint aTtl, co
                     case OhmHeader::kMsgTypeResend:
                         ResendSeen();
                         break;
+                    case OhmHeader::kMsgTypeFec:
+                        HandleFec(header);
+                        break;
                     default:
                         ASSERTS();
                     }
@@ -3,6 +3,7 @@
 #include <OpenHome/Types.h>
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Av/Songcast/ProtocolOhBase.h>
+#include <OpenHome/Av/Songcast/OhmRelayTree.h>
 #include <OpenHome/Private/Network.h>
 
 namespace OpenHome {
@@ -18,7 +19,7 @@ class IOhmMsgFactory;
 class ProtocolOhu : public ProtocolOhBase
 {
     static const TUint kTimerLeaveTimeoutMs = 50;
-    static const TUint kMaxSlaveCount = 4;
+    static const TUint kMaxSlaveCount = OhmRelayTree::kMaxFanOut;
 public:
     ProtocolOhu(Environment& aEnv, IOhmMsgFactory& aFactory, Media::TrackFactory& aTrackFactory,
                 Optional<IOhmTimestamper> aTimestamper, const Brx& aMode,
@@ -35,7 +36,9 @@ private:
     void HandleTrack(const OhmHeader& aHeader);
     void HandleMetatext(const OhmHeader& aHeader);
     void HandleSlave(const OhmHeader& aHeader);
+    void HandleFec(const OhmHeader& aHeader);
     void Broadcast(OhmMsg* aMsg);
+    void SendToSlaves(const TChar* aCaller);
     void SendLeave();
     void TimerLeaveExpired();
 private:
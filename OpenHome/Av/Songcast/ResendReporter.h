@@ -0,0 +1,17 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+
+namespace OpenHome {
+    class WriterJsonArray;
+namespace Av {
+
+class ISongcastResendReporter
+{
+public:
+    virtual void WriteResendStats(WriterJsonArray& aWriter) = 0; // one object per receiver
+    virtual ~ISongcastResendReporter() {}
+};
+
+} // namespace Av
+} // namespace OpenHome
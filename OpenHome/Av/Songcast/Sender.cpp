@@ -32,6 +32,11 @@ const Brn Sender::kConfigIdEnabled("Sender.Enabled");
 const Brn Sender::kConfigIdChannel("Sender.Channel");
 const Brn Sender::kConfigIdMode("Sender.Mode");
 const Brn Sender::kConfigIdPreset("Sender.Preset");
+const Brn Sender::kConfigIdFecGroupFrames("Sender.FecGroupFrames");
+const Brn Sender::kConfigIdCompression("Sender.Compression");
+const Brn Sender::kConfigIdRelayFanOut("Sender.RelayFanOut");
+const Brn Sender::kConfigIdResendHistoryMs("Sender.ResendHistoryMs");
+const Brn Sender::kConfigIdLatencyMaxMs("Sender.LatencyMaxMs");
 
 Sender::Sender(Environment& aEnv,
                Net::DvDeviceStandard& aDevice,
@@ -42,8 +47,12 @@ Sender::Sender(Environment& aEnv,
                const Brx& aName,
                TUint aMinLatencyMs,
                const Brx& aSongcastMode,
-               IUnicastOverrideObserver& aUnicastOverrideObserver)
-    : iAudioBuf(nullptr)
+               IUnicastOverrideObserver& aUnicastOverrideObserver,
+               IOhmLatencyObserver& aLatencyObserver)
+    : iLockLatency("SNDL")
+    , iLatencyMaxMs(aMinLatencyMs)
+    , iLatencyAdaptive(false)
+    , iAudioBuf(nullptr)
     , iSampleRate(0)
     , iMinLatencyMs(aMinLatencyMs)
     , iSongcastMode(aSongcastMode)
@@ -58,6 +67,7 @@ Sender::Sender(Environment& aEnv,
     // create sender with default configuration.  CongfigVals below will each call back on construction, allowing these to be updated
     iOhmSender = new OhmSender(aEnv, aDevice, *iOhmSenderDriver, aZoneHandler, aThreadPriority,
                                aName, defaultChannel, aMinLatencyMs, false/*unicast*/);
+    iOhmSender->SetLatencyObserver(aLatencyObserver);
 
     iConfigChannel = new ConfigNum(aConfigInit, kConfigIdChannel, kChannelMin, kChannelMax, defaultChannel);
     iListenerIdConfigChannel = iConfigChannel->Subscribe(MakeFunctorConfigNum(*this, &Sender::ConfigChannelChanged));
@@ -71,9 +81,28 @@ Sender::Sender(Environment& aEnv,
     iConfigPreset = new ConfigNum(aConfigInit, kConfigIdPreset, kPresetMin, kPresetMax, kPresetNone);
     iListenerIdConfigPreset = iConfigPreset->Subscribe(MakeFunctorConfigNum(*this, &Sender::ConfigPresetChanged));
 
+    iConfigFecGroupFrames = new ConfigNum(aConfigInit, kConfigIdFecGroupFrames, kFecGroupFramesMin, OhmFec::kMaxGroupFrames, kFecGroupFramesDefault);
+    iListenerIdConfigFecGroupFrames = iConfigFecGroupFrames->Subscribe(MakeFunctorConfigNum(*this, &Sender::ConfigFecGroupFramesChanged));
+
+    iConfigRelayFanOut = new ConfigNum(aConfigInit, kConfigIdRelayFanOut, kRelayFanOutMin, OhmRelayTree::kMaxFanOut, OhmRelayTree::kMaxFanOut);
+    iListenerIdConfigRelayFanOut = iConfigRelayFanOut->Subscribe(MakeFunctorConfigNum(*this, &Sender::ConfigRelayFanOutChanged));
+
+    iConfigResendHistoryMs = new ConfigNum(aConfigInit, kConfigIdResendHistoryMs, kResendHistoryMsMin,
+                                           OhmSenderDriver::kMaxHistoryFrames * kSongcastPacketMs, kResendHistoryMsDefault);
+    iListenerIdConfigResendHistoryMs = iConfigResendHistoryMs->Subscribe(MakeFunctorConfigNum(*this, &Sender::ConfigResendHistoryMsChanged));
+
+    const TInt latencyMaxMin = (TInt)aMinLatencyMs;
+    const TInt latencyMaxMax = std::max(latencyMaxMin, kLatencyMaxMsMax);
+    const TInt latencyMaxDefault = std::min(std::max(latencyMaxMin, kLatencyMaxMsDefault), latencyMaxMax);
+    iConfigLatencyMaxMs = new ConfigNum(aConfigInit, kConfigIdLatencyMaxMs, latencyMaxMin, latencyMaxMax, latencyMaxDefault);
+    iListenerIdConfigLatencyMaxMs = iConfigLatencyMaxMs->Subscribe(MakeFunctorConfigNum(*this, &Sender::ConfigLatencyMaxMsChanged));
+
     choices.clear();
     choices.push_back(eStringIdNo);
     choices.push_back(eStringIdYes);
+    iConfigCompression = new ConfigChoice(aConfigInit, kConfigIdCompression, choices, eStringIdNo);
+    iListenerIdConfigCompression = iConfigCompression->Subscribe(MakeFunctorConfigChoice(*this, &Sender::ConfigCompressionChanged));
+
     iConfigEnabled = new ConfigChoice(aConfigInit, kConfigIdEnabled, choices, eStringIdYes);
     iListenerIdConfigEnabled = iConfigEnabled->Subscribe(MakeFunctorConfigChoice(*this, &Sender::ConfigEnabledChanged));
 
@@ -92,6 +121,16 @@ Sender::~Sender()
     delete iConfigMode;
     iConfigPreset->Unsubscribe(iListenerIdConfigPreset);
     delete iConfigPreset;
+    iConfigFecGroupFrames->Unsubscribe(iListenerIdConfigFecGroupFrames);
+    delete iConfigFecGroupFrames;
+    iConfigCompression->Unsubscribe(iListenerIdConfigCompression);
+    delete iConfigCompression;
+    iConfigRelayFanOut->Unsubscribe(iListenerIdConfigRelayFanOut);
+    delete iConfigRelayFanOut;
+    iConfigResendHistoryMs->Unsubscribe(iListenerIdConfigResendHistoryMs);
+    delete iConfigResendHistoryMs;
+    iConfigLatencyMaxMs->Unsubscribe(iListenerIdConfigLatencyMaxMs);
+    delete iConfigLatencyMaxMs;
 }
 
 void Sender::SetName(const Brx& aName)
@@ -117,6 +156,11 @@ void Sender::Push(Msg* aMsg)
     }
 }
 
+void Sender::WriteResendStats(WriterJsonArray& aWriter)
+{
+    iOhmSender->WriteResendStats(aWriter);
+}
+
 Msg* Sender::ProcessMsg(MsgMode* aMsg)
 {
     const TBool wasEnabled = iEnabled;
@@ -134,6 +178,18 @@ Msg* Sender::ProcessMsg(MsgMode* aMsg)
         }
         iUnicastOverrideObserver.UnicastOverrideEnabled();
     }
+
+    /* Modes that manage their own latency (e.g. to stay in sync with other devices) rely on
+       local playback being delayed by exactly the amount they requested.  Only adapt songcast
+       latency to receivers' reception for other modes. */
+    const TBool adaptive = (iEnabled && aMsg->Info().LatencyMode() == Latency::NotSupported);
+    iLockLatency.Wait();
+    const TBool changed = (adaptive != iLatencyAdaptive);
+    iLatencyAdaptive = adaptive;
+    iLockLatency.Signal();
+    if (changed) {
+        UpdateLatencyRange();
+    }
     aMsg->RemoveRef();
     return nullptr;
 }
@@ -347,6 +403,42 @@ void Sender::ConfigPresetChanged(KeyValuePair<TInt>& aKvp)
     iOhmSender->SetPreset(aKvp.Value());
 }
 
+void Sender::ConfigFecGroupFramesChanged(KeyValuePair<TInt>& aKvp)
+{
+    iOhmSender->SetFecGroupFrames(aKvp.Value());
+}
+
+void Sender::ConfigCompressionChanged(KeyValuePair<TUint>& aStringId)
+{
+    iOhmSender->SetCompression(aStringId.Value() == eStringIdYes);
+}
+
+void Sender::ConfigRelayFanOutChanged(KeyValuePair<TInt>& aKvp)
+{
+    iOhmSender->SetRelayFanOut(aKvp.Value());
+}
+
+void Sender::ConfigResendHistoryMsChanged(KeyValuePair<TInt>& aKvp)
+{
+    // each audio msg carries kSongcastPacketMs of audio
+    iOhmSenderDriver->SetHistoryFrames(aKvp.Value() / kSongcastPacketMs);
+}
+
+void Sender::ConfigLatencyMaxMsChanged(KeyValuePair<TInt>& aKvp)
+{
+    iLockLatency.Wait();
+    iLatencyMaxMs = aKvp.Value();
+    iLockLatency.Signal();
+    UpdateLatencyRange();
+}
+
+void Sender::UpdateLatencyRange()
+{
+    AutoMutex _(iLockLatency);
+    const TUint maxMs = (iLatencyAdaptive? iLatencyMaxMs : iMinLatencyMs);
+    iOhmSender->SetLatencyRange(iMinLatencyMs, maxMs, iMinLatencyMs);
+}
+
 // FIXME: review how this mapping is generated
 TUint Sender::FirstChannelToSend(TUint aNumChannels)
 {
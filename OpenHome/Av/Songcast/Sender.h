@@ -6,6 +6,8 @@
 #include <OpenHome/Optional.h>
 #include <OpenHome/Media/PipelineObserver.h>
 #include <OpenHome/Configuration/ConfigManager.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Av/Songcast/ResendReporter.h>
 
 #include <vector>
 
@@ -20,18 +22,31 @@ class OhmSender;
 class ZoneHandler;
 class IOhmTimestamper;
 class IUnicastOverrideObserver;
+class IOhmLatencyObserver;
 
-class Sender : public Media::IPipelineElementDownstream, private Media::IMsgProcessor, private Media::IPcmProcessor, private INonCopyable
+class Sender : public Media::IPipelineElementDownstream, public ISongcastResendReporter, private Media::IMsgProcessor, private Media::IPcmProcessor, private INonCopyable
 {
     static const Brn kConfigIdEnabled;
     static const Brn kConfigIdChannel;
     static const Brn kConfigIdMode;
     static const Brn kConfigIdPreset;
+    static const Brn kConfigIdFecGroupFrames;
+    static const Brn kConfigIdCompression;
+    static const Brn kConfigIdRelayFanOut;
+    static const Brn kConfigIdResendHistoryMs;
+    static const Brn kConfigIdLatencyMaxMs;
     static const TInt kChannelMin = 0;
     static const TInt kChannelMax = 65535;
     static const TInt kPresetMin = 0;
     static const TInt kPresetMax = 0x7fffffff;
     static const TInt kPresetNone = 0;
+    static const TInt kFecGroupFramesMin = 0; // Fec disabled
+    static const TInt kFecGroupFramesDefault = 0;
+    static const TInt kRelayFanOutMin = 1;
+    static const TInt kResendHistoryMsMin = 100;
+    static const TInt kResendHistoryMsDefault = 500;
+    static const TInt kLatencyMaxMsMax = 1000;
+    static const TInt kLatencyMaxMsDefault = 500;
     static const TUint kSongcastPacketMs = 5;
     static const TUint kSongcastPacketJiffies = Media::Jiffies::kPerMs * kSongcastPacketMs;
     static const TUint kSongcastPacketMaxBytes = 3 * Media::DecodedAudio::kMaxNumChannels * 192 * kSongcastPacketMs;
@@ -45,13 +60,16 @@ public:
            const Brx& aName,
            TUint aMinLatencyMs,
            const Brx& aSongcastMode,
-           IUnicastOverrideObserver& aUnicastOverrideObserver);
+           IUnicastOverrideObserver& aUnicastOverrideObserver,
+           IOhmLatencyObserver& aLatencyObserver);
     ~Sender();
     void SetName(const Brx& aName);
     void SetImageUri(const Brx& aUri);
     void NotifyPipelineState(Media::EPipelineState aState);
 private: // from Media::IPipelineElementDownstream
     void Push(Media::Msg* aMsg) override;
+private: // from ISongcastResendReporter
+    void WriteResendStats(WriterJsonArray& aWriter) override;
 private: // from Media::IMsgProcessor
     Media::Msg* ProcessMsg(Media::MsgMode* aMsg) override;
     Media::Msg* ProcessMsg(Media::MsgTrack* aMsg) override;
@@ -78,6 +96,12 @@ private:
     void ConfigChannelChanged(Configuration::KeyValuePair<TInt>& aValue);
     void ConfigModeChanged(Configuration::KeyValuePair<TUint>& aStringId);
     void ConfigPresetChanged(Configuration::KeyValuePair<TInt>& aValue);
+    void ConfigFecGroupFramesChanged(Configuration::KeyValuePair<TInt>& aValue);
+    void ConfigCompressionChanged(Configuration::KeyValuePair<TUint>& aStringId);
+    void ConfigRelayFanOutChanged(Configuration::KeyValuePair<TInt>& aValue);
+    void ConfigResendHistoryMsChanged(Configuration::KeyValuePair<TInt>& aValue);
+    void ConfigLatencyMaxMsChanged(Configuration::KeyValuePair<TInt>& aValue);
+    void UpdateLatencyRange();
 private:
     static TUint FirstChannelToSend(TUint aNumChannels);
     void DoProcessFragment(const Brx& aData, TUint aNumChannels, TUint aBytesPerSample);
@@ -126,6 +150,19 @@ private:
     TUint iListenerIdConfigMode;
     Configuration::ConfigNum* iConfigPreset;
     TUint iListenerIdConfigPreset;
+    Configuration::ConfigNum* iConfigFecGroupFrames;
+    TUint iListenerIdConfigFecGroupFrames;
+    Configuration::ConfigChoice* iConfigCompression;
+    TUint iListenerIdConfigCompression;
+    Configuration::ConfigNum* iConfigRelayFanOut;
+    TUint iListenerIdConfigRelayFanOut;
+    Configuration::ConfigNum* iConfigResendHistoryMs;
+    TUint iListenerIdConfigResendHistoryMs;
+    Configuration::ConfigNum* iConfigLatencyMaxMs;
+    TUint iListenerIdConfigLatencyMaxMs;
+    Mutex iLockLatency;
+    TUint iLatencyMaxMs;
+    TBool iLatencyAdaptive; // current mode leaves songcast latency to us
     std::vector<Media::MsgAudio*> iPendingAudio;
     Bwx* iAudioBuf;
     TUint iSampleRate;
@@ -20,6 +20,7 @@
 #include <OpenHome/Av/Songcast/EnableProcessor.h>
 #include <OpenHome/Media/SenderThread.h>
 #include <OpenHome/Av/Songcast/Sender.h>
+#include <OpenHome/Av/Songcast/OhmLatency.h>
 #include <OpenHome/Av/Product.h>
 #include <OpenHome/Configuration/ConfigManager.h>
 #include <OpenHome/Private/Debug.h>
@@ -111,6 +112,7 @@ private:
 
 class SongcastSender : private Media::IPipelineObserver
                      , private IProductObserver
+                     , private IOhmLatencyObserver
 {
 public:
     SongcastSender(IMediaPlayer& aMediaPlayer, ZoneHandler& aZoneHandler,
@@ -130,10 +132,13 @@ private: // from IProductObserver
     void SourceIndexChanged() override;
     void SourceXmlChanged() override;
     void ProductUrisChanged() override;
+private: // from IOhmLatencyObserver
+    void NotifySongcastLatency(TUint aLatencyMs) override;
 private:
     void FriendlyNameChanged(const Brx& aName);
 private:
     Mutex iLock;
+    Media::PipelineManager& iPipeline;
     Media::SenderThread* iSenderThread;
     Sender* iSender;
     Product& iProduct;
@@ -506,6 +511,7 @@ SongcastSender::SongcastSender(IMediaPlayer& aMediaPlayer, ZoneHandler& aZoneHan
                                Optional<IOhmTimestamper> aTxTimestamper, const Brx& aMode,
                                IUnicastOverrideObserver& aUnicastOverrideObserver)
     : iLock("STX1")
+    , iPipeline(aMediaPlayer.Pipeline())
     , iProduct(aMediaPlayer.Product())
     , iFriendlyNameObservable(aMediaPlayer.FriendlyNameObservable())
 {
@@ -520,7 +526,8 @@ SongcastSender::SongcastSender(IMediaPlayer& aMediaPlayer, ZoneHandler& aZoneHan
     iSender = new Sender(aMediaPlayer.Env(), aMediaPlayer.Device(), aZoneHandler,
                          aTxTimestamper, aMediaPlayer.ConfigInitialiser(), senderThreadPriority,
                          Brx::Empty(), pipeline.SenderMinLatencyMs(), aMode,
-                         aUnicastOverrideObserver);
+                         aUnicastOverrideObserver, *this);
+    aMediaPlayer.SetSongcastResendReporter(*iSender);
     iLoggerSender = new Logger("Sender", *iSender);
     //iLoggerSender->SetEnabled(true);
     //iLoggerSender->SetFilter(Logger::EMsgAll);
@@ -596,6 +603,12 @@ void SongcastSender::ProductUrisChanged()
     iSender->SetImageUri(imageUri);
 }
 
+void SongcastSender::NotifySongcastLatency(TUint aLatencyMs)
+{
+    // keep local playback in sync with receivers
+    iPipeline.SetSenderLatencyMs(aLatencyMs);
+}
+
 void SongcastSender::FriendlyNameChanged(const Brx& aName)
 {
     iSender->SetName(aName);
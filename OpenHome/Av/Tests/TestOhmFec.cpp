@@ -0,0 +1,417 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/SuiteUnitTest.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Converter.h>
+#include <OpenHome/Av/Songcast/Ohm.h>
+#include <OpenHome/Av/Songcast/OhmMsg.h>
+#include <OpenHome/Av/Songcast/OhmFec.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+namespace OpenHome {
+namespace Av {
+
+class SuiteOhmFec : public SuiteUnitTest
+{
+    static const TUint kGroupFrames = 8;
+    static const TUint kSampleRate = 44100;
+    static const TUint kBitDepth = 16;
+    static const TUint kChannels = 2;
+    static const TUint kLatency = 100;
+public:
+    SuiteOhmFec();
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestHeaderRoundTrip();
+    void TestJoinWithCapabilities();
+    void TestEncoderAlignsGroups();
+    void TestEncoderSkipsBrokenGroup();
+    void TestNoLoss();
+    void TestSingleLossPerGroup();
+    void TestParityBeforeLateFrame();
+    void TestResentCopyMatchesOriginal();
+    void TestTwoLossesNeedResend();
+    void TestParityLostNeedsResend();
+    void TestLossInjection();
+private:
+    OhmMsgAudio* CreateFrame(TUint aFrame);
+    void CheckRecovered(TUint aFrame);
+    void Transmit(TUint aNumFrames, const std::vector<TBool>& aFrameLost, const std::vector<TBool>& aParityLost);
+    void AddParity(const Brx& aFecMsg);
+    void SendParity();
+    void RunLossInjection(TUint aLossPercent, TUint aSeed);
+private:
+    OhmMsgFactory* iFactory;
+    OhmFecEncoder* iEncoder;
+    OhmFecDecoder* iDecoder;
+    Bws<OhmMsgAudio::kStreamHeaderBytes> iStreamHeader;
+    Bws<OhmFec::kMaxMsgBytes> iFecMsg;
+    TUint iFramesLost;
+    TUint iFramesRecovered;
+};
+
+} // namespace Av
+} // namespace OpenHome
+
+using namespace OpenHome::Av;
+
+
+// SuiteOhmFec
+
+SuiteOhmFec::SuiteOhmFec()
+    : SuiteUnitTest("SuiteOhmFec")
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestHeaderRoundTrip), "TestHeaderRoundTrip");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestJoinWithCapabilities), "TestJoinWithCapabilities");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestEncoderAlignsGroups), "TestEncoderAlignsGroups");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestEncoderSkipsBrokenGroup), "TestEncoderSkipsBrokenGroup");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestNoLoss), "TestNoLoss");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestSingleLossPerGroup), "TestSingleLossPerGroup");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestParityBeforeLateFrame), "TestParityBeforeLateFrame");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestResentCopyMatchesOriginal), "TestResentCopyMatchesOriginal");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestTwoLossesNeedResend), "TestTwoLossesNeedResend");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestParityLostNeedsResend), "TestParityLostNeedsResend");
+    AddTest(MakeFunctor(*this, &SuiteOhmFec::TestLossInjection), "TestLossInjection");
+}
+
+void SuiteOhmFec::Setup()
+{
+    iFactory = new OhmMsgFactory(10, 1, 1);
+    iEncoder = new OhmFecEncoder();
+    iEncoder->SetGroupFrames(kGroupFrames);
+    iDecoder = new OhmFecDecoder();
+    iStreamHeader.Replace(Brx::Empty());
+    OhmMsgAudio::GetStreamHeader(iStreamHeader, 0, kSampleRate, kSampleRate * kBitDepth * kChannels, 0, kBitDepth, kChannels, Brn("PCM"));
+    iFramesLost = 0;
+    iFramesRecovered = 0;
+}
+
+void SuiteOhmFec::TearDown()
+{
+    delete iDecoder;
+    delete iEncoder;
+    delete iFactory;
+}
+
+OhmMsgAudio* SuiteOhmFec::CreateFrame(TUint aFrame)
+{
+    // vary the size of frames so that parity has to cope with padding
+    const TUint bytesPerSample = kChannels * kBitDepth / 8;
+    const TUint samples = 100 + ((aFrame * 37) % 120);
+    Bws<OhmMsgAudio::kMaxSampleBytes> audio;
+    for (TUint i = 0; i < samples * bytesPerSample; i++) {
+        audio.Append((TByte)(aFrame + i));
+    }
+    OhmMsgAudio* msg = iFactory->CreateAudio(false, true, false, false, samples, aFrame, 0, kLatency,
+                                             (TUint64)aFrame * 1000, iStreamHeader, audio);
+    msg->Serialise();
+    return msg;
+}
+
+void SuiteOhmFec::CheckRecovered(TUint aFrame)
+{
+    OhmMsgAudio* expected = CreateFrame(aFrame);
+    TEST(iDecoder->Recovered() == expected->SendableBuffer());
+    expected->RemoveRef();
+
+    ReaderBuffer reader(iDecoder->Recovered());
+    OhmHeader header;
+    header.Internalise(reader);
+    TEST(header.MsgType() == OhmHeader::kMsgTypeAudio);
+    OhmMsgAudio* msg = iFactory->CreateAudio(reader, header);
+    TEST(msg->Frame() == aFrame);
+    TEST(!msg->Resent());
+    msg->SetResent(true); // as ProtocolOhBase does
+    TEST(msg->Resent());
+    msg->RemoveRef();
+}
+
+void SuiteOhmFec::AddParity(const Brx& aFecMsg)
+{
+    ReaderBuffer reader(aFecMsg);
+    OhmHeader header;
+    header.Internalise(reader);
+    TEST(header.MsgType() == OhmHeader::kMsgTypeFec);
+    OhmHeaderFec headerFec;
+    headerFec.Internalise(reader, header);
+    const Brn parity = aFecMsg.Split(OhmHeader::kHeaderBytes + OhmHeaderFec::kHeaderBytes);
+    TEST(parity.Bytes() == headerFec.ParityBytes());
+    if (iDecoder->AddParity(headerFec, parity)) {
+        const TUint frame = Converter::BeUint32At(iDecoder->Recovered(), OhmHeader::kHeaderBytes + 4);
+        CheckRecovered(frame);
+        iFramesRecovered++;
+    }
+}
+
+void SuiteOhmFec::SendParity()
+{
+    iFecMsg.Replace(Brx::Empty());
+    WriterBuffer writer(iFecMsg);
+    iEncoder->Externalise(writer);
+    AddParity(iFecMsg);
+}
+
+void SuiteOhmFec::Transmit(TUint aNumFrames, const std::vector<TBool>& aFrameLost, const std::vector<TBool>& aParityLost)
+{
+    for (TUint i = 0; i < aNumFrames; i++) {
+        OhmMsgAudio* msg = CreateFrame(i);
+        const TBool groupComplete = iEncoder->Add(i, msg->SendableBuffer());
+        if (aFrameLost[i]) {
+            iFramesLost++;
+        }
+        else if (iDecoder->AddFrame(i, msg->SendableBuffer())) {
+            CheckRecovered(Converter::BeUint32At(iDecoder->Recovered(), OhmHeader::kHeaderBytes + 4));
+            iFramesRecovered++;
+        }
+        msg->RemoveRef();
+        if (groupComplete && !aParityLost[i / kGroupFrames]) {
+            SendParity();
+        }
+    }
+}
+
+void SuiteOhmFec::TestHeaderRoundTrip()
+{
+    OhmHeaderFec headerFec(1234 * kGroupFrames, kGroupFrames, 0x5a5a, 1500);
+    OhmHeader header(OhmHeader::kMsgTypeFec, headerFec.MsgBytes());
+    Bws<OhmHeader::kHeaderBytes + OhmHeaderFec::kHeaderBytes> buf;
+    WriterBuffer writer(buf);
+    header.Externalise(writer);
+    headerFec.Externalise(writer);
+
+    ReaderBuffer reader(buf);
+    OhmHeader header2;
+    header2.Internalise(reader);
+    TEST(header2.MsgType() == OhmHeader::kMsgTypeFec);
+    TEST(header2.MsgBytes() == OhmHeaderFec::kHeaderBytes + 1500);
+    OhmHeaderFec headerFec2;
+    headerFec2.Internalise(reader, header2);
+    TEST(headerFec2.FrameFirst() == 1234 * kGroupFrames);
+    TEST(headerFec2.GroupFrames() == kGroupFrames);
+    TEST(headerFec2.FrameBytesXor() == 0x5a5a);
+    TEST(headerFec2.ParityBytes() == 1500);
+}
+
+void SuiteOhmFec::TestJoinWithCapabilities()
+{
+    Bws<OhmHeader::kHeaderBytes + OhmHeaderCapabilities::kHeaderBytes> buf;
+    WriterBuffer writer(buf);
+    OhmHeaderCapabilities support(OhmFec::kMaxGroupFrames, OhmHeaderCapabilities::kCodecFlac);
+    OhmHeader header(OhmHeader::kMsgTypeJoin, support.MsgBytes());
+    header.Externalise(writer);
+    support.Externalise(writer);
+
+    ReaderBuffer reader(buf);
+    OhmHeader header2;
+    header2.Internalise(reader);
+    TEST(header2.MsgType() == OhmHeader::kMsgTypeJoin);
+    TEST(header2.MsgBytes() == OhmHeaderCapabilities::kHeaderBytes);
+    OhmHeaderCapabilities support2;
+    support2.Internalise(reader, header2);
+    TEST(support2.MaxFecGroupFrames() == OhmFec::kMaxGroupFrames);
+    TEST(support2.Codecs() == OhmHeaderCapabilities::kCodecFlac);
+}
+
+void SuiteOhmFec::TestEncoderAlignsGroups()
+{
+    // first frame is part way through a group so no parity until the next group completes
+    TUint parityCount = 0;
+    for (TUint i = 3; i < 3 + 3 * kGroupFrames; i++) {
+        OhmMsgAudio* msg = CreateFrame(i);
+        if (iEncoder->Add(i, msg->SendableBuffer())) {
+            TEST((i + 1) % kGroupFrames == 0);
+            TEST(i + 1 > 3 + kGroupFrames);
+            parityCount++;
+        }
+        msg->RemoveRef();
+    }
+    TEST(parityCount == 2);
+}
+
+void SuiteOhmFec::TestEncoderSkipsBrokenGroup()
+{
+    // a jump in frame numbers (e.g. StreamInterrupted) abandons the current group
+    TUint parityCount = 0;
+    for (TUint i = 0; i < 2 * kGroupFrames; i++) {
+        if (i == 3) {
+            continue;
+        }
+        OhmMsgAudio* msg = CreateFrame(i);
+        if (iEncoder->Add(i, msg->SendableBuffer())) {
+            TEST(i == 2 * kGroupFrames - 1);
+            parityCount++;
+        }
+        msg->RemoveRef();
+    }
+    TEST(parityCount == 1);
+}
+
+void SuiteOhmFec::TestNoLoss()
+{
+    const TUint numFrames = 10 * kGroupFrames;
+    std::vector<TBool> frameLost(numFrames, false);
+    std::vector<TBool> parityLost(numFrames / kGroupFrames, false);
+    Transmit(numFrames, frameLost, parityLost);
+    TEST(iFramesLost == 0);
+    TEST(iFramesRecovered == 0);
+    TEST(iDecoder->FramesRecovered() == 0);
+}
+
+void SuiteOhmFec::TestSingleLossPerGroup()
+{
+    // the decoder learns the group size from the first Fec msg so the first group is always left intact
+    const TUint numFrames = (kGroupFrames + 1) * kGroupFrames;
+    std::vector<TBool> frameLost(numFrames, false);
+    std::vector<TBool> parityLost(numFrames / kGroupFrames, false);
+    for (TUint i = 0; i < kGroupFrames; i++) {
+        frameLost[(i + 1) * kGroupFrames + i] = true; // test losing each position within a group
+    }
+    Transmit(numFrames, frameLost, parityLost);
+    TEST(iFramesLost == kGroupFrames);
+    TEST(iFramesRecovered == kGroupFrames);
+    TEST(iDecoder->FramesRecovered() == kGroupFrames);
+}
+
+void SuiteOhmFec::TestParityBeforeLateFrame()
+{
+    std::vector<TBool> frameLost(kGroupFrames, false);
+    std::vector<TBool> parityLost(1, false);
+    Transmit(kGroupFrames, frameLost, parityLost);
+
+    // frames 2 and 5 of the next group are initially lost; a resend of 5 arrives after parity, allowing 2 to be rebuilt
+    const TUint first = kGroupFrames;
+    Bws<OhmFec::kMaxFrameBytes> late;
+    for (TUint i = first; i < first + kGroupFrames; i++) {
+        OhmMsgAudio* msg = CreateFrame(i);
+        const TBool groupComplete = iEncoder->Add(i, msg->SendableBuffer());
+        msg->SetResent(true);
+        if (i == first + 5) {
+            late.Replace(msg->SendableBuffer());
+        }
+        else if (i != first + 2) {
+            TEST(!iDecoder->AddFrame(i, msg->SendableBuffer()));
+        }
+        msg->RemoveRef();
+        if (groupComplete) {
+            SendParity();
+        }
+    }
+    TEST(iFramesRecovered == 0);
+    TEST(iDecoder->AddFrame(first + 5, late));
+    CheckRecovered(first + 2);
+    // the recovered frame is fed back through the decoder by ProtocolOhBase - this must be harmless
+    TEST(!iDecoder->AddFrame(first + 2, iDecoder->Recovered()));
+    TEST(iDecoder->FramesRecovered() == 1);
+}
+
+void SuiteOhmFec::TestResentCopyMatchesOriginal()
+{
+    std::vector<TBool> frameLost(kGroupFrames, false);
+    std::vector<TBool> parityLost(1, false);
+    Transmit(kGroupFrames, frameLost, parityLost);
+
+    // every frame of the next group is received as a resend; its first frame is lost
+    const TUint first = kGroupFrames;
+    for (TUint i = first; i < first + kGroupFrames; i++) {
+        OhmMsgAudio* msg = CreateFrame(i);
+        const TBool groupComplete = iEncoder->Add(i, msg->SendableBuffer());
+        msg->SetResent(true);
+        if (i != first) {
+            TEST(!iDecoder->AddFrame(i, msg->SendableBuffer()));
+            TEST(!iDecoder->AddFrame(i, msg->SendableBuffer())); // duplicates are ignored
+        }
+        msg->RemoveRef();
+        if (groupComplete) {
+            SendParity();
+        }
+    }
+    TEST(iFramesRecovered == 1);
+}
+
+void SuiteOhmFec::TestTwoLossesNeedResend()
+{
+    const TUint numFrames = 3 * kGroupFrames;
+    std::vector<TBool> frameLost(numFrames, false);
+    std::vector<TBool> parityLost(numFrames / kGroupFrames, false);
+    frameLost[kGroupFrames + 1] = frameLost[kGroupFrames + 6] = true;
+    frameLost[2 * kGroupFrames + 4] = true;
+    Transmit(numFrames, frameLost, parityLost);
+    TEST(iFramesLost == 3);
+    TEST(iFramesRecovered == 1);
+}
+
+void SuiteOhmFec::TestParityLostNeedsResend()
+{
+    const TUint numFrames = 3 * kGroupFrames;
+    std::vector<TBool> frameLost(numFrames, false);
+    std::vector<TBool> parityLost(numFrames / kGroupFrames, false);
+    frameLost[kGroupFrames + 3] = true;
+    parityLost[1] = true;
+    frameLost[2 * kGroupFrames + 3] = true;
+    Transmit(numFrames, frameLost, parityLost);
+    TEST(iFramesLost == 2);
+    TEST(iFramesRecovered == 1);
+}
+
+void SuiteOhmFec::RunLossInjection(TUint aLossPercent, TUint aSeed)
+{
+    const TUint numGroups = 250;
+    const TUint numFrames = numGroups * kGroupFrames;
+    std::vector<TBool> frameLost(numFrames, false);
+    std::vector<TBool> parityLost(numGroups, false);
+
+    // simple LCG so that results are repeatable
+    TUint rand = aSeed;
+    auto lose = [&rand, aLossPercent]() {
+        rand = rand * 1103515245 + 12345;
+        return ((rand >> 16) % 100) < aLossPercent;
+    };
+    TUint expectedRecovered = 0;
+    for (TUint g = 1; g < numGroups; g++) { // first group left intact so that the decoder learns the group size
+        TUint lostInGroup = 0;
+        for (TUint i = 0; i < kGroupFrames; i++) {
+            if (lose()) {
+                frameLost[g * kGroupFrames + i] = true;
+                lostInGroup++;
+            }
+        }
+        parityLost[g] = lose();
+        if (lostInGroup == 1 && !parityLost[g]) {
+            expectedRecovered++;
+        }
+    }
+
+    TearDown();
+    Setup();
+    Transmit(numFrames, frameLost, parityLost);
+    const TUint needResend = iFramesLost - iFramesRecovered;
+    Print("    %2u%% loss over %u frames: %3u lost, %3u recovered locally, %3u needed resend\n",
+          aLossPercent, numFrames, iFramesLost, iFramesRecovered, needResend);
+    TEST(iFramesRecovered == expectedRecovered);
+    TEST(iDecoder->FramesRecovered() == expectedRecovered);
+}
+
+void SuiteOhmFec::TestLossInjection()
+{
+    RunLossInjection(1, 1);
+    RunLossInjection(2, 2);
+    RunLossInjection(5, 3);
+    RunLossInjection(10, 4);
+    RunLossInjection(20, 5);
+}
+
+
+
+void TestOhmFec()
+{
+    Runner runner("Songcast forward error correction tests\n");
+    runner.Add(new SuiteOhmFec());
+    runner.Run();
+}
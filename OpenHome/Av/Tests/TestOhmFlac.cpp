@@ -0,0 +1,645 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/SuiteUnitTest.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Av/Songcast/OhmMsg.h>
+#include <OpenHome/Av/Songcast/OhmFlac.h>
+#include <OpenHome/Media/Codec/CodecController.h>
+#include <OpenHome/Media/Codec/CodecFactory.h>
+#include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Media/MimeTypeList.h>
+#include <OpenHome/Media/Utils/AllocatorInfoLogger.h>
+#include <OpenHome/Media/Utils/ProcessorAudioUtils.h>
+
+#include <FLAC/format.h>
+#include <FLAC/stream_decoder.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+using namespace OpenHome::Media;
+
+namespace OpenHome {
+namespace Av {
+
+class TestFlacDecoder
+{
+public:
+    TestFlacDecoder();
+    ~TestFlacDecoder();
+    void Decode(const std::vector<TByte>& aStream);
+    TUint SampleRate() const { return iSampleRate; }
+    TUint BitDepth() const { return iBitDepth; }
+    TUint Channels() const { return iChannels; }
+    TUint Errors() const { return iErrors; }
+    const std::vector<TInt>& Subsamples() const { return iSubsamples; }
+private:
+    static FLAC__StreamDecoderReadStatus ReadCallback(const FLAC__StreamDecoder* aDecoder, FLAC__byte aBuffer[], size_t* aBytes, void* aClientData);
+    static FLAC__StreamDecoderWriteStatus WriteCallback(const FLAC__StreamDecoder* aDecoder, const FLAC__Frame* aFrame, const FLAC__int32* const aBuffer[], void* aClientData);
+    static void MetadataCallback(const FLAC__StreamDecoder* aDecoder, const FLAC__StreamMetadata* aMetadata, void* aClientData);
+    static void ErrorCallback(const FLAC__StreamDecoder* aDecoder, FLAC__StreamDecoderErrorStatus aStatus, void* aClientData);
+private:
+    FLAC__StreamDecoder* iDecoder;
+    const std::vector<TByte>* iStream;
+    TUint iOffset;
+    TUint iSampleRate;
+    TUint iBitDepth;
+    TUint iChannels;
+    TUint iErrors;
+    std::vector<TInt> iSubsamples;
+};
+
+// Feeds encoded msgs, as ProtocolOhBase outputs them, through a CodecController running CodecFlac
+class TestFlacPipeline : private IPipelineElementUpstream
+                       , private IPipelineElementDownstream
+                       , private IStreamHandler
+                       , private IUrlBlockWriter
+                       , private IMimeTypeList
+                       , private INonCopyable
+{
+public:
+    TestFlacPipeline(PcmStorage aStorage);
+    ~TestFlacPipeline();
+    void QueueData(const Brx& aData);
+    TBool WaitForPcm(TUint aBytes, TUint aTimeoutMs); // false if fewer than aBytes of audio were decoded in time
+    std::vector<TByte> Pcm();
+private:
+    void Queue(Msg* aMsg);
+private: // from IPipelineElementUpstream
+    Msg* Pull() override;
+private: // from IPipelineElementDownstream
+    void Push(Msg* aMsg) override;
+private: // from IStreamHandler
+    EStreamPlay OkToPlay(TUint aStreamId) override;
+    TUint TrySeek(TUint aStreamId, TUint64 aOffset) override;
+    TUint TryDiscard(TUint aJiffies) override;
+    TUint TryStop(TUint aStreamId) override;
+    void NotifyStarving(const Brx& aMode, TUint aStreamId, TBool aStarving) override;
+private: // from IUrlBlockWriter
+    TBool TryGet(IWriter& aWriter, const Brx& aUrl, TUint64 aOffset, TUint aBytes) override;
+private: // from IMimeTypeList
+    void Add(const TChar* aMimeType) override;
+private:
+    AllocatorInfoLogger iInfoAggregator;
+    TrackFactory* iTrackFactory;
+    MsgFactory* iMsgFactory;
+    Codec::CodecController* iController;
+    Mutex iLock;
+    Semaphore iSemPending;
+    Semaphore iSemDecoded;
+    Semaphore iSemQuit;
+    std::list<Msg*> iPending;
+    std::vector<TByte> iPcm;
+};
+
+class SuiteOhmFlac : public SuiteUnitTest
+{
+    static const TUint kChannels = 2;
+    static const TUint kFrameMs = 5; // matches Sender
+public:
+    SuiteOhmFlac();
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestStreamHeader();
+    void TestRoundTrip44k16();
+    void TestRoundTrip96k24();
+    void TestRoundTrip192k24();
+    void TestIncompressibleFits();
+    void TestUnsupportedFormat();
+    void TestCodecControllerPerFrame();
+    void TestCodecControllerMatchesLibFlac();
+    void TestBandwidthAndCpu();
+private:
+    void RoundTrip(TUint aSampleRate, TUint aBitDepth, TUint aFrames);
+    void CompareWithLibFlac(TUint aSampleRate, TUint aBitDepth, PcmStorage aStorage);
+    void Measure(TUint aSampleRate, TUint aBitDepth);
+    void Generate(TUint aSampleRate, TUint aBitDepth, TUint aSamples, std::vector<TInt>& aSubsamples);
+    void Pack(TUint aBitDepth, const TInt* aSubsamples, TUint aCount, Bwx& aPcm);
+    void StartStream(TUint aSampleRate, TUint aBitDepth);
+private:
+    OhmFlacEncoder* iEncoder;
+    TestFlacDecoder* iDecoder;
+    std::vector<TByte> iStream;
+    Bws<OhmMsgAudio::kMaxSampleBytes> iPcm;
+    Bws<OhmMsgAudio::kMaxAudioBytes> iFlac;
+    TUint iRandom;
+    TUint64 iPhase;
+};
+
+} // namespace Av
+} // namespace OpenHome
+
+using namespace OpenHome::Av;
+
+
+// TestFlacDecoder
+
+TestFlacDecoder::TestFlacDecoder()
+    : iStream(nullptr)
+    , iOffset(0)
+    , iSampleRate(0)
+    , iBitDepth(0)
+    , iChannels(0)
+    , iErrors(0)
+{
+    iDecoder = FLAC__stream_decoder_new();
+}
+
+TestFlacDecoder::~TestFlacDecoder()
+{
+    FLAC__stream_decoder_delete(iDecoder);
+}
+
+void TestFlacDecoder::Decode(const std::vector<TByte>& aStream)
+{
+    iStream = &aStream;
+    iOffset = 0;
+    iSampleRate = iBitDepth = iChannels = iErrors = 0;
+    iSubsamples.clear();
+    ASSERT(FLAC__stream_decoder_init_stream(iDecoder, ReadCallback, nullptr, nullptr, nullptr, nullptr,
+                                            WriteCallback, MetadataCallback, ErrorCallback, this) == FLAC__STREAM_DECODER_INIT_STATUS_OK);
+    (void)FLAC__stream_decoder_process_until_end_of_stream(iDecoder);
+    (void)FLAC__stream_decoder_finish(iDecoder);
+    iStream = nullptr;
+}
+
+FLAC__StreamDecoderReadStatus TestFlacDecoder::ReadCallback(const FLAC__StreamDecoder* /*aDecoder*/, FLAC__byte aBuffer[], size_t* aBytes, void* aClientData)
+{
+    TestFlacDecoder* self = reinterpret_cast<TestFlacDecoder*>(aClientData);
+    const TUint remaining = (TUint)self->iStream->size() - self->iOffset;
+    if (remaining == 0) {
+        *aBytes = 0;
+        return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+    }
+    if (*aBytes > remaining) {
+        *aBytes = remaining;
+    }
+    (void)memcpy(aBuffer, &(*self->iStream)[self->iOffset], *aBytes);
+    self->iOffset += (TUint)*aBytes;
+    return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+FLAC__StreamDecoderWriteStatus TestFlacDecoder::WriteCallback(const FLAC__StreamDecoder* /*aDecoder*/, const FLAC__Frame* aFrame, const FLAC__int32* const aBuffer[], void* aClientData)
+{
+    TestFlacDecoder* self = reinterpret_cast<TestFlacDecoder*>(aClientData);
+    for (TUint i = 0; i < aFrame->header.blocksize; i++) {
+        for (TUint j = 0; j < aFrame->header.channels; j++) {
+            self->iSubsamples.push_back(aBuffer[j][i]);
+        }
+    }
+    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+void TestFlacDecoder::MetadataCallback(const FLAC__StreamDecoder* /*aDecoder*/, const FLAC__StreamMetadata* aMetadata, void* aClientData)
+{
+    TestFlacDecoder* self = reinterpret_cast<TestFlacDecoder*>(aClientData);
+    if (aMetadata->type == FLAC__METADATA_TYPE_STREAMINFO) {
+        self->iSampleRate = aMetadata->data.stream_info.sample_rate;
+        self->iBitDepth = aMetadata->data.stream_info.bits_per_sample;
+        self->iChannels = aMetadata->data.stream_info.channels;
+    }
+}
+
+void TestFlacDecoder::ErrorCallback(const FLAC__StreamDecoder* /*aDecoder*/, FLAC__StreamDecoderErrorStatus /*aStatus*/, void* aClientData)
+{
+    reinterpret_cast<TestFlacDecoder*>(aClientData)->iErrors++;
+}
+
+
+// TestFlacPipeline
+
+TestFlacPipeline::TestFlacPipeline(PcmStorage aStorage)
+    : iLock("TFPL")
+    , iSemPending("TFPP", 0)
+    , iSemDecoded("TFPD", 0)
+    , iSemQuit("TFPQ", 0)
+{
+    iTrackFactory = new TrackFactory(iInfoAggregator, 2);
+    MsgFactoryInitParams init;
+    init.SetMsgAudioEncodedCount(100, 100);
+    init.SetMsgAudioPcmCount(100, 100);
+    init.SetMsgPlayableCount(10, 0, 0);
+    init.SetMsgTrackCount(2);
+    init.SetMsgEncodedStreamCount(2);
+    init.SetMsgDecodedStreamCount(2);
+    init.SetMsgHaltCount(2);
+    init.SetMsgQuitCount(1);
+    init.SetDecodedPcmStorage(aStorage);
+    iMsgFactory = new MsgFactory(iInfoAggregator, init);
+    iController = new Codec::CodecController(*iMsgFactory, *this, *this, *this, Jiffies::kPerMs * 5, kPriorityNormal, false);
+    iController->AddCodec(Codec::CodecFactory::NewFlac(*this));
+    iController->Start();
+
+    Track* track = iTrackFactory->CreateTrack(Brn("ohm://test"), Brx::Empty());
+    Queue(iMsgFactory->CreateMsgTrack(*track));
+    track->RemoveRef();
+    Queue(iMsgFactory->CreateMsgEncodedStream(Brn("ohm://test"), Brx::Empty(), 0, 0, 1, false, false, Multiroom::Forbidden, this));
+}
+
+TestFlacPipeline::~TestFlacPipeline()
+{
+    Queue(iMsgFactory->CreateMsgQuit());
+    iSemQuit.Wait();
+    delete iController;
+    for (auto msg : iPending) {
+        msg->RemoveRef();
+    }
+    delete iMsgFactory;
+    delete iTrackFactory;
+}
+
+void TestFlacPipeline::QueueData(const Brx& aData)
+{
+    Queue(iMsgFactory->CreateMsgAudioEncoded(aData));
+}
+
+TBool TestFlacPipeline::WaitForPcm(TUint aBytes, TUint aTimeoutMs)
+{
+    for (;;) {
+        {
+            AutoMutex _(iLock);
+            if (iPcm.size() >= aBytes) {
+                return true;
+            }
+        }
+        try {
+            iSemDecoded.Wait(aTimeoutMs);
+        }
+        catch (Timeout&) {
+            return false;
+        }
+    }
+}
+
+std::vector<TByte> TestFlacPipeline::Pcm()
+{
+    AutoMutex _(iLock);
+    return iPcm;
+}
+
+void TestFlacPipeline::Queue(Msg* aMsg)
+{
+    {
+        AutoMutex _(iLock);
+        iPending.push_back(aMsg);
+    }
+    iSemPending.Signal();
+}
+
+Msg* TestFlacPipeline::Pull()
+{
+    iSemPending.Wait();
+    AutoMutex _(iLock);
+    ASSERT(iPending.size() > 0);
+    Msg* msg = iPending.front();
+    iPending.pop_front();
+    return msg;
+}
+
+void TestFlacPipeline::Push(Msg* aMsg)
+{
+    // called from CodecController's thread
+    if (auto audio = dynamic_cast<MsgAudioPcm*>(aMsg)) {
+        MsgPlayable* playable = audio->CreatePlayable();
+        ProcessorPcmBufTest pcmProcessor;
+        playable->Read(pcmProcessor);
+        playable->RemoveRef();
+        const Brn pcm(pcmProcessor.Buf());
+        {
+            AutoMutex _(iLock);
+            iPcm.insert(iPcm.end(), pcm.Ptr(), pcm.Ptr() + pcm.Bytes());
+        }
+        iSemDecoded.Signal();
+        return;
+    }
+    const TBool quit = (dynamic_cast<MsgQuit*>(aMsg) != nullptr);
+    aMsg->RemoveRef();
+    if (quit) {
+        iSemQuit.Signal();
+    }
+}
+
+EStreamPlay TestFlacPipeline::OkToPlay(TUint /*aStreamId*/)
+{
+    return ePlayYes;
+}
+
+TUint TestFlacPipeline::TrySeek(TUint /*aStreamId*/, TUint64 /*aOffset*/)
+{
+    return MsgFlush::kIdInvalid;
+}
+
+TUint TestFlacPipeline::TryDiscard(TUint /*aJiffies*/)
+{
+    return MsgFlush::kIdInvalid;
+}
+
+TUint TestFlacPipeline::TryStop(TUint /*aStreamId*/)
+{
+    return MsgFlush::kIdInvalid;
+}
+
+void TestFlacPipeline::NotifyStarving(const Brx& /*aMode*/, TUint /*aStreamId*/, TBool /*aStarving*/)
+{
+}
+
+TBool TestFlacPipeline::TryGet(IWriter& /*aWriter*/, const Brx& /*aUrl*/, TUint64 /*aOffset*/, TUint /*aBytes*/)
+{
+    return false;
+}
+
+void TestFlacPipeline::Add(const TChar* /*aMimeType*/)
+{
+}
+
+
+// SuiteOhmFlac
+
+SuiteOhmFlac::SuiteOhmFlac()
+    : SuiteUnitTest("SuiteOhmFlac")
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmFlac::TestStreamHeader), "TestStreamHeader");
+    AddTest(MakeFunctor(*this, &SuiteOhmFlac::TestRoundTrip44k16), "TestRoundTrip44k16");
+    AddTest(MakeFunctor(*this, &SuiteOhmFlac::TestRoundTrip96k24), "TestRoundTrip96k24");
+    AddTest(MakeFunctor(*this, &SuiteOhmFlac::TestRoundTrip192k24), "TestRoundTrip192k24");
+    AddTest(MakeFunctor(*this, &SuiteOhmFlac::TestIncompressibleFits), "TestIncompressibleFits");
+    AddTest(MakeFunctor(*this, &SuiteOhmFlac::TestUnsupportedFormat), "TestUnsupportedFormat");
+    AddTest(MakeFunctor(*this, &SuiteOhmFlac::TestCodecControllerPerFrame), "TestCodecControllerPerFrame");
+    AddTest(MakeFunctor(*this, &SuiteOhmFlac::TestCodecControllerMatchesLibFlac), "TestCodecControllerMatchesLibFlac");
+    AddTest(MakeFunctor(*this, &SuiteOhmFlac::TestBandwidthAndCpu), "TestBandwidthAndCpu");
+}
+
+void SuiteOhmFlac::Setup()
+{
+    iEncoder = new OhmFlacEncoder();
+    iDecoder = new TestFlacDecoder();
+    iStream.clear();
+    iRandom = 1;
+    iPhase = 0;
+}
+
+void SuiteOhmFlac::TearDown()
+{
+    delete iDecoder;
+    delete iEncoder;
+}
+
+void SuiteOhmFlac::Generate(TUint aSampleRate, TUint aBitDepth, TUint aSamples, std::vector<TInt>& aSubsamples)
+{
+    // a couple of tones plus a little noise - roughly as compressible as typical music
+    static const double kTwoPi = 6.283185307179586;
+    const double fullScale = (double)((1 << (aBitDepth - 1)) - 1);
+    aSubsamples.clear();
+    for (TUint i = 0; i < aSamples; i++, iPhase++) {
+        const double t = (double)iPhase / aSampleRate;
+        const double tone = 0.5 * sin(kTwoPi * 440 * t) + 0.2 * sin(kTwoPi * 1630 * t);
+        iRandom = iRandom * 1103515245 + 12345;
+        const double noise = (((TInt)((iRandom >> 16) & 0xffff)) - 32768) / 32768.0 * 0.002;
+        aSubsamples.push_back((TInt)((tone + noise) * fullScale));
+        aSubsamples.push_back((TInt)((0.8 * tone - noise) * fullScale));
+    }
+}
+
+void SuiteOhmFlac::Pack(TUint aBitDepth, const TInt* aSubsamples, TUint aCount, Bwx& aPcm)
+{
+    aPcm.SetBytes(0);
+    for (TUint i = 0; i < aCount; i++) {
+        const TUint subsample = (TUint)aSubsamples[i];
+        if (aBitDepth == 24) {
+            aPcm.Append((TByte)(subsample >> 16));
+        }
+        aPcm.Append((TByte)(subsample >> 8));
+        aPcm.Append((TByte)subsample);
+    }
+}
+
+void SuiteOhmFlac::StartStream(TUint aSampleRate, TUint aBitDepth)
+{
+    Bws<OhmFlac::kStreamHeaderBytes> header;
+    OhmFlac::WriteStreamHeader(header, aSampleRate, aBitDepth, kChannels, 0);
+    TEST(header.Bytes() == OhmFlac::kStreamHeaderBytes);
+    iStream.assign(header.Ptr(), header.Ptr() + header.Bytes());
+    iEncoder->SetFormat(aSampleRate, aBitDepth, kChannels);
+}
+
+void SuiteOhmFlac::RoundTrip(TUint aSampleRate, TUint aBitDepth, TUint aFrames)
+{
+    StartStream(aSampleRate, aBitDepth);
+    std::vector<TInt> expected;
+    std::vector<TInt> frame;
+    for (TUint i = 0; i < aFrames; i++) {
+        // vary frame size a little, as happens around halts and track changes
+        const TUint samples = aSampleRate * kFrameMs / 1000 - (i % 7 == 6? 17 : 0);
+        Generate(aSampleRate, aBitDepth, samples, frame);
+        Pack(aBitDepth, &frame[0], (TUint)frame.size(), iPcm);
+        TEST(iEncoder->Encode(iPcm, iFlac));
+        TEST(iFlac.Bytes() < iPcm.Bytes());
+        iStream.insert(iStream.end(), iFlac.Ptr(), iFlac.Ptr() + iFlac.Bytes());
+        expected.insert(expected.end(), frame.begin(), frame.end());
+    }
+    iDecoder->Decode(iStream);
+    TEST(iDecoder->Errors() == 0);
+    TEST(iDecoder->SampleRate() == aSampleRate);
+    TEST(iDecoder->BitDepth() == aBitDepth);
+    TEST(iDecoder->Channels() == kChannels);
+    TEST(iDecoder->Subsamples() == expected);
+}
+
+void SuiteOhmFlac::TestStreamHeader()
+{
+    StartStream(192000, 24);
+    TEST(Brn(&iStream[0], 4) == Brn("fLaC"));
+    iDecoder->Decode(iStream);
+    TEST(iDecoder->Errors() == 0);
+    TEST(iDecoder->SampleRate() == 192000);
+    TEST(iDecoder->BitDepth() == 24);
+    TEST(iDecoder->Channels() == kChannels);
+    TEST(iDecoder->Subsamples().size() == 0);
+}
+
+void SuiteOhmFlac::TestRoundTrip44k16()
+{
+    RoundTrip(44100, 16, 200);
+}
+
+void SuiteOhmFlac::TestRoundTrip96k24()
+{
+    RoundTrip(96000, 24, 200);
+}
+
+void SuiteOhmFlac::TestRoundTrip192k24()
+{
+    RoundTrip(192000, 24, 200);
+}
+
+void SuiteOhmFlac::TestIncompressibleFits()
+{
+    // full scale white noise at the largest frame size Songcast sends
+    static const TUint kSampleRate = 192000;
+    static const TUint kSamples = kSampleRate * kFrameMs / 1000;
+    StartStream(kSampleRate, 24);
+    std::vector<TInt> frame;
+    for (TUint i = 0; i < kSamples * kChannels; i++) {
+        iRandom = iRandom * 1103515245 + 12345;
+        frame.push_back((TInt)(iRandom ^ (iRandom >> 7)) >> 8);
+    }
+    Pack(24, &frame[0], (TUint)frame.size(), iPcm);
+    TEST(iPcm.Bytes() == OhmMsgAudio::kMaxSampleBytes);
+    TEST(iEncoder->Encode(iPcm, iFlac));
+    TEST(iFlac.Bytes() > iPcm.Bytes());
+    TEST(iFlac.Bytes() <= OhmMsgAudio::kMaxAudioBytes);
+    iStream.insert(iStream.end(), iFlac.Ptr(), iFlac.Ptr() + iFlac.Bytes());
+    iDecoder->Decode(iStream);
+    TEST(iDecoder->Subsamples() == frame);
+}
+
+void SuiteOhmFlac::TestUnsupportedFormat()
+{
+    TEST(!OhmFlac::IsSupported(8, 2));
+    TEST(!OhmFlac::IsSupported(32, 2));
+    TEST(!OhmFlac::IsSupported(16, 0));
+    TEST(OhmFlac::IsSupported(16, 1));
+    TEST(OhmFlac::IsSupported(24, 2));
+
+    iPcm.SetBytes(0);
+    for (TUint i = 0; i < 441; i++) {
+        iPcm.Append((TByte)i);
+    }
+    iEncoder->SetFormat(44100, 8, 2);
+    TEST(!iEncoder->Encode(iPcm, iFlac));
+    iEncoder->SetFormat(44100, 16, 2);
+    TEST(!iEncoder->Encode(Brx::Empty(), iFlac));
+}
+
+void SuiteOhmFlac::TestCodecControllerPerFrame()
+{
+    // Each Songcast frame arrives in its own msg, kFrameMs apart.  Check that CodecController
+    // hands CodecFlac whatever has arrived rather than blocking until libFLAC's (much larger)
+    // read request is satisfied - audio held back there isn't accounted for in latency.
+    // The first frame also completes the 256 byte peek CodecController uses to rank codecs.
+    static const TUint kSampleRate = 44100;
+    static const TUint kBitDepth = 16;
+    static const TUint kFrames = 20;
+    static const TUint kTimeoutMs = 1000;
+    const TUint samples = kSampleRate * kFrameMs / 1000;
+    StartStream(kSampleRate, kBitDepth);
+    TestFlacPipeline pipeline(PcmStorage::PackedBigEndian);
+    pipeline.QueueData(Brn(&iStream[0], (TUint)iStream.size()));
+    std::vector<TByte> expected;
+    std::vector<TInt> frame;
+    for (TUint i = 0; i < kFrames; i++) {
+        Generate(kSampleRate, kBitDepth, samples, frame);
+        Pack(kBitDepth, &frame[0], (TUint)frame.size(), iPcm);
+        TEST(iEncoder->Encode(iPcm, iFlac));
+        pipeline.QueueData(iFlac);
+        expected.insert(expected.end(), iPcm.Ptr(), iPcm.Ptr() + iPcm.Bytes());
+        TEST(pipeline.WaitForPcm((TUint)expected.size(), kTimeoutMs));
+        TEST(pipeline.Pcm() == expected);
+    }
+}
+
+void SuiteOhmFlac::CompareWithLibFlac(TUint aSampleRate, TUint aBitDepth, PcmStorage aStorage)
+{
+    static const TUint kFrames = 20;
+    static const TUint kMsgBytes = 2048; // unrelated to frame size, as for a file
+    static const TUint kTimeoutMs = 5000;
+    const TUint samples = aSampleRate * kFrameMs / 1000;
+    StartStream(aSampleRate, aBitDepth);
+    std::vector<TInt> frame;
+    for (TUint i = 0; i < kFrames; i++) {
+        Generate(aSampleRate, aBitDepth, samples, frame);
+        Pack(aBitDepth, &frame[0], (TUint)frame.size(), iPcm);
+        TEST(iEncoder->Encode(iPcm, iFlac));
+        iStream.insert(iStream.end(), iFlac.Ptr(), iFlac.Ptr() + iFlac.Bytes());
+    }
+
+    // CodecFlac used to pack libFLAC's output into big endian interleaved audio and pass that to
+    // OutputAudioPcm().  Decode with libFLAC directly and pack it the same way for reference.
+    iDecoder->Decode(iStream);
+    TEST(iDecoder->Errors() == 0);
+    std::vector<TByte> expected;
+    for (auto subsample : iDecoder->Subsamples()) {
+        if (aBitDepth == 24) {
+            expected.push_back((TByte)(subsample >> 16));
+        }
+        expected.push_back((TByte)(subsample >> 8));
+        expected.push_back((TByte)subsample);
+    }
+    TEST(expected.size() == (size_t)kFrames * samples * kChannels * (aBitDepth / 8));
+
+    TestFlacPipeline pipeline(aStorage);
+    for (TUint offset = 0; offset < iStream.size(); offset += kMsgBytes) {
+        const TUint bytes = std::min(kMsgBytes, (TUint)iStream.size() - offset);
+        pipeline.QueueData(Brn(&iStream[offset], bytes));
+    }
+    TEST(pipeline.WaitForPcm((TUint)expected.size(), kTimeoutMs));
+    TEST(pipeline.Pcm() == expected);
+}
+
+void SuiteOhmFlac::TestCodecControllerMatchesLibFlac()
+{
+    // CodecFlac outputs libFLAC's planar buffers via OutputAudioPcmPlanar()
+    CompareWithLibFlac(44100, 16, PcmStorage::PackedBigEndian);
+    CompareWithLibFlac(96000, 24, PcmStorage::PackedBigEndian);
+    CompareWithLibFlac(44100, 16, PcmStorage::Int32);
+    CompareWithLibFlac(96000, 24, PcmStorage::Int32);
+}
+
+void SuiteOhmFlac::Measure(TUint aSampleRate, TUint aBitDepth)
+{
+    static const TUint kSeconds = 10;
+    const TUint samples = aSampleRate * kFrameMs / 1000;
+    const TUint frames = kSeconds * 1000 / kFrameMs;
+    StartStream(aSampleRate, aBitDepth);
+    std::vector<TInt> frame;
+    TUint64 pcmBytes = 0;
+    TUint64 flacBytes = 0;
+    TUint maxFlacBytes = 0;
+    TUint64 encodeUs = 0;
+    for (TUint i = 0; i < frames; i++) {
+        Generate(aSampleRate, aBitDepth, samples, frame);
+        Pack(aBitDepth, &frame[0], (TUint)frame.size(), iPcm);
+        const TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+        TEST(iEncoder->Encode(iPcm, iFlac));
+        encodeUs += Os::TimeInUs(gEnv->OsCtx()) - start;
+        pcmBytes += iPcm.Bytes();
+        flacBytes += iFlac.Bytes();
+        if (iFlac.Bytes() > maxFlacBytes) {
+            maxFlacBytes = iFlac.Bytes();
+        }
+    }
+    const TUint pcmKbps = (TUint)(pcmBytes * 8 / (kSeconds * 1000));
+    const TUint flacKbps = (TUint)(flacBytes * 8 / (kSeconds * 1000));
+    const TUint percent = (TUint)(flacBytes * 100 / pcmBytes);
+    const TUint usPerFrame = (TUint)(encodeUs / frames);
+    // cpu load, in hundredths of a percent of one core, of encoding in real time
+    const TUint load = (TUint)(encodeUs * 10000 / (kSeconds * 1000000));
+    Print("    %6u/%u: PCM %5u kbit/s, FLAC %5u kbit/s (%2u%%, largest frame %4u of %4u bytes), encode %3uus/frame (%u.%02u%% cpu)\n",
+          aSampleRate, aBitDepth, pcmKbps, flacKbps, percent, maxFlacBytes, samples * kChannels * aBitDepth / 8,
+          usPerFrame, load / 100, load % 100);
+    TEST(flacBytes < pcmBytes);
+}
+
+void SuiteOhmFlac::TestBandwidthAndCpu()
+{
+    Measure(44100, 16);
+    Measure(96000, 24);
+    Measure(192000, 24);
+}
+
+
+
+void TestOhmFlac()
+{
+    Runner runner("Songcast lossless compression tests\n");
+    runner.Add(new SuiteOhmFlac());
+    runner.Run();
+}
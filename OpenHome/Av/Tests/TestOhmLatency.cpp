@@ -0,0 +1,501 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/SuiteUnitTest.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Av/Songcast/Ohm.h>
+#include <OpenHome/Av/Songcast/OhmLatency.h>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+namespace OpenHome {
+namespace Av {
+
+class SuiteOhmLatency : public SuiteUnitTest
+{
+public:
+    SuiteOhmLatency();
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestHeaderRoundTrip();
+    void TestHeaderLimits();
+    void TestNoAudio();
+    void TestNetworkDelay();
+    void TestLoss();
+    void TestExtremeJitter();
+};
+
+class SuiteOhmReceptionMonitor : public SuiteUnitTest
+{
+    static const TUint kSampleRate = 48000;
+    static const TUint kFrameSamples = 240;
+    static const TUint kFrameUs = 5000;
+    static const TUint64 kStartUs = 1000000;
+public:
+    SuiteOhmReceptionMonitor();
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestSteadyArrivals();
+    void TestJitteredArrivals();
+    void TestLoss();
+    void TestLateFrameNotLost();
+    void TestNewStream();
+    void TestGapAfterHalt();
+    void TestGapWithoutHalt();
+    void TestReportResetsCounts();
+private:
+    void Add(TUint aFrame, TInt aArrivalOffsetUs = 0, TBool aHalt = false);
+private:
+    OhmReceptionMonitor* iMonitor;
+};
+
+class SuiteOhmLatencyController : public SuiteUnitTest
+{
+    static const TUint kMinMs = 100;
+    static const TUint kMaxMs = 1000;
+    static const TUint kDefaultMs = 300;
+public:
+    SuiteOhmLatencyController();
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestStartsAtDefault();
+    void TestIncreaseImmediate();
+    void TestRoundsUp();
+    void TestHighestReceiverWins();
+    void TestClampedToMax();
+    void TestSmallDecreaseIgnored();
+    void TestDecreaseAfterHold();
+    void TestLegacyReceiverUsesDefault();
+    void TestExpiredReportIgnored();
+    void TestNoReportsHoldsLatency();
+    void TestDisabled();
+private:
+    static OhmHeaderReception Reception(TUint aRequiredMs);
+private:
+    OhmLatencyController* iController;
+    Endpoint iReceiver1;
+    Endpoint iReceiver2;
+};
+
+} // namespace Av
+} // namespace OpenHome
+
+using namespace OpenHome::Av;
+
+
+// SuiteOhmLatency
+
+SuiteOhmLatency::SuiteOhmLatency()
+    : SuiteUnitTest("SuiteOhmLatency")
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmLatency::TestHeaderRoundTrip), "TestHeaderRoundTrip");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatency::TestHeaderLimits), "TestHeaderLimits");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatency::TestNoAudio), "TestNoAudio");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatency::TestNetworkDelay), "TestNetworkDelay");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatency::TestLoss), "TestLoss");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatency::TestExtremeJitter), "TestExtremeJitter");
+}
+
+void SuiteOhmLatency::Setup()
+{
+}
+
+void SuiteOhmLatency::TearDown()
+{
+}
+
+void SuiteOhmLatency::TestHeaderRoundTrip()
+{
+    OhmHeaderCapabilities capabilities(8, OhmHeaderCapabilities::kCodecFlac);
+    OhmHeaderReception reception(1234, 56789, 200, 3);
+    OhmHeader header(OhmHeader::kMsgTypeListen, capabilities.MsgBytes() + reception.MsgBytes());
+    Bws<OhmHeader::kHeaderBytes + OhmHeaderCapabilities::kHeaderBytes + OhmHeaderReception::kHeaderBytes> buf;
+    WriterBuffer writer(buf);
+    header.Externalise(writer);
+    capabilities.Externalise(writer);
+    reception.Externalise(writer);
+    TEST(buf.Bytes() == buf.MaxBytes());
+
+    ReaderBuffer reader(buf);
+    OhmHeader header2;
+    header2.Internalise(reader);
+    TEST(header2.MsgType() == OhmHeader::kMsgTypeListen);
+    TEST(header2.MsgBytes() == OhmHeaderCapabilities::kHeaderBytes + OhmHeaderReception::kHeaderBytes);
+    OhmHeaderCapabilities capabilities2;
+    capabilities2.Internalise(reader, header2);
+    TEST(capabilities2.MaxFecGroupFrames() == 8);
+    OhmHeaderReception reception2;
+    reception2.Internalise(reader, header2);
+    TEST(reception2.JitterUs() == 1234);
+    TEST(reception2.SpreadUs() == 56789);
+    TEST(reception2.FramesExpected() == 200);
+    TEST(reception2.FramesLost() == 3);
+}
+
+void SuiteOhmLatency::TestHeaderLimits()
+{
+    OhmHeaderReception reception(0, 0, 100000, 200000);
+    TEST(reception.FramesExpected() == 0xffff);
+    TEST(reception.FramesLost() == 0xffff);
+    OhmHeaderReception reception2(0, 0, 10, 20);
+    TEST(reception2.FramesExpected() == 10);
+    TEST(reception2.FramesLost() == 10);
+}
+
+void SuiteOhmLatency::TestNoAudio()
+{
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception()) == 0);
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(5000, 5000, 0, 0)) == 0);
+}
+
+void SuiteOhmLatency::TestNetworkDelay()
+{
+    // perfect reception still leaves some headroom
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(0, 0, 200, 0)) == OhmLatency::kHeadroomMs);
+    // jitter estimate dominates spread
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(1000, 3000, 200, 0)) == OhmLatency::kHeadroomMs + 4);
+    // spread dominates jitter estimate
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(1000, 9500, 200, 0)) == OhmLatency::kHeadroomMs + 10);
+}
+
+void SuiteOhmLatency::TestLoss()
+{
+    static const TUint kNetworkMs = 4;
+    static const TUint kBaseMs = OhmLatency::kHeadroomMs + kNetworkMs;
+    static const TUint kRepairMs = OhmLatency::kRepairMs + kNetworkMs;
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(1000, 0, 1000, 1)) == kBaseMs + kRepairMs);
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(1000, 0, 1000, 9)) == kBaseMs + kRepairMs);
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(1000, 0, 1000, 10)) == kBaseMs + 2 * kRepairMs);
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(1000, 0, 1000, 50)) == kBaseMs + 3 * kRepairMs);
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(1000, 0, 1000, 1000)) == kBaseMs + 3 * kRepairMs);
+}
+
+void SuiteOhmLatency::TestExtremeJitter()
+{
+    static const TUint kMaxNetworkMs = 10 * 1000;
+    TEST(OhmLatency::RequiredMs(OhmHeaderReception(0xffffffff, 0xffffffff, 200, 0)) == OhmLatency::kHeadroomMs + kMaxNetworkMs);
+}
+
+
+// SuiteOhmReceptionMonitor
+
+SuiteOhmReceptionMonitor::SuiteOhmReceptionMonitor()
+    : SuiteUnitTest("SuiteOhmReceptionMonitor")
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmReceptionMonitor::TestSteadyArrivals), "TestSteadyArrivals");
+    AddTest(MakeFunctor(*this, &SuiteOhmReceptionMonitor::TestJitteredArrivals), "TestJitteredArrivals");
+    AddTest(MakeFunctor(*this, &SuiteOhmReceptionMonitor::TestLoss), "TestLoss");
+    AddTest(MakeFunctor(*this, &SuiteOhmReceptionMonitor::TestLateFrameNotLost), "TestLateFrameNotLost");
+    AddTest(MakeFunctor(*this, &SuiteOhmReceptionMonitor::TestNewStream), "TestNewStream");
+    AddTest(MakeFunctor(*this, &SuiteOhmReceptionMonitor::TestGapAfterHalt), "TestGapAfterHalt");
+    AddTest(MakeFunctor(*this, &SuiteOhmReceptionMonitor::TestGapWithoutHalt), "TestGapWithoutHalt");
+    AddTest(MakeFunctor(*this, &SuiteOhmReceptionMonitor::TestReportResetsCounts), "TestReportResetsCounts");
+}
+
+void SuiteOhmReceptionMonitor::Setup()
+{
+    iMonitor = new OhmReceptionMonitor();
+}
+
+void SuiteOhmReceptionMonitor::TearDown()
+{
+    delete iMonitor;
+}
+
+void SuiteOhmReceptionMonitor::Add(TUint aFrame, TInt aArrivalOffsetUs, TBool aHalt)
+{
+    const TUint64 arrivalUs = kStartUs + (TUint64)aFrame * kFrameUs + aArrivalOffsetUs;
+    iMonitor->Add(aFrame, (TUint64)aFrame * kFrameSamples, kSampleRate, aHalt, arrivalUs);
+}
+
+void SuiteOhmReceptionMonitor::TestSteadyArrivals()
+{
+    TEST(iMonitor->RequiredLatencyMs() == 0);
+    for (TUint i = 0; i < 100; i++) {
+        Add(i);
+    }
+    TEST(iMonitor->RequiredLatencyMs() == OhmLatency::kHeadroomMs);
+    const OhmHeaderReception report = iMonitor->Report();
+    TEST(report.JitterUs() == 0);
+    TEST(report.SpreadUs() == 0);
+    TEST(report.FramesExpected() == 100);
+    TEST(report.FramesLost() == 0);
+}
+
+void SuiteOhmReceptionMonitor::TestJitteredArrivals()
+{
+    static const TUint kJitterUs = 2000;
+    for (TUint i = 0; i < 200; i++) {
+        Add(i, (i & 1) * kJitterUs);
+    }
+    const OhmHeaderReception report = iMonitor->Report();
+    TEST(report.SpreadUs() == kJitterUs);
+    TEST(report.JitterUs() > kJitterUs * 3 / 4);
+    TEST(report.JitterUs() <= kJitterUs);
+    TEST(report.FramesLost() == 0);
+    TEST(OhmLatency::RequiredMs(report) > OhmLatency::kHeadroomMs);
+}
+
+void SuiteOhmReceptionMonitor::TestLoss()
+{
+    for (TUint i = 0; i < 20; i++) {
+        if (i != 10 && i != 11) {
+            Add(i);
+        }
+    }
+    const OhmHeaderReception report = iMonitor->Report();
+    TEST(report.FramesExpected() == 20);
+    TEST(report.FramesLost() == 2);
+}
+
+void SuiteOhmReceptionMonitor::TestLateFrameNotLost()
+{
+    for (TUint i = 0; i < 20; i++) {
+        if (i != 10) {
+            Add(i);
+        }
+    }
+    Add(10, 10 * kFrameUs); // arrives after frame 19
+    const OhmHeaderReception report = iMonitor->Report();
+    TEST(report.FramesExpected() == 20);
+    TEST(report.FramesLost() == 0);
+}
+
+void SuiteOhmReceptionMonitor::TestNewStream()
+{
+    for (TUint i = 0; i < 10; i++) {
+        Add(i);
+    }
+    // sender restarted with unrelated frame numbers and timestamps
+    iMonitor->Add(5000, 0, kSampleRate, false, kStartUs + 20 * kFrameUs);
+    iMonitor->Add(5001, kFrameSamples, kSampleRate, false, kStartUs + 21 * kFrameUs);
+    const OhmHeaderReception report = iMonitor->Report();
+    TEST(report.FramesExpected() == 12);
+    TEST(report.FramesLost() == 0);
+    TEST(report.SpreadUs() == 0);
+    TEST(report.JitterUs() == 0);
+}
+
+void SuiteOhmReceptionMonitor::TestGapAfterHalt()
+{
+    static const TUint kGapUs = 500 * 1000;
+    for (TUint i = 0; i < 10; i++) {
+        Add(i, 0, i == 9);
+    }
+    for (TUint i = 10; i < 20; i++) {
+        Add(i, kGapUs);
+    }
+    const OhmHeaderReception report = iMonitor->Report();
+    TEST(report.SpreadUs() == 0);
+    TEST(report.JitterUs() == 0);
+}
+
+void SuiteOhmReceptionMonitor::TestGapWithoutHalt()
+{
+    static const TUint kGapUs = 500 * 1000;
+    for (TUint i = 0; i < 10; i++) {
+        Add(i);
+    }
+    for (TUint i = 10; i < 20; i++) {
+        Add(i, kGapUs);
+    }
+    const OhmHeaderReception report = iMonitor->Report();
+    TEST(report.SpreadUs() == kGapUs);
+    TEST(report.JitterUs() > 0);
+}
+
+void SuiteOhmReceptionMonitor::TestReportResetsCounts()
+{
+    for (TUint i = 0; i < 100; i++) {
+        Add(i, (i & 1) * 1000);
+    }
+    const OhmHeaderReception report = iMonitor->Report();
+    TEST(report.FramesExpected() == 100);
+    TEST(report.JitterUs() > 0);
+
+    // jitter estimate is a running average so persists across reports
+    const OhmHeaderReception report2 = iMonitor->Report();
+    TEST(report2.FramesExpected() == 0);
+    TEST(report2.FramesLost() == 0);
+    TEST(report2.SpreadUs() == 0);
+    TEST(report2.JitterUs() == report.JitterUs());
+    TEST(iMonitor->RequiredLatencyMs() == 0);
+}
+
+
+// SuiteOhmLatencyController
+
+SuiteOhmLatencyController::SuiteOhmLatencyController()
+    : SuiteUnitTest("SuiteOhmLatencyController")
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestStartsAtDefault), "TestStartsAtDefault");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestIncreaseImmediate), "TestIncreaseImmediate");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestRoundsUp), "TestRoundsUp");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestHighestReceiverWins), "TestHighestReceiverWins");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestClampedToMax), "TestClampedToMax");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestSmallDecreaseIgnored), "TestSmallDecreaseIgnored");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestDecreaseAfterHold), "TestDecreaseAfterHold");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestLegacyReceiverUsesDefault), "TestLegacyReceiverUsesDefault");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestExpiredReportIgnored), "TestExpiredReportIgnored");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestNoReportsHoldsLatency), "TestNoReportsHoldsLatency");
+    AddTest(MakeFunctor(*this, &SuiteOhmLatencyController::TestDisabled), "TestDisabled");
+}
+
+void SuiteOhmLatencyController::Setup()
+{
+    iController = new OhmLatencyController();
+    iController->SetRange(kMinMs, kMaxMs, kDefaultMs);
+    iReceiver1.Replace(Endpoint(51972, Brn("192.168.1.10")));
+    iReceiver2.Replace(Endpoint(51972, Brn("192.168.1.11")));
+}
+
+void SuiteOhmLatencyController::TearDown()
+{
+    delete iController;
+}
+
+OhmHeaderReception SuiteOhmLatencyController::Reception(TUint aRequiredMs)
+{ // static
+    ASSERT(aRequiredMs > OhmLatency::kHeadroomMs);
+    const TUint spreadUs = (aRequiredMs - OhmLatency::kHeadroomMs) * 1000;
+    const OhmHeaderReception reception(0, spreadUs, 200, 0);
+    ASSERT(OhmLatency::RequiredMs(reception) == aRequiredMs);
+    return reception;
+}
+
+void SuiteOhmLatencyController::TestStartsAtDefault()
+{
+    TEST(iController->Enabled());
+    TEST(iController->LatencyMs() == kDefaultMs);
+    TEST(!iController->Update(0));
+    TEST(iController->LatencyMs() == kDefaultMs);
+}
+
+void SuiteOhmLatencyController::TestIncreaseImmediate()
+{
+    iController->Add(iReceiver1, Reception(420), 0);
+    TEST(iController->Update(0));
+    TEST(iController->LatencyMs() == 420);
+    iController->Add(iReceiver1, Reception(420), 1000);
+    TEST(!iController->Update(1000));
+}
+
+void SuiteOhmLatencyController::TestRoundsUp()
+{
+    iController->Add(iReceiver1, Reception(343), 0);
+    TEST(iController->Update(0));
+    TEST(iController->LatencyMs() == 350);
+}
+
+void SuiteOhmLatencyController::TestHighestReceiverWins()
+{
+    iController->Add(iReceiver1, Reception(420), 0);
+    iController->Add(iReceiver2, Reception(150), 0);
+    TEST(iController->Update(0));
+    TEST(iController->LatencyMs() == 420);
+}
+
+void SuiteOhmLatencyController::TestClampedToMax()
+{
+    iController->Add(iReceiver1, Reception(2000), 0);
+    TEST(iController->Update(0));
+    TEST(iController->LatencyMs() == kMaxMs);
+}
+
+void SuiteOhmLatencyController::TestSmallDecreaseIgnored()
+{
+    static const TUint kStepMs = 10 * 1000;
+    for (TUint now = 0; now <= 4 * OhmLatencyController::kDecreaseHoldMs; now += kStepMs) {
+        iController->Add(iReceiver1, Reception(kDefaultMs - OhmLatencyController::kDecreaseMarginMs + 5), now);
+        TEST(!iController->Update(now));
+    }
+    TEST(iController->LatencyMs() == kDefaultMs);
+}
+
+void SuiteOhmLatencyController::TestDecreaseAfterHold()
+{
+    static const TUint kStepMs = 10 * 1000;
+    TUint now = 0;
+    for (; now < OhmLatencyController::kDecreaseHoldMs; now += kStepMs) {
+        iController->Add(iReceiver1, Reception(50), now);
+        TEST(!iController->Update(now));
+        TEST(iController->LatencyMs() == kDefaultMs);
+    }
+    iController->Add(iReceiver1, Reception(50), now);
+    TEST(iController->Update(now));
+    TEST(iController->LatencyMs() == kMinMs);
+}
+
+void SuiteOhmLatencyController::TestLegacyReceiverUsesDefault()
+{
+    static const TUint kStepMs = 10 * 1000;
+    for (TUint now = 0; now <= 2 * OhmLatencyController::kDecreaseHoldMs; now += kStepMs) {
+        iController->AddLegacy(iReceiver1, now);
+        iController->Add(iReceiver2, Reception(50), now);
+        TEST(!iController->Update(now));
+    }
+    TEST(iController->LatencyMs() == kDefaultMs);
+}
+
+void SuiteOhmLatencyController::TestExpiredReportIgnored()
+{
+    static const TUint kStepMs = 10 * 1000;
+    iController->Add(iReceiver1, Reception(420), 0);
+    TEST(iController->Update(0));
+    TEST(iController->LatencyMs() == 420);
+
+    // receiver1 stops reporting.  Its report expires, after which a decrease can start
+    TUint now = 0;
+    for (; now <= OhmLatencyController::kReportLifetimeMs + OhmLatencyController::kDecreaseHoldMs; now += kStepMs) {
+        iController->Add(iReceiver2, Reception(50), now);
+        TEST(!iController->Update(now));
+        TEST(iController->LatencyMs() == 420);
+    }
+    iController->Add(iReceiver2, Reception(50), now);
+    TEST(iController->Update(now));
+    TEST(iController->LatencyMs() == kMinMs);
+}
+
+void SuiteOhmLatencyController::TestNoReportsHoldsLatency()
+{
+    iController->Add(iReceiver1, Reception(420), 0);
+    TEST(iController->Update(0));
+    TEST(!iController->Update(OhmLatencyController::kReportLifetimeMs + 1));
+    TEST(!iController->Update(OhmLatencyController::kReportLifetimeMs + OhmLatencyController::kDecreaseHoldMs + 1));
+    TEST(iController->LatencyMs() == 420);
+}
+
+void SuiteOhmLatencyController::TestDisabled()
+{
+    iController->SetRange(kMinMs, kMinMs, kMinMs);
+    TEST(!iController->Enabled());
+    TEST(iController->LatencyMs() == 0);
+    iController->Add(iReceiver1, Reception(420), 0);
+    iController->AddLegacy(iReceiver2, 0);
+    TEST(!iController->Update(0));
+    TEST(iController->LatencyMs() == 0);
+
+    // re-enabling starts again from the default
+    iController->SetRange(kMinMs, kMaxMs, kDefaultMs);
+    TEST(iController->LatencyMs() == kDefaultMs);
+    TEST(!iController->Update(0));
+}
+
+
+
+void TestOhmLatency()
+{
+    Runner runner("Songcast adaptive latency tests\n");
+    runner.Add(new SuiteOhmLatency());
+    runner.Add(new SuiteOhmReceptionMonitor());
+    runner.Add(new SuiteOhmLatencyController());
+    runner.Run();
+}
@@ -0,0 +1,395 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/SuiteUnitTest.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/NetworkAdapterList.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Av/Songcast/Ohm.h>
+#include <OpenHome/Av/Songcast/OhmSocket.h>
+#include <OpenHome/Av/Songcast/OhmRelayTree.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+namespace OpenHome {
+namespace Av {
+
+class SuiteOhmRelayTree : public SuiteUnitTest
+{
+public:
+    SuiteOhmRelayTree();
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestDefaultMatchesFlatSlaveList();
+    void TestDepthLimitedByLatency();
+    void TestCapacity();
+    void TestParentChildConsistent();
+    void TestRelayCount();
+private:
+    OhmRelayTree* iTree;
+};
+
+// Minimal stand in for ProtocolOhu: receives on its own socket, relays to the slaves it was last told about
+class TestRelayReceiver : public INonCopyable
+{
+    static const TUint kMaxMsgBytes = 1024;
+public:
+    TestRelayReceiver(Environment& aEnv, TIpAddress aInterface);
+    ~TestRelayReceiver();
+    Endpoint This() const;
+    void Receive(); // one msg; a slave list or relayed audio
+    TUint AudioCount() const { return iAudioCount; }
+    TUint Hops() const { return iHops; }
+    TUint SlaveCount() const { return iSlaveCount; }
+private:
+    OhmSocket iSocket;
+    Srs<kMaxMsgBytes> iReadBuffer;
+    Bws<kMaxMsgBytes> iTxBuffer;
+    Endpoint iSlaveList[OhmRelayTree::kMaxFanOut];
+    TUint iSlaveCount;
+    TUint iAudioCount;
+    TUint iHops;
+};
+
+class SuiteOhmRelayLoopback : public SuiteUnitTest, public INonCopyable
+{
+    static const TUint kMaxReceivers = 31;
+public:
+    SuiteOhmRelayLoopback(Environment& aEnv, TIpAddress aInterface);
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestFanOut4();
+    void TestFanOut2();
+    void TestReparentOnRelayExpiry();
+private:
+    void Create(TUint aReceivers);
+    void SendSlaveLists(TUint aReceivers, TUint aRelaysNotified);
+    void SendAudio(TUint aReceivers);
+    void CheckDelivery(TUint aReceivers, TUint aExpectedCount);
+private:
+    Environment& iEnv;
+    TIpAddress iInterface;
+    OhmRelayTree iTree;
+    OhmSocket* iSender;
+    std::vector<TestRelayReceiver*> iReceivers;
+    Bws<1024> iTxBuffer;
+};
+
+} // namespace Av
+} // namespace OpenHome
+
+using namespace OpenHome::Av;
+
+
+// SuiteOhmRelayTree
+
+SuiteOhmRelayTree::SuiteOhmRelayTree()
+    : SuiteUnitTest("SuiteOhmRelayTree")
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmRelayTree::TestDefaultMatchesFlatSlaveList), "TestDefaultMatchesFlatSlaveList");
+    AddTest(MakeFunctor(*this, &SuiteOhmRelayTree::TestDepthLimitedByLatency), "TestDepthLimitedByLatency");
+    AddTest(MakeFunctor(*this, &SuiteOhmRelayTree::TestCapacity), "TestCapacity");
+    AddTest(MakeFunctor(*this, &SuiteOhmRelayTree::TestParentChildConsistent), "TestParentChildConsistent");
+    AddTest(MakeFunctor(*this, &SuiteOhmRelayTree::TestRelayCount), "TestRelayCount");
+}
+
+void SuiteOhmRelayTree::Setup()
+{
+    iTree = new OhmRelayTree();
+}
+
+void SuiteOhmRelayTree::TearDown()
+{
+    delete iTree;
+}
+
+void SuiteOhmRelayTree::TestDefaultMatchesFlatSlaveList()
+{
+    // low latency gives the single level of relaying (to 4 slaves) senders always supported
+    iTree->Configure(OhmRelayTree::kMaxFanOut, 0);
+    TEST(iTree->MaxDepth() == 1);
+    TEST(iTree->Capacity() == 5);
+    TEST(iTree->FirstChild(0) == 1);
+    TEST(iTree->ChildCount(0, 5) == 4);
+    TEST(iTree->ChildCount(1, 5) == 0);
+    TEST(iTree->RelayCount(5) == 1);
+}
+
+void SuiteOhmRelayTree::TestDepthLimitedByLatency()
+{
+    TEST(OhmRelayTree::MaxDepthForLatency(0) == 1);
+    TEST(OhmRelayTree::MaxDepthForLatency(2 * OhmRelayTree::kHopBudgetMs) == 1);
+    TEST(OhmRelayTree::MaxDepthForLatency(4 * OhmRelayTree::kHopBudgetMs) == 2);
+    TEST(OhmRelayTree::MaxDepthForLatency(4 * OhmRelayTree::kHopBudgetMs - 1) == 1);
+    TEST(OhmRelayTree::MaxDepthForLatency(150) == 3);
+}
+
+void SuiteOhmRelayTree::TestCapacity()
+{
+    iTree->Configure(4, 4 * OhmRelayTree::kHopBudgetMs);
+    TEST(iTree->Capacity() == 1 + 4 + 16);
+    iTree->Configure(2, 8 * OhmRelayTree::kHopBudgetMs);
+    TEST(iTree->MaxDepth() == 4);
+    TEST(iTree->Capacity() == 1 + 2 + 4 + 8 + 16);
+    iTree->Configure(1, 4 * OhmRelayTree::kHopBudgetMs);
+    TEST(iTree->Capacity() == 3); // chain
+    iTree->Configure(4, 1000);
+    TEST(iTree->Capacity() == OhmRelayTree::kMaxReceivers);
+}
+
+void SuiteOhmRelayTree::TestParentChildConsistent()
+{
+    for (TUint fanOut = 1; fanOut <= OhmRelayTree::kMaxFanOut; fanOut++) {
+        iTree->Configure(fanOut, 1000);
+        const TUint receivers = iTree->Capacity();
+        std::vector<TUint> parents(receivers, 0);
+        for (TUint i = 0; i < receivers; i++) {
+            const TUint first = iTree->FirstChild(i);
+            const TUint count = iTree->ChildCount(i, receivers);
+            TEST(count <= fanOut);
+            for (TUint j = 0; j < count; j++) {
+                TEST(iTree->Parent(first + j) == i);
+                parents[first + j]++;
+            }
+        }
+        // every receiver other than the one the sender sends to has exactly one parent
+        TEST(parents[0] == 0);
+        for (TUint i = 1; i < receivers; i++) {
+            TEST(parents[i] == 1);
+            TEST(iTree->Depth(i) == iTree->Depth(iTree->Parent(i)) + 1);
+            TEST(iTree->Depth(i) <= iTree->MaxDepth());
+        }
+    }
+}
+
+void SuiteOhmRelayTree::TestRelayCount()
+{
+    iTree->Configure(4, 1000);
+    TEST(iTree->RelayCount(0) == 0);
+    TEST(iTree->RelayCount(1) == 0);
+    TEST(iTree->RelayCount(2) == 1);
+    TEST(iTree->RelayCount(5) == 1);
+    TEST(iTree->RelayCount(6) == 2);
+    TEST(iTree->RelayCount(21) == 5);
+    for (TUint receivers = 1; receivers <= iTree->Capacity(); receivers++) {
+        const TUint relays = iTree->RelayCount(receivers);
+        for (TUint i = 0; i < receivers; i++) {
+            TEST((iTree->ChildCount(i, receivers) > 0) == (i < relays));
+        }
+    }
+}
+
+
+// TestRelayReceiver
+
+TestRelayReceiver::TestRelayReceiver(Environment& aEnv, TIpAddress aInterface)
+    : iSocket(aEnv)
+    , iReadBuffer(iSocket)
+    , iSlaveCount(0)
+    , iAudioCount(0)
+    , iHops(0)
+{
+    iSocket.OpenUnicast(aInterface, 1);
+}
+
+TestRelayReceiver::~TestRelayReceiver()
+{
+    iSocket.Close();
+}
+
+Endpoint TestRelayReceiver::This() const
+{
+    return iSocket.This();
+}
+
+void TestRelayReceiver::Receive()
+{
+    OhmHeader header;
+    header.Internalise(iReadBuffer);
+    if (header.MsgType() == OhmHeader::kMsgTypeSlave) {
+        OhmHeaderSlave headerSlave;
+        headerSlave.Internalise(iReadBuffer, header);
+        iSlaveCount = headerSlave.SlaveCount();
+        ASSERT(iSlaveCount <= OhmRelayTree::kMaxFanOut);
+        for (TUint i = 0; i < iSlaveCount; i++) {
+            iSlaveList[i].Internalise(iReadBuffer);
+        }
+    }
+    else {
+        // payload is the number of relays the msg has passed through
+        ASSERT(header.MsgType() == OhmHeader::kMsgTypeAudio);
+        ReaderBinary reader(iReadBuffer);
+        iHops = reader.ReadUintBe(1);
+        iAudioCount++;
+        if (iSlaveCount > 0) {
+            WriterBuffer writer(iTxBuffer);
+            writer.Flush();
+            header.Externalise(writer);
+            WriterBinary(writer).WriteUint8(iHops + 1);
+            TEST(iSocket.Send(iTxBuffer, iSlaveList, iSlaveCount) == 0);
+        }
+    }
+    iReadBuffer.ReadFlush();
+}
+
+
+// SuiteOhmRelayLoopback
+
+SuiteOhmRelayLoopback::SuiteOhmRelayLoopback(Environment& aEnv, TIpAddress aInterface)
+    : SuiteUnitTest("SuiteOhmRelayLoopback")
+    , iEnv(aEnv)
+    , iInterface(aInterface)
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmRelayLoopback::TestFanOut4), "TestFanOut4");
+    AddTest(MakeFunctor(*this, &SuiteOhmRelayLoopback::TestFanOut2), "TestFanOut2");
+    AddTest(MakeFunctor(*this, &SuiteOhmRelayLoopback::TestReparentOnRelayExpiry), "TestReparentOnRelayExpiry");
+}
+
+void SuiteOhmRelayLoopback::Setup()
+{
+    iSender = new OhmSocket(iEnv);
+    iSender->OpenUnicast(iInterface, 1);
+}
+
+void SuiteOhmRelayLoopback::TearDown()
+{
+    for (TUint i = 0; i < iReceivers.size(); i++) {
+        delete iReceivers[i];
+    }
+    iReceivers.clear();
+    delete iSender;
+}
+
+void SuiteOhmRelayLoopback::Create(TUint aReceivers)
+{
+    ASSERT(aReceivers <= kMaxReceivers);
+    for (TUint i = 0; i < aReceivers; i++) {
+        iReceivers.push_back(new TestRelayReceiver(iEnv, iInterface));
+    }
+}
+
+void SuiteOhmRelayLoopback::SendSlaveLists(TUint aReceivers, TUint aRelaysNotified)
+{
+    // as OhmSender::SendSlaveList
+    const TUint relays = iTree.RelayCount(aReceivers);
+    const TUint notify = std::max(relays, std::min(aRelaysNotified, aReceivers));
+    for (TUint i = 0; i < notify; i++) {
+        const TUint first = iTree.FirstChild(i);
+        const TUint children = iTree.ChildCount(i, aReceivers);
+        OhmHeaderSlave headerSlave(children);
+        OhmHeader header(OhmHeader::kMsgTypeSlave, headerSlave.MsgBytes());
+        WriterBuffer writer(iTxBuffer);
+        writer.Flush();
+        header.Externalise(writer);
+        headerSlave.Externalise(writer);
+        for (TUint j = 0; j < children; j++) {
+            iReceivers[first + j]->This().Externalise(writer);
+        }
+        iSender->Send(iTxBuffer, iReceivers[i]->This());
+        iReceivers[i]->Receive();
+        TEST(iReceivers[i]->SlaveCount() == children);
+    }
+}
+
+void SuiteOhmRelayLoopback::SendAudio(TUint aReceivers)
+{
+    OhmHeader header(OhmHeader::kMsgTypeAudio, 1);
+    WriterBuffer writer(iTxBuffer);
+    writer.Flush();
+    header.Externalise(writer);
+    WriterBinary(writer).WriteUint8(0);
+    iSender->Send(iTxBuffer, iReceivers[0]->This());
+    // parents always have lower indices than their children so each receiver's msg is already queued
+    for (TUint i = 0; i < aReceivers; i++) {
+        iReceivers[i]->Receive();
+    }
+}
+
+void SuiteOhmRelayLoopback::CheckDelivery(TUint aReceivers, TUint aExpectedCount)
+{
+    for (TUint i = 0; i < aReceivers; i++) {
+        TEST(iReceivers[i]->AudioCount() == aExpectedCount);
+        TEST(iReceivers[i]->Hops() == iTree.Depth(i));
+        TEST(iReceivers[i]->Hops() <= iTree.MaxDepth());
+    }
+}
+
+void SuiteOhmRelayLoopback::TestFanOut4()
+{
+    iTree.Configure(4, 4 * OhmRelayTree::kHopBudgetMs);
+    const TUint receivers = iTree.Capacity();
+    TEST(receivers == 21);
+    Create(receivers);
+    SendSlaveLists(receivers, 0);
+    for (TUint i = 0; i < 10; i++) {
+        SendAudio(receivers);
+    }
+    CheckDelivery(receivers, 10);
+}
+
+void SuiteOhmRelayLoopback::TestFanOut2()
+{
+    iTree.Configure(2, 8 * OhmRelayTree::kHopBudgetMs);
+    const TUint receivers = iTree.Capacity();
+    TEST(receivers == kMaxReceivers);
+    Create(receivers);
+    SendSlaveLists(receivers, 0);
+    SendAudio(receivers);
+    CheckDelivery(receivers, 1);
+    TEST(iReceivers[receivers - 1]->Hops() == 4);
+}
+
+void SuiteOhmRelayLoopback::TestReparentOnRelayExpiry()
+{
+    iTree.Configure(4, 4 * OhmRelayTree::kHopBudgetMs);
+    TUint receivers = 18;
+    Create(receivers);
+    SendSlaveLists(receivers, 0);
+    SendAudio(receivers);
+    CheckDelivery(receivers, 1);
+
+    /* Relay 2 expires.  As OhmSender::RemoveSlave, the last receiver moves into its place,
+       so only relay 2's children (and the moved receiver's old parent) need new slave lists. */
+    const TUint relaysNotified = iTree.RelayCount(receivers);
+    delete iReceivers[2];
+    receivers--;
+    iReceivers[2] = iReceivers[receivers];
+    iReceivers.pop_back();
+    SendSlaveLists(receivers, relaysNotified);
+    SendAudio(receivers);
+    for (TUint i = 0; i < receivers; i++) {
+        TEST(iReceivers[i]->Hops() == iTree.Depth(i));
+    }
+    TEST(iReceivers[2]->AudioCount() == 2);
+    TEST(iReceivers[iTree.FirstChild(2)]->AudioCount() == 2);
+}
+
+
+
+void TestOhmRelayTree(Environment& aEnv)
+{
+    AutoNetworkAdapterRef ref(aEnv, "TestOhmRelayTree");
+    NetworkAdapter* current = ref.Adapter();
+    if (current == nullptr) {
+        std::vector<NetworkAdapter*>* subnetList = aEnv.NetworkAdapterList().CreateSubnetList();
+        if (subnetList->size() > 0) {
+            current = (*subnetList)[0];
+        }
+        NetworkAdapterList::DestroySubnetList(subnetList);
+    }
+    ASSERT(current != nullptr);
+
+    Runner runner("Songcast relay tree tests\n");
+    runner.Add(new SuiteOhmRelayTree());
+    runner.Add(new SuiteOhmRelayLoopback(aEnv, current->Address()));
+    runner.Run();
+}
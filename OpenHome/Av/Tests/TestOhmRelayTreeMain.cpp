@@ -0,0 +1,12 @@
+#include <OpenHome/Private/TestFramework.h>
+
+using namespace OpenHome;
+
+extern void TestOhmRelayTree(Environment& aEnv);
+
+void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+{
+    Net::Library* lib = new Net::Library(aInitParams);
+    TestOhmRelayTree(lib->Env());
+    delete lib;
+}
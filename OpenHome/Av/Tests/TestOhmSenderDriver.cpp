@@ -0,0 +1,312 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/SuiteUnitTest.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Json.h>
+#include <OpenHome/Private/Converter.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/NetworkAdapterList.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Av/Songcast/Ohm.h>
+#include <OpenHome/Av/Songcast/OhmMsg.h>
+#include <OpenHome/Av/Songcast/OhmSender.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+namespace OpenHome {
+namespace Av {
+
+class SuiteOhmSenderDriverHistory : public SuiteUnitTest, public INonCopyable
+{
+    static const TUint kSampleRate = 44100;
+    static const TUint kChannels = 2;
+    static const TUint kBitDepth = 16;
+    static const TUint kMsgBytes = (kSampleRate / 200) * kChannels * (kBitDepth / 8); // 5ms
+public:
+    SuiteOhmSenderDriverHistory(Environment& aEnv, TIpAddress aInterface);
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestResendRecent();
+    void TestResendOutsideHistory();
+    void TestHistoryShrinks();
+    void TestFrameJumpClearsHistory();
+    void TestHistoryDoesNotExhaustMsgs();
+private:
+    void Send(TUint aMsgs, TBool aReceive);
+    TUint Resend(const std::vector<TUint>& aFrames);
+    TUint ReceiveFrame(TBool& aResent);
+private:
+    Environment& iEnv;
+    TIpAddress iInterface;
+    OhmSenderDriver* iDriver;
+    SocketUdp* iReceiver;
+    Bws<kMsgBytes> iAudio;
+    Bws<OhmMsgAudio::kStreamHeaderBytes + OhmMsgAudio::kMaxAudioBytes + OhmHeader::kHeaderBytes> iRxBuf;
+};
+
+class SuiteOhmResendStats : public SuiteUnitTest, public INonCopyable
+{
+public:
+    SuiteOhmResendStats(Environment& aEnv);
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestEmpty();
+    void TestPerReceiver();
+    void TestOldestReceiverReplaced();
+private:
+    void Write();
+private:
+    Environment& iEnv;
+    OhmResendStats* iStats;
+    Bwh iJson;
+};
+
+} // namespace Av
+} // namespace OpenHome
+
+using namespace OpenHome::Av;
+
+
+// SuiteOhmSenderDriverHistory
+
+SuiteOhmSenderDriverHistory::SuiteOhmSenderDriverHistory(Environment& aEnv, TIpAddress aInterface)
+    : SuiteUnitTest("SuiteOhmSenderDriverHistory")
+    , iEnv(aEnv)
+    , iInterface(aInterface)
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmSenderDriverHistory::TestResendRecent), "TestResendRecent");
+    AddTest(MakeFunctor(*this, &SuiteOhmSenderDriverHistory::TestResendOutsideHistory), "TestResendOutsideHistory");
+    AddTest(MakeFunctor(*this, &SuiteOhmSenderDriverHistory::TestHistoryShrinks), "TestHistoryShrinks");
+    AddTest(MakeFunctor(*this, &SuiteOhmSenderDriverHistory::TestFrameJumpClearsHistory), "TestFrameJumpClearsHistory");
+    AddTest(MakeFunctor(*this, &SuiteOhmSenderDriverHistory::TestHistoryDoesNotExhaustMsgs), "TestHistoryDoesNotExhaustMsgs");
+}
+
+void SuiteOhmSenderDriverHistory::Setup()
+{
+    iReceiver = new SocketUdp(iEnv, 0, iInterface);
+    iDriver = new OhmSenderDriver(iEnv, nullptr);
+    IOhmSenderDriver& driver = *iDriver;
+    driver.SetEndpoint(Endpoint(iReceiver->Port(), iInterface), iInterface);
+    driver.SetEnabled(true);
+    driver.SetActive(true);
+    iDriver->SetAudioFormat(kSampleRate, kSampleRate * kChannels * kBitDepth, kChannels, kBitDepth, true, Brn("PCM"), 0);
+    iAudio.SetBytes(kMsgBytes);
+    for (TUint i = 0; i < kMsgBytes; i++) {
+        iAudio[i] = (TByte)i;
+    }
+}
+
+void SuiteOhmSenderDriverHistory::TearDown()
+{
+    static_cast<IOhmSenderDriver*>(iDriver)->SetActive(false); // returns history msgs to the factory
+    delete iDriver;
+    delete iReceiver;
+}
+
+void SuiteOhmSenderDriverHistory::Send(TUint aMsgs, TBool aReceive)
+{
+    for (TUint i = 0; i < aMsgs; i++) {
+        iDriver->SendAudio(iAudio.Ptr(), iAudio.Bytes());
+        if (aReceive) {
+            TBool resent;
+            (void)ReceiveFrame(resent);
+            TEST(!resent);
+        }
+    }
+}
+
+TUint SuiteOhmSenderDriverHistory::Resend(const std::vector<TUint>& aFrames)
+{
+    Bwh frames(aFrames.size() * 4);
+    WriterBuffer wb(frames);
+    WriterBinary writer(wb);
+    for (auto frame : aFrames) {
+        writer.WriteUint32Be(frame);
+    }
+    return static_cast<IOhmSenderDriver*>(iDriver)->Resend(frames);
+}
+
+TUint SuiteOhmSenderDriverHistory::ReceiveFrame(TBool& aResent)
+{
+    static const TUint kFlagsIndex = OhmHeader::kHeaderBytes + 1;
+    static const TUint kFrameIndex = OhmHeader::kHeaderBytes + 4;
+    (void)iReceiver->Receive(iRxBuf);
+    TEST(iRxBuf[5] == OhmHeader::kMsgTypeAudio);
+    aResent = ((iRxBuf[kFlagsIndex] & OhmMsgAudio::kFlagResent) != 0);
+    return Converter::BeUint32At(iRxBuf, kFrameIndex);
+}
+
+void SuiteOhmSenderDriverHistory::TestResendRecent()
+{
+    Send(20, true);
+    TEST(Resend({ 5, 19, 3 }) == 3);
+    TBool resent = false;
+    TEST(ReceiveFrame(resent) == 5);
+    TEST(resent);
+    TEST(ReceiveFrame(resent) == 19);
+    TEST(ReceiveFrame(resent) == 3);
+}
+
+void SuiteOhmSenderDriverHistory::TestResendOutsideHistory()
+{
+    iDriver->SetHistoryFrames(10);
+    Send(30, true);
+    TEST(Resend({ 5, 19, 20, 29, 30 }) == 2);
+    TBool resent;
+    TEST(ReceiveFrame(resent) == 20);
+    TEST(ReceiveFrame(resent) == 29);
+}
+
+void SuiteOhmSenderDriverHistory::TestHistoryShrinks()
+{
+    Send(50, true);
+    TEST(Resend({ 0 }) == 1);
+    TBool resent;
+    TEST(ReceiveFrame(resent) == 0);
+    iDriver->SetHistoryFrames(10);
+    TEST(Resend({ 0, 39 }) == 0);
+    TEST(Resend({ 40, 49 }) == 2);
+    TEST(ReceiveFrame(resent) == 40);
+    TEST(ReceiveFrame(resent) == 49);
+}
+
+void SuiteOhmSenderDriverHistory::TestFrameJumpClearsHistory()
+{
+    Send(20, true);
+    static_cast<IOhmSenderDriver*>(iDriver)->StreamInterrupted();
+    Send(5, false);
+    TEST(Resend({ 19 }) == 0);
+    TBool resent;
+    TUint frame = ReceiveFrame(resent);
+    TEST(frame > 19);
+    TEST(Resend({ frame + 2 }) == 1);
+}
+
+void SuiteOhmSenderDriverHistory::TestHistoryDoesNotExhaustMsgs()
+{
+    /* Msgs are only returned to the factory when they drop out of the history.
+       Sending many more msgs than the factory holds, with occasional breaks in frame
+       numbering, would block if any leaked. */
+    iDriver->SetHistoryFrames(OhmSenderDriver::kMaxHistoryFrames);
+    for (TUint i = 0; i < 10; i++) {
+        Send(OhmSenderDriver::kMaxHistoryFrames, false);
+        static_cast<IOhmSenderDriver*>(iDriver)->StreamInterrupted();
+    }
+    iDriver->SetHistoryFrames(1);
+    Send(OhmSenderDriver::kMaxHistoryFrames * 2, false);
+}
+
+
+// SuiteOhmResendStats
+
+SuiteOhmResendStats::SuiteOhmResendStats(Environment& aEnv)
+    : SuiteUnitTest("SuiteOhmResendStats")
+    , iEnv(aEnv)
+    , iJson(4 * 1024)
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmResendStats::TestEmpty), "TestEmpty");
+    AddTest(MakeFunctor(*this, &SuiteOhmResendStats::TestPerReceiver), "TestPerReceiver");
+    AddTest(MakeFunctor(*this, &SuiteOhmResendStats::TestOldestReceiverReplaced), "TestOldestReceiverReplaced");
+}
+
+void SuiteOhmResendStats::Setup()
+{
+    iStats = new OhmResendStats(iEnv);
+}
+
+void SuiteOhmResendStats::TearDown()
+{
+    delete iStats;
+}
+
+void SuiteOhmResendStats::Write()
+{
+    iJson.SetBytes(0);
+    WriterBuffer writer(iJson);
+    WriterJsonArray writerArray(writer);
+    iStats->Write(writerArray);
+    writerArray.WriteEnd();
+}
+
+void SuiteOhmResendStats::TestEmpty()
+{
+    Write();
+    TEST(iJson == Brn("[]"));
+}
+
+void SuiteOhmResendStats::TestPerReceiver()
+{
+    const Endpoint ep1(5000, Brn("192.168.1.10"));
+    const Endpoint ep2(5001, Brn("192.168.1.11"));
+    iStats->Add(ep1, 4, 3);
+    iStats->Add(ep2, 1, 0);
+    iStats->Add(ep1, 2, 2);
+    Write();
+
+    auto parserArray = JsonParserArray::Create(iJson);
+    JsonParser parser;
+    parser.Parse(parserArray.NextObject());
+    Endpoint::EndpointBuf buf;
+    ep1.AppendEndpoint(buf);
+    TEST(parser.String("receiver") == buf);
+    TEST(parser.Num("requests") == 2);
+    TEST(parser.Num("frames_requested") == 6);
+    TEST(parser.Num("frames_resent") == 5);
+    TEST(parser.Num("frames_per_minute") > 0);
+    TEST(parser.Num("age_seconds") == 0);
+
+    parser.Parse(parserArray.NextObject());
+    buf.SetBytes(0);
+    ep2.AppendEndpoint(buf);
+    TEST(parser.String("receiver") == buf);
+    TEST(parser.Num("requests") == 1);
+    TEST(parser.Num("frames_requested") == 1);
+    TEST(parser.Num("frames_resent") == 0);
+    Brn entry;
+    TEST(!parserArray.TryNextObject(entry));
+}
+
+void SuiteOhmResendStats::TestOldestReceiverReplaced()
+{
+    static const TUint kReceivers = 20;
+    for (TUint i = 0; i < kReceivers; i++) {
+        iStats->Add(Endpoint(5000 + i, Brn("192.168.1.10")), 1, 1);
+    }
+    Write();
+    auto parserArray = JsonParserArray::Create(iJson);
+    TUint count = 0;
+    Brn entry;
+    while (parserArray.TryNextObject(entry)) {
+        count++;
+    }
+    TEST(count > 0 && count < kReceivers);
+}
+
+
+
+void TestOhmSenderDriver(Environment& aEnv)
+{
+    AutoNetworkAdapterRef ref(aEnv, "TestOhmSenderDriver");
+    NetworkAdapter* current = ref.Adapter();
+    if (current == nullptr) {
+        std::vector<NetworkAdapter*>* subnetList = aEnv.NetworkAdapterList().CreateSubnetList();
+        if (subnetList->size() > 0) {
+            current = (*subnetList)[0];
+        }
+        NetworkAdapterList::DestroySubnetList(subnetList);
+    }
+    ASSERT(current != nullptr);
+
+    Runner runner("Songcast sender driver tests\n");
+    runner.Add(new SuiteOhmSenderDriverHistory(aEnv, current->Address()));
+    runner.Add(new SuiteOhmResendStats(aEnv));
+    runner.Run();
+}
@@ -0,0 +1,12 @@
+#include <OpenHome/Private/TestFramework.h>
+
+using namespace OpenHome;
+
+extern void TestOhmSenderDriver(Environment& aEnv);
+
+void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+{
+    Net::Library* lib = new Net::Library(aInitParams);
+    TestOhmSenderDriver(lib->Env());
+    delete lib;
+}
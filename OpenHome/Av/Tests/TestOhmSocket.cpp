@@ -0,0 +1,368 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/SuiteUnitTest.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/NetworkAdapterList.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/SocketUdpBatch.h>
+#include <OpenHome/Av/Songcast/OhmSocket.h>
+#include <OpenHome/Av/Songcast/Ohm.h>
+#include <OpenHome/Av/Songcast/OhmMsg.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+namespace OpenHome {
+namespace Av {
+
+class SuiteOhmSocketFanOut : public SuiteUnitTest, public INonCopyable
+{
+    static const TUint kSlaveCount = 4;
+    static const TUint kTtl = 1;
+    static const TUint kMaxDatagramBytes = OhmHeader::kHeaderBytes + OhmMsgAudio::kStreamHeaderBytes + OhmMsgAudio::kMaxAudioBytes;
+public:
+    SuiteOhmSocketFanOut(Environment& aEnv, TIpAddress aInterface);
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestSendToAll();
+    void TestSendToNone();
+    void TestReadSender();
+private:
+    Environment& iEnv;
+    TIpAddress iInterface;
+    OhmSocket* iSocket;
+    SocketUdp* iSlaves[kSlaveCount];
+    Endpoint iEndpoints[kSlaveCount];
+    Bws<kMaxDatagramBytes> iTx;
+    Bws<kMaxDatagramBytes> iRx;
+};
+
+class SuiteSocketUdpBatch : public SuiteUnitTest, public INonCopyable
+{
+    static const TUint kMaxDatagramBytes = 2 * 1024;
+public:
+    SuiteSocketUdpBatch(Environment& aEnv, TIpAddress aInterface);
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestReceiveBatched();
+    void TestReceiveTruncates();
+    void TestInterrupt();
+    void TestSendCalls();
+private:
+    Environment& iEnv;
+    TIpAddress iInterface;
+    SocketUdpBatch* iSocket;
+    SocketUdp* iPeer;
+    Bws<kMaxDatagramBytes> iBuf;
+};
+
+class SuiteOhmSocketRelayRate : public SuiteUnitTest, public INonCopyable
+{
+    static const TUint kSlaveCount = 4;
+    static const TUint kSeconds = 10;
+    static const TUint kMsgsPerSecond = 200; // 5ms audio msgs
+    static const TUint kMsgBytes = OhmHeader::kHeaderBytes + OhmMsgAudio::kStreamHeaderBytes + OhmMsgAudio::kMaxSampleBytes;
+public:
+    SuiteOhmSocketRelayRate(Environment& aEnv, TIpAddress aInterface);
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestPerDatagram();
+    void TestBatched();
+    void Report(const TChar* aName, TUint64 aSendUs, TUint64 aSyscalls);
+private:
+    Environment& iEnv;
+    TIpAddress iInterface;
+    SocketUdp* iSlaves[kSlaveCount];
+    Endpoint iEndpoints[kSlaveCount];
+    Bws<kMsgBytes> iTx;
+};
+
+} // namespace Av
+} // namespace OpenHome
+
+using namespace OpenHome::Av;
+
+
+// SuiteOhmSocketFanOut
+
+SuiteOhmSocketFanOut::SuiteOhmSocketFanOut(Environment& aEnv, TIpAddress aInterface)
+    : SuiteUnitTest("SuiteOhmSocketFanOut")
+    , iEnv(aEnv)
+    , iInterface(aInterface)
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmSocketFanOut::TestSendToAll), "TestSendToAll");
+    AddTest(MakeFunctor(*this, &SuiteOhmSocketFanOut::TestSendToNone), "TestSendToNone");
+    AddTest(MakeFunctor(*this, &SuiteOhmSocketFanOut::TestReadSender), "TestReadSender");
+}
+
+void SuiteOhmSocketFanOut::Setup()
+{
+    iSocket = new OhmSocket(iEnv);
+    iSocket->OpenUnicast(iInterface, kTtl);
+    for (TUint i = 0; i < kSlaveCount; i++) {
+        iSlaves[i] = new SocketUdp(iEnv, 0, iInterface);
+        iEndpoints[i].Replace(Endpoint(iSlaves[i]->Port(), iInterface));
+    }
+}
+
+void SuiteOhmSocketFanOut::TearDown()
+{
+    for (TUint i = 0; i < kSlaveCount; i++) {
+        delete iSlaves[i];
+    }
+    delete iSocket;
+}
+
+void SuiteOhmSocketFanOut::TestSendToAll()
+{
+    iTx.SetBytes(0);
+    for (TUint i = 0; i < 1000; i++) {
+        iTx.Append((TByte)i);
+    }
+    TEST(iSocket->Send(iTx, iEndpoints, kSlaveCount) == 0);
+    const Endpoint sender = iSocket->This();
+    for (TUint i = 0; i < kSlaveCount; i++) {
+        Endpoint ep = iSlaves[i]->Receive(iRx);
+        TEST(iRx == iTx);
+        TEST(ep.Port() == sender.Port());
+    }
+}
+
+void SuiteOhmSocketFanOut::TestSendToNone()
+{
+    iTx.Replace(Brn("SuiteOhmSocketFanOut"));
+    TEST(iSocket->Send(iTx, iEndpoints, 0) == 0);
+    // a subsequent send to the first slave only should be the first datagram it sees
+    Brn second("second");
+    TEST(iSocket->Send(second, iEndpoints, 1) == 0);
+    (void)iSlaves[0]->Receive(iRx);
+    TEST(iRx == second);
+}
+
+void SuiteOhmSocketFanOut::TestReadSender()
+{
+    // datagrams from different slaves, read in one batch, each report their own sender
+    Brn msgs[] = { Brn("zero"), Brn("one"), Brn("two") };
+    const Endpoint receiver = iSocket->This();
+    for (TUint i = 0; i < 3; i++) {
+        iSlaves[i]->Send(msgs[i], receiver);
+    }
+    Thread::Sleep(50); // let all datagrams arrive so that they're read together
+    for (TUint i = 0; i < 3; i++) {
+        iSocket->Read(iRx);
+        TEST(iRx == msgs[i]);
+        TEST(iSocket->Sender().Port() == iEndpoints[i].Port());
+    }
+}
+
+
+// SuiteSocketUdpBatch
+
+SuiteSocketUdpBatch::SuiteSocketUdpBatch(Environment& aEnv, TIpAddress aInterface)
+    : SuiteUnitTest("SuiteSocketUdpBatch")
+    , iEnv(aEnv)
+    , iInterface(aInterface)
+{
+    AddTest(MakeFunctor(*this, &SuiteSocketUdpBatch::TestReceiveBatched), "TestReceiveBatched");
+    AddTest(MakeFunctor(*this, &SuiteSocketUdpBatch::TestReceiveTruncates), "TestReceiveTruncates");
+    AddTest(MakeFunctor(*this, &SuiteSocketUdpBatch::TestInterrupt), "TestInterrupt");
+    AddTest(MakeFunctor(*this, &SuiteSocketUdpBatch::TestSendCalls), "TestSendCalls");
+}
+
+void SuiteSocketUdpBatch::Setup()
+{
+    iSocket = new SocketUdpBatch(iEnv, kMaxDatagramBytes, 0, iInterface);
+    iPeer = new SocketUdp(iEnv, 0, iInterface);
+}
+
+void SuiteSocketUdpBatch::TearDown()
+{
+    delete iPeer;
+    delete iSocket;
+}
+
+void SuiteSocketUdpBatch::TestReceiveBatched()
+{
+    const TUint kCount = SocketUdpBatch::kMaxBatch + 3;
+    const Endpoint ep(iSocket->Port(), iInterface);
+    for (TUint i = 0; i < kCount; i++) {
+        Bws<Ascii::kMaxUintStringBytes> msg;
+        Ascii::AppendDec(msg, i);
+        iPeer->Send(msg, ep);
+    }
+    Thread::Sleep(50);
+    for (TUint i = 0; i < kCount; i++) {
+        const Endpoint sender = iSocket->Receive(iBuf);
+        TEST(Ascii::Uint(iBuf) == i);
+        TEST(sender.Port() == iPeer->Port());
+    }
+    if (iSocket->Batched()) {
+        // one read for each full batch plus one for the remainder
+        TEST(iSocket->ReceiveCalls() == 2);
+    }
+    else {
+        TEST(iSocket->ReceiveCalls() == kCount);
+    }
+}
+
+void SuiteSocketUdpBatch::TestReceiveTruncates()
+{
+    Bwh big(kMaxDatagramBytes);
+    big.SetBytes(kMaxDatagramBytes);
+    big.Fill('x');
+    iPeer->Send(big, Endpoint(iSocket->Port(), iInterface));
+    Bws<16> small;
+    (void)iSocket->Receive(small);
+    TEST(small.Bytes() == small.MaxBytes());
+    TEST(small[0] == 'x');
+}
+
+void SuiteSocketUdpBatch::TestInterrupt()
+{
+    iSocket->Interrupt(true);
+    TEST_THROWS(iSocket->Receive(iBuf), NetworkError);
+    iSocket->Interrupt(false);
+    Brn msg("after interrupt");
+    iPeer->Send(msg, Endpoint(iSocket->Port(), iInterface));
+    (void)iSocket->Receive(iBuf);
+    TEST(iBuf == msg);
+}
+
+void SuiteSocketUdpBatch::TestSendCalls()
+{
+    static const TUint kCount = 8;
+    SocketUdp* peers[kCount];
+    Endpoint endpoints[kCount];
+    for (TUint i = 0; i < kCount; i++) {
+        peers[i] = new SocketUdp(iEnv, 0, iInterface);
+        endpoints[i].Replace(Endpoint(peers[i]->Port(), iInterface));
+    }
+    Brn msg("SuiteSocketUdpBatch");
+    TEST(iSocket->Send(msg, endpoints, kCount) == 0);
+    TEST(iSocket->SendCalls() == (iSocket->Batched()? 1 : kCount));
+    for (TUint i = 0; i < kCount; i++) {
+        const Endpoint sender = peers[i]->Receive(iBuf);
+        TEST(iBuf == msg);
+        TEST(sender.Port() == iSocket->Port());
+        delete peers[i];
+    }
+}
+
+
+// SuiteOhmSocketRelayRate
+
+SuiteOhmSocketRelayRate::SuiteOhmSocketRelayRate(Environment& aEnv, TIpAddress aInterface)
+    : SuiteUnitTest("SuiteOhmSocketRelayRate")
+    , iEnv(aEnv)
+    , iInterface(aInterface)
+{
+    AddTest(MakeFunctor(*this, &SuiteOhmSocketRelayRate::TestPerDatagram), "TestPerDatagram");
+    AddTest(MakeFunctor(*this, &SuiteOhmSocketRelayRate::TestBatched), "TestBatched");
+}
+
+void SuiteOhmSocketRelayRate::Setup()
+{
+    for (TUint i = 0; i < kSlaveCount; i++) {
+        iSlaves[i] = new SocketUdp(iEnv, 0, iInterface);
+        iEndpoints[i].Replace(Endpoint(iSlaves[i]->Port(), iInterface));
+    }
+    iTx.SetBytes(0);
+    for (TUint i = 0; i < kMsgBytes; i++) {
+        iTx.Append((TByte)(i * 7));
+    }
+}
+
+void SuiteOhmSocketRelayRate::TearDown()
+{
+    for (TUint i = 0; i < kSlaveCount; i++) {
+        delete iSlaves[i];
+    }
+}
+
+/* Cost of relaying a 192kHz/24-bit stereo stream to the maximum number of slaves.
+   Slaves don't read so some datagrams may be dropped by the receiving side; this
+   doesn't affect the cost to the sender. */
+
+void SuiteOhmSocketRelayRate::TestPerDatagram()
+{
+    // the path used before batching: one ohNet send per slave per msg
+    SocketUdp socket(iEnv, 0, iInterface);
+    const TUint msgs = kSeconds * kMsgsPerSecond;
+    TUint failures = 0;
+    const TUint64 start = Os::TimeInUs(iEnv.OsCtx());
+    for (TUint i = 0; i < msgs; i++) {
+        for (TUint j = 0; j < kSlaveCount; j++) {
+            try {
+                socket.Send(iTx, iEndpoints[j]);
+            }
+            catch (NetworkError&) {
+                failures++;
+            }
+        }
+    }
+    const TUint64 sendUs = Os::TimeInUs(iEnv.OsCtx()) - start;
+    Report("per datagram", sendUs, (TUint64)msgs * kSlaveCount);
+    TEST(failures == 0);
+}
+
+void SuiteOhmSocketRelayRate::TestBatched()
+{
+    SocketUdpBatch socket(iEnv, kMsgBytes, 0, iInterface);
+    const TUint msgs = kSeconds * kMsgsPerSecond;
+    TUint failures = 0;
+    const TUint64 start = Os::TimeInUs(iEnv.OsCtx());
+    for (TUint i = 0; i < msgs; i++) {
+        if (socket.Send(iTx, iEndpoints, kSlaveCount) != 0) {
+            failures++;
+        }
+    }
+    const TUint64 sendUs = Os::TimeInUs(iEnv.OsCtx()) - start;
+    Report(socket.Batched()? "batched" : "batched (unsupported, per datagram)", sendUs, socket.SendCalls());
+    TEST(socket.SendCalls() == (socket.Batched()? msgs : msgs * kSlaveCount));
+    TEST(failures == 0);
+}
+
+void SuiteOhmSocketRelayRate::Report(const TChar* aName, TUint64 aSendUs, TUint64 aSyscalls)
+{
+    const TUint msgs = kSeconds * kMsgsPerSecond;
+    const TUint syscallsPerSecond = (TUint)(aSyscalls / kSeconds);
+    const TUint usPerMsg = (TUint)(aSendUs / msgs);
+    // cpu load, in hundredths of a percent of one core, of relaying in real time
+    const TUint load = (TUint)(aSendUs * 10000 / (kSeconds * 1000000));
+    Print("    192/24 to %u slaves, %s: %u datagrams of %u bytes, %u send syscalls/s, %uus/msg (%u.%02u%% cpu)\n",
+          kSlaveCount, aName, msgs * kSlaveCount, kMsgBytes, syscallsPerSecond, usPerMsg, load / 100, load % 100);
+}
+
+
+
+void TestOhmSocket(Environment& aEnv)
+{
+    AutoNetworkAdapterRef ref(aEnv, "TestOhmSocket");
+    NetworkAdapter* current = ref.Adapter();
+    if (current == nullptr) {
+        std::vector<NetworkAdapter*>* subnetList = aEnv.NetworkAdapterList().CreateSubnetList();
+        if (subnetList->size() > 0) {
+            current = (*subnetList)[0];
+        }
+        NetworkAdapterList::DestroySubnetList(subnetList);
+    }
+    ASSERT(current != nullptr);
+
+    Runner runner("Songcast socket tests\n");
+    runner.Add(new SuiteOhmSocketFanOut(aEnv, current->Address()));
+    runner.Add(new SuiteSocketUdpBatch(aEnv, current->Address()));
+    runner.Add(new SuiteOhmSocketRelayRate(aEnv, current->Address()));
+    runner.Run();
+}
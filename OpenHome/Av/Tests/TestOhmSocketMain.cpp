@@ -0,0 +1,12 @@
+#include <OpenHome/Private/TestFramework.h>
+
+using namespace OpenHome;
+
+extern void TestOhmSocket(Environment& aEnv);
+
+void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+{
+    Net::Library* lib = new Net::Library(aInitParams);
+    TestOhmSocket(lib->Env());
+    delete lib;
+}
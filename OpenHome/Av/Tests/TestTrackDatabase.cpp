@@ -4,6 +4,9 @@
 #include <OpenHome/Media/Utils/AllocatorInfoLogger.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Net/Private/Globals.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Ascii.h>
 
 #include <limits.h>
 #include <array>
@@ -17,6 +20,46 @@ using namespace OpenHome::Media;
 namespace OpenHome {
 namespace Av {
 
+class SuiteTrackDatabaseMemory : public Suite
+{
+public:
+    SuiteTrackDatabaseMemory();
+    void Test() override;
+private:
+    void TestPlaylist(TUint aNumTracks);
+};
+
+class SuiteTrackList : public Suite
+{
+    static const TUint kMaxTracks = 300;
+    static const TUint kIterations = 2000;
+public:
+    SuiteTrackList();
+    void Test() override;
+private:
+    void CheckMatches(const TrackList& aList, const std::vector<Track*>& aExpected);
+};
+
+class SuiteTrackDatabaseBenchmark : public Suite, private ITrackDatabaseObserver
+{
+    static const TUint kNumTracks = 10000;
+    static const TUint kAlbumTracks = 300;
+    static const TUint kAlbumRepeats = 20;
+public:
+    SuiteTrackDatabaseBenchmark();
+    void Test() override;
+private:
+    void TestAlbum(ITrackDatabase& aDb);
+private: // from ITrackDatabaseObserver
+    void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
+    void NotifyAllDeleted() override;
+private:
+    TUint iNotifications;
+};
+
 class SuiteTrackDatabase : public SuiteUnitTest, private ITrackDatabaseObserver
 {
     static const TUint kMaxTracks = 100;
@@ -27,7 +70,9 @@ private: // from SuiteUnitTest
     void TearDown() override;
 private: // from ITrackDatabaseObserver
     void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
     void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
     void NotifyAllDeleted() override;
 private:
     void InsertInitialTrack();
@@ -42,6 +87,10 @@ private:
     void DeleteValidId();
     void DeleteInvalidId();
     void DeleteAll();
+    void InsertList();
+    void InsertListFailsWhenFull();
+    void DeleteList();
+    void DeleteListInvalidId();
     void SeqUpdatesOnChanges();
     void GetTrackByValidId();
     void GetTrackByInvalidIdFails();
@@ -63,6 +112,10 @@ private:
     TUint iIdLastDeletedBefore;
     TUint iIdLastDeletedAfter;
     TUint iAllDeletedCount;
+    TUint iInsertedListCount;
+    std::vector<TUint> iIdsLastInsertedList;
+    TUint iDeletedListCount;
+    std::vector<TUint> iIdsLastDeletedList;
 };
 
 class SuiteTrackReader : public SuiteUnitTest, private ITrackDatabaseObserver
@@ -75,7 +128,9 @@ private: // from SuiteUnitTest
     void TearDown() override;
 private: // from ITrackDatabaseObserver
     void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
     void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
     void NotifyAllDeleted() override;
 private:
     void TrackRefValidId();
@@ -109,7 +164,9 @@ private: // from SuiteUnitTest
     void TearDown() override;
 private: // from ITrackDatabaseObserver
     void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
     void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
     void NotifyAllDeleted() override;
 private:
     void TrackRefShuffleOff();
@@ -124,6 +181,8 @@ private:
     void TrackRefByIndexSortedShuffleOn();
     void ModeToggleReshuffles();
     void NextTrackBeyondEndReshuffles();
+    void InsertDeleteListShuffleOff();
+    void InsertDeleteListShuffleOn();
 private:
     static const TUint kNumTracks = 16; // gives us ~1 in 21 trillion chance of shuffling tracks into their original order
     Media::AllocatorInfoLogger iInfoAggregator;
@@ -132,6 +191,9 @@ private:
     Shuffler* iShuffler;
     ITrackDatabaseReader* iReader;
     std::array<TUint, kNumTracks> iIds;
+    TUint iInsertedCount;
+    TUint iInsertedListCount;
+    TUint iDeletedListCount;
 };
 
 class SuiteRepeater : public SuiteUnitTest, private ITrackDatabaseObserver
@@ -144,7 +206,9 @@ private: // from SuiteUnitTest
     void TearDown() override;
 private: // from ITrackDatabaseObserver
     void NotifyTrackInserted(Media::Track& aTrack, TUint aIdBefore, TUint aIdAfter) override;
+    void NotifyTracksInserted(const std::vector<Media::Track*>& aTracks, TUint aIdBefore, TUint aIdAfter) override;
     void NotifyTrackDeleted(TUint aId, Media::Track* aBefore, Media::Track* aAfter) override;
+    void NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted) override;
     void NotifyAllDeleted() override;
 private:
     void TrackRefRepeatOff();
@@ -188,6 +252,10 @@ SuiteTrackDatabase::SuiteTrackDatabase()
     AddTest(MakeFunctor(*this, &SuiteTrackDatabase::DeleteValidId), "DeleteValidId");
     AddTest(MakeFunctor(*this, &SuiteTrackDatabase::DeleteInvalidId), "DeleteInvalidId");
     AddTest(MakeFunctor(*this, &SuiteTrackDatabase::DeleteAll), "DeleteAll");
+    AddTest(MakeFunctor(*this, &SuiteTrackDatabase::InsertList), "InsertList");
+    AddTest(MakeFunctor(*this, &SuiteTrackDatabase::InsertListFailsWhenFull), "InsertListFailsWhenFull");
+    AddTest(MakeFunctor(*this, &SuiteTrackDatabase::DeleteList), "DeleteList");
+    AddTest(MakeFunctor(*this, &SuiteTrackDatabase::DeleteListInvalidId), "DeleteListInvalidId");
     AddTest(MakeFunctor(*this, &SuiteTrackDatabase::SeqUpdatesOnChanges), "SeqUpdatesOnChanges");
     AddTest(MakeFunctor(*this, &SuiteTrackDatabase::GetTrackByValidId), "GetTrackByValidId");
     AddTest(MakeFunctor(*this, &SuiteTrackDatabase::GetTrackByInvalidIdFails), "GetTrackByInvalidIdFails");
@@ -203,7 +271,9 @@ void SuiteTrackDatabase::Setup()
     iDb = new TrackDatabase(*iTrackFactory, kMaxTracks);
     iTrackDatabase = static_cast<ITrackDatabase*>(iDb);
     iTrackDatabase->AddObserver(*this);
-    iInsertedCount = iDeletedCount = iAllDeletedCount = 0;
+    iInsertedCount = iDeletedCount = iAllDeletedCount = iInsertedListCount = iDeletedListCount = 0;
+    iIdsLastInsertedList.clear();
+    iIdsLastDeletedList.clear();
     iIdLastInserted = iIdLastInsertedBefore = iIdLastInsertedAfter = 
         iIdLastDeleted = iIdLastDeletedBefore = iIdLastDeletedAfter = UINT_MAX;
 }
@@ -222,6 +292,17 @@ void SuiteTrackDatabase::NotifyTrackInserted(Track& aTrack, TUint aIdBefore, TUi
     iIdLastInsertedAfter = aIdAfter;
 }
 
+void SuiteTrackDatabase::NotifyTracksInserted(const std::vector<Track*>& aTracks, TUint aIdBefore, TUint aIdAfter)
+{
+    iInsertedListCount++;
+    iIdsLastInsertedList.clear();
+    for (auto track : aTracks) {
+        iIdsLastInsertedList.push_back(track->Id());
+    }
+    iIdLastInsertedBefore = aIdBefore;
+    iIdLastInsertedAfter = aIdAfter;
+}
+
 void SuiteTrackDatabase::NotifyTrackDeleted(TUint aId, Track* aBefore, Track* aAfter)
 {
     iDeletedCount++;
@@ -230,6 +311,18 @@ void SuiteTrackDatabase::NotifyTrackDeleted(TUint aId, Track* aBefore, Track* aA
     iIdLastDeletedAfter = (aAfter==nullptr? ITrackDatabase::kTrackIdNone : aAfter->Id());
 }
 
+void SuiteTrackDatabase::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& aDeleted)
+{
+    iDeletedListCount++;
+    iIdsLastDeletedList.clear();
+    for (auto& d : aDeleted) {
+        iIdsLastDeletedList.push_back(d.iId);
+    }
+    const TrackDbDeletion& last = aDeleted[aDeleted.size()-1];
+    iIdLastDeletedBefore = (last.iBefore==nullptr? ITrackDatabase::kTrackIdNone : last.iBefore->Id());
+    iIdLastDeletedAfter = (last.iAfter==nullptr? ITrackDatabase::kTrackIdNone : last.iAfter->Id());
+}
+
 void SuiteTrackDatabase::NotifyAllDeleted()
 {
     iAllDeletedCount++;
@@ -413,6 +506,114 @@ void SuiteTrackDatabase::DeleteAll()
     TEST(count == 0);
 }
 
+void SuiteTrackDatabase::InsertList()
+{
+    TUint ids[2];
+    iTrackDatabase->Insert(ITrackDatabase::kTrackIdNone, Brx::Empty(), Brx::Empty(), ids[0]);
+    iTrackDatabase->Insert(ids[0], Brx::Empty(), Brx::Empty(), ids[1]);
+    TUint seqBefore;
+    iTrackDatabase->GetIdArray(iIdArray, seqBefore);
+
+    std::vector<TrackDbEntry> tracks;
+    tracks.push_back({ Brn("http://host/1"), Brn("meta1") });
+    tracks.push_back({ Brn("http://host/2"), Brn("meta2") });
+    tracks.push_back({ Brn("http://host/3"), Brn("meta3") });
+    std::vector<TUint> newIds;
+    iTrackDatabase->InsertList(ids[0], tracks, newIds);
+    TEST(newIds.size() == tracks.size());
+    TEST(iInsertedCount == 2);
+    TEST(iInsertedListCount == 1);
+    TEST(iIdsLastInsertedList == newIds);
+    TEST(iIdLastInsertedBefore == ids[0]);
+    TEST(iIdLastInsertedAfter == ids[1]);
+
+    TUint seq;
+    iTrackDatabase->GetIdArray(iIdArray, seq);
+    TEST(seq == seqBefore + 1);
+    TEST(iIdArray[0] == ids[0]);
+    for (TUint i=0; i<newIds.size(); i++) {
+        TEST(iIdArray[i+1] == newIds[i]);
+        Track* track;
+        iTrackDatabase->GetTrackById(newIds[i], track);
+        TEST(track->Uri() == tracks[i].iUri);
+        TEST(track->MetaData() == tracks[i].iMetaData);
+        track->RemoveRef();
+    }
+    TEST(iIdArray[4] == ids[1]);
+
+    // empty list is a no-op
+    iTrackDatabase->InsertList(ITrackDatabase::kTrackIdNone, std::vector<TrackDbEntry>(), newIds);
+    TEST(newIds.size() == 0);
+    TEST(iInsertedListCount == 1);
+
+    TEST_THROWS(iTrackDatabase->InsertList(UINT_MAX, tracks, newIds), TrackDbIdNotFound);
+    TEST(iInsertedListCount == 1);
+}
+
+void SuiteTrackDatabase::InsertListFailsWhenFull()
+{
+    std::vector<TrackDbEntry> tracks(kMaxTracks - 1, { Brx::Empty(), Brx::Empty() });
+    std::vector<TUint> newIds;
+    iTrackDatabase->InsertList(ITrackDatabase::kTrackIdNone, tracks, newIds);
+    TEST(iTrackDatabase->TrackCount() == kMaxTracks - 1);
+    tracks.resize(2);
+    TEST_THROWS(iTrackDatabase->InsertList(ITrackDatabase::kTrackIdNone, tracks, newIds), TrackDbFull);
+    TEST(iTrackDatabase->TrackCount() == kMaxTracks - 1);
+    TEST(iInsertedListCount == 1);
+    tracks.resize(1);
+    iTrackDatabase->InsertList(ITrackDatabase::kTrackIdNone, tracks, newIds);
+    TEST(iTrackDatabase->TrackCount() == kMaxTracks);
+}
+
+void SuiteTrackDatabase::DeleteList()
+{
+    std::vector<TrackDbEntry> tracks(5, { Brx::Empty(), Brx::Empty() });
+    std::vector<TUint> ids;
+    iTrackDatabase->InsertList(ITrackDatabase::kTrackIdNone, tracks, ids);
+    TUint seqBefore;
+    iTrackDatabase->GetIdArray(iIdArray, seqBefore);
+
+    std::vector<TUint> toDelete;
+    toDelete.push_back(ids[3]);
+    toDelete.push_back(ids[1]);
+    toDelete.push_back(ids[2]);
+    iTrackDatabase->DeleteList(toDelete);
+    TEST(iDeletedCount == 0);
+    TEST(iDeletedListCount == 1);
+    TEST(iIdsLastDeletedList == toDelete);
+    // ids[2] was removed last, after its neighbours ids[1] and ids[3] had gone
+    TEST(iIdLastDeletedBefore == ids[0]);
+    TEST(iIdLastDeletedAfter == ids[4]);
+
+    TUint seq;
+    iTrackDatabase->GetIdArray(iIdArray, seq);
+    TEST(seq == seqBefore + 1);
+    TEST(iIdArray[0] == ids[0]);
+    TEST(iIdArray[1] == ids[4]);
+    TEST(iIdArray[2] == ITrackDatabase::kTrackIdNone);
+
+    toDelete.clear();
+    toDelete.push_back(ids[0]);
+    toDelete.push_back(ids[4]);
+    iTrackDatabase->DeleteList(toDelete);
+    TEST(iDeletedListCount == 2);
+    TEST(iIdLastDeletedBefore == ITrackDatabase::kTrackIdNone);
+    TEST(iIdLastDeletedAfter == ITrackDatabase::kTrackIdNone);
+    TEST(iTrackDatabase->TrackCount() == 0);
+}
+
+void SuiteTrackDatabase::DeleteListInvalidId()
+{
+    std::vector<TrackDbEntry> tracks(3, { Brx::Empty(), Brx::Empty() });
+    std::vector<TUint> ids;
+    iTrackDatabase->InsertList(ITrackDatabase::kTrackIdNone, tracks, ids);
+    std::vector<TUint> toDelete(ids);
+    toDelete.push_back(UINT_MAX);
+    TEST_THROWS(iTrackDatabase->DeleteList(toDelete), TrackDbIdNotFound);
+    TEST(iDeletedListCount == 0);
+    TEST(iTrackDatabase->TrackCount() == ids.size());
+}
+
 void SuiteTrackDatabase::SeqUpdatesOnChanges()
 {
     TUint seq;
@@ -597,10 +798,18 @@ void SuiteTrackReader::NotifyTrackInserted(Track& /*aTrack*/, TUint /*aIdBefore*
 {
 }
 
+void SuiteTrackReader::NotifyTracksInserted(const std::vector<Track*>& /*aTracks*/, TUint /*aIdBefore*/, TUint /*aIdAfter*/)
+{
+}
+
 void SuiteTrackReader::NotifyTrackDeleted(TUint /*aId*/, Track* /*aBefore*/, Track* /*aAfter*/)
 {
 }
 
+void SuiteTrackReader::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& /*aDeleted*/)
+{
+}
+
 void SuiteTrackReader::NotifyAllDeleted()
 {
 }
@@ -723,6 +932,8 @@ SuiteShuffler::SuiteShuffler()
     AddTest(MakeFunctor(*this, &SuiteShuffler::TrackRefByIndexSortedShuffleOn), "TrackRefByIndexSortedShuffleOn");
     AddTest(MakeFunctor(*this, &SuiteShuffler::ModeToggleReshuffles), "ModeToggleReshuffles");
     AddTest(MakeFunctor(*this, &SuiteShuffler::NextTrackBeyondEndReshuffles), "NextTrackBeyondEndReshuffles");
+    AddTest(MakeFunctor(*this, &SuiteShuffler::InsertDeleteListShuffleOff), "InsertDeleteListShuffleOff");
+    AddTest(MakeFunctor(*this, &SuiteShuffler::InsertDeleteListShuffleOn), "InsertDeleteListShuffleOn");
 }
 
 void SuiteShuffler::Setup()
@@ -739,6 +950,7 @@ void SuiteShuffler::Setup()
         writer->Insert(insertAfter, Brx::Empty(), Brx::Empty(), iIds[i]);
         insertAfter = iIds[i];
     }
+    iInsertedCount = iInsertedListCount = iDeletedListCount = 0;
 }
 
 void SuiteShuffler::TearDown()
@@ -750,12 +962,23 @@ void SuiteShuffler::TearDown()
 
 void SuiteShuffler::NotifyTrackInserted(Track& /*aTrack*/, TUint /*aIdBefore*/, TUint /*aIdAfter*/)
 {
+    iInsertedCount++;
+}
+
+void SuiteShuffler::NotifyTracksInserted(const std::vector<Track*>& /*aTracks*/, TUint /*aIdBefore*/, TUint /*aIdAfter*/)
+{
+    iInsertedListCount++;
 }
 
 void SuiteShuffler::NotifyTrackDeleted(TUint /*aId*/, Track* /*aBefore*/, Track* /*aAfter*/)
 {
 }
 
+void SuiteShuffler::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& /*aDeleted*/)
+{
+    iDeletedListCount++;
+}
+
 void SuiteShuffler::NotifyAllDeleted()
 {
 }
@@ -847,7 +1070,7 @@ void SuiteShuffler::PrevTrackRefShuffleOn()
     iShuffler->SetShuffle(true);
 
     // find id of last shuffled track
-    TUint id = iShuffler->iShuffleList[iShuffler->iShuffleList.size()-1]->Id();
+    TUint id = iShuffler->iShuffleList.At(iShuffler->iShuffleList.Count()-1)->Id();
 
     TBool shuffled = false;
     for (TInt i=kNumTracks-1; i>=0; i--) {
@@ -931,7 +1154,7 @@ void SuiteShuffler::TrackRefByIndexSortedShuffleOn()
     for (TUint i=0; i<kNumTracks; i++) {
         track = iReader->TrackRefByIndexSorted(i);
         TEST(track != nullptr);
-        TEST(track->Id() == iShuffler->iShuffleList[i]->Id());
+        TEST(track->Id() == iShuffler->iShuffleList.At(i)->Id());
         track->RemoveRef();
     }
     track = iReader->TrackRefByIndexSorted(kNumTracks+1);
@@ -991,6 +1214,46 @@ void SuiteShuffler::NextTrackBeyondEndReshuffles()
     TEST(reshuffled);
 }
 
+void SuiteShuffler::InsertDeleteListShuffleOff()
+{
+    ITrackDatabase* writer = static_cast<ITrackDatabase*>(iDb);
+    std::vector<TrackDbEntry> tracks(8, { Brx::Empty(), Brx::Empty() });
+    std::vector<TUint> ids;
+    writer->InsertList(iIds[3], tracks, ids);
+    TEST(iInsertedListCount == 1);
+    TEST(iInsertedCount == 0);
+    for (TUint i=0; i<ids.size(); i++) {
+        Track* track = iReader->TrackRefByIndexSorted(i + 4);
+        TEST(track->Id() == ids[i]);
+        track->RemoveRef();
+    }
+    writer->DeleteList(ids);
+    TEST(iDeletedListCount == 1);
+    TEST(iShuffler->iShuffleList.Count() == kNumTracks);
+}
+
+void SuiteShuffler::InsertDeleteListShuffleOn()
+{
+    iShuffler->SetShuffle(true);
+    ITrackDatabase* writer = static_cast<ITrackDatabase*>(iDb);
+    std::vector<TrackDbEntry> tracks(8, { Brx::Empty(), Brx::Empty() });
+    std::vector<TUint> ids;
+    writer->InsertList(iIds[3], tracks, ids);
+    // shuffled tracks aren't contiguous so are reported individually
+    TEST(iInsertedListCount == 0);
+    TEST(iInsertedCount == ids.size());
+    TEST(iShuffler->iShuffleList.Count() == kNumTracks + ids.size());
+    for (auto id : ids) {
+        TEST(iShuffler->iShuffleList.TrackFromId(id) != nullptr);
+    }
+    writer->DeleteList(ids);
+    TEST(iDeletedListCount == 1);
+    TEST(iShuffler->iShuffleList.Count() == kNumTracks);
+    for (auto id : ids) {
+        TEST(iShuffler->iShuffleList.TrackFromId(id) == nullptr);
+    }
+}
+
 
 // SuiteRepeater
 
@@ -1038,10 +1301,18 @@ void SuiteRepeater::NotifyTrackInserted(Track& /*aTrack*/, TUint /*aIdBefore*/,
 {
 }
 
+void SuiteRepeater::NotifyTracksInserted(const std::vector<Track*>& /*aTracks*/, TUint /*aIdBefore*/, TUint /*aIdAfter*/)
+{
+}
+
 void SuiteRepeater::NotifyTrackDeleted(TUint /*aId*/, Track* /*aBefore*/, Track* /*aAfter*/)
 {
 }
 
+void SuiteRepeater::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& /*aDeleted*/)
+{
+}
+
 void SuiteRepeater::NotifyAllDeleted()
 {
 }
@@ -1131,6 +1402,262 @@ void SuiteRepeater::TrackRefByIndexSortedRepeatOn()
 
 
 
+// SuiteTrackDatabaseMemory
+
+SuiteTrackDatabaseMemory::SuiteTrackDatabaseMemory()
+    : Suite("TrackDatabase memory use")
+{
+}
+
+void SuiteTrackDatabaseMemory::Test()
+{
+    TestPlaylist(1000);
+    TestPlaylist(10000);
+}
+
+void SuiteTrackDatabaseMemory::TestPlaylist(TUint aNumTracks)
+{
+    // typical DIDL-Lite for a track from a media server
+    static const TChar* kMetaData =
+        "<DIDL-Lite xmlns:dc=\"http://purl.org/dc/elements/1.1/\" xmlns:upnp=\"urn:schemas-upnp-org:metadata-1-0/upnp/\" "
+        "xmlns=\"urn:schemas-upnp-org:metadata-1-0/DIDL-Lite/\"><item id=\"1234\" parentID=\"56\" restricted=\"1\">"
+        "<dc:title>Track Title</dc:title><upnp:artist>Artist Name</upnp:artist><upnp:album>Album Title</upnp:album>"
+        "<upnp:albumArtURI>http://192.168.1.10:9000/art/1234.jpg</upnp:albumArtURI><upnp:class>object.item.audioItem.musicTrack</upnp:class>"
+        "<res protocolInfo=\"http-get:*:audio/x-flac:*\" duration=\"0:04:12.000\">http://192.168.1.10:9000/music/1234.flac</res></item></DIDL-Lite>";
+    const Brn metaData(kMetaData);
+    AllocatorInfoLogger infoAggregator;
+    TrackFactory* trackFactory = new TrackFactory(infoAggregator, aNumTracks);
+    TrackDatabase* db = new TrackDatabase(*trackFactory, aNumTracks);
+    ITrackDatabase* trackDb = static_cast<ITrackDatabase*>(db);
+
+    Bws<64> uri;
+    TUint idAfter = ITrackDatabase::kTrackIdNone;
+    for (TUint i=0; i<aNumTracks; i++) {
+        uri.Replace("http://192.168.1.10:9000/music/");
+        Ascii::AppendDec(uri, i);
+        uri.Append(".flac");
+        trackDb->Insert(idAfter, uri, metaData, idAfter);
+    }
+    TEST(trackDb->TrackCount() == aNumTracks);
+
+    // tracks read back exactly as they were inserted
+    Track* track;
+    trackDb->GetTrackById(idAfter, track);
+    uri.Replace("http://192.168.1.10:9000/music/");
+    Ascii::AppendDec(uri, aNumTracks - 1);
+    uri.Append(".flac");
+    TEST(track->Uri() == uri);
+    TEST(track->MetaData() == metaData);
+    track->RemoveRef();
+
+    const TUint inlineBytes = aNumTracks * (kTrackUriMaxBytes + kTrackMetaDataMaxBytes);
+    Log::Print("  %5u tracks: uri+metadata use %u KB (inline storage would use %u KB)\n",
+               aNumTracks, trackFactory->StorageBytesResident() / 1024, inlineBytes / 1024);
+    TEST(trackFactory->StorageBytesResident() < inlineBytes / 4);
+
+    delete db;
+    delete trackFactory;
+}
+
+
+// SuiteTrackList
+
+SuiteTrackList::SuiteTrackList()
+    : Suite("TrackList random insert/remove")
+{
+}
+
+void SuiteTrackList::Test()
+{
+    // apply a random sequence of operations to both a TrackList and a vector, checking they always agree
+    AllocatorInfoLogger infoAggregator;
+    TrackFactory* trackFactory = new TrackFactory(infoAggregator, 2 * kMaxTracks);
+    TrackList* list = new TrackList(kMaxTracks);
+    std::vector<Track*> expected;
+    for (TUint i=0; i<kIterations; i++) {
+        const TUint count = (TUint)expected.size();
+        const TBool insert = (count == 0 || (count < kMaxTracks && gEnv->Random(3) != 0));
+        if (insert) {
+            const TUint index = gEnv->Random(count + 1);
+            Track* track = trackFactory->CreateTrack(Brx::Empty(), Brx::Empty());
+            list->Insert(index, track);
+            expected.insert(expected.begin() + index, track);
+        }
+        else {
+            const TUint index = gEnv->Random(count);
+            Track* track = list->Remove(index);
+            TEST(track == expected[index]);
+            expected.erase(expected.begin() + index);
+            TEST(list->TrackFromId(track->Id()) == nullptr);
+            TEST_THROWS(list->IndexFromId(track->Id()), TrackDbIdNotFound);
+            track->RemoveRef();
+        }
+        if (i % 100 == 0) {
+            CheckMatches(*list, expected);
+        }
+    }
+    CheckMatches(*list, expected);
+
+    // shuffling keeps the same set of tracks and leaves the id index consistent
+    list->Shuffle();
+    TEST(list->Count() == expected.size());
+    for (TUint i=0; i<list->Count(); i++) {
+        Track* track = list->At(i);
+        TEST(std::find(expected.begin(), expected.end(), track) != expected.end());
+        TEST(list->IndexFromId(track->Id()) == i);
+    }
+
+    list->Clear();
+    TEST(list->Count() == 0);
+    delete list;
+    delete trackFactory;
+}
+
+void SuiteTrackList::CheckMatches(const TrackList& aList, const std::vector<Track*>& aExpected)
+{
+    TEST(aList.Count() == aExpected.size());
+    std::vector<TUint32> ids;
+    aList.GetIds(ids);
+    TEST(ids.size() == aExpected.size());
+    for (TUint i=0; i<aExpected.size(); i++) {
+        TEST_QUIETLY(aList.At(i) == aExpected[i]);
+        TEST_QUIETLY(ids[i] == aExpected[i]->Id());
+        TEST_QUIETLY(aList.TrackFromId(aExpected[i]->Id()) == aExpected[i]);
+        TEST_QUIETLY(aList.IndexFromId(aExpected[i]->Id()) == i);
+    }
+}
+
+
+// SuiteTrackDatabaseBenchmark
+
+SuiteTrackDatabaseBenchmark::SuiteTrackDatabaseBenchmark()
+    : Suite("TrackDatabase benchmark")
+    , iNotifications(0)
+{
+}
+
+void SuiteTrackDatabaseBenchmark::Test()
+{
+    AllocatorInfoLogger infoAggregator;
+    TrackFactory* trackFactory = new TrackFactory(infoAggregator, kNumTracks);
+    TrackDatabase* db = new TrackDatabase(*trackFactory, kNumTracks);
+    ITrackDatabase* trackDb = static_cast<ITrackDatabase*>(db);
+    Shuffler* shuffler = new Shuffler(*gEnv, *db, kNumTracks);
+    static_cast<ITrackDatabaseReader*>(shuffler)->SetObserver(*this);
+    ITrackDatabaseReader* reader = static_cast<ITrackDatabaseReader*>(db);
+
+    // append tracks one at a time, as control points adding an album do
+    std::vector<TUint> ids;
+    ids.reserve(kNumTracks);
+    TUint idAfter = ITrackDatabase::kTrackIdNone;
+    TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kNumTracks; i++) {
+        trackDb->Insert(idAfter, Brn("http://host/track"), Brx::Empty(), idAfter);
+        ids.push_back(idAfter);
+    }
+    const TUint64 insertUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+    TEST(trackDb->TrackCount() == kNumTracks);
+
+    // random seeks by id and by index
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kNumTracks; i++) {
+        const TUint index = gEnv->Random(kNumTracks);
+        Track* track;
+        trackDb->GetTrackById(ids[index], track);
+        TEST_QUIETLY(track->Id() == ids[index]);
+        track->RemoveRef();
+        track = reader->TrackRefByIndex(gEnv->Random(kNumTracks));
+        track->RemoveRef();
+        track = reader->NextTrackRef(ids[index]);
+        if (track != nullptr) {
+            track->RemoveRef();
+        }
+    }
+    const TUint64 seekUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+
+    // delete from random positions
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=kNumTracks; i>0; i--) {
+        const TUint index = gEnv->Random(i);
+        trackDb->DeleteId(ids[index]);
+        ids[index] = ids[i-1];
+    }
+    const TUint64 deleteUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+    TEST(trackDb->TrackCount() == 0);
+
+    Log::Print("  %u tracks: insert %llums, random seek %llums, delete %llums\n",
+               kNumTracks, insertUs / 1000, seekUs / 1000, deleteUs / 1000);
+
+    TestAlbum(*trackDb);
+
+    delete shuffler;
+    delete db;
+    delete trackFactory;
+}
+
+void SuiteTrackDatabaseBenchmark::TestAlbum(ITrackDatabase& aDb)
+{
+    // queue then clear an album, one track per call vs a single InsertList/DeleteList
+    std::vector<TrackDbEntry> album(kAlbumTracks, { Brn("http://host/track"), Brn("<DIDL-Lite/>") });
+    std::vector<TUint> ids;
+    ids.reserve(kAlbumTracks);
+
+    iNotifications = 0;
+    TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kAlbumRepeats; i++) {
+        ids.clear();
+        TUint idAfter = ITrackDatabase::kTrackIdNone;
+        for (const auto& entry : album) {
+            aDb.Insert(idAfter, entry.iUri, entry.iMetaData, idAfter);
+            ids.push_back(idAfter);
+        }
+        for (auto id : ids) {
+            aDb.DeleteId(id);
+        }
+    }
+    const TUint64 singleUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+    const TUint singleNotifications = iNotifications;
+
+    iNotifications = 0;
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kAlbumRepeats; i++) {
+        aDb.InsertList(ITrackDatabase::kTrackIdNone, album, ids);
+        TEST_QUIETLY(ids.size() == kAlbumTracks);
+        aDb.DeleteList(ids);
+    }
+    const TUint64 listUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+    TEST(aDb.TrackCount() == 0);
+
+    Log::Print("  %u x %u track album: per track %lluus (%u notifications), list %lluus (%u notifications)\n",
+               kAlbumRepeats, kAlbumTracks, singleUs, singleNotifications, listUs, iNotifications);
+}
+
+void SuiteTrackDatabaseBenchmark::NotifyTrackInserted(Track& /*aTrack*/, TUint /*aIdBefore*/, TUint /*aIdAfter*/)
+{
+    iNotifications++;
+}
+
+void SuiteTrackDatabaseBenchmark::NotifyTracksInserted(const std::vector<Track*>& /*aTracks*/, TUint /*aIdBefore*/, TUint /*aIdAfter*/)
+{
+    iNotifications++;
+}
+
+void SuiteTrackDatabaseBenchmark::NotifyTrackDeleted(TUint /*aId*/, Track* /*aBefore*/, Track* /*aAfter*/)
+{
+    iNotifications++;
+}
+
+void SuiteTrackDatabaseBenchmark::NotifyTracksDeleted(const std::vector<TrackDbDeletion>& /*aDeleted*/)
+{
+    iNotifications++;
+}
+
+void SuiteTrackDatabaseBenchmark::NotifyAllDeleted()
+{
+}
+
+
+
 void TestTrackDatabase()
 {
     Runner runner("Track database tests\n");
@@ -1139,5 +1666,14 @@ void TestTrackDatabase()
     runner.Add(new SuiteTrackReader());
     runner.Add(new SuiteShuffler());
     runner.Add(new SuiteRepeater());
+    runner.Add(new SuiteTrackDatabaseMemory());
+    runner.Add(new SuiteTrackList());
+    runner.Run();
+}
+
+void TestTrackDatabaseBenchmark()
+{
+    Runner runner("Track database benchmark\n");
+    runner.Add(new SuiteTrackDatabaseBenchmark());
     runner.Run();
 }
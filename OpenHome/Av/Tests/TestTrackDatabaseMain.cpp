@@ -1,14 +1,29 @@
 #include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/OptionParser.h>
 
 using namespace OpenHome;
 using namespace OpenHome::TestFramework;
 
 extern void TestTrackDatabase();
+extern void TestTrackDatabaseBenchmark();
 
-void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
 {
+    OptionParser parser;
+    OptionBool optionBenchmark("-b", "--benchmark", "Time inserts, seeks and deletes on a large playlist");
+    parser.AddOption(&optionBenchmark);
+    if (!parser.Parse(aArgc, aArgv)) {
+        delete aInitParams;
+        return;
+    }
+
     Net::UpnpLibrary::InitialiseMinimal(aInitParams);
-    TestTrackDatabase();
+    if (optionBenchmark.Value()) {
+        TestTrackDatabaseBenchmark();
+    }
+    else {
+        TestTrackDatabase();
+    }
     delete aInitParams;
     Net::UpnpLibrary::Close();
 }
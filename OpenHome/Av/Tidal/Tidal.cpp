@@ -317,7 +317,7 @@ TBool Tidal::TryGetStreamUrl(const Brx& aTrackId,
                               iHeaderTransferEncoding,
                               ReaderHttpEntity::Mode::Client);
 
-        JsonParser responseParser;
+        JsonParserTape responseParser;
 
         if (code != 200) 
         {
@@ -386,7 +386,7 @@ TBool Tidal::TryGetStreamUrl(const Brx& aTrackId,
             Bwn manifestW(manifest.Ptr(), manifest.Bytes(), manifest.Bytes());  // We can reuse the underlying buffer provided by iResponseBuffer
             Converter::FromBase64(manifestW);
 
-            JsonParser manifestParser;
+            JsonParserTape manifestParser;
             manifestParser.ParseAndUnescape(manifestW);
 
             LOG_TRACE(kPipeline,
@@ -394,8 +394,12 @@ TBool Tidal::TryGetStreamUrl(const Brx& aTrackId,
                       PBUF(manifestParser.String("mimeType")),
                       PBUF(manifestParser.String("encryptionType")));
 
-            auto urlParser = JsonParserArray::Create(manifestParser.String("urls"));
-            aStreamUrl.Replace(urlParser.NextString());
+            JsonTapeIterator urls = manifestParser.Get("urls").Iterate();
+            JsonTapeValue url;
+            if (!urls.Next(url) || url.IsNull()) {
+                THROW(JsonArrayEnumerationComplete);
+            }
+            aStreamUrl.Replace(url.String());
 
             LOG(kMedia, "Tidal::TryGetStreamUrl aStreamUrl: %.*s\n", PBUF(aStreamUrl));
             success = true;
@@ -849,7 +853,7 @@ TBool Tidal::StartLimitedInputFlow(LimitedInputFlowDetails& aDetails)
         }
         else
         {
-            JsonParser p;
+            JsonParserTape p;
             p.ParseAndUnescape(iResponseBuffer);
 
             aDetails.Set(p.String("verificationUriComplete"),
@@ -996,7 +1000,7 @@ void Tidal::DoPollForToken()
 
             const TUint status = iReaderResponse.Status().Code();
 
-            JsonParser p;
+            JsonParserTape p;
             p.ParseAndUnescape(iResponseBuffer);
 
             // Success - polling complete...
@@ -1117,7 +1121,7 @@ TBool Tidal::DoTryGetAccessToken(const Brx& aTokenId,
         const TUint code = iReaderResponse.Status()
                                           .Code();
 
-        JsonParser parser;
+        JsonParserTape parser;
         parser.ParseAndUnescape(iResponseBuffer);
 
         if (code != 200)
@@ -1149,12 +1153,11 @@ TBool Tidal::DoTryGetAccessToken(const Brx& aTokenId,
 
         // User information is also contained within our response
         // which is needed for future API requests.
-        JsonParser parserUser;
-        parserUser.Parse(parser.String("user"));
+        const JsonTapeValue user = parser.Get("user");
 
-        const TUint userId = parserUser.Num("userId");
-        const Brx& countryCode = parserUser.String("countryCode");
-        const Brx& username = parserUser.String("username");
+        const TUint userId = user.Num("userId");
+        const Brx& countryCode = user.String("countryCode");
+        const Brx& username = user.String("username");
 
         // Store our user info internally for future API calls...
         TBool didPopulate = false;
@@ -1259,7 +1262,7 @@ TBool Tidal::DoInheritToken(const Brx& aAccessTokenIn,
         const TUint code = iReaderResponse.Status()
                                           .Code();
 
-        JsonParser parser;
+        JsonParserTape parser;
         parser.ParseAndUnescape(iResponseBuffer);
 
         if (code != 200)
@@ -1530,21 +1533,20 @@ TBool Tidal::TryGetTrackFavouriteStatus(const Brx& aTrackId, const Brx& aTokenId
             THROW(ReaderError);
         }
         else {
-            JsonParser p;
+            JsonParserTape p;
             p.ParseAndUnescape(iResponseBuffer);
-            if (p.HasKey("TRACK")) {
-                auto jsonParserArray = JsonParserArray::Create(p.String("TRACK"));
-                try {
-                    for (;;) {
-                        Brn trackId = jsonParserArray.NextString();
-                        //Log::Print("Favorite track id = %.*s\n", PBUF(trackId));
-                        if (trackId == aTrackId) {
-                            aIsFavourite = true;
-                            break;
-                        }
+            JsonTapeValue tracks;
+            if (p.TryGet(Brn("TRACK"), tracks)) {
+                JsonTapeIterator it = tracks.Iterate();
+                JsonTapeValue track;
+                while (it.Next(track) && !track.IsNull()) {
+                    Brn trackId = track.String();
+                    //Log::Print("Favorite track id = %.*s\n", PBUF(trackId));
+                    if (trackId == aTrackId) {
+                        aIsFavourite = true;
+                        break;
                     }
                 }
-                catch (JsonArrayEnumerationComplete&) {}
                 success = true;
             }
             else {
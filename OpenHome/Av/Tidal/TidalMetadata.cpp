@@ -43,6 +43,19 @@ TidalMetadata::TidalMetadata(Media::TrackFactory& aTrackFactory)
 
 Media::Track* TidalMetadata::TrackFromJson(const Brx& aMetadata,
                                            const Brx& aTokenId)
+{
+    try {
+        iTape.Parse(aMetadata);
+    }
+    catch (JsonCorrupt&) {
+        LOG_ERROR(kMedia, "TidalMetadata::TrackFromJson failed to parse metadata (JsonCorrupt)\n");
+        return nullptr;
+    }
+    return TrackFromJson(iTape.Root(), aTokenId);
+}
+
+Media::Track* TidalMetadata::TrackFromJson(const JsonTapeValue& aMetadata,
+                                           const Brx& aTokenId)
 {
     try {
         ParseTidalMetadata(aMetadata, aTokenId);
@@ -60,41 +73,39 @@ Media::Track* TidalMetadata::TrackFromJson(const Brx& aMetadata,
     }
 }
 
-void TidalMetadata::ParseTidalMetadata(const Brx& aMetadata,
+void TidalMetadata::ParseTidalMetadata(const JsonTapeValue& aMetadata,
                                        const Brx& aTokenId)
 {
     iTrackUri.Replace(Brx::Empty());
     iMetaDataDidl.Replace(Brx::Empty());
-    JsonParser parser;
-    JsonParser nestedParser;
-    parser.Parse(aMetadata);
+    JsonTapeValue item = aMetadata;
 
-    if (parser.HasKey("item")) {
+    if (item.HasKey("item")) {
         // playlists have an extra layer of indirection (item dictionary) as they can be mixed media (audio and video)
-        parser.Parse(parser.String("item"));
+        item = item.Get("item");
     }
 
-    if (!parser.HasKey("id")) {
+    if (!item.HasKey("id")) {
         // track uri based on id, so will be invalid without one
         THROW(TidalResponseInvalid);
     }
 
-    if (parser.HasKey("allowStreaming")) {
-        if (!parser.Bool("allowStreaming")) {
+    if (item.HasKey("allowStreaming")) {
+        if (!item.Bool("allowStreaming")) {
             THROW(TidalResponseInvalid);
         }
     }
-    if (parser.HasKey("streamReady")) {
-        if (!parser.Bool("streamReady")) {
+    if (item.HasKey("streamReady")) {
+        if (!item.Bool("streamReady")) {
             THROW(TidalResponseInvalid);
         }
     }
-    //if (parser.HasKey("url")) { // streamable tidal url
-    //    iTrackUri.ReplaceThrow(parser.String("url")); 
+    //if (item.HasKey("url")) { // streamable tidal url
+    //    iTrackUri.ReplaceThrow(item.String("url")); 
     //}
 
      // special linn style tidal url (non-streamable, gets converted later)
-    const Brx& itemId = parser.String("id");
+    const Brn itemId = item.String("id");
     iTrackUri.ReplaceThrow(Brn("tidal://track?trackId="));
     iTrackUri.AppendThrow(itemId);
     iTrackUri.AppendThrow(Brn("&version="));
@@ -112,63 +123,64 @@ void TidalMetadata::ParseTidalMetadata(const Brx& aMetadata,
     }
 
     Bwn unescapedBuf;
-    auto unescapeVal = [&] (const Brx& aValue) {
-        unescapedBuf.Set(aValue.Ptr(), aValue.Bytes(), aValue.Bytes());
+    auto unescapeVal = [&] (const JsonTapeValue& aValue) {
+        const Brn val = aValue.String();
+        unescapedBuf.Set(val.Ptr(), val.Bytes(), val.Bytes());
         Json::Unescape(unescapedBuf);
     };
 
     WriterBuffer w(iMetaDataDidl);
     WriterDIDLLite writer(itemId, DIDLLite::kItemTypeTrack, w);
 
-    if (parser.HasKey("title")) {
-        unescapeVal(parser.String("title"));
+    JsonTapeValue val;
+    if (item.TryGet(Brn("title"), val)) {
+        unescapeVal(val);
         writer.WriteTitle(unescapedBuf);
     }
 
-    if (parser.HasKey("trackNumber")) {
-        unescapeVal(parser.String("trackNumber"));
+    if (item.TryGet(Brn("trackNumber"), val)) {
+        unescapeVal(val);
         writer.WriteTrackNumber(unescapedBuf);
     }
 
-    if (parser.HasKey("album")) {
-        nestedParser.Parse(parser.String("album"));
-        if (nestedParser.HasKey("title")) {
-            unescapeVal(nestedParser.String("title"));
+    JsonTapeValue nested;
+    if (item.TryGet(Brn("album"), nested)) {
+        if (nested.TryGet(Brn("title"), val)) {
+            unescapeVal(val);
             writer.WriteAlbum(unescapedBuf);
         }
 
-        if (nestedParser.HasKey("id")) {
-            writer.WriteCustomMetadata("albumId", DIDLLite::kNameSpaceLinn, nestedParser.String("id"));
+        if (nested.HasKey("id")) {
+            writer.WriteCustomMetadata("albumId", DIDLLite::kNameSpaceLinn, nested.String("id"));
         }
 
-        TryWriteArtwork(writer, nestedParser);
+        TryWriteArtwork(writer, nested);
     }
 
-    if (parser.HasKey("artist")) {
-        nestedParser.Parse(parser.String("artist"));
-        if (nestedParser.HasKey("name")) {
-            unescapeVal(nestedParser.String("name"));
+    if (item.TryGet(Brn("artist"), nested)) {
+        if (nested.TryGet(Brn("name"), val)) {
+            unescapeVal(val);
             writer.WriteArtist(unescapedBuf);
         }
 
-        if (nestedParser.HasKey("id")) {
-            writer.WriteCustomMetadata("artistId", DIDLLite::kNameSpaceLinn, nestedParser.String("id"));
+        if (nested.HasKey("id")) {
+            writer.WriteCustomMetadata("artistId", DIDLLite::kNameSpaceLinn, nested.String("id"));
         }
     }
 
     WriterDIDLLite::StreamingDetails details;
     details.durationResolution = EDurationResolution::Seconds;
-    details.duration = parser.HasKey("duration") ? parser.Num("duration")
-                                                 : 0;
+    details.duration = item.HasKey("duration") ? item.Num("duration")
+                                               : 0;
 
     writer.WriteStreamingDetails(DIDLLite::kProtocolHttpGet, details, iTrackUri);
     writer.WriteEnd();
 }
 
-void TidalMetadata::TryWriteArtwork(WriterDIDLLite& aWriter, JsonParser& aParser)
+void TidalMetadata::TryWriteArtwork(WriterDIDLLite& aWriter, const JsonTapeValue& aAlbum)
 {
-    // NOTE: Assumes 'aParser' is already pointing to a valid TIDAL album object
-    if (!aParser.HasKey("cover")) {
+    // NOTE: Assumes 'aAlbum' is a valid TIDAL album object
+    if (!aAlbum.HasKey("cover")) {
         return;
     }
 
@@ -176,7 +188,7 @@ void TidalMetadata::TryWriteArtwork(WriterDIDLLite& aWriter, JsonParser& aParser
     Bwh baseArtworkUri(1024);
     baseArtworkUri.Replace(kImageResourceBaseUrl);
 
-    Parser idParser(aParser.String("cover"));
+    Parser idParser(aAlbum.String("cover"));
     while(!idParser.Finished()) {
         baseArtworkUri.AppendThrow(idParser.Next('-')); // replace '-' with '/' in value
         baseArtworkUri.AppendThrow(Brn("/"));
@@ -2,6 +2,7 @@
 
 #include <OpenHome/Types.h>
 #include <OpenHome/Buffer.h>
+#include <OpenHome/Json.h>
 #include <OpenHome/Av/OhMetadata.h>
 #include <OpenHome/Private/Standard.h>
 #include <OpenHome/Media/Pipeline/Msg.h>
@@ -11,7 +12,6 @@ EXCEPTION(TidalRequestInvalid);
 
 namespace OpenHome {
     class Environment;
-    class JsonParser;
 namespace Av {
 
 class TidalMetadata : private OpenHome::INonCopyable
@@ -62,16 +62,19 @@ public:
     TidalMetadata(OpenHome::Media::TrackFactory& aTrackFactory);
     OpenHome::Media::Track* TrackFromJson(const OpenHome::Brx& aMetadata,
                                           const OpenHome::Brx& aTokenId);
+    OpenHome::Media::Track* TrackFromJson(const OpenHome::JsonTapeValue& aMetadata,
+                                          const OpenHome::Brx& aTokenId); // aMetadata must be an object
     static const Brx& IdTypeToString(EIdType aType);
     static EIdType StringToIdType(const Brx& aString);
 private:
-    void ParseTidalMetadata(const OpenHome::Brx& aMetadata,
+    void ParseTidalMetadata(const OpenHome::JsonTapeValue& aMetadata,
                             const OpenHome::Brx& aTokenId);
 
     void TryWriteArtwork(WriterDIDLLite& aWriter,
-                         JsonParser& aParser);
+                         const OpenHome::JsonTapeValue& aAlbum);
 private:
     OpenHome::Media::TrackFactory& iTrackFactory;
+    OpenHome::JsonTape iTape;
     OpenHome::Media::BwsTrackUri iTrackUri;
     OpenHome::Media::BwsTrackMetaData iMetaDataDidl;
 };
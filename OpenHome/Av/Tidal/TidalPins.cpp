@@ -61,10 +61,10 @@ static const TChar* kPinResponsePlaylists = "playlists";
 // NOTE: Sometimes the TIDAL API just ignores the 'limit' and 'offset' parameters provided in the request and gives us anything
 //       Code below here ensures we correctly process the number of item(s) returned, not just what we expect to have been returned!
 //       Known effected endpoints: mixes/{id}/items - Always returns all mix items (~ 100) for artist & track radios
-static TUint GetRealFetchedItemCount(JsonParser& aParser, TUint expectedItemCount)
+static TUint GetRealFetchedItemCount(const JsonTapeValue& aResponse, TUint expectedItemCount)
 {
-    if (aParser.HasKey("limit")) {
-        TUint actualReturnedNumberOfItems = static_cast<TUint>(aParser.Num("limit"));
+    if (aResponse.HasKey("limit")) {
+        TUint actualReturnedNumberOfItems = static_cast<TUint>(aResponse.Num("limit"));
         if (actualReturnedNumberOfItems > expectedItemCount) {
             Log::Print("TidalPins::GetRealFetchedItemCount - WARNING!! Asked for %u item(s) but TIDAL returned %u item(s). Processing all %u item(s), but this may take a while.\n",
                        expectedItemCount,
@@ -325,7 +325,7 @@ TBool TidalPins::LoadContainers(const Brx& aPath,
     AutoMutex _(iLock);
     const TChar* kIdString = (aIdType == TidalMetadata::ePlaylist) ? "uuid" : "id";
     const TUint kIdSize = (aIdType == TidalMetadata::ePlaylist) ? 40 : 20;
-    JsonParser parser;
+    JsonTape tape;
     InitPlaylist(aPinShuffled);
     TUint lastId = 0;
     TUint tracksFound = 0;
@@ -338,7 +338,7 @@ TBool TidalPins::LoadContainers(const Brx& aPath,
     const TBool shuffleLoadOrder = ShouldShuffleLoadOrder(aPinShuffled, aShuffleMode);
 
     TUint start, end;
-    TUint total = GetTotalItems(parser, aPath, TidalMetadata::eNone, true, shuffleLoadOrder, start, end, aAuthConfig); // aIdType relevant to tracks, not containers
+    TUint total = GetTotalItems(tape, aPath, TidalMetadata::eNone, true, shuffleLoadOrder, start, end, aAuthConfig); // aIdType relevant to tracks, not containers
     TUint offset = start;
 
     do {
@@ -350,31 +350,31 @@ TBool TidalPins::LoadContainers(const Brx& aPath,
             }
 
             // response is list of containers, so need to loop through containers
-            parser.Reset();
-            parser.Parse(iJsonResponse.Buffer());
+            tape.Parse(iJsonResponse.Buffer());
+            const JsonTapeValue response = tape.Root();
 
-            const TUint fetchedItemCount = GetRealFetchedItemCount(parser, kItemLimitPerRequest);
+            const TUint fetchedItemCount = GetRealFetchedItemCount(response, kItemLimitPerRequest);
             UpdateOffset(total, fetchedItemCount, end, true, shuffleLoadOrder, offset);
             
             TUint idCount = 0;
-            auto parserItems = JsonParserArray::Create(parser.String("items"));
-            JsonParser parserItem;
+            JsonTapeIterator items = response.Get("items").Iterate();
+            JsonTapeValue item;
 
             for (TUint i = 0; i < kItemLimitPerRequest; i++) {
-                Brn obj;
-                if (!parserItems.TryNextObject(obj)) {
+                if (!items.Next(item) || item.IsNull()) {
                     break;
                 }
-
-                parserItem.Parse(obj);
+                if (item.Type() != JsonTape::Type::Object) {
+                    THROW(JsonWrongType);
+                }
 
                 // Some TIDAL responses are nested in a wrapper object
                 // featuring a 'created' date/time
-                if (parserItem.HasKey("item")) {
-                    parserItem.Parse(parserItem.String("item"));
+                if (item.HasKey("item")) {
+                    item = item.Get("item");
                 }
 
-                containerIds[i].ReplaceThrow(parserItem.String(kIdString)); // parse response from Tidal
+                containerIds[i].ReplaceThrow(item.String(kIdString)); // parse response from Tidal
                 idCount++;
                 if (containerIds[i].Bytes() == 0) {
                     return false;
@@ -424,13 +424,13 @@ TUint TidalPins::LoadTracksById(const Brx& aId,
     TUint currId = aPlaylistId;
     TBool initPlay = (aPlaylistId == 0);
     TBool isPlayable = false;
-    JsonParser parser;
+    JsonTape tape;
     Media::Track* track = nullptr;
 
     const TBool shuffleLoadOrder = ShouldShuffleLoadOrder(aPinShuffled, aShuffleMode);
 
     TUint start, end;
-    TUint total = GetTotalItems(parser, aId, aIdType, false, shuffleLoadOrder, start, end, aAuthConfig);
+    TUint total = GetTotalItems(tape, aId, aIdType, false, shuffleLoadOrder, start, end, aAuthConfig);
     TUint offset = start;
 
     // id to list of tracks
@@ -450,17 +450,21 @@ TUint TidalPins::LoadTracksById(const Brx& aId,
                 THROW(PinNothingToPlay);
             }
 
-            parser.Reset();
-            parser.Parse(iJsonResponse.Buffer());
+            tape.Parse(iJsonResponse.Buffer());
+            const JsonTapeValue response = tape.Root();
 
-            const TUint fetchedItemCount = GetRealFetchedItemCount(parser, kItemLimitPerRequest);
+            const TUint fetchedItemCount = GetRealFetchedItemCount(response, kItemLimitPerRequest);
             UpdateOffset(total, fetchedItemCount, end, false, shuffleLoadOrder, offset);
 
-            if (parser.HasKey("items")) {
-                auto parserItems = JsonParserArray::Create(parser.String("items"));
-                Brn obj;
-                while(parserItems.TryNextObject(obj)) {
-                    track = iTidalMetadata.TrackFromJson(obj,
+            JsonTapeValue items;
+            if (response.TryGet(Brn("items"), items)) {
+                JsonTapeIterator it = items.Iterate();
+                JsonTapeValue item;
+                while(it.Next(item) && !item.IsNull()) {
+                    if (item.Type() != JsonTape::Type::Object) {
+                        THROW(JsonWrongType);
+                    }
+                    track = iTidalMetadata.TrackFromJson(item,
                                                          aAuthConfig.oauthTokenId);
                     if (track != nullptr) {
                         aCount++;
@@ -478,7 +482,7 @@ TUint TidalPins::LoadTracksById(const Brx& aId,
             }
             else {
                 // special case for only one track (no 'items' object)
-                track = iTidalMetadata.TrackFromJson(iJsonResponse.Buffer(),
+                track = iTidalMetadata.TrackFromJson(response,
                                                      aAuthConfig.oauthTokenId);
                 if (track != nullptr) {
                     aCount++;
@@ -514,7 +518,7 @@ TUint TidalPins::LoadTracksById(const Brx& aId,
     return currId;
 }
 
-TUint TidalPins::GetTotalItems(JsonParser& aParser,
+TUint TidalPins::GetTotalItems(JsonTape& aTape,
                                const Brx& aId,
                                TidalMetadata::EIdType aIdType,
                                TBool aIsContainer,
@@ -541,10 +545,10 @@ TUint TidalPins::GetTotalItems(JsonParser& aParser,
             success = iTidal.TryGetTracksById(iJsonResponse, aId, aIdType, 1, 0, aAuthConfig);
         }
         if (success) {
-            aParser.Reset();
-            aParser.Parse(iJsonResponse.Buffer());
-            if (aParser.HasKey("totalNumberOfItems")) { 
-                total = aParser.Num("totalNumberOfItems");
+            aTape.Parse(iJsonResponse.Buffer());
+            const JsonTapeValue response = aTape.Root();
+            if (response.HasKey("totalNumberOfItems")) { 
+                total = response.Num("totalNumberOfItems");
             }
             else {
                 total = 1; // tidal glitch - total tag is not included if only one item
@@ -757,39 +761,41 @@ EPinMetadataStatus TidalPinRefresher::TryRefreshMixPinMetadata(const IPin& aPin,
      */
 
     try {
-        JsonParser p;
-        Brn firstItem(Brx::Empty());
-
-        p.Parse(jsonResponse.Buffer());
-
-        if (p.HasKey("rows")) {
-            JsonParserArray ap = JsonParserArray::Create(p.String("rows"));
-            firstItem = ap.NextObject();
-            p.Parse(firstItem);
-            if (p.HasKey("modules")) {
-                ap = JsonParserArray::Create(p.String("modules"));
-                firstItem = ap.NextObject();
-                p.Parse(firstItem);
-                if (p.HasKey("pagedList")) {
-                    p.Parse(p.String("pagedList"));
-                    if (p.HasKey("items")) {
-                        Brn obj;
-                        ap = JsonParserArray::Create(p.String("items"));
-                        while(ap.TryNextObject(obj)) {
-                            // Phew - we should now have access to each of the user's Mixes now.
-                            p.Parse(obj);
+        JsonTape tape;
+        tape.Parse(jsonResponse.Buffer());
+
+        // "rows" and "modules" only ever hold a single object
+        auto firstObject = [] (const JsonTapeValue& aArray) -> JsonTapeValue {
+            JsonTapeIterator it = aArray.Iterate();
+            JsonTapeValue obj;
+            if (!it.Next(obj) || obj.IsNull()) {
+                THROW(JsonArrayEnumerationComplete);
+            }
+            return obj;
+        };
 
-                            if (!p.HasKey("id")) {
+        JsonTapeValue p = tape.Root();
+        JsonTapeValue val;
+        if (p.TryGet(Brn("rows"), val)) {
+            p = firstObject(val);
+            if (p.TryGet(Brn("modules"), val)) {
+                p = firstObject(val);
+                if (p.TryGet(Brn("pagedList"), val)) {
+                    p = val;
+                    if (p.TryGet(Brn("items"), val)) {
+                        JsonTapeIterator items = val.Iterate();
+                        JsonTapeValue obj;
+                        while(items.Next(obj) && !obj.IsNull()) {
+                            // Phew - we should now have access to each of the user's Mixes now.
+                            if (!obj.HasKey("id")) {
                                 continue;
                             }
 
-                            Brn jsonId = p.String("id");
+                            Brn jsonId = obj.String("id");
                             if (jsonId == mixId) {
                                 // Found matching mix. Really only the artwork will change, so we'll check that.
                                 // NOTE: We only care about the "SMALL" image as this is what CPs set for the pin.
-                                p.Parse(p.String("images"));
-                                p.Parse(p.String("SMALL"));
-                                Brn artwork = p.String("url");
+                                Brn artwork = obj.Get("images").Get("SMALL").String("url");
 
                                 // Only update if the artwork has changed!
                                 if (artwork != aPin.ArtworkUri()) {
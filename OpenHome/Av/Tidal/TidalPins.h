@@ -21,6 +21,7 @@ namespace OpenHome {
     class Environment;
     class IThreadPool;
     class IThreadPoolHandle;
+    class JsonTape;
 namespace Configuration {
     class IConfigInitialiser;
     class ConfigChoice;
@@ -67,7 +68,7 @@ private:
     TBool LoadByStringQuery(const Brx& aQuery,TidalMetadata::EIdType aIdType, TBool aPinShuffled, EShuffleMode aShuffleMode, const Tidal::AuthenticationConfig& aAuthConfig);
     TUint LoadTracksById(const Brx& aId, TidalMetadata::EIdType aIdType, TUint aIsContainer, TUint& aCount, TBool aPinShuffled, EShuffleMode aShuffleMode, const Tidal::AuthenticationConfig& aAuthConfig);
 private: // helpers
-    TUint GetTotalItems(JsonParser& aParser, const Brx& aId, TidalMetadata::EIdType aIdType, TBool aIsContainer, TBool aShouldShuffleLoadOrder, TUint& aStartIndex, TUint& aEndIndex, const Tidal::AuthenticationConfig& aAuthConfig);
+    TUint GetTotalItems(JsonTape& aTape, const Brx& aId, TidalMetadata::EIdType aIdType, TBool aIsContainer, TBool aShouldShuffleLoadOrder, TUint& aStartIndex, TUint& aEndIndex, const Tidal::AuthenticationConfig& aAuthConfig);
     void UpdateOffset(TUint aTotalItems, TUint aFetchedCount, TUint aEndIndex, TBool aIsContainer, TBool aShouldShuffleLoadOrder, TUint& aOffset);
     TBool IsValidId(const Brx& aRequest, TidalMetadata::EIdType aIdType);
     void InitPlaylist(TBool aShuffle);
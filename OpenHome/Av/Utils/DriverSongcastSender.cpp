@@ -69,7 +69,8 @@ DriverSongcastSender::DriverSongcastSender(IPipelineElementUpstream& aPipeline,
 
     iZoneHandler = new ZoneHandler(iEnv, udn);
 
-    iOhmSender = new OhmSender(iEnv, *iDevice, *iOhmSenderDriver, *iZoneHandler, kPriorityHigh, udn, aChannel, kSongcastLatencyMs, false/*unicast*/);
+    iOhmSender = new OhmSender(iEnv, *iDevice, *iOhmSenderDriver, *iZoneHandler, kPriorityHigh, udn, aChannel, kSongcastLatencyMinMs, false/*unicast*/);
+    iOhmSender->SetLatencyRange(kSongcastLatencyMinMs, kSongcastLatencyMaxMs, kSongcastLatencyMs);
     iOhmSender->SetEnabled(true);
     iDevice->SetEnabled();
     iTimer = new Timer(iEnv, MakeFunctor(*this, &DriverSongcastSender::TimerCallback), "DriverSongcastSender");
@@ -18,7 +18,9 @@ namespace Av {
 class DriverSongcastSender : public Media::PipelineElement, private Net::IResourceManager
 {
     static const TUint kSongcastTtl = 1;
-    static const TUint kSongcastLatencyMs = 300;
+    static const TUint kSongcastLatencyMs = 300; // initial latency, adapted to receivers' reception
+    static const TUint kSongcastLatencyMinMs = 100;
+    static const TUint kSongcastLatencyMaxMs = 1000;
     static const TUint kSongcastPreset = 0;
     static const Brn kSenderIconFileName;
     static const TUint kSupportedMsgTypes;
@@ -936,6 +936,592 @@ TBool JsonParserArray::TryEndEnumerationIfNull()
     return false;
 }
 
+// JsonTape
+
+JsonTape::JsonTape()
+{
+    iTape.reserve(kDefaultEntries);
+    iOpen.reserve(16);
+}
+
+void JsonTape::Parse(const Brx& aJson)
+{
+    enum class Expect
+    {
+        Value,
+        ValueOrEnd,
+        Key,
+        KeyOrEnd,
+        Colon,
+        SeparatorOrEnd,
+        Nothing
+    };
+
+    Reset();
+    iJson.Set(aJson);
+    const TByte* start = iJson.Ptr();
+    const TByte* ptr = start;
+    const TByte* end = ptr + iJson.Bytes();
+    Expect expect = Expect::Value;
+    auto afterValue = [&] {
+        expect = (iOpen.size() == 0? Expect::Nothing : Expect::SeparatorOrEnd);
+    };
+    auto closeContainer = [&] (TByte aCh) {
+        if (iOpen.size() == 0) {
+            THROW(JsonCorrupt);
+        }
+        Entry& entry = iTape[iOpen.back()];
+        if ((aCh == '}') != (entry.iType == Type::Object)) {
+            THROW(JsonCorrupt);
+        }
+        iOpen.pop_back();
+        entry.iBytes = (TUint)(ptr + 1 - start) - entry.iOffset;
+        entry.iNext = (TUint)iTape.size();
+        ptr++;
+        afterValue();
+    };
+
+    try {
+        while (ptr < end) {
+            const TByte ch = *ptr;
+            if (Ascii::IsWhitespace(ch)) {
+                ptr++;
+                continue;
+            }
+            switch (expect)
+            {
+            case Expect::ValueOrEnd:
+                if (ch == ']') {
+                    closeContainer(ch);
+                    break;
+                }
+                // fall through
+            case Expect::Value:
+                if (ch == '{' || ch == '[') {
+                    Add(ch == '{'? Type::Object : Type::Array, ptr, 0);
+                    iOpen.push_back((TUint)iTape.size() - 1);
+                    ptr++;
+                    expect = (ch == '{'? Expect::KeyOrEnd : Expect::ValueOrEnd);
+                }
+                else if (ch == '\"') {
+                    ptr = ParseString(ptr, end);
+                    afterValue();
+                }
+                else if (ch == '-' || Ascii::IsDigit(ch)) {
+                    const TByte* numStart = ptr++;
+                    while (ptr < end && (Ascii::IsDigit(*ptr) || *ptr == '.' || *ptr == 'e' || *ptr == 'E' || *ptr == '-' || *ptr == '+')) {
+                        ptr++;
+                    }
+                    Add(Type::Num, numStart, (TUint)(ptr - numStart));
+                    afterValue();
+                }
+                else {
+                    ptr = ParseLiteral(ptr, end);
+                    afterValue();
+                }
+                break;
+            case Expect::KeyOrEnd:
+                if (ch == '}') {
+                    closeContainer(ch);
+                    break;
+                }
+                // fall through
+            case Expect::Key:
+                if (ch != '\"') {
+                    THROW(JsonCorrupt);
+                }
+                ptr = ParseString(ptr, end);
+                expect = Expect::Colon;
+                break;
+            case Expect::Colon:
+                if (ch != ':') {
+                    THROW(JsonCorrupt);
+                }
+                ptr++;
+                expect = Expect::Value;
+                break;
+            case Expect::SeparatorOrEnd:
+                if (ch == ',') {
+                    ptr++;
+                    expect = (iTape[iOpen.back()].iType == Type::Object? Expect::Key : Expect::Value);
+                }
+                else {
+                    closeContainer(ch);
+                }
+                break;
+            case Expect::Nothing:
+                THROW(JsonCorrupt);
+            }
+        }
+        if (expect != Expect::Nothing) {
+            THROW(JsonCorrupt);
+        }
+    }
+    catch (JsonCorrupt&) {
+        Reset();
+        throw;
+    }
+}
+
+void JsonTape::Reset()
+{
+    iJson.Set(Brx::Empty());
+    iTape.clear();
+    iOpen.clear();
+}
+
+JsonTapeValue JsonTape::Root() const
+{
+    ASSERT(iTape.size() > 0);
+    return JsonTapeValue(*this, 0);
+}
+
+TUint JsonTape::Entries() const
+{
+    return (TUint)iTape.size();
+}
+
+const TByte* JsonTape::ParseString(const TByte* aPtr, const TByte* aEnd)
+{
+    const TByte* start = ++aPtr; // skip opening quote
+    TBool escaped = false;
+    while (aPtr < aEnd) {
+        const TByte ch = *aPtr;
+        if (ch == '\"') {
+            Add(Type::String, start, (TUint)(aPtr - start), escaped);
+            return aPtr + 1;
+        }
+        if (ch == '\\') {
+            escaped = true;
+            aPtr++; // escaped char can't end the string
+        }
+        aPtr++;
+    }
+    THROW(JsonCorrupt);
+}
+
+const TByte* JsonTape::ParseLiteral(const TByte* aPtr, const TByte* aEnd)
+{
+    const Brn remaining(aPtr, (TUint)(aEnd - aPtr));
+    if (remaining.BeginsWith(WriterJson::kNull)) {
+        Add(Type::Null, aPtr, WriterJson::kNull.Bytes());
+        return aPtr + WriterJson::kNull.Bytes();
+    }
+    if (remaining.BeginsWith(WriterJson::kBoolTrue)) {
+        Add(Type::Bool, aPtr, WriterJson::kBoolTrue.Bytes());
+        return aPtr + WriterJson::kBoolTrue.Bytes();
+    }
+    if (remaining.BeginsWith(WriterJson::kBoolFalse)) {
+        Add(Type::Bool, aPtr, WriterJson::kBoolFalse.Bytes());
+        return aPtr + WriterJson::kBoolFalse.Bytes();
+    }
+    THROW(JsonCorrupt);
+}
+
+void JsonTape::Add(Type aType, const TByte* aStart, TUint aBytes, TBool aEscaped)
+{
+    Entry entry;
+    entry.iOffset = (TUint)(aStart - iJson.Ptr());
+    entry.iBytes = aBytes;
+    entry.iNext = (TUint)iTape.size() + 1;
+    entry.iType = aType;
+    entry.iEscaped = aEscaped;
+    iTape.push_back(entry);
+}
+
+
+// JsonTapeValue
+
+JsonTapeValue::JsonTapeValue()
+    : iTape(nullptr)
+    , iIndex(0)
+{
+}
+
+JsonTapeValue::JsonTapeValue(const JsonTape& aTape, TUint aIndex)
+    : iTape(&aTape)
+    , iIndex(aIndex)
+{
+}
+
+inline const JsonTape::Entry& JsonTapeValue::Current() const
+{
+    ASSERT(iTape != nullptr);
+    return iTape->iTape[iIndex];
+}
+
+inline Brn JsonTapeValue::Text(const JsonTape::Entry& aEntry) const
+{
+    return Brn(iTape->iJson.Ptr() + aEntry.iOffset, aEntry.iBytes);
+}
+
+JsonTape::Type JsonTapeValue::Type() const
+{
+    return Current().iType;
+}
+
+TBool JsonTapeValue::IsNull() const
+{
+    return Current().iType == JsonTape::Type::Null;
+}
+
+Brn JsonTapeValue::String() const
+{
+    const auto& entry = Current();
+    if (entry.iType == JsonTape::Type::Null) {
+        THROW(JsonValueNull);
+    }
+    return Text(entry);
+}
+
+Brn JsonTapeValue::StringUnescaped(Bwx& aBuf, Json::Encoding aEncoding) const
+{
+    Brn val = String();
+    if (!Current().iEscaped) {
+        return val;
+    }
+    aBuf.ReplaceThrow(val);
+    Json::Unescape(aBuf, aEncoding);
+    return Brn(aBuf);
+}
+
+TInt JsonTapeValue::Num() const
+{
+    try {
+        return Ascii::Int(String());
+    }
+    catch (AsciiError&) {
+        THROW(JsonCorrupt);
+    }
+}
+
+TBool JsonTapeValue::Bool() const
+{
+    Brn val = String();
+    if (val == WriterJson::kBoolTrue) {
+        return true;
+    }
+    else if (val == WriterJson::kBoolFalse) {
+        return false;
+    }
+    THROW(JsonCorrupt);
+}
+
+Brn JsonTapeValue::Raw() const
+{
+    const auto& entry = Current();
+    if (entry.iType == JsonTape::Type::String) {
+        return Brn(iTape->iJson.Ptr() + entry.iOffset - 1, entry.iBytes + 2); // include quotes
+    }
+    return Text(entry);
+}
+
+TUint JsonTapeValue::Count() const
+{
+    JsonTapeIterator it = Iterate();
+    JsonTapeValue val;
+    TUint count = 0;
+    while (it.Next(val)) {
+        count++;
+    }
+    return count;
+}
+
+JsonTapeIterator JsonTapeValue::Iterate() const
+{
+    const auto& entry = Current();
+    if (entry.iType != JsonTape::Type::Object && entry.iType != JsonTape::Type::Array) {
+        THROW(JsonWrongType);
+    }
+    return JsonTapeIterator(*iTape, iIndex + 1, entry.iNext, entry.iType == JsonTape::Type::Object);
+}
+
+TBool JsonTapeValue::HasKey(const TChar* aKey) const
+{
+    return HasKey(Brn(aKey));
+}
+
+TBool JsonTapeValue::HasKey(const Brx& aKey) const
+{
+    JsonTapeValue val;
+    return TryGet(aKey, val);
+}
+
+TBool JsonTapeValue::TryGet(const Brx& aKey, JsonTapeValue& aValue) const
+{
+    const auto& entry = Current();
+    if (entry.iType != JsonTape::Type::Object) {
+        THROW(JsonWrongType);
+    }
+    const auto& tape = iTape->iTape;
+    TUint i = iIndex + 1;
+    while (i < entry.iNext) {
+        if (Text(tape[i]) == aKey) {
+            aValue = JsonTapeValue(*iTape, i + 1);
+            return true;
+        }
+        i = tape[i + 1].iNext;
+    }
+    return false;
+}
+
+JsonTapeValue JsonTapeValue::Get(const TChar* aKey) const
+{
+    return Get(Brn(aKey));
+}
+
+JsonTapeValue JsonTapeValue::Get(const Brx& aKey) const
+{
+    JsonTapeValue val;
+    if (!TryGet(aKey, val)) {
+        THROW(JsonKeyNotFound);
+    }
+    return val;
+}
+
+Brn JsonTapeValue::String(const TChar* aKey) const
+{
+    return Get(Brn(aKey)).String();
+}
+
+Brn JsonTapeValue::String(const Brx& aKey) const
+{
+    return Get(aKey).String();
+}
+
+Brn JsonTapeValue::StringOptional(const TChar* aKey) const
+{
+    return StringOptional(Brn(aKey));
+}
+
+Brn JsonTapeValue::StringOptional(const Brx& aKey) const
+{
+    JsonTapeValue val;
+    if (!TryGet(aKey, val) || val.IsNull()) {
+        return Brn(Brx::Empty());
+    }
+    return val.String();
+}
+
+TInt JsonTapeValue::Num(const TChar* aKey) const
+{
+    return Get(Brn(aKey)).Num();
+}
+
+TInt JsonTapeValue::Num(const Brx& aKey) const
+{
+    return Get(aKey).Num();
+}
+
+TBool JsonTapeValue::Bool(const TChar* aKey) const
+{
+    return Get(Brn(aKey)).Bool();
+}
+
+TBool JsonTapeValue::Bool(const Brx& aKey) const
+{
+    return Get(aKey).Bool();
+}
+
+TBool JsonTapeValue::IsNull(const TChar* aKey) const
+{
+    return Get(Brn(aKey)).IsNull();
+}
+
+TBool JsonTapeValue::IsNull(const Brx& aKey) const
+{
+    return Get(aKey).IsNull();
+}
+
+void JsonTapeValue::GetKeys(std::vector<Brn>& aKeys) const
+{
+    JsonTapeIterator it = Iterate();
+    Brn key;
+    JsonTapeValue val;
+    while (it.Next(key, val)) {
+        aKeys.push_back(key);
+    }
+}
+
+
+// JsonTapeIterator
+
+JsonTapeIterator::JsonTapeIterator(const JsonTape& aTape, TUint aFirst, TUint aEnd, TBool aObject)
+    : iTape(&aTape)
+    , iIndex(aFirst)
+    , iEnd(aEnd)
+    , iObject(aObject)
+{
+}
+
+TBool JsonTapeIterator::Next(JsonTapeValue& aValue)
+{
+    if (iIndex >= iEnd) {
+        return false;
+    }
+    const TUint index = (iObject? iIndex + 1 : iIndex);
+    aValue = JsonTapeValue(*iTape, index);
+    iIndex = iTape->iTape[index].iNext;
+    return true;
+}
+
+TBool JsonTapeIterator::Next(Brn& aKey, JsonTapeValue& aValue)
+{
+    if (!iObject) {
+        THROW(JsonWrongType);
+    }
+    if (iIndex >= iEnd) {
+        return false;
+    }
+    const auto& key = iTape->iTape[iIndex];
+    aKey.Set(iTape->iJson.Ptr() + key.iOffset, key.iBytes);
+    return Next(aValue);
+}
+
+// JsonParserTape
+
+JsonParserTape::JsonParserTape()
+    : iEmpty(true)
+{
+}
+
+void JsonParserTape::Parse(const Brx& aJson)
+{
+    Reset();
+    Brn json = Ascii::Trim(aJson);
+    if (json.Bytes() == 0 || json == WriterJson::kNull) {
+        return;
+    }
+    iTape.Parse(json);
+    if (iTape.iTape[0].iType != JsonTape::Type::Object) {
+        iTape.Reset();
+        THROW(JsonCorrupt);
+    }
+    iEmpty = false;
+}
+
+void JsonParserTape::ParseAndUnescape(Bwx& aJson)
+{
+    Parse(aJson);
+    if (iEmpty) {
+        return;
+    }
+    auto& tape = iTape.iTape;
+    const TUint end = tape[0].iNext;
+    TUint i = 1;
+    while (i < end) {
+        JsonTape::Entry& val = tape[i + 1];
+        if (val.iType == JsonTape::Type::String && val.iEscaped) {
+            // unescaping only ever shrinks a string so offsets of later entries remain valid
+            Bwn buf(iTape.iJson.Ptr() + val.iOffset, val.iBytes, val.iBytes);
+            Json::Unescape(buf);
+            val.iBytes = buf.Bytes();
+            val.iEscaped = false;
+        }
+        i = val.iNext;
+    }
+}
+
+void JsonParserTape::Reset()
+{
+    iTape.Reset();
+    iEmpty = true;
+}
+
+TBool JsonParserTape::HasKey(const TChar* aKey) const
+{
+    return HasKey(Brn(aKey));
+}
+
+TBool JsonParserTape::HasKey(const Brx& aKey) const
+{
+    JsonTapeValue val;
+    return TryGet(aKey, val);
+}
+
+TBool JsonParserTape::TryGet(const Brx& aKey, JsonTapeValue& aValue) const
+{
+    if (iEmpty) {
+        return false;
+    }
+    return iTape.Root().TryGet(aKey, aValue);
+}
+
+JsonTapeValue JsonParserTape::Get(const TChar* aKey) const
+{
+    return Get(Brn(aKey));
+}
+
+JsonTapeValue JsonParserTape::Get(const Brx& aKey) const
+{
+    JsonTapeValue val;
+    if (!TryGet(aKey, val)) {
+        THROW(JsonKeyNotFound);
+    }
+    return val;
+}
+
+Brn JsonParserTape::String(const TChar* aKey) const
+{
+    return Get(Brn(aKey)).String();
+}
+
+Brn JsonParserTape::String(const Brx& aKey) const
+{
+    return Get(aKey).String();
+}
+
+Brn JsonParserTape::StringOptional(const TChar* aKey) const
+{
+    return StringOptional(Brn(aKey));
+}
+
+Brn JsonParserTape::StringOptional(const Brx& aKey) const
+{
+    JsonTapeValue val;
+    if (!TryGet(aKey, val) || val.IsNull()) {
+        return Brn(Brx::Empty());
+    }
+    return val.String();
+}
+
+TInt JsonParserTape::Num(const TChar* aKey) const
+{
+    return Get(Brn(aKey)).Num();
+}
+
+TInt JsonParserTape::Num(const Brx& aKey) const
+{
+    return Get(aKey).Num();
+}
+
+TBool JsonParserTape::Bool(const TChar* aKey) const
+{
+    return Get(Brn(aKey)).Bool();
+}
+
+TBool JsonParserTape::Bool(const Brx& aKey) const
+{
+    return Get(aKey).Bool();
+}
+
+TBool JsonParserTape::IsNull(const TChar* aKey) const
+{
+    return Get(Brn(aKey)).IsNull();
+}
+
+TBool JsonParserTape::IsNull(const Brx& aKey) const
+{
+    return Get(aKey).IsNull();
+}
+
+void JsonParserTape::GetKeys(std::vector<Brn>& aKeys) const
+{
+    if (!iEmpty) {
+        iTape.Root().GetKeys(aKeys);
+    }
+}
+
 // class WriterJson
 
 const Brn WriterJson::kQuote("\"");
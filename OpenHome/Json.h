@@ -4,6 +4,7 @@
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Exception.h>
 #include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Standard.h>
 
 #include <map>
 #include <vector>
@@ -144,6 +145,154 @@ private:
     EntryValType iEntryType;
 };
 
+class JsonTapeValue;
+class JsonTapeIterator;
+class JsonParserTape;
+
+/*
+    Single pass parser which indexes a complete document.
+
+    Parse() records the type and location of every value in a flat array (the "tape").
+    Each object or array entry also records where its contents end, so nested values
+    can be reached or skipped without scanning the document again.  Strings are left
+    escaped in the parsed buffer, which must outlive the tape; callers unescape only the
+    values they use.
+*/
+class JsonTape : private INonCopyable
+{
+    friend class JsonTapeValue;
+    friend class JsonTapeIterator;
+    friend class JsonParserTape;
+    static const TUint kDefaultEntries = 256;
+public:
+    enum class Type : TByte
+    {
+        Null,
+        Bool,
+        Num,
+        String,
+        Object,
+        Array
+    };
+public:
+    JsonTape();
+    void Parse(const Brx& aJson); // throws JsonCorrupt
+    void Reset();
+    JsonTapeValue Root() const;
+    TUint Entries() const;
+private:
+    struct Entry
+    {
+        TUint iOffset;  // first byte of value, excluding quotes for strings
+        TUint iBytes;   // length of value, including brackets for objects/arrays
+        TUint iNext;    // index of next entry after this value and its contents
+        Type iType;
+        TBool iEscaped; // string contains escape sequences
+    };
+private:
+    const TByte* ParseString(const TByte* aPtr, const TByte* aEnd);
+    const TByte* ParseLiteral(const TByte* aPtr, const TByte* aEnd);
+    void Add(Type aType, const TByte* aStart, TUint aBytes, TBool aEscaped = false);
+private:
+    Brn iJson;
+    std::vector<Entry> iTape;
+    std::vector<TUint> iOpen; // objects/arrays whose closing bracket hasn't been reached yet
+};
+
+/*
+    View of a single value within a JsonTape.
+    Object accessors mirror those of JsonParser, allowing callers to switch parsers without
+    other changes.  As with JsonParser, String() returns the text of non-string values.
+*/
+class JsonTapeValue
+{
+    friend class JsonTape;
+    friend class JsonTapeIterator;
+public:
+    JsonTapeValue();
+    JsonTape::Type Type() const;
+    TBool IsNull() const;
+    Brn String() const; // escaped, as it appears in the document.  Throws JsonValueNull
+    Brn StringUnescaped(Bwx& aBuf, Json::Encoding aEncoding = Json::Encoding::Utf8) const; // only copies to aBuf if there is something to unescape
+    TInt Num() const;
+    TBool Bool() const;
+    Brn Raw() const; // complete text of value, as required by JsonParser or JsonParserArray
+    TUint Count() const; // number of entries in an object or array
+    JsonTapeIterator Iterate() const; // entries in an object or array.  Throws JsonWrongType for other values
+
+    TBool HasKey(const TChar* aKey) const;
+    TBool HasKey(const Brx& aKey) const;
+    TBool TryGet(const Brx& aKey, JsonTapeValue& aValue) const;
+    JsonTapeValue Get(const TChar* aKey) const; // throws JsonKeyNotFound
+    JsonTapeValue Get(const Brx& aKey) const;
+    Brn String(const TChar* aKey) const;
+    Brn String(const Brx& aKey) const;
+    Brn StringOptional(const TChar* aKey) const; // returns empty buffer if aKey had null value or was missing
+    Brn StringOptional(const Brx& aKey) const;
+    TInt Num(const TChar* aKey) const;
+    TInt Num(const Brx& aKey) const;
+    TBool Bool(const TChar* aKey) const;
+    TBool Bool(const Brx& aKey) const;
+    TBool IsNull(const TChar* aKey) const;
+    TBool IsNull(const Brx& aKey) const;
+    void GetKeys(std::vector<Brn>& aKeys) const;
+private:
+    JsonTapeValue(const JsonTape& aTape, TUint aIndex);
+    inline const JsonTape::Entry& Current() const;
+    inline Brn Text(const JsonTape::Entry& aEntry) const;
+private:
+    const JsonTape* iTape;
+    TUint iIndex;
+};
+
+class JsonTapeIterator
+{
+    friend class JsonTapeValue;
+public:
+    TBool Next(JsonTapeValue& aValue);            // next array entry or object member value
+    TBool Next(Brn& aKey, JsonTapeValue& aValue); // next object member.  aKey is escaped
+private:
+    JsonTapeIterator(const JsonTape& aTape, TUint aFirst, TUint aEnd, TBool aObject);
+private:
+    const JsonTape* iTape;
+    TUint iIndex;
+    TUint iEnd;
+    TBool iObject;
+};
+
+/*
+    JsonParser interface over a JsonTape.
+    Callers of JsonParser can switch to this without other changes.  Get()/TryGet() then
+    give access to nested objects and arrays without parsing them again.
+*/
+class JsonParserTape : private INonCopyable
+{
+public:
+    JsonParserTape();
+    void Parse(const Brx& aJson);
+    void ParseAndUnescape(Bwx& aJson); // as JsonParser, only unescapes string members of the outer object
+    void Reset();
+    TBool HasKey(const TChar* aKey) const;
+    TBool HasKey(const Brx& aKey) const;
+    TBool TryGet(const Brx& aKey, JsonTapeValue& aValue) const;
+    JsonTapeValue Get(const TChar* aKey) const; // throws JsonKeyNotFound
+    JsonTapeValue Get(const Brx& aKey) const;
+    Brn String(const TChar* aKey) const;
+    Brn String(const Brx& aKey) const;
+    Brn StringOptional(const TChar* aKey) const; // returns empty buffer if aKey had null value or was missing
+    Brn StringOptional(const Brx& aKey) const; // returns empty buffer if aKey had null value or was missing
+    TInt Num(const TChar* aKey) const;
+    TInt Num(const Brx& aKey) const;
+    TBool Bool(const TChar* aKey) const;
+    TBool Bool(const Brx& aKey) const;
+    TBool IsNull(const TChar* aKey) const;
+    TBool IsNull(const Brx& aKey) const;
+    void GetKeys(std::vector<Brn>& aKeys) const; // in document order
+private:
+    JsonTape iTape;
+    TBool iEmpty; // as JsonParser, an empty or null document is treated as an object with no keys
+};
+
 class WriterJson
 {
 public:
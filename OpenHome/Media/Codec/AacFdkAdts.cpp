@@ -48,6 +48,7 @@ public:
     ~CodecAacFdkAdts();
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo) override;
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const override;
     void StreamInitialise() override;
     void Process() override;
     //TBool TrySeek(TUint aStreamId, TUint64 aSample) override;
@@ -197,6 +198,19 @@ CodecAacFdkAdts::~CodecAacFdkAdts()
     LOG(kCodec, "CodecAacFdkAdts::~CodecAacFdkAdts\n");
 }
 
+CodecBase::RecognitionHint CodecAacFdkAdts::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
+        return RecognitionHint::Unlikely;
+    }
+    // Recognise() searches for a run of frames, so only a frame header at the very start is conclusive.
+    // Sync is 12 set bits, followed by the MPEG version and a layer of 0.
+    if (aStreamStart.Bytes() >= 2 && aStreamStart[0] == 0xff && (aStreamStart[1] & 0xf6) == 0xf0) {
+        return RecognitionHint::Likely;
+    }
+    return RecognitionHint::Unknown;
+}
+
 TBool CodecAacFdkAdts::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
     LOG(kCodec, "CodecAacFdkAdts::Recognise\n");
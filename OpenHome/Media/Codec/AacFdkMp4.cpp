@@ -20,6 +20,7 @@ public:
     ~CodecAacFdkMp4();
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo);
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const;
     void StreamInitialise();
     void Process();
     TBool TrySeek(TUint aStreamId, TUint64 aSample);
@@ -30,8 +31,7 @@ private:
     TUint SkipEsdsTag(IReader& aReader, TByte& aDescLen);
 private:
     Bws<kMaxRecogBytes> iRecogBuf;
-    SampleSizeTable iSampleSizeTable;
-    SeekTable iSeekTable;
+    Mpeg4SampleTables* iTables;
     TBool iIsFragmentedStream;
     TUint iCurrentCodecSample;  // Sample count is 32 bits in stsz box.
     Bwh iAudioSpecificConfig;
@@ -57,12 +57,21 @@ CodecBase* CodecFactory::NewAacFdkMp4(IMimeTypeList& aMimeTypeList)
 
 CodecAacFdkMp4::CodecAacFdkMp4(IMimeTypeList& aMimeTypeList)
     : CodecAacFdkBase("AAC", aMimeTypeList)
+    , iTables(nullptr)
     , iAudioSpecificConfig(kDefaultAscBytes)
 {
 }
 
 CodecAacFdkMp4::~CodecAacFdkMp4()
 {
+    if (iTables != nullptr) {
+        iTables->RemoveRef();
+    }
+}
+
+CodecBase::RecognitionHint CodecAacFdkMp4::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    return SniffSignature(aStreamStart, aStreamInfo, "mp4a");
 }
 
 TBool CodecAacFdkMp4::Recognise(const EncodedStreamInfo& aStreamInfo)
@@ -304,7 +313,7 @@ TBool CodecAacFdkMp4::TrySeek(TUint aStreamId, TUint64 aSample)
         TUint64 codecSample = 0;
         // This alters seekTableInputSample to point to closest audio sample to aSample that can actually be seeked to.
         // codecSample is altered to be the "codec" sample containing that audio sample. This is nothing to do with audio samples in Hz.
-        const TUint64 bytes = iSeekTable.Offset(seekTableInputSample, codecSample);     // find file offset relating to given audio sample
+        const TUint64 bytes = iTables->Seek().Offset(seekTableInputSample, codecSample, iTables->SampleSizes());     // find file offset relating to given audio sample
         LOG(kCodec, "CodecAacFdkMp4::Seek to sample: %llu, byte: %llu, codecSample: %llu\n", seekTableInputSample, bytes, codecSample);
         const TBool canSeek = iController->TrySeekTo(aStreamId, bytes);
         if (canSeek) {
@@ -344,11 +353,12 @@ void CodecAacFdkMp4::ProcessMpeg4()
 {
     iInBuf.SetBytes(0);
 
-    if (iCurrentCodecSample < iSampleSizeTable.Count()) {
+    const SampleSizeTable& sampleSizes = iTables->SampleSizes();
+    if (iCurrentCodecSample < sampleSizes.Count()) {
         // Read in a single aac sample.
         try {
-            LOG_TRACE(kCodec, "CodecAacFdkMp4::Process  iCurrentCodecSample: %u, size: %u, inBuf.MaxBytes(): %u\n", iCurrentCodecSample, iSampleSizeTable.SampleSize(iCurrentCodecSample), iInBuf.MaxBytes());
-            TUint sampleSize = iSampleSizeTable.SampleSize(iCurrentCodecSample);
+            LOG_TRACE(kCodec, "CodecAacFdkMp4::Process  iCurrentCodecSample: %u, size: %u, inBuf.MaxBytes(): %u\n", iCurrentCodecSample, sampleSizes.SampleSize(iCurrentCodecSample), iInBuf.MaxBytes());
+            TUint sampleSize = sampleSizes.SampleSize(iCurrentCodecSample);
             iController->Read(iInBuf, sampleSize);
             LOG_TRACE(kCodec, "CodecAacFdkMp4::Process  read iInBuf.Bytes() = %u\n", iInBuf.Bytes());
             if (iInBuf.Bytes() < sampleSize) {
@@ -388,17 +398,9 @@ void CodecAacFdkMp4::ProcessMpeg4()
 
 void CodecAacFdkMp4::ReadSampleAndSeekTables(CodecBufferedReader& aReader)
 {
-    ReaderBinary readerBin(aReader);
-    iSampleSizeTable.Clear();
-    const TUint sampleCount = readerBin.ReadUintBe(4);
-    iSampleSizeTable.Init(sampleCount);
-    for (TUint i=0; i<sampleCount; i++) {
-        const TUint sampleSize = readerBin.ReadUintBe(4);
-        iSampleSizeTable.AddSampleSize(sampleSize);
+    Mpeg4SampleTables* tables = Mpeg4SampleTablesReader::Read(aReader);
+    if (iTables != nullptr) {
+        iTables->RemoveRef();
     }
-
-    // Read seek table.
-    iSeekTable.Deinitialise();
-    SeekTableInitialiser seekTableInitialiser(iSeekTable, aReader);
-    seekTableInitialiser.Init();
+    iTables = tables;
 }
@@ -19,6 +19,19 @@ CodecAiffBase::~CodecAiffBase()
 {
 }
 
+CodecBase::RecognitionHint CodecAiffBase::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    const RecognitionHint hint = SniffSignature(aStreamStart, aStreamInfo, "FORM");
+    if (hint != RecognitionHint::Likely) {
+        return hint;
+    }
+    const Brn formType(iName.Ptr(), 4);
+    if (aStreamStart.Bytes() < 12) {
+        return RecognitionHint::Unknown;
+    }
+    return Brn(aStreamStart.Ptr() + 8, 4) == formType? RecognitionHint::Likely : RecognitionHint::Unlikely;
+}
+
 TBool CodecAiffBase::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
     if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
@@ -15,6 +15,7 @@ protected:
     ~CodecAiffBase();
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo);
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const;
     void StreamInitialise();
     void Process();
     TBool TrySeek(TUint aStreamId, TUint64 aSample);
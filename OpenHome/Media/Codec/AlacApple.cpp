@@ -26,6 +26,7 @@ public:
     ~CodecAlacApple();
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo);
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const;
     void StreamInitialise();
     void Process();
     TBool TrySeek(TUint aStreamId, TUint64 aSample);
@@ -35,8 +36,7 @@ private:
 private:
     static const TUint kMaxRecogBytes = 6 * 1024; // copied from previous CodecController behaviour
     Bws<kMaxRecogBytes> iRecogBuf;
-    SampleSizeTable iSampleSizeTable;
-    SeekTable iSeekTable;
+    Mpeg4SampleTables* iTables;
     TBool iIsFragmentedStream;
     TUint iCurrentSample;       // Sample count is 32 bits in stsz box.
 };
@@ -60,6 +60,7 @@ CodecBase* CodecFactory::NewAlacApple(IMimeTypeList& aMimeTypeList)
 
 CodecAlacApple::CodecAlacApple(IMimeTypeList& aMimeTypeList)
     : CodecAlacAppleBase("ALAC")
+    , iTables(nullptr)
 {
     LOG(kCodec, "CodecAlac::CodecAlac\n");
     aMimeTypeList.Add("audio/x-m4a");
@@ -68,6 +69,14 @@ CodecAlacApple::CodecAlacApple(IMimeTypeList& aMimeTypeList)
 CodecAlacApple::~CodecAlacApple()
 {
     LOG(kCodec, "CodecAlac::~CodecAlac\n");
+    if (iTables != nullptr) {
+        iTables->RemoveRef();
+    }
+}
+
+CodecBase::RecognitionHint CodecAlacApple::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    return SniffSignature(aStreamStart, aStreamInfo, "alac");
 }
 
 TBool CodecAlacApple::Recognise(const EncodedStreamInfo& aStreamInfo)
@@ -191,7 +200,7 @@ TBool CodecAlacApple::TrySeek(TUint aStreamId, TUint64 aSample)
 
     try {
         TUint64 startSample = 0;
-        TUint64 bytes = iSeekTable.Offset(aSample, startSample);     // find file offset relating to given audio sample
+        TUint64 bytes = iTables->Seek().Offset(aSample, startSample, iTables->SampleSizes());     // find file offset relating to given audio sample
         LOG(kCodec, "CodecAlac::TrySeek to sample: %llu, byte: %lld\n", startSample, bytes);
         TBool canSeek = iController->TrySeekTo(aStreamId, bytes);
         if (canSeek) {
@@ -225,11 +234,12 @@ void CodecAlacApple::Process()
     //LOG(kCodec, "CodecAlac::Process\n");
     iInBuf.SetBytes(0);
 
-    if (iCurrentSample < iSampleSizeTable.Count()) {
+    const SampleSizeTable& sampleSizes = iTables->SampleSizes();
+    if (iCurrentSample < sampleSizes.Count()) {
         // Read in a single alac sample.
         try {
-            LOG(kCodec, "CodecAlac::Process  iCurrentSample: %u, size: %u, inBuf.MaxBytes(): %u\n", iCurrentSample, iSampleSizeTable.SampleSize(iCurrentSample), iInBuf.MaxBytes());
-            TUint sampleSize = iSampleSizeTable.SampleSize(iCurrentSample);
+            LOG(kCodec, "CodecAlac::Process  iCurrentSample: %u, size: %u, inBuf.MaxBytes(): %u\n", iCurrentSample, sampleSizes.SampleSize(iCurrentSample), iInBuf.MaxBytes());
+            TUint sampleSize = sampleSizes.SampleSize(iCurrentSample);
             iController->Read(iInBuf, sampleSize);
             if (iInBuf.Bytes() < sampleSize) {
                 THROW(CodecStreamEnded);
@@ -262,18 +272,9 @@ void CodecAlacApple::Process()
 
 void CodecAlacApple::ReadSampleAndSeekTables(CodecBufferedReader& aReader)
 {
-    // Read sample size table.
-    ReaderBinary readerBin(aReader);
-    iSampleSizeTable.Clear();
-    const TUint sampleCount = readerBin.ReadUintBe(4);
-    iSampleSizeTable.Init(sampleCount);
-    for (TUint i=0; i<sampleCount; i++) {
-        const TUint sampleSize = readerBin.ReadUintBe(4);
-        iSampleSizeTable.AddSampleSize(sampleSize);
+    Mpeg4SampleTables* tables = Mpeg4SampleTablesReader::Read(aReader);
+    if (iTables != nullptr) {
+        iTables->RemoveRef();
     }
-
-    // Read seek table.
-    iSeekTable.Deinitialise();
-    SeekTableInitialiser seekTableInitialiser(iSeekTable, aReader);
-    seekTableInitialiser.Init();
+    iTables = tables;
 }
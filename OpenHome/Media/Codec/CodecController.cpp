@@ -136,6 +136,11 @@ void CodecBase::StreamCompleted()
 {
 }
 
+CodecBase::RecognitionHint CodecBase::Sniff(const Brx& /*aStreamStart*/, const EncodedStreamInfo& /*aStreamInfo*/) const
+{
+    return RecognitionHint::Unknown;
+}
+
 const TChar* CodecBase::Id() const
 {
     return iId;
@@ -158,6 +163,22 @@ SpeakerProfile CodecBase::DeriveProfile(TUint aChannels)
     return (aChannels == 1) ? SpeakerProfile(1) : SpeakerProfile(2);
 }
 
+CodecBase::RecognitionHint CodecBase::SniffSignature(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo,
+                                                     const TChar* aSignature, TUint aOffset)
+{
+    if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
+        return RecognitionHint::Unlikely;
+    }
+    Brn signature(aSignature);
+    if (aStreamStart.Bytes() < aOffset + signature.Bytes()) {
+        return RecognitionHint::Unknown;
+    }
+    if (Brn(aStreamStart.Ptr() + aOffset, signature.Bytes()) == signature) {
+        return RecognitionHint::Likely;
+    }
+    return RecognitionHint::Unlikely;
+}
+
 
 // CodecController::InitialSeekObserver
 
@@ -207,6 +228,7 @@ CodecController::CodecController(MsgFactory& aMsgFactory, IPipelineElementUpstre
     , iRamp(RampType::Sample)
     , iInitialSeekPos(0)
 {
+    iRecogStreams = iRecogAttempts = iRecogAttemptsMax = 0;
     iDecoderThread = new ThreadFunctor("CodecController", MakeFunctor(*this, &CodecController::CodecThread), aThreadPriority);
     if (aLogger) {
         iLoggerRewinder = new Logger(iRewinder, "Rewinder");
@@ -256,6 +278,13 @@ void CodecController::AddCodec(CodecBase* aCodec)
 #endif
 }
 
+void CodecController::GetRecognitionStats(TUint& aStreams, TUint& aAttempts, TUint& aMaxAttempts) const
+{
+    aStreams = iRecogStreams;
+    aAttempts = iRecogAttempts;
+    aMaxAttempts = iRecogAttemptsMax;
+}
+
 void CodecController::Start()
 {
     iDecoderThread->Start();
@@ -319,7 +348,7 @@ void CodecController::CodecThread()
             iLock.Wait();
             iQueueTrackData = iStreamEnded = iStreamStopped = iSeek = iRecognising = iSeekInProgress = false;
             iActiveCodec = nullptr;
-            iChannels = iBitDepth = iBytesPerSample = 0;
+            iChannels = iBitDepth = iBytesPerSample = iStoredBytesPerSample = 0;
             iSampleRate = iSeekSeconds = 0;
             iStreamPos = 0LL;
             ReleaseAudioEncoded();
@@ -354,10 +383,13 @@ void CodecController::CodecThread()
 
             LOG(kMedia, "CodecThread: start recognition.  iTrackId=%u, iStreamId=%u\n", iTrackId, iStreamId);
             TBool streamEnded = false;
+            const TBool flushed = !RankCodecs(streamInfo, streamEnded);
+            TUint attempts = 0;
 
-            for (size_t i=0; i<iCodecs.size() && !iQuit && !iStreamStopped; i++) {
-                CodecBase* codec = iCodecs[i];
+            for (size_t i=0; i<iCodecsRanked.size() && !flushed && !iQuit && !iStreamStopped; i++) {
+                CodecBase* codec = iCodecsRanked[i];
                 TBool recognised = false;
+                attempts++;
                 try {
                     recognised = codec->Recognise(streamInfo);
                 }
@@ -386,10 +418,16 @@ void CodecController::CodecThread()
             }
             iRecognising = false;
             iRewinder.Stop(); // stop buffering audio
+            iRecogStreams++;
+            iRecogAttempts += attempts;
+            if (attempts > iRecogAttemptsMax) {
+                iRecogAttemptsMax = attempts;
+            }
             if (iQuit) {
                 break;
             }
-            LOG(kMedia, "CodecThread: recognition complete\n");
+            LOG(kMedia, "CodecThread: recognition complete (%s after %u attempts)\n",
+                (iActiveCodec == nullptr? "none" : iActiveCodec->Id()), attempts);
             if (iActiveCodec == nullptr) {
                 if (iStreamId != 0  && // FIXME - hard-coded assumption about Filler's NullTrack
                     !iStreamStopped && // we wouldn't necessarily expect to recognise a track if we're told to stop
@@ -503,6 +541,49 @@ void CodecController::CodecThread()
     }
 }
 
+TBool CodecController::RankCodecs(const EncodedStreamInfo& aStreamInfo, TBool& aStreamEnded)
+{
+    // Peek at the start of the stream (then rewind) so that codecs can be offered it
+    // in order of how likely they are to recognise it.
+    TBool flushed = false;
+    iSniffBuf.SetBytes(0);
+    if (aStreamInfo.StreamFormat() == EncodedStreamInfo::Format::Encoded) {
+        try {
+            Read(iSniffBuf, iSniffBuf.MaxBytes());
+        }
+        catch (CodecStreamStart&) {}
+        catch (CodecStreamEnded&) {}
+        catch (CodecStreamStopped&) {}
+        catch (CodecStreamFlush&) {
+            flushed = true;
+        }
+        AutoMutex _(iLock);
+        if (iStreamStarted || iStreamEnded) {
+            aStreamEnded = true;
+        }
+        iStreamStarted = iStreamEnded = false;
+        if (!flushed) {
+            // as in the recognition loop, don't rewind to replay msgs the pending flush would discard
+            Rewind();
+        }
+    }
+
+    iCodecHints.clear();
+    for (auto codec : iCodecs) {
+        iCodecHints.push_back(codec->Sniff(iSniffBuf, aStreamInfo));
+    }
+    // stable partition by hint, preserving recognition cost order within each group
+    iCodecsRanked.clear();
+    for (auto hint : { CodecBase::RecognitionHint::Likely, CodecBase::RecognitionHint::Unknown, CodecBase::RecognitionHint::Unlikely }) {
+        for (size_t i=0; i<iCodecs.size(); i++) {
+            if (iCodecHints[i] == hint) {
+                iCodecsRanked.push_back(iCodecs[i]);
+            }
+        }
+    }
+    return !flushed;
+}
+
 void CodecController::Rewind()
 {
     iRewinder.Rewind();
@@ -563,6 +644,16 @@ void CodecController::ReleaseAudioDecoded()
 }
 
 void CodecController::Read(Bwx& aBuf, TUint aBytes)
+{
+    ReadAtLeast(aBuf, aBytes, aBytes);
+}
+
+void CodecController::ReadAvailable(Bwx& aBuf, TUint aBytes)
+{
+    ReadAtLeast(aBuf, aBytes, std::min(aBytes, 1u));
+}
+
+void CodecController::ReadAtLeast(Bwx& aBuf, TUint aBytes, TUint aMinBytes)
 {
     if (iPendingMsg != nullptr) {
         if (DoRead(aBuf, aBytes)) {
@@ -582,7 +673,7 @@ void CodecController::Read(Bwx& aBuf, TUint aBytes)
         }
         THROW(CodecStreamEnded);
     }
-    while (!iStreamEnded && (iAudioEncoded == nullptr || iAudioEncoded->Bytes() < aBytes)) {
+    while (!iStreamEnded && (iAudioEncoded == nullptr || iAudioEncoded->Bytes() < aMinBytes)) {
         Msg* msg = PullMsg();
         if (msg != nullptr) {
             ASSERT(iPendingMsg == nullptr);
@@ -770,6 +861,7 @@ void CodecController::DoOutputDecodedStream(MsgDecodedStream* aMsg)
         iSampleRate = stream.SampleRate();
         iBitDepth = stream.BitDepth();
         iBytesPerSample = iChannels * iBitDepth / 8;
+        iStoredBytesPerSample = iChannels * DecodedAudio::BytesPerSubsample(iMsgFactory.DecodedPcmStorage(), iBitDepth);
 
         // Handle when the new MsgDecodedStream should be output.
         if (iPostSeekStreamInfo != nullptr) {
@@ -790,6 +882,10 @@ void CodecController::DoOutputDecodedStream(MsgDecodedStream* aMsg)
         }
 
         iMaxOutputSamples = Jiffies::ToSamples(iMaxOutputJiffies, iSampleRate);
+        if (iMsgFactory.DecodedPcmStorage() == PcmStorage::Int32 && iStoredBytesPerSample > 0) {
+            // expanded subsamples must still fit in a single DecodedAudio
+            iMaxOutputSamples = std::min(iMaxOutputSamples, AudioData::kMaxBytes / iStoredBytesPerSample);
+        }
         iMaxOutputBytes = (iMaxOutputSamples * iBitDepth  * iChannels) / 8;
     }
     if (queue) {
@@ -831,11 +927,118 @@ TUint64 CodecController::OutputAudioPcm(MsgAudioEncoded* aMsg, TUint aChannels,
     ASSERT(aChannels == iChannels);
     ASSERT(aSampleRate == iSampleRate);
     ASSERT(aBitDepth == iBitDepth);
+    if (iMsgFactory.DecodedPcmStorage() == PcmStorage::Int32) {
+        /* aMsg's buffer can't be shared when subsamples need to be widened.
+           Copy its (big endian) content out and output it as a decoded buffer. */
+        const TUint64 offsetBefore = aTrackOffset;
+        const TUint maxBytes = iEncodedPcm.MaxBytes() - (iEncodedPcm.MaxBytes() % iBytesPerSample);
+        while (aMsg != nullptr) {
+            MsgAudioEncoded* remaining = nullptr;
+            if (aMsg->Bytes() > maxBytes) {
+                remaining = aMsg->Split(maxBytes);
+            }
+            aMsg->CopyTo(const_cast<TByte*>(iEncodedPcm.Ptr()));
+            iEncodedPcm.SetBytes(aMsg->Bytes());
+            aMsg->RemoveRef();
+            aTrackOffset += OutputAudioPcm(iEncodedPcm, aChannels, aSampleRate, aBitDepth, AudioDataEndian::Big, aTrackOffset);
+            aMsg = remaining;
+        }
+        return aTrackOffset - offsetBefore;
+    }
     MsgAudioPcm* audio = iMsgFactory.CreateMsgAudioPcm(aMsg, aChannels, aSampleRate, aBitDepth, aTrackOffset);
     aMsg->RemoveRef();
     return DoOutputAudio(audio);
 }
 
+static void InterleavePacked(const TInt32* const* aSubsamples, TUint aIndex, TUint aNumSamples,
+                             TUint aChannels, TUint aBitDepth, TByte* aDest)
+{
+    const TUint end = aIndex + aNumSamples;
+    switch (aBitDepth)
+    {
+    case 8:
+        for (TUint i=aIndex; i<end; i++) {
+            for (TUint j=0; j<aChannels; j++) {
+                *aDest++ = (TByte)aSubsamples[j][i];
+            }
+        }
+        break;
+    case 16:
+        for (TUint i=aIndex; i<end; i++) {
+            for (TUint j=0; j<aChannels; j++) {
+                const TUint32 subsample = (TUint32)aSubsamples[j][i];
+                *aDest++ = (TByte)(subsample >> 8);
+                *aDest++ = (TByte)subsample;
+            }
+        }
+        break;
+    case 24:
+        for (TUint i=aIndex; i<end; i++) {
+            for (TUint j=0; j<aChannels; j++) {
+                const TUint32 subsample = (TUint32)aSubsamples[j][i];
+                *aDest++ = (TByte)(subsample >> 16);
+                *aDest++ = (TByte)(subsample >> 8);
+                *aDest++ = (TByte)subsample;
+            }
+        }
+        break;
+    case 32:
+        for (TUint i=aIndex; i<end; i++) {
+            for (TUint j=0; j<aChannels; j++) {
+                const TUint32 subsample = (TUint32)aSubsamples[j][i];
+                *aDest++ = (TByte)(subsample >> 24);
+                *aDest++ = (TByte)(subsample >> 16);
+                *aDest++ = (TByte)(subsample >> 8);
+                *aDest++ = (TByte)subsample;
+            }
+        }
+        break;
+    default:
+        ASSERTS();
+    }
+}
+
+static void InterleaveInt32(const TInt32* const* aSubsamples, TUint aIndex, TUint aNumSamples,
+                            TUint aChannels, TUint aBitDepth, TInt32* aDest)
+{
+    const TUint shift = 32 - aBitDepth;
+    const TUint end = aIndex + aNumSamples;
+    for (TUint i=aIndex; i<end; i++) {
+        for (TUint j=0; j<aChannels; j++) {
+            *aDest++ = (TInt32)((TUint32)aSubsamples[j][i] << shift);
+        }
+    }
+}
+
+TUint64 CodecController::OutputAudioPcmPlanar(const TInt32* const* aSubsamples, TUint aNumSamples, TUint aChannels,
+                                              TUint aSampleRate, TUint aBitDepth, TUint64 aTrackOffset)
+{
+    ASSERT(aChannels == iChannels);
+    ASSERT(aSampleRate == iSampleRate);
+    ASSERT(aBitDepth == iBitDepth);
+
+    const TBool int32 = (iMsgFactory.DecodedPcmStorage() == PcmStorage::Int32);
+    const TUint64 offsetBefore = aTrackOffset;
+    TUint index = 0;
+    while (index < aNumSamples) {
+        TByte* dest;
+        TUint samples;
+        GetAudioBuf(dest, samples);
+        samples = std::min(samples, aNumSamples - index);
+        if (int32) {
+            InterleaveInt32(aSubsamples, index, samples, aChannels, aBitDepth, reinterpret_cast<TInt32*>(dest));
+        }
+        else {
+            InterleavePacked(aSubsamples, index, samples, aChannels, aBitDepth, dest);
+        }
+        iAudioDecodedBytes += samples * iStoredBytesPerSample;
+        OutputAudioDecoded(aTrackOffset);
+        index += samples;
+    }
+
+    return aTrackOffset - offsetBefore;
+}
+
 TUint64 CodecController::DoOutputAudio(MsgAudio* aAudioMsg)
 {
     if (iExpectedFlushId != MsgFlush::kIdInvalid) {
@@ -923,13 +1126,27 @@ void CodecController::GetAudioBuf(TByte*& aDest, TUint& aSamples)
         iAudioDecodedBytes = 0;
     }
     aDest = iAudioDecoded->PtrW() + iAudioDecodedBytes;
-    const auto samplesMsg = (AudioData::kMaxBytes - iAudioDecodedBytes) / iBytesPerSample;
+    const auto samplesMsg = (AudioData::kMaxBytes - iAudioDecodedBytes) / iStoredBytesPerSample;
     aSamples = std::min(iMaxOutputSamples, samplesMsg);
 }
 
 void CodecController::OutputAudioBuf(TUint aSamples, TUint64& aTrackOffset)
 {
-    iAudioDecodedBytes += (aSamples * iBytesPerSample);
+    if (aSamples == 0) {
+        ReleaseAudioDecoded();
+        iAudioDecodedBytes = 0;
+        return;
+    }
+    if (iMsgFactory.DecodedPcmStorage() == PcmStorage::Int32) {
+        // codec wrote packed big endian audio; widen it in place
+        iAudioDecoded->ExpandToInt32(iAudioDecodedBytes, aSamples * iChannels, iBitDepth);
+    }
+    iAudioDecodedBytes += (aSamples * iStoredBytesPerSample);
+    OutputAudioDecoded(aTrackOffset);
+}
+
+void CodecController::OutputAudioDecoded(TUint64& aTrackOffset)
+{
     iAudioDecoded->SetBytes(iAudioDecodedBytes);
     auto audioPcm = iMsgFactory.CreateMsgAudioPcm(iAudioDecoded, iChannels, iSampleRate, iBitDepth, aTrackOffset);
     iAudioDecoded = nullptr; // ownership of reference passed to audioPcm
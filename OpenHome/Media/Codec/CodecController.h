@@ -40,6 +40,18 @@ public:
      *                           Fewer bytes may be returned at the end of a stream.
      */
     virtual void Read(Bwx& aBuf, TUint aBytes) = 0;
+    /**
+     * Read up to a specified number of bytes, returning as soon as any are available.
+     *
+     * As Read() but only blocks until some audio is available rather than until aBytes
+     * have been received.  Intended for codecs whose decoder asks for large reads but
+     * which may be fed small frames at a real-time rate (e.g. Songcast) where waiting
+     * for the full read would add latency.
+     *
+     * @param[in] aBuf           Buffer to write into.  Data is appended to any existing content.
+     * @param[in] aBytes         Maximum number of bytes to read.
+     */
+    virtual void ReadAvailable(Bwx& aBuf, TUint aBytes) = 0;
     /**
      * Read the content of the next audio msg.
      *
@@ -168,6 +180,24 @@ public:
      * @return     Number of jiffies of audio contained in aMsg.
      */
     virtual TUint64 OutputAudioPcm(MsgAudioEncoded* aMsg, TUint aChannels, TUint aSampleRate, TUint aBitDepth, TUint64 aTrackOffset) = 0;
+    /**
+     * Add a block of planar decoded (PCM) audio to the pipeline.
+     *
+     * Audio is interleaved directly into pipeline-owned buffers, so codecs whose decoder
+     * outputs one buffer per channel don't need to assemble packed audio themselves.
+     *
+     * @param[in] aSubsamples    aChannels pointers, each to aNumSamples subsamples for a single
+     *                           channel.  Subsamples are right-justified (sign extended from aBitDepth bits).
+     * @param[in] aNumSamples    Number of samples (per channel) to output.
+     * @param[in] aChannels      Number of channels.  Must be in the range [1..8].
+     * @param[in] aSampleRate    Sample rate.
+     * @param[in] aBitDepth      Number of bits of audio for a single sample for a single channel.
+     * @param[in] aTrackOffset   Offset (in jiffies) into the stream at the start of aSubsamples.
+     *
+     * @return     Number of jiffies of audio contained in aSubsamples.
+     */
+    virtual TUint64 OutputAudioPcmPlanar(const TInt32* const* aSubsamples, TUint aNumSamples, TUint aChannels,
+                                         TUint aSampleRate, TUint aBitDepth, TUint64 aTrackOffset) = 0;
     /**
     * Add a block of DSD audio to the pipeline.
     *
@@ -217,7 +247,24 @@ public:
      * This allows the pipeline to ramp audio down/up to avoid glitches caused by a stream discontinuity. A MsgDecodedStream must follow this.
      */
     virtual void OutputStreamInterrupted() = 0;
+    /**
+     * Retrieve a pipeline-owned buffer that a codec can decode into directly.
+     *
+     * Must be followed by a call to OutputAudioBuf() before the codec outputs any other msg.
+     *
+     * @param[out] aDest         Buffer to write packed, big endian pcm into.
+     * @param[out] aSamples      Maximum number of samples (each of aChannels subsamples at the
+     *                           current stream's bit depth) that may be written to aDest.
+     */
     virtual void GetAudioBuf(TByte*& aDest, TUint& aSamples) = 0;
+    /**
+     * Add audio written to the buffer from GetAudioBuf() to the pipeline.
+     *
+     * @param[in]     aSamples       Number of samples written.  0 releases the buffer without
+     *                               outputting any audio.
+     * @param[in,out] aTrackOffset   Offset (in jiffies) into the stream at the start of the
+     *                               buffer.  Updated to the offset following this audio.
+     */
     virtual void OutputAudioBuf(TUint aSamples, TUint64& aTrackOffset) = 0;
     virtual TUint MaxBitDepth() const = 0;
 };
@@ -280,9 +327,33 @@ public:
        ,kCostMedium
        ,kCostHigh
     };
+    enum class RecognitionHint
+    {
+        Likely,
+        Unknown,
+        Unlikely
+    };
 public:
     virtual ~CodecBase();
 public:
+    /**
+     * Cheaply estimate whether a new audio stream is likely to be handled by this codec.
+     *
+     * Called for every codec before any Recognise() for a stream.  Codecs are then offered
+     * the stream in order Likely, Unknown, Unlikely (by recognition cost within each group)
+     * so that, usually, only one Recognise() runs.  Hints only affect ordering; a codec
+     * returning Unlikely is still offered the stream if no earlier codec recognises it.
+     *
+     * Must not call iController.  The default implementation returns Unknown.
+     *
+     * @param[in] aStreamStart   The first few hundred bytes of the stream (fewer for very
+     *                           short streams; empty for Pcm and Dsd streams).
+     * @param[in] aStreamInfo    Info describing the current encoded stream
+     *
+     * @return     Likely if aStreamStart carries this codec's signature; Unlikely if it
+     *             carries a signature this codec cannot decode; Unknown otherwise.
+     */
+    virtual RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const;
     /**
      * Report whether a new audio stream is handled by this codec.
      *
@@ -341,6 +412,14 @@ public:
 protected:
     CodecBase(const TChar* aId, RecognitionComplexity aRecognitionCost=kCostMedium);
     static SpeakerProfile DeriveProfile(TUint aChannels);
+    /**
+     * Helper for Sniff() implementations that check for a fixed signature in an encoded stream.
+     *
+     * @return     Likely if aSignature appears at aOffset; Unknown if aStreamStart is too
+     *             short to tell; Unlikely otherwise (including all Pcm and Dsd streams).
+     */
+    static RecognitionHint SniffSignature(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo,
+                                          const TChar* aSignature, TUint aOffset = 0);
 private:
     void Construct(ICodecController& aController);
 protected:
@@ -358,6 +437,7 @@ private:
     private: // from ISeekObserver
         void NotifySeekComplete(TUint aHandle, TUint aFlushId) override;
     };
+    static const TUint kSniffBytes = 256;
 public:
     CodecController(MsgFactory& aMsgFactory, IPipelineElementUpstream& aUpstreamElement, IPipelineElementDownstream& aDownstreamElement,
                     IUrlBlockWriter& aUrlBlockWriter, TUint aMaxOutputJiffies, TUint aThreadPriority, TBool aLogger);
@@ -366,21 +446,33 @@ public:
     void Start();
     void SetAnimator(IPipelineAnimator& aAnimator);
     void Flush(TUint aFlushId);
+    /**
+     * Report how much work codec recognition has needed since construction.
+     *
+     * @param[out] aStreams       Number of streams offered to codecs for recognition.
+     * @param[out] aAttempts      Total number of calls to CodecBase::Recognise().
+     * @param[out] aMaxAttempts   Greatest number of calls to Recognise() for a single stream.
+     */
+    void GetRecognitionStats(TUint& aStreams, TUint& aAttempts, TUint& aMaxAttempts) const;
 private:
     void CodecThread();
+    TBool RankCodecs(const EncodedStreamInfo& aStreamInfo, TBool& aStreamEnded);
     void Rewind();
     Msg* PullMsg();
     void Queue(Msg* aMsg);
     TBool QueueTrackData() const;
     void ReleaseAudioEncoded();
     void ReleaseAudioDecoded();
+    void ReadAtLeast(Bwx& aBuf, TUint aBytes, TUint aMinBytes);
     TBool DoRead(Bwx& aBuf, TUint aBytes);
     void DoOutputDecodedStream(MsgDecodedStream* aMsg);
     TUint64 DoOutputAudio(MsgAudio* aAudioMsg);
+    void OutputAudioDecoded(TUint64& aTrackOffset);
 private: // ISeeker
     void StartSeek(TUint aStreamId, TUint aSecondsAbsolute, ISeekObserver& aObserver, TUint& aHandle) override;
 private: // ICodecController
     void Read(Bwx& aBuf, TUint aBytes) override;
+    void ReadAvailable(Bwx& aBuf, TUint aBytes) override;
     void ReadNextMsg(Bwx& aBuf) override;
     MsgAudioEncoded* ReadNextMsg() override;
     TBool Read(IWriter& aWriter, TUint64 aOffset, TUint aBytes) override; // Read an arbitrary amount of data from current stream, out-of-band from pipeline
@@ -391,6 +483,8 @@ private: // ICodecController
     void OutputDecodedStreamDsd(TUint aSampleRate, TUint aNumChannels, const Brx& aCodecName, TUint64 aLength, TUint64 aSampleStart, SpeakerProfile aProfile) override;
     TUint64 OutputAudioPcm(const Brx& aData, TUint aChannels, TUint aSampleRate, TUint aBitDepth, AudioDataEndian aEndian, TUint64 aTrackOffset) override;
     TUint64 OutputAudioPcm(MsgAudioEncoded* aMsg, TUint aChannels, TUint aSampleRate, TUint aBitDepth, TUint64 aTrackOffset) override;
+    TUint64 OutputAudioPcmPlanar(const TInt32* const* aSubsamples, TUint aNumSamples, TUint aChannels,
+                                 TUint aSampleRate, TUint aBitDepth, TUint64 aTrackOffset) override;
     TUint64 OutputAudioDsd(const Brx& aData, TUint aChannels, TUint aSampleRate, TUint aSampleBlockWords, TUint64 aTrackOffset, TUint aPadBytesPerChunk) override;
     TUint64 OutputAudioDsd(MsgAudioEncoded* aMsg, TUint aChannels, TUint aSampleRate, TUint aSampleBlockWords, TUint64 aTrackOffset, TUint aPadBytesPerChunk) override;
     void OutputMetaText(const Brx& aMetaText) override;
@@ -433,6 +527,12 @@ private:
     Mutex iLock;
     Semaphore iShutdownSem;
     std::vector<CodecBase*> iCodecs;
+    std::vector<CodecBase*> iCodecsRanked;  // iCodecs, most likely to recognise current stream first
+    std::vector<CodecBase::RecognitionHint> iCodecHints;
+    Bws<kSniffBytes> iSniffBuf;
+    std::atomic<TUint> iRecogStreams;
+    std::atomic<TUint> iRecogAttempts;
+    std::atomic<TUint> iRecogAttemptsMax;
     ThreadFunctor* iDecoderThread;
     IPipelineAnimator* iAnimator;
     CodecBase* iActiveCodec;
@@ -468,6 +568,7 @@ private:
     TUint iSampleRate;
     TUint iBitDepth;    // Only for detecting out-of-sequence MsgAudioPcm
     TUint iBytesPerSample;
+    TUint iStoredBytesPerSample; // as iBytesPerSample but for audio held in DecodedAudio
     TUint64 iStreamLength;
     TUint64 iStreamPos;
     TUint iTrackId;
@@ -476,6 +577,7 @@ private:
     const TUint iMaxOutputJiffies;
     DecodedAudio* iAudioDecoded;
     TUint iAudioDecodedBytes;
+    Bws<AudioData::kMaxBytes> iEncodedPcm;
     RampType iRamp;
     TUint iInitialSeekPos;
     InitialSeekObserver iInitialSeekObserver;
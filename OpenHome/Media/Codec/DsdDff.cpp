@@ -32,6 +32,7 @@ public:
     CodecDsdDff(IMimeTypeList& aMimeTypeList, TUint aSampleBlockWords, TUint aPadBytesPerChunk);
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo) override;
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const override;
     void StreamInitialise() override;
     void Process() override;
     TBool TrySeek(TUint aStreamId, TUint64 aSample) override;
@@ -95,6 +96,11 @@ CodecDsdDff::CodecDsdDff(IMimeTypeList& aMimeTypeList, TUint aSampleBlockWords,
 }
 
 
+CodecBase::RecognitionHint CodecDsdDff::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    return SniffSignature(aStreamStart, aStreamInfo, "FRM8");
+}
+
 TBool CodecDsdDff::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
     if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
@@ -36,6 +36,7 @@ public:
     CodecDsdDsf(IMimeTypeList& aMimeTypeList, TUint aSampleBlockWords, TUint aPadBytesPerChunk);
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo) override;
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const override;
     void StreamInitialise() override;
     void Process() override;
     TBool TrySeek(TUint aStreamId, TUint64 aSample) override;
@@ -335,6 +336,11 @@ TBool CodecDsdDsf::TrySeek(TUint aStreamId, TUint64 aSample)
     return true;
 }
 
+CodecBase::RecognitionHint CodecDsdDsf::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    return SniffSignature(aStreamStart, aStreamInfo, "DSD ");
+}
+
 TBool CodecDsdDsf::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
 	if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded)
@@ -22,6 +22,7 @@ public:
     CodecDsdRaw(TUint aSampleBlockWords, TUint aPaddingBytes);
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo) override;
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const override;
     void StreamInitialise() override;
     void Process() override;
     TBool TrySeek(TUint aStreamId, TUint64 aSample) override;
@@ -66,6 +67,11 @@ CodecDsdRaw::CodecDsdRaw(TUint aSampleBlockWords, TUint aPaddingBytes)
 {
 }
 
+CodecBase::RecognitionHint CodecDsdRaw::Sniff(const Brx& /*aStreamStart*/, const EncodedStreamInfo& aStreamInfo) const
+{
+    return aStreamInfo.StreamFormat() == EncodedStreamInfo::Format::Dsd? RecognitionHint::Likely : RecognitionHint::Unlikely;
+}
+
 TBool CodecDsdRaw::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
     if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Dsd) {
@@ -25,6 +25,7 @@ public:
     ~CodecFlac();
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo);
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const;
     void StreamInitialise();
     void Process();
     TBool TrySeek(TUint aStreamId, TUint64 aSample);
@@ -48,7 +49,6 @@ public:
     void CallbackError(const FLAC__StreamDecoder* aDecoder,
                        FLAC__StreamDecoderErrorStatus aStatus);
 private:
-    TByte iBuf[DecodedAudio::kMaxBytes];
     FLAC__StreamDecoder* iDecoder;
     Brn iName;
     TUint64 iSampleStart;
@@ -152,6 +152,20 @@ CodecFlac::~CodecFlac()
     FLAC__stream_decoder_delete(iDecoder);
 }
 
+CodecBase::RecognitionHint CodecFlac::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
+        return RecognitionHint::Unlikely;
+    }
+    if (SniffSignature(aStreamStart, aStreamInfo, "fLaC") == RecognitionHint::Likely) {
+        return RecognitionHint::Likely;
+    }
+    if (SniffSignature(aStreamStart, aStreamInfo, "OggS") == RecognitionHint::Likely) {
+        return SniffSignature(aStreamStart, aStreamInfo, "fLaC", 37);
+    }
+    return aStreamStart.Bytes() < 4? RecognitionHint::Unknown : RecognitionHint::Unlikely;
+}
+
 TBool CodecFlac::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
     if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
@@ -301,7 +315,10 @@ FLAC__StreamDecoderReadStatus CodecFlac::CallbackRead(const FLAC__StreamDecoder*
     Bwn buf(aBuffer, *aBytes);
 
     try {
-        iController->Read(buf, *aBytes);
+        // libFLAC asks for far more than a single frame.  Return whatever has arrived so that
+        // frames delivered one per msg at a real-time rate (Songcast) are decoded as they
+        // arrive rather than once several KB have been buffered.
+        iController->ReadAvailable(buf, *aBytes);
         *aBytes = buf.Bytes();
         return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
     }
@@ -357,7 +374,7 @@ FLAC__StreamDecoderWriteStatus CodecFlac::CallbackWrite(const FLAC__StreamDecode
                                                         const TInt32* const aBuffer[])
 {
     const TUint channels = aFrame->header.channels;
-    TUint samplesToWrite = aFrame->header.blocksize;
+    const TUint samplesToWrite = aFrame->header.blocksize;
     const TUint bitDepth = aFrame->header.bits_per_sample;
     const TUint sampleRate = aFrame->header.sample_rate;
     if (iSampleRate != sampleRate || iNumChannels != channels || iBitDepth != bitDepth) {
@@ -376,44 +393,13 @@ FLAC__StreamDecoderWriteStatus CodecFlac::CallbackWrite(const FLAC__StreamDecode
         iStreamMsgDue = false;
     }
     
-    const TUint bytesPerSample = (bitDepth/8) * channels;
-    const TUint maxSamples = sizeof(iBuf) / bytesPerSample;
-    TUint startI=0, endI;
-    while (samplesToWrite > 0) {
-        const TUint samples = (samplesToWrite > maxSamples? maxSamples : samplesToWrite);
-        TByte* p = iBuf;
-        endI = startI + samples;
-        for (TUint i=startI; i<endI; i++) {
-            for (TUint j=0; j<channels; j++) {
-                TUint subsample = aBuffer[j][i];
-                // pipeline audio data is big endian so we might as well convert to that here
-                switch (bitDepth)
-                {
-                case 8:
-                    *p++ = (TByte)subsample;
-                    break;
-                case 16:
-                    *p++ = (TByte)(subsample >> 8);
-                    *p++ = (TByte)subsample;
-                    break;
-                case 24:
-                    *p++ = (TByte)(subsample >> 16);
-                    *p++ = (TByte)(subsample >> 8);
-                    *p++ = (TByte)subsample;
-                    break;
-                default:
-                    Log::Print("Unsupported bit depth in CodecFlac::CallbackWrite - %u\n", bitDepth);
-                    THROW(CodecStreamFeatureUnsupported);
-                }
-            }
-        }
-        const TUint bytes = samples * bytesPerSample;
-        Brn encodedAudio(iBuf, bytes);
-        iTrackOffset += iController->OutputAudioPcm(encodedAudio, channels, sampleRate,
-                                                    bitDepth, AudioDataEndian::Big, iTrackOffset);
-        samplesToWrite -= samples;
-        startI = endI;
+    if (bitDepth != 8 && bitDepth != 16 && bitDepth != 24) {
+        Log::Print("Unsupported bit depth in CodecFlac::CallbackWrite - %u\n", bitDepth);
+        THROW(CodecStreamFeatureUnsupported);
     }
+    // interleave libFLAC's per-channel buffers straight into pipeline audio
+    iTrackOffset += iController->OutputAudioPcmPlanar(aBuffer, samplesToWrite, channels,
+                                                      sampleRate, bitDepth, iTrackOffset);
 
     return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
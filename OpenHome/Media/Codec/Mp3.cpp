@@ -140,6 +140,7 @@ public:
 private: // from CodecBase
     ~CodecMp3();
     TBool Recognise(const EncodedStreamInfo& aStreamInfo);
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const;
     void StreamInitialise();
     void Process();
     TBool TrySeek(TUint aStreamId, TUint64 aSample);
@@ -156,7 +157,6 @@ private:
     Bws<kInBufBytes> iInput;
     TUint64     iTrackLengthJiffies;
     TUint64     iTrackOffset;
-    Bws<DecodedAudio::kMaxBytes> iOutput;
     TBool       iStreamEnded;
     Bws<6*1024> iRecogBuf;
 };
@@ -692,6 +692,19 @@ CodecMp3::~CodecMp3()
 {
 }
 
+CodecBase::RecognitionHint CodecMp3::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
+        return RecognitionHint::Unlikely;
+    }
+    // Recognise() searches for a frame, so only a frame header at the very start is conclusive.
+    // Frame sync is 11 set bits; layer 0 is reserved (and used by ADTS).
+    if (aStreamStart.Bytes() >= 2 && aStreamStart[0] == 0xff && (aStreamStart[1] & 0xe0) == 0xe0 && (aStreamStart[1] & 0x06) != 0) {
+        return RecognitionHint::Likely;
+    }
+    return RecognitionHint::Unknown;
+}
+
 TBool CodecMp3::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
     if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
@@ -723,7 +736,6 @@ void CodecMp3::StreamInitialise()
     mad_frame_init(&iMadFrame);
     mad_synth_init(&iMadSynth);
 
-    iOutput.SetBytes(0);
     // Discard bytes preceeding frame start.
     iInput.SetBytes(0);
     if (iHeaderBytes > 0) {
@@ -749,7 +761,6 @@ void CodecMp3::StreamCompleted()
     //LOG(kCodec, "CodecMp3::Deinitialise\n");
     iHeader.Clear();
     iInput.SetBytes(0);
-    iOutput.SetBytes(0);
     iHeaderBytes = 0;
 
     mad_synth_finish(&iMadSynth);
@@ -775,7 +786,6 @@ TBool CodecMp3::TrySeek(TUint aStreamId, TUint64 aSample)
     TBool canSeek = iController->TrySeekTo(aStreamId, bytes);
     if (canSeek) {
         iInput.SetBytes(0);
-        iOutput.SetBytes(0);
         iSamplesWrittenTotal = aSample;
         iTrackOffset = (aSample * Jiffies::kPerSecond) / iHeader.SampleRate();
         iController->OutputDecodedStream(iHeader.BitRate(), kBitDepth, iHeader.SampleRate(), iHeader.Channels(), iHeader.Name(), iTrackLengthJiffies, aSample, false, DeriveProfile(iHeader.Channels()));
@@ -883,44 +893,31 @@ void CodecMp3::Process()
     }
 
     TUint pcmIndex = 0;
-    do {
-        TUint bytes = samplesToWrite * (kBitDepth/8) * channels;
-        TUint samples = samplesToWrite;
-        TUint outputSpace = iOutput.MaxBytes() - iOutput.Bytes();
-        if (bytes > outputSpace) {
-            samples = outputSpace / (channels * (kBitDepth/8));
-            bytes = samples * (kBitDepth/8) * channels;
+    while (samplesToWrite > 0) {
+        // synthesise straight into pipeline audio; output is always 24-bit
+        TByte* dst;
+        TUint samples;
+        iController->GetAudioBuf(dst, samples);
+        if (samples > samplesToWrite) {
+            samples = samplesToWrite;
         }
-        TByte* dst = const_cast<TByte*>(iOutput.Ptr()) + iOutput.Bytes();
         for (TUint i=pcmIndex; i<pcmIndex+samples; i++) {
             for (TUint j=0; j<channels; j++) {
                 TUint subsample = fixedToPcm(iMadSynth.pcm.samples[j][i]);
-                // output is always 24-bit
                 *dst++ = (TByte)(subsample >> 24);
                 *dst++ = (TByte)(subsample >> 16);
                 *dst++ = (TByte)(subsample >> 8);
             }
         }
+        iController->OutputAudioBuf(samples, iTrackOffset);
         pcmIndex += samples;
-        iOutput.SetBytes(iOutput.Bytes() + bytes);
-        // only output audio when we have data for a full-sized msg.
-        // any data not output now will be picked up the next time round
-        if (iOutput.MaxBytes() - iOutput.Bytes() < (kBitDepth/8) * channels) {
-            iTrackOffset += iController->OutputAudioPcm(iOutput, channels, iHeader.SampleRate(),
-                                                        kBitDepth, AudioDataEndian::Big, iTrackOffset);
-            iOutput.SetBytes(0);
-        }
         iSamplesWrittenTotal += samples;
         samplesToWrite -= samples;
-    } while (samplesToWrite > 0);
+    }
 
     // now propogate any end of stream exception
     // first check we have processed remaining frames of this stream
     if ((iMadStream.md_len == 0) && (iStreamEnded || newStreamStarted)) {
-        if (iOutput.Bytes() > 0) { // only output if there is audio remaining
-            iController->OutputAudioPcm(iOutput, channels, iHeader.SampleRate(),
-                                        kBitDepth, AudioDataEndian::Big, iTrackOffset);
-        }
         if (newStreamStarted) {
             THROW(CodecStreamStart);
         }
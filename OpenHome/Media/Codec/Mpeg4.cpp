@@ -10,7 +10,11 @@
 #include <OpenHome/Media/Debug.h>
 #include <OpenHome/Media/MimeTypeList.h>
 
+#include <openssl/evp.h>
+
+#include <algorithm>
 #include <limits>
+#include <string.h>
 #include <vector>
 
 using namespace OpenHome;
@@ -960,6 +964,125 @@ void Mpeg4BoxStsc::Set(IMsgAudioEncodedCache& aCache, TUint aBoxBytes)
     iBytes = aBoxBytes;
 }
 
+// Mpeg4BoxStss
+
+Mpeg4BoxStss::Mpeg4BoxStss(SeekTable& aSeekTable)
+    : iSeekTable(aSeekTable)
+{
+    Reset();
+}
+
+Msg* Mpeg4BoxStss::Process()
+{
+    // Table of sync samples - seeks must start from one of these.
+
+    while (!Complete()) {
+        if (iState != eNone) {
+            Msg* msg = iCache->Pull();
+            if (msg != nullptr) {
+                return msg;
+            }
+        }
+
+        if (iState == eNone) {
+            iCache->Inspect(iBuf, iBuf.MaxBytes());
+            iState = eVersion;
+        }
+        else if (iState == eVersion) {
+            iOffset += iBuf.Bytes();
+            const TUint version = Converter::BeUint32At(iBuf, 0);
+            if (version != kVersion) {
+                iCache->Discard(iBytes - iOffset);
+                iOffset = iBytes;
+                THROW(MediaMpeg4FileInvalid);
+            }
+            iCache->Inspect(iBuf, iBuf.MaxBytes());
+            iState = eEntries;
+        }
+        else if (iState == eEntries) {
+            iOffset += iBuf.Bytes();
+            iEntries = Converter::BeUint32At(iBuf, 0);
+            iEntryCount = 0;
+            iPrevSampleNumber = 0;
+            if (iEntries > (iBytes - iOffset) / sizeof(TUint32)) {
+                iCache->Discard(iBytes - iOffset);
+                iOffset = iBytes;
+                THROW(MediaMpeg4FileInvalid);
+            }
+            iSeekTable.InitialiseSyncSamples(iEntries);
+
+            if (iEntries > 0) {
+                iCache->Inspect(iBuf, iBuf.MaxBytes());
+                iState = eEntry;
+            }
+            else {
+                iState = eComplete;
+            }
+        }
+        else if (iState == eEntry) {
+            iOffset += iBuf.Bytes();
+            const TUint sampleNumber = Converter::BeUint32At(iBuf, 0);
+            if (sampleNumber <= iPrevSampleNumber) {
+                // sample numbers start from 1 and must increase
+                iCache->Discard(iBytes - iOffset);
+                iOffset = iBytes;
+                THROW(MediaMpeg4FileInvalid);
+            }
+            iSeekTable.SetSyncSample(sampleNumber);
+            iPrevSampleNumber = sampleNumber;
+
+            iEntryCount++;
+            if (iEntryCount < iEntries) {
+                iCache->Inspect(iBuf, iBuf.MaxBytes());
+            }
+            else {
+                if (!Complete()) {
+                    iCache->Discard(iBytes - iOffset);
+                    iOffset = iBytes;
+                    THROW(MediaMpeg4FileInvalid);
+                }
+                iState = eComplete;
+            }
+        }
+        else {
+            // Unhandled state.
+            ASSERTS();
+        }
+    }
+
+    return nullptr;
+}
+
+TBool Mpeg4BoxStss::Complete() const
+{
+    ASSERT(iOffset <= iBytes);
+    return iOffset == iBytes;
+}
+
+void Mpeg4BoxStss::Reset()
+{
+    iCache = nullptr;
+    iState = eNone;
+    iBytes = 0;
+    iOffset = 0;
+    iBuf.SetBytes(0);
+    iEntries = 0;
+    iEntryCount = 0;
+    iPrevSampleNumber = 0;
+}
+
+TBool Mpeg4BoxStss::Recognise(const Brx& aBoxId) const
+{
+    return aBoxId == Brn("stss");
+}
+
+void Mpeg4BoxStss::Set(IMsgAudioEncodedCache& aCache, TUint aBoxBytes)
+{
+    ASSERT(iCache == nullptr);
+    iCache = &aCache;
+    iBytes = aBoxBytes;
+}
+
 // Mpeg4BoxStco
 
 Mpeg4BoxStco::Mpeg4BoxStco(SeekTable& aSeekTable)
@@ -3137,11 +3260,11 @@ void Mpeg4CodecInfo::SetCodecInfo(MsgAudioEncoded* aMsg)
 // Mpeg4BoxMdat
 
 // :MpegWideVineDRM
-// At present, we currently only support WideVine DRM. That requires us to decrypt each MPEG audio-sample in turn.
+// Protected samples are decrypted in place in iSampleBuf, as many complete samples at a time as it holds.
 // Some of the 96/24 FLAC tracks have audio samples over 9216 bytes in length, which is the current maximum size of
 // MsgAuioEncoded. Therefore, require internal buffers to be slightly larger than this value to accomodate the decryption.
 // This complicates the checks upon reaching the end of chunks & the box data itself.
-#define MDAT_HAS_DECRYPTED_AUDIO_TO_EMIT (iDecryptionBuf != nullptr && iDecryptionBuf->Bytes() > AudioData::kMaxBytes)
+#define MDAT_HAS_DECRYPTED_AUDIO_TO_EMIT (iDecryptedBytes > AudioData::kMaxBytes)
 
 Mpeg4BoxMdat::Mpeg4BoxMdat(Optional<IMpegDRMProvider> aDRMProvider,
                            MsgFactory& aMsgFactory,
@@ -3169,17 +3292,16 @@ Mpeg4BoxMdat::Mpeg4BoxMdat(Optional<IMpegDRMProvider> aDRMProvider,
     , iOutOfBandReader(aOutOfBandReader)
     , iStopper(aContainerStopper)
     , iLock("MP4D")
+    , iSampleBuf(nullptr)
+    , iDecryptedBytes(0)
+    , iDecryptionBuf(nullptr)
+    , iEncryptedSamples(aSampleSizeTable, aProtectionDetails)
     , iChunkMsg(nullptr)
 {
     aChunkSeeker.RegisterChunkSeekObserver(*this);
 
     if (iDRMProvider.Ok()) {
-        iSampleBuf     = new Bwh(1024 * 16); // During testing we've found tracks containing samples of 16,299bytes
-        iDecryptionBuf = new Bwh(1024 * 16);
-    }
-    else {
-        iSampleBuf     = nullptr;
-        iDecryptionBuf = nullptr;
+        iSampleBuf = new Bwh(kMaxProtectedSampleBytes);
     }
 
     Reset();
@@ -3242,6 +3364,7 @@ Msg* Mpeg4BoxMdat::Process()
             MsgAudioEncoded* msg = iMetadataProvider.GetMetadata();
             if (iMetadataProvider.Complete()) {
                 iChunk = 0;
+                iChunkBytesSkipped = 0;
 
                 if (!ChunkBytes(&iChunkBytesRemaining)) {
                     msg->RemoveRef();
@@ -3262,13 +3385,15 @@ Msg* Mpeg4BoxMdat::Process()
             {
                 AutoMutex a(iLock);
                 if (iSeek) {
-                    LOG(kCodec, "Mpeg4BoxMdat::Process seek occured iSeekChunk: %u\n", iSeekChunk);
+                    LOG(kCodec, "Mpeg4BoxMdat::Process seek occured iSeekChunk: %u, iSeekChunkBytesToSkip: %u\n", iSeekChunk, iSeekChunkBytesToSkip);
                     // Chunk has changed due to seek.
                     iChunk = iSeekChunk;
 
-                    if (!ChunkBytes(&iChunkBytesRemaining)) {
+                    if (!ChunkBytes(&iChunkBytesRemaining) || iSeekChunkBytesToSkip > iChunkBytesRemaining) {
                         THROW(MediaMpeg4FileInvalid);
                     }
+                    iChunkBytesSkipped = iSeekChunkBytesToSkip;
+                    iChunkBytesRemaining -= iChunkBytesSkipped;
 
                     iFileReadOffset = iBoxStartOffset+Mpeg4BoxHeaderReader::kHeaderBytes;
                     iOffset = iFileReadOffset - Mpeg4BoxHeaderReader::kHeaderBytes - iBoxStartOffset;
@@ -3279,6 +3404,7 @@ Msg* Mpeg4BoxMdat::Process()
 
                     iSeek = false;
                     iSeekChunk = 0;
+                    iSeekChunkBytesToSkip = 0;
                 }
             }
 
@@ -3345,16 +3471,7 @@ Msg* Mpeg4BoxMdat::Process()
             }
         }
         else if (iState == eProtectedChunk) {
-
-            // :MpegWideVineDRM
-            // Reset the state of our decryption buffer.
-            if (MDAT_HAS_DECRYPTED_AUDIO_TO_EMIT) {
-                const Brn remaining(iDecryptionBuf->Ptr() + AudioData::kMaxBytes, iDecryptionBuf->Bytes() - AudioData::kMaxBytes);
-                iDecryptionBuf->Replace(remaining);
-            }
-            else {
-                iDecryptionBuf->SetBytes(0);
-            }
+            DiscardEmittedAudio();
 
             // Next - consume as much audio as possible from the audio stream, while we have space.
             if (iChunkMsg) {
@@ -3380,63 +3497,47 @@ Msg* Mpeg4BoxMdat::Process()
             }
 
             // : MpegWideVineDRM
-            // Read and decrypt MPEG samples one-by-one until we've filled up our available buffer space.
-            ReaderBuffer sampleReader(*iSampleBuf);
-
-            while (true) {
-                const TBool hasReadAllSamples = iSampleIndex >= iSampleSizeTable.Count();
-                if (hasReadAllSamples) {
-                    MoveToNextChunkIfPossible();
-                    break;
-                }
-                // Otherwise, we attempt to decrypt the current sample.
-                const TUint sampleBytes = iSampleSizeTable.SampleSize(iSampleIndex);
-                if (sampleBytes > iDecryptionBuf->MaxBytes()) {
-                    Log::Print("Mpeg4BoxMdat::Process() - ERROR  :: Very large sample detected. We can handle %u bytes, sample was %u bytes\n", iDecryptionBuf->MaxBytes(), sampleBytes);
+            // Find every complete sample we've buffered so that they can all be decrypted in a single pass.
+            const TUint encryptedBytes = iSampleBuf->Bytes() - iDecryptedBytes;
+            const TUint sampleCount = iSampleSizeTable.Count();
+            TUint samples = 0;
+            TUint samplesBytes = 0;
+            while (iSampleIndex + samples < sampleCount) {
+                const TUint sampleBytes = iSampleSizeTable.SampleSize(iSampleIndex + samples);
+                if (sampleBytes > iSampleBuf->MaxBytes()) {
+                    Log::Print("Mpeg4BoxMdat::Process() - ERROR  :: Very large sample detected. We can handle %u bytes, sample was %u bytes\n", iSampleBuf->MaxBytes(), sampleBytes);
                     OnErrorEncountered();
                     THROW(CodecStreamCorrupt);
                 }
-
-                // Otherwise, we attempt to decrypt the current sample.
-                const Brx&  sampleData  = sampleReader.Read(sampleBytes);
-
-                const TBool hasReadFullSample = sampleData.Bytes() == sampleBytes;
-                const TBool hasSpaceToDecrypt = iDecryptionBuf->BytesRemaining() >= sampleData.Bytes();
-
-                if (!hasReadFullSample || !hasSpaceToDecrypt) {
-                    iSampleBuf->Replace(sampleData);
-
-                    if (iChunkMsg == nullptr) {
-                        if (iChunkBytesRemaining > 0) {
-                            iState = eChunk;
-                        }
-                        else {
-                            MoveToNextChunkIfPossible();
-                        }
-                    }
-
+                if (sampleBytes > encryptedBytes - samplesBytes) {
                     break;
                 }
+                samplesBytes += sampleBytes;
+                samples++;
+            }
 
-                const Brx& KID = iProtectionDetails.KID();
-                const Brx&  IV = iProtectionDetails.GetSampleIV(iSampleIndex);
-
-                ASSERT(iDRMProvider.Ok());
+            if (samples > 0) {
+                DecryptSamples(samples, samplesBytes);
+            }
 
-                if (!iDRMProvider.Unwrap().Decrypt(KID, sampleData, IV, *iDecryptionBuf)) {
-                    LOG_ERROR(kCodec, "Mpeg4BoxMdat::Process() - Failed to decrypt content\n");
-                    OnErrorEncountered();
-                    THROW(CodecStreamCorrupt);
+            const TBool hasReadAllSamples = iSampleIndex >= sampleCount;
+            if (hasReadAllSamples) {
+                MoveToNextChunkIfPossible();
+            }
+            else if (iChunkMsg == nullptr) {
+                // Only part of the next sample is buffered. Read the rest of it.
+                if (iChunkBytesRemaining > 0) {
+                    iState = eChunk;
+                }
+                else {
+                    MoveToNextChunkIfPossible();
                 }
-
-                iSampleIndex += 1;
-
             }
 
-            if (iDecryptionBuf->Bytes() > 0) {
+            if (iDecryptedBytes > 0) {
                 // :MpegWideVineDRM
                 // The decryption buffer may contain more data than a MsgAudioEncoded message can handle,
-                const Brn outputData(iDecryptionBuf->Ptr(), std::min(iDecryptionBuf->Bytes(), AudioData::kMaxBytes));
+                const Brn outputData(iSampleBuf->Ptr(), std::min(iDecryptedBytes, AudioData::kMaxBytes));
                 return iMsgFactory.CreateMsgAudioEncoded(outputData);
             }
         }
@@ -3466,7 +3567,9 @@ void Mpeg4BoxMdat::Reset()
     iState = eNone;
     iChunk = 0;
     iSeekChunk = 0;
+    iSeekChunkBytesToSkip = 0;
     iSeek = false;
+    iChunkBytesSkipped = 0;
     iChunkBytesRemaining = 0;
     iBytes = 0;
     iOffset = 0;
@@ -3482,10 +3585,7 @@ void Mpeg4BoxMdat::Reset()
     if (iSampleBuf) {
         iSampleBuf->SetBytes(0);
     }
-
-    if (iDecryptionBuf) {
-        iDecryptionBuf->SetBytes(0);
-    }
+    iDecryptedBytes = 0;
 }
 
 TBool Mpeg4BoxMdat::Recognise(const Brx& aBoxId) const
@@ -3502,11 +3602,12 @@ void Mpeg4BoxMdat::Set(IMsgAudioEncodedCache& aCache, TUint aBoxBytes)
     iFileReadOffset = iBoxStartOffset + Mpeg4BoxHeaderReader::kHeaderBytes;
 }
 
-void Mpeg4BoxMdat::ChunkSeek(TUint aChunk)
+void Mpeg4BoxMdat::ChunkSeek(TUint aChunk, TUint aChunkBytesToSkip)
 {
     AutoMutex a(iLock);
     iSeek = true;
     iSeekChunk = aChunk;
+    iSeekChunkBytesToSkip = aChunkBytesToSkip;
 
     if (iContainerInfo.ProcessingMode() == Mpeg4ContainerInfo::EProcessingMode::Fragmented) {
         // For fragmented files, we are likely moving to a completely different fragment in the file,
@@ -3535,7 +3636,7 @@ TUint Mpeg4BoxMdat::BytesUntilChunk() const
     }
 
     const TUint64 chunkOffset = isFragmentedStream ? iFileReadOffset
-                                                   : iSeekTable.GetOffset(iChunk);
+                                                   : iSeekTable.GetOffset(iChunk) + iChunkBytesSkipped;
 
     if (chunkOffset < iFileReadOffset) {
         THROW(MediaMpeg4FileInvalid);
@@ -3548,20 +3649,11 @@ TUint Mpeg4BoxMdat::BytesUntilChunk() const
 
 TBool Mpeg4BoxMdat::ChunkBytes(TUint *aChunkBytes) const
 {
-    TUint chunkBytes               = 0;
     const TBool isFragmentedStream = iContainerInfo.ProcessingMode() == Mpeg4ContainerInfo::EProcessingMode::Fragmented;
 
+    TUint64 chunkBytes = 0;
     if (isFragmentedStream) {
-        for (TUint i = 0; i < iSampleSizeTable.Count(); i += 1) {
-            const TUint sampleBytes = iSampleSizeTable.SampleSize(i);
-
-            if ((std::numeric_limits<TUint>::max() - chunkBytes) < sampleBytes) {
-                // Wrapping will occur.
-                *aChunkBytes = 0;
-                return false;
-            }
-            chunkBytes += sampleBytes;
-        }
+        chunkBytes = iSampleSizeTable.Bytes(0, iSampleSizeTable.Count());
     }
     else {
         if (iChunk >= iSeekTable.ChunkCount()) {
@@ -3571,19 +3663,15 @@ TBool Mpeg4BoxMdat::ChunkBytes(TUint *aChunkBytes) const
         const TUint chunkSamples = iSeekTable.SamplesPerChunk(iChunk);
         const TUint startSample = iSeekTable.StartSample(iChunk); // NOTE: this assumes first sample == 0 (which is valid with how our tables are setup), but in MPEG4 spec, first sample == 1.
         // Samples start from 1. However, tables here are indexed from 0.
-        for (TUint i = startSample; i < startSample + chunkSamples; i++) {
-            const TUint sampleBytes = iSampleSizeTable.SampleSize(i);
-
-            if ((std::numeric_limits<TUint>::max() - chunkBytes) < sampleBytes) {
-                // Wrapping will occur.
-                *aChunkBytes = 0;
-                return false;
-            }
-            chunkBytes += sampleBytes;
-        }
+        chunkBytes = iSampleSizeTable.Bytes(startSample, chunkSamples);
     }
 
-    *aChunkBytes = chunkBytes;
+    if (chunkBytes > std::numeric_limits<TUint>::max()) {
+        // Wrapping will occur.
+        *aChunkBytes = 0;
+        return false;
+    }
+    *aChunkBytes = static_cast<TUint>(chunkBytes);
     return true;
 }
 
@@ -3610,6 +3698,7 @@ void Mpeg4BoxMdat::MoveToNextChunkIfPossible()
         }
         else {
             iChunk += 1;
+            iChunkBytesSkipped = 0;
 
             if (!ChunkBytes(&iChunkBytesRemaining)) {
                 THROW(MediaMpeg4FileInvalid);
@@ -3634,9 +3723,10 @@ void Mpeg4BoxMdat::OnErrorEncountered()
     iSampleIndex = 0;
 
     // Clear out any pending decrypted content to ensure that we signal completed...
-    if (iDecryptionBuf) {
-        iDecryptionBuf->SetBytes(0);
+    if (iSampleBuf) {
+        iSampleBuf->SetBytes(0);
     }
+    iDecryptedBytes = 0;
 
     // Clear out any dangling message references if we're in the middle of a decyrption cycle...
     if (iChunkMsg) {
@@ -3647,10 +3737,158 @@ void Mpeg4BoxMdat::OnErrorEncountered()
     ASSERT(Complete());
 }
 
+void Mpeg4BoxMdat::DiscardEmittedAudio()
+{
+    // The previous call to Process() output up to AudioData::kMaxBytes of decrypted audio
+    const TUint emitted = std::min(iDecryptedBytes, AudioData::kMaxBytes);
+    if (emitted > 0) {
+        TByte* ptr = const_cast<TByte*>(iSampleBuf->Ptr());
+        const TUint remaining = iSampleBuf->Bytes() - emitted;
+        (void)memmove(ptr, ptr + emitted, remaining);
+        iSampleBuf->SetBytes(remaining);
+        iDecryptedBytes -= emitted;
+    }
+}
+
+void Mpeg4BoxMdat::DecryptSamples(TUint aCount, TUint aBytes)
+{
+    ASSERT(iDRMProvider.Ok());
+    IMpegDRMProvider& provider = iDRMProvider.Unwrap();
+    const Brx& kid = iProtectionDetails.KID();
+    TByte* ptr = const_cast<TByte*>(iSampleBuf->Ptr() + iDecryptedBytes);
+    TBool decrypted = true;
+
+    if (provider.SupportsDecryptInPlace()) {
+        iEncryptedSamples.Set(iSampleIndex, aCount);
+        Bwn samples(ptr, aBytes, aBytes);
+        decrypted = provider.DecryptInPlace(kid, iEncryptedSamples, samples);
+    }
+    else {
+        if (iDecryptionBuf == nullptr) {
+            iDecryptionBuf = new Bwh(kMaxProtectedSampleBytes);
+        }
+        TByte* sample = ptr;
+        for (TUint i = 0; i < aCount && decrypted; i++) {
+            const TUint sampleBytes = iSampleSizeTable.SampleSize(iSampleIndex + i);
+            iDecryptionBuf->SetBytes(0);
+            decrypted = provider.Decrypt(kid, Brn(sample, sampleBytes), iProtectionDetails.GetSampleIV(iSampleIndex + i), *iDecryptionBuf);
+            if (decrypted && iDecryptionBuf->Bytes() != sampleBytes) {
+                decrypted = false;
+            }
+            if (decrypted) {
+                (void)memcpy(sample, iDecryptionBuf->Ptr(), sampleBytes);
+                sample += sampleBytes;
+            }
+        }
+    }
+
+    if (!decrypted) {
+        LOG_ERROR(kCodec, "Mpeg4BoxMdat::Process() - Failed to decrypt content\n");
+        OnErrorEncountered();
+        THROW(CodecStreamCorrupt);
+    }
+    iSampleIndex += aCount;
+    iDecryptedBytes += aBytes;
+}
+
+
+// Mpeg4EncryptedSampleRange
+
+Mpeg4EncryptedSampleRange::Mpeg4EncryptedSampleRange(SampleSizeTable& aSampleSizeTable, Mpeg4ProtectionDetails& aProtectionDetails)
+    : iSampleSizeTable(aSampleSizeTable)
+    , iProtectionDetails(aProtectionDetails)
+    , iFirstSample(0)
+    , iCount(0)
+{
+}
+
+void Mpeg4EncryptedSampleRange::Set(TUint aFirstSample, TUint aCount)
+{
+    iFirstSample = aFirstSample;
+    iCount = aCount;
+}
+
+TUint Mpeg4EncryptedSampleRange::Count() const
+{
+    return iCount;
+}
+
+TUint Mpeg4EncryptedSampleRange::Bytes(TUint aIndex) const
+{
+    ASSERT(aIndex < iCount);
+    return iSampleSizeTable.SampleSize(iFirstSample + aIndex);
+}
+
+const Brx& Mpeg4EncryptedSampleRange::IV(TUint aIndex)
+{
+    ASSERT(aIndex < iCount);
+    return iProtectionDetails.GetSampleIV(iFirstSample + aIndex);
+}
+
+
+// Mpeg4CencDecryptor
+
+Mpeg4CencDecryptor::Mpeg4CencDecryptor()
+    : iKeySet(false)
+{
+    iCtx = EVP_CIPHER_CTX_new();
+    ASSERT(iCtx != nullptr);
+}
+
+Mpeg4CencDecryptor::~Mpeg4CencDecryptor()
+{
+    EVP_CIPHER_CTX_free(iCtx);
+}
+
+void Mpeg4CencDecryptor::SetKey(const Brx& aKey)
+{
+    ASSERT(aKey.Bytes() == kKeyBytes);
+    // The key schedule is set up once here. Each sample then only needs to reset the counter.
+    iKeySet = (EVP_DecryptInit_ex(iCtx, EVP_aes_128_ctr(), nullptr, aKey.Ptr(), nullptr) == 1);
+}
+
+TBool Mpeg4CencDecryptor::Decrypt(const Brx& aIV, Bwx& aSample)
+{
+    return Decrypt(aIV, const_cast<TByte*>(aSample.Ptr()), aSample.Bytes());
+}
+
+TBool Mpeg4CencDecryptor::Decrypt(IMpeg4EncryptedSamples& aSamples, Bwx& aData)
+{
+    TByte* ptr = const_cast<TByte*>(aData.Ptr());
+    TUint remaining = aData.Bytes();
+    const TUint count = aSamples.Count();
+    for (TUint i = 0; i < count; i++) {
+        const TUint bytes = aSamples.Bytes(i);
+        if (bytes > remaining || !Decrypt(aSamples.IV(i), ptr, bytes)) {
+            return false;
+        }
+        ptr += bytes;
+        remaining -= bytes;
+    }
+    return remaining == 0;
+}
+
+TBool Mpeg4CencDecryptor::Decrypt(const Brx& aIV, TByte* aData, TUint aBytes)
+{
+    if (!iKeySet || aIV.Bytes() != kIVBytes) {
+        return false;
+    }
+    // 'cenc' uses the IV as the initial counter block, restarting for every sample
+    if (EVP_DecryptInit_ex(iCtx, nullptr, nullptr, nullptr, aIV.Ptr()) != 1) {
+        return false;
+    }
+    int decrypted = 0;
+    if (EVP_DecryptUpdate(iCtx, aData, &decrypted, aData, static_cast<int>(aBytes)) != 1) {
+        return false;
+    }
+    return decrypted == static_cast<int>(aBytes);
+}
+
 
 // SampleSizeTable
 
 SampleSizeTable::SampleSizeTable()
+    : iTotalBytes(0)
 {
     WriteInit();
 }
@@ -3664,11 +3902,14 @@ void SampleSizeTable::Init(TUint aMaxEntries)
 {
     ASSERT(iTable.size() == 0);
     iTable.reserve(aMaxEntries);
+    iIndex.reserve(aMaxEntries / kIndexInterval + 1);
 }
 
 void SampleSizeTable::Clear()
 {
     iTable.clear();
+    iIndex.clear();
+    iTotalBytes = 0;
 }
 
 void SampleSizeTable::Reset()
@@ -3683,7 +3924,11 @@ void SampleSizeTable::AddSampleSize(TUint aSize)
         // File contains more sample sizes than it reported (and than we reserved capacity for).
         THROW(MediaMpeg4FileInvalid);
     }
+    if (iTable.size() % kIndexInterval == 0) {
+        iIndex.push_back(iTotalBytes);
+    }
     iTable.push_back(aSize);
+    iTotalBytes += aSize;
 }
 
 TUint32 SampleSizeTable::SampleSize(TUint aIndex) const
@@ -3709,6 +3954,27 @@ TUint32 SampleSizeTable::Count() const
     return iTable.size();
 }
 
+TUint64 SampleSizeTable::Bytes(TUint aIndex, TUint aCount) const
+{
+    if (aIndex > iTable.size() || aCount > iTable.size() - aIndex) {
+        THROW(MediaMpeg4FileInvalid);
+    }
+    return BytesBefore(aIndex + aCount) - BytesBefore(aIndex);
+}
+
+TUint64 SampleSizeTable::BytesBefore(TUint aIndex) const
+{
+    if (aIndex == iTable.size()) {
+        return iTotalBytes;
+    }
+    const TUint indexEntry = aIndex / kIndexInterval;
+    TUint64 bytes = iIndex[indexEntry];
+    for (TUint i = indexEntry * kIndexInterval; i < aIndex; i++) {
+        bytes += iTable[i];
+    }
+    return bytes;
+}
+
 void SampleSizeTable::WriteInit()
 {
     iWriteIndex = 0;
@@ -3767,6 +4033,11 @@ void SeekTable::InitialiseOffsets(TUint aEntries)
     iOffsets.reserve(aEntries);
 }
 
+void SeekTable::InitialiseSyncSamples(TUint aEntries)
+{
+    iSyncSamples.reserve(aEntries);
+}
+
 TBool SeekTable::Initialised() const
 {
     const TBool initialised = iSamplesPerChunk.size() > 0
@@ -3779,20 +4050,36 @@ void SeekTable::Deinitialise()
     iSamplesPerChunk.clear();
     iAudioSamplesPerSample.clear();
     iOffsets.clear();
+    iSyncSamples.clear();
 }
 
 void SeekTable::SetSamplesPerChunk(TUint aFirstChunk, TUint aSamplesPerChunk,
         TUint aSampleDescriptionIndex)
 {
     TSamplesPerChunkEntry entry = { aFirstChunk, aSamplesPerChunk,
-            aSampleDescriptionIndex };
+            aSampleDescriptionIndex, 0 };
+    if (iSamplesPerChunk.size() > 0) {
+        const TSamplesPerChunkEntry& prev = iSamplesPerChunk.back();
+        // Runs must be in chunk order for lookups to work.  Treat any that aren't as empty.
+        if (entry.iFirstChunk < prev.iFirstChunk) {
+            entry.iFirstChunk = prev.iFirstChunk;
+        }
+        entry.iFirstSample = prev.iFirstSample
+                           + static_cast<TUint64>(entry.iFirstChunk - prev.iFirstChunk) * prev.iSamples;
+    }
     iSamplesPerChunk.push_back(entry);
 }
 
 void SeekTable::SetAudioSamplesPerSample(TUint32 aSampleCount,
         TUint32 aAudioSamples)
 {
-    TAudioSamplesPerSampleEntry entry = { aSampleCount, aAudioSamples };
+    TAudioSamplesPerSampleEntry entry = { aSampleCount, aAudioSamples, 0, 0 };
+    if (iAudioSamplesPerSample.size() > 0) {
+        const TAudioSamplesPerSampleEntry& prev = iAudioSamplesPerSample.back();
+        entry.iFirstSample = prev.iFirstSample + prev.iSampleCount;
+        entry.iFirstAudioSample = prev.iFirstAudioSample
+                                + static_cast<TUint64>(prev.iSampleCount) * prev.iAudioSamples;
+    }
     iAudioSamplesPerSample.push_back(entry);
 }
 
@@ -3801,6 +4088,15 @@ void SeekTable::SetOffset(TUint64 aOffset)
     iOffsets.push_back(aOffset);
 }
 
+void SeekTable::SetSyncSample(TUint aSampleNumber)
+{
+    const TUint sample = aSampleNumber - 1;
+    if (aSampleNumber == 0 || (iSyncSamples.size() > 0 && sample <= iSyncSamples.back())) {
+        THROW(MediaMpeg4FileInvalid);
+    }
+    iSyncSamples.push_back(sample);
+}
+
 TUint SeekTable::ChunkCount() const
 {
     return iOffsets.size();
@@ -3813,57 +4109,23 @@ TUint SeekTable::AudioSamplesPerSample() const
 
 TUint SeekTable::SamplesPerChunk(TUint aChunkIndex) const
 {
-    //ASSERT(aChunkIndex < iSamplesPerChunk.size());
-    //return iSamplesPerChunk[aChunkIndex];
-
-    // FIXME - don't move through loop backwards.
-    TUint current = iSamplesPerChunk.size() - 1;
-    for (;;) {
-        // Note: aChunkIndex = 0 => iFirstChunk = 1
-        if (iSamplesPerChunk[current].iFirstChunk <= aChunkIndex + 1) {
-            return iSamplesPerChunk[current].iSamples;
-        }
-        ASSERT(current != 0);
-        current--;
-    }
+    // Note: aChunkIndex = 0 => iFirstChunk = 1
+    const TUint chunk = aChunkIndex + 1;
+    auto it = std::upper_bound(iSamplesPerChunk.cbegin(), iSamplesPerChunk.cend(), chunk,
+                               [](TUint aValue, const TSamplesPerChunkEntry& aEntry) { return aValue < aEntry.iFirstChunk; });
+    ASSERT(it != iSamplesPerChunk.cbegin());
+    return (it - 1)->iSamples;
 }
 
 TUint SeekTable::StartSample(TUint aChunkIndex) const
 {
     // NOTE: chunk indexes passed in start from 0, but chunks referenced within seek table start from 1.
-    TUint startSample = 0;
-    const TUint desiredChunk = aChunkIndex + 1;
-    TUint prevFirstChunk = 1;
-    TUint prevSamples = 0;
-    for (TUint i = 0; i < iSamplesPerChunk.size(); i++) {
-        const TUint nextFirstChunk = iSamplesPerChunk[i].iFirstChunk;
-        const TUint nextSamples = iSamplesPerChunk[i].iSamples;
-
-        // Desired chunk was within last chunk range.
-        if (nextFirstChunk >= desiredChunk) {
-            const TUint chunkDiff = desiredChunk - prevFirstChunk;
-            startSample += chunkDiff * prevSamples;
-            prevFirstChunk = nextFirstChunk;
-            prevSamples = nextSamples;
-            break;
-        }
-
-        const TUint chunkDiff = nextFirstChunk - prevFirstChunk;
-        startSample += chunkDiff * prevSamples;
-        prevFirstChunk = nextFirstChunk;
-        prevSamples = nextSamples;
-    }
-
-    // See if exhausted samples per chunk table without encountering desired chunk.
-    if (prevFirstChunk < desiredChunk) {
-        const TUint chunkDiff = desiredChunk - prevFirstChunk;
-        startSample += chunkDiff * prevSamples;
-    }
-
-    return startSample;
+    const TUint64 startSample = CodecSampleFromChunk(aChunkIndex + 1);
+    ASSERT(startSample <= std::numeric_limits<TUint>::max());
+    return static_cast<TUint>(startSample);
 }
 
-TUint64 SeekTable::Offset(TUint64& aAudioSample, TUint64& aSample)
+TUint64 SeekTable::Offset(TUint64& aAudioSample, TUint64& aSample, const SampleSizeTable& aSampleSizes) const
 {
     if (iSamplesPerChunk.size() == 0 || iAudioSamplesPerSample.size() == 0
             || iOffsets.size() == 0) {
@@ -3871,24 +4133,24 @@ TUint64 SeekTable::Offset(TUint64& aAudioSample, TUint64& aSample)
     }
 
     const TUint64 codecSampleFromAudioSample = CodecSample(aAudioSample);
+    const TUint64 syncSample = SyncSample(codecSampleFromAudioSample);
 
-    // FIXME - if stss box was present, must use it here to find appropriate sync sample.
-    // If stss box not present all codec samples are sync samples.
-
-    const TUint chunk = Chunk(codecSampleFromAudioSample);
-    // FIXME - could go one step further and use chunk-to-sample table to find offset of desired sample within desired chunk.
-    const TUint codecSampleFromChunk = CodecSampleFromChunk(chunk);
-    const TUint audioSampleFromCodecSample = AudioSampleFromCodecSample(
-            codecSampleFromChunk);
+    const TUint chunk = Chunk(syncSample);
+    if (chunk == 0 || chunk >= iOffsets.size()+1) { // error - required chunk doesn't exist
+        THROW(MediaMpeg4OutOfRange);
+    }
+    // The sync sample needn't be the first in its chunk.  Skip over any samples that precede it.
+    const TUint64 codecSampleFromChunk = CodecSampleFromChunk(chunk);
+    ASSERT(syncSample >= codecSampleFromChunk);
+    ASSERT(syncSample <= std::numeric_limits<TUint>::max());
+    const TUint64 bytesIntoChunk = aSampleSizes.Bytes(static_cast<TUint>(codecSampleFromChunk),
+                                                      static_cast<TUint>(syncSample - codecSampleFromChunk));
 
-    aAudioSample = audioSampleFromCodecSample;
-    aSample = codecSampleFromChunk;
+    aAudioSample = AudioSampleFromCodecSample(syncSample);
+    aSample = syncSample;
 
     //stco:
-    if (chunk >= iOffsets.size()+1) { // error - required chunk doesn't exist
-        THROW(MediaMpeg4OutOfRange);
-    }
-    return iOffsets[chunk - 1]; // entry found - return offset to required chunk
+    return iOffsets[chunk - 1] + bytesIntoChunk;
 }
 
 TUint64 SeekTable::GetOffset(TUint aChunkIndex) const
@@ -3906,6 +4168,7 @@ void SeekTable::WriteInit()
     iSpcWriteIndex      = 0;
     iAspsWriteIndex     = 0;
     iOffsetsWriteIndex  = 0;
+    iSyncWriteIndex     = 0;
 }
 
 void SeekTable::Write(IWriter& aWriter, TUint aMaxBytes)
@@ -3969,184 +4232,156 @@ void SeekTable::Write(IWriter& aWriter, TUint aMaxBytes)
         bytesLeftToWrite -= sizeof(TUint64);
         iOffsetsWriteIndex++;
     }
+
+    const TUint syncSampleCount = iSyncSamples.size();
+    if (iSyncWriteIndex == 0) {
+        if (bytesLeftToWrite < sizeof(TUint32)) {
+            return;
+        }
+        writerBin.WriteUint32Be(syncSampleCount);
+        bytesLeftToWrite -= sizeof(TUint32);
+    }
+
+    while (iSyncWriteIndex < syncSampleCount) {
+        if (bytesLeftToWrite < sizeof(TUint32)) {
+            return;
+        }
+        writerBin.WriteUint32Be(iSyncSamples[iSyncWriteIndex] + 1); // numbered from 1, as in stss
+        bytesLeftToWrite -= sizeof(TUint32);
+        iSyncWriteIndex++;
+    }
 }
 
 TBool SeekTable::WriteComplete() const
 {
     return (iSpcWriteIndex == iSamplesPerChunk.size()) &&
            (iAspsWriteIndex == iAudioSamplesPerSample.size()) &&
-           (iOffsetsWriteIndex == iOffsets.size());
+           (iOffsetsWriteIndex == iOffsets.size()) &&
+           (iSyncWriteIndex == iSyncSamples.size());
 }
 
 TUint64 SeekTable::CodecSample(TUint64 aAudioSample) const
 {
     // Use entries from stts box to find codec sample that contains the desired
     // audio sample.
-    TUint64 totalCodecSamples = 0;
-    TUint64 totalAudioSamples = 0;
-    for (TUint entry = 0; entry < iAudioSamplesPerSample.size(); entry++) {
-        const TUint sampleCount = iAudioSamplesPerSample[entry].iSampleCount;
-        const TUint audioSamples = iAudioSamplesPerSample[entry].iAudioSamples;
-        const TUint audioSamplesInrange = sampleCount * audioSamples;
-        if (aAudioSample <= totalCodecSamples + audioSamplesInrange) {
-            // Audio samples are within this range.
-
-            // Find codec sample in this range that contains given audio sample.
-            ASSERT(aAudioSample >= totalAudioSamples);
-            const TUint64 audioSampleOffset = aAudioSample - totalAudioSamples;
-            const TUint64 codecSampleOffset = audioSampleOffset / audioSamples;
-            ASSERT(codecSampleOffset <= sampleCount);
-
-            totalCodecSamples += codecSampleOffset;
-            return totalCodecSamples;
-        }
-        totalCodecSamples += sampleCount;
-        totalAudioSamples += audioSamplesInrange;
-    }
-
+    const TUint64 totalAudioSamples = AudioSamplesTotal();
     if (aAudioSample > totalAudioSamples) {
         THROW(MediaMpeg4OutOfRange);
     }
+    if (iAudioSamplesPerSample.size() == 0) {
+        LOG(kCodec, "SeekTable::CodecSample could not find aAudioSample: %llu\n", aAudioSample);
+        THROW(MediaMpeg4FileInvalid);
+    }
+    const TAudioSamplesPerSampleEntry& last = iAudioSamplesPerSample.back();
+    if (aAudioSample == totalAudioSamples) {
+        return last.iFirstSample + last.iSampleCount;
+    }
 
-    // Something went wrong. Could be corrupt table or programmer error!
-    LOG(kCodec, "SeekTable::CodecSample could not find aAudioSample: %u\n", aAudioSample);
-    THROW(MediaMpeg4FileInvalid);
+    // Find the last run starting at or before aAudioSample.  Runs of no audio samples share their
+    // start with the following run so are skipped over.
+    auto it = std::upper_bound(iAudioSamplesPerSample.cbegin(), iAudioSamplesPerSample.cend(), aAudioSample,
+                               [](TUint64 aSample, const TAudioSamplesPerSampleEntry& aEntry) { return aSample < aEntry.iFirstAudioSample; });
+    ASSERT(it != iAudioSamplesPerSample.cbegin());
+    const TAudioSamplesPerSampleEntry& entry = *(it - 1);
+    const TUint64 codecSampleOffset = (aAudioSample - entry.iFirstAudioSample) / entry.iAudioSamples;
+    ASSERT(codecSampleOffset < entry.iSampleCount);
+    return entry.iFirstSample + codecSampleOffset;
 }
 
-TUint SeekTable::SamplesPerChunkTotal(TUint aIndex) const
+TUint64 SeekTable::SyncSample(TUint64 aCodecSample) const
 {
-    // Calculates chunks*samples_per_chunk at given index in samples-per-chunk
-    // table.
-    ASSERT(aIndex < iSamplesPerChunk.size());
-    const TUint startChunk = iSamplesPerChunk[aIndex].iFirstChunk;
-    const TUint spc = iSamplesPerChunk[aIndex].iSamples;
-    TUint endChunk = 0;
-
-    // Find last chunk in current run.
-    if (aIndex + 1 < iSamplesPerChunk.size()) {
-        endChunk = iSamplesPerChunk[aIndex + 1].iFirstChunk;
+    if (iSyncSamples.size() == 0) {
+        return aCodecSample;
     }
-    else {
-        // No next entry, so end chunk must be last chunk in file.
-        // Since chunk numbers start at one, must be chunk_count+1.
-        endChunk = iOffsets.size()+1;
+    auto it = std::upper_bound(iSyncSamples.cbegin(), iSyncSamples.cend(), aCodecSample);
+    if (it == iSyncSamples.cbegin()) {
+        // No sync sample this early.  Decoding can only start from the first one.
+        return iSyncSamples[0];
     }
+    return *(it - 1);
+}
 
-    const TUint chunkDiff = endChunk - startChunk;
-    const TUint samplesInRange = chunkDiff * spc;
-
-    return samplesInRange;
+TUint64 SeekTable::CodecSamplesTotal() const
+{
+    if (iSamplesPerChunk.size() == 0) {
+        return 0;
+    }
+    // Last run continues to the last chunk in the file.
+    // Since chunk numbers start at one, chunk after the last is chunk_count+1.
+    const TSamplesPerChunkEntry& last = iSamplesPerChunk.back();
+    const TUint endChunk = iOffsets.size() + 1;
+    if (endChunk <= last.iFirstChunk) {
+        return last.iFirstSample;
+    }
+    return last.iFirstSample + static_cast<TUint64>(endChunk - last.iFirstChunk) * last.iSamples;
 }
 
-TUint SeekTable::ChunkWithinSamplesPerChunk(TUint aIndex, TUint aSampleOffset) const
+TUint64 SeekTable::AudioSamplesTotal() const
 {
-    ASSERT(aIndex < iSamplesPerChunk.size());
-    const TUint chunk = iSamplesPerChunk[aIndex].iFirstChunk;
-    const TUint spc = iSamplesPerChunk[aIndex].iSamples;
-    const TUint chunkOffset = static_cast<TUint>(aSampleOffset / spc);
-    return chunk + chunkOffset;
+    if (iAudioSamplesPerSample.size() == 0) {
+        return 0;
+    }
+    const TAudioSamplesPerSampleEntry& last = iAudioSamplesPerSample.back();
+    return last.iFirstAudioSample + static_cast<TUint64>(last.iSampleCount) * last.iAudioSamples;
 }
 
 TUint SeekTable::Chunk(TUint64 aCodecSample) const
 {
     // Use data from stsc box to find chunk containing the desired codec sample.
-    TUint64 totalSamples = 0;
-    for (TUint entry = 0; entry < iSamplesPerChunk.size(); entry++) {
-        const TUint samplesInRange = SamplesPerChunkTotal(entry);
-        if (aCodecSample < totalSamples + samplesInRange) {
-            // Desired sample is in this range.
-
-            // Find chunk in this range that contains the desired sample.
-            ASSERT(aCodecSample >= totalSamples);
-            const TUint64 sampleOffset64 = aCodecSample - totalSamples;
-            ASSERT(sampleOffset64 <= std::numeric_limits<TUint>::max());  // Ensure no issues with casting to smaller type.
-            const TUint sampleOffset = static_cast<TUint>(sampleOffset64);
-            const TUint chunk = ChunkWithinSamplesPerChunk(entry, sampleOffset);
-
-            return chunk;
-        }
-
-        totalSamples += samplesInRange;
-    }
-
+    const TUint64 totalSamples = CodecSamplesTotal();
     if (aCodecSample > totalSamples) {
         THROW(MediaMpeg4OutOfRange);
     }
-
-    LOG(kCodec, "SeekTable::Chunk could not find aCodecSample: %u\n", aCodecSample);
-    THROW(MediaMpeg4FileInvalid);
-}
-
-TUint SeekTable::CodecSampleFromChunk(TUint aChunk) const
-{
-    // Use data from stsc box to find chunk containing the desired codec sample.
-    TUint totalSamples = 0;
-    TUint chunk = 1;
-    for (TUint entry = 0; entry < iSamplesPerChunk.size(); entry++) {
-        const TUint startChunk = iSamplesPerChunk[entry].iFirstChunk;
-        const TUint spc = iSamplesPerChunk[entry].iSamples;
-        TUint endChunk = 0;
-
-        // Find last chunk in current run.
-        if (entry + 1 < iSamplesPerChunk.size()) {
-            endChunk = iSamplesPerChunk[entry + 1].iFirstChunk;
-        }
-        else {
-            // No next entry, so end chunk must be last chunk in file.
-            endChunk = iOffsets.size();
-        }
-
-        const TUint chunkDiff = endChunk - startChunk;
-        const TUint samplesInRange = chunkDiff * spc;
-
-        if (aChunk <= endChunk) {
-            // Desired chunk is in this range.
-
-            const TUint chunkOffset = aChunk - startChunk;
-            const TUint sampleOffset = chunkOffset * spc;
-            totalSamples += sampleOffset;
-            return totalSamples;
-        }
-
-        totalSamples += samplesInRange;
-        chunk = startChunk;
+    if (aCodecSample == totalSamples) {
+        LOG(kCodec, "SeekTable::Chunk could not find aCodecSample: %llu\n", aCodecSample);
+        THROW(MediaMpeg4FileInvalid);
     }
 
-    if (aChunk > chunk) {
-        THROW(MediaMpeg4OutOfRange);
+    // Find the last run starting at or before aCodecSample.  Empty runs share their
+    // start with the following run so are skipped over.
+    auto it = std::upper_bound(iSamplesPerChunk.cbegin(), iSamplesPerChunk.cend(), aCodecSample,
+                               [](TUint64 aSample, const TSamplesPerChunkEntry& aEntry) { return aSample < aEntry.iFirstSample; });
+    ASSERT(it != iSamplesPerChunk.cbegin());
+    const TSamplesPerChunkEntry& entry = *(it - 1);
+    const TUint64 chunkOffset = (aCodecSample - entry.iFirstSample) / entry.iSamples;
+    ASSERT(chunkOffset <= std::numeric_limits<TUint>::max() - entry.iFirstChunk);
+    return entry.iFirstChunk + static_cast<TUint>(chunkOffset);
+}
+
+TUint64 SeekTable::CodecSampleFromChunk(TUint aChunk) const
+{
+    // Use data from stsc box to find the first codec sample in the desired chunk.
+    // Chunks before the first run are treated as empty.
+    auto it = std::upper_bound(iSamplesPerChunk.cbegin(), iSamplesPerChunk.cend(), aChunk,
+                               [](TUint aValue, const TSamplesPerChunkEntry& aEntry) { return aValue < aEntry.iFirstChunk; });
+    if (it == iSamplesPerChunk.cbegin()) {
+        return 0;
     }
-
-    LOG(kCodec, "SeekTable::CodecSampleFromChunk could not find aCodecSample: %u\n", aChunk);
-    THROW(MediaMpeg4FileInvalid);
+    const TSamplesPerChunkEntry& entry = *(it - 1);
+    return entry.iFirstSample + static_cast<TUint64>(aChunk - entry.iFirstChunk) * entry.iSamples;
 }
 
-TUint SeekTable::AudioSampleFromCodecSample(TUint aCodecSample) const
+TUint64 SeekTable::AudioSampleFromCodecSample(TUint64 aCodecSample) const
 {
     // Use entries from stts box to find audio sample that start at given codec sample;
-    TUint totalCodecSamples = 0;
-    for (TUint entry = 0; entry < iAudioSamplesPerSample.size(); entry++) {
-        const TUint sampleCount = iAudioSamplesPerSample[entry].iSampleCount;
-        const TUint audioSamples = iAudioSamplesPerSample[entry].iAudioSamples;
-        if (aCodecSample <= totalCodecSamples + sampleCount) {
-            // Codec sample is within this range.
-
-            // Find the number of audio samples at the start of the given codec sample.
-            ASSERT(totalCodecSamples <= aCodecSample);
-            const TUint codecSampleOffset = aCodecSample - totalCodecSamples;
-            const TUint audioSampleOffset = codecSampleOffset * audioSamples;
-
-            return audioSampleOffset;
-        }
-        totalCodecSamples += sampleCount;
+    if (iAudioSamplesPerSample.size() == 0) {
+        LOG(kCodec, "SeekTable::AudioSampleFromCodecSample could not find aCodecSample: %llu\n", aCodecSample);
+        THROW(MediaMpeg4FileInvalid);
     }
-
+    const TAudioSamplesPerSampleEntry& last = iAudioSamplesPerSample.back();
+    const TUint64 totalCodecSamples = last.iFirstSample + last.iSampleCount;
     if (aCodecSample > totalCodecSamples) {
         THROW(MediaMpeg4OutOfRange);
     }
+    if (aCodecSample == totalCodecSamples) {
+        return AudioSamplesTotal();
+    }
 
-    // Something went wrong. Could be corrupt table or programmer error!
-    LOG(kCodec, "SeekTable::AudioSampleFromCodecSample could not find aCodecSample: %u\n", aCodecSample);
-    THROW(MediaMpeg4FileInvalid);
+    auto it = std::upper_bound(iAudioSamplesPerSample.cbegin(), iAudioSamplesPerSample.cend(), aCodecSample,
+                               [](TUint64 aSample, const TAudioSamplesPerSampleEntry& aEntry) { return aSample < aEntry.iFirstSample; });
+    ASSERT(it != iAudioSamplesPerSample.cbegin());
+    const TAudioSamplesPerSampleEntry& entry = *(it - 1);
+    return entry.iFirstAudioSample + (aCodecSample - entry.iFirstSample) * entry.iAudioSamples;
 }
 
 
@@ -4188,10 +4423,140 @@ void SeekTableInitialiser::Init()
         const TUint64 offset = readerBin.ReadUint64Be(8);
         iSeekTable.SetOffset(offset);
     }
+
+    const TUint syncSampleCount = readerBin.ReadUintBe(4);
+    iSeekTable.InitialiseSyncSamples(syncSampleCount);
+    for (TUint i = 0; i < syncSampleCount; i++) {
+        const TUint sampleNumber = readerBin.ReadUintBe(4);
+        iSeekTable.SetSyncSample(sampleNumber);
+    }
     iInitialised = true;
 }
 
 
+// Mpeg4SampleTables
+
+Mpeg4SampleTables::Mpeg4SampleTables()
+    : iRefCount(1)
+{
+}
+
+void Mpeg4SampleTables::AddRef()
+{
+    iRefCount++;
+}
+
+void Mpeg4SampleTables::RemoveRef()
+{
+    if (--iRefCount == 0) {
+        delete this;
+    }
+}
+
+SampleSizeTable& Mpeg4SampleTables::SampleSizes()
+{
+    return iSampleSizes;
+}
+
+SeekTable& Mpeg4SampleTables::Seek()
+{
+    return iSeek;
+}
+
+
+// Mpeg4SampleTablesRegistry
+
+Mpeg4SampleTablesRegistry::Entry Mpeg4SampleTablesRegistry::iEntries[kMaxEntries];
+std::atomic<TUint> Mpeg4SampleTablesRegistry::iNextId(kIdNone + 1);
+
+TUint Mpeg4SampleTablesRegistry::Register(Mpeg4SampleTables& aTables)
+{ // static
+    for (TUint i = 0; i < kMaxEntries; i++) {
+        Entry& entry = iEntries[i];
+        TBool used = false;
+        if (entry.iUsed.compare_exchange_strong(used, true)) {
+            TUint id;
+            do { // skip values that can't be told apart from no id or from serialised tables
+                id = iNextId++;
+            } while (id == kIdNone || id == kMarker);
+            aTables.AddRef();
+            entry.iTables = &aTables;
+            entry.iId.store(id);
+            return id;
+        }
+    }
+    return kIdNone;
+}
+
+void Mpeg4SampleTablesRegistry::Deregister(TUint aId)
+{ // static
+    if (aId == kIdNone) {
+        return;
+    }
+    for (TUint i = 0; i < kMaxEntries; i++) {
+        Entry& entry = iEntries[i];
+        if (entry.iId.load() == aId) {
+            Mpeg4SampleTables* tables = entry.iTables;
+            entry.iId.store(kIdNone);
+            entry.iTables = nullptr;
+            entry.iUsed.store(false);
+            tables->RemoveRef();
+            return;
+        }
+    }
+    ASSERTS();
+}
+
+Mpeg4SampleTables* Mpeg4SampleTablesRegistry::Claim(TUint aId)
+{ // static
+    if (aId == kIdNone) {
+        return nullptr;
+    }
+    for (TUint i = 0; i < kMaxEntries; i++) {
+        Entry& entry = iEntries[i];
+        if (entry.iId.load() == aId) {
+            entry.iTables->AddRef();
+            return entry.iTables;
+        }
+    }
+    return nullptr;
+}
+
+
+// Mpeg4SampleTablesReader
+
+Mpeg4SampleTables* Mpeg4SampleTablesReader::Read(IReader& aReader)
+{ // static
+    ReaderBinary readerBin(aReader);
+    const TUint sampleCount = readerBin.ReadUintBe(4);
+    if (sampleCount == Mpeg4SampleTablesRegistry::kMarker) {
+        const TUint id = readerBin.ReadUintBe(4);
+        Mpeg4SampleTables* tables = Mpeg4SampleTablesRegistry::Claim(id);
+        if (tables == nullptr) {
+            LOG_ERROR(kCodec, "Mpeg4SampleTablesReader::Read - no tables registered with id %u\n", id);
+            THROW(MediaMpeg4FileInvalid);
+        }
+        return tables;
+    }
+
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    try {
+        SampleSizeTable& sampleSizes = tables->SampleSizes();
+        sampleSizes.Init(sampleCount);
+        for (TUint i = 0; i < sampleCount; i++) {
+            sampleSizes.AddSampleSize(readerBin.ReadUintBe(4));
+        }
+        SeekTableInitialiser seekTableInitialiser(tables->Seek(), aReader);
+        seekTableInitialiser.Init();
+    }
+    catch (Exception&) {
+        tables->RemoveRef();
+        throw;
+    }
+    return tables;
+}
+
+
 // MsgAudioEncodedWriter
 
 MsgAudioEncodedWriter::MsgAudioEncodedWriter(MsgFactory& aMsgFactory) :
@@ -4626,11 +4991,18 @@ Mpeg4Container::Mpeg4Container(IMimeTypeList& aMimeTypeList, Optional<IMpegDRMPr
     , iLock("MP4L")
 {
     aMimeTypeList.Add("audio/mp4");
+    iTables = new Mpeg4SampleTables();
+    iTablesId = Mpeg4SampleTablesRegistry::Register(*iTables);
+    if (iTablesId == Mpeg4SampleTablesRegistry::kIdNone) {
+        LOG(kCodec, "Mpeg4Container - sample table registry full, tables will be sent in-band\n");
+    }
 }
 
 Mpeg4Container::~Mpeg4Container()
 {
     delete iOutOfBandReader;
+    Mpeg4SampleTablesRegistry::Deregister(iTablesId);
+    iTables->RemoveRef();
 }
 
 void Mpeg4Container::Construct(IMsgAudioEncodedCache& aCache, MsgFactory& aMsgFactory, IContainerSeekHandler& aSeekHandler, IContainerUrlBlockWriter& aUrlBlockWriter, IContainerStopper& aContainerStopper)
@@ -4645,17 +5017,18 @@ void Mpeg4Container::Construct(IMsgAudioEncodedCache& aCache, MsgFactory& aMsgFa
     iProcessorFactory.Add(new Mpeg4BoxSwitcher(iProcessorFactory, Brn("stbl")));
     iProcessorFactory.Add(new Mpeg4BoxMoov(iProcessorFactory, iMetadataChecker));
     iProcessorFactory.Add(new Mpeg4BoxStsd(iStreamInfo, iCodecInfo, iProtectionDetails));
-    iProcessorFactory.Add(new Mpeg4BoxStts(iSeekTable));
-    iProcessorFactory.Add(new Mpeg4BoxStsc(iSeekTable));
-    iProcessorFactory.Add(new Mpeg4BoxStco(iSeekTable));
-    iProcessorFactory.Add(new Mpeg4BoxCo64(iSeekTable));
-    iProcessorFactory.Add(new Mpeg4BoxStsz(iSampleSizeTable));
+    iProcessorFactory.Add(new Mpeg4BoxStts(iTables->Seek()));
+    iProcessorFactory.Add(new Mpeg4BoxStsc(iTables->Seek()));
+    iProcessorFactory.Add(new Mpeg4BoxStss(iTables->Seek()));
+    iProcessorFactory.Add(new Mpeg4BoxStco(iTables->Seek()));
+    iProcessorFactory.Add(new Mpeg4BoxCo64(iTables->Seek()));
+    iProcessorFactory.Add(new Mpeg4BoxStsz(iTables->SampleSizes()));
     iProcessorFactory.Add(new Mpeg4BoxMdhd(iDurationInfo));
     iProcessorFactory.Add(
-        new Mpeg4BoxMdat(iDRMProvider, aMsgFactory, iBoxRootOutOfBand, iMetadataChecker, *this, *this, iBoxRoot, iSeekTable, iSampleSizeTable, iProtectionDetails, iContainerInfo, *iOutOfBandReader, aContainerStopper));
+        new Mpeg4BoxMdat(iDRMProvider, aMsgFactory, iBoxRootOutOfBand, iMetadataChecker, *this, *this, iBoxRoot, iTables->Seek(), iTables->SampleSizes(), iProtectionDetails, iContainerInfo, *iOutOfBandReader, aContainerStopper));
 
     // 'Moof' specific boxes
-    iProcessorFactory.Add(new Mpeg4BoxSidx(iSeekTable));
+    iProcessorFactory.Add(new Mpeg4BoxSidx(iTables->Seek()));
 
     iProcessorFactory.Add(new Mpeg4BoxTkhd(iDurationInfo));
     iProcessorFactory.Add(new Mpeg4BoxSwitcher(iProcessorFactory, Brn("mvex")));
@@ -4663,8 +5036,8 @@ void Mpeg4Container::Construct(IMsgAudioEncodedCache& aCache, MsgFactory& aMsgFa
 
     iProcessorFactory.Add(new Mpeg4BoxMoof(iProcessorFactory, iContainerInfo, static_cast<IBoxOffsetProvider&>(iBoxRoot), iStreamInfo));
     iProcessorFactory.Add(new Mpeg4BoxSwitcher(iProcessorFactory, Brn("traf")));
-    iProcessorFactory.Add(new Mpeg4BoxTfhd(iSampleSizeTable, iContainerInfo));
-    iProcessorFactory.Add(new Mpeg4BoxTrun(iSampleSizeTable, iContainerInfo));
+    iProcessorFactory.Add(new Mpeg4BoxTfhd(iTables->SampleSizes(), iContainerInfo));
+    iProcessorFactory.Add(new Mpeg4BoxTrun(iTables->SampleSizes(), iContainerInfo));
     iProcessorFactory.Add(new Mpeg4BoxSenc(iProtectionDetails));
 
     ASSERT(iSeekObserver != nullptr);
@@ -4712,8 +5085,8 @@ void Mpeg4Container::Reset()
     iDurationInfo.Reset();
     iStreamInfo.Reset();
     iCodecInfo.Reset();
-    iSampleSizeTable.Reset();
-    iSeekTable.Deinitialise();
+    iTables->SampleSizes().Reset();
+    iTables->Seek().Deinitialise();
     iContainerInfo.Reset();
     iProtectionDetails.Reset();
     iRecognitionStarted = false;
@@ -4800,18 +5173,18 @@ TBool Mpeg4Container::TrySeek(TUint aStreamId, TUint64 aOffset)
         // Fragmented streams are based on the SIDX.
         // This defines how large each fragment/segment is starting from the position of the first MOOF box encountered in the stream
         const TUint fragmentIndex = (TUint)aOffset;
-        if (fragmentIndex >= iSeekTable.ChunkCount()) {
-            LOG_ERROR(kCodec, "Mpeg4Container::TrySeek - Index of: %u doesn't exist. We have %u available.\n", fragmentIndex, iSeekTable.ChunkCount());
+        if (fragmentIndex >= iTables->Seek().ChunkCount()) {
+            LOG_ERROR(kCodec, "Mpeg4Container::TrySeek - Index of: %u doesn't exist. We have %u available.\n", fragmentIndex, iTables->Seek().ChunkCount());
         }
 
         TUint64 offset = iContainerInfo.FirstMoofStart();
         for(TUint i = 0; i < fragmentIndex; i += 1) {
-            offset += iSeekTable.GetOffset(i);
+            offset += iTables->Seek().GetOffset(i);
         }
 
         const TBool seek = iSeekHandler->TrySeekTo(aStreamId, offset);
         if (seek) {
-            iSeekObserver->ChunkSeek(0); // The value here doesn't really matter for fragmented files, but we still need to call the function
+            iSeekObserver->ChunkSeek(0, 0); // The value here doesn't really matter for fragmented files, but we still need to call the function
             iBoxRoot.Reset();
         }
         return seek;
@@ -4819,17 +5192,24 @@ TBool Mpeg4Container::TrySeek(TUint aStreamId, TUint64 aOffset)
     }
     else {
         // As TrySeek requires a byte offset, any codec that uses an Mpeg4 stream MUST find the appropriate seek offset (in bytes) and pass that via TrySeek().
-        // i.e., aOffset MUST match a chunk offset.
+        // i.e., aOffset MUST be the start of a sample, as returned by SeekTable::Offset().  This needn't be the start of a chunk.
 
-        const TUint chunkCount = iSeekTable.ChunkCount();
+        const SeekTable& seekTable = iTables->Seek();
+        const TUint chunkCount = seekTable.ChunkCount();
         for (TUint i = 0; i < chunkCount; i++) {
-            if (iSeekTable.GetOffset(i) == aOffset) {
-                const TBool seek = iSeekHandler->TrySeekTo(aStreamId, aOffset);
-                if (seek) {
-                    iSeekObserver->ChunkSeek(i);
-                }
-                return seek;
+            const TUint64 chunkOffset = seekTable.GetOffset(i);
+            if (aOffset < chunkOffset) {
+                continue;
             }
+            const TUint64 bytesIntoChunk = aOffset - chunkOffset;
+            if (bytesIntoChunk > 0 && bytesIntoChunk >= iTables->SampleSizes().Bytes(seekTable.StartSample(i), seekTable.SamplesPerChunk(i))) {
+                continue;
+            }
+            const TBool seek = iSeekHandler->TrySeekTo(aStreamId, aOffset);
+            if (seek) {
+                iSeekObserver->ChunkSeek(i, static_cast<TUint>(bytesIntoChunk));
+            }
+            return seek;
         }
     }
 
@@ -4915,8 +5295,7 @@ MsgAudioEncoded* Mpeg4Container::GetMetadata()
                 msg = iMsgFactory->CreateMsgAudioEncoded(infoBuf);
                 msg->Add(codecInfo);
 
-                iSampleSizeTable.WriteInit();
-                iMdataState = eMdataSizeTab;    // For these codecs, we alwyas provide a sample & seek table
+                StartSampleTables();    // For these codecs, we alwyas provide a sample & seek table
             }
             else if (doCodecInfo) {
                 // Make sure to include the codec name at the beginning to ensure our codecs will recognise it property
@@ -4925,11 +5304,10 @@ MsgAudioEncoded* Mpeg4Container::GetMetadata()
                 iMdataState = eMdataComplete;   // For these codecs, a sample & seek table are NEVER provided
             }
             else if (doSampleTable) {
-                iSampleSizeTable.WriteInit();
-                iMdataState = eMdataSizeTab;
+                StartSampleTables();
             }
             else if (doSeekTable) {
-                iSeekTable.WriteInit();
+                iTables->Seek().WriteInit();
                 iMdataState = eMdataSeekTab;
             }
             else {
@@ -4938,14 +5316,26 @@ MsgAudioEncoded* Mpeg4Container::GetMetadata()
         }
         break;
 
+    case eMdataTablesRef:
+        {
+            Bws<2 * sizeof(TUint32)> refBuf;
+            WriterBuffer writerBuf(refBuf);
+            WriterBinary writerBin(writerBuf);
+            writerBin.WriteUint32Be(Mpeg4SampleTablesRegistry::kMarker);
+            writerBin.WriteUint32Be(iTablesId);
+            msg = iMsgFactory->CreateMsgAudioEncoded(refBuf);
+            iMdataState = eMdataComplete;
+        }
+        break;
+
     case eMdataSizeTab:
         {
             MsgAudioEncodedWriter writerMsg(*iMsgFactory);
-            iSampleSizeTable.Write(writerMsg, EncodedAudio::kMaxBytes);
+            iTables->SampleSizes().Write(writerMsg, EncodedAudio::kMaxBytes);
             writerMsg.WriteFlush();
             msg = writerMsg.Msg();
-            if (iSampleSizeTable.WriteComplete()) {
-                iSeekTable.WriteInit();
+            if (iTables->SampleSizes().WriteComplete()) {
+                iTables->Seek().WriteInit();
                 iMdataState = eMdataSeekTab;
             }
         }
@@ -4954,10 +5344,10 @@ MsgAudioEncoded* Mpeg4Container::GetMetadata()
     case eMdataSeekTab:
         {
             MsgAudioEncodedWriter writerMsg(*iMsgFactory);
-            iSeekTable.Write(writerMsg, EncodedAudio::kMaxBytes);
+            iTables->Seek().Write(writerMsg, EncodedAudio::kMaxBytes);
             writerMsg.WriteFlush();
             msg = writerMsg.Msg();
-            if (iSeekTable.WriteComplete()) {
+            if (iTables->Seek().WriteComplete()) {
                 iMdataState = eMdataComplete;
             }
         }
@@ -4976,6 +5366,18 @@ TBool Mpeg4Container::Complete()
     return (iMdataState == eMdataComplete);
 }
 
+void Mpeg4Container::StartSampleTables()
+{
+    // Long files have tables of many MB.  Pass codecs a reference to these rather than a copy when possible.
+    if (iTablesId != Mpeg4SampleTablesRegistry::kIdNone) {
+        iMdataState = eMdataTablesRef;
+    }
+    else {
+        iTables->SampleSizes().WriteInit();
+        iMdataState = eMdataSizeTab;
+    }
+}
+
 void Mpeg4Container::RegisterChunkSeekObserver(
         IMpeg4ChunkSeekObserver& aChunkSeekObserver)
 {
@@ -7,6 +7,7 @@
 #include <OpenHome/Media/Codec/CodecController.h>
 #include <OpenHome/Private/Uri.h>
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -15,6 +16,8 @@ EXCEPTION(Mpeg4BoxUnrecognised);
 EXCEPTION(MediaMpeg4FileInvalid);
 EXCEPTION(MediaMpeg4OutOfRange);
 
+struct evp_cipher_ctx_st; // OpenSSL's EVP_CIPHER_CTX
+
 namespace OpenHome {
 namespace Media {
     class IMimeTypeList;
@@ -394,6 +397,39 @@ private:
     Bws<4> iBuf;
 };
 
+class Mpeg4BoxStss : public IMpeg4BoxRecognisable
+{
+private:
+    static const TUint kVersion = 0;
+public:
+    Mpeg4BoxStss(SeekTable& aSeekTable);
+public: // from IMpeg4BoxRecognisable
+    Msg* Process() override;
+    TBool Complete() const override;
+    void Reset() override;
+    TBool Recognise(const Brx& aBoxId) const override;
+    void Set(IMsgAudioEncodedCache& aCache, TUint aBoxBytes) override;
+private:
+    enum EState
+    {
+        eNone,
+        eVersion,
+        eEntries,
+        eEntry,
+        eComplete,
+    };
+private:
+    SeekTable& iSeekTable;
+    IMsgAudioEncodedCache* iCache;
+    EState iState;
+    TUint iBytes;
+    TUint iOffset;
+    TUint iEntries;
+    TUint iEntryCount;
+    TUint iPrevSampleNumber;
+    Bws<4> iBuf;
+};
+
 class Mpeg4BoxStco : public IMpeg4BoxRecognisable
 {
 private:
@@ -1068,7 +1104,7 @@ public:
 class IMpeg4ChunkSeekObserver
 {
 public:
-    virtual void ChunkSeek(TUint aChunk) = 0;
+    virtual void ChunkSeek(TUint aChunk, TUint aChunkBytesToSkip) = 0; // aChunkBytesToSkip => start of the sample to resume from
     virtual ~IMpeg4ChunkSeekObserver() {}
 };
 
@@ -1081,18 +1117,79 @@ public:
 
 class Mpeg4OutOfBandReader;
 
+/*
+ * Describes a run of protected samples that are stored back-to-back.
+ * All samples are fully encrypted ('cenc' without subsample encryption).
+ */
+class IMpeg4EncryptedSamples
+{
+public:
+    virtual TUint Count() const = 0;
+    virtual TUint Bytes(TUint aIndex) const = 0;
+    virtual const Brx& IV(TUint aIndex) = 0; // 16 bytes. Only valid until the next call.
+    virtual ~IMpeg4EncryptedSamples() {}
+};
+
 class IMpegDRMProvider
 {
 public:
     virtual ~IMpegDRMProvider() {};
+    // Decrypts a single sample, appending the result to aDecryptBuffer.
     virtual TBool Decrypt(const Brx& aKID,
                           const Brx& aEncryptedData,
                           const Brx& aIV,
                           Bwx& aDecryptBuffer) = 0;
+    /*
+     * Providers that can decrypt several samples in a single call should override both of the following.
+     * aData holds the encrypted bytes of all aSamples and is overwritten with the decrypted audio.
+     * Providers that don't are passed one sample at a time to Decrypt() above.
+     */
+    virtual TBool SupportsDecryptInPlace() const { return false; }
+    virtual TBool DecryptInPlace(const Brx& /*aKID*/, IMpeg4EncryptedSamples& /*aSamples*/, Bwx& /*aData*/) { return false; }
+};
+
+/*
+ * AES-128-CTR decryption of 'cenc' protected samples using OpenSSL's EVP API,
+ * so that any hardware support for AES is used.
+ * Intended for use by IMpegDRMProvider implementations that have access to the content key.
+ */
+class Mpeg4CencDecryptor : private INonCopyable
+{
+public:
+    static const TUint kKeyBytes = 16;
+    static const TUint kIVBytes = 16;
+public:
+    Mpeg4CencDecryptor();
+    ~Mpeg4CencDecryptor();
+    void SetKey(const Brx& aKey);
+    TBool Decrypt(const Brx& aIV, Bwx& aSample); // decrypts aSample in place
+    TBool Decrypt(IMpeg4EncryptedSamples& aSamples, Bwx& aData); // decrypts all samples in aData in place
+private:
+    TBool Decrypt(const Brx& aIV, TByte* aData, TUint aBytes);
+private:
+    evp_cipher_ctx_st* iCtx;
+    TBool iKeySet;
+};
+
+class Mpeg4EncryptedSampleRange : public IMpeg4EncryptedSamples
+{
+public:
+    Mpeg4EncryptedSampleRange(SampleSizeTable& aSampleSizeTable, Mpeg4ProtectionDetails& aProtectionDetails);
+    void Set(TUint aFirstSample, TUint aCount);
+public: // from IMpeg4EncryptedSamples
+    TUint Count() const override;
+    TUint Bytes(TUint aIndex) const override;
+    const Brx& IV(TUint aIndex) override;
+private:
+    SampleSizeTable& iSampleSizeTable;
+    Mpeg4ProtectionDetails& iProtectionDetails;
+    TUint iFirstSample;
+    TUint iCount;
 };
 
 class Mpeg4BoxMdat : public IMpeg4BoxRecognisable, public IMpeg4ChunkSeekObserver, private INonCopyable
 {
+    static const TUint kMaxProtectedSampleBytes = 16 * 1024; // During testing we've found tracks containing samples of 16,299bytes
 public:
     Mpeg4BoxMdat(Optional<IMpegDRMProvider> iDRMProvider,
                  MsgFactory& aMsgFactory,
@@ -1115,13 +1212,15 @@ public: // from IMpeg4BoxRecognisable
     TBool Recognise(const Brx& aBoxId) const override;
     void Set(IMsgAudioEncodedCache& aCache, TUint aBoxBytes) override;
 private: // from IMpeg4ChunkSeekObserver
-    void ChunkSeek(TUint aChunk) override;
+    void ChunkSeek(TUint aChunk, TUint aChunkBytesToSkip) override;
 private:
     TUint BytesUntilChunk() const;
     TBool ChunkBytes(TUint *aChunkBytes) const;
     TUint BytesToRead() const;
     void MoveToNextChunkIfPossible();
     void OnErrorEncountered();
+    void DiscardEmittedAudio();
+    void DecryptSamples(TUint aCount, TUint aBytes);
 private:
     enum EState
     {
@@ -1151,7 +1250,9 @@ private:
     EState iState;
     TUint iChunk;
     TUint iSeekChunk;
+    TUint iSeekChunkBytesToSkip;
     TBool iSeek;
+    TUint iChunkBytesSkipped;   // bytes at the start of iChunk that precede the sample a seek resumed from
     TUint iChunkBytesRemaining;
     TUint iBytes;
     TUint64 iOffset;
@@ -1161,8 +1262,10 @@ private:
 
     // Protection Support
     TUint iSampleIndex;
-    Bwh* iDecryptionBuf;
-    Bwh* iSampleBuf;
+    Bwh* iSampleBuf;        // decrypted audio (first iDecryptedBytes), followed by encrypted samples
+    TUint iDecryptedBytes;
+    Bwh* iDecryptionBuf;    // only allocated for providers that can't decrypt in place
+    Mpeg4EncryptedSampleRange iEncryptedSamples;
     MsgAudioEncoded* iChunkMsg;
 };
 
@@ -1179,18 +1282,28 @@ public:
     TUint DefaultSampleSize() const;
     void SetDefaultSampleSize(TUint aDefaultSampleSize);
     TUint Count() const;
+    TUint64 Bytes(TUint aIndex, TUint aCount) const; // total size of aCount samples, starting from aIndex
     void WriteInit();
     void Write(IWriter& aWriter, TUint aMaxBytes);
     TBool WriteComplete() const;
+private:
+    TUint64 BytesBefore(TUint aIndex) const;
+private:
+    static const TUint kIndexInterval = 64;
 private:
     std::vector<TUint> iTable;
+    std::vector<TUint64> iIndex; // total size of samples before every kIndexInterval'th sample
+    TUint64 iTotalBytes;
     TUint iWriteIndex;
     TUint iDefaultSampleSize;
 };
 
-// FIXME - should probably also include stss here.
-// If stss box is present, it means that not all samples are sync samples, and the stss box is consulted to find the first sync sample prior to specified time.
-// If stss not present, all samples are sync samples.
+/*
+ * Each stts and stsc run records the first codec (and, for stts, audio) sample it covers.
+ * These are accumulated as runs are added so lookups are binary searches rather than scans.
+ * If an stss box is present, seeks start from the closest preceding sync sample.
+ * If stss not present, all samples are sync samples.
+ */
 class SeekTable
 {
 public:
@@ -1200,16 +1313,20 @@ public:
     void InitialiseSamplesPerChunk(TUint aEntries);
     void InitialiseAudioSamplesPerSample(TUint aEntries);
     void InitialiseOffsets(TUint aEntries);
+    void InitialiseSyncSamples(TUint aEntries);
     TBool Initialised() const;
     void Deinitialise();
     void SetSamplesPerChunk(TUint aFirstChunk, TUint aSamplesPerChunk, TUint aSampleDescriptionIndex);
     void SetAudioSamplesPerSample(TUint32 aSampleCount, TUint32 aAudioSamples);
     void SetOffset(TUint64 aOffset);    // FIXME - rename to AddOffset()? and similar with above methods?
+    void SetSyncSample(TUint aSampleNumber); // as in stss, numbered from 1.  Must be called in increasing order.
     TUint ChunkCount() const;
     TUint AudioSamplesPerSample() const;
     TUint SamplesPerChunk(TUint aChunkIndex) const;
     TUint StartSample(TUint aChunkIndex) const;
-    TUint64 Offset(TUint64& aAudioSample, TUint64& aSample);    // FIXME - aSample should be TUint.
+    // Find the file offset of the closest sync sample at or before aAudioSample.  aAudioSample and aSample
+    // are updated to the first audio sample and codec sample that decoding will resume from.
+    TUint64 Offset(TUint64& aAudioSample, TUint64& aSample, const SampleSizeTable& aSampleSizes) const;    // FIXME - aSample should be TUint.
     // FIXME - See if it's possible to split this class into its 3 separate components, to simplify it.
     TUint64 GetOffset(TUint aChunkIndex) const;
     void WriteInit();
@@ -1218,30 +1335,37 @@ public:
 private:
     // Find the codec sample that contains the given audio sample.
     TUint64 CodecSample(TUint64 aAudioSample) const;
-    TUint SamplesPerChunkTotal(TUint aIndex) const;
-    TUint ChunkWithinSamplesPerChunk(TUint aIndex, TUint aSampleOffset) const;
+    // Find the closest sync sample at or before the given codec sample.
+    TUint64 SyncSample(TUint64 aCodecSample) const;
+    TUint64 CodecSamplesTotal() const;  // according to stsc and chunk count
+    TUint64 AudioSamplesTotal() const;  // according to stts
     // Find the chunk that contains the desired codec sample.
     TUint Chunk(TUint64 aCodecSample) const;
-    TUint CodecSampleFromChunk(TUint aChunk) const;
-    TUint AudioSampleFromCodecSample(TUint aCodecSample) const;
+    TUint64 CodecSampleFromChunk(TUint aChunk) const;
+    TUint64 AudioSampleFromCodecSample(TUint64 aCodecSample) const;
 
 private:
     typedef struct {
         TUint   iFirstChunk;
         TUint   iSamples;
         TUint   iSampleDescriptionIndex;
+        TUint64 iFirstSample;       // first codec sample in this run
     } TSamplesPerChunkEntry;
     typedef struct {
         TUint   iSampleCount;
         TUint   iAudioSamples;
+        TUint64 iFirstSample;       // first codec sample in this run
+        TUint64 iFirstAudioSample;  // first audio sample in this run
     } TAudioSamplesPerSampleEntry;
 private:
     std::vector<TSamplesPerChunkEntry> iSamplesPerChunk;
     std::vector<TAudioSamplesPerSampleEntry> iAudioSamplesPerSample;
     std::vector<TUint64> iOffsets;
+    std::vector<TUint> iSyncSamples; // codec samples, from 0.  Empty if all samples are sync samples.
     TUint iSpcWriteIndex;
     TUint iAspsWriteIndex;
     TUint iOffsetsWriteIndex;
+    TUint iSyncWriteIndex;
 };
 
 class SeekTableInitialiser : public INonCopyable
@@ -1255,6 +1379,67 @@ private:
     TBool iInitialised;
 };
 
+/*
+ * Sample size and seek tables for a stream (or, for fragmented streams, the current fragment).
+ * Owned jointly by Mpeg4Container, which populates them, and the codec that decodes its output.
+ * Codecs must not modify the tables.
+ */
+class Mpeg4SampleTables : private INonCopyable
+{
+public:
+    Mpeg4SampleTables();
+    void AddRef();
+    void RemoveRef(); // deletes this once the last reference is removed
+    SampleSizeTable& SampleSizes();
+    SeekTable& Seek();
+private:
+    ~Mpeg4SampleTables() {}
+private:
+    SampleSizeTable iSampleSizes;
+    SeekTable iSeek;
+    std::atomic<TUint> iRefCount;
+};
+
+/*
+ * Allows a codec to find the tables of the container that feeds it.
+ * Containers register their tables once then send codecs the (4 byte) id returned,
+ * preceded by kMarker, in place of the serialised tables.
+ * Deregister() must not be called while a codec may be claiming the same tables.  This holds
+ * as a container and the codecs reading from it run in the same thread.
+ */
+class Mpeg4SampleTablesRegistry
+{
+    static const TUint kMaxEntries = 8;
+public:
+    static const TUint kIdNone = 0;
+    static const TUint32 kMarker = 0xffffffff; // not a plausible sample count
+public:
+    static TUint Register(Mpeg4SampleTables& aTables); // adds a reference.  Returns kIdNone if the registry is full
+    static void Deregister(TUint aId);
+    static Mpeg4SampleTables* Claim(TUint aId);      // returns a new reference or nullptr if aId is not registered
+private:
+    struct Entry
+    {
+        std::atomic<TBool> iUsed;
+        std::atomic<TUint> iId;
+        Mpeg4SampleTables* iTables;
+    };
+private:
+    static Entry iEntries[kMaxEntries];
+    static std::atomic<TUint> iNextId;
+};
+
+class Mpeg4SampleTablesReader
+{
+public:
+    /*
+     * Reads the tables that follow a codec's stream descriptor, whether sent by reference or serialised.
+     * Returns a reference which the caller must release.
+     * Throws MediaMpeg4FileInvalid if tables were sent by reference but can't be found.
+     */
+    static Mpeg4SampleTables* Read(IReader& aReader);
+};
+
 class MsgAudioEncodedWriter : public IWriter
 {
 public:
@@ -1402,6 +1587,8 @@ private: // from IMpeg4MetadataProvider
     TBool Complete() override;
 private: // from IMpeg4ChunkSeekObservable
     void RegisterChunkSeekObserver(IMpeg4ChunkSeekObserver& aChunkSeekObserver) override;
+private:
+    void StartSampleTables();
 private:
     Optional<IMpegDRMProvider> iDRMProvider;
     Mpeg4BoxProcessorFactory iProcessorFactory;
@@ -1411,8 +1598,8 @@ private:
     Mpeg4Duration iDurationInfo;
     Mpeg4StreamInfo iStreamInfo;
     Mpeg4CodecInfo iCodecInfo;
-    SampleSizeTable iSampleSizeTable;
-    SeekTable iSeekTable;
+    Mpeg4SampleTables* iTables;
+    TUint iTablesId;
     Mpeg4ProtectionDetails iProtectionDetails;
     Mpeg4ContainerInfo iContainerInfo;
     Mpeg4OutOfBandReader* iOutOfBandReader;
@@ -1425,6 +1612,7 @@ private:
     enum EMdataState
     {
         eMdataNone,
+        eMdataTablesRef,
         eMdataSizeTab,
         eMdataSeekTab,
         eMdataComplete
@@ -24,21 +24,20 @@ public:
     ~CodecOpus();
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo);
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const;
     void StreamInitialise();
     void Process();
     TBool TrySeek(TUint aStreamId, TUint64 aSample);
     void StreamCompleted();
 
 private:
-    void TryReadSizeTable(CodecBufferedReader&);
-    void TryReadSeekTable(CodecBufferedReader&);
+    void ReadSampleAndSeekTables(CodecBufferedReader& aReader);
     TBool ValidateCodecInformation(const Brx&) const;
 
 private:
     Brn iName;
     OpusDecoder* iDecoder;
-    SampleSizeTable iSampleSizeTable;
-    SeekTable iSeekTable;
+    Mpeg4SampleTables* iTables;
     Bws<1024> iInBuf;
     Bws<48000 * 2 * sizeof(TInt)> iDecodedBuf;
 
@@ -112,6 +111,7 @@ static const AudioDataEndian kAudioEndianess = AudioDataEndian::Little;
 CodecOpus::CodecOpus(IMimeTypeList& aMimeTypeList)
     : CodecBase("Opus")
     , iName("Opus")
+    , iTables(nullptr)
 {
     int err = 0;
     iDecoder = opus_decoder_create(48000, 2, &err);
@@ -125,6 +125,14 @@ CodecOpus::~CodecOpus()
 {
     opus_decoder_destroy(iDecoder);
     iDecoder = nullptr;
+    if (iTables != nullptr) {
+        iTables->RemoveRef();
+    }
+}
+
+CodecBase::RecognitionHint CodecOpus::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    return SniffSignature(aStreamStart, aStreamInfo, "dOps");
 }
 
 TBool CodecOpus::Recognise(const EncodedStreamInfo& aStreamInfo)
@@ -171,8 +179,7 @@ void CodecOpus::StreamInitialise()
 
         config.Append(codecBufReader.Read(kOpusConfigSize));
 
-        TryReadSizeTable(codecBufReader);
-        TryReadSeekTable(codecBufReader);
+        ReadSampleAndSeekTables(codecBufReader);
     }
     catch (MediaMpeg4FileInvalid&) {
         THROW(CodecStreamCorrupt);
@@ -216,8 +223,9 @@ void CodecOpus::Process()
     iInBuf.SetBytes(0);
     iDecodedBuf.SetBytes(0);
 
-    if (iSamplesDecoded < iSampleSizeTable.Count()) {
-        const TUint sampleSize = iSampleSizeTable.SampleSize(iSamplesDecoded);
+    const SampleSizeTable& sampleSizes = iTables->SampleSizes();
+    if (iSamplesDecoded < sampleSizes.Count()) {
+        const TUint sampleSize = sampleSizes.SampleSize(iSamplesDecoded);
         iController->Read(iInBuf, sampleSize);
 
         const TInt outputSamples = opus_decode(iDecoder, (const TByte*)iInBuf.Ptr(), iInBuf.Bytes(), (TInt16*)iDecodedBuf.Ptr(), iSampleRate * iChannelCount, 0);
@@ -265,8 +273,7 @@ void CodecOpus::Process()
         try {
             CodecBufferedReader codecBufReader(*iController, iInBuf);
 
-            TryReadSizeTable(codecBufReader);
-            TryReadSeekTable(codecBufReader);
+            ReadSampleAndSeekTables(codecBufReader);
 
             // Reset this, as we're at the start of a new chunk! :)
             iSamplesDecoded = 0;
@@ -307,7 +314,7 @@ TBool CodecOpus::TrySeek(TUint aStreamId, TUint64 aSample)
 
     /*
     // NOTE: We only support seeking Opus when it's part of a fragmented MPEG stream.
-    if (!iSeekTable.IsFragmentedStream()) {
+    if (!iTables->Seek().IsFragmentedStream()) {
         LOG_ERROR(kCodec, "CodecOpus::TrySeek - ATTEMPTING TO SEEK A NON-FRAGMENTED FILE. This is not supported.\n");
         return false;
     }
@@ -318,8 +325,8 @@ TBool CodecOpus::TrySeek(TUint aStreamId, TUint64 aSample)
     TUint accumulatedTime = 0;
     TUint64 samplesToSkip = aSample;
 
-    for(fragmentIndex = 0; fragmentIndex < iSeekTable.ChunkCount(); fragmentIndex += 1) {
-        const TUint segmentDuration = iSeekTable.SamplesPerChunk(fragmentIndex);
+    for(fragmentIndex = 0; fragmentIndex < iTables->Seek().ChunkCount(); fragmentIndex += 1) {
+        const TUint segmentDuration = iTables->Seek().SamplesPerChunk(fragmentIndex);
 
         const TBool segmentContainsSeekPosition = (accumulatedTime + segmentDuration) > seekPositionSeconds;
         if (segmentContainsSeekPosition) {
@@ -339,9 +346,6 @@ TBool CodecOpus::TrySeek(TUint aStreamId, TUint64 aSample)
 
     iTrackOffset = (aSample * Jiffies::kPerSecond) / iSampleRate;
 
-    iSampleSizeTable.Clear();
-    iSeekTable.Deinitialise();
-
     if (iController->TrySeekTo(aStreamId, fragmentIndex)) {
         iController->OutputDecodedStream(iBitRate, iBitDepth, iSampleRate, iChannelCount, kCodecOpus, iTrackLengthJiffies, aSample, false, DeriveProfile(iChannelCount));
         iTrackOffset = aSample;
@@ -358,29 +362,13 @@ void CodecOpus::StreamCompleted()
     (void)opus_decoder_ctl(iDecoder, OPUS_RESET_STATE);
 }
 
-void CodecOpus::TryReadSizeTable(CodecBufferedReader& aReader)
+void CodecOpus::ReadSampleAndSeekTables(CodecBufferedReader& aReader)
 {
-    // Read sample size table.
-    ReaderBinary readerBin(aReader);
-
-    iSampleSizeTable.Clear();
-
-    const TUint sampleCount = readerBin.ReadUintBe(4);
-
-    iSampleSizeTable.Init(sampleCount);
-
-    for (TUint i=0; i<sampleCount; i++) {
-        const TUint sampleSize = readerBin.ReadUintBe(4);
-        iSampleSizeTable.AddSampleSize(sampleSize);
+    Mpeg4SampleTables* tables = Mpeg4SampleTablesReader::Read(aReader);
+    if (iTables != nullptr) {
+        iTables->RemoveRef();
     }
-}
-
-void CodecOpus::TryReadSeekTable(CodecBufferedReader& aReader)
-{
-    iSeekTable.Deinitialise();
-
-    SeekTableInitialiser seekTableInitialiser(iSeekTable, aReader);
-    seekTableInitialiser.Init();
+    iTables = tables;
 }
 
 TBool CodecOpus::ValidateCodecInformation(const Brx& aCodecInfo) const
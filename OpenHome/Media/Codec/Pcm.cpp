@@ -19,6 +19,7 @@ public:
     ~CodecPcm();
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo) override;
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const override;
     void StreamInitialise() override;
     void Process() override;
     TBool TrySeek(TUint aStreamId, TUint64 aSample) override;
@@ -64,6 +65,11 @@ CodecPcm::~CodecPcm()
 {
 }
 
+CodecBase::RecognitionHint CodecPcm::Sniff(const Brx& /*aStreamStart*/, const EncodedStreamInfo& aStreamInfo) const
+{
+    return aStreamInfo.StreamFormat() == EncodedStreamInfo::Format::Pcm? RecognitionHint::Likely : RecognitionHint::Unlikely;
+}
+
 TBool CodecPcm::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
     if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Pcm) {
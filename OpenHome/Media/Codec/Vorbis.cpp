@@ -140,6 +140,20 @@ CodecVorbis::~CodecVorbis()
     LOG(kCodec, "CodecVorbis::~CodecVorbis\n");
 }
 
+CodecBase::RecognitionHint CodecVorbis::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    // Vorbis is only supported within Ogg.  The first page of a stream holds a
+    // single segment, so its identification header follows a 28 byte page header.
+    const RecognitionHint hint = SniffSignature(aStreamStart, aStreamInfo, "OggS");
+    if (hint != RecognitionHint::Likely) {
+        return hint;
+    }
+    if (SniffSignature(aStreamStart, aStreamInfo, "\x01vorbis", 28) == RecognitionHint::Likely) {
+        return RecognitionHint::Likely;
+    }
+    return RecognitionHint::Unknown;
+}
+
 TBool CodecVorbis::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
     if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
@@ -187,8 +201,6 @@ void CodecVorbis::StreamInitialise()
     iStreamEnded = false;
     iNewStreamStarted = false;
     iTotalSamplesOutput = 0;
-    iInBuf.SetBytes(0);
-    iOutBuf.SetBytes(0);
     iSamplesTotal = 0;
     iTrackLengthJiffies = 0;
     iTrackOffset = 0;
@@ -247,8 +259,6 @@ TBool CodecVorbis::TrySeekBytes(TUint aStreamId, TUint64 aSample, TUint64 aByteP
     if (canSeek) {
         iTotalSamplesOutput = aSample;
         iTrackOffset = (aSample * Jiffies::kPerSecond) / iSampleRate;
-        iInBuf.SetBytes(0);
-        iOutBuf.SetBytes(0);
         iController->OutputDecodedStream(0, kBitDepth, iSampleRate, iChannels, kCodecVorbis, iTrackLengthJiffies, aSample, false, DeriveProfile(iChannels));
     }
     return canSeek;
@@ -357,7 +367,7 @@ TUint64 CodecVorbis::GetTotalSamples()
     THROW(CodecStreamCorrupt);
 }
 
-// copy audio data to output buffer, converting to big endian if required.
+// convert audio data to big endian if required.  aDst may equal aSrc.
 void CodecVorbis::BigEndian(TInt16* aDst, TInt16* aSrc, TUint aSamples)
 {
     aSamples *= iChannels;
@@ -369,14 +379,16 @@ void CodecVorbis::BigEndian(TInt16* aDst, TInt16* aSrc, TUint aSamples)
 void CodecVorbis::Process()
 {
     TInt bitstream = 0;
-    TUint iPrevBytes = iOutBuf.Bytes();
 
     if(!iStreamEnded || !iNewStreamStarted) {
         LOG(kCodec, "CodecVorbis::Process bitstream %d\n", bitstream);
         try {
-            char *pcm = (char *)iInBuf.Ptr();
-            TInt request = (iOutBuf.MaxBytes() - iOutBuf.Bytes());
-            ASSERT((TInt)iInBuf.MaxBytes() >= request);
+            // decode straight into pipeline audio, then byte swap in place
+            TByte* dstByte;
+            TUint maxSamples;
+            iController->GetAudioBuf(dstByte, maxSamples);
+            char *pcm = reinterpret_cast<char*>(dstByte);
+            TInt request = (TInt)(maxSamples * iBytesPerSample);
 
             TInt bytes = 0;
             bytes = ov_read(&iPimpl->iVf, pcm, request, (int*)&bitstream);
@@ -399,14 +411,14 @@ void CodecVorbis::Process()
                 LOG(kCodec, "CodecVorbis::Process new bitstream %d, %d\n", iBitstream, bitstream);
                 iBitstream = bitstream;
 
-                // Encountered a new logical bitstream. Better push any
-                // buffered PCM from previous stream.
-                if (iOutBuf.Bytes() > 0) {
-                    iTrackOffset += iController->OutputAudioPcm(iOutBuf, iChannels, iSampleRate,
-                        kBitDepth, AudioDataEndian::Big, iTrackOffset);
-                    iOutBuf.SetBytes(0);
-                    LOG(kCodec, "CodecVorbis::Process output (new bitstream detected) - total samples = %llu\n", iTotalSamplesOutput);
-                }
+                // Encountered a new logical bitstream. Audio from the previous
+                // stream has already been output; the pcm just read belongs to
+                // the new stream so is only output after any MsgDecodedStream.
+                // Move it out of the pipeline buffer (which was sized for the
+                // previous stream) and release that buffer before outputting
+                // any other msgs.
+                iChainedPcm.Replace(Brn(dstByte, bytes));
+                iController->OutputAudioBuf(0, iTrackOffset);
 
                 // From ov_read() docs:
                 // "However, when reading audio back, the application must be aware that multiple bitstream sections do not necessarily use the same number of channels or sampling rate."
@@ -435,21 +447,23 @@ void CodecVorbis::Process()
                 }
 
                 OutputMetaData();
-            }
-
-            TUint samples = bytes/iBytesPerSample;
-            TByte* dstByte = const_cast<TByte*>(iOutBuf.Ptr()) + iOutBuf.Bytes();
-            TInt16* dst = reinterpret_cast<TInt16*>(dstByte);
-            BigEndian(dst, (TInt16 *)pcm, samples);
-            iOutBuf.SetBytes(iOutBuf.Bytes()+bytes);
-            iTotalSamplesOutput += samples;
 
-            LOG(kCodec, "CodecVorbis::Process read - bytes %d, iPrevBytes %d\n", bytes, iPrevBytes);
-            if (iOutBuf.MaxBytes() - iOutBuf.Bytes() < (TUint)((kBitDepth/8) * iChannels)) {
-                iTrackOffset += iController->OutputAudioPcm(iOutBuf, iChannels, iSampleRate,
+                const TUint samples = bytes/iBytesPerSample;
+                TInt16* dst = reinterpret_cast<TInt16*>(const_cast<TByte*>(iChainedPcm.Ptr()));
+                BigEndian(dst, dst, samples);
+                iTotalSamplesOutput += samples;
+                iTrackOffset += iController->OutputAudioPcm(iChainedPcm, iChannels, iSampleRate,
                     kBitDepth, AudioDataEndian::Big, iTrackOffset);
-                iOutBuf.SetBytes(0);
-                LOG(kCodec, "CodecVorbis::Process output - total samples = %llu\n", iTotalSamplesOutput);
+                LOG(kCodec, "CodecVorbis::Process output (new bitstream detected) - total samples = %llu\n", iTotalSamplesOutput);
+            }
+            else {
+                TUint samples = bytes/iBytesPerSample;
+                TInt16* dst = reinterpret_cast<TInt16*>(dstByte);
+                BigEndian(dst, dst, samples);
+                iTotalSamplesOutput += samples;
+
+                LOG(kCodec, "CodecVorbis::Process read - bytes %d\n", bytes);
+                iController->OutputAudioBuf(samples, iTrackOffset);
             }
         }
         catch(CodecStreamEnded&) {
@@ -463,17 +477,12 @@ void CodecVorbis::Process()
     FlushOutput();
 }
 
-// flush any remaining samples from the decoded buffer
+// propagate end of stream once all decoded audio has been output
 void CodecVorbis::FlushOutput()
 {
     LOG(kCodec, "CodecVorbis::FlushOutput\n");
 
     if (iStreamEnded || iNewStreamStarted) {
-        if (iOutBuf.Bytes() > 0) {
-            iTrackOffset += iController->OutputAudioPcm(iOutBuf, iChannels, iSampleRate,
-                kBitDepth, AudioDataEndian::Big, iTrackOffset);
-            iOutBuf.SetBytes(0);
-        }
         if (iNewStreamStarted) {
             THROW(CodecStreamStart);
         }
@@ -22,6 +22,7 @@ public:
     ~CodecVorbis();
 protected: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo) override;
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const override;
     void StreamInitialise() override;
     void Process() override;
     TBool TrySeek(TUint aStreamId, TUint64 aSample) override;
@@ -50,8 +51,7 @@ private:
     class Pimpl;
     std::unique_ptr<Pimpl> iPimpl;
 
-    Bws<DecodedAudio::kMaxBytes> iInBuf;
-    Bws<DecodedAudio::kMaxBytes> iOutBuf;
+    Bws<DecodedAudio::kMaxBytes> iChainedPcm;   // first audio read from a new logical bitstream
     Bws<2*kSearchChunkSize> iSeekBuf;   // can store 2 read chunks, to check for sync word across read boundaries
 
     TUint iSampleRate;
@@ -23,6 +23,7 @@ public:
     ~CodecWav();
 private: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo);
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const;
     void StreamInitialise();
     void Process();
     TBool TrySeek(TUint aStreamId, TUint64 aSample);
@@ -85,6 +86,15 @@ CodecWav::~CodecWav()
     ClearAudioEncoded();
 }
 
+CodecBase::RecognitionHint CodecWav::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    const RecognitionHint hint = SniffSignature(aStreamStart, aStreamInfo, "RIFF");
+    if (hint != RecognitionHint::Likely) {
+        return hint;
+    }
+    return SniffSignature(aStreamStart, aStreamInfo, "WAVE", 8);
+}
+
 TBool CodecWav::Recognise(const EncodedStreamInfo& aStreamInfo)
 {
     if (aStreamInfo.StreamFormat() != EncodedStreamInfo::Format::Encoded) {
@@ -115,12 +115,12 @@ Msg* DecodedAudioAggregator::ProcessMsg(MsgDecodedStream* aMsg)
 
 Msg* DecodedAudioAggregator::ProcessMsg(MsgAudioPcm* aMsg)
 {
-    return TryAggregate(aMsg, kPcmPaddingBytes);
+    return TryAggregate(aMsg, kPcmPaddingBytes, aMsg->StorageBitDepth());
 }
 
 Msg* DecodedAudioAggregator::ProcessMsg(MsgAudioDsd* aMsg)
 {
-    return TryAggregate(aMsg, aMsg->JiffiesNonPlayable());
+    return TryAggregate(aMsg, aMsg->JiffiesNonPlayable(), iBitDepth);
 }
 
 Msg* DecodedAudioAggregator::ProcessMsg(MsgQuit* aMsg)
@@ -134,7 +134,7 @@ TBool DecodedAudioAggregator::AggregatorFull(TUint aBytes, TUint aJiffies)
     return (aBytes == DecodedAudio::kMaxBytes || aJiffies >= kMaxJiffies);
 }
 
-MsgAudioDecoded* DecodedAudioAggregator::TryAggregate(MsgAudioDecoded* aMsg, TUint aJiffiesNonPlayable)
+MsgAudioDecoded* DecodedAudioAggregator::TryAggregate(MsgAudioDecoded* aMsg, TUint aJiffiesNonPlayable, TUint aStoredBitDepth)
 {
     if (iAggregationDisabled) {
         return aMsg;
@@ -142,7 +142,7 @@ MsgAudioDecoded* DecodedAudioAggregator::TryAggregate(MsgAudioDecoded* aMsg, TUi
 
     TUint msgJiffies = aMsg->Jiffies() + aJiffiesNonPlayable; // addition of non playable jiffies prevents TryAggregate() from trying to write to buffer without enough free memory
     const TUint jiffiesPerSample = Jiffies::PerSample(iSampleRate);
-    const TUint msgBytes = Jiffies::ToBytes(msgJiffies, jiffiesPerSample, iChannels, iBitDepth); // jiffies might be modified here
+    const TUint msgBytes = Jiffies::ToBytes(msgJiffies, jiffiesPerSample, iChannels, aStoredBitDepth); // jiffies might be modified here
     ASSERT(msgJiffies == (aMsg->Jiffies() + aJiffiesNonPlayable)); // refuse to handle msgs not terminating on sample boundaries
 
     if (iDecodedAudio == nullptr) {
@@ -156,14 +156,14 @@ MsgAudioDecoded* DecodedAudioAggregator::TryAggregate(MsgAudioDecoded* aMsg, TUi
         }
     }
 
-    TUint aggregatedBytes = Jiffies::ToBytes(iAggregatedJiffies, jiffiesPerSample, iChannels, iBitDepth);
+    TUint aggregatedBytes = Jiffies::ToBytes(iAggregatedJiffies, jiffiesPerSample, iChannels, aStoredBitDepth);
 
     if (aggregatedBytes + msgBytes <= kMaxBytes) {
         // Have byte capacity to add new data.
         iDecodedAudio->Aggregate(aMsg);
 
         iAggregatedJiffies += msgJiffies;
-        aggregatedBytes = Jiffies::ToBytes(iAggregatedJiffies, jiffiesPerSample, iChannels, iBitDepth);
+        aggregatedBytes = Jiffies::ToBytes(iAggregatedJiffies, jiffiesPerSample, iChannels, aStoredBitDepth);
 
         if (AggregatorFull(aggregatedBytes, iAggregatedJiffies)) {
             auto msg = iDecodedAudio;
@@ -38,7 +38,7 @@ private: // IMsgProcessor
     Msg* ProcessMsg(MsgQuit* aMsg) override;
 private:
     static TBool AggregatorFull(TUint aBytes, TUint aJiffies);
-    MsgAudioDecoded* TryAggregate(MsgAudioDecoded* aMsg, TUint aJiffiesNonPlayable);
+    MsgAudioDecoded* TryAggregate(MsgAudioDecoded* aMsg, TUint aJiffiesNonPlayable, TUint aStoredBitDepth);
     void OutputAggregatedAudio();
 private:
     IPipelineElementDownstream& iDownstreamElement;
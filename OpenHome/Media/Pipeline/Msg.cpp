@@ -1,5 +1,6 @@
 #include <OpenHome/Media/Pipeline/Msg.h>
 #include <OpenHome/Media/Pipeline/RampArray.h>
+#include <OpenHome/Media/Pipeline/ElementObserver.h>
 #include <OpenHome/Types.h>
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Optional.h>
@@ -25,35 +26,161 @@ using namespace OpenHome::Media;
 const TChar* OpenHome::Media::kStreamPlayNames[] = { "Yes", "No", "Later" };
 
 
+// AllocatorMemoryBudget
+
+AllocatorMemoryBudget::AllocatorMemoryBudget(TUint aBytes, IInfoAggregator& aInfoAggregator)
+    : iBytesTotal(aBytes)
+    , iBytesReserved(0)
+    , iBytesReservedMax(0)
+    , iLock("PAL3")
+    , iReclaimThread(nullptr)
+    , iReclaimId(0)
+{
+    std::vector<Brn> infoQueries;
+    infoQueries.push_back(AllocatorBase::kQueryMemory);
+    aInfoAggregator.Register(*this, infoQueries);
+}
+
+void AllocatorMemoryBudget::SetReclaimThread(IPipelineElementObserverThread& aThread)
+{
+    ASSERT(iReclaimThread == nullptr);
+    iReclaimId = aThread.Register(MakeFunctor(*this, &AllocatorMemoryBudget::Reclaim));
+    iReclaimThread = &aThread;
+}
+
+void AllocatorMemoryBudget::AddAllocator(AllocatorBase& aAllocator)
+{
+    AutoMutex _(iLock);
+    iAllocators.push_back(&aAllocator);
+}
+
+void AllocatorMemoryBudget::RemoveAllocator(AllocatorBase& aAllocator)
+{
+    AutoMutex _(iLock);
+    auto it = std::find(iAllocators.begin(), iAllocators.end(), &aAllocator);
+    ASSERT(it != iAllocators.end());
+    iAllocators.erase(it);
+}
+
+TBool AllocatorMemoryBudget::TryReserve(TUint aBytes)
+{
+    TUint reserved = iBytesReserved.load();
+    do {
+        if (reserved > iBytesTotal || aBytes > iBytesTotal - reserved) {
+            return false;
+        }
+    } while (!iBytesReserved.compare_exchange_weak(reserved, reserved + aBytes));
+    UpdateReservedMax(reserved + aBytes);
+    return true;
+}
+
+void AllocatorMemoryBudget::Overdraw(TUint aBytes)
+{
+    const TUint reserved = (iBytesReserved += aBytes);
+    UpdateReservedMax(reserved);
+}
+
+void AllocatorMemoryBudget::Release(TUint aBytes)
+{
+    ASSERT(iBytesReserved.load() >= aBytes);
+    iBytesReserved -= aBytes;
+}
+
+void AllocatorMemoryBudget::ScheduleReclaim()
+{
+    if (iReclaimThread != nullptr) {
+        iReclaimThread->Schedule(iReclaimId);
+    }
+}
+
+void AllocatorMemoryBudget::Reclaim()
+{
+    AutoMutex _(iLock);
+    for (auto allocator : iAllocators) {
+        allocator->Reclaim();
+    }
+}
+
+TUint AllocatorMemoryBudget::BytesTotal() const
+{
+    return iBytesTotal;
+}
+
+TUint AllocatorMemoryBudget::BytesReserved() const
+{
+    return iBytesReserved.load();
+}
+
+TUint AllocatorMemoryBudget::BytesReservedMax() const
+{
+    return iBytesReservedMax.load();
+}
+
+void AllocatorMemoryBudget::UpdateReservedMax(TUint aReserved)
+{
+    TUint max = iBytesReservedMax.load(std::memory_order_relaxed);
+    while (aReserved > max && !iBytesReservedMax.compare_exchange_weak(max, aReserved, std::memory_order_relaxed)) {
+    }
+}
+
+void AllocatorMemoryBudget::QueryInfo(const Brx& aQuery, IWriter& aWriter)
+{
+    if (aQuery == AllocatorBase::kQueryMemory) {
+        WriterAscii writer(aWriter);
+        writer.Write(Brn("Allocator memory budget: "));
+        writer.WriteUint(iBytesTotal);
+        writer.Write(Brn(" bytes, resident:"));
+        writer.WriteUint(iBytesReserved.load());
+        writer.Write(Brn(" bytes, peak:"));
+        writer.WriteUint(iBytesReservedMax.load());
+        aWriter.Write(Brn(" bytes\n"));
+    }
+}
+
+
 // AllocatorBase
 
 const Brn AllocatorBase::kQueryMemory = Brn("memory");
 
 AllocatorBase::~AllocatorBase()
 {
-    LOG(kPipeline, "> ~AllocatorBase for %s. (Peak %u/%u)\n", iName, iCellsUsedMax, iFree.Slots());
-    const TUint slots = iFree.Slots();
-    for (TUint i=0; i<slots; i++) {
+    LOG(kPipeline, "> ~AllocatorBase for %s. (Peak %u/%u)\n", iName, iCellsUsedMax.load(), iCellsTotal);
+    if (iBudget != nullptr) {
+        iBudget->RemoveAllocator(*this);
+    }
+    // Only delete cells already on the free list.  Read() could try to grow the allocator.
+    const TUint cells = iCellsResident.load();
+    for (TUint i=0; i<cells; i++) {
         //Log::Print("  %u", i);
-        try {
-            Allocated* ptr = Read();
-            //Log::Print("(%p)", ptr);
-            delete ptr;
-        }
-        catch (AssertionFailed&) {
-            Log::Print("...leak at %u of %u\n", i+1, slots);
+        Allocated* ptr = TryRead();
+        if (ptr == nullptr) {
+            Log::Print("...leak at %u of %u\n", i+1, cells);
             ASSERTS();
         }
+        //Log::Print("(%p)", ptr);
+        delete ptr;
     }
+    if (iBudget != nullptr) {
+        iBudget->Release(cells * iCellBytes);
+    }
+    delete[] iNextFree;
+    delete[] iCells;
     LOG(kPipeline, "< ~AllocatorBase for %s\n", iName);
 }
 
 void AllocatorBase::Free(Allocated* aPtr)
 {
-    iLock.Wait();
-    iCellsUsed--;
-    iFree.Write(aPtr);
-    iLock.Signal();
+    const TUint cellsUsed = --iCellsUsed;
+    Write(aPtr);
+    if (iBudget != nullptr) {
+        // Reclaim once at least two slabs are unused.  Shrinking leaves a slab spare, so
+        // a pipeline hovering around a slab boundary doesn't repeatedly grow and shrink.
+        // Cells are destroyed by Reclaim() on another thread so Free() never blocks.
+        const TUint resident = iCellsResident.load(std::memory_order_relaxed);
+        if (resident > iSlabCells && resident >= cellsUsed + 2 * iSlabCells) {
+            iBudget->ScheduleReclaim();
+        }
+    }
 }
 
 TUint AllocatorBase::CellsTotal() const
@@ -68,75 +195,221 @@ TUint AllocatorBase::CellBytes() const
 
 TUint AllocatorBase::CellsUsed() const
 {
-    iLock.Wait();
-    TUint cellsUsed = iCellsUsed;
-    iLock.Signal();
-    return cellsUsed;
+    return iCellsUsed.load();
 }
 
 TUint AllocatorBase::CellsUsedMax() const
 {
-    iLock.Wait();
-    TUint cellsUsedMax = iCellsUsedMax;
-    iLock.Signal();
-    return cellsUsedMax;
+    return iCellsUsedMax.load();
 }
 
 void AllocatorBase::GetStats(TUint& aCellsTotal, TUint& aCellBytes, TUint& aCellsUsed, TUint& aCellsUsedMax) const
 {
     aCellsTotal = iCellsTotal;
     aCellBytes = iCellBytes;
-    iLock.Wait();
-    aCellsUsed = iCellsUsed;
-    aCellsUsedMax = iCellsUsedMax;
-    iLock.Signal();
+    aCellsUsed = iCellsUsed.load();
+    aCellsUsedMax = iCellsUsedMax.load();
 }
 
-AllocatorBase::AllocatorBase(const TChar* aName, TUint aNumCells, TUint aCellBytes, IInfoAggregator& aInfoAggregator)
-    : iFree(aNumCells)
-    , iLock("PAL1")
+TUint AllocatorBase::CellsResident() const
+{
+    return iCellsResident.load();
+}
+
+TUint AllocatorBase::CellsResidentMax() const
+{
+    return iCellsResidentMax.load();
+}
+
+AllocatorBase::AllocatorBase(const TChar* aName, TUint aNumCells, TUint aCellBytes, IInfoAggregator& aInfoAggregator,
+                             AllocatorMemoryBudget* aBudget)
+    : iFreeHead(0)
+    , iCellsAdded(0)
     , iName(aName)
     , iCellsTotal(aNumCells)
     , iCellBytes(aCellBytes)
     , iCellsUsed(0)
     , iCellsUsedMax(0)
-{
+    , iBudget(aBudget)
+    , iSlabCells(std::max((aNumCells + kSlabsPerAllocator - 1) / kSlabsPerAllocator, 1u))
+    , iLockResize("PAL2")
+    , iCellsResident(0)
+    , iCellsResidentMax(0)
+{
+    ASSERT(iFreeHead.is_lock_free());
+    iCells = new Allocated*[aNumCells];
+    iNextFree = new std::atomic<TUint>[aNumCells];
+    if (iBudget != nullptr) {
+        iIndexesVacant.reserve(aNumCells);
+        iBudget->AddAllocator(*this);
+    }
     std::vector<Brn> infoQueries;
     infoQueries.push_back(kQueryMemory);
     aInfoAggregator.Register(*this, infoQueries);
 }
 
+void AllocatorBase::AddCell(Allocated* aCell)
+{
+    ASSERT(iBudget == nullptr);
+    InsertCell(aCell);
+}
+
+void AllocatorBase::Populate()
+{
+    if (iBudget == nullptr) {
+        for (TUint i=0; i<iCellsTotal; i++) {
+            InsertCell(NewCell());
+        }
+    }
+    else {
+        (void)TryGrow();
+    }
+}
+
 Allocated* AllocatorBase::DoAllocate()
 {
-    iLock.Wait();
     Allocated* cell = Read();
     ASSERT_VA(cell->iRefCount == 0, "%s has count %u\n", iName, cell->iRefCount.load());
     cell->iRefCount = 1;
-    iCellsUsed++;
-    if (iCellsUsed > iCellsUsedMax) {
-        iCellsUsedMax = iCellsUsed;
+    const TUint cellsUsed = ++iCellsUsed;
+    TUint cellsUsedMax = iCellsUsedMax.load(std::memory_order_relaxed);
+    while (cellsUsed > cellsUsedMax &&
+           !iCellsUsedMax.compare_exchange_weak(cellsUsedMax, cellsUsed, std::memory_order_relaxed)) {
     }
-    iLock.Signal();
     return cell;
 }
 
+Allocated* AllocatorBase::NewCell()
+{
+    ASSERTS(); // only required by derived classes which call Populate()
+    return nullptr;
+}
+
 Allocated* AllocatorBase::Read()
 {
-    Allocated* p = nullptr;
-    try {
-        p = iFree.Read();
+    for (;;) {
+        Allocated* cell = TryRead();
+        if (cell != nullptr) {
+            return cell;
+        }
+        if (iBudget == nullptr || !TryGrow()) {
+            Log::Print("Warning: Allocator error for %s\n", iName);
+            ASSERTS();
+        }
     }
-    catch (FifoReadError&) {
-        Log::Print("Warning: Allocator error for %s\n", iName);
-        ASSERTS();
+}
+
+Allocated* AllocatorBase::TryRead()
+{
+    // Pop from the free stack.  The count in the upper half of iFreeHead changes on every
+    // push/pop so a cell that is popped then pushed back while we were reading iNextFree
+    // can't be mistaken for an unchanged stack (the ABA problem).
+    TUint64 head = iFreeHead.load(std::memory_order_acquire);
+    for (;;) {
+        const TUint index = (TUint)(head & kFreeIndexMask);
+        if (index == 0) {
+            return nullptr;
+        }
+        const TUint64 next = ((head >> 32) + 1) << 32 | iNextFree[index-1].load(std::memory_order_relaxed);
+        if (iFreeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire)) {
+            return iCells[index-1];
+        }
     }
-    return p;
+}
+
+void AllocatorBase::Write(Allocated* aCell)
+{
+    const TUint index = aCell->iCellIndex;
+    ASSERT(index > 0 && index <= iCellsTotal && iCells[index-1] == aCell);
+    TUint64 head = iFreeHead.load(std::memory_order_relaxed);
+    TUint64 next;
+    do {
+        iNextFree[index-1].store((TUint)(head & kFreeIndexMask), std::memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | index;
+    } while (!iFreeHead.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void AllocatorBase::InsertCell(Allocated* aCell)
+{
+    TUint index;
+    if (iIndexesVacant.size() > 0) {
+        index = iIndexesVacant.back();
+        iIndexesVacant.pop_back();
+    }
+    else {
+        ASSERT(iCellsAdded < iCellsTotal);
+        index = ++iCellsAdded;
+    }
+    iCells[index-1] = aCell;
+    aCell->iCellIndex = index;
+    // count the cell as resident before it's visible to DoAllocate() so that
+    // iCellsUsed can never exceed iCellsResident
+    const TUint resident = ++iCellsResident;
+    TUint residentMax = iCellsResidentMax.load(std::memory_order_relaxed);
+    while (resident > residentMax &&
+           !iCellsResidentMax.compare_exchange_weak(residentMax, resident, std::memory_order_relaxed)) {
+    }
+    Write(aCell);
+}
+
+TBool AllocatorBase::TryGrow()
+{
+    AutoMutex _(iLockResize);
+    if ((iFreeHead.load() & kFreeIndexMask) != 0) {
+        return true; // another thread grew (or a cell was freed) while we waited for the lock
+    }
+    const TUint cellsMax = std::min(iSlabCells, iCellsTotal - iCellsResident.load());
+    if (cellsMax == 0) {
+        return false;
+    }
+    TUint cells = cellsMax;
+    while (cells > 0 && !iBudget->TryReserve(cells * iCellBytes)) {
+        cells /= 2;
+    }
+    if (cells == 0) {
+        // Budget exhausted.  Carry on growing (a fixed allocator would have created all
+        // of its cells anyway) rather than failing, but report the overdraft.
+        cells = cellsMax;
+        iBudget->Overdraw(cells * iCellBytes);
+        Log::Print("Warning: memory budget exceeded growing %s to %u cells\n", iName, iCellsResident.load() + cells);
+    }
+    for (TUint i=0; i<cells; i++) {
+        InsertCell(NewCell());
+    }
+    LOG(kPipeline, "Allocator %s grew to %u cells\n", iName, iCellsResident.load());
+    return true;
+}
+
+void AllocatorBase::Reclaim()
+{
+    if (iBudget == nullptr) {
+        return;
+    }
+    AutoMutex _(iLockResize);
+    const TUint resident = iCellsResident.load();
+    const TUint target = std::max(iSlabCells, iCellsUsed.load() + iSlabCells);
+    if (resident < target + iSlabCells) {
+        return; // not enough unused cells to be worth reclaiming
+    }
+    TUint released = 0;
+    while (iCellsResident.load() > target) {
+        Allocated* cell = TryRead();
+        if (cell == nullptr) {
+            break; // all remaining free cells were allocated under us
+        }
+        iCells[cell->iCellIndex-1] = nullptr;
+        iIndexesVacant.push_back(cell->iCellIndex);
+        iCellsResident--;
+        delete cell;
+        released++;
+    }
+    iBudget->Release(released * iCellBytes);
+    LOG(kPipeline, "Allocator %s shrank to %u cells\n", iName, iCellsResident.load());
 }
 
 void AllocatorBase::QueryInfo(const Brx& aQuery, IWriter& aWriter)
 {
-    // Note that value of iCellsUsed may be slightly out of date as Allocator doesn't hold any lock while updating its fifo and iCellsUsed
-    AutoMutex a(iLock);
+    // Note that value of iCellsUsed may be slightly out of date as Allocator doesn't hold any lock while updating its free list and iCellsUsed
     if (aQuery == kQueryMemory) {
         WriterAscii writer(aWriter);
         writer.Write(Brn("Allocator: "));
@@ -146,10 +419,14 @@ void AllocatorBase::QueryInfo(const Brx& aQuery, IWriter& aWriter)
         writer.Write(Brn(" cells x "));
         writer.WriteUint(iCellBytes);
         writer.Write(Brn(" bytes, in use:"));
-        writer.WriteUint(iCellsUsed);
+        writer.WriteUint(iCellsUsed.load());
         writer.Write(Brn(" cells, peak:"));
-        writer.WriteUint(iCellsUsedMax);
-        aWriter.Write(Brn(" cells\n"));
+        writer.WriteUint(iCellsUsedMax.load());
+        writer.Write(Brn(" cells, resident:"));
+        writer.WriteUint(iCellsResident.load() * iCellBytes);
+        writer.Write(Brn(" bytes, peak resident:"));
+        writer.WriteUint(iCellsResidentMax.load() * iCellBytes);
+        aWriter.Write(Brn(" bytes\n"));
     }
 }
 
@@ -178,6 +455,7 @@ void Allocated::Clear()
 Allocated::Allocated(AllocatorBase& aAllocator)
     : iAllocator(aAllocator)
     , iRefCount(0)
+    , iCellIndex(0)
 {
     ASSERT(iRefCount.is_lock_free());
 }
@@ -344,11 +622,45 @@ void DecodedAudio::SetBytes(TUint aBytes)
     iData.SetBytes(aBytes);
 }
 
-void DecodedAudio::ConstructPcm(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian)
+void DecodedAudio::ExpandToInt32(TUint aOffsetBytes, TUint aNumSubsamples, TUint aBitDepth)
+{
+    const TUint subsampleBytes = aBitDepth / 8;
+    ASSERT(aOffsetBytes + (aNumSubsamples * sizeof(TInt32)) <= iData.MaxBytes());
+    TByte* base = const_cast<TByte*>(iData.Ptr()) + aOffsetBytes;
+    /* Work backwards from the final subsample.  Each output subsample is at least as
+       large as its input so no input is overwritten before it has been read. */
+    for (TUint i=aNumSubsamples; i>0; i--) {
+        const TByte* src = base + ((i-1) * subsampleBytes);
+        TUint32 subsample = 0;
+        for (TUint j=0; j<subsampleBytes; j++) {
+            subsample = (subsample << 8) | src[j];
+        }
+        subsample <<= (32 - aBitDepth);
+        (void)memcpy(base + ((i-1) * sizeof(TInt32)), &subsample, sizeof(TInt32));
+    }
+}
+
+TUint DecodedAudio::BytesPerSubsample(PcmStorage aStorage, TUint aBitDepth)
+{ // static
+    if (aStorage == PcmStorage::Int32) {
+        return sizeof(TInt32);
+    }
+    return aBitDepth / 8;
+}
+
+void DecodedAudio::ConstructPcm(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian, PcmStorage aStorage)
 {
     ASSERT((aBitDepth & 7) == 0);
     ASSERT(aData.Bytes() % (aBitDepth/8) == 0);
     TByte* ptr = const_cast<TByte*>(iData.Ptr());
+    if (aStorage == PcmStorage::Int32) {
+        const TUint numSubsamples = aData.Bytes() / (aBitDepth/8);
+        const TUint bytes = numSubsamples * sizeof(TInt32);
+        ASSERT(bytes <= iData.MaxBytes());
+        CopyToInt32(aData, aBitDepth, aEndian, reinterpret_cast<TInt32*>(ptr));
+        iData.SetBytes(bytes);
+        return;
+    }
     if (aEndian == AudioDataEndian::Big || aBitDepth == 8) {
         (void)memcpy(ptr, aData.Ptr(), aData.Bytes());
     }
@@ -407,6 +719,59 @@ void DecodedAudio::CopyToBigEndian32(const Brx& aData, TByte* aDest)
     }
 }
 
+void DecodedAudio::CopyToInt32(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian, TInt32* aDest)
+{ // static
+    const TByte* src = aData.Ptr();
+    const TByte* end = src + aData.Bytes();
+    const TBool little = (aEndian == AudioDataEndian::Little);
+    switch (aBitDepth)
+    {
+    case 8:
+        for (; src<end; src++) {
+            *aDest++ = (TInt32)((TUint32)src[0] << 24);
+        }
+        break;
+    case 16:
+        if (little) {
+            for (; src<end; src+=2) {
+                *aDest++ = (TInt32)(((TUint32)src[1] << 24) | ((TUint32)src[0] << 16));
+            }
+        }
+        else {
+            for (; src<end; src+=2) {
+                *aDest++ = (TInt32)(((TUint32)src[0] << 24) | ((TUint32)src[1] << 16));
+            }
+        }
+        break;
+    case 24:
+        if (little) {
+            for (; src<end; src+=3) {
+                *aDest++ = (TInt32)(((TUint32)src[2] << 24) | ((TUint32)src[1] << 16) | ((TUint32)src[0] << 8));
+            }
+        }
+        else {
+            for (; src<end; src+=3) {
+                *aDest++ = (TInt32)(((TUint32)src[0] << 24) | ((TUint32)src[1] << 16) | ((TUint32)src[2] << 8));
+            }
+        }
+        break;
+    case 32:
+        if (little) {
+            for (; src<end; src+=4) {
+                *aDest++ = (TInt32)(((TUint32)src[3] << 24) | ((TUint32)src[2] << 16) | ((TUint32)src[1] << 8) | (TUint32)src[0]);
+            }
+        }
+        else {
+            for (; src<end; src+=4) {
+                *aDest++ = (TInt32)(((TUint32)src[0] << 24) | ((TUint32)src[1] << 16) | ((TUint32)src[2] << 8) | (TUint32)src[3]);
+            }
+        }
+        break;
+    default: // unsupported bit depth
+        ASSERTS();
+    }
+}
+
 
 // Jiffies
 
@@ -808,94 +1173,270 @@ Ramp Ramp::Split(TUint aNewSize, TUint aCurrentSize)
 
 
 // RampApplicator
+//
+// Ramps are applied a block of samples at a time.  Packed big-endian subsamples are
+// unpacked into left-justified 32-bit values (PcmStorage::Int32 audio is already in this
+// form), multiplied by the (Q15) ramp curve and repacked at their original bit depth.
+// Unpack/pack routines are chosen once per call to Start(); the multiply is vectorised
+// where the target supports it.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define RAMP_APPLICATOR_SSE2
+# include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define RAMP_APPLICATOR_NEON
+# include <arm_neon.h>
+#endif
+
+static void RampUnpack8(const TByte* aSrc, TInt32* aDest, TUint aNumSubsamples)
+{
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        aDest[i] = (TInt32)((TUint32)aSrc[i] << 24);
+    }
+}
+
+static void RampUnpack16(const TByte* aSrc, TInt32* aDest, TUint aNumSubsamples)
+{
+    for (TUint i=0; i<aNumSubsamples; i++, aSrc+=2) {
+        aDest[i] = (TInt32)(((TUint32)aSrc[0] << 24) | ((TUint32)aSrc[1] << 16));
+    }
+}
+
+static void RampUnpack24(const TByte* aSrc, TInt32* aDest, TUint aNumSubsamples)
+{
+    for (TUint i=0; i<aNumSubsamples; i++, aSrc+=3) {
+        aDest[i] = (TInt32)(((TUint32)aSrc[0] << 24) | ((TUint32)aSrc[1] << 16) | ((TUint32)aSrc[2] << 8));
+    }
+}
+
+static void RampUnpack32(const TByte* aSrc, TInt32* aDest, TUint aNumSubsamples)
+{
+    for (TUint i=0; i<aNumSubsamples; i++, aSrc+=4) {
+        aDest[i] = (TInt32)(((TUint32)aSrc[0] << 24) | ((TUint32)aSrc[1] << 16) | ((TUint32)aSrc[2] << 8) | (TUint32)aSrc[3]);
+    }
+}
+
+static void RampUnpackInt32(const TByte* aSrc, TInt32* aDest, TUint aNumSubsamples)
+{
+    (void)memcpy(aDest, aSrc, aNumSubsamples * sizeof(TInt32));
+}
+
+static void RampPack8(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples, TUint /*aNumChannels*/)
+{
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        aDest[i] = (TByte)(aSrc[i] >> 24);
+    }
+}
+
+static void RampPack16(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples, TUint /*aNumChannels*/)
+{
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        const TUint32 subsample = (TUint32)aSrc[i];
+        *aDest++ = (TByte)(subsample >> 24);
+        *aDest++ = (TByte)(subsample >> 16);
+    }
+}
+
+static void RampPack24(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples, TUint /*aNumChannels*/)
+{
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        const TUint32 subsample = (TUint32)aSrc[i];
+        *aDest++ = (TByte)(subsample >> 24);
+        *aDest++ = (TByte)(subsample >> 16);
+        *aDest++ = (TByte)(subsample >> 8);
+    }
+}
+
+static void RampPack32(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples, TUint /*aNumChannels*/)
+{
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        const TUint32 subsample = (TUint32)aSrc[i];
+        *aDest++ = (TByte)(subsample >> 24);
+        *aDest++ = (TByte)(subsample >> 16);
+        *aDest++ = (TByte)(subsample >> 8);
+        *aDest++ = (TByte)subsample;
+    }
+}
+
+static void RampPack32ChannelTagged(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples, TUint aNumChannels)
+{ // 6 channel 32-bit audio carries the channel id in its least significant byte (for efficiency on 6channel 192k)
+    TUint channel = 0;
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        const TUint32 subsample = (TUint32)aSrc[i];
+        *aDest++ = (TByte)(subsample >> 24);
+        *aDest++ = (TByte)(subsample >> 16);
+        *aDest++ = (TByte)(subsample >> 8);
+        *aDest++ = (TByte)(channel << 4);
+        if (++channel == aNumChannels) {
+            channel = 0;
+        }
+    }
+}
+
+static void RampPackInt32(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples, TUint /*aNumChannels*/)
+{
+    (void)memcpy(aDest, aSrc, aNumSubsamples * sizeof(TInt32));
+}
 
 const TUint RampApplicator::kFullRampSpan = Ramp::kMax - Ramp::kMin;
 
 RampApplicator::RampApplicator(const Media::Ramp& aRamp)
     : iRamp(aRamp)
     , iPtr(nullptr)
+    , iUnpack(nullptr)
+    , iPack(nullptr)
 {
 }
 
 TUint RampApplicator::Start(const Brx& aData, TUint aBitDepth, TUint aNumChannels)
+{
+    DoStart(aData, aBitDepth, aNumChannels, aBitDepth/8);
+    switch (iBitDepth)
+    {
+    case 8:
+        iUnpack = RampUnpack8;
+        break;
+    case 16:
+        iUnpack = RampUnpack16;
+        break;
+    case 24:
+        iUnpack = RampUnpack24;
+        break;
+    case 32:
+        iUnpack = RampUnpack32;
+        break;
+    default:
+        ASSERTS();
+    }
+    return iNumSamples;
+}
+
+TUint RampApplicator::StartInt32(const Brx& aData, TUint aBitDepth, TUint aNumChannels)
+{
+    DoStart(aData, aBitDepth, aNumChannels, sizeof(TInt32));
+    iUnpack = RampUnpackInt32;
+    return iNumSamples;
+}
+
+void RampApplicator::DoStart(const Brx& aData, TUint aBitDepth, TUint aNumChannels, TUint aSrcBytesPerSubsample)
 {
     iPtr = aData.Ptr();
     iBitDepth = aBitDepth;
     iNumChannels = aNumChannels;
-    ASSERT_DEBUG(aData.Bytes() % ((iBitDepth/8) * iNumChannels) == 0);
-    iNumSamples = (TInt)(aData.Bytes() / ((iBitDepth/8) * iNumChannels));
+    ASSERT(iNumChannels <= DecodedAudio::kMaxNumChannels);
+    iSrcBytesPerSample = aSrcBytesPerSubsample * iNumChannels;
+    iBytesPerSample = (iBitDepth/8) * iNumChannels;
+    ASSERT_DEBUG(aData.Bytes() % iSrcBytesPerSample == 0);
+    iNumSamples = (TInt)(aData.Bytes() / iSrcBytesPerSample);
     iTotalRamp = (iRamp.Start() - iRamp.End());
     iLoopCount = 0;
-    return iNumSamples;
+    switch (iBitDepth)
+    {
+    case 8:
+        iPack = RampPack8;
+        break;
+    case 16:
+        iPack = RampPack16;
+        break;
+    case 24:
+        iPack = RampPack24;
+        break;
+    case 32:
+        iPack = (iNumChannels == 6? RampPack32ChannelTagged : RampPack32);
+        break;
+    default:
+        ASSERTS();
+    }
 }
 
-void RampApplicator::GetNextSample(TByte* aDest)
+inline TInt32 RampApplicator::NextMultiplier()
 {
-    ASSERT_DEBUG(iPtr != nullptr);
     const TUint16 ramp = (iNumSamples==1? (TUint16)iRamp.Start() : (TUint16)(iRamp.Start() - ((iLoopCount * iTotalRamp)/(iNumSamples-1))));
-    //Log::Print(" %04x ", ramp);
     const TUint rampIndex = std::min(kRampArrayCount-1, (kFullRampSpan - ramp + (1<<4)) >> 5); // assumes fullRampSpan==2^14 and kRampArray has 512 (2^9) items. (1<<4 allows rounding up)
-    for (TUint i=0; i<iNumChannels; i++) {
-        TInt16 subsample16 = 0;
-        switch (iBitDepth)
-        {
-        case 8:
-            subsample16 = *iPtr++ << 8;
-            break;
-        case 16:
-            subsample16 = *iPtr++ << 8;
-            subsample16 += *iPtr++;
-            break;
-        case 24:
-            subsample16 = *iPtr++ << 8;
-            subsample16 += *iPtr++;
-            iPtr++;
-            break;
-        case 32:
-            subsample16 = *iPtr++ << 8;
-            subsample16 += *iPtr++;
-            iPtr++;
-            iPtr++;
-            break;
-        default:
-            ASSERTS();
-        }
-        //Log::Print(" %03u ", rampIndex);
-        const TUint16 rampMult = static_cast<TUint16>(kRampArray[rampIndex]);
-        TInt rampedSubsample = (rampIndex==512? 0 : (subsample16 * rampMult) >> 15);
-        //Log::Print("Original=%04x (%d), ramped=%04x (%d), rampIndex=%u\n", subsample, subsample, rampedSubsample, rampedSubsample, rampIndex);
-
-        switch (iBitDepth)
-        {
-        case 8:
-            *aDest++ = (TByte)(rampedSubsample >> 8);
-            break;
-        case 16:
-            *aDest++ = (TByte)(rampedSubsample >> 8);
-            *aDest++ = (TByte)rampedSubsample;
-            break;
-        case 24:
-            *aDest++ = (TByte)(rampedSubsample >> 8);
-            *aDest++ = (TByte)rampedSubsample;
-            *aDest++ = (TByte)0;
-            break;
-        case 32:
-            *aDest++ = (TByte)(rampedSubsample >> 8);
-            *aDest++ = (TByte)rampedSubsample;
-            *aDest++ = (TByte)0;
-            if(iNumChannels == 6) {
-                *aDest++ = (TByte)i<<4; //set channel id for efficiency on 6channel 192k
-            }
-            else {
-                *aDest++ = (TByte)0;
+    iLoopCount++;
+    return (TInt32)kRampArray[rampIndex];
+}
+
+void RampApplicator::GetNextSample(TByte* aDest)
+{
+    (void)GetNextSamples(aDest, 1);
+}
+
+TUint RampApplicator::GetNextSamples(TByte* aDest, TUint aMaxSamples)
+{
+    return DoGetNextSamples(aDest, aMaxSamples, iPack, iBytesPerSample);
+}
+
+TUint RampApplicator::GetNextSamplesInt32(TInt32* aDest, TUint aMaxSamples)
+{
+    return DoGetNextSamples(reinterpret_cast<TByte*>(aDest), aMaxSamples, RampPackInt32, sizeof(TInt32) * iNumChannels);
+}
+
+TUint RampApplicator::DoGetNextSamples(TByte* aDest, TUint aMaxSamples, PackFunction aPack, TUint aDestBytesPerSample)
+{
+    ASSERT_DEBUG(iPtr != nullptr);
+    const TUint numSamples = std::min(aMaxSamples, (TUint)(iNumSamples - iLoopCount));
+    const TUint samplesPerBlock = kMaxBlockSubsamples / iNumChannels;
+    TInt32 subsamples[kMaxBlockSubsamples];
+    TInt32 multipliers[kMaxBlockSubsamples];
+    TUint remaining = numSamples;
+    while (remaining > 0) {
+        const TUint blockSamples = std::min(samplesPerBlock, remaining);
+        const TUint blockSubsamples = blockSamples * iNumChannels;
+        TInt32* mult = multipliers;
+        for (TUint i=0; i<blockSamples; i++) {
+            const TInt32 multiplier = NextMultiplier();
+            for (TUint j=0; j<iNumChannels; j++) {
+                *mult++ = multiplier;
             }
-            break;
-        default:
-            ASSERTS();
         }
+        iUnpack(iPtr, subsamples, blockSubsamples);
+        ApplyMultipliers(subsamples, multipliers, blockSubsamples);
+        aPack(subsamples, aDest, blockSubsamples, iNumChannels);
+        iPtr += blockSamples * iSrcBytesPerSample;
+        aDest += blockSamples * aDestBytesPerSample;
+        remaining -= blockSamples;
     }
+    return numSamples;
+}
 
-    iLoopCount++;
+void RampApplicator::ApplyMultipliers(TInt32* aSubsamples, const TInt32* aMultipliers, TUint aNumSubsamples)
+{ // static
+    TUint i = 0;
+#if defined(RAMP_APPLICATOR_SSE2)
+    /* SSE2 has no signed 32x32 multiply so split each subsample into signed high and
+       unsigned low halves.  As multipliers are <2^15,
+           (s * m) >> 15 == ((s >> 16) * m * 2) + (((s & 0xffff) * m) >> 15)
+       with every intermediate fitting in 32 bits. */
+    const __m128i maskLow = _mm_set1_epi32(0xffff);
+    for (; i+4 <= aNumSubsamples; i+=4) {
+        const __m128i subsamples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSubsamples + i));
+        const __m128i mult = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aMultipliers + i));
+        const __m128i high = _mm_srai_epi32(subsamples, 16);
+        const __m128i low = _mm_and_si128(subsamples, maskLow);
+        const __m128i highProduct = _mm_madd_epi16(high, mult); // upper half of each mult lane is zero
+        const __m128i lowProduct = _mm_or_si128(_mm_mullo_epi16(low, mult),
+                                                _mm_slli_epi32(_mm_mulhi_epu16(low, mult), 16));
+        const __m128i ramped = _mm_add_epi32(_mm_slli_epi32(highProduct, 1), _mm_srli_epi32(lowProduct, 15));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(aSubsamples + i), ramped);
+    }
+#elif defined(RAMP_APPLICATOR_NEON)
+    for (; i+4 <= aNumSubsamples; i+=4) {
+        const int32x4_t subsamples = vld1q_s32(aSubsamples + i);
+        const int32x4_t mult = vld1q_s32(aMultipliers + i);
+        const int64x2_t productLow = vmull_s32(vget_low_s32(subsamples), vget_low_s32(mult));
+        const int64x2_t productHigh = vmull_s32(vget_high_s32(subsamples), vget_high_s32(mult));
+        vst1q_s32(aSubsamples + i, vcombine_s32(vshrn_n_s64(productLow, 15), vshrn_n_s64(productHigh, 15)));
+    }
+#endif
+    ApplyMultipliersScalar(aSubsamples + i, aMultipliers + i, aNumSubsamples - i);
+}
+
+void RampApplicator::ApplyMultipliersScalar(TInt32* aSubsamples, const TInt32* aMultipliers, TUint aNumSubsamples)
+{ // static
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        aSubsamples[i] = (TInt32)(((TInt64)aSubsamples[i] * aMultipliers[i]) >> 15);
+    }
 }
 
 TUint RampApplicator::MedianMultiplier(const Media::Ramp& aRamp)
@@ -920,12 +1461,116 @@ TUint RampApplicator::MedianMultiplier(const Media::Ramp& aRamp)
 }
 
 
+// TrackStoragePool
+
+TrackStoragePool::TrackStoragePool(IInfoAggregator& aInfoAggregator)
+    : iLock("TSPL")
+    , iBytesInUse(0)
+    , iBytesResident(0)
+    , iBytesResidentMax(0)
+{
+    for (TUint i=0; i<kNumSizeClasses; i++) {
+        iFree[i] = nullptr;
+    }
+    std::vector<Brn> infoQueries;
+    infoQueries.push_back(AllocatorBase::kQueryMemory);
+    aInfoAggregator.Register(*this, infoQueries);
+}
+
+TrackStoragePool::~TrackStoragePool()
+{
+    ASSERT_VA(iBytesInUse == 0, "TrackStoragePool - %u bytes leaked\n", iBytesInUse);
+    for (auto slab : iSlabs) {
+        delete[] slab;
+    }
+}
+
+TByte* TrackStoragePool::Allocate(TUint aBytes)
+{
+    const TUint sizeClass = SizeClass(aBytes);
+    const TUint blockBytes = 1 << (sizeClass + kMinBlockShift);
+    AutoMutex _(iLock);
+    if (iFree[sizeClass] == nullptr) {
+        const TUint slabBytes = (blockBytes > kSlabBytes? blockBytes : kSlabBytes);
+        TByte* slab = new TByte[slabBytes];
+        iSlabs.push_back(slab);
+        for (TUint offset = slabBytes; offset > 0; ) {
+            offset -= blockBytes;
+            TByte* block = slab + offset;
+            *reinterpret_cast<TByte**>(block) = iFree[sizeClass];
+            iFree[sizeClass] = block;
+        }
+        iBytesResident += slabBytes;
+        iBytesResidentMax = std::max(iBytesResidentMax, iBytesResident);
+    }
+    TByte* block = iFree[sizeClass];
+    iFree[sizeClass] = *reinterpret_cast<TByte**>(block);
+    iBytesInUse += blockBytes;
+    return block;
+}
+
+void TrackStoragePool::Free(TByte* aPtr, TUint aBytes)
+{
+    const TUint sizeClass = SizeClass(aBytes);
+    AutoMutex _(iLock);
+    *reinterpret_cast<TByte**>(aPtr) = iFree[sizeClass];
+    iFree[sizeClass] = aPtr;
+    iBytesInUse -= 1 << (sizeClass + kMinBlockShift);
+}
+
+TUint TrackStoragePool::BytesInUse() const
+{
+    AutoMutex _(iLock);
+    return iBytesInUse;
+}
+
+TUint TrackStoragePool::BytesResident() const
+{
+    AutoMutex _(iLock);
+    return iBytesResident;
+}
+
+TUint TrackStoragePool::BytesResidentMax() const
+{
+    AutoMutex _(iLock);
+    return iBytesResidentMax;
+}
+
+TUint TrackStoragePool::SizeClass(TUint aBytes)
+{ // static
+    ASSERT(aBytes > 0 && aBytes <= (1u << kMaxBlockShift));
+    TUint sizeClass = 0;
+    while ((1u << (sizeClass + kMinBlockShift)) < aBytes) {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+void TrackStoragePool::QueryInfo(const Brx& aQuery, IWriter& aWriter)
+{
+    if (aQuery == AllocatorBase::kQueryMemory) {
+        AutoMutex _(iLock);
+        WriterAscii writer(aWriter);
+        writer.Write(Brn("Track storage: in use:"));
+        writer.WriteUint(iBytesInUse);
+        writer.Write(Brn(" bytes, resident:"));
+        writer.WriteUint(iBytesResident);
+        writer.Write(Brn(" bytes, peak:"));
+        writer.WriteUint(iBytesResidentMax);
+        aWriter.Write(Brn(" bytes\n"));
+    }
+}
+
+
 // Track
 
 Track::Track(AllocatorBase& aAllocator)
     : Allocated(aAllocator)
+    , iStoragePool(nullptr)
+    , iStorage(nullptr)
+    , iStorageBytes(0)
+    , iId(kIdNone)
 {
-    Clear();
 }
 
 const Brx& Track::Uri() const
@@ -943,23 +1588,34 @@ TUint Track::Id() const
     return iId;
 }
 
-void Track::Initialise(const Brx& aUri, const Brx& aMetaData, TUint aId)
+void Track::Initialise(TrackStoragePool& aStoragePool, const Brx& aUri, const Brx& aMetaData, TUint aId)
 {
-    iUri.ReplaceThrow(aUri);
-    if (aMetaData.Bytes() > iMetaData.MaxBytes()) {
-        iMetaData.Replace(aMetaData.Split(0, iMetaData.MaxBytes()));
+    if (aUri.Bytes() > kTrackUriMaxBytes) {
+        THROW(BufferOverflow);
     }
-    else {
-        iMetaData.Replace(aMetaData);
+    const TUint metaDataBytes = std::min(aMetaData.Bytes(), kTrackMetaDataMaxBytes);
+    iStoragePool = &aStoragePool;
+    iStorageBytes = aUri.Bytes() + metaDataBytes;
+    if (iStorageBytes > 0) {
+        iStorage = aStoragePool.Allocate(iStorageBytes);
+        (void)memcpy(iStorage, aUri.Ptr(), aUri.Bytes());
+        (void)memcpy(iStorage + aUri.Bytes(), aMetaData.Ptr(), metaDataBytes);
     }
+    iUri.Set(iStorage, aUri.Bytes());
+    iMetaData.Set(iStorage + aUri.Bytes(), metaDataBytes);
     iId = aId;
 }
 
 void Track::Clear()
 {
+    if (iStorage != nullptr) {
+        iStoragePool->Free(iStorage, iStorageBytes);
+        iStorage = nullptr;
+    }
+    iStorageBytes = 0;
+    iUri.Set(Brx::Empty());
+    iMetaData.Set(Brx::Empty());
 #ifdef DEFINE_DEBUG
-    iUri.SetBytes(0);
-    iMetaData.SetBytes(0);
     iId = UINT_MAX;
 #endif // DEFINE_DEBUG
 }
@@ -2228,9 +2884,15 @@ MsgAudio* MsgAudioPcm::Clone()
     MsgAudioPcm* clone = static_cast<MsgAudioPcm*>(MsgAudioDecoded::Clone());
     clone->iAllocatorPlayablePcm = iAllocatorPlayablePcm;
     clone->iAttenuation = iAttenuation;
+    clone->iStorage = iStorage;
     return clone;
 }
 
+TUint MsgAudioPcm::StorageBitDepth() const
+{
+    return (iStorage == PcmStorage::Int32? 32 : iBitDepth);
+}
+
 MsgPlayable* MsgAudioPcm::CreatePlayable()
 {
     TUint offsetJiffies = iOffset;
@@ -2240,13 +2902,14 @@ MsgPlayable* MsgAudioPcm::CreatePlayable()
     const TUint sizeBytes = Jiffies::ToBytes(sizeJiffies, jiffiesPerSample, iNumChannels, iBitDepth);
     // both size & offset will be rounded down if they don't fall on a sample boundary
     // we don't risk losing any data doing this as the start and end of each DecodedAudio's data fall on sample boundaries
+    // both are expressed in packed bytes at iBitDepth, regardless of how the audio is stored
 
     MsgPlayable* playable;
     if (iRamp.Direction() != Ramp::EMute) {
         auto playablePcm = iAllocatorPlayablePcm->Allocate();
         Optional<IPipelineBufferObserver> bufferObserver(iPipelineBufferObserver);
         playablePcm->Initialise(iAudioData, sizeBytes, iSize, iSampleRate, iBitDepth, iNumChannels,
-                                offsetBytes, iAttenuation, iRamp, bufferObserver);
+                                offsetBytes, iAttenuation, iStorage, iRamp, bufferObserver);
         playable = playablePcm;
     }
     else {
@@ -2262,17 +2925,19 @@ MsgPlayable* MsgAudioPcm::CreatePlayable()
 }
 
 void MsgAudioPcm::Initialise(DecodedAudio* aDecodedAudio, TUint aSampleRate, TUint aBitDepth, TUint aChannels, TUint64 aTrackOffset,
+                             PcmStorage aStorage,
                              Allocator<MsgPlayablePcm>& aAllocatorPlayablePcm,
                              Allocator<MsgPlayableSilence>& aAllocatorPlayableSilence)
 {
     const TUint bytes = aDecodedAudio->Bytes();
-    const TUint byteDepth = aBitDepth / 8;
+    const TUint byteDepth = DecodedAudio::BytesPerSubsample(aStorage, aBitDepth);
     ASSERT(bytes % byteDepth == 0);
     const TUint numSubsamples = bytes / byteDepth;
     MsgAudioDecoded::Initialise(aDecodedAudio, aSampleRate, aBitDepth, aChannels,
                                 aTrackOffset, numSubsamples, aAllocatorPlayableSilence);
     iAllocatorPlayablePcm = &aAllocatorPlayablePcm;
     iAttenuation = MsgAudioPcm::kUnityAttenuation;
+    iStorage = aStorage;
 }
 
 void MsgAudioPcm::SplitCompleted(MsgAudio& aRemaining)
@@ -2281,6 +2946,7 @@ void MsgAudioPcm::SplitCompleted(MsgAudio& aRemaining)
     MsgAudioPcm& remaining = static_cast<MsgAudioPcm&>(aRemaining);
     remaining.iAllocatorPlayablePcm = iAllocatorPlayablePcm;
     remaining.iAttenuation = iAttenuation;
+    remaining.iStorage = iStorage;
 }
 
 MsgAudio* MsgAudioPcm::Allocate()
@@ -2292,6 +2958,7 @@ void MsgAudioPcm::Clear()
 {
     MsgAudioDecoded::Clear();
     iAttenuation = MsgAudioPcm::kUnityAttenuation;
+    iStorage = PcmStorage::PackedBigEndian;
 }
 
 Msg* MsgAudioPcm::Process(IMsgProcessor& aProcessor)
@@ -2652,6 +3319,15 @@ void MsgPlayable::Read(IPcmProcessor& aProcessor)
     aProcessor.EndBlock();
 }
 
+void MsgPlayable::Read(IPcmProcessorInt32& aProcessor)
+{
+    aProcessor.BeginBlock();
+    if (iSize > 0) {
+        ReadBlock(aProcessor);
+    }
+    aProcessor.EndBlock();
+}
+
 void MsgPlayable::Read(IDsdProcessor& aProcessor)
 {
     aProcessor.BeginBlock();
@@ -2709,6 +3385,11 @@ void MsgPlayable::ReadBlock(IPcmProcessor& /*aProcessor*/)
     ASSERTS();
 }
 
+void MsgPlayable::ReadBlock(IPcmProcessorInt32& /*aProcessor*/)
+{
+    ASSERTS();
+}
+
 void MsgPlayable::ReadBlock(IDsdProcessor& /*aProcessor*/)
 {
     ASSERTS();
@@ -2723,14 +3404,28 @@ MsgPlayablePcm::MsgPlayablePcm(AllocatorBase& aAllocator)
 }
 
 void MsgPlayablePcm::Initialise(DecodedAudio* aDecodedAudio, TUint aSizeBytes, TUint aJiffies, TUint aSampleRate, TUint aBitDepth,
-                                TUint aNumChannels, TUint aOffsetBytes, TUint aAttenuation, const Media::Ramp& aRamp,
-                                Optional<IPipelineBufferObserver> aPipelineBufferObserver)
+                                TUint aNumChannels, TUint aOffsetBytes, TUint aAttenuation, PcmStorage aStorage,
+                                const Media::Ramp& aRamp, Optional<IPipelineBufferObserver> aPipelineBufferObserver)
 {
     MsgPlayable::Initialise(aSizeBytes, aJiffies, aSampleRate, aBitDepth, aNumChannels,
                             aOffsetBytes, aRamp, aPipelineBufferObserver);
     iAudioData = aDecodedAudio;
     iAudioData->AddRef();
     iAttenuation = aAttenuation;
+    iStorage = aStorage;
+}
+
+Brn MsgPlayablePcm::StoredAudio() const
+{
+    /* iOffset and iSize count packed bytes at iBitDepth.  Convert these to the
+       equivalent range of DecodedAudio if it holds whole 32-bit subsamples. */
+    if (iStorage == PcmStorage::Int32) {
+        const TUint subsampleBytes = iBitDepth / 8;
+        const TUint offset = (iOffset / subsampleBytes) * sizeof(TInt32);
+        const TUint bytes = (iSize / subsampleBytes) * sizeof(TInt32);
+        return Brn(iAudioData->Ptr(offset), bytes);
+    }
+    return Brn(iAudioData->Ptr(iOffset), iSize);
 }
 
 void MsgPlayablePcm::ApplyAttenuation(Bwx& aData)
@@ -2750,39 +3445,148 @@ void MsgPlayablePcm::ApplyAttenuation(Bwx& aData)
     }
 }
 
-void MsgPlayablePcm::ReadBlock(IPcmProcessor& aProcessor)
+void MsgPlayablePcm::ApplyAttenuation(TInt32* aSubsamples, TUint aNumSubsamples)
 {
-    Bwn audioBuf(iAudioData->Ptr(iOffset), iSize, iSize);
-    ApplyAttenuation(audioBuf);
+    if (iAttenuation == MsgAudioPcm::kUnityAttenuation) {
+        return;
+    }
+    ASSERT(iBitDepth == 16);
+    for (TUint i=0; i<aNumSubsamples; i++) {
+        const TInt sample = aSubsamples[i] >> 16; // matches rounding of the packed version above
+        const TInt attenuatedSample = sample * (TInt)iAttenuation / (TInt)MsgAudioPcm::kUnityAttenuation;
+        aSubsamples[i] = (TInt32)((TUint32)attenuatedSample << 16);
+    }
+}
 
+static void PackInt32(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples, TUint aBitDepth)
+{
+    switch (aBitDepth)
+    {
+    case 8:
+        RampPack8(aSrc, aDest, aNumSubsamples, 0);
+        break;
+    case 16:
+        RampPack16(aSrc, aDest, aNumSubsamples, 0);
+        break;
+    case 24:
+        RampPack24(aSrc, aDest, aNumSubsamples, 0);
+        break;
+    case 32:
+        RampPack32(aSrc, aDest, aNumSubsamples, 0);
+        break;
+    default:
+        ASSERTS();
+    }
+}
+
+void MsgPlayablePcm::ReadBlock(IPcmProcessor& aProcessor)
+{
     const TUint numChannels = iNumChannels;
     const TUint bitDepth = iBitDepth;
     const TUint subsampleBytes = bitDepth / 8;
+    const TUint bytesPerSample = subsampleBytes * numChannels;
+    Brn stored = StoredAudio();
+
+    if (iStorage == PcmStorage::Int32) {
+        TInt32* subsamples = (TInt32*)stored.Ptr();
+        ApplyAttenuation(subsamples, stored.Bytes() / sizeof(TInt32));
+        Bws<kMaxFragmentSubsamples * sizeof(TInt32)> packedBuf;
+        const TUint samplesPerFragment = kMaxFragmentSubsamples / numChannels;
+        if (iRamp.IsEnabled()) {
+            RampApplicator ra(iRamp);
+            TUint remaining = ra.StartInt32(stored, bitDepth, numChannels);
+            while (remaining > 0) {
+                const TUint fragmentSamples = ra.GetNextSamples((TByte*)packedBuf.Ptr(), samplesPerFragment);
+                packedBuf.SetBytes(fragmentSamples * bytesPerSample);
+                aProcessor.ProcessFragment(packedBuf, numChannels, subsampleBytes);
+                remaining -= fragmentSamples;
+            }
+        }
+        else {
+            TUint remaining = stored.Bytes() / (sizeof(TInt32) * numChannels);
+            while (remaining > 0) {
+                const TUint fragmentSamples = std::min(samplesPerFragment, remaining);
+                PackInt32(subsamples, (TByte*)packedBuf.Ptr(), fragmentSamples * numChannels, bitDepth);
+                packedBuf.SetBytes(fragmentSamples * bytesPerSample);
+                aProcessor.ProcessFragment(packedBuf, numChannels, subsampleBytes);
+                subsamples += fragmentSamples * numChannels;
+                remaining -= fragmentSamples;
+            }
+        }
+        return;
+    }
+
+    Bwn audioBuf(stored.Ptr(), stored.Bytes(), stored.Bytes());
+    ApplyAttenuation(audioBuf);
     if (iRamp.IsEnabled()) {
-        Bws<256> rampedBuf;
+        Bws<1024> rampedBuf;
         RampApplicator ra(iRamp);
-        const TUint numSamples = ra.Start(audioBuf, bitDepth, numChannels);
-        const TUint bytesPerSample = subsampleBytes * numChannels;
+        TUint remaining = ra.Start(audioBuf, bitDepth, numChannels);
         const TUint samplesPerFragment = rampedBuf.MaxBytes() / bytesPerSample;
-        TByte* ptr = (TByte*)rampedBuf.Ptr();
-        TUint fragmentSamples = 0;
-        for (TUint i=0; i<numSamples; i++) {
-            ra.GetNextSample(ptr);
-
-            fragmentSamples++;
-            ptr += bytesPerSample;
-            if (fragmentSamples == samplesPerFragment || i == numSamples-1) {
-                rampedBuf.SetBytes(fragmentSamples * bytesPerSample);
-                aProcessor.ProcessFragment(rampedBuf, numChannels, subsampleBytes);
-                ptr = (TByte*)rampedBuf.Ptr();
-                fragmentSamples = 0;
-            }
+        while (remaining > 0) {
+            const TUint fragmentSamples = ra.GetNextSamples((TByte*)rampedBuf.Ptr(), samplesPerFragment);
+            rampedBuf.SetBytes(fragmentSamples * bytesPerSample);
+            aProcessor.ProcessFragment(rampedBuf, numChannels, subsampleBytes);
+            remaining -= fragmentSamples;
         }
     }
     else {
         aProcessor.ProcessFragment(audioBuf, numChannels, subsampleBytes);
     }
+}
+
+void MsgPlayablePcm::ReadBlock(IPcmProcessorInt32& aProcessor)
+{
+    const TUint numChannels = iNumChannels;
+    const TUint bitDepth = iBitDepth;
+    const TUint samplesPerFragment = kMaxFragmentSubsamples / numChannels;
+    TInt32 fragment[kMaxFragmentSubsamples];
+    Brn stored = StoredAudio();
+
+    if (iStorage == PcmStorage::Int32) {
+        ASSERT_DEBUG(((size_t)stored.Ptr() & (sizeof(TInt32) - 1)) == 0);
+        TInt32* subsamples = (TInt32*)stored.Ptr();
+        const TUint numSubsamples = stored.Bytes() / sizeof(TInt32);
+        ApplyAttenuation(subsamples, numSubsamples);
+        if (!iRamp.IsEnabled()) {
+            // no conversion required - pass DecodedAudio's own buffer on
+            aProcessor.ProcessFragment(subsamples, numSubsamples / numChannels, numChannels, bitDepth);
+            return;
+        }
+        RampApplicator ra(iRamp);
+        TUint remaining = ra.StartInt32(stored, bitDepth, numChannels);
+        while (remaining > 0) {
+            const TUint fragmentSamples = ra.GetNextSamplesInt32(fragment, samplesPerFragment);
+            aProcessor.ProcessFragment(fragment, fragmentSamples, numChannels, bitDepth);
+            remaining -= fragmentSamples;
+        }
+        return;
+    }
 
+    Bwn audioBuf(stored.Ptr(), stored.Bytes(), stored.Bytes());
+    ApplyAttenuation(audioBuf);
+    if (iRamp.IsEnabled()) {
+        RampApplicator ra(iRamp);
+        TUint remaining = ra.Start(audioBuf, bitDepth, numChannels);
+        while (remaining > 0) {
+            const TUint fragmentSamples = ra.GetNextSamplesInt32(fragment, samplesPerFragment);
+            aProcessor.ProcessFragment(fragment, fragmentSamples, numChannels, bitDepth);
+            remaining -= fragmentSamples;
+        }
+    }
+    else {
+        const TUint bytesPerSample = (bitDepth / 8) * numChannels;
+        const TByte* ptr = audioBuf.Ptr();
+        TUint remaining = audioBuf.Bytes() / bytesPerSample;
+        while (remaining > 0) {
+            const TUint fragmentSamples = std::min(samplesPerFragment, remaining);
+            const TUint fragmentBytes = fragmentSamples * bytesPerSample;
+            DecodedAudio::CopyToInt32(Brn(ptr, fragmentBytes), bitDepth, AudioDataEndian::Big, fragment);
+            aProcessor.ProcessFragment(fragment, fragmentSamples, numChannels, bitDepth);
+            ptr += fragmentBytes;
+            remaining -= fragmentSamples;
+        }
+    }
 }
 
 TBool MsgPlayablePcm::TryLogTimestamps()
@@ -2802,7 +3606,9 @@ MsgPlayable* MsgPlayablePcm::Allocate()
 void MsgPlayablePcm::SplitCompleted(MsgPlayable& aRemaining)
 {
     iAudioData->AddRef();
-    static_cast<MsgPlayablePcm&>(aRemaining).iAudioData = iAudioData;
+    MsgPlayablePcm& remaining = static_cast<MsgPlayablePcm&>(aRemaining);
+    remaining.iAudioData = iAudioData;
+    remaining.iStorage = iStorage;
 }
 
 void MsgPlayablePcm::Clear()
@@ -2810,6 +3616,7 @@ void MsgPlayablePcm::Clear()
     MsgPlayable::Clear();
     iAudioData->RemoveRef();
     iAttenuation = MsgAudioPcm::kUnityAttenuation;
+    iStorage = PcmStorage::PackedBigEndian;
 }
 
 
@@ -2892,6 +3699,18 @@ void MsgPlayableSilence::ReadBlock(IPcmProcessor& aProcessor)
     } while (remainingBytes > 0);
 }
 
+void MsgPlayableSilence::ReadBlock(IPcmProcessorInt32& aProcessor)
+{
+    static const TInt32 silence[kMaxSilenceSubsamples] = { 0 };
+    const TUint samplesPerFragment = kMaxSilenceSubsamples / iNumChannels;
+    TUint remaining = iSize / ((iBitDepth / 8) * iNumChannels);
+    while (remaining > 0) {
+        const TUint samples = (remaining > samplesPerFragment? samplesPerFragment : remaining);
+        aProcessor.ProcessSilence(silence, samples, iNumChannels, iBitDepth);
+        remaining -= samples;
+    }
+}
+
 MsgPlayable* MsgPlayableSilence::Allocate()
 {
     return static_cast<Allocator<MsgPlayableSilence>&>(iAllocator).Allocate();
@@ -3096,6 +3915,114 @@ TUint MsgQueue::NumMsgs() const
 }
 
 
+// MsgQueueSpsc
+
+MsgQueueSpsc::MsgQueueSpsc(TUint aCapacity)
+    : iCapacity(aCapacity)
+    , iHead(0)
+    , iTail(0)
+    , iPushedBackCount(0)
+    , iConsumerWaiting(false)
+    , iProducerWaiting(false)
+    , iSemNotEmpty("MQSE", 0)
+    , iSemNotFull("MQSF", 0)
+{
+    ASSERT(aCapacity > 0 && (aCapacity & (aCapacity - 1)) == 0);
+    ASSERT(iHead.is_lock_free());
+    ASSERT(iConsumerWaiting.is_lock_free());
+    iRing = new Msg*[iCapacity];
+}
+
+MsgQueueSpsc::~MsgQueueSpsc()
+{
+    Clear();
+    delete[] iRing;
+}
+
+void MsgQueueSpsc::Enqueue(Msg* aMsg)
+{
+    ASSERT(aMsg != nullptr);
+    const TUint tail = iTail.load(std::memory_order_relaxed);
+    while (tail - iHead.load() == iCapacity) {
+        // Full.  Advertise that we're waiting then check again so that a
+        // concurrent Dequeue() either sees the flag or frees a slot we see.
+        iProducerWaiting.store(true);
+        if (tail - iHead.load() != iCapacity) {
+            iProducerWaiting.store(false);
+            break;
+        }
+        iSemNotFull.Wait();
+    }
+    iRing[tail & (iCapacity - 1)] = aMsg;
+    iTail.store(tail + 1); // publishes slot to consumer
+    if (iConsumerWaiting.exchange(false)) {
+        iSemNotEmpty.Signal();
+    }
+}
+
+Msg* MsgQueueSpsc::Dequeue()
+{
+    Msg* msg;
+    for (;;) {
+        if (TryDequeue(msg)) {
+            return msg;
+        }
+        // Empty.  As Enqueue(), re-check after advertising that we're waiting.
+        // A stale Signal() can result in one spurious wakeup; the loop absorbs this.
+        iConsumerWaiting.store(true);
+        if (TryDequeue(msg)) {
+            iConsumerWaiting.store(false);
+            return msg;
+        }
+        iSemNotEmpty.Wait();
+    }
+}
+
+void MsgQueueSpsc::EnqueueAtHead(Msg* aMsg)
+{
+    iPushedBack.EnqueueAtHead(aMsg);
+    iPushedBackCount++;
+}
+
+TBool MsgQueueSpsc::IsEmpty() const
+{
+    return iPushedBackCount.load() == 0 && iHead.load() == iTail.load();
+}
+
+void MsgQueueSpsc::Clear()
+{
+    Msg* msg;
+    while (TryDequeue(msg)) {
+        msg->RemoveRef();
+    }
+}
+
+TUint MsgQueueSpsc::NumMsgs() const
+{
+    const TUint head = iHead.load();
+    return iPushedBackCount.load() + (iTail.load() - head);
+}
+
+TBool MsgQueueSpsc::TryDequeue(Msg*& aMsg)
+{
+    if (!iPushedBack.IsEmpty()) {
+        aMsg = iPushedBack.Dequeue();
+        iPushedBackCount--;
+        return true;
+    }
+    const TUint head = iHead.load(std::memory_order_relaxed);
+    if (head == iTail.load()) {
+        return false;
+    }
+    aMsg = iRing[head & (iCapacity - 1)];
+    iHead.store(head + 1); // returns slot to producer
+    if (iProducerWaiting.exchange(false)) {
+        iSemNotFull.Signal();
+    }
+    return true;
+}
+
+
 // MsgReservoir
 
 MsgReservoir::MsgReservoir()
@@ -3726,7 +4653,8 @@ const TUint ISupply::kMaxDrainMs = 5000;
 // TrackFactory
 
 TrackFactory::TrackFactory(IInfoAggregator& aInfoAggregator, TUint aTrackCount)
-    : iAllocatorTrack("Track", aTrackCount, aInfoAggregator)
+    : iStoragePool(aInfoAggregator)
+    , iAllocatorTrack("Track", aTrackCount, aInfoAggregator)
     , iLock("TRKF")
     , iNextId(1)
 {
@@ -3738,45 +4666,59 @@ Track* TrackFactory::CreateTrack(const Brx& aUri, const Brx& aMetaData)
     iLock.Wait();
     TUint id = iNextId++;
     iLock.Signal();
-    track->Initialise(aUri, aMetaData, id);
+    track->Initialise(iStoragePool, aUri, aMetaData, id);
     return track;
 }
 
 Track* TrackFactory::CreateNullTrack()
 {
     auto track = iAllocatorTrack.Allocate();
-    track->Initialise(Brx::Empty(), Brx::Empty(), Track::kIdNone);
+    track->Initialise(iStoragePool, Brx::Empty(), Brx::Empty(), Track::kIdNone);
     return track;
 }
 
+TUint TrackFactory::StorageBytesResident() const
+{
+    return iStoragePool.BytesResident();
+}
+
 
 // MsgFactory
 
 MsgFactory::MsgFactory(IInfoAggregator& aInfoAggregator, const MsgFactoryInitParams& aInitParams)
-    : iAllocatorMsgMode("MsgMode", aInitParams.iMsgModeCount, aInfoAggregator)
-    , iAllocatorMsgTrack("MsgTrack", aInitParams.iMsgTrackCount, aInfoAggregator)
-    , iAllocatorMsgDrain("MsgDrain", aInitParams.iMsgDrainCount, aInfoAggregator)
+    : iMemoryBudget(CreateMemoryBudget(aInitParams, aInfoAggregator))
+    , iAllocatorMsgMode("MsgMode", aInitParams.iMsgModeCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgTrack("MsgTrack", aInitParams.iMsgTrackCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgDrain("MsgDrain", aInitParams.iMsgDrainCount, aInfoAggregator, iMemoryBudget.get())
     , iDrainId(0)
-    , iAllocatorMsgDelay("MsgDelay", aInitParams.iMsgDelayCount, aInfoAggregator)
-    , iAllocatorMsgEncodedStream("MsgEncodedStream", aInitParams.iMsgEncodedStreamCount, aInfoAggregator)
-    , iAllocatorMsgStreamSegment("MsgStreamSegment", aInitParams.iMsgStreamSegmentCount, aInfoAggregator)
-    , iAllocatorAudioData("AudioData", aInitParams.iEncodedAudioCount + aInitParams.iDecodedAudioCount, aInfoAggregator)
-    , iAllocatorMsgAudioEncoded("MsgAudioEncoded", aInitParams.iMsgAudioEncodedCount, aInfoAggregator)
-    , iAllocatorMsgMetaText("MsgMetaText", aInitParams.iMsgMetaTextCount, aInfoAggregator)
-    , iAllocatorMsgStreamInterrupted("MsgStreamInterrupted", aInitParams.iMsgStreamInterruptedCount, aInfoAggregator)
-    , iAllocatorMsgHalt("MsgHalt", aInitParams.iMsgHaltCount, aInfoAggregator)
-    , iAllocatorMsgFlush("MsgFlush", aInitParams.iMsgFlushCount, aInfoAggregator)
-    , iAllocatorMsgWait("MsgWait", aInitParams.iMsgWaitCount, aInfoAggregator)
-    , iAllocatorMsgDecodedStream("MsgDecodedStream", aInitParams.iMsgDecodedStreamCount, aInfoAggregator)
-    , iAllocatorMsgAudioPcm("MsgAudioPcm", aInitParams.iMsgAudioPcmCount, aInfoAggregator)
-    , iAllocatorMsgAudioDsd("MsgAudioDsd", aInitParams.iMsgAudioDsdCount, aInfoAggregator)
-    , iAllocatorMsgSilence("MsgSilence", aInitParams.iMsgSilenceCount, aInfoAggregator)
-    , iAllocatorMsgPlayablePcm("MsgPlayablePcm", aInitParams.iMsgPlayablePcmCount, aInfoAggregator)
-    , iAllocatorMsgPlayableDsd("MsgPlayableDsd", aInitParams.iMsgPlayableDsdCount, aInfoAggregator)
-    , iAllocatorMsgPlayableSilence("MsgPlayableSilence", aInitParams.iMsgPlayableSilenceCount, aInfoAggregator)
-    , iAllocatorMsgPlayableSilenceDsd("MsgPlayableSilenceDsd", aInitParams.iMsgPlayableSilenceCount, aInfoAggregator)
-    , iAllocatorMsgQuit("MsgQuit", aInitParams.iMsgQuitCount, aInfoAggregator)
-{
+    , iAllocatorMsgDelay("MsgDelay", aInitParams.iMsgDelayCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgEncodedStream("MsgEncodedStream", aInitParams.iMsgEncodedStreamCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgStreamSegment("MsgStreamSegment", aInitParams.iMsgStreamSegmentCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorAudioData("AudioData", aInitParams.iEncodedAudioCount + aInitParams.iDecodedAudioCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgAudioEncoded("MsgAudioEncoded", aInitParams.iMsgAudioEncodedCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgMetaText("MsgMetaText", aInitParams.iMsgMetaTextCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgStreamInterrupted("MsgStreamInterrupted", aInitParams.iMsgStreamInterruptedCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgHalt("MsgHalt", aInitParams.iMsgHaltCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgFlush("MsgFlush", aInitParams.iMsgFlushCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgWait("MsgWait", aInitParams.iMsgWaitCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgDecodedStream("MsgDecodedStream", aInitParams.iMsgDecodedStreamCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgAudioPcm("MsgAudioPcm", aInitParams.iMsgAudioPcmCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgAudioDsd("MsgAudioDsd", aInitParams.iMsgAudioDsdCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgSilence("MsgSilence", aInitParams.iMsgSilenceCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgPlayablePcm("MsgPlayablePcm", aInitParams.iMsgPlayablePcmCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgPlayableDsd("MsgPlayableDsd", aInitParams.iMsgPlayableDsdCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgPlayableSilence("MsgPlayableSilence", aInitParams.iMsgPlayableSilenceCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgPlayableSilenceDsd("MsgPlayableSilenceDsd", aInitParams.iMsgPlayableSilenceCount, aInfoAggregator, iMemoryBudget.get())
+    , iAllocatorMsgQuit("MsgQuit", aInitParams.iMsgQuitCount, aInfoAggregator, iMemoryBudget.get())
+    , iDecodedPcmStorage(aInitParams.iDecodedPcmStorage)
+{
+}
+
+void MsgFactory::SetMemoryReclaimThread(IPipelineElementObserverThread& aThread)
+{
+    if (iMemoryBudget) {
+        iMemoryBudget->SetReclaimThread(aThread);
+    }
 }
 
 MsgMode* MsgFactory::CreateMsgMode(const Brx& aMode, const ModeInfo& aInfo,
@@ -3966,6 +4908,7 @@ MsgAudioPcm* MsgFactory::CreateMsgAudioPcm(const Brx& aData, TUint aChannels, TU
 
 MsgAudioPcm* MsgFactory::CreateMsgAudioPcm(MsgAudioEncoded* aAudio, TUint aChannels, TUint aSampleRate, TUint aBitDepth, TUint64 aTrackOffset)
 {
+    ASSERT(iDecodedPcmStorage == PcmStorage::PackedBigEndian); // encoded audio can only be shared if it needs no conversion
     AudioData* audioData = aAudio->iAudioData;
     audioData->AddRef();
     return CreateMsgAudioPcm(static_cast<DecodedAudio*>(audioData),
@@ -4020,16 +4963,24 @@ EncodedAudio* MsgFactory::CreateEncodedAudio(const Brx& aData)
 DecodedAudio* MsgFactory::CreateDecodedAudio(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian)
 {
     DecodedAudio* decodedAudio = static_cast<DecodedAudio*>(iAllocatorAudioData.Allocate());
-    decodedAudio->ConstructPcm(aData, aBitDepth, aEndian);
+    decodedAudio->ConstructPcm(aData, aBitDepth, aEndian, iDecodedPcmStorage);
     return decodedAudio;
 }
 
+AllocatorMemoryBudget* MsgFactory::CreateMemoryBudget(const MsgFactoryInitParams& aInitParams, IInfoAggregator& aInfoAggregator)
+{ // static
+    if (aInitParams.iMemoryBudgetBytes == 0) {
+        return nullptr;
+    }
+    return new AllocatorMemoryBudget(aInitParams.iMemoryBudgetBytes, aInfoAggregator);
+}
+
 MsgAudioPcm* MsgFactory::CreateMsgAudioPcm(DecodedAudio* aAudioData, TUint aChannels, TUint aSampleRate, TUint aBitDepth, TUint64 aTrackOffset)
 {
     MsgAudioPcm* msg = iAllocatorMsgAudioPcm.Allocate();
     try {
         msg->Initialise(aAudioData, aSampleRate, aBitDepth, aChannels, aTrackOffset,
-                        iAllocatorMsgPlayablePcm, iAllocatorMsgPlayableSilence);
+                        iDecodedPcmStorage, iAllocatorMsgPlayablePcm, iAllocatorMsgPlayableSilence);
     }
     catch (AssertionFailed&) { // test code helper
         msg->RemoveRef();
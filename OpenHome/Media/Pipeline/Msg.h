@@ -13,6 +13,8 @@
 
 #include <limits.h>
 #include <atomic>
+#include <memory>
+#include <vector>
 
 EXCEPTION(SampleRateInvalid);
 EXCEPTION(SampleRateUnsupported);
@@ -25,7 +27,56 @@ namespace OpenHome {
 namespace Media {
 
 class Allocated;
+class AllocatorBase;
+class IPipelineElementObserverThread;
 
+/*
+ * Memory shared between a set of elastic allocators.
+ *
+ * Allocators created with a budget start with a single slab of cells and grow a slab at a time.
+ * Growth beyond the budget is allowed (up to each allocator's capacity) but is logged.
+ * Unused slabs are returned to the budget by Reclaim(), which runs on aThread passed to
+ * SetReclaimThread() so that audio threads never destroy cells.
+ */
+class AllocatorMemoryBudget : private IInfoProvider
+{
+public:
+    AllocatorMemoryBudget(TUint aBytes, IInfoAggregator& aInfoAggregator);
+    void SetReclaimThread(IPipelineElementObserverThread& aThread); // must be called before aThread is started
+    void AddAllocator(AllocatorBase& aAllocator);
+    void RemoveAllocator(AllocatorBase& aAllocator);
+    TBool TryReserve(TUint aBytes);
+    void Overdraw(TUint aBytes);
+    void Release(TUint aBytes);
+    void ScheduleReclaim(); // cheap and non-blocking.  Safe to call from any thread
+    void Reclaim();
+    TUint BytesTotal() const;
+    TUint BytesReserved() const;
+    TUint BytesReservedMax() const;
+private:
+    void UpdateReservedMax(TUint aReserved);
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter) override;
+private:
+    const TUint iBytesTotal;
+    std::atomic<TUint> iBytesReserved;
+    std::atomic<TUint> iBytesReservedMax;
+    Mutex iLock;
+    std::vector<AllocatorBase*> iAllocators;
+    IPipelineElementObserverThread* iReclaimThread;
+    TUint iReclaimId;
+};
+
+/*
+ * Pool of Allocated cells.
+ *
+ * The free list is a lock-free stack so Allocate()/Free() can be called concurrently from any
+ * number of threads without contending on a mutex.  Statistics are maintained atomically and
+ * may be very slightly out of date with respect to each other when read.
+ *
+ * By default all cells are created up front.  If an AllocatorMemoryBudget is supplied, cells are
+ * instead created in slabs as required and destroyed by Reclaim(); aNumCells is then an upper limit.
+ */
 class AllocatorBase : private IInfoProvider
 {
 public:
@@ -36,40 +87,61 @@ public:
     TUint CellsUsed() const;
     TUint CellsUsedMax() const;
     void GetStats(TUint& aCellsTotal, TUint& aCellBytes, TUint& aCellsUsed, TUint& aCellsUsedMax) const;
+    TUint CellsResident() const;
+    TUint CellsResidentMax() const;
+    void Reclaim(); // returns unused slabs to the memory budget.  Must not be called from audio threads
     inline const TChar* Name() const;
     static const Brn kQueryMemory;
 protected:
-    AllocatorBase(const TChar* aName, TUint aNumCells, TUint aCellBytes, IInfoAggregator& aInfoAggregator);
+    AllocatorBase(const TChar* aName, TUint aNumCells, TUint aCellBytes, IInfoAggregator& aInfoAggregator,
+                  AllocatorMemoryBudget* aBudget = nullptr);
+    void AddCell(Allocated* aCell); // for use by constructors of derived classes only
+    void Populate();                // alternative to AddCell() for classes which implement NewCell()
     Allocated* DoAllocate();
 private:
+    virtual Allocated* NewCell();
     Allocated* Read();
+    Allocated* TryRead();
+    void Write(Allocated* aCell);
+    void InsertCell(Allocated* aCell);
+    TBool TryGrow();
 private: // from IInfoProvider
     void QueryInfo(const Brx& aQuery, IWriter& aWriter);
-protected:
-    FifoLiteDynamic<Allocated*> iFree;
 private:
-    mutable Mutex iLock;
+    static const TUint64 kFreeIndexMask = 0xffffffff;
+    static const TUint kSlabsPerAllocator = 16;
+private:
+    Allocated** iCells;
+    std::atomic<TUint>* iNextFree;  // 1-based index of cell below each cell on the free stack.  0 => none.
+    std::atomic<TUint64> iFreeHead; // (ABA count << 32) | (1-based index of top of free stack)
+    TUint iCellsAdded;
     const TChar* iName;
     const TUint iCellsTotal;
     const TUint iCellBytes;
-    TUint iCellsUsed;
-    TUint iCellsUsedMax;
+    std::atomic<TUint> iCellsUsed;
+    std::atomic<TUint> iCellsUsedMax;
+    AllocatorMemoryBudget* iBudget;
+    const TUint iSlabCells;             // only meaningful if iBudget is non-null
+    Mutex iLockResize;
+    std::vector<TUint> iIndexesVacant;  // indexes of destroyed cells.  Protected by iLockResize.
+    std::atomic<TUint> iCellsResident;
+    std::atomic<TUint> iCellsResidentMax;
 };
 
 template <class T> class Allocator : public AllocatorBase
 {
 public:
-    Allocator(const TChar* aName, TUint aNumCells, IInfoAggregator& aInfoAggregator);
+    Allocator(const TChar* aName, TUint aNumCells, IInfoAggregator& aInfoAggregator, AllocatorMemoryBudget* aBudget = nullptr);
     virtual ~Allocator();
     T* Allocate();
+private: // from AllocatorBase
+    Allocated* NewCell() override;
 };
 
-template <class T> Allocator<T>::Allocator(const TChar* aName, TUint aNumCells, IInfoAggregator& aInfoAggregator)
-    : AllocatorBase(aName, aNumCells, sizeof(T), aInfoAggregator)
+template <class T> Allocator<T>::Allocator(const TChar* aName, TUint aNumCells, IInfoAggregator& aInfoAggregator, AllocatorMemoryBudget* aBudget)
+    : AllocatorBase(aName, aNumCells, sizeof(T), aInfoAggregator, aBudget)
 {
-    for (TUint i=0; i<aNumCells; i++) {
-        iFree.Write(new T(*this));
-    }
+    Populate();
 }
 
 template <class T> Allocator<T>::~Allocator()
@@ -81,6 +153,11 @@ template <class T> T* Allocator<T>::Allocate()
     return static_cast<T*>(DoAllocate());
 }
 
+template <class T> Allocated* Allocator<T>::NewCell()
+{
+    return new T(*this);
+}
+
 class Logger;
 
 class Allocated
@@ -102,6 +179,7 @@ protected:
     AllocatorBase& iAllocator;
 private:
     std::atomic<TUint> iRefCount;
+    TUint iCellIndex; // 1-based position in iAllocator
 };
 
 enum class AudioDataEndian
@@ -111,6 +189,19 @@ enum class AudioDataEndian
     Big
 };
 
+/**
+ * Layout of pcm audio held in DecodedAudio.
+ *
+ * Storage is fixed for the lifetime of a MsgFactory (and so for a pipeline).  It is an
+ * implementation detail of MsgAudioPcm/MsgPlayablePcm - IPcmProcessor always receives
+ * packed big endian data and IPcmProcessorInt32 always receives 32-bit subsamples.
+ */
+enum class PcmStorage
+{
+    PackedBigEndian, // subsamples packed at the stream's bit depth, big endian
+    Int32            // one host endian TInt32 per subsample, left-justified (msb of audio at bit 31)
+};
+
 class AudioData : public Allocated
 {
 public:
@@ -167,19 +258,23 @@ private:
 class DecodedAudio : public AudioData
 {
     friend class MsgFactory;
+    friend class MsgPlayablePcm;
 public:
     static const TUint kMaxNumChannels = 8;
 public:
     void Aggregate(DecodedAudio& aDecodedAudio);
     void SetBytes(TUint aBytes);
+    void ExpandToInt32(TUint aOffsetBytes, TUint aNumSubsamples, TUint aBitDepth); // converts packed big endian subsamples starting at aOffsetBytes in place
+    static TUint BytesPerSubsample(PcmStorage aStorage, TUint aBitDepth);
 private:
     DecodedAudio(AllocatorBase& aAllocator);
-    void ConstructPcm(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian);
+    void ConstructPcm(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian, PcmStorage aStorage);
     void ConstructDsd(const Brx& aData);
     void Construct();
     static void CopyToBigEndian16(const Brx& aData, TByte* aDest);
     static void CopyToBigEndian24(const Brx& aData, TByte* aDest);
     static void CopyToBigEndian32(const Brx& aData, TByte* aDest);
+    static void CopyToInt32(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian, TInt32* aDest);
 };
 
 /**
@@ -287,20 +382,37 @@ private:
 
 class RampApplicator : private INonCopyable
 {
+    friend class SuiteRampApplicatorPerf;
     static const TUint kFullRampSpan;
+    static const TUint kMaxBlockSubsamples = 512;
+    typedef void (*UnpackFunction)(const TByte* aSrc, TInt32* aDest, TUint aNumSubsamples);
+    typedef void (*PackFunction)(const TInt32* aSrc, TByte* aDest, TUint aNumSubsamples, TUint aNumChannels);
 public:
     RampApplicator(const Media::Ramp& aRamp);
     TUint Start(const Brx& aData, TUint aBitDepth, TUint aNumChannels); // returns number of samples
+    TUint StartInt32(const Brx& aData, TUint aBitDepth, TUint aNumChannels); // as Start() for PcmStorage::Int32 data
     void GetNextSample(TByte* aDest);
+    TUint GetNextSamples(TByte* aDest, TUint aMaxSamples); // returns number of samples written to aDest
+    TUint GetNextSamplesInt32(TInt32* aDest, TUint aMaxSamples); // returns number of samples written to aDest
     static TUint MedianMultiplier(const Media::Ramp& aRamp);
+private:
+    void DoStart(const Brx& aData, TUint aBitDepth, TUint aNumChannels, TUint aSrcBytesPerSubsample);
+    TUint DoGetNextSamples(TByte* aDest, TUint aMaxSamples, PackFunction aPack, TUint aDestBytesPerSample);
+    inline TInt32 NextMultiplier();
+    static void ApplyMultipliers(TInt32* aSubsamples, const TInt32* aMultipliers, TUint aNumSubsamples);
+    static void ApplyMultipliersScalar(TInt32* aSubsamples, const TInt32* aMultipliers, TUint aNumSubsamples);
 private:
     const Media::Ramp& iRamp;
     const TByte* iPtr;
     TUint iBitDepth;
     TUint iNumChannels;
+    TUint iSrcBytesPerSample;
+    TUint iBytesPerSample;
     TInt iNumSamples;
     TInt iTotalRamp;
     TInt iLoopCount;
+    UnpackFunction iUnpack;
+    PackFunction iPack;
 };
 
 class MsgFactory;
@@ -323,6 +435,41 @@ enum class Latency
     External
 };
 
+/*
+ * Variable length storage for Track uri and metadata.
+ *
+ * Blocks are rounded up to a power of 2 size class and carved from slabs which are
+ * allocated on demand then retained for reuse by later tracks.  Memory used therefore
+ * scales with the size of metadata actually held rather than with kTrackMetaDataMaxBytes.
+ */
+class TrackStoragePool : private IInfoProvider, private INonCopyable
+{
+public:
+    TrackStoragePool(IInfoAggregator& aInfoAggregator);
+    ~TrackStoragePool();
+    TByte* Allocate(TUint aBytes);
+    void Free(TByte* aPtr, TUint aBytes); // aBytes must match the value passed to Allocate()
+    TUint BytesInUse() const;
+    TUint BytesResident() const;
+    TUint BytesResidentMax() const;
+private:
+    static TUint SizeClass(TUint aBytes);
+private: // from IInfoProvider
+    void QueryInfo(const Brx& aQuery, IWriter& aWriter) override;
+private:
+    static const TUint kMinBlockShift = 6;  // 64 byte blocks
+    static const TUint kMaxBlockShift = 13; // 8k blocks; fits kTrackUriMaxBytes + kTrackMetaDataMaxBytes
+    static const TUint kNumSizeClasses = kMaxBlockShift - kMinBlockShift + 1;
+    static const TUint kSlabBytes = 16 * 1024;
+private:
+    mutable Mutex iLock;
+    TByte* iFree[kNumSizeClasses]; // singly linked lists, threaded through the first bytes of each free block
+    std::vector<TByte*> iSlabs;
+    TUint iBytesInUse;
+    TUint iBytesResident;
+    TUint iBytesResidentMax;
+};
+
 class Track : public Allocated
 {
     friend class TrackFactory;
@@ -334,12 +481,15 @@ public:
     const Brx& MetaData() const;
     TUint Id() const;
 private:
-    void Initialise(const Brx& aUri, const Brx& aMetaData, TUint aId);
+    void Initialise(TrackStoragePool& aStoragePool, const Brx& aUri, const Brx& aMetaData, TUint aId);
 private: // from Allocated
     void Clear() override;
 private:
-    BwsTrackUri iUri;
-    BwsTrackMetaData iMetaData;
+    TrackStoragePool* iStoragePool;
+    TByte* iStorage;
+    TUint iStorageBytes;
+    Brn iUri;
+    Brn iMetaData;
     TUint iId;
 };
 
@@ -940,12 +1090,14 @@ public:
 public:
     MsgAudioPcm(AllocatorBase& aAllocator);
     void SetAttenuation(TUint aAttenuation);
+    TUint StorageBitDepth() const; // bits used to hold each subsample in memory
     inline void AddLogPoint(const TChar* aId);
 public: // from MsgAudio
     MsgAudio* Clone() override; // create new MsgAudio, take ref to DecodedAudio, copy size/offset
     MsgPlayable* CreatePlayable() override; // removes ref, transfer ownership of DecodedAudio
 private:
     void Initialise(DecodedAudio* aDecodedAudio, TUint aSampleRate, TUint aBitDepth, TUint aChannels, TUint64 aTrackOffset,
+                    PcmStorage aStorage,
                     Allocator<MsgPlayablePcm>& aAllocatorPlayablePcm,
                     Allocator<MsgPlayableSilence>& aAllocatorPlayableSilence);
 private: // from MsgAudio
@@ -957,6 +1109,7 @@ private: // from Msg
 private:
     Allocator<MsgPlayablePcm>* iAllocatorPlayablePcm;
     TUint iAttenuation;
+    PcmStorage iStorage;
 };
 
 class MsgAudioDsd : public MsgAudioDecoded
@@ -1025,6 +1178,7 @@ private:
 };
 
 class IPcmProcessor;
+class IPcmProcessorInt32;
 class IDsdProcessor;
 
 /**
@@ -1051,6 +1205,12 @@ public:
      *                             padding around each sample) or if a ramp is being applied.
      */
     void Read(IPcmProcessor& aProcessor);
+    /**
+     * Extract pcm data from this msg as 32-bit subsamples.
+     *
+     * Cheaper than Read(IPcmProcessor&) when the pipeline uses PcmStorage::Int32.
+     */
+    void Read(IPcmProcessorInt32& aProcessor);
     void Read(IDsdProcessor& aProcessor);
     virtual TBool TryLogTimestamps();
 protected:
@@ -1066,6 +1226,7 @@ private:
     virtual MsgPlayable* Allocate() = 0;
     virtual void SplitCompleted(MsgPlayable& aRemaining);
     virtual void ReadBlock(IPcmProcessor& aProcessor);
+    virtual void ReadBlock(IPcmProcessorInt32& aProcessor);
     virtual void ReadBlock(IDsdProcessor& aProcessor);
 protected:
     TUint iSize; // Bytes
@@ -1081,25 +1242,30 @@ protected:
 class MsgPlayablePcm : public MsgPlayable
 {
     friend class MsgAudioPcm;
+    static const TUint kMaxFragmentSubsamples = 512;
 public:
     MsgPlayablePcm(AllocatorBase& aAllocator);
 private:
     void Initialise(DecodedAudio* aDecodedAudio, TUint aSizeBytes, TUint aJiffies,
                     TUint aSampleRate, TUint aBitDepth, TUint aNumChannels, TUint aOffsetBytes,
-                    TUint aAttenuation, const Media::Ramp& aRamp,
+                    TUint aAttenuation, PcmStorage aStorage, const Media::Ramp& aRamp,
                     Optional<IPipelineBufferObserver> aPipelineBufferObserver);
 private: // from MsgPlayable
     MsgPlayable* Allocate() override;
     void SplitCompleted(MsgPlayable& aRemaining) override;
     void ReadBlock(IPcmProcessor& aProcessor) override;
+    void ReadBlock(IPcmProcessorInt32& aProcessor) override;
     TBool TryLogTimestamps() override;
 private: // from Msg
     void Clear() override;
 private:
+    Brn StoredAudio() const;
     void ApplyAttenuation(Bwx& aData);
+    void ApplyAttenuation(TInt32* aSubsamples, TUint aNumSubsamples);
 private:
     DecodedAudio* iAudioData;
     TUint iAttenuation;
+    PcmStorage iStorage;
 };
 
 class MsgPlayableDsd : public MsgPlayable
@@ -1126,6 +1292,7 @@ class MsgPlayableSilence : public MsgPlayable
 {
     friend class MsgSilence;
     friend class MsgAudioPcm;
+    static const TUint kMaxSilenceSubsamples = 512;
 public:
     MsgPlayableSilence(AllocatorBase& aAllocator);
 private:
@@ -1136,6 +1303,7 @@ private:
 private: // from MsgPlayable
     MsgPlayable* Allocate() override;
     void ReadBlock(IPcmProcessor& aProcessor) override;
+    void ReadBlock(IPcmProcessorInt32& aProcessor) override;
 };
 
 class MsgPlayableSilenceDsd : public MsgPlayable
@@ -1239,6 +1407,49 @@ public:
     virtual void Flush() = 0;
 };
 
+/**
+ * Alternative to IPcmProcessor for consumers that work on whole 32-bit subsamples.
+ *
+ * Avoids unpacking big endian bytes when the pipeline holds audio as PcmStorage::Int32.
+ */
+class IPcmProcessorInt32
+{
+public:
+    virtual ~IPcmProcessorInt32() {}
+    /**
+     * Called once per call to MsgPlayable::Read.
+     *
+     * Will be called before any calls to ProcessFragment.
+     */
+    virtual void BeginBlock() = 0;
+    /**
+     * Copy a block of audio data.
+     *
+     * @param aSubsamples      Interleaved, host endian subsamples.  Audio is left-justified
+     *                         so the top aBitDepth bits of each subsample are significant.
+     * @param aNumSamples      Number of samples.  aSubsamples holds aNumSamples*aNumChannels values.
+     * @param aNumChannels     Number of channels.
+     * @param aBitDepth        Bit depth of the stream (8, 16, 24 or 32).
+     */
+    virtual void ProcessFragment(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint aBitDepth) = 0;
+    /**
+     * Copy a block of (silent) audio data.
+     *
+     * Parameters are as for ProcessFragment.
+     */
+    virtual void ProcessSilence(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint aBitDepth) = 0;
+    /**
+     * Called once per call to MsgPlayable::Read.
+     *
+     * No more calls to ProcessFragment will be made after this.
+     */
+    virtual void EndBlock() = 0;
+    /**
+     * If this is called, the processor should pass on any buffered audio.
+     */
+    virtual void Flush() = 0;
+};
+
 /**
 * Used to retrieve DSD audio data from a MsgPlayable
 */
@@ -1323,6 +1534,42 @@ private:
     Semaphore iSem;
 };
 
+/*
+ * Lock-free alternative to MsgQueue for exactly one producer and one consumer thread.
+ *
+ * Enqueue() may only be called by the producer.  Dequeue(), EnqueueAtHead() and Clear() may
+ * only be called by the consumer.  IsEmpty() and NumMsgs() may be called from any thread.
+ * The consumer only blocks when the queue is empty; the producer only blocks when aCapacity
+ * msgs are already queued.
+ */
+class MsgQueueSpsc : private INonCopyable
+{
+public:
+    static const TUint kDefaultCapacity = 8192; // more than any pipeline reservoir holds, so back-pressure is only a backstop
+public:
+    MsgQueueSpsc(TUint aCapacity = kDefaultCapacity); // aCapacity must be a power of 2
+    ~MsgQueueSpsc();
+    void Enqueue(Msg* aMsg);
+    Msg* Dequeue();
+    void EnqueueAtHead(Msg* aMsg);
+    TBool IsEmpty() const;
+    void Clear();
+    TUint NumMsgs() const; // test/debug use only
+private:
+    TBool TryDequeue(Msg*& aMsg);
+private:
+    Msg** iRing;
+    const TUint iCapacity;
+    std::atomic<TUint> iHead;           // index of next msg to dequeue.  Only written by consumer.
+    std::atomic<TUint> iTail;           // index of next free slot.  Only written by producer.
+    MsgQueueLite iPushedBack;           // msgs returned by EnqueueAtHead().  Only accessed by consumer.
+    std::atomic<TUint> iPushedBackCount;
+    std::atomic<TBool> iConsumerWaiting;
+    std::atomic<TBool> iProducerWaiting;
+    Semaphore iSemNotEmpty;
+    Semaphore iSemNotFull;
+};
+
 class MsgReservoir
 {
 protected:
@@ -1459,7 +1706,7 @@ private:
         MsgReservoir& iQueue;
     };
 private:
-    MsgQueue iQueue;
+    MsgQueueSpsc iQueue; // DoEnqueue() from a single producer; DoDequeue()/EnqueueAtHead() from a single consumer
     mutable Mutex iLockEncoded; // see #5098
     TUint iEncodedBytes;
     std::atomic<TUint> iJiffies;
@@ -1929,7 +2176,9 @@ public:
     TrackFactory(IInfoAggregator& aInfoAggregator, TUint aTrackCount);
     Track* CreateTrack(const Brx& aUri, const Brx& aMetaData);
     Track* CreateNullTrack();
+    TUint StorageBytesResident() const; // memory used by uri/metadata of all tracks.  Test/debug use only.
 private:
+    TrackStoragePool iStoragePool;
     Allocator<Track> iAllocatorTrack;
     Mutex iLock;
     TUint iNextId;
@@ -1959,6 +2208,8 @@ public:
     inline void SetMsgSilenceCount(TUint aCount);
     inline void SetMsgPlayableCount(TUint aPcmCount, TUint aDsdCount, TUint aSilenceCount);
     inline void SetMsgQuitCount(TUint aCount);
+    inline void SetDecodedPcmStorage(PcmStorage aStorage);
+    inline void SetMemoryBudget(TUint aBytes); // 0 => preallocate all cells (default)
 private:
     TUint iMsgModeCount;
     TUint iMsgTrackCount;
@@ -1982,12 +2233,15 @@ private:
     TUint iMsgPlayableDsdCount;
     TUint iMsgPlayableSilenceCount;
     TUint iMsgQuitCount;
+    PcmStorage iDecodedPcmStorage;
+    TUint iMemoryBudgetBytes;
 };
 
 class MsgFactory
 {
 public:
     MsgFactory(IInfoAggregator& aInfoAggregator, const MsgFactoryInitParams& aInitParams);
+    void SetMemoryReclaimThread(IPipelineElementObserverThread& aThread); // no-op unless a memory budget was set
 
     MsgMode* CreateMsgMode(const Brx& aMode, const ModeInfo& aInfo, Optional<IClockPuller> aClockPuller, const ModeTransportControls& aTransportControls);
     MsgMode* CreateMsgMode(const Brx& aMode);
@@ -2044,11 +2298,14 @@ public:
     inline TUint AllocatorPlayableSilenceCount() const;
     inline TUint AllocatorPlayableSilenceDsdCount() const;
     inline TUint AllocatorQuitCount() const;
+    inline PcmStorage DecodedPcmStorage() const;
 private:
     EncodedAudio* CreateEncodedAudio(const Brx& aData);
     DecodedAudio* CreateDecodedAudio(const Brx& aData, TUint aBitDepth, AudioDataEndian aEndian);
     MsgAudioDsd* CreateMsgAudioDsd(DecodedAudio* aAudioData, TUint aChannels, TUint aSampleRate, TUint aSampleBlockBits, TUint64 aTrackOffset, TUint aPadBytesPerChunk);
+    static AllocatorMemoryBudget* CreateMemoryBudget(const MsgFactoryInitParams& aInitParams, IInfoAggregator& aInfoAggregator);
 private:
+    std::unique_ptr<AllocatorMemoryBudget> iMemoryBudget; // nullptr unless MsgFactoryInitParams::SetMemoryBudget() was called.  Declared before (so outlives) allocators
     Allocator<MsgMode> iAllocatorMsgMode;
     Allocator<MsgTrack> iAllocatorMsgTrack;
     Allocator<MsgDrain> iAllocatorMsgDrain;
@@ -2072,6 +2329,7 @@ private:
     Allocator<MsgPlayableSilence> iAllocatorMsgPlayableSilence;
     Allocator<MsgPlayableSilenceDsd> iAllocatorMsgPlayableSilenceDsd;
     Allocator<MsgQuit> iAllocatorMsgQuit;
+    const PcmStorage iDecodedPcmStorage;
 };
 
 #include <OpenHome/Media/Pipeline/Msg.inl>
@@ -319,6 +319,8 @@ inline MsgFactoryInitParams::MsgFactoryInitParams()
     , iMsgPlayableDsdCount(1)
     , iMsgPlayableSilenceCount(1)
     , iMsgQuitCount(1)
+    , iDecodedPcmStorage(PcmStorage::PackedBigEndian)
+    , iMemoryBudgetBytes(0)
 {
 }
 inline void MsgFactoryInitParams::SetMsgModeCount(TUint aCount)
@@ -397,6 +399,14 @@ inline void MsgFactoryInitParams::SetMsgQuitCount(TUint aCount)
 {
     iMsgQuitCount = aCount;
 }
+inline void MsgFactoryInitParams::SetDecodedPcmStorage(PcmStorage aStorage)
+{
+    iDecodedPcmStorage = aStorage;
+}
+inline void MsgFactoryInitParams::SetMemoryBudget(TUint aBytes)
+{
+    iMemoryBudgetBytes = aBytes;
+}
 
 
 // MsgFactory
@@ -489,3 +499,7 @@ inline TUint MsgFactory::AllocatorQuitCount() const
 {
     return iAllocatorMsgQuit.CellsUsed();
 }
+inline PcmStorage MsgFactory::DecodedPcmStorage() const
+{
+    return iDecodedPcmStorage;
+}
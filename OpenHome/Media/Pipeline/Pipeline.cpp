@@ -65,6 +65,8 @@ PipelineInitParams::PipelineInitParams()
     , iSupportElements(EPipelineSupportElementsAll)
     , iMuter(kMuterDefault)
     , iDsdMaxSampleRate(kDsdMaxSampleRateDefault)
+    , iDecodedPcmStorage(kDecodedPcmStorageDefault)
+    , iMsgMemoryBudgetBytes(kMsgMemoryBudgetDefault)
 {
     SetThreadPriorityMax(kThreadPriorityMax);
 }
@@ -152,6 +154,16 @@ void PipelineInitParams::SetDsdMaxSampleRate(TUint aMaxSampleRate)
     iDsdMaxSampleRate = aMaxSampleRate;
 }
 
+void PipelineInitParams::SetDecodedPcmStorage(PcmStorage aStorage)
+{
+    iDecodedPcmStorage = aStorage;
+}
+
+void PipelineInitParams::SetMsgMemoryBudget(TUint aBytes)
+{
+    iMsgMemoryBudgetBytes = aBytes;
+}
+
 TUint PipelineInitParams::EncodedReservoirBytes() const
 {
     return iEncodedReservoirBytes;
@@ -232,6 +244,16 @@ TUint OpenHome::Media::PipelineInitParams::DsdMaxSampleRate() const
     return iDsdMaxSampleRate;
 }
 
+PcmStorage PipelineInitParams::DecodedPcmStorage() const
+{
+    return iDecodedPcmStorage;
+}
+
+TUint PipelineInitParams::MsgMemoryBudgetBytes() const
+{
+    return iMsgMemoryBudgetBytes;
+}
+
 
 // Pipeline
 
@@ -336,9 +358,12 @@ Pipeline::Pipeline(
     msgInit.SetMsgSilenceCount(kMsgCountSilence);
     msgInit.SetMsgPlayableCount(kMsgCountPlayablePcm, kMsgCountPlayableDsd, kMsgCountPlayableSilence);
     msgInit.SetMsgQuitCount(kMsgCountQuit);
+    msgInit.SetDecodedPcmStorage(aInitParams->DecodedPcmStorage());
+    msgInit.SetMemoryBudget(aInitParams->MsgMemoryBudgetBytes());
     iMsgFactory = new MsgFactory(aInfoAggregator, msgInit);
 
     iEventThread = new PipelineElementObserverThread(aInitParams->ThreadPriorityEvent());
+    iMsgFactory->SetMemoryReclaimThread(*iEventThread);
     iBranchController = new BranchController();
     IPipelineElementDownstream* downstream = nullptr;
     IPipelineElementUpstream* upstream = nullptr;
@@ -957,6 +982,12 @@ TUint Pipeline::SenderMinLatencyMs() const
     return Jiffies::ToMs(iInitParams->SenderMinLatency());
 }
 
+void Pipeline::SetSenderLatencyMs(TUint aLatencyMs)
+{
+    const TUint latency = std::max(aLatencyMs * Jiffies::kPerMs, iInitParams->SenderMinLatency());
+    iVariableDelay2->SetMinDelay(latency);
+}
+
 void Pipeline::GetThreadPriorityRange(TUint& aMin, TUint& aMax) const
 {
     aMax = iInitParams->ThreadPriorityStarvationRamper();
@@ -992,6 +1023,12 @@ static void LogComponentAudioThroughput(Logger* aLogger) {
 }
 #endif // PIPELINE_LOG_AUDIO_THROUGHPUT
 
+void Pipeline::GetEncodedReservoirLevel(TUint& aBytes, TUint& aMaxBytes) const
+{
+    aBytes = iEncodedAudioReservoir->SizeInBytes();
+    aMaxBytes = iInitParams->EncodedReservoirBytes();
+}
+
 void Pipeline::LogBuffers() const
 {
     const TUint encodedBytes = iEncodedAudioReservoir->SizeInBytes();
@@ -57,6 +57,8 @@ public:
     void SetSupportElements(TUint aElements); // EPipelineSupportElements members OR'd together
     void SetMuter(MuterImpl aMuter);
     void SetDsdMaxSampleRate(TUint aMaxSampleRate);
+    void SetDecodedPcmStorage(PcmStorage aStorage); // defaults to PackedBigEndian.  Int32 suits drivers consuming IPcmProcessorInt32
+    void SetMsgMemoryBudget(TUint aBytes); // 0 => preallocate all msgs.  Otherwise msgs are created on demand, aiming to use at most aBytes
     // getters
     TUint EncodedReservoirBytes() const;
     TUint DecodedReservoirJiffies() const;
@@ -74,6 +76,8 @@ public:
     TUint SupportElements() const;
     MuterImpl Muter() const;
     TUint DsdMaxSampleRate() const;
+    PcmStorage DecodedPcmStorage() const;
+    TUint MsgMemoryBudgetBytes() const;
 private:
     PipelineInitParams();
 private:
@@ -93,6 +97,8 @@ private:
     TUint iSupportElements;
     MuterImpl iMuter;
     TUint iDsdMaxSampleRate;
+    PcmStorage iDecodedPcmStorage;
+    TUint iMsgMemoryBudgetBytes;
 private:
     static const TUint kEncodedReservoirSizeBytes       = 1536 * 1024;
     static const TUint kDecodedReservoirSize            = Jiffies::kPerMs * 2000;
@@ -107,6 +113,8 @@ private:
     static const TUint kMaxLatencyDefault               = Jiffies::kPerMs * 2000;
     static const MuterImpl kMuterDefault                = MuterImpl::eRampSamples;
     static const TUint kDsdMaxSampleRateDefault         = 0;
+    static const PcmStorage kDecodedPcmStorageDefault   = PcmStorage::PackedBigEndian;
+    static const TUint kMsgMemoryBudgetDefault          = 0;
 };
 
 namespace Codec {
@@ -219,9 +227,11 @@ public:
     IClockPuller& GetPhaseAdjuster();
     IBranchController& GetBranchController() const;
     TUint SenderMinLatencyMs() const;
+    void SetSenderLatencyMs(TUint aLatencyMs);
     void GetThreadPriorityRange(TUint& aMin, TUint& aMax) const;
     void GetThreadPriorities(TUint& aFlywheelRamper, TUint& aStarvationRamper, TUint& aCodec, TUint& aEvent);
     void GetMaxSupportedSampleRates(TUint& aPcm, TUint& aDsd) const;
+    void GetEncodedReservoirLevel(TUint& aBytes, TUint& aMaxBytes) const;
     void LogBuffers() const;
 public: // from IPipelineElementDownstream
     void Push(Msg* aMsg) override;
@@ -114,73 +114,29 @@ void FlywheelInput::BeginBlock()
 {
 }
 
-inline void FlywheelInput::AppendSubsample8(TByte*& aDest, const TByte*& aSrc)
+void FlywheelInput::ProcessFragment(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint /*aBitDepth*/)
 {
-    *aDest++ = *aSrc++;
-    *aDest++ = 0;
-    *aDest++ = 0;
-    *aDest++ = 0;
+    DoProcessFragment(aSubsamples, aNumSamples, aNumChannels);
 }
 
-inline void FlywheelInput::AppendSubsample16(TByte*& aDest, const TByte*& aSrc)
+void FlywheelInput::ProcessSilence(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint /*aBitDepth*/)
 {
-    *aDest++ = *aSrc++;
-    *aDest++ = *aSrc++;
-    *aDest++ = 0;
-    *aDest++ = 0;
+    DoProcessFragment(aSubsamples, aNumSamples, aNumChannels);
 }
 
-inline void FlywheelInput::AppendSubsample24(TByte*& aDest, const TByte*& aSrc)
+void FlywheelInput::DoProcessFragment(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels)
 {
-    *aDest++ = *aSrc++;
-    *aDest++ = *aSrc++;
-    *aDest++ = *aSrc++;
-    *aDest++ = 0;
-}
-
-inline void FlywheelInput::AppendSubsample32(TByte*& aDest, const TByte*& aSrc)
-{
-    *aDest++ = *aSrc++;
-    *aDest++ = *aSrc++;
-    *aDest++ = *aSrc++;
-    *aDest++ = *aSrc++;
-}
-
-void FlywheelInput::ProcessFragment(const Brx& aData, TUint aNumChannels, TUint aSubsampleBytes)
-{
-    DoProcessFragment(aData, aNumChannels, aSubsampleBytes);
-}
-
-void FlywheelInput::ProcessSilence(const Brx& aData, TUint aNumChannels, TUint aSubsampleBytes)
-{
-    DoProcessFragment(aData, aNumChannels, aSubsampleBytes);
-}
-
-void FlywheelInput::DoProcessFragment(const Brx& aData, TUint aNumChannels, TUint aSubsampleBytes)
-{
-    const TByte* src = aData.Ptr();
-    const TUint numSubsamples = aData.Bytes() / aSubsampleBytes;
-    const TUint numSamples = numSubsamples / aNumChannels;
-    for (TUint i=0; i<numSamples; i++) {
+    /* Subsamples arrive left-justified so can be written out as big endian 32-bit values,
+       regardless of the stream's bit depth.  This avoids unpacking each subsample byte by byte. */
+    const TInt32* src = aSubsamples;
+    for (TUint i=0; i<aNumSamples; i++) {
         for (TUint j=0; j<aNumChannels; j++) {
-            switch (aSubsampleBytes)
-            {
-            case 1:
-                AppendSubsample8(iChannelPtr[j], src);
-                break;
-            case 2:
-                AppendSubsample16(iChannelPtr[j], src);
-                break;
-            case 3:
-                AppendSubsample24(iChannelPtr[j], src);
-                break;
-            case 4:
-                AppendSubsample32(iChannelPtr[j], src);
-                break;
-            default:
-                ASSERTS();
-                break;
-            }
+            const TUint32 subsample = (TUint32)*src++;
+            TByte*& dest = iChannelPtr[j];
+            *dest++ = (TByte)(subsample >> 24);
+            *dest++ = (TByte)(subsample >> 16);
+            *dest++ = (TByte)(subsample >> 8);
+            *dest++ = (TByte)subsample;
         }
     }
 }
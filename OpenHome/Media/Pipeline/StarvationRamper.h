@@ -30,7 +30,7 @@ public:
     virtual void WaitForOccupancy(TUint aJiffies) = 0;
 };
 
-class FlywheelInput : public IPcmProcessor
+class FlywheelInput : public IPcmProcessorInt32
 {
     static const TUint kMaxSampleRate = 192000;
     static const TUint kMaxChannels = 10;
@@ -40,15 +40,11 @@ public:
     ~FlywheelInput();
     const Brx& Prepare(MsgQueueLite& aQueue, TUint aJiffies, TUint aSampleRate, TUint aBitDepth, TUint aNumChannels);
 private:
-    inline static void AppendSubsample8(TByte*& aDest, const TByte*& aSrc);
-    inline static void AppendSubsample16(TByte*& aDest, const TByte*& aSrc);
-    inline static void AppendSubsample24(TByte*& aDest, const TByte*& aSrc);
-    inline static void AppendSubsample32(TByte*& aDest, const TByte*& aSrc);
-    void DoProcessFragment(const Brx& aData, TUint aNumChannels, TUint aSubsampleBytes);
-private: // from IPcmProcessor
+    void DoProcessFragment(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels);
+private: // from IPcmProcessorInt32
     void BeginBlock() override;
-    void ProcessFragment(const Brx& aData, TUint aNumChannels, TUint aSubsampleBytes) override;
-    void ProcessSilence(const Brx& aData, TUint aNumChannels, TUint aSubsampleBytes) override;
+    void ProcessFragment(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint aBitDepth) override;
+    void ProcessSilence(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint aBitDepth) override;
     void EndBlock() override;
     void Flush() override;
 private:
@@ -648,6 +648,10 @@ VariableDelayRight::VariableDelayRight(MsgFactory& aMsgFactory,
                                        TUint aRampDuration, TUint aMinDelay)
     : VariableDelayBase(aMsgFactory, aUpstreamElement, aRampDuration, "right")
     , iMinDelay(aMinDelay)
+    , iMinDelayPending(aMinDelay)
+    , iMinDelayChanged(false)
+    , iDelaySeen(false)
+    , iDelayJiffiesRequested(0)
     , iDelayJiffiesTotal(0)
     , iAnimatorLatency(0)
     , iSampleRate(0)
@@ -656,8 +660,37 @@ VariableDelayRight::VariableDelayRight(MsgFactory& aMsgFactory,
 {
 }
 
+void VariableDelayRight::SetMinDelay(TUint aMinDelay)
+{
+    AutoMutex _(iLock);
+    iMinDelayPending = aMinDelay;
+    iMinDelayChanged = true;
+}
+
+Msg* VariableDelayRight::Pull()
+{
+    iLock.Wait();
+    const TBool changed = iMinDelayChanged;
+    const TUint minDelay = iMinDelayPending;
+    iMinDelayChanged = false;
+    iLock.Signal();
+
+    if (changed && minDelay != iMinDelay) {
+        iMinDelay = minDelay;
+        if (iDelaySeen) {
+            const TUint delayJiffies = UpdateDelay();
+            LOG(kMedia, "VariableDelayRight::SetMinDelay(%u): delay=%u(%u), iStatus=%s\n",
+                        iMinDelay, delayJiffies, Jiffies::ToMs(delayJiffies), Status());
+            HandleDelayChange(delayJiffies);
+        }
+    }
+    return VariableDelayBase::Pull();
+}
+
 Msg* VariableDelayRight::ProcessMsg(MsgMode* aMsg)
 {
+    iDelaySeen = false;
+    iDelayJiffiesRequested = 0;
     iDelayJiffiesTotal = 0;
     return VariableDelayBase::ProcessMsg(aMsg);
 }
@@ -666,11 +699,10 @@ Msg* VariableDelayRight::ProcessMsg(MsgDelay* aMsg)
 {
     const TUint msgDelayJiffies = aMsg->RemainingJiffies();
     const TUint msgDelayTotalJiffies = aMsg->TotalJiffies();
-    TUint delayJiffies = std::max(msgDelayJiffies, iMinDelay);
-    iDelayJiffiesTotal = delayJiffies;
     aMsg->RemoveRef();
-    delayJiffies = (iAnimatorLatency >= delayJiffies? 0 : delayJiffies - iAnimatorLatency);
-    delayJiffies = std::max(delayJiffies, iMinDelay);
+    iDelaySeen = true;
+    iDelayJiffiesRequested = msgDelayJiffies;
+    const TUint delayJiffies = UpdateDelay();
     LOG(kMedia, "VariableDelayRight::ProcessMsg(MsgDelay(%u): delay=%u(%u), downstream=%u(%u), prev=%u(%u), iStatus=%s\n",
                 msgDelayJiffies,
                 delayJiffies, Jiffies::ToMs(delayJiffies),
@@ -712,6 +744,13 @@ void VariableDelayRight::NotifyDelayApplied(TUint /*aJiffies*/)
     }
 }
 
+TUint VariableDelayRight::UpdateDelay()
+{
+    iDelayJiffiesTotal = std::max(iDelayJiffiesRequested, iMinDelay);
+    const TUint delayJiffies = (iAnimatorLatency >= iDelayJiffiesTotal? 0 : iDelayJiffiesTotal - iAnimatorLatency);
+    return std::max(delayJiffies, iMinDelay);
+}
+
 void VariableDelayRight::AdjustDelayForAnimatorLatency()
 {
     try {
@@ -719,8 +758,7 @@ void VariableDelayRight::AdjustDelayForAnimatorLatency()
             auto streamInfo = iDecodedStream->StreamInfo();
             ASSERT(iAnimator != nullptr);
             iAnimatorLatency = iAnimator->PipelineAnimatorDelayJiffies(streamInfo.Format(), iSampleRate, iBitDepth, iNumChannels);
-            TUint delayJiffies = (iAnimatorLatency >= iDelayJiffiesTotal? 0 : iDelayJiffiesTotal - iAnimatorLatency);
-            delayJiffies = std::max(delayJiffies, iMinDelay);
+            const TUint delayJiffies = (iDelaySeen? UpdateDelay() : iMinDelay);
             HandleDelayChange(delayJiffies);
         }
     }
@@ -121,6 +121,13 @@ public:
     VariableDelayRight(MsgFactory& aMsgFactory,
                        IPipelineElementUpstream& aUpstreamElement,
                        TUint aRampDuration, TUint aMinDelay);
+    /*
+     * Change the minimum delay applied.  Can be called from any thread.  Takes effect
+     * (ramping through any change in delay) the next time a msg is pulled.
+     */
+    void SetMinDelay(TUint aMinDelay);
+public: // from IPipelineElementUpstream
+    Msg* Pull() override;
 private: // from PipelineElement (IMsgProcessor)
     using VariableDelayBase::ProcessMsg;
     Msg* ProcessMsg(MsgMode* aMsg) override;
@@ -131,10 +138,15 @@ private: // from VariableDelayBase
 private: // from IVariableDelayObserver
     void NotifyDelayApplied(TUint aJiffies) override;
 private:
+    TUint UpdateDelay(); // returns delay to apply locally
     void AdjustDelayForAnimatorLatency();
     void StartClockPuller();
 private:
-    const TUint iMinDelay;
+    TUint iMinDelay;
+    TUint iMinDelayPending;
+    TBool iMinDelayChanged;
+    TBool iDelaySeen;           // a MsgDelay has been pulled since the last MsgMode
+    TUint iDelayJiffiesRequested;
     TUint iDelayJiffiesTotal;
     TUint iAnimatorLatency;
     TUint iSampleRate;
@@ -353,6 +353,11 @@ TUint PipelineManager::SenderMinLatencyMs() const
     return iPipeline->SenderMinLatencyMs();
 }
 
+void PipelineManager::SetSenderLatencyMs(TUint aLatencyMs)
+{
+    iPipeline->SetSenderLatencyMs(aLatencyMs);
+}
+
 void PipelineManager::GetThreadPriorityRange(TUint& aMin, TUint& aMax) const
 {
     iPipeline->GetThreadPriorityRange(aMin, aMax);
@@ -369,6 +374,11 @@ void PipelineManager::GetMaxSupportedSampleRates(TUint& aPcm, TUint& aDsd) const
     iPipeline->GetMaxSupportedSampleRates(aPcm, aDsd);
 }
 
+void PipelineManager::GetEncodedReservoirLevel(TUint& aBytes, TUint& aMaxBytes) const
+{
+    iPipeline->GetEncodedReservoirLevel(aBytes, aMaxBytes);
+}
+
 Msg* PipelineManager::Pull()
 {
     return iPipeline->Pull();
@@ -298,9 +298,23 @@ public:
     void Prev();
     IBranchController& GetBranchController() const;
     TUint SenderMinLatencyMs() const;
+    /**
+     * Set the latency a songcast sender is currently advertising.
+     *
+     * Local playback is delayed by the same amount so that it remains in sync with
+     * receivers.  Values below SenderMinLatencyMs() are treated as SenderMinLatencyMs().
+     */
+    void SetSenderLatencyMs(TUint aLatencyMs);
     void GetThreadPriorityRange(TUint& aMin, TUint& aMax) const;
     void GetThreadPriorities(TUint& aFiller, TUint& aFlywheelRamper, TUint& aStarvationRamper, TUint& aCodec, TUint& aEvent);
     void GetMaxSupportedSampleRates(TUint& aPcm, TUint& aDsd) const;
+    /**
+     * Report how much encoded audio is currently buffered, ahead of the codec.
+     *
+     * @param[out] aBytes      Bytes currently held in the encoded reservoir.
+     * @param[out] aMaxBytes   Nominal capacity of the encoded reservoir.
+     */
+    void GetEncodedReservoirLevel(TUint& aBytes, TUint& aMaxBytes) const;
 public: // from IPipelineObservable
     void AddObserver(IPipelineObserver& aObserver) override;
     void RemoveObserver(IPipelineObserver& aObserver) override;
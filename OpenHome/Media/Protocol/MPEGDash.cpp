@@ -1,4 +1,5 @@
 #include <OpenHome/Functor.h>
+#include <OpenHome/OsWrapper.h>
 #include <OpenHome/Media/Debug.h>
 #include <OpenHome/Private/Uri.h>
 #include <OpenHome/Private/Debug.h>
@@ -14,6 +15,7 @@
 #include <OpenHome/Media/Pipeline/Pipeline.h>
 #include <OpenHome/Media/PipelineManager.h>
 #include <OpenHome/Private/Http.h>
+#include <OpenHome/Private/Env.h>
 #include <OpenHome/Private/Time.h>
 #include <OpenHome/Private/Timer.h>
 #include <OpenHome/Av/Radio/ContentProcessorFactory.h>
@@ -768,6 +770,15 @@ TBool MPDDocument::TrySet(const Brx& aXml)
 
     return true;
 }
+TBool MPDDocument::TrySelectRepresentation(const Brx& aRepresentationId)
+{
+    return iPeriod.TrySelectRepresentation(aRepresentationId);
+}
+
+void MPDDocument::VisitRepresentations(IRepresentationVisitor& aVisitor)
+{
+    iPeriod.VisitRepresentations(aVisitor);
+}
 
 
 void MPDDocument::Visit(IBaseUrlVisitor& aVisitor)
@@ -938,6 +949,16 @@ TBool MPDPeriod::TrySelectAdaptationSet(TUint aIndex)
     return false;
 }
 
+TBool MPDPeriod::TrySelectRepresentation(const Brx& aRepresentationId)
+{
+    return iAdaptationSet.TrySelectRepresentation(aRepresentationId);
+}
+
+void MPDPeriod::VisitRepresentations(IRepresentationVisitor& aVisitor)
+{
+    iAdaptationSet.Visit(aVisitor);
+}
+
 void MPDPeriod::Visit(IAdaptationSetVisitor& aVisitor)
 {
     if (iXml.Bytes() == 0) {
@@ -1586,6 +1607,61 @@ TBool MPDSegmentStream::TrySet(MPDDocument& aDocument, TBool aIsUpdate)
 
     iCurrentDocument = &aDocument;
 
+    if (!TryFindSegmentXml()) {
+        Log::Print("!! MPD: Unknown segment type found.\n");
+        return false;
+    }
+
+    if (aIsUpdate) {
+        // NOTE: We don't really check if it's the same manifest, or the new one contains all the bits and pieces
+        //       we actually need. Perhaps we should do something like that in the future....
+        return true;
+    }
+    else {
+        return TrySetInitialSegmentNumber();
+    }
+}
+
+TBool MPDSegmentStream::TrySelectRepresentation(const Brx& aRepresentationId)
+{
+    if (iCurrentDocument == nullptr) {
+        return false;
+    }
+
+    const MPDRepresentation& current = iCurrentDocument->Period().AdaptationSet().Representation();
+    if (current.Id() == aRepresentationId) {
+        return true;
+    }
+
+    Bws<DashBitrateSelector::kMaxIdBytes> previousId;
+    if (current.Id().Bytes() > previousId.MaxBytes()) {
+        return false;
+    }
+    previousId.Replace(current.Id());
+    const ESegmentType previousType = iSegmentType;
+
+    if (!iCurrentDocument->TrySelectRepresentation(aRepresentationId)) {
+        LOG_ERROR(kMedia, "MPDSegmentStream::TrySelectRepresentation - No representation with id: %.*s\n", PBUF(aRepresentationId));
+        return false;
+    }
+
+    // Segment numbering is shared by all representations of an adaptation set (spec link: 5.3.3.2, segmentAlignment),
+    // so we continue from iSegmentNumber. We can't cope with the addressing scheme changing beneath us though.
+    if (!TryFindSegmentXml() || iSegmentType != previousType) {
+        LOG_ERROR(kMedia, "MPDSegmentStream::TrySelectRepresentation - Representation %.*s uses a different segment type\n", PBUF(aRepresentationId));
+        (void)iCurrentDocument->TrySelectRepresentation(previousId);
+        (void)TryFindSegmentXml();
+        return false;
+    }
+
+    return true;
+}
+
+TBool MPDSegmentStream::TryFindSegmentXml()
+{
+    iSegmentType = ESegmentType::Unknown;
+    iSegmentXml.Set(Brx::Empty());
+
     // Now we need to decide what the type of stream we require from the given manifest. This'll be one of the 3 supported types:
     // Types marked with a (*) are not currently supported.
     //  -     List (each segment is provided in a list, optionally as ranges within a single URL)
@@ -1616,19 +1692,7 @@ TBool MPDSegmentStream::TrySet(MPDDocument& aDocument, TBool aIsUpdate)
         }
     }
 
-    if (iSegmentXml.Bytes() == 0 || iSegmentType == ESegmentType::Unknown) {
-        Log::Print("!! MPD: Unknown segment type found.\n");
-        return false;
-    }
-
-    if (aIsUpdate) {
-        // NOTE: We don't really check if it's the same manifest, or the new one contains all the bits and pieces
-        //       we actually need. Perhaps we should do something like that in the future....
-        return true;
-    }
-    else {
-        return TrySetInitialSegmentNumber();
-    }
+    return iSegmentXml.Bytes() > 0 && iSegmentType != ESegmentType::Unknown;
 }
 
 
@@ -1704,6 +1768,245 @@ TBool MPDSegmentStream::TryGetSegmentTemplateStartingNumber(SegmentTemplate& aSe
 
 
 
+// DashThroughputEstimator
+const TUint DashThroughputEstimator::kFastHalfLifeMs = 3000;
+const TUint DashThroughputEstimator::kSlowHalfLifeMs = 8000;
+const TUint DashThroughputEstimator::kMinSampleBytes = 16 * 1024;
+
+DashThroughputEstimator::Ewma::Ewma(TUint aHalfLifeMs)
+    : iAlpha(exp(log(0.5) / (aHalfLifeMs / 1000.0)))
+{
+    Reset();
+}
+
+void DashThroughputEstimator::Ewma::Reset()
+{
+    iEstimate = 0;
+    iTotalWeight = 0;
+}
+
+void DashThroughputEstimator::Ewma::Add(double aWeightSecs, double aValue)
+{
+    // Longer downloads carry more weight. i.e. a download lasting one half-life moves the estimate half way to aValue.
+    const double adjustedAlpha = pow(iAlpha, aWeightSecs);
+    iEstimate = (aValue * (1 - adjustedAlpha)) + (adjustedAlpha * iEstimate);
+    iTotalWeight += aWeightSecs;
+}
+
+double DashThroughputEstimator::Ewma::Estimate() const
+{
+    // iEstimate starts at 0 so is biased low until enough samples have been seen. Correct for this.
+    const double zeroFactor = 1 - pow(iAlpha, iTotalWeight);
+    return iEstimate / zeroFactor;
+}
+
+DashThroughputEstimator::DashThroughputEstimator()
+    : iFast(kFastHalfLifeMs)
+    , iSlow(kSlowHalfLifeMs)
+    , iSamples(0)
+{ }
+
+void DashThroughputEstimator::Reset()
+{
+    iFast.Reset();
+    iSlow.Reset();
+    iSamples = 0;
+}
+
+void DashThroughputEstimator::AddSample(TUint64 aBytes, TUint aDurationUs)
+{
+    if (aBytes < kMinSampleBytes) {
+        return;
+    }
+    if (aDurationUs == 0) {
+        aDurationUs = 1;
+    }
+
+    const double durationSecs  = aDurationUs / 1000000.0;
+    const double bitsPerSecond = (aBytes * 8) / durationSecs;
+    iFast.Add(durationSecs, bitsPerSecond);
+    iSlow.Add(durationSecs, bitsPerSecond);
+    iSamples += 1;
+}
+
+TBool DashThroughputEstimator::HasEstimate() const
+{
+    return iSamples > 0;
+}
+
+TUint DashThroughputEstimator::EstimateBitsPerSecond() const
+{
+    if (iSamples == 0) {
+        return 0;
+    }
+
+    const double fast = iFast.Estimate();
+    const double slow = iSlow.Estimate();
+    const double estimate = fast < slow ? fast : slow;
+    if (estimate >= UINT_MAX) {
+        return UINT_MAX;
+    }
+    return static_cast<TUint>(estimate);
+}
+
+
+// DashBitrateSelector
+const TUint DashBitrateSelector::kSafetyFactorPercent   = 90;
+const TUint DashBitrateSelector::kUpSwitchFactorPercent = 70;
+const TUint DashBitrateSelector::kLowBufferMs           = 4000;
+const TUint DashBitrateSelector::kUpSwitchMinBufferMs   = 10000;
+const TUint DashBitrateSelector::kUpSwitchHoldSegments  = 3;
+
+DashBitrateSelector::DashBitrateSelector()
+{
+    Reset();
+}
+
+void DashBitrateSelector::Reset()
+{
+    // NOTE: The throughput estimate is deliberately kept. Network conditions don't change just because a new
+    //       stream (or refreshed manifest) has started.
+    iCandidateCount = 0;
+    iCurrent = -1;
+    iSegmentsSinceSwitch = 0;
+    iSwitchCount = 0;
+}
+
+TBool DashBitrateSelector::TrySetCurrent(const Brx& aRepresentationId)
+{
+    for (TUint i = 0; i < iCandidateCount; i += 1) {
+        if (iCandidates[i].iId == aRepresentationId) {
+            iCurrent = static_cast<TInt>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const Brx& DashBitrateSelector::Current() const
+{
+    if (iCurrent < 0) {
+        return Brx::Empty();
+    }
+    return iCandidates[iCurrent].iId;
+}
+
+TUint DashBitrateSelector::CurrentBandwidth() const
+{
+    if (iCurrent < 0) {
+        return 0;
+    }
+    return iCandidates[iCurrent].iBandwidth;
+}
+
+TUint DashBitrateSelector::SwitchCount() const
+{
+    return iSwitchCount;
+}
+
+void DashBitrateSelector::SegmentDownloaded(TUint64 aBytes, TUint aDurationUs)
+{
+    iEstimator.AddSample(aBytes, aDurationUs);
+}
+
+const Brx& DashBitrateSelector::Select(TUint aBufferedMs)
+{
+    if (iCurrent < 0) {
+        return Brx::Empty();
+    }
+
+    iSegmentsSinceSwitch += 1;
+    if (!iEstimator.HasEstimate()) {
+        return iCandidates[iCurrent].iId;
+    }
+
+    const TUint64 estimate = iEstimator.EstimateBitsPerSecond();
+    const TUint keepPercent = aBufferedMs < kLowBufferMs ? kUpSwitchFactorPercent : kSafetyFactorPercent;
+    TInt target = iCurrent;
+
+    if (static_cast<TUint64>(iCandidates[iCurrent].iBandwidth) * 100 > estimate * keepPercent) {
+        target = HighestSustainable((estimate * keepPercent) / 100);
+    }
+    else if (aBufferedMs >= kUpSwitchMinBufferMs && iSegmentsSinceSwitch >= kUpSwitchHoldSegments) {
+        const TInt up = HighestSustainable((estimate * kUpSwitchFactorPercent) / 100);
+        if (up > iCurrent) {
+            target = up;
+        }
+    }
+
+    if (target != iCurrent) {
+        LOG(kMedia, "DashBitrateSelector::Select - %.*s (%u bps) -> %.*s (%u bps). Estimate: %llu bps, buffered: %ums\n",
+                    PBUF(iCandidates[iCurrent].iId), iCandidates[iCurrent].iBandwidth,
+                    PBUF(iCandidates[target].iId), iCandidates[target].iBandwidth,
+                    estimate, aBufferedMs);
+        iCurrent = target;
+        iSegmentsSinceSwitch = 0;
+        iSwitchCount += 1;
+    }
+
+    return iCandidates[iCurrent].iId;
+}
+
+void DashBitrateSelector::VisitRepresentation(const Brx& aId, TUint aBandwidth, TUint /*aQualityRanking*/, const Brx& aRepresentationXml)
+{
+    if (iCandidateCount == kMaxRepresentations || aId.Bytes() > kMaxIdBytes) {
+        LOG_WARNING(kMedia, "DashBitrateSelector::VisitRepresentation - Ignoring representation: %.*s\n", PBUF(aId));
+        return;
+    }
+
+    Candidate candidate;
+    candidate.iId.Replace(aId);
+    candidate.iBandwidth = aBandwidth;
+
+    // Either attribute may instead be specified on the parent AdaptationSet, in which case it's common to all candidates.
+    Parser p;
+    Brn key;
+    Brn value;
+    if (TryCreateAttributeParser(aRepresentationXml, kMPDTagRepresentation, p)) {
+        while (TryReadAttribute(p, key, value)) {
+            if (key.Equals(Brn("codecs"))) {
+                candidate.iCodecs.Replace(value.Split(0, std::min(value.Bytes(), candidate.iCodecs.MaxBytes())));
+            }
+            else if (key.Equals(Brn("audioSamplingRate"))) {
+                candidate.iSamplingRate.Replace(value.Split(0, std::min(value.Bytes(), candidate.iSamplingRate.MaxBytes())));
+            }
+        }
+    }
+
+    // Keep candidates sorted by ascending bandwidth.
+    TUint index = iCandidateCount;
+    while (index > 0 && iCandidates[index - 1].iBandwidth > aBandwidth) {
+        iCandidates[index] = iCandidates[index - 1];
+        index -= 1;
+    }
+    iCandidates[index] = candidate;
+    iCandidateCount += 1;
+}
+
+TBool DashBitrateSelector::IsCompatible(const Candidate& aCandidate) const
+{
+    const Candidate& current = iCandidates[iCurrent];
+    return aCandidate.iCodecs == current.iCodecs
+        && aCandidate.iSamplingRate == current.iSamplingRate;
+}
+
+TInt DashBitrateSelector::HighestSustainable(TUint64 aBitsPerSecond) const
+{
+    // Falls back to the lowest compatible representation if none are sustainable.
+    TInt selected = -1;
+    for (TUint i = 0; i < iCandidateCount; i += 1) {
+        if (!IsCompatible(iCandidates[i])) {
+            continue;
+        }
+        if (selected == -1 || iCandidates[i].iBandwidth <= aBitsPerSecond) {
+            selected = static_cast<TInt>(i);
+        }
+    }
+    return selected;
+}
+
+
+
 // ContentMPD
 class ContentMPD : public Media::ContentProcessor
 {
@@ -1820,9 +2123,16 @@ private:
     TBool TryConnectSocket(const Brx& aUri, TUint& port);
     void OnManifestExpiryTimerFired();
     ProtocolStreamResult StreamManifest();
+    void InitialiseBitrateSelector(TBool aIsUpdate);
+    void SelectRepresentation();
+    TUint BufferedMs() const;
 
 private:
+    PipelineManager& iPipeline;
     MPDSegmentStream iSegmentStream;
+    DashBitrateSelector iBitrateSelector;
+    TUint64 iSegmentBytes;
+    TUint64 iSegmentUs;
     ISupply* iSupply;
     Bwh iSegmentUrlBuffer;
     Uri iUri;
@@ -1860,7 +2170,10 @@ Protocol* ProtocolFactory::NewDash(Environment& aEnv, SslContext& aSsl, Av::IMed
 // ProtocolDash
 ProtocolDash::ProtocolDash(Environment& aEnv, SslContext& aSsl, Av::IMediaPlayer& aMediaPlayer)
     : ProtocolNetworkSsl(aEnv, aSsl)
+    , iPipeline(aMediaPlayer.Pipeline())
     , iSegmentStream(aMediaPlayer.UnixTimestamp())
+    , iSegmentBytes(0)
+    , iSegmentUs(0)
     , iSupply(nullptr)
     , iSegmentUrlBuffer(1024)
     , iWriterRequest(iSocket)
@@ -1995,6 +2308,9 @@ ProtocolStreamResult ProtocolDash::Stream(const Brx& aUri)
                 LOG_ERROR(kMedia, "ProtocolDash::Stream - Failed to construct segment stream around MPD document\n");
                 res = EProtocolStreamErrorUnrecoverable;
             }
+            else {
+                InitialiseBitrateSelector(isUpdate);
+            }
         }
 
         // Configure emitting a stream message. If we've already started, then we don't emit a new stream message
@@ -2089,7 +2405,13 @@ TUint ProtocolDash::TryStop(TUint aStreamId)
 
 Brn ProtocolDash::Read(TUint aBytes)
 {
-    return iReaderEntity.Read(aBytes);
+    // Only time spent waiting on the network counts towards throughput. Time spent blocked pushing audio
+    // downstream (i.e. because the pipeline is full) would otherwise look like a slow link.
+    const TUint64 start = Os::TimeInUs(iEnv.OsCtx());
+    const Brn buf = iReaderEntity.Read(aBytes);
+    iSegmentUs += Os::TimeInUs(iEnv.OsCtx()) - start;
+    iSegmentBytes += buf.Bytes();
+    return buf;
 }
 
 void ProtocolDash::ReadFlush()
@@ -2182,6 +2504,8 @@ ProtocolStreamResult ProtocolDash::StreamManifest()
     ProtocolStreamResult streamResult = EProtocolStreamSuccess;
 
     while (!iStopped && streamResult == EProtocolStreamSuccess) {
+        SelectRepresentation();
+
         try {
             if (!iSegmentStream.TryGetNextSegment(segment)) {
                 break;
@@ -2258,6 +2582,10 @@ ProtocolStreamResult ProtocolDash::StreamSegment(MPDSegment& aSegment)
     TUint port                  = 0;
     ProtocolStreamResult result = EProtocolStreamErrorUnrecoverable;
 
+    iSegmentBytes = 0;
+    iSegmentUs    = 0;
+    const TUint64 requestStart = Os::TimeInUs(iEnv.OsCtx());
+
     if (TryConnectSocket(aSegment.iUrlBuffer, port)) {
         try {
             iWriterRequest.WriteMethod(Http::kMethodGet, iUri.PathAndQuery(), Http::eHttp11);
@@ -2276,6 +2604,7 @@ ProtocolStreamResult ProtocolDash::StreamSegment(MPDSegment& aSegment)
             iWriterRequest.WriteFlush();
 
             iReaderResponse.Read();
+            iSegmentUs = Os::TimeInUs(iEnv.OsCtx()) - requestStart; // Include time to first byte
 
             const TUint responseCode = iReaderResponse.Status().Code();
             LOG(kMedia, "ProtocolDash::StreamSegment - Read response code: %u\n", responseCode);
@@ -2285,6 +2614,17 @@ ProtocolStreamResult ProtocolDash::StreamSegment(MPDSegment& aSegment)
 
                 result = iProtocolManager->GetAudioProcessor()
                              ->Stream(*this, iHeaderContentLength.ContentLength());
+
+                if (result == EProtocolStreamSuccess) {
+                    // Reads from a full pipeline are served from socket buffers that filled while we were blocked,
+                    // so overstate throughput. Skip such samples.
+                    TUint encodedBytes = 0;
+                    TUint maxEncodedBytes = 0;
+                    iPipeline.GetEncodedReservoirLevel(encodedBytes, maxEncodedBytes);
+                    if (encodedBytes < (maxEncodedBytes / 10) * 9) {
+                        iBitrateSelector.SegmentDownloaded(iSegmentBytes, static_cast<TUint>(iSegmentUs));
+                    }
+                }
             }
             else if (iSegmentStream.IsDynamic() && responseCode == 404) {
                 // For dynamic streams, this suggests that we're requesting a segment from the future. I struggle to hit the case
@@ -2307,6 +2647,51 @@ ProtocolStreamResult ProtocolDash::StreamSegment(MPDSegment& aSegment)
     return result;
 }
 
+void ProtocolDash::InitialiseBitrateSelector(TBool aIsUpdate)
+{
+    // Refreshing the manifest re-runs the default representation selection, so restore the one we were streaming.
+    Bws<DashBitrateSelector::kMaxIdBytes> current(iBitrateSelector.Current());
+    const Brx& defaultId = iMPD.Period().AdaptationSet().Representation().Id();
+
+    iBitrateSelector.Reset();
+    iMPD.VisitRepresentations(iBitrateSelector);
+
+    if (aIsUpdate && current.Bytes() > 0 && iBitrateSelector.TrySetCurrent(current)) {
+        if (!iSegmentStream.TrySelectRepresentation(current)) {
+            (void)iBitrateSelector.TrySetCurrent(defaultId);
+        }
+    }
+    else {
+        (void)iBitrateSelector.TrySetCurrent(defaultId);
+    }
+}
+
+void ProtocolDash::SelectRepresentation()
+{
+    const Brx& selected = iBitrateSelector.Select(BufferedMs());
+    if (selected.Bytes() == 0 || selected == iMPD.Period().AdaptationSet().Representation().Id()) {
+        return;
+    }
+
+    if (!iSegmentStream.TrySelectRepresentation(selected)) {
+        LOG_ERROR(kMedia, "ProtocolDash::SelectRepresentation - Unable to switch to representation %.*s\n", PBUF(selected));
+        (void)iBitrateSelector.TrySetCurrent(iMPD.Period().AdaptationSet().Representation().Id());
+    }
+}
+
+TUint ProtocolDash::BufferedMs() const
+{
+    const TUint bandwidth = iBitrateSelector.CurrentBandwidth();
+    if (bandwidth == 0) {
+        return 0;
+    }
+
+    TUint encodedBytes = 0;
+    TUint maxEncodedBytes = 0;
+    iPipeline.GetEncodedReservoirLevel(encodedBytes, maxEncodedBytes);
+    return static_cast<TUint>((static_cast<TUint64>(encodedBytes) * 8 * 1000) / bandwidth);
+}
+
 void ProtocolDash::OnManifestExpiryTimerFired()
 {
     LOG(kMedia, "ProtocolDash::OnManifestExpiryTimerFired - WARN: Manifest has expired. Needs refreshed.\n");
@@ -242,8 +242,10 @@ public:
     TBool TrySet(const Brx& aXml);
 
     TBool TrySelectAdaptationSet(TUint aIndex); // Annoyingly, adaptation sets don't require an ID and so we must rely on using indexes...
+    TBool TrySelectRepresentation(const Brx& aRepresentationId); // Within the currently selected adaptation set
 
     void Visit(IAdaptationSetVisitor& aVisitor);
+    void VisitRepresentations(IRepresentationVisitor& aVisitor); // Of the currently selected adaptation set
 
 private:
     MPDAdaptationSet iAdaptationSet;
@@ -273,8 +275,10 @@ public:
     void GetBaseUrl(Bwx& aUrlBuffer);
 
     TBool TrySet(const Brx& aXml);
+    TBool TrySelectRepresentation(const Brx& aRepresentationId);
 
     void Visit(IBaseUrlVisitor& aVisitor);
+    void VisitRepresentations(IRepresentationVisitor& aVisitor);
 
 private:
     void TryDetectContentProtection();
@@ -323,7 +327,13 @@ public:
 public: // FIXME: Maybe should be internal to the MPDDocument??
     TBool TrySet(MPDDocument& aDocument, TBool aIsUpdate); // FIXME: Do we need the const here? Perhaps it could be constructed with the document and then have some sort of generational counter to ensure we're still valid??
 
+    // Switches to another representation of the current adaptation set. Takes effect from the next media segment.
+    // NOTE: No initialisation segment is requested for the new representation. The codec has already been configured
+    //       from the first one, so callers must only switch between representations sharing the same codec & sample rate.
+    TBool TrySelectRepresentation(const Brx& aRepresentationId);
+
 private:
+    TBool TryFindSegmentXml();
     TBool TryGetInitialisationSegment(MPDSegment& aSegment);
     TBool TryGetMediaSegment(MPDSegment& aSegment);
 
@@ -340,6 +350,105 @@ private:
     TUint64 iSeekPosition;
 };
 
+// DashThroughputEstimator
+//     Estimates available network throughput from segment download timings.
+//     Two exponentially weighted moving averages (one fast, one slow) are kept, weighted by download duration.
+//     The estimate is the lower of the two so that we react quickly to a drop in throughput but slowly to recovery.
+class DashThroughputEstimator
+{
+public:
+    static const TUint kFastHalfLifeMs;
+    static const TUint kSlowHalfLifeMs;
+    static const TUint kMinSampleBytes; // Smaller downloads (e.g. init segments) are dominated by request latency and ignored
+
+public:
+    DashThroughputEstimator();
+
+public:
+    void Reset();
+    void AddSample(TUint64 aBytes, TUint aDurationUs);
+    TBool HasEstimate() const;
+    TUint EstimateBitsPerSecond() const;
+
+private:
+    class Ewma
+    {
+    public:
+        Ewma(TUint aHalfLifeMs);
+        void Reset();
+        void Add(double aWeightSecs, double aValue);
+        double Estimate() const;
+    private:
+        const double iAlpha;
+        double iEstimate;
+        double iTotalWeight;
+    };
+
+private:
+    Ewma iFast;
+    Ewma iSlow;
+    TUint iSamples;
+};
+
+// DashBitrateSelector
+//     Picks which representation of an adaptation set should provide the next media segment, based on measured
+//     throughput and how much audio is already buffered. Visit the adaptation set to populate candidates, then call
+//     Select() at each segment boundary.
+//
+//     Switching down happens as soon as the current representation is no longer sustainable. Switching up requires
+//     a healthy buffer, a throughput estimate with extra headroom and a minimum number of segments since the
+//     last switch, so that a throughput estimate hovering near a boundary doesn't cause us to oscillate.
+class DashBitrateSelector : public IRepresentationVisitor
+{
+public:
+    static const TUint kMaxRepresentations = 16;
+    static const TUint kMaxIdBytes = 64;
+    static const TUint kMaxCodecBytes = 32;
+
+    static const TUint kSafetyFactorPercent;      // Applied to estimate when deciding if current representation is sustainable
+    static const TUint kUpSwitchFactorPercent;    // Applied to estimate when deciding whether to switch up
+    static const TUint kLowBufferMs;              // Below this, only a representation well within throughput is kept
+    static const TUint kUpSwitchMinBufferMs;      // Must have at least this much buffered to switch up
+    static const TUint kUpSwitchHoldSegments;     // Min segments streamed since last switch before switching up
+
+public:
+    DashBitrateSelector();
+
+public:
+    void Reset();
+    TBool TrySetCurrent(const Brx& aRepresentationId); // Returns false if aRepresentationId has not been visited
+    const Brx& Current() const;
+    TUint CurrentBandwidth() const;
+    TUint SwitchCount() const;
+
+    void SegmentDownloaded(TUint64 aBytes, TUint aDurationUs);
+    const Brx& Select(TUint aBufferedMs); // Returns id of representation that should provide the next segment
+
+private: // IRepresentationVisitor
+    void VisitRepresentation(const Brx& aId, TUint aBandwidth, TUint aQualityRanking, const Brx& aRepresentationXml) override;
+
+private:
+    struct Candidate
+    {
+        Bws<kMaxIdBytes> iId;
+        Bws<kMaxCodecBytes> iCodecs;
+        Bws<kMaxCodecBytes> iSamplingRate;
+        TUint iBandwidth;
+    };
+
+private:
+    TBool IsCompatible(const Candidate& aCandidate) const;
+    TInt HighestSustainable(TUint64 aBitsPerSecond) const;
+
+private:
+    DashThroughputEstimator iEstimator;
+    Candidate iCandidates[kMaxRepresentations]; // Sorted by ascending bandwidth
+    TUint iCandidateCount;
+    TInt iCurrent;
+    TUint iSegmentsSinceSwitch;
+    TUint iSwitchCount;
+};
+
 class IDashDRMProvider
 {
 public:
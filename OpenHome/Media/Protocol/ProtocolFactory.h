@@ -28,8 +28,11 @@ class IServerObserver;
 
 class ProtocolFactory
 {
+public:
+    static const TUint kHlsSegmentLookaheadDefault = 2;
 public:
     static Protocol* NewHls(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent);
+    static Protocol* NewHls(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, TUint aSegmentLookahead); // 0 disables segment prefetch
     static Protocol* NewHttp(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent); // UA is optional so can be empty
     static Protocol* NewHttp(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, IServerObserver& aServerObserver); // UA is optional so can be empty
     static Protocol* NewHttps(Environment& aEnv, SslContext& aSsl);
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <string.h>
 
 namespace OpenHome {
 namespace Media {
@@ -31,7 +32,7 @@ private:
     static const Brn kSchemeHttp;
     static const Brn kSchemeHttps;
 public:
-    ProtocolHls(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent);
+    ProtocolHls(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, TUint aSegmentLookahead);
     ~ProtocolHls();
 private: // from Protocol
     void Initialise(MsgFactory& aMsgFactory, IPipelineElementDownstream& aDownstream) override;
@@ -83,7 +84,12 @@ Protocol* ProtocolFactory::NewHls(Environment& aEnv, SslContext& aSsl, const Brx
      * into an IProtocol interface, is to require ProtocolHls to take ownership
      * of objects passed in.
      */
-    return new ProtocolHls(aEnv, aSsl, aUserAgent);
+    return new ProtocolHls(aEnv, aSsl, aUserAgent, kHlsSegmentLookaheadDefault);
+}
+
+Protocol* ProtocolFactory::NewHls(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, TUint aSegmentLookahead)
+{ // static
+    return new ProtocolHls(aEnv, aSsl, aUserAgent, aSegmentLookahead);
 }
 
 
@@ -397,21 +403,498 @@ void PlaylistProvider::InterruptPlaylistProvider(TBool aInterrupt)
 }
 
 
+// SegmentPrefetcher::Slot
+
+SegmentPrefetcher::Slot::Slot(SegmentPrefetcher& aParent, IUriLoader& aLoader, TUint aBufferBytes)
+    : iParent(aParent)
+    , iLoader(aLoader)
+    , iSem("SPFS", 0)
+    , iBuf(aBufferBytes)
+    , iHead(0)
+    , iCount(0)
+    , iInUse(0)
+    , iState(eIdle)
+    , iSeq(0)
+    , iBusy(false)
+    , iAbandoned(false)
+{
+    iBuf.SetBytes(iBuf.MaxBytes());
+}
+
+void SegmentPrefetcher::Slot::Clear()
+{
+    iHead = iCount = iInUse = 0;
+    iState = eIdle;
+    iSeq = 0;
+    iAbandoned = false;
+}
+
+TUint SegmentPrefetcher::Slot::Space() const
+{
+    return iBuf.Bytes() - iCount - iInUse;
+}
+
+void SegmentPrefetcher::Slot::Append(const Brx& aData)
+{
+    ASSERT(aData.Bytes() <= Space());
+    TByte* ptr = const_cast<TByte*>(iBuf.Ptr());
+    const TUint capacity = iBuf.Bytes();
+    const TUint tail = (iHead + iCount) % capacity;
+    const TUint firstBytes = (capacity - tail < aData.Bytes()? capacity - tail : aData.Bytes());
+    (void)memcpy(ptr + tail, aData.Ptr(), firstBytes);
+    (void)memcpy(ptr, aData.Ptr() + firstBytes, aData.Bytes() - firstBytes);
+    iCount += aData.Bytes();
+}
+
+Brn SegmentPrefetcher::Slot::Take(TUint aBytes)
+{
+    const TUint capacity = iBuf.Bytes();
+    TUint bytes = (iCount < aBytes? iCount : aBytes);
+    if (bytes > capacity - iHead) {
+        bytes = capacity - iHead; // only return contiguous data; remainder is returned by next Read()
+    }
+    Brn buf(iBuf.Ptr() + iHead, bytes);
+    iHead = (iHead + bytes) % capacity;
+    iCount -= bytes;
+    iInUse = bytes;
+    return buf;
+}
+
+TBool SegmentPrefetcher::Slot::HoldsUri() const
+{
+    return iState != eIdle && iState != eUriError && iState != eEndOfStream;
+}
+
+void SegmentPrefetcher::Slot::Run()
+{
+    iParent.FetchLoop(*this);
+}
+
+Brn SegmentPrefetcher::Slot::Read(TUint aBytes)
+{
+    return iParent.ReadSlot(*this, aBytes);
+}
+
+void SegmentPrefetcher::Slot::ReadFlush()
+{
+}
+
+void SegmentPrefetcher::Slot::ReadInterrupt()
+{
+    iParent.InterruptSegmentProvider(true);
+}
+
+
+// SegmentPrefetcher
+
+SegmentPrefetcher::SegmentPrefetcher(ISegmentUriProvider& aProvider, const std::vector<IUriLoader*>& aLoaders, TUint aBufferBytes)
+    : iProvider(aProvider)
+    , iLock("SPF1")
+    , iLockUri("SPF2")
+    , iSemConsumer("SPFC", 0)
+    , iCurrent(nullptr)
+    , iNextUriSeq(0)
+    , iNextReadSeq(0)
+    , iSegmentsDiscarded(0)
+    , iActive(false)
+    , iInterrupted(false)
+    , iUrisExhausted(false)
+    , iFetchingUri(false)
+    , iQuit(false)
+{
+    ASSERT(aLoaders.size() > 0);
+    for (auto loader : aLoaders) {
+        iSlots.push_back(new Slot(*this, *loader, aBufferBytes));
+    }
+    for (auto slot : iSlots) {
+        auto thread = new ThreadFunctor("HlsPrefetch", MakeFunctor(*slot, &Slot::Run));
+        iThreads.push_back(thread);
+        thread->Start();
+    }
+}
+
+SegmentPrefetcher::~SegmentPrefetcher()
+{
+    TBool fetchingUri;
+    {
+        AutoMutex _(iLock);
+        iQuit = true;
+        iActive = false;
+        fetchingUri = iFetchingUri;
+        SignalAllLocked();
+    }
+    if (fetchingUri) {
+        iProvider.InterruptSegmentUriProvider(true);
+    }
+    for (auto slot : iSlots) {
+        slot->iLoader.Interrupt(true);
+    }
+    for (auto thread : iThreads) {
+        delete thread;
+    }
+    for (auto slot : iSlots) {
+        delete slot;
+    }
+}
+
+void SegmentPrefetcher::Reset()
+{
+    LOG(kMedia, "SegmentPrefetcher::Reset\n");
+    TBool fetchingUri;
+    {
+        AutoMutex _(iLock);
+        iActive = false;
+        fetchingUri = iFetchingUri;
+        SignalAllLocked();
+    }
+
+    // Unblock any fetching threads then wait for them to become idle.
+    if (fetchingUri) {
+        iProvider.InterruptSegmentUriProvider(true);
+    }
+    for (auto slot : iSlots) {
+        slot->iLoader.Interrupt(true);
+    }
+    iLock.Wait();
+    for (;;) {
+        TBool busy = false;
+        for (auto slot : iSlots) {
+            busy = busy || slot->iBusy;
+        }
+        if (!busy) {
+            break;
+        }
+        iLock.Signal();
+        iSemConsumer.Wait();
+        iLock.Wait();
+    }
+    iLock.Signal();
+    for (auto slot : iSlots) {
+        slot->iLoader.Interrupt(false);
+        slot->iLoader.Reset();
+    }
+    if (fetchingUri) {
+        iProvider.InterruptSegmentUriProvider(false);
+    }
+
+    /* Only count discarded segments now that all threads are idle.  A NextSegmentUri()
+       call that was in progress above will either have completed (so its slot holds a
+       uri) or been interrupted before consuming one. */
+    AutoMutex _(iLock);
+    TUint discarded = 0;
+    for (auto slot : iSlots) {
+        if (slot->HoldsUri() && slot->iSeq >= iNextReadSeq) {
+            discarded++;
+        }
+        slot->Clear();
+    }
+    iSegmentsDiscarded = discarded;
+    iCurrent = nullptr;
+    iNextUriSeq = iNextReadSeq = 0;
+    iUrisExhausted = false;
+    (void)iSemConsumer.Clear();
+}
+
+TUint SegmentPrefetcher::SegmentsDiscarded() const
+{
+    AutoMutex _(iLock);
+    return iSegmentsDiscarded;
+}
+
+IReader& SegmentPrefetcher::NextSegment()
+{
+    AutoMutex _(iLock);
+    if (iCurrent != nullptr) {
+        ReleaseLocked(*iCurrent);
+        iCurrent = nullptr;
+    }
+    if (!iActive) {
+        iActive = true;
+        SignalAllLocked();
+    }
+
+    Slot* slot = nullptr;
+    for (;;) {
+        if (iInterrupted) {
+            THROW(HlsSegmentError);
+        }
+        slot = FindSlotLocked(iNextReadSeq);
+        if (slot != nullptr && slot->iState != Slot::eLoading) {
+            break;
+        }
+        iLock.Signal();
+        iSemConsumer.Wait();
+        iLock.Wait();
+    }
+
+    switch (slot->iState)
+    {
+    case Slot::eEndOfStream:
+        // Leave slot in place - all subsequent calls report end of stream until Reset().
+        THROW(HlsEndOfStream);
+    case Slot::eUriError:
+        THROW(HlsSegmentError);
+    case Slot::eLoadError:
+        iNextReadSeq++;
+        ReleaseLocked(*slot);
+        THROW(HlsSegmentError);
+    default:
+        break;
+    }
+    iNextReadSeq++;
+    iCurrent = slot;
+    return *slot;
+}
+
+void SegmentPrefetcher::InterruptSegmentProvider(TBool aInterrupt)
+{
+    {
+        AutoMutex _(iLock);
+        iInterrupted = aInterrupt;
+        SignalAllLocked();
+    }
+    for (auto slot : iSlots) {
+        slot->iLoader.Interrupt(aInterrupt);
+    }
+}
+
+void SegmentPrefetcher::FetchLoop(Slot& aSlot)
+{
+    while (WaitForWork(aSlot)) {
+        Slot::EState state = Slot::eLoading;
+        Uri uri;
+        {
+            AutoMutex _(iLockUri);
+            TUint64 seq = 0;
+            {
+                AutoMutex __(iLock);
+                if (!CanFetchLocked()) {
+                    continue;
+                }
+                seq = iNextUriSeq;
+                iFetchingUri = true;
+            }
+            try {
+                (void)iProvider.NextSegmentUri(uri);
+            }
+            catch (const HlsSegmentUriError&) {
+                state = Slot::eUriError;
+            }
+            catch (const HlsEndOfStream&) {
+                state = Slot::eEndOfStream;
+            }
+            AutoMutex __(iLock);
+            iFetchingUri = false;
+            iNextUriSeq++;
+            aSlot.iSeq = seq;
+            aSlot.iState = state;
+            if (state != Slot::eLoading) {
+                iUrisExhausted = true;
+            }
+            iSemConsumer.Signal();
+        }
+        if (state != Slot::eLoading) {
+            continue;
+        }
+
+        IReader* reader = nullptr;
+        try {
+            reader = &aSlot.iLoader.Load(uri);
+        }
+        catch (const UriLoaderError&) {
+            LOG(kMedia, "SegmentPrefetcher::FetchLoop caught UriLoaderError\n");
+        }
+        {
+            AutoMutex _(iLock);
+            aSlot.iState = (reader == nullptr? Slot::eLoadError : Slot::eStreaming);
+            iSemConsumer.Signal();
+        }
+        if (reader != nullptr) {
+            Stream(aSlot, *reader);
+        }
+    }
+}
+
+TBool SegmentPrefetcher::WaitForWork(Slot& aSlot)
+{
+    AutoMutex _(iLock);
+    for (;;) {
+        if (iQuit) {
+            aSlot.iBusy = false;
+            iSemConsumer.Signal();
+            return false;
+        }
+        if (aSlot.iState == Slot::eIdle && CanFetchLocked()) {
+            aSlot.iBusy = true;
+            return true;
+        }
+        if (aSlot.iBusy) {
+            aSlot.iBusy = false;
+            iSemConsumer.Signal(); // Reset() may be waiting on this
+        }
+        iLock.Signal();
+        aSlot.iSem.Wait();
+        iLock.Wait();
+    }
+}
+
+void SegmentPrefetcher::Stream(Slot& aSlot, IReader& aReader)
+{
+    Slot::EState state = Slot::eComplete;
+    try {
+        for (;;) {
+            TUint space = 0;
+            {
+                AutoMutex _(iLock);
+                for (;;) {
+                    if (iInterrupted || !iActive || aSlot.iAbandoned) {
+                        THROW(ReaderError);
+                    }
+                    space = aSlot.Space();
+                    if (space > 0) {
+                        break;
+                    }
+                    iLock.Signal();
+                    aSlot.iSem.Wait();
+                    iLock.Wait();
+                }
+            }
+            Brn buf = aReader.Read(space < kMaxReadBytes? space : kMaxReadBytes);
+            if (buf.Bytes() == 0) {
+                break;
+            }
+            AutoMutex _(iLock);
+            aSlot.Append(buf);
+            iSemConsumer.Signal();
+        }
+    }
+    catch (const ReaderError&) {
+        LOG(kMedia, "SegmentPrefetcher::Stream caught ReaderError\n");
+        state = Slot::eStreamError;
+    }
+    AutoMutex _(iLock);
+    if (aSlot.iAbandoned) {
+        // Reader moved on before this segment was fully fetched. Slot can now be reused.
+        aSlot.Clear();
+        if (!iInterrupted) {
+            aSlot.iLoader.Interrupt(false);
+        }
+        return;
+    }
+    aSlot.iState = state;
+    iSemConsumer.Signal();
+}
+
+Brn SegmentPrefetcher::ReadSlot(Slot& aSlot, TUint aBytes)
+{
+    AutoMutex _(iLock);
+    if (aSlot.iInUse > 0) {
+        // Caller has finished with buffer returned from previous Read().
+        aSlot.iInUse = 0;
+        aSlot.iSem.Signal();
+    }
+    for (;;) {
+        if (iInterrupted) {
+            THROW(ReaderError);
+        }
+        if (aSlot.iCount > 0) {
+            return aSlot.Take(aBytes);
+        }
+        if (aSlot.iState == Slot::eComplete) {
+            return Brx::Empty();
+        }
+        if (aSlot.iState == Slot::eStreamError) {
+            THROW(ReaderError);
+        }
+        iLock.Signal();
+        iSemConsumer.Wait();
+        iLock.Wait();
+    }
+}
+
+SegmentPrefetcher::Slot* SegmentPrefetcher::FindSlotLocked(TUint64 aSeq) const
+{
+    for (auto slot : iSlots) {
+        if (slot->iState != Slot::eIdle && slot->iSeq == aSeq) {
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+void SegmentPrefetcher::ReleaseLocked(Slot& aSlot)
+{
+    // Fetching thread may still be streaming if the reader abandoned this segment early.
+    // Leave it to finish (or fail) before the slot is reused.
+    if (aSlot.iState == Slot::eStreaming) {
+        aSlot.iAbandoned = true;
+        aSlot.iLoader.Interrupt(true);
+        aSlot.iCount = aSlot.iInUse = 0;
+        aSlot.iSem.Signal();
+        return;
+    }
+    aSlot.Clear();
+    aSlot.iSem.Signal();
+}
+
+void SegmentPrefetcher::SignalAllLocked()
+{
+    for (auto slot : iSlots) {
+        slot->iSem.Signal();
+    }
+    iSemConsumer.Signal();
+}
+
+TBool SegmentPrefetcher::CanFetchLocked() const
+{
+    return iActive && !iInterrupted && !iUrisExhausted && !iQuit;
+}
+
+
 // SegmentProvider
 
-SegmentProvider::SegmentProvider(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, ITimerFactory& aTimerFactory, ISegmentUriProvider& aProvider)
+SegmentProvider::SegmentProvider(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, ITimerFactory& aTimerFactory, ISegmentUriProvider& aProvider, TUint aLookahead)
     : iLoader(aEnv, aSsl, aUserAgent, aTimerFactory, kConnectRetryIntervalMs)
     , iProvider(aProvider)
+    , iPrefetcher(nullptr)
+{
+    if (aLookahead > 0) {
+        for (TUint i=0; i<aLookahead; i++) {
+            iPrefetchLoaders.push_back(new UriLoader(aEnv, aSsl, aUserAgent, aTimerFactory, kConnectRetryIntervalMs));
+        }
+        iPrefetcher = new SegmentPrefetcher(aProvider, iPrefetchLoaders, kSegmentBufferBytes);
+    }
+}
+
+SegmentProvider::~SegmentProvider()
 {
+    delete iPrefetcher;
+    for (auto loader : iPrefetchLoaders) {
+        delete loader;
+    }
 }
 
 void SegmentProvider::Reset()
 {
+    if (iPrefetcher != nullptr) {
+        iPrefetcher->Reset();
+    }
     iLoader.Reset();
 }
 
+TUint SegmentProvider::SegmentsDiscarded() const
+{
+    if (iPrefetcher != nullptr) {
+        return iPrefetcher->SegmentsDiscarded();
+    }
+    return 0;
+}
+
 IReader& SegmentProvider::NextSegment()
 {
+    if (iPrefetcher != nullptr) {
+        return iPrefetcher->NextSegment();
+    }
     try {
         Uri uri;
         iProvider.NextSegmentUri(uri);
@@ -433,6 +916,9 @@ IReader& SegmentProvider::NextSegment()
 
 void SegmentProvider::InterruptSegmentProvider(TBool aInterrupt)
 {
+    if (iPrefetcher != nullptr) {
+        iPrefetcher->InterruptSegmentProvider(aInterrupt);
+    }
     iLoader.Interrupt(aInterrupt);
 }
 
@@ -1056,7 +1542,7 @@ const Brn ProtocolHls::kSchemeHlsSecure("hlss");
 const Brn ProtocolHls::kSchemeHttp("http");
 const Brn ProtocolHls::kSchemeHttps("https");
 
-ProtocolHls::ProtocolHls(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent)
+ProtocolHls::ProtocolHls(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, TUint aSegmentLookahead)
     : Protocol(aEnv)
     , iTimerFactory(aEnv)
     , iSupply(nullptr)
@@ -1064,7 +1550,7 @@ ProtocolHls::ProtocolHls(Environment& aEnv, SslContext& aSsl, const Brx& aUserAg
     , iPlaylistProvider(aEnv, aSsl, aUserAgent, iTimerFactory)
     , iReloadTimer(aEnv, iTimerFactory)
     , iM3uReader(iPlaylistProvider, iReloadTimer)
-    , iSegmentProvider(aEnv, aSsl, aUserAgent, iTimerFactory, iM3uReader)
+    , iSegmentProvider(aEnv, aSsl, aUserAgent, iTimerFactory, iM3uReader, aSegmentLookahead)
     , iSegmentStreamer(iSegmentProvider)
     , iSem("PRTH", 0)
     , iLock("PRHL")
@@ -1254,7 +1740,8 @@ ProtocolStreamResult ProtocolHls::Stream(const Brx& aUri)
             iSegmentProvider.Reset();
             iSegmentStreamer.Reset();
             iPlaylistProvider.Reset();
-            const auto lastSegment = iM3uReader.LastSegment();
+            // Segments that were prefetched but never played are retried rather than skipped.
+            const auto lastSegment = iM3uReader.LastSegment() - iSegmentProvider.SegmentsDiscarded();
             iM3uReader.Reset();
 
             // There is no flush pending, and iStreamId has been cleared (so no
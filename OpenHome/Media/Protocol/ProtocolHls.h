@@ -7,8 +7,10 @@
 #include <OpenHome/Private/Uri.h>
 #include <OpenHome/Media/Supply.h>
 #include <OpenHome/SocketHttp.h>
+#include <OpenHome/Private/Thread.h>
 
 #include <algorithm>
+#include <vector>
 
 EXCEPTION(UriLoaderError);
 
@@ -120,14 +122,24 @@ private:
     TBool iEnabled;
 };
 
-class UriLoader
+class IUriLoader
+{
+public:
+    virtual IReader& Load(const Uri& aUri) = 0; // THROWS UriLoaderError
+    virtual void Reset() = 0;
+    virtual void Interrupt(TBool aInterrupt) = 0;
+    virtual ~IUriLoader() {}
+};
+
+class UriLoader : public IUriLoader
 {
 public:
     UriLoader(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, ITimerFactory& aTimerFactory, TUint aRetryInterval);
     ~UriLoader();
-    IReader& Load(const Uri& aUri); // THROWS UriLoaderError
-    void Reset();
-    void Interrupt(TBool aInterrupt);
+public: // from IUriLoader
+    IReader& Load(const Uri& aUri) override;
+    void Reset() override;
+    void Interrupt(TBool aInterrupt) override;
 private:
     SocketHttp iSocket;
     const TUint iRetryInterval;
@@ -156,19 +168,135 @@ private:
     Uri iUri;
 };
 
+/*
+ * Fetches up to N upcoming segments concurrently (N being the number of
+ * loaders passed in) so that connecting to, and waiting for the first byte
+ * of, the next segment overlaps reading of the current one.
+ *
+ * Segment URIs are requested from ISegmentUriProvider one at a time, so
+ * segment ordering and discontinuity handling are exactly those of the
+ * provider. NextSegment() returns segments in that same order.
+ *
+ * Each in-flight segment is held in a ring buffer of aBufferBytes. Segments
+ * larger than this stream through the buffer, with the fetching thread
+ * blocking until the reader frees space.
+ *
+ * Fetching starts on the first call to NextSegment() following construction
+ * or Reset().
+ */
+class SegmentPrefetcher : public ISegmentProvider
+{
+    static const TUint kMaxReadBytes = 4 * 1024;
+public:
+    SegmentPrefetcher(ISegmentUriProvider& aProvider, const std::vector<IUriLoader*>& aLoaders, TUint aBufferBytes);
+    ~SegmentPrefetcher();
+    /*
+     * Discards any prefetched segments and returns all fetching threads to an idle state.
+     *
+     * Must not be called concurrently with NextSegment() or a Read() on the segment it returned.
+     */
+    void Reset();
+    /*
+     * Number of segments whose URIs were taken from the ISegmentUriProvider
+     * but which had not been returned from NextSegment() at the time of the
+     * last Reset() call.
+     */
+    TUint SegmentsDiscarded() const;
+public: // from ISegmentProvider
+    IReader& NextSegment() override;
+    void InterruptSegmentProvider(TBool aInterrupt) override;
+private:
+    class Slot : public IReader
+    {
+    public:
+        enum EState
+        {
+            eIdle,
+            eLoading,
+            eStreaming,
+            eComplete,
+            eLoadError,
+            eStreamError,
+            eUriError,
+            eEndOfStream
+        };
+    public:
+        Slot(SegmentPrefetcher& aParent, IUriLoader& aLoader, TUint aBufferBytes);
+        void Clear();
+        TUint Space() const;
+        void Append(const Brx& aData);
+        Brn Take(TUint aBytes);
+        TBool HoldsUri() const;
+        void Run();
+    public: // from IReader
+        Brn Read(TUint aBytes) override;
+        void ReadFlush() override;
+        void ReadInterrupt() override;
+    public:
+        SegmentPrefetcher& iParent;
+        IUriLoader& iLoader;
+        Semaphore iSem;
+        Bwh iBuf;
+        TUint iHead;    // first unread byte
+        TUint iCount;   // unread bytes
+        TUint iInUse;   // bytes preceding iHead still referenced by the last Read()
+        EState iState;
+        TUint64 iSeq;
+        TBool iBusy;
+        TBool iAbandoned;
+    };
+private:
+    void FetchLoop(Slot& aSlot);
+    TBool WaitForWork(Slot& aSlot);
+    void Stream(Slot& aSlot, IReader& aReader);
+    Brn ReadSlot(Slot& aSlot, TUint aBytes);
+    Slot* FindSlotLocked(TUint64 aSeq) const;
+    void ReleaseLocked(Slot& aSlot);
+    void SignalAllLocked();
+    TBool CanFetchLocked() const;
+private:
+    ISegmentUriProvider& iProvider;
+    std::vector<Slot*> iSlots;
+    std::vector<ThreadFunctor*> iThreads;
+    mutable Mutex iLock;
+    Mutex iLockUri; // serialises calls to iProvider.NextSegmentUri()
+    Semaphore iSemConsumer;
+    Slot* iCurrent;
+    TUint64 iNextUriSeq;
+    TUint64 iNextReadSeq;
+    TUint iSegmentsDiscarded;
+    TBool iActive;
+    TBool iInterrupted;
+    TBool iUrisExhausted;
+    TBool iFetchingUri;
+    TBool iQuit;
+};
+
 class SegmentProvider : public ISegmentProvider
 {
 private:
     static const TUint kConnectRetryIntervalMs = 1 * 1000;
+    static const TUint kSegmentBufferBytes = 128 * 1024;
 public:
-    SegmentProvider(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, ITimerFactory& aTimerFactory, ISegmentUriProvider& aProvider);
+    /*
+     * aLookahead of 0 fetches each segment only when it is requested.
+     * Otherwise, up to aLookahead segments are fetched in parallel ahead of being requested.
+     */
+    SegmentProvider(Environment& aEnv, SslContext& aSsl, const Brx& aUserAgent, ITimerFactory& aTimerFactory, ISegmentUriProvider& aProvider, TUint aLookahead);
+    ~SegmentProvider();
     void Reset();
+    /*
+     * See SegmentPrefetcher::SegmentsDiscarded().  Always 0 if aLookahead was 0.
+     */
+    TUint SegmentsDiscarded() const;
 public: // from ISegmentProvider
     IReader& NextSegment() override;
     void InterruptSegmentProvider(TBool aInterrupt) override;
 private:
     UriLoader iLoader;
     ISegmentUriProvider& iProvider;
+    std::vector<IUriLoader*> iPrefetchLoaders;
+    SegmentPrefetcher* iPrefetcher;
 };
 
 class SegmentDescriptor
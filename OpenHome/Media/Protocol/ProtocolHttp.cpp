@@ -7,6 +7,7 @@
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Private/Network.h>
 #include <OpenHome/SocketSsl.h>
+#include <OpenHome/SocketHttp.h>
 #include <OpenHome/Private/Uri.h>
 #include <OpenHome/Media/Debug.h>
 #include <OpenHome/Private/Parser.h>
@@ -36,6 +37,29 @@ private:
     std::vector<IServerObserver*> iServerObservers;
 };
 
+// Counts response body bytes so that ProtocolHttp can tell whether a response
+// has been fully consumed and its connection can be kept alive.
+// Once a limit (the response's Content-Length) is set, reads beyond it throw
+// ReaderError.  Kept-alive connections aren't closed by the server at the end
+// of a response so this is how readers that consume until ReaderError (e.g.
+// playlist content processors) see the end of the body.
+class ReaderBodyCounter : public IReader
+{
+public:
+    ReaderBodyCounter(IReader& aReader);
+    void Reset();
+    void SetLimit(TUint64 aBytes);
+    TUint64 Bytes() const;
+private: // from IReader
+    Brn Read(TUint aBytes) override;
+    void ReadFlush() override;
+    void ReadInterrupt() override;
+private:
+    IReader& iReader;
+    TUint64 iBytes;
+    TUint64 iLimit; // 0 => unlimited
+};
+
 class ProtocolHttp : public Protocol , private IReader , private IIcyObserver
 {
     static const Brn kSchemeHttp;
@@ -69,6 +93,8 @@ private:
     TBool Connect(const Uri& aUri);
     TInt PortFromUri(const Uri& aUri) const;
     void Close();
+    TBool ResponseComplete() const;
+    void ResetBodyCounter();
     void Reinitialise(const Brx& aUri);
     ProtocolStreamResult DoStream();
     ProtocolGetResult DoGet(IWriter& aWriter, TUint64 aOffset, TUint aBytes);
@@ -88,6 +114,7 @@ private:
     WriterHttpRequest iWriterRequest;
     ReaderUntilS<2048> iReaderUntil;
     ReaderHttpResponse iReaderResponse;
+    ReaderBodyCounter iBodyCounter;
     ReaderHttpChunked iDechunker;
     ContentRecogBuf iContentRecogBuf;
     ReaderIcy* iReaderIcy;
@@ -95,6 +122,7 @@ private:
     HttpHeaderContentLength iHeaderContentLength;
     HttpHeaderLocation iHeaderLocation;
     HttpHeaderTransferEncoding iHeaderTransferEncoding;
+    SocketHttpHeaderConnection iHeaderConnection;
     HeaderIcyMetadata iHeaderIcyMetadata;
     HeaderServer iHeaderServer;
     Bws<kMaxUserAgentBytes> iUserAgent;
@@ -109,6 +137,7 @@ private:
     TBool iStarted;
     TBool iStopped;
     TBool iReadSuccess;
+    TBool iResponseValid;
     TUint64 iSeekPos;
     TUint64 iOffset;
     ContentProcessor* iContentProcessor;
@@ -195,6 +224,58 @@ void HeaderServer::RemoveServerObserver(IServerObserver& aObserver)
 }
 
 
+// ReaderBodyCounter
+
+ReaderBodyCounter::ReaderBodyCounter(IReader& aReader)
+    : iReader(aReader)
+    , iBytes(0)
+    , iLimit(0)
+{
+}
+
+void ReaderBodyCounter::Reset()
+{
+    iBytes = 0;
+    iLimit = 0;
+}
+
+void ReaderBodyCounter::SetLimit(TUint64 aBytes)
+{
+    iLimit = aBytes;
+}
+
+TUint64 ReaderBodyCounter::Bytes() const
+{
+    return iBytes;
+}
+
+Brn ReaderBodyCounter::Read(TUint aBytes)
+{
+    if (iLimit > 0) {
+        if (iBytes >= iLimit) {
+            THROW(ReaderError);
+        }
+        const TUint64 remaining = iLimit - iBytes;
+        if (aBytes > remaining) {
+            aBytes = static_cast<TUint>(remaining);
+        }
+    }
+    Brn buf = iReader.Read(aBytes);
+    iBytes += buf.Bytes();
+    return buf;
+}
+
+void ReaderBodyCounter::ReadFlush()
+{
+    iReader.ReadFlush();
+}
+
+void ReaderBodyCounter::ReadInterrupt()
+{
+    iReader.ReadInterrupt();
+}
+
+
 // ProtocolHttp
 
 const Brn ProtocolHttp::kSchemeHttp("http");
@@ -216,13 +297,15 @@ ProtocolHttp::ProtocolHttp(Environment& aEnv, SslContext& aSsl, const Brx& aUser
     , iWriterRequest(iWriterBuf)
     , iReaderUntil(iReaderBuf)
     , iReaderResponse(aEnv, iReaderUntil)
-    , iDechunker(iReaderUntil)
+    , iBodyCounter(iReaderUntil)
+    , iDechunker(iBodyCounter)
     , iContentRecogBuf(iDechunker)
     , iUserAgent(aUserAgent)
     , iTotalStreamBytes(0)
     , iTotalBytes(0)
     , iStreamId(IPipelineIdProvider::kStreamIdInvalid)
     , iSeekable(false)
+    , iResponseValid(false)
     , iSem("PRTH", 0)
     , iServerObserver(aServerObserver)
 {
@@ -233,6 +316,7 @@ ProtocolHttp::ProtocolHttp(Environment& aEnv, SslContext& aSsl, const Brx& aUser
     iReaderResponse.AddHeader(iHeaderContentLength);
     iReaderResponse.AddHeader(iHeaderLocation);
     iReaderResponse.AddHeader(iHeaderTransferEncoding);
+    iReaderResponse.AddHeader(iHeaderConnection);
     iReaderResponse.AddHeader(iHeaderIcyMetadata);
     iReaderResponse.AddHeader(iHeaderServer);
     if (iServerObserver.Ok()) {
@@ -512,7 +596,39 @@ TInt ProtocolHttp::PortFromUri(const Uri& aUri) const
 
 void ProtocolHttp::Close()
 {
-    iSocket.Close();
+    if (ResponseComplete()) {
+        iSocket.CloseKeepAlive();
+    }
+    else {
+        iSocket.Close();
+    }
+    iResponseValid = false;
+}
+
+TBool ProtocolHttp::ResponseComplete() const
+{
+    // Only reuse connections where we know the body has been consumed in full.
+    // Chunked and unbounded (live) responses are always closed.
+    if (!iResponseValid || iHeaderConnection.Close()) {
+        return false;
+    }
+    if (iReaderResponse.Version() != Http::eHttp11 && !iHeaderConnection.KeepAlive()) {
+        return false;
+    }
+    if (iHeaderTransferEncoding.IsChunked()) {
+        return false;
+    }
+    const TUint64 contentLength = iHeaderContentLength.ContentLength();
+    return contentLength > 0 && iBodyCounter.Bytes() == contentLength;
+}
+
+void ProtocolHttp::ResetBodyCounter()
+{
+    iBodyCounter.Reset();
+    const TUint64 contentLength = iHeaderContentLength.ContentLength();
+    if (!iHeaderTransferEncoding.IsChunked() && contentLength > 0) {
+        iBodyCounter.SetLimit(contentLength);
+    }
 }
 
 void ProtocolHttp::Reinitialise(const Brx& aUri)
@@ -581,28 +697,46 @@ ProtocolStreamResult ProtocolHttp::DoStream()
 
 ProtocolGetResult ProtocolHttp::DoGet(IWriter& aWriter, TUint64 aOffset, TUint aBytes)
 {
-    try {
-        LOG(kMedia, "ProtocolHttp::DoGet send request\n");
-        iWriterRequest.WriteMethod(Http::kMethodGet, iUri.PathAndQuery(), Http::eHttp11);
-        const TUint port = PortFromUri(iUri);
-        Http::WriteHeaderHostAndPort(iWriterRequest, iUri.Host(), port);
-        Http::WriteHeaderConnectionClose(iWriterRequest);
-        TUint64 last = aOffset+aBytes;
-        if (last > 0) {
-            last -= 1;  // need to adjust for last byte position as request
-                        // requires absolute positions, rather than range
-        }
-        Http::WriteHeaderRange(iWriterRequest, aOffset, last);
-        iWriterRequest.WriteFlush();
-    }
-    catch(WriterError&) {
-        LOG(kMedia, "ProtocolHttp::DoGet WriterError\n");
-        return EProtocolGetErrorUnrecoverable;
+    for (;;) {
+        try {
+            LOG(kMedia, "ProtocolHttp::DoGet send request\n");
+            iWriterRequest.WriteMethod(Http::kMethodGet, iUri.PathAndQuery(), Http::eHttp11);
+            const TUint port = PortFromUri(iUri);
+            Http::WriteHeaderHostAndPort(iWriterRequest, iUri.Host(), port);
+            TUint64 last = aOffset+aBytes;
+            if (last > 0) {
+                last -= 1;  // need to adjust for last byte position as request
+                            // requires absolute positions, rather than range
+            }
+            Http::WriteHeaderRange(iWriterRequest, aOffset, last);
+            iWriterRequest.WriteFlush();
+            LOG(kMedia, "ProtocolHttp::DoGet read response\n");
+            iReaderResponse.Read();
+            break;
+        }
+        catch(WriterError&) {
+            LOG(kMedia, "ProtocolHttp::DoGet WriterError\n");
+        }
+        catch(HttpError&) {
+            LOG(kMedia, "ProtocolHttp::DoGet HttpError\n");
+        }
+        catch(ReaderError&) {
+            LOG(kMedia, "ProtocolHttp::DoGet ReaderError\n");
+        }
+        // A pooled connection may have been dropped by the server while idle.  Retry on a new one.
+        if (!iSocket.IsReused()) {
+            return EProtocolGetErrorUnrecoverable;
+        }
+        Close();
+        iContentRecogBuf.ReadFlush();
+        if (!Connect(iUri)) {
+            return EProtocolGetErrorUnrecoverable;
+        }
     }
+    iResponseValid = true;
+    ResetBodyCounter();
 
     try {
-        LOG(kMedia, "ProtocolHttp::DoGet read response\n");
-        iReaderResponse.Read();
 
         const TUint code = iReaderResponse.Status().Code();
         iTotalBytes = iHeaderContentLength.ContentLength();
@@ -690,11 +824,6 @@ TUint ProtocolHttp::WriteRequest(TUint64 aOffset)
 {
     iContentRecogBuf.ReadFlush();
     //iSocket.LogVerbose(true);
-    Close();
-    if (!Connect(iUri)) {
-        LOG(kMedia, "ProtocolHttp::WriteRequest Connection failure\n");
-        return 0;
-    }
 
     /* GETting ASX for BBC Scotland responds with invalid chunking if we request ICY metadata.
        Suppress this header if we're requesting a resource with an extension that matches
@@ -716,41 +845,59 @@ TUint ProtocolHttp::WriteRequest(TUint64 aOffset)
         Ascii::CaseInsensitiveEquals(ext, Brn(".opml"))) {
         nonAudioUri = true;
     }
-    try {
-        LOG(kMedia, "ProtocolHttp::WriteRequest send request\n");
-        iWriterRequest.WriteMethod(Http::kMethodGet, iUri.PathAndQuery(), Http::eHttp11);
-        const TInt port = PortFromUri(iUri);
-        Http::WriteHeaderHostAndPort(iWriterRequest, iUri.Host(), port);
-        if (iUserAgent.Bytes() > 0) {
-            iWriterRequest.WriteHeader(Http::kHeaderUserAgent, iUserAgent);
+
+    for (;;) { // loops only if a connection taken from the pool turns out to have been closed by the server
+        Close();
+        if (!Connect(iUri)) {
+            LOG(kMedia, "ProtocolHttp::WriteRequest Connection failure\n");
+            return 0;
         }
-        Http::WriteHeaderConnectionClose(iWriterRequest);
-        if (!nonAudioUri) {
-            // Suppress ICY metadata and Range header for resources such as playlist files.
-            HeaderIcyMetadata::Write(iWriterRequest);
-            Http::WriteHeaderRangeFirstOnly(iWriterRequest, aOffset);
+
+        try {
+            LOG(kMedia, "ProtocolHttp::WriteRequest send request\n");
+            iWriterRequest.WriteMethod(Http::kMethodGet, iUri.PathAndQuery(), Http::eHttp11);
+            const TInt port = PortFromUri(iUri);
+            Http::WriteHeaderHostAndPort(iWriterRequest, iUri.Host(), port);
+            if (iUserAgent.Bytes() > 0) {
+                iWriterRequest.WriteHeader(Http::kHeaderUserAgent, iUserAgent);
+            }
+            if (!nonAudioUri) {
+                // Suppress ICY metadata and Range header for resources such as playlist files.
+                HeaderIcyMetadata::Write(iWriterRequest);
+                Http::WriteHeaderRangeFirstOnly(iWriterRequest, aOffset);
+            }
+            iWriterRequest.WriteFlush();
+        }
+        catch(WriterError&) {
+            LOG(kMedia, "ProtocolHttp::WriteRequest writer error\n");
+            if (iSocket.IsReused() && !iStopped) {
+                continue;
+            }
+            return 0;
         }
-        iWriterRequest.WriteFlush();
-    }
-    catch(WriterError&) {
-        LOG(kMedia, "ProtocolHttp::WriteRequest writer error\n");
-        return 0;
-    }
 
-    try {
-        LOG(kMedia, "ProtocolHttp::WriteRequest read response\n");
-        //iSocket.LogVerbose(true);
-        iReaderResponse.Read();
-        //iSocket.LogVerbose(false);
-    }
-    catch(HttpError&) {
-        LOG(kMedia, "ProtocolHttp::WriteRequest http error\n");
-        return 0;
-    }
-    catch(ReaderError&) {
-        LOG(kMedia, "ProtocolHttp::WriteRequest reader error\n");
-        return 0;
+        try {
+            LOG(kMedia, "ProtocolHttp::WriteRequest read response\n");
+            //iSocket.LogVerbose(true);
+            iReaderResponse.Read();
+            //iSocket.LogVerbose(false);
+        }
+        catch(HttpError&) {
+            LOG(kMedia, "ProtocolHttp::WriteRequest http error\n");
+            return 0;
+        }
+        catch(ReaderError&) {
+            LOG(kMedia, "ProtocolHttp::WriteRequest reader error\n");
+            if (iSocket.IsReused() && !iStopped) {
+                iContentRecogBuf.ReadFlush();
+                continue;
+            }
+            return 0;
+        }
+        break;
     }
+    iResponseValid = true;
+    ResetBodyCounter();
     const TUint code = iReaderResponse.Status().Code();
     LOG(kMedia, "ProtocolHttp::WriteRequest response code %d\n", code);
     return code;
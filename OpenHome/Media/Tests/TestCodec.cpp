@@ -22,6 +22,7 @@
 #include <OpenHome/Media/Utils/AllocatorInfoLogger.h>
 #include <OpenHome/Private/SuiteUnitTest.h>
 
+#include <algorithm>
 #include <vector>
 
 using namespace OpenHome;
@@ -997,6 +998,11 @@ void SuiteCodecZeroCrossings::TestZeroCrossings()
     Log::Print("TestCodec ");
     Log::Print(filename);
     Log::Print(" start: %ums, end: %ums, duration: %us (%ums)\n", timeStart, timeEnd, (timeEnd-timeStart)/1000, timeEnd-timeStart);
+    // decode rate, in MB/s of packed pcm output, for comparing codec changes
+    const TUint64 decodedBytes = (Jiffies::ToSamples(iJiffies, iSampleRate) * iChannels * iBitDepth) / 8;
+    const TUint durationMs = std::max(timeEnd - timeStart, 1u);
+    Log::Print(" decoded: %llu bytes, rate: %u.%02u MB/s\n", decodedBytes,
+               (TUint)(decodedBytes / (durationMs * 1000)), (TUint)((decodedBytes / (durationMs * 10)) % 100));
 
     Log::Print("iJiffies: %llu, track jiffies: %llu\n", iJiffies, jiffies);
     TEST(iJiffies == jiffies);
@@ -11,6 +11,7 @@
 #include <OpenHome/Media/MimeTypeList.h>
 
 #include <list>
+#include <vector>
 #include <limits.h>
 
 using namespace OpenHome;
@@ -27,6 +28,7 @@ private:
     static const TChar* kId;
 public:
     TestCodecControllerDummyCodec(TUint aReadBufBytes);
+    TestCodecControllerDummyCodec(TUint aReadBufBytes, const TChar* aId, RecognitionComplexity aRecognitionCost);
     void SetStreamInfo(TUint aReadBytes, TUint aChannels, TUint aSampleRate, TUint aBitDepth, AudioDataEndian aEndianness, const SpeakerProfile& aProfile);
 public: // from CodecBase
     TBool Recognise(const EncodedStreamInfo& aStreamInfo) override;
@@ -204,6 +206,70 @@ private:
     TestCodecControllerDummyCodec* iCodec;
 };
 
+class TestCodecControllerDummyCodecPlanar : public TestCodecControllerDummyCodec
+{
+    static const TUint kMaxChannels = 2;
+public:
+    TestCodecControllerDummyCodecPlanar(TUint aReadBufBytes);
+public: // from TestCodecControllerDummyCodec
+    void Process() override;
+private:
+    std::vector<TInt32> iPlanes[kMaxChannels];
+};
+
+class SuiteCodecControllerPlanar : public SuiteCodecControllerBase
+{
+private:
+    static const TUint kBitsPerSample = 16;
+    static const TUint kSamplesPerMsg = 1024; // spans several DecodedAudio
+    static const TUint kAudioBytesPerMsg = 2*2*kSamplesPerMsg; // 16 bits (2 bytes) * 2 channels * kSamplesPerMsg
+public:
+    SuiteCodecControllerPlanar();
+private: // // from SuiteCodecControllerBase
+    void Setup() override;
+    void TearDown() override;
+private:
+    Msg* CreateAudio();
+    void TestPlanarOutput();
+private:
+    TestCodecControllerDummyCodecPlanar* iCodec;
+};
+
+class TestCodecControllerDummyCodecSignature : public TestCodecControllerDummyCodec
+{
+public:
+    static const TUint kSignatureBytes = 4;
+public:
+    TestCodecControllerDummyCodecSignature(TUint aReadBufBytes, const TChar* aId, RecognitionComplexity aRecognitionCost);
+    TUint RecogniseCount() const;
+public: // from TestCodecControllerDummyCodec
+    TBool Recognise(const EncodedStreamInfo& aStreamInfo) override;
+    RecognitionHint Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const override;
+    void StreamInitialise() override;
+private:
+    TUint iRecogniseCount;
+};
+
+class SuiteCodecControllerRecognitionOrder : public SuiteCodecControllerBase
+{
+private:
+    static const TUint kBitsPerSample = 16;
+    static const TUint kAudioBytes = 1024;
+public:
+    SuiteCodecControllerRecognitionOrder();
+private: // // from SuiteCodecControllerBase
+    void Setup() override;
+    void TearDown() override;
+private:
+    Msg* CreateAudio(const TChar* aSignature);
+    void PlayStream(const TChar* aSignature);
+    void TestLikelyCodecTriedFirst();
+    void TestUnrecognisedSignatureFallsBack();
+private:
+    TestCodecControllerDummyCodecSignature* iCodecCheap;
+    TestCodecControllerDummyCodecSignature* iCodecExpensive;
+};
+
 class TestCodecControllerDummyCodecStreamInitialise : public TestCodecControllerDummyCodec
 {
 public:
@@ -1176,7 +1242,12 @@ void SuiteCodecControllerPcmSize::TestPcmIsExpectedSize()
 const TChar* TestCodecControllerDummyCodec::kId("DUMC");
 
 TestCodecControllerDummyCodec::TestCodecControllerDummyCodec(TUint aReadBufBytes)
-    : CodecBase(kId, CodecBase::RecognitionComplexity::kCostLow)
+    : TestCodecControllerDummyCodec(aReadBufBytes, kId, CodecBase::RecognitionComplexity::kCostLow)
+{
+}
+
+TestCodecControllerDummyCodec::TestCodecControllerDummyCodec(TUint aReadBufBytes, const TChar* aId, RecognitionComplexity aRecognitionCost)
+    : CodecBase(aId, aRecognitionCost)
     , iReadBuf(aReadBufBytes)
     , iReadBytes(0)
     , iChannels(0)
@@ -1244,6 +1315,237 @@ void TestCodecControllerDummyCodec::StreamCompleted()
 }
 
 
+// TestCodecControllerDummyCodecPlanar
+
+TestCodecControllerDummyCodecPlanar::TestCodecControllerDummyCodecPlanar(TUint aReadBufBytes)
+    : TestCodecControllerDummyCodec(aReadBufBytes)
+{
+}
+
+void TestCodecControllerDummyCodecPlanar::Process()
+{
+    ASSERT(iChannels <= kMaxChannels);
+    ASSERT(iBitDepth == 16);
+    ASSERT(iEndianness == AudioDataEndian::Big);
+    iReadBuf.SetBytes(0);
+    iController->Read(iReadBuf, iReadBytes);
+    if (iReadBuf.Bytes() < iReadBytes) {
+        THROW(CodecStreamEnded);
+    }
+
+    // de-interleave into per-channel buffers, as a planar decoder would produce
+    const TUint samples = iReadBuf.Bytes() / (2 * iChannels);
+    const TByte* p = iReadBuf.Ptr();
+    const TInt32* planes[kMaxChannels];
+    for (TUint j=0; j<iChannels; j++) {
+        iPlanes[j].resize(samples);
+        planes[j] = iPlanes[j].data();
+    }
+    for (TUint i=0; i<samples; i++) {
+        for (TUint j=0; j<iChannels; j++) {
+            iPlanes[j][i] = (TInt16)((p[0] << 8) | p[1]);
+            p += 2;
+        }
+    }
+    iTrackOffset += iController->OutputAudioPcmPlanar(planes, samples, iChannels, iSampleRate, iBitDepth, iTrackOffset);
+}
+
+
+// SuiteCodecControllerPlanar
+
+SuiteCodecControllerPlanar::SuiteCodecControllerPlanar()
+    : SuiteCodecControllerBase("SuiteCodecControllerPlanar")
+{
+    AddTest(MakeFunctor(*this, &SuiteCodecControllerPlanar::TestPlanarOutput), "TestPlanarOutput");
+}
+
+void SuiteCodecControllerPlanar::Setup()
+{
+    SuiteCodecControllerBase::Setup();
+    iCodec = new TestCodecControllerDummyCodecPlanar(kAudioBytesPerMsg);
+    iController->AddCodec(iCodec);  // Takes ownership.
+    iController->Start();
+}
+
+void SuiteCodecControllerPlanar::TearDown()
+{
+    SuiteCodecControllerBase::TearDown();
+}
+
+Msg* SuiteCodecControllerPlanar::CreateAudio()
+{
+    static const TUint kBytesPerSample = kBitsPerSample/8;
+    TByte encodedAudioData[kAudioBytesPerMsg];
+    (void)memset(encodedAudioData, 0x7f, kAudioBytesPerMsg);
+    Brn encodedAudioBuf(encodedAudioData, kAudioBytesPerMsg);
+    MsgAudioEncoded* audio = iMsgFactory->CreateMsgAudioEncoded(encodedAudioBuf);
+
+    TUint samples = kAudioBytesPerMsg / (kNumChannels*kBytesPerSample);
+    TUint jiffiesPerSample = Jiffies::kPerSecond / kSampleRate;
+    iTrackOffset += samples * jiffiesPerSample;
+    iTrackOffsetBytes += kAudioBytesPerMsg;
+    return audio;
+}
+
+void SuiteCodecControllerPlanar::TestPlanarOutput()
+{
+    static const TUint kAudioBytes = 4 * kAudioBytesPerMsg;
+
+    iCodec->SetStreamInfo(kAudioBytesPerMsg, kNumChannels, kSampleRate, kBitsPerSample, AudioDataEndian::Big, kProfile);
+
+    Queue(CreateTrack());
+    PullNext(EMsgTrack);
+    Queue(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+
+    while (iTrackOffsetBytes < kAudioBytes) {
+        Queue(CreateAudio());
+    }
+    Queue(CreateEncodedStream());
+
+    // Each block of planar audio is split across as many MsgAudioPcm as needed
+    // to respect the controller's maximum msg duration.
+    PullNext(EMsgDecodedStream);
+    TUint msgs = 0;
+    while (iJiffies < iTrackOffset) {
+        PullNext(EMsgAudioPcm);
+        TEST(iMsgOffset < iTrackOffset);
+        msgs++;
+    }
+    TEST(msgs > kAudioBytes / kAudioBytesPerMsg);
+    TEST(iJiffies == iTrackOffset);
+
+    PullNext(EMsgEncodedStream);
+    PullNext(EMsgDecodedStream);
+}
+
+
+// TestCodecControllerDummyCodecSignature
+
+TestCodecControllerDummyCodecSignature::TestCodecControllerDummyCodecSignature(TUint aReadBufBytes, const TChar* aId, RecognitionComplexity aRecognitionCost)
+    : TestCodecControllerDummyCodec(aReadBufBytes, aId, aRecognitionCost)
+    , iRecogniseCount(0)
+{
+}
+
+TUint TestCodecControllerDummyCodecSignature::RecogniseCount() const
+{
+    return iRecogniseCount;
+}
+
+TBool TestCodecControllerDummyCodecSignature::Recognise(const EncodedStreamInfo& /*aStreamInfo*/)
+{
+    // Signature is this codec's id.
+    iRecogniseCount++;
+    Bws<kSignatureBytes> buf;
+    iController->Read(buf, buf.MaxBytes());
+    return buf == Brn(Id());
+}
+
+Codec::CodecBase::RecognitionHint TestCodecControllerDummyCodecSignature::Sniff(const Brx& aStreamStart, const EncodedStreamInfo& aStreamInfo) const
+{
+    return SniffSignature(aStreamStart, aStreamInfo, Id());
+}
+
+void TestCodecControllerDummyCodecSignature::StreamInitialise()
+{
+    Bws<kSignatureBytes> buf;
+    iController->Read(buf, buf.MaxBytes()); // skip signature
+    TestCodecControllerDummyCodec::StreamInitialise();
+}
+
+
+// SuiteCodecControllerRecognitionOrder
+
+SuiteCodecControllerRecognitionOrder::SuiteCodecControllerRecognitionOrder()
+    : SuiteCodecControllerBase("SuiteCodecControllerRecognitionOrder")
+{
+    AddTest(MakeFunctor(*this, &SuiteCodecControllerRecognitionOrder::TestLikelyCodecTriedFirst), "TestLikelyCodecTriedFirst");
+    AddTest(MakeFunctor(*this, &SuiteCodecControllerRecognitionOrder::TestUnrecognisedSignatureFallsBack), "TestUnrecognisedSignatureFallsBack");
+}
+
+void SuiteCodecControllerRecognitionOrder::Setup()
+{
+    SuiteCodecControllerBase::Setup();
+    iCodecCheap = new TestCodecControllerDummyCodecSignature(kAudioBytes, "CHEP", Codec::CodecBase::kCostVeryLow);
+    iCodecExpensive = new TestCodecControllerDummyCodecSignature(kAudioBytes, "EXPN", Codec::CodecBase::kCostHigh);
+    iCodecCheap->SetStreamInfo(kAudioBytes, kNumChannels, kSampleRate, kBitsPerSample, AudioDataEndian::Big, kProfile);
+    iCodecExpensive->SetStreamInfo(kAudioBytes, kNumChannels, kSampleRate, kBitsPerSample, AudioDataEndian::Big, kProfile);
+    iController->AddCodec(iCodecCheap);     // Takes ownership.
+    iController->AddCodec(iCodecExpensive); // Takes ownership.
+    iController->Start();
+}
+
+void SuiteCodecControllerRecognitionOrder::TearDown()
+{
+    SuiteCodecControllerBase::TearDown();
+}
+
+Msg* SuiteCodecControllerRecognitionOrder::CreateAudio(const TChar* aSignature)
+{
+    static const TUint kBytesPerSample = kBitsPerSample/8;
+    const TUint sigBytes = TestCodecControllerDummyCodecSignature::kSignatureBytes;
+    TByte encodedAudioData[sigBytes + kAudioBytes];
+    (void)memcpy(encodedAudioData, aSignature, sigBytes);
+    (void)memset(encodedAudioData + sigBytes, 0x7f, kAudioBytes);
+    Brn encodedAudioBuf(encodedAudioData, sizeof(encodedAudioData));
+    MsgAudioEncoded* audio = iMsgFactory->CreateMsgAudioEncoded(encodedAudioBuf);
+
+    TUint samples = kAudioBytes / (kNumChannels*kBytesPerSample);
+    TUint jiffiesPerSample = Jiffies::kPerSecond / kSampleRate;
+    iTrackOffset += samples * jiffiesPerSample;
+    return audio;
+}
+
+void SuiteCodecControllerRecognitionOrder::PlayStream(const TChar* aSignature)
+{
+    Queue(CreateTrack());
+    PullNext(EMsgTrack);
+    Queue(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+    Queue(CreateAudio(aSignature));
+
+    PullNext(EMsgDecodedStream);
+    while (iJiffies < iTrackOffset) {
+        PullNext(EMsgAudioPcm);
+    }
+    TEST(iJiffies == iTrackOffset);
+}
+
+void SuiteCodecControllerRecognitionOrder::TestLikelyCodecTriedFirst()
+{
+    // Expensive codec would normally be tried last; its signature should promote it.
+    PlayStream("EXPN");
+    TEST(iCodecCheap->RecogniseCount() == 0);
+    TEST(iCodecExpensive->RecogniseCount() == 1);
+
+    TUint streams, attempts, maxAttempts;
+    iController->GetRecognitionStats(streams, attempts, maxAttempts);
+    TEST(streams == 1);
+    TEST(attempts == 1);
+    TEST(maxAttempts == 1);
+}
+
+void SuiteCodecControllerRecognitionOrder::TestUnrecognisedSignatureFallsBack()
+{
+    // No codec claims this signature so both are tried (in cost order); neither recognises it.
+    Queue(CreateTrack());
+    PullNext(EMsgTrack);
+    Queue(CreateEncodedStream());
+    PullNext(EMsgEncodedStream);
+    Queue(CreateAudio("NONE"));
+    iSemStop->Wait();   // stream is stopped when recognition fails
+    TEST(iStopCount == 1);
+
+    TEST(iCodecCheap->RecogniseCount() == 1);
+    TEST(iCodecExpensive->RecogniseCount() == 1);
+    TUint streams, attempts, maxAttempts;
+    iController->GetRecognitionStats(streams, attempts, maxAttempts);
+    TEST(streams == 1);
+    TEST(attempts == 2);
+}
+
+
 // TestCodecControllerDummyCodecStreamInitialise
 
 TestCodecControllerDummyCodecStreamInitialise::TestCodecControllerDummyCodecStreamInitialise(TUint aReadBufBytes, Semaphore& aSemStreamInitPending, Semaphore& aSemStreamInitContinue)
@@ -1641,6 +1943,8 @@ void TestCodecController()
     Runner runner("CodecController tests\n");
     runner.Add(new SuiteCodecControllerStream());
     runner.Add(new SuiteCodecControllerPcmSize());
+    runner.Add(new SuiteCodecControllerPlanar());
+    runner.Add(new SuiteCodecControllerRecognitionOrder());
     runner.Add(new SuiteCodecControllerStopDuringStreamInit());
     runner.Add(new SuiteCodecControllerSeekInvalid());
     runner.Add(new SuiteCodecControllerUnexpectedFlush());
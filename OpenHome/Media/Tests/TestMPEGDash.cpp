@@ -6,6 +6,8 @@
 #include <OpenHome/Private/SuiteUnitTest.h>
 #include <OpenHome/Media/Protocol/MPEGDash.h>
 
+#include <vector>
+
 using namespace OpenHome;
 using namespace OpenHome::Media;
 using namespace OpenHome::TestFramework;
@@ -1283,6 +1285,326 @@ void SuiteMPDSegmentStream::TestSeeking()
 }
 
 
+// SuiteDashThroughputEstimator
+class SuiteDashThroughputEstimator : public Suite
+{
+public:
+    SuiteDashThroughputEstimator() : Suite("SuiteDashThroughputEstimator") {}
+
+private: // Suite
+    void Test() override;
+
+private:
+    void TestFirstSample();
+    void TestSmallSamplesIgnored();
+    void TestReactsQuicklyToDrop();
+};
+
+void SuiteDashThroughputEstimator::Test()
+{
+    TestFirstSample();
+    TestSmallSamplesIgnored();
+    TestReactsQuicklyToDrop();
+}
+
+void SuiteDashThroughputEstimator::TestFirstSample()
+{
+    DashThroughputEstimator subject;
+    TEST(subject.HasEstimate() == false);
+    TEST(subject.EstimateBitsPerSecond() == 0);
+
+    subject.AddSample(100000, 1000000); // 100KB in 1s
+    TEST(subject.HasEstimate());
+    const TUint estimate = subject.EstimateBitsPerSecond();
+    TEST(estimate >= 799999 && estimate <= 800001);
+
+    subject.Reset();
+    TEST(subject.HasEstimate() == false);
+}
+
+void SuiteDashThroughputEstimator::TestSmallSamplesIgnored()
+{
+    DashThroughputEstimator subject;
+    subject.AddSample(DashThroughputEstimator::kMinSampleBytes - 1, 1000000);
+    TEST(subject.HasEstimate() == false);
+}
+
+void SuiteDashThroughputEstimator::TestReactsQuicklyToDrop()
+{
+    DashThroughputEstimator subject;
+    for (TUint i = 0; i < 20; i += 1) {
+        subject.AddSample(250000, 1000000); // 2Mbps
+    }
+    TEST(subject.EstimateBitsPerSecond() > 1990000);
+
+    subject.AddSample(50000, 2000000); // 200kbps, lasting 2s
+    TEST(subject.EstimateBitsPerSecond() < 1400000);
+
+    // ...but is slow to trust a recovery
+    subject.AddSample(250000, 1000000);
+    TEST(subject.EstimateBitsPerSecond() < 1500000);
+}
+
+
+// SuiteDashBitrateSelector
+class SuiteDashBitrateSelector : public Suite
+{
+public:
+    SuiteDashBitrateSelector() : Suite("SuiteDashBitrateSelector") {}
+
+private: // Suite
+    void Test() override;
+
+private:
+    void TestVisiting();
+    void TestSegmentStreamSwitching();
+    void TestNoEstimate();
+    void TestStableThroughput();
+    void TestStepDownAndRecover();
+    void TestNoisyThroughput();
+    void TestIncompatibleIgnored();
+};
+
+// Deterministically replays a bandwidth trace (one entry per segment) against a DashBitrateSelector,
+// modelling the pipeline's encoded reservoir as a buffer that drains in real time while segments download.
+class DashAbrSimulator
+{
+public:
+    static const TUint kSegmentMs = 4000;
+    static const TUint kMaxBufferMs = 30000;
+public:
+    DashAbrSimulator(DashBitrateSelector& aSelector);
+    void AddRepresentation(const TChar* aId, TUint aBandwidth, const TChar* aCodecs);
+    void Run(const TUint* aTraceKbps, TUint aSegments);
+    TUint RebufferMs() const { return iRebufferMs; }
+    TUint SelectedBandwidth(TUint aSegment) const { return iSelected[aSegment]; }
+private:
+    DashBitrateSelector& iSelector;
+    TUint iBufferedMs;
+    TUint iRebufferMs;
+    std::vector<TUint> iSelected;
+};
+
+DashAbrSimulator::DashAbrSimulator(DashBitrateSelector& aSelector)
+    : iSelector(aSelector)
+    , iBufferedMs(0)
+    , iRebufferMs(0)
+{
+    iSelector.Reset();
+}
+
+void DashAbrSimulator::AddRepresentation(const TChar* aId, TUint aBandwidth, const TChar* aCodecs)
+{
+    Bws<256> xml("<Representation id=\"");
+    xml.Append(aId);
+    xml.Append("\" bandwidth=\"");
+    Ascii::AppendDec(xml, aBandwidth);
+    xml.Append("\" codecs=\"");
+    xml.Append(aCodecs);
+    xml.Append("\"/>");
+    static_cast<IRepresentationVisitor&>(iSelector).VisitRepresentation( // Visitor methods are private in DashBitrateSelector
+        Brn(aId), aBandwidth, MPDRepresentation::kDefaultQualityRanking, xml);
+}
+
+void DashAbrSimulator::Run(const TUint* aTraceKbps, TUint aSegments)
+{
+    for (TUint i = 0; i < aSegments; i += 1) {
+        (void)iSelector.Select(iBufferedMs);
+        const TUint bandwidth = iSelector.CurrentBandwidth();
+        iSelected.push_back(bandwidth);
+
+        const TUint64 bytes = (static_cast<TUint64>(bandwidth) * kSegmentMs) / 8000;
+        const TUint64 downloadUs = (bytes * 8 * 1000000) / (static_cast<TUint64>(aTraceKbps[i]) * 1000);
+        const TUint downloadMs = static_cast<TUint>(downloadUs / 1000);
+
+        // Playback drains the buffer while we download. The very first segment is startup delay rather than a stall.
+        if (downloadMs > iBufferedMs) {
+            if (iSelected.size() > 1) {
+                iRebufferMs += downloadMs - iBufferedMs;
+            }
+            iBufferedMs = 0;
+        }
+        else {
+            iBufferedMs -= downloadMs;
+        }
+        iBufferedMs += kSegmentMs;
+        if (iBufferedMs > kMaxBufferMs) {
+            iBufferedMs = kMaxBufferMs; // Filler blocks until there is space
+        }
+
+        iSelector.SegmentDownloaded(bytes, static_cast<TUint>(downloadUs));
+    }
+}
+
+void SuiteDashBitrateSelector::Test()
+{
+    TestVisiting();
+    TestSegmentStreamSwitching();
+    TestNoEstimate();
+    TestStableThroughput();
+    TestStepDownAndRecover();
+    TestNoisyThroughput();
+    TestIncompatibleIgnored();
+}
+
+static const Brn kAbrManifest("<?xml version=\"1.0\" encoding=\"utf-8\"?><MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"dynamic\" availabilityStartTime=\"1969-12-31T23:59:44Z\" minimumUpdatePeriod=\"PT6H\"><BaseURL>http://dash.example.com/radio/</BaseURL><Period id=\"1\" start=\"PT0S\"><AdaptationSet contentType=\"audio\" segmentAlignment=\"true\" audioSamplingRate=\"48000\" mimeType=\"audio/mp4\" codecs=\"mp4a.40.2\"><SegmentTemplate timescale=\"48000\" initialization=\"stream-$RepresentationID$.dash\" media=\"stream-$RepresentationID$-$Number$.m4s\" startNumber=\"1\" duration=\"307200\"/><Representation id=\"audio=320000\" bandwidth=\"320000\"/><Representation id=\"audio=96000\" bandwidth=\"96000\"/><Representation id=\"audio=128000\" bandwidth=\"128000\"/></AdaptationSet></Period></MPD>");
+
+void SuiteDashBitrateSelector::TestVisiting()
+{
+    MPDDocument document;
+    DashBitrateSelector subject;
+
+    TEST(document.TrySet(kAbrManifest));
+    TEST(document.Period().AdaptationSet().Representation().Id() == Brn("audio=320000"));
+
+    document.VisitRepresentations(subject);
+    TEST(subject.Current() == Brx::Empty());
+    TEST(subject.TrySetCurrent(Brn("audio=96000")));
+    TEST(subject.CurrentBandwidth() == 96000);
+    TEST(subject.TrySetCurrent(Brn("audio=320000")));
+    TEST(subject.CurrentBandwidth() == 320000);
+    TEST(subject.TrySetCurrent(Brn("audio=48000")) == false);
+    TEST(subject.Current() == Brn("audio=320000"));
+
+    subject.Reset();
+    TEST(subject.TrySetCurrent(Brn("audio=320000")) == false);
+}
+
+void SuiteDashBitrateSelector::TestSegmentStreamSwitching()
+{
+    const TUint kTimestamp = 1723638296; // Wed Aug 14 2024 12:24:56 (GMT)
+
+    Bws<Uri::kMaxUriBytes> uriBuffer;
+    MPDDocument document;
+    MPDSegment segment(uriBuffer);
+    FixedUnixTimestamp timestamp(kTimestamp);
+    MPDSegmentStream subject(timestamp);
+
+    TEST(subject.TrySelectRepresentation(Brn("audio=128000")) == false); // No document yet
+
+    TEST(document.TrySet(kAbrManifest));
+    TEST(subject.TrySet(document, false));
+
+    TEST(subject.TrySelectRepresentation(Brn("audio=128000")));
+    TEST(document.Period().AdaptationSet().Representation().Id() == Brn("audio=128000"));
+    TEST(document.Period().AdaptationSet().Representation().Bandwidth() == 128000);
+
+    TEST(subject.TrySelectRepresentation(Brn("missing")) == false);
+    TEST(document.Period().AdaptationSet().Representation().Id() == Brn("audio=128000"));
+
+    TEST(subject.TryGetNextSegment(segment));
+    TEST(Ascii::Contains(segment.iUrlBuffer, Brn("/stream-audio=128000.dash")));
+}
+
+void SuiteDashBitrateSelector::TestNoEstimate()
+{
+    DashBitrateSelector subject;
+    TEST(subject.Select(0) == Brx::Empty());
+
+    DashAbrSimulator sim(subject);
+    sim.AddRepresentation("low", 96000, "mp4a.40.2");
+    sim.AddRepresentation("high", 320000, "mp4a.40.2");
+    TEST(subject.TrySetCurrent(Brn("high")));
+
+    // Without any throughput measurements we stick with the initial selection.
+    TEST(subject.Select(0) == Brn("high"));
+    TEST(subject.Select(0) == Brn("high"));
+    TEST(subject.SwitchCount() == 0);
+}
+
+static void AddDefaultRepresentations(DashAbrSimulator& aSim, DashBitrateSelector& aSelector)
+{
+    aSim.AddRepresentation("320", 320000, "mp4a.40.2");
+    aSim.AddRepresentation("96", 96000, "mp4a.40.2");
+    aSim.AddRepresentation("160", 160000, "mp4a.40.2");
+    TEST(aSelector.TrySetCurrent(Brn("320")));
+}
+
+void SuiteDashBitrateSelector::TestStableThroughput()
+{
+    TUint trace[30];
+    for (TUint i = 0; i < 30; i += 1) {
+        trace[i] = 2000;
+    }
+
+    DashBitrateSelector subject;
+    DashAbrSimulator sim(subject);
+    AddDefaultRepresentations(sim, subject);
+    sim.Run(trace, 30);
+
+    TEST(subject.SwitchCount() == 0);
+    TEST(sim.RebufferMs() == 0);
+    TEST(sim.SelectedBandwidth(29) == 320000);
+}
+
+void SuiteDashBitrateSelector::TestStepDownAndRecover()
+{
+    // 2Mbps, dropping to 200kbps for 30 segments, then recovering.
+    static const TUint kSegments = 80;
+    TUint trace[kSegments];
+    for (TUint i = 0; i < kSegments; i += 1) {
+        trace[i] = (i >= 20 && i < 50) ? 200 : 2000;
+    }
+
+    DashBitrateSelector subject;
+    DashAbrSimulator sim(subject);
+    AddDefaultRepresentations(sim, subject);
+    sim.Run(trace, kSegments);
+
+    // Steps down shortly after the drop and never tries to step back up while the link is poor...
+    for (TUint i = 23; i < 50; i += 1) {
+        TEST(sim.SelectedBandwidth(i) == 160000);
+    }
+    // ...buffered audio covers the segments fetched before adapting...
+    TEST(sim.RebufferMs() == 0);
+    // ...and returns to the best representation once throughput recovers.
+    TEST(sim.SelectedBandwidth(kSegments - 1) == 320000);
+    TEST(subject.SwitchCount() == 2);
+}
+
+void SuiteDashBitrateSelector::TestNoisyThroughput()
+{
+    // Throughput alternating either side of a threshold shouldn't cause repeated switching.
+    static const TUint kSegments = 60;
+    const TUint kTraces[][2] = { { 300, 450 }, { 250, 600 }, { 200, 800 } };
+
+    for (TUint t = 0; t < sizeof(kTraces) / sizeof(kTraces[0]); t += 1) {
+        TUint trace[kSegments];
+        for (TUint i = 0; i < kSegments; i += 1) {
+            trace[i] = kTraces[t][i % 2];
+        }
+
+        DashBitrateSelector subject;
+        DashAbrSimulator sim(subject);
+        AddDefaultRepresentations(sim, subject);
+        sim.Run(trace, kSegments);
+
+        TEST(subject.SwitchCount() <= 2);
+        TEST(sim.RebufferMs() == 0);
+    }
+}
+
+void SuiteDashBitrateSelector::TestIncompatibleIgnored()
+{
+    // Lowest bandwidth representation uses a different codec so can't be switched to mid-stream.
+    static const TUint kSegments = 20;
+    TUint trace[kSegments];
+    for (TUint i = 0; i < kSegments; i += 1) {
+        trace[i] = i < 5 ? 2000 : 60;
+    }
+
+    DashBitrateSelector subject;
+    DashAbrSimulator sim(subject);
+    sim.AddRepresentation("he-aac", 48000, "mp4a.40.5");
+    sim.AddRepresentation("160", 160000, "mp4a.40.2");
+    sim.AddRepresentation("320", 320000, "mp4a.40.2");
+    TEST(subject.TrySetCurrent(Brn("320")));
+    sim.Run(trace, kSegments);
+
+    TEST(sim.SelectedBandwidth(kSegments - 1) == 160000);
+}
+
+
 extern void TestMPEGDash(Environment& /*aEnv*/)
 {
     Runner runner("TestMPEGDash");
@@ -1295,6 +1617,8 @@ extern void TestMPEGDash(Environment& /*aEnv*/)
     runner.Add(new SuiteBaseUrlCollection());
     runner.Add(new SuiteContentProtection());
     runner.Add(new SuiteMPDSegmentStream());
+    runner.Add(new SuiteDashThroughputEstimator());
+    runner.Add(new SuiteDashBitrateSelector());
 
     runner.Run();
 }
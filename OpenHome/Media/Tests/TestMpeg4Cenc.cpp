@@ -0,0 +1,372 @@
+#include <OpenHome/Media/Codec/Mpeg4.h>
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Net/Private/Globals.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
+
+#include <vector>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+using namespace OpenHome::Media;
+using namespace OpenHome::Media::Codec;
+
+namespace OpenHome {
+namespace Media {
+namespace Codec {
+
+class TestEncryptedSamples : public IMpeg4EncryptedSamples
+{
+public:
+    TestEncryptedSamples();
+    void Add(TUint aBytes, const Brx& aIV);
+    TUint TotalBytes() const;
+public: // from IMpeg4EncryptedSamples
+    TUint Count() const override;
+    TUint Bytes(TUint aIndex) const override;
+    const Brx& IV(TUint aIndex) override;
+private:
+    std::vector<TUint> iBytes;
+    std::vector<TByte> iIVs;
+    Brn iIV;
+    TUint iTotalBytes;
+};
+
+// Provider that holds the content key itself, as a clear key provider would
+class TestCencProvider : public IMpegDRMProvider
+{
+public:
+    TestCencProvider(const Brx& aKey, TBool aInPlace);
+public: // from IMpegDRMProvider
+    TBool Decrypt(const Brx& aKID, const Brx& aEncryptedData, const Brx& aIV, Bwx& aDecryptBuffer) override;
+    TBool SupportsDecryptInPlace() const override;
+    TBool DecryptInPlace(const Brx& aKID, IMpeg4EncryptedSamples& aSamples, Bwx& aData) override;
+private:
+    Mpeg4CencDecryptor iDecryptor;
+    TBool iInPlace;
+};
+
+class SuiteMpeg4Cenc : public Suite
+{
+public:
+    SuiteMpeg4Cenc();
+    void Test() override;
+private:
+    void TestKnownAnswer();
+    void TestSamplesMatchSingleSample();
+    void TestSamplesSizeMismatch();
+    void TestNoKey();
+    void TestProvider();
+};
+
+class SuiteMpeg4CencBenchmark : public Suite
+{
+    static const TUint kBufferBytes = 16 * 1024; // matches Mpeg4BoxMdat's buffer for protected samples
+    static const TUint kTotalBytes = 256 * 1024 * 1024;
+public:
+    SuiteMpeg4CencBenchmark();
+    void Test() override;
+private:
+    void TestSampleBytes(TUint aSampleBytes);
+};
+
+} // namespace Codec
+} // namespace Media
+} // namespace OpenHome
+
+
+// NIST SP 800-38A, F.5.1 (CTR-AES128.Encrypt)
+static const TByte kNistKey[] = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+static const TByte kNistCounter[] = { 0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff };
+static const TByte kNistPlaintext[] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11 };
+static const TByte kNistCiphertext[] = {
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+    0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e };
+
+static void FillPattern(Bwx& aBuf, TUint aBytes)
+{
+    aBuf.SetBytes(0);
+    for (TUint i=0; i<aBytes; i++) {
+        aBuf.Append((TByte)((i * 7) ^ (i >> 8)));
+    }
+}
+
+static void SampleIV(TUint aIndex, Bwx& aIV)
+{
+    // 8 byte per-sample IV, expanded to 16 bytes as Mpeg4ProtectionDetails does
+    aIV.SetBytes(0);
+    aIV.Append(Brn("cenc"));
+    WriterBuffer writer(aIV);
+    WriterBinary(writer).WriteUint32Be(aIndex);
+    while (aIV.Bytes() < Mpeg4CencDecryptor::kIVBytes) {
+        aIV.Append((TByte)0);
+    }
+}
+
+
+// TestEncryptedSamples
+
+TestEncryptedSamples::TestEncryptedSamples()
+    : iTotalBytes(0)
+{
+}
+
+void TestEncryptedSamples::Add(TUint aBytes, const Brx& aIV)
+{
+    ASSERT(aIV.Bytes() == Mpeg4CencDecryptor::kIVBytes);
+    iBytes.push_back(aBytes);
+    iIVs.insert(iIVs.end(), aIV.Ptr(), aIV.Ptr() + aIV.Bytes());
+    iTotalBytes += aBytes;
+}
+
+TUint TestEncryptedSamples::TotalBytes() const
+{
+    return iTotalBytes;
+}
+
+TUint TestEncryptedSamples::Count() const
+{
+    return (TUint)iBytes.size();
+}
+
+TUint TestEncryptedSamples::Bytes(TUint aIndex) const
+{
+    return iBytes[aIndex];
+}
+
+const Brx& TestEncryptedSamples::IV(TUint aIndex)
+{
+    iIV.Set(&iIVs[aIndex * Mpeg4CencDecryptor::kIVBytes], Mpeg4CencDecryptor::kIVBytes);
+    return iIV;
+}
+
+
+// TestCencProvider
+
+TestCencProvider::TestCencProvider(const Brx& aKey, TBool aInPlace)
+    : iInPlace(aInPlace)
+{
+    iDecryptor.SetKey(aKey);
+}
+
+TBool TestCencProvider::Decrypt(const Brx& /*aKID*/, const Brx& aEncryptedData, const Brx& aIV, Bwx& aDecryptBuffer)
+{
+    if (aDecryptBuffer.BytesRemaining() < aEncryptedData.Bytes()) {
+        return false;
+    }
+    const TUint offset = aDecryptBuffer.Bytes();
+    aDecryptBuffer.Append(aEncryptedData);
+    Bwn sample(aDecryptBuffer.Ptr() + offset, aEncryptedData.Bytes(), aEncryptedData.Bytes());
+    return iDecryptor.Decrypt(aIV, sample);
+}
+
+TBool TestCencProvider::SupportsDecryptInPlace() const
+{
+    return iInPlace;
+}
+
+TBool TestCencProvider::DecryptInPlace(const Brx& /*aKID*/, IMpeg4EncryptedSamples& aSamples, Bwx& aData)
+{
+    return iDecryptor.Decrypt(aSamples, aData);
+}
+
+
+// SuiteMpeg4Cenc
+
+SuiteMpeg4Cenc::SuiteMpeg4Cenc()
+    : Suite("Mpeg4 CENC decryption")
+{
+}
+
+void SuiteMpeg4Cenc::Test()
+{
+    TestKnownAnswer();
+    TestSamplesMatchSingleSample();
+    TestSamplesSizeMismatch();
+    TestNoKey();
+    TestProvider();
+}
+
+void SuiteMpeg4Cenc::TestKnownAnswer()
+{
+    Mpeg4CencDecryptor decryptor;
+    decryptor.SetKey(Brn(kNistKey, sizeof(kNistKey)));
+    const Brn iv(kNistCounter, sizeof(kNistCounter));
+
+    // length deliberately not a multiple of the AES block size
+    Bws<sizeof(kNistCiphertext)> buf(Brn(kNistCiphertext, sizeof(kNistCiphertext)));
+    TEST(decryptor.Decrypt(iv, buf));
+    TEST(buf == Brn(kNistPlaintext, sizeof(kNistPlaintext)));
+
+    // counter restarts for each sample
+    buf.Replace(Brn(kNistCiphertext, sizeof(kNistCiphertext)));
+    TEST(decryptor.Decrypt(iv, buf));
+    TEST(buf == Brn(kNistPlaintext, sizeof(kNistPlaintext)));
+
+    // CTR mode is symmetric
+    TEST(decryptor.Decrypt(iv, buf));
+    TEST(buf == Brn(kNistCiphertext, sizeof(kNistCiphertext)));
+
+    TEST(decryptor.Decrypt(Brn(kNistCounter, 8), buf) == false);
+}
+
+void SuiteMpeg4Cenc::TestSamplesMatchSingleSample()
+{
+    static const TUint kSampleBytes[] = { 1, 16, 17, 300, 4097, 15, 0, 2048 };
+    Mpeg4CencDecryptor decryptor;
+    decryptor.SetKey(Brn(kNistKey, sizeof(kNistKey)));
+
+    TestEncryptedSamples samples;
+    Bws<Mpeg4CencDecryptor::kIVBytes> iv;
+    for (TUint i=0; i<sizeof(kSampleBytes)/sizeof(kSampleBytes[0]); i++) {
+        SampleIV(i, iv);
+        samples.Add(kSampleBytes[i], iv);
+    }
+    Bwh expected(samples.TotalBytes());
+    FillPattern(expected, samples.TotalBytes());
+    Bwh data(expected);
+
+    TByte* ptr = const_cast<TByte*>(expected.Ptr());
+    for (TUint i=0; i<samples.Count(); i++) {
+        const TUint bytes = samples.Bytes(i);
+        Bwn sample(ptr, bytes, bytes);
+        TEST(decryptor.Decrypt(samples.IV(i), sample));
+        ptr += bytes;
+    }
+
+    TEST(decryptor.Decrypt(samples, data));
+    TEST(data == expected);
+}
+
+void SuiteMpeg4Cenc::TestSamplesSizeMismatch()
+{
+    Mpeg4CencDecryptor decryptor;
+    decryptor.SetKey(Brn(kNistKey, sizeof(kNistKey)));
+    TestEncryptedSamples samples;
+    samples.Add(32, Brn(kNistCounter, sizeof(kNistCounter)));
+    samples.Add(32, Brn(kNistCounter, sizeof(kNistCounter)));
+
+    Bws<128> data;
+    FillPattern(data, 63);
+    TEST(decryptor.Decrypt(samples, data) == false);
+    FillPattern(data, 65);
+    TEST(decryptor.Decrypt(samples, data) == false);
+    FillPattern(data, 64);
+    TEST(decryptor.Decrypt(samples, data));
+}
+
+void SuiteMpeg4Cenc::TestNoKey()
+{
+    Mpeg4CencDecryptor decryptor;
+    Bws<sizeof(kNistCiphertext)> buf(Brn(kNistCiphertext, sizeof(kNistCiphertext)));
+    TEST(decryptor.Decrypt(Brn(kNistCounter, sizeof(kNistCounter)), buf) == false);
+}
+
+void SuiteMpeg4Cenc::TestProvider()
+{
+    // both routes through a provider give the same audio
+    TestCencProvider perSample(Brn(kNistKey, sizeof(kNistKey)), false);
+    TestCencProvider inPlace(Brn(kNistKey, sizeof(kNistKey)), true);
+    TEST(!perSample.SupportsDecryptInPlace());
+    TEST(inPlace.SupportsDecryptInPlace());
+
+    TestEncryptedSamples samples;
+    Bws<Mpeg4CencDecryptor::kIVBytes> iv;
+    for (TUint i=0; i<4; i++) {
+        SampleIV(i, iv);
+        samples.Add(1000 + i, iv);
+    }
+    Bwh encrypted(samples.TotalBytes());
+    FillPattern(encrypted, samples.TotalBytes());
+
+    Bwh decrypted(samples.TotalBytes());
+    TUint offset = 0;
+    for (TUint i=0; i<samples.Count(); i++) {
+        const Brn sample(encrypted.Ptr() + offset, samples.Bytes(i));
+        TEST(perSample.Decrypt(Brx::Empty(), sample, samples.IV(i), decrypted));
+        offset += samples.Bytes(i);
+    }
+    TEST(decrypted.Bytes() == encrypted.Bytes());
+
+    TEST(inPlace.DecryptInPlace(Brx::Empty(), samples, encrypted));
+    TEST(encrypted == decrypted);
+}
+
+
+// SuiteMpeg4CencBenchmark
+
+SuiteMpeg4CencBenchmark::SuiteMpeg4CencBenchmark()
+    : Suite("Mpeg4 CENC decryption benchmark")
+{
+}
+
+void SuiteMpeg4CencBenchmark::Test()
+{
+    // typical sample sizes for 44.1kHz AAC, 48kHz 16 bit FLAC and 96/24 FLAC
+    TestSampleBytes(400);
+    TestSampleBytes(4096);
+    TestSampleBytes(9700);
+}
+
+void SuiteMpeg4CencBenchmark::TestSampleBytes(TUint aSampleBytes)
+{
+    TestCencProvider provider(Brn(kNistKey, sizeof(kNistKey)), true);
+    TestEncryptedSamples samples;
+    Bws<Mpeg4CencDecryptor::kIVBytes> iv;
+    const TUint count = kBufferBytes / aSampleBytes;
+    for (TUint i=0; i<count; i++) {
+        SampleIV(i, iv);
+        samples.Add(aSampleBytes, iv);
+    }
+    const TUint iterations = kTotalBytes / samples.TotalBytes();
+    const TUint64 bytes = (TUint64)iterations * samples.TotalBytes();
+    Bwh sampleBuf(kBufferBytes);
+    FillPattern(sampleBuf, samples.TotalBytes());
+    Bwh decryptionBuf(kBufferBytes);
+
+    // previous path through Mpeg4BoxMdat: one call per sample, output copied into a separate buffer
+    TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<iterations; i++) {
+        decryptionBuf.SetBytes(0);
+        TUint offset = 0;
+        for (TUint j=0; j<count; j++) {
+            const Brn sample(sampleBuf.Ptr() + offset, aSampleBytes);
+            TEST_QUIETLY(provider.Decrypt(Brx::Empty(), sample, samples.IV(j), decryptionBuf));
+            offset += aSampleBytes;
+        }
+    }
+    const TUint64 perSampleUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+
+    // every complete sample in the buffer decrypted in place in a single call
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<iterations; i++) {
+        TEST_QUIETLY(provider.DecryptInPlace(Brx::Empty(), samples, sampleBuf));
+    }
+    const TUint64 inPlaceUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+
+    Log::Print("  %u byte samples, %lluMB: per sample %lluus (%lluMB/s); in place %lluus (%lluMB/s)\n",
+               aSampleBytes, bytes / (1024 * 1024),
+               perSampleUs, perSampleUs == 0? 0 : bytes / perSampleUs,
+               inPlaceUs, inPlaceUs == 0? 0 : bytes / inPlaceUs);
+}
+
+
+
+void TestMpeg4Cenc()
+{
+    Runner runner("Mpeg4 CENC decryption tests\n");
+    runner.Add(new SuiteMpeg4Cenc());
+    runner.Run();
+}
+
+void TestMpeg4CencBenchmark()
+{
+    Runner runner("Mpeg4 CENC decryption benchmark\n");
+    runner.Add(new SuiteMpeg4CencBenchmark());
+    runner.Run();
+}
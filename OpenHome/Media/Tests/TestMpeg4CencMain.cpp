@@ -0,0 +1,29 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/OptionParser.h>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+extern void TestMpeg4Cenc();
+extern void TestMpeg4CencBenchmark();
+
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
+{
+    OptionParser parser;
+    OptionBool optionBenchmark("-b", "--benchmark", "Compare decrypting protected samples one at a time with decrypting them in place");
+    parser.AddOption(&optionBenchmark);
+    if (!parser.Parse(aArgc, aArgv)) {
+        delete aInitParams;
+        return;
+    }
+
+    Net::UpnpLibrary::InitialiseMinimal(aInitParams);
+    if (optionBenchmark.Value()) {
+        TestMpeg4CencBenchmark();
+    }
+    else {
+        TestMpeg4Cenc();
+    }
+    delete aInitParams;
+    Net::UpnpLibrary::Close();
+}
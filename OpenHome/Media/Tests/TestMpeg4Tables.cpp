@@ -0,0 +1,529 @@
+#include <OpenHome/Media/Codec/Mpeg4.h>
+#include <OpenHome/Media/Pipeline/Msg.h>
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Net/Private/Globals.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+using namespace OpenHome::Media;
+using namespace OpenHome::Media::Codec;
+
+namespace OpenHome {
+namespace Media {
+namespace Codec {
+
+class Mpeg4TablesHelper
+{
+public:
+    static const TUint kAudioSamplesPerSample = 1024;
+    static const TUint kSamplesPerChunk = 20;
+public:
+    static void Populate(Mpeg4SampleTables& aTables, TUint aSampleCount);
+    static void Serialise(Mpeg4SampleTables& aTables, Bwx& aBuf, TUint& aMsgCount);
+    static void WriteReference(TUint aId, Bwx& aBuf);
+};
+
+class SuiteMpeg4Tables : public Suite
+{
+public:
+    SuiteMpeg4Tables();
+    void Test() override;
+private:
+    void TestSerialisedRoundTrip();
+    void TestReference();
+    void TestReferenceUnknown();
+    void TestReferenceOutlivesRegistration();
+    void TestRegistryFull();
+};
+
+class SuiteSeekTable : public Suite
+{
+public:
+    SuiteSeekTable();
+    void Test() override;
+private:
+    static void Populate(Mpeg4SampleTables& aTables, TBool aSyncSamples);
+    void TestChunks();
+    void TestSeek();
+    void TestSeekSyncSamples();
+    void TestSerialisedSyncSamples();
+    void TestSampleBytes();
+    void TestSeekExpected(Mpeg4SampleTables& aTables, TUint64 aAudioSample, TUint64 aExpectedAudioSample,
+                          TUint64 aExpectedSample, TUint64 aExpectedOffset);
+};
+
+class SuiteMpeg4TablesBenchmark : public Suite
+{
+    static const TUint kIterations = 10;
+    static const TUint kSeeks = 100000;
+public:
+    SuiteMpeg4TablesBenchmark();
+    void Test() override;
+private:
+    void TestTables();
+    void TestSeek();
+};
+
+} // namespace Codec
+} // namespace Media
+} // namespace OpenHome
+
+
+// Mpeg4TablesHelper
+
+void Mpeg4TablesHelper::Populate(Mpeg4SampleTables& aTables, TUint aSampleCount)
+{ // static
+    SampleSizeTable& sampleSizes = aTables.SampleSizes();
+    sampleSizes.Init(aSampleCount);
+    for (TUint i=0; i<aSampleCount; i++) {
+        sampleSizes.AddSampleSize(300 + (i % 97));
+    }
+
+    SeekTable& seek = aTables.Seek();
+    const TUint chunks = (aSampleCount + kSamplesPerChunk - 1) / kSamplesPerChunk;
+    seek.InitialiseSamplesPerChunk(1);
+    seek.SetSamplesPerChunk(1, kSamplesPerChunk, 1);
+    seek.InitialiseAudioSamplesPerSample(1);
+    seek.SetAudioSamplesPerSample(aSampleCount, kAudioSamplesPerSample);
+    seek.InitialiseOffsets(chunks);
+    TUint64 offset = 4096;
+    for (TUint i=0; i<chunks; i++) {
+        seek.SetOffset(offset);
+        offset += kSamplesPerChunk * 350;
+    }
+}
+
+void Mpeg4TablesHelper::Serialise(Mpeg4SampleTables& aTables, Bwx& aBuf, TUint& aMsgCount)
+{ // static
+    // as Mpeg4Container does when it can't register its tables, one MsgAudioEncoded at a time
+    aBuf.SetBytes(0);
+    aMsgCount = 0;
+    WriterBuffer writer(aBuf);
+    SampleSizeTable& sampleSizes = aTables.SampleSizes();
+    sampleSizes.WriteInit();
+    do {
+        sampleSizes.Write(writer, EncodedAudio::kMaxBytes);
+        aMsgCount++;
+    } while (!sampleSizes.WriteComplete());
+    SeekTable& seek = aTables.Seek();
+    seek.WriteInit();
+    do {
+        seek.Write(writer, EncodedAudio::kMaxBytes);
+        aMsgCount++;
+    } while (!seek.WriteComplete());
+}
+
+void Mpeg4TablesHelper::WriteReference(TUint aId, Bwx& aBuf)
+{ // static
+    aBuf.SetBytes(0);
+    WriterBuffer writerBuf(aBuf);
+    WriterBinary writerBin(writerBuf);
+    writerBin.WriteUint32Be(Mpeg4SampleTablesRegistry::kMarker);
+    writerBin.WriteUint32Be(aId);
+}
+
+
+// SuiteMpeg4Tables
+
+SuiteMpeg4Tables::SuiteMpeg4Tables()
+    : Suite("Mpeg4 sample and seek tables")
+{
+}
+
+void SuiteMpeg4Tables::Test()
+{
+    TestSerialisedRoundTrip();
+    TestReference();
+    TestReferenceUnknown();
+    TestReferenceOutlivesRegistration();
+    TestRegistryFull();
+}
+
+void SuiteMpeg4Tables::TestSerialisedRoundTrip()
+{
+    static const TUint kSampleCount = 1000;
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    Mpeg4TablesHelper::Populate(*tables, kSampleCount);
+    Bwh buf(64 * 1024);
+    TUint msgs = 0;
+    Mpeg4TablesHelper::Serialise(*tables, buf, msgs);
+
+    ReaderBuffer reader(buf);
+    Mpeg4SampleTables* read = Mpeg4SampleTablesReader::Read(reader);
+    TEST(read != tables);
+    TEST(read->SampleSizes().Count() == kSampleCount);
+    for (TUint i=0; i<kSampleCount; i++) {
+        TEST(read->SampleSizes().SampleSize(i) == tables->SampleSizes().SampleSize(i));
+    }
+    TEST(read->Seek().ChunkCount() == tables->Seek().ChunkCount());
+    TUint64 audioSample = 500 * Mpeg4TablesHelper::kAudioSamplesPerSample;
+    TUint64 codecSample = 0;
+    const TUint64 offset = tables->Seek().Offset(audioSample, codecSample, tables->SampleSizes());
+    TUint64 audioSampleRead = 500 * Mpeg4TablesHelper::kAudioSamplesPerSample;
+    TUint64 codecSampleRead = 0;
+    TEST(read->Seek().Offset(audioSampleRead, codecSampleRead, read->SampleSizes()) == offset);
+    TEST(audioSampleRead == audioSample);
+    TEST(codecSampleRead == codecSample);
+
+    read->RemoveRef();
+    tables->RemoveRef();
+}
+
+void SuiteMpeg4Tables::TestReference()
+{
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    Mpeg4TablesHelper::Populate(*tables, 100);
+    const TUint id = Mpeg4SampleTablesRegistry::Register(*tables);
+    TEST(id != Mpeg4SampleTablesRegistry::kIdNone);
+    TEST(id != Mpeg4SampleTablesRegistry::kMarker);
+
+    Bws<8> buf;
+    Mpeg4TablesHelper::WriteReference(id, buf);
+    ReaderBuffer reader(buf);
+    Mpeg4SampleTables* read = Mpeg4SampleTablesReader::Read(reader);
+    TEST(read == tables);
+    TEST(read->SampleSizes().Count() == 100);
+    read->RemoveRef();
+
+    Mpeg4SampleTablesRegistry::Deregister(id);
+    tables->RemoveRef();
+}
+
+void SuiteMpeg4Tables::TestReferenceUnknown()
+{
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    const TUint id = Mpeg4SampleTablesRegistry::Register(*tables);
+    Mpeg4SampleTablesRegistry::Deregister(id);
+    tables->RemoveRef();
+
+    Bws<8> buf;
+    Mpeg4TablesHelper::WriteReference(id, buf);
+    ReaderBuffer reader(buf);
+    TEST_THROWS(Mpeg4SampleTablesReader::Read(reader), MediaMpeg4FileInvalid);
+
+    Mpeg4TablesHelper::WriteReference(Mpeg4SampleTablesRegistry::kIdNone, buf);
+    ReaderBuffer reader2(buf);
+    TEST_THROWS(Mpeg4SampleTablesReader::Read(reader2), MediaMpeg4FileInvalid);
+}
+
+void SuiteMpeg4Tables::TestReferenceOutlivesRegistration()
+{
+    // a codec may still be decoding from tables after its container has been destroyed
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    Mpeg4TablesHelper::Populate(*tables, 50);
+    const TUint id = Mpeg4SampleTablesRegistry::Register(*tables);
+    Mpeg4SampleTables* claimed = Mpeg4SampleTablesRegistry::Claim(id);
+    TEST(claimed == tables);
+    Mpeg4SampleTablesRegistry::Deregister(id);
+    tables->RemoveRef();
+    TEST(claimed->SampleSizes().Count() == 50);
+    TEST(Mpeg4SampleTablesRegistry::Claim(id) == nullptr);
+    claimed->RemoveRef();
+}
+
+void SuiteMpeg4Tables::TestRegistryFull()
+{
+    static const TUint kMaxAttempts = 1024;
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    TUint ids[kMaxAttempts];
+    TUint count = 0;
+    for (; count<kMaxAttempts; count++) {
+        ids[count] = Mpeg4SampleTablesRegistry::Register(*tables);
+        if (ids[count] == Mpeg4SampleTablesRegistry::kIdNone) {
+            break;
+        }
+    }
+    TEST(count > 0);
+    TEST(count < kMaxAttempts);
+    for (TUint i=0; i<count; i++) {
+        for (TUint j=i+1; j<count; j++) {
+            TEST(ids[i] != ids[j]);
+        }
+    }
+    for (TUint i=0; i<count; i++) {
+        Mpeg4SampleTablesRegistry::Deregister(ids[i]);
+    }
+    const TUint id = Mpeg4SampleTablesRegistry::Register(*tables);
+    TEST(id != Mpeg4SampleTablesRegistry::kIdNone);
+    Mpeg4SampleTablesRegistry::Deregister(id);
+    tables->RemoveRef();
+}
+
+
+// SuiteSeekTable
+
+SuiteSeekTable::SuiteSeekTable()
+    : Suite("Mpeg4 seek table")
+{
+}
+
+void SuiteSeekTable::Test()
+{
+    TestChunks();
+    TestSeek();
+    TestSeekSyncSamples();
+    TestSerialisedSyncSamples();
+    TestSampleBytes();
+}
+
+void SuiteSeekTable::Populate(Mpeg4SampleTables& aTables, TBool aSyncSamples)
+{ // static
+    /* chunks 1-2 hold 10 samples each (samples 0-19)
+       chunks 3-5 hold 5 samples each (samples 20-34)
+       chunks 6-8 hold 8 samples each (samples 35-58)
+       samples 0-29 hold 1024 audio samples each, samples 30-58 hold 512
+       sample n is 100+n bytes; chunk n starts at offset n*1000
+       sync samples (if any) are 0, 20, 27 (part way through chunk 4) and 35 */
+    SampleSizeTable& sampleSizes = aTables.SampleSizes();
+    sampleSizes.Init(59);
+    for (TUint i=0; i<59; i++) {
+        sampleSizes.AddSampleSize(100 + i);
+    }
+    SeekTable& seek = aTables.Seek();
+    seek.InitialiseSamplesPerChunk(3);
+    seek.SetSamplesPerChunk(1, 10, 1);
+    seek.SetSamplesPerChunk(3, 5, 1);
+    seek.SetSamplesPerChunk(6, 8, 1);
+    seek.InitialiseAudioSamplesPerSample(2);
+    seek.SetAudioSamplesPerSample(30, 1024);
+    seek.SetAudioSamplesPerSample(29, 512);
+    seek.InitialiseOffsets(8);
+    for (TUint i=1; i<=8; i++) {
+        seek.SetOffset(i * 1000);
+    }
+    if (aSyncSamples) {
+        seek.InitialiseSyncSamples(4);
+        seek.SetSyncSample(1);
+        seek.SetSyncSample(21);
+        seek.SetSyncSample(28);
+        seek.SetSyncSample(36);
+    }
+}
+
+void SuiteSeekTable::TestChunks()
+{
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    Populate(*tables, false);
+    const SeekTable& seek = tables->Seek();
+    TEST(seek.ChunkCount() == 8);
+    static const TUint kSamplesPerChunk[] = { 10, 10, 5, 5, 5, 8, 8, 8 };
+    static const TUint kStartSample[] = { 0, 10, 20, 25, 30, 35, 43, 51 };
+    for (TUint i=0; i<8; i++) {
+        TEST(seek.SamplesPerChunk(i) == kSamplesPerChunk[i]);
+        TEST(seek.StartSample(i) == kStartSample[i]);
+    }
+    tables->RemoveRef();
+}
+
+void SuiteSeekTable::TestSeekExpected(Mpeg4SampleTables& aTables, TUint64 aAudioSample, TUint64 aExpectedAudioSample,
+                                      TUint64 aExpectedSample, TUint64 aExpectedOffset)
+{
+    TUint64 audioSample = aAudioSample;
+    TUint64 sample = 0;
+    const TUint64 offset = aTables.Seek().Offset(audioSample, sample, aTables.SampleSizes());
+    TEST(offset == aExpectedOffset);
+    TEST(audioSample == aExpectedAudioSample);
+    TEST(sample == aExpectedSample);
+}
+
+void SuiteSeekTable::TestSeek()
+{
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    Populate(*tables, false);
+    // with no stss, every sample is a sync sample so seeks start part way through chunks
+    TestSeekExpected(*tables, 0, 0, 0, 1000);
+    TestSeekExpected(*tables, 10239, 9216, 9, 1000 + 936);              // sample 9, last in chunk 1
+    TestSeekExpected(*tables, 10240, 10240, 10, 2000);
+    TestSeekExpected(*tables, 31000, 30720, 30, 5000);                  // sample 30, first with 512 audio samples
+    TestSeekExpected(*tables, 40000, 39936, 48, 7000 + 725);            // sample 48, 6th in chunk 7
+    TestSeekExpected(*tables, 45567, 30720 + 28*512, 58, 8000 + 1078);  // last sample
+    const SeekTable& seek = tables->Seek();
+    TUint64 audioSample = 45568; // end of stream
+    TUint64 sample = 0;
+    TEST_THROWS(seek.Offset(audioSample, sample, tables->SampleSizes()), MediaMpeg4FileInvalid);
+    audioSample = 45569;
+    TEST_THROWS(seek.Offset(audioSample, sample, tables->SampleSizes()), MediaMpeg4OutOfRange);
+    tables->RemoveRef();
+}
+
+void SuiteSeekTable::TestSeekSyncSamples()
+{
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    Populate(*tables, true);
+    TestSeekExpected(*tables, 0, 0, 0, 1000);
+    TestSeekExpected(*tables, 10240, 0, 0, 1000);
+    TestSeekExpected(*tables, 27647, 20480, 20, 3000);
+    // sync sample 27 is the 3rd in chunk 4 so samples 25 and 26 (125+126 bytes) are skipped
+    TestSeekExpected(*tables, 27648, 27648, 27, 4000 + 251);
+    TestSeekExpected(*tables, 31000, 27648, 27, 4000 + 251);
+    TestSeekExpected(*tables, 40000, 33280, 35, 6000);
+    TestSeekExpected(*tables, 45568, 33280, 35, 6000);
+    TEST_THROWS(tables->Seek().SetSyncSample(36), MediaMpeg4FileInvalid);
+    TEST_THROWS(tables->Seek().SetSyncSample(2), MediaMpeg4FileInvalid);
+    tables->RemoveRef();
+}
+
+void SuiteSeekTable::TestSerialisedSyncSamples()
+{
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    Populate(*tables, true);
+    Bwh buf(4 * 1024);
+    TUint msgs = 0;
+    Mpeg4TablesHelper::Serialise(*tables, buf, msgs);
+    ReaderBuffer reader(buf);
+    Mpeg4SampleTables* read = Mpeg4SampleTablesReader::Read(reader);
+    TestSeekExpected(*read, 27647, 20480, 20, 3000);
+    TestSeekExpected(*read, 31000, 27648, 27, 4000 + 251);
+    TestSeekExpected(*read, 40000, 33280, 35, 6000);
+    read->RemoveRef();
+    tables->RemoveRef();
+}
+
+void SuiteSeekTable::TestSampleBytes()
+{
+    Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+    Mpeg4TablesHelper::Populate(*tables, 1000);
+    const SampleSizeTable& sampleSizes = tables->SampleSizes();
+    TEST(sampleSizes.Bytes(0, 0) == 0);
+    TUint64 total = 0;
+    for (TUint i=0; i<sampleSizes.Count(); i++) {
+        TEST(sampleSizes.Bytes(0, i) == total);
+        TEST(sampleSizes.Bytes(i, 1) == sampleSizes.SampleSize(i));
+        total += sampleSizes.SampleSize(i);
+    }
+    TEST(sampleSizes.Bytes(0, 1000) == total);
+    TEST(sampleSizes.Bytes(1000, 0) == 0);
+    TUint64 expected = 0;
+    for (TUint i=63; i<63+130; i++) {
+        expected += sampleSizes.SampleSize(i);
+    }
+    TEST(sampleSizes.Bytes(63, 130) == expected);
+    TEST_THROWS(sampleSizes.Bytes(999, 2), MediaMpeg4FileInvalid);
+    TEST_THROWS(sampleSizes.Bytes(1001, 0), MediaMpeg4FileInvalid);
+    tables->RemoveRef();
+}
+
+
+// SuiteMpeg4TablesBenchmark
+
+SuiteMpeg4TablesBenchmark::SuiteMpeg4TablesBenchmark()
+    : Suite("Mpeg4 tables benchmark")
+{
+}
+
+void SuiteMpeg4TablesBenchmark::Test()
+{
+    TestTables();
+    TestSeek();
+}
+
+void SuiteMpeg4TablesBenchmark::TestTables()
+{
+    // synthetic tables matching 1 hour and 10 hour 44.1kHz AAC audiobooks
+    static const TUint kDurationsSecs[] = { 60 * 60, 10 * 60 * 60 };
+    for (auto secs : kDurationsSecs) {
+        const TUint sampleCount = (secs * 44100) / Mpeg4TablesHelper::kAudioSamplesPerSample;
+        Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+        Mpeg4TablesHelper::Populate(*tables, sampleCount);
+        const TUint id = Mpeg4SampleTablesRegistry::Register(*tables);
+        TEST(id != Mpeg4SampleTablesRegistry::kIdNone);
+
+        Bwh serialised(sampleCount * 8 + 1024);
+        TUint msgs = 0;
+        TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+        for (TUint i=0; i<kIterations; i++) {
+            Mpeg4TablesHelper::Serialise(*tables, serialised, msgs);
+            ReaderBuffer reader(serialised);
+            Mpeg4SampleTables* read = Mpeg4SampleTablesReader::Read(reader);
+            TEST(read->SampleSizes().Count() == sampleCount);
+            read->RemoveRef();
+        }
+        const TUint64 serialisedUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+
+        Bws<8> reference;
+        start = Os::TimeInUs(gEnv->OsCtx());
+        for (TUint i=0; i<kIterations; i++) {
+            Mpeg4TablesHelper::WriteReference(id, reference);
+            ReaderBuffer reader(reference);
+            Mpeg4SampleTables* read = Mpeg4SampleTablesReader::Read(reader);
+            TEST(read->SampleSizes().Count() == sampleCount);
+            read->RemoveRef();
+        }
+        const TUint64 referenceUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+
+        Log::Print("  %uh, %u samples: serialised %uB in %u msgs, %lluus; by reference %uB, %lluus\n",
+                   secs / (60 * 60), sampleCount, serialised.Bytes(), msgs, serialisedUs / kIterations,
+                   reference.Bytes(), referenceUs / kIterations);
+
+        Mpeg4SampleTablesRegistry::Deregister(id);
+        tables->RemoveRef();
+    }
+}
+
+void SuiteMpeg4TablesBenchmark::TestSeek()
+{
+    // variable chunking (a new stsc run every 4 chunks) and a sync sample every 8 samples
+    static const TUint kSampleCounts[] = { 100000, 1000000 };
+    for (auto sampleCount : kSampleCounts) {
+        Mpeg4SampleTables* tables = new Mpeg4SampleTables();
+        SeekTable& seek = tables->Seek();
+        TUint samples = 0;
+        TUint chunk = 1;
+        TUint runs = 0;
+        while (samples < sampleCount) {
+            const TUint samplesPerChunk = 5 + (runs % 20);
+            seek.SetSamplesPerChunk(chunk, samplesPerChunk, 1);
+            chunk += 4;
+            samples += 4 * samplesPerChunk;
+            runs++;
+        }
+        for (TUint i=1; i<chunk; i++) {
+            seek.SetOffset(i * 4096);
+        }
+        seek.SetAudioSamplesPerSample(samples, Mpeg4TablesHelper::kAudioSamplesPerSample);
+        for (TUint i=1; i<=samples; i+=8) {
+            seek.SetSyncSample(i);
+        }
+        SampleSizeTable& sampleSizes = tables->SampleSizes();
+        sampleSizes.Init(samples);
+        for (TUint i=0; i<samples; i++) {
+            sampleSizes.AddSampleSize(300 + (i % 97));
+        }
+
+        const TUint64 audioSamples = static_cast<TUint64>(samples) * Mpeg4TablesHelper::kAudioSamplesPerSample;
+        TUint64 checksum = 0;
+        const TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+        for (TUint i=0; i<kSeeks; i++) {
+            TUint64 audioSample = (audioSamples * i) / kSeeks;
+            TUint64 sample = 0;
+            checksum += seek.Offset(audioSample, sample, sampleSizes);
+            TEST(sample <= (audioSamples * i) / kSeeks / Mpeg4TablesHelper::kAudioSamplesPerSample);
+        }
+        const TUint64 seekUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+        TEST(checksum > 0);
+
+        Log::Print("  %u samples, %u stsc runs, %u chunks: %u seeks in %lluus\n",
+                   samples, runs, chunk - 1, kSeeks, seekUs);
+        tables->RemoveRef();
+    }
+}
+
+
+
+void TestMpeg4Tables()
+{
+    Runner runner("Mpeg4 sample table tests\n");
+    runner.Add(new SuiteMpeg4Tables());
+    runner.Add(new SuiteSeekTable());
+    runner.Run();
+}
+
+void TestMpeg4TablesBenchmark()
+{
+    Runner runner("Mpeg4 sample table benchmark\n");
+    runner.Add(new SuiteMpeg4TablesBenchmark());
+    runner.Run();
+}
@@ -0,0 +1,29 @@
+#include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/OptionParser.h>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
+
+extern void TestMpeg4Tables();
+extern void TestMpeg4TablesBenchmark();
+
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
+{
+    OptionParser parser;
+    OptionBool optionBenchmark("-b", "--benchmark", "Time passing large sample tables from container to codec");
+    parser.AddOption(&optionBenchmark);
+    if (!parser.Parse(aArgc, aArgv)) {
+        delete aInitParams;
+        return;
+    }
+
+    Net::UpnpLibrary::InitialiseMinimal(aInitParams);
+    if (optionBenchmark.Value()) {
+        TestMpeg4TablesBenchmark();
+    }
+    else {
+        TestMpeg4Tables();
+    }
+    delete aInitParams;
+    Net::UpnpLibrary::Close();
+}
@@ -3,9 +3,13 @@
 #include <OpenHome/Media/Pipeline/RampArray.h>
 #include <OpenHome/Media/Utils/AllocatorInfoLogger.h>
 #include <OpenHome/Media/Utils/ProcessorAudioUtils.h>
+#include <OpenHome/Net/Private/Globals.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <string.h>
 #include <vector>
+#include <algorithm>
 
 using namespace OpenHome;
 using namespace OpenHome::TestFramework;
@@ -30,11 +34,40 @@ public:
     TestCell(AllocatorBase& aAllocator);
     void Fill(TChar aVal);
     void CheckIsFilled(TChar aVal) const;
+    TBool IsFilled(TChar aVal) const;
 private:
     static const TUint kNumBytes = 10;
     TChar iBytes[kNumBytes];
 };
 
+class SuiteAllocatorElastic : public Suite
+{
+    static const TUint kMaxCells = 64; // => slabs of 4 cells
+    static const TUint kSlabCells = 4;
+public:
+    SuiteAllocatorElastic();
+    void Test() override;
+private:
+    AllocatorInfoLogger iInfoAggregator;
+};
+
+class SuiteAllocatorContention : public Suite
+{
+    static const TUint kNumThreads = 4;
+    static const TUint kCellsPerThread = 4;
+    static const TUint kIterations = 100000;
+public:
+    SuiteAllocatorContention();
+    void Test() override;
+private:
+    void AllocateFreeThread();
+private:
+    AllocatorInfoLogger iInfoAggregator;
+    Allocator<TestCell>* iAllocator;
+    std::atomic<TUint> iNextThreadId;
+    std::atomic<TUint> iCorruptCells;
+};
+
 class SuiteMsgAudioEncoded : public Suite
 {
     static const TUint kMsgCount = 8;
@@ -111,6 +144,82 @@ private:
     AllocatorInfoLogger iInfoAggregator;
 };
 
+class SuiteRampApplicatorPerf : public Suite
+{
+    static const TUint kSampleRate = 192000;
+    static const TUint kSamplesPerMsg = kSampleRate / 200; // 5ms
+    static const TUint kIterations = 200;
+public:
+    SuiteRampApplicatorPerf();
+    void Test() override;
+private:
+    void Benchmark(TUint aBitDepth, TUint aNumChannels);
+private:
+    Bwh iAudio;
+    Bwh iRamped;
+};
+
+class ProcessorInt32Test : public IPcmProcessorInt32
+{
+public:
+    ProcessorInt32Test();
+    const std::vector<TInt32>& Subsamples() const;
+    TUint NumFragments() const;
+    TUint BitDepth() const;
+    TInt64 Sum() const;
+private: // from IPcmProcessorInt32
+    void BeginBlock() override;
+    void ProcessFragment(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint aBitDepth) override;
+    void ProcessSilence(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint aBitDepth) override;
+    void EndBlock() override;
+    void Flush() override;
+private:
+    std::vector<TInt32> iSubsamples;
+    TUint iNumFragments;
+    TUint iBitDepth;
+};
+
+class ProcessorPcmSum : public IPcmProcessor
+{
+public:
+    ProcessorPcmSum() : iSum(0) {}
+    TUint64 Sum() const { return iSum; }
+private: // from IPcmProcessor
+    void BeginBlock() override {}
+    void ProcessFragment(const Brx& aData, TUint aNumChannels, TUint aSubsampleBytes) override;
+    void ProcessSilence(const Brx& aData, TUint aNumChannels, TUint aSubsampleBytes) override;
+    void EndBlock() override {}
+    void Flush() override {}
+private:
+    TUint64 iSum;
+};
+
+class SuitePcmStorage : public Suite
+{
+    static const TUint kMsgCount = 8;
+    static const TUint kNumChannels = 2;
+    static const TUint kNumSamples = 480;
+    static const TUint kPerfSampleRate = 192000;
+    static const TUint kPerfIterations = 2000;
+public:
+    SuitePcmStorage();
+    ~SuitePcmStorage();
+    void Test() override;
+private:
+    void TestReadsMatch(TUint aBitDepth);
+    void TestRampsMatch(TUint aBitDepth);
+    void TestSplit();
+    void TestSilence();
+    void Benchmark(MsgFactory& aFactory, const TChar* aStorage);
+    static std::vector<TInt32> Unpack(const Brx& aData, TUint aBitDepth);
+    MsgPlayable* CreatePlayable(MsgFactory& aFactory, TUint aBitDepth, TBool aRamp);
+private:
+    AllocatorInfoLogger iInfoAggregator;
+    MsgFactory* iFactoryPacked;
+    MsgFactory* iFactoryInt32;
+    Bwh iData;
+};
+
 class SuiteAudioStream : public Suite
 {
     static const TUint kMsgEncodedStreamCount = 1;
@@ -304,6 +413,31 @@ private:
     AllocatorInfoLogger iInfoAggregator;
 };
 
+class SuiteMsgQueueSpsc : public Suite
+{
+    static const TUint kSmallCapacity = 4;
+    static const TUint kNumFlushes = 16;
+    static const TUint kNumBenchmarkMsgs = 200000;
+public:
+    SuiteMsgQueueSpsc();
+    ~SuiteMsgQueueSpsc();
+    void Test() override;
+private:
+    void TestFifo();
+    void TestEnqueueAtHead();
+    void TestClear();
+    void TestProducerBlocksWhenFull();
+    void TestContention();
+    void FlushProducer();
+    void BenchmarkProducer();
+private:
+    MsgFactory* iMsgFactory;
+    TrackFactory* iTrackFactory;
+    AllocatorInfoLogger iInfoAggregator;
+    MsgQueueSpsc* iQueueSpsc;
+    MsgQueue* iQueueLocked;
+};
+
 class SuiteMsgReservoir : public Suite
 {
     static const TUint kMsgCount = 8;
@@ -439,6 +573,16 @@ void TestCell::CheckIsFilled(TChar aVal) const
     }
 }
 
+TBool TestCell::IsFilled(TChar aVal) const
+{
+    for (TUint i=0; i<kNumBytes; i++) {
+        if (iBytes[i] != aVal) {
+            return false;
+        }
+    }
+    return true;
+}
+
 
 // SuiteAllocator
 
@@ -506,6 +650,150 @@ void SuiteAllocator::Test()
 }
 
 
+// SuiteAllocatorElastic
+
+SuiteAllocatorElastic::SuiteAllocatorElastic()
+    : Suite("Elastic allocator tests")
+{
+}
+
+void SuiteAllocatorElastic::Test()
+{
+    const TUint cellBytes = sizeof(TestCell);
+    AllocatorMemoryBudget* budget = new AllocatorMemoryBudget(10 * kSlabCells * cellBytes, iInfoAggregator);
+    Allocator<TestCell>* allocator = new Allocator<TestCell>("TestCell", kMaxCells, iInfoAggregator, budget);
+
+    // only the first slab is created up front
+    TEST(allocator->CellsTotal() == kMaxCells);
+    TEST(allocator->CellsResident() == kSlabCells);
+    TEST(budget->BytesReserved() == kSlabCells * cellBytes);
+
+    // allocator grows a slab at a time
+    std::vector<TestCell*> cells;
+    for (TUint i=0; i<kSlabCells+1; i++) {
+        cells.push_back(allocator->Allocate());
+        cells.back()->Fill((TChar)i);
+    }
+    TEST(allocator->CellsResident() == 2 * kSlabCells);
+    TEST(allocator->CellsUsed() == kSlabCells + 1);
+    TEST(budget->BytesReserved() == 2 * kSlabCells * cellBytes);
+
+    // growth continues beyond the budget (up to the allocator's capacity) but is recorded
+    while (cells.size() < 10 * kSlabCells) {
+        cells.push_back(allocator->Allocate());
+    }
+    TEST(allocator->CellsResident() == 10 * kSlabCells);
+    TEST(budget->BytesReserved() == budget->BytesTotal());
+    cells.push_back(allocator->Allocate());
+    TEST(allocator->CellsResident() == 11 * kSlabCells);
+    TEST(budget->BytesReserved() == 11 * kSlabCells * cellBytes);
+    while (cells.size() < kMaxCells) {
+        cells.push_back(allocator->Allocate());
+    }
+    TEST_THROWS(allocator->Allocate(), AssertionFailed);
+    TEST(allocator->CellsUsed() == kMaxCells);
+
+    // freeing cells doesn't destroy them...
+    for (TUint i=kSlabCells+1; i<cells.size(); i++) {
+        cells[i]->RemoveRef();
+    }
+    cells.resize(kSlabCells+1);
+    TEST(allocator->CellsUsed() == kSlabCells + 1);
+    TEST(allocator->CellsResident() == kMaxCells);
+
+    // ...Reclaim() returns memory to the budget, keeping a slab spare above current use
+    budget->Reclaim();
+    TEST(allocator->CellsResident() >= kSlabCells + 1);
+    TEST(allocator->CellsResident() < kSlabCells + 1 + 2 * kSlabCells);
+    TEST(allocator->CellsResidentMax() == kMaxCells);
+    TEST(budget->BytesReserved() == allocator->CellsResident() * cellBytes);
+    TEST(budget->BytesReservedMax() == kMaxCells * cellBytes);
+
+    // cells still in use were unaffected by shrinking
+    for (TUint i=0; i<cells.size(); i++) {
+        cells[i]->CheckIsFilled((TChar)i);
+        cells[i]->RemoveRef();
+    }
+    TEST(allocator->CellsUsed() == 0);
+    budget->Reclaim();
+    TEST(allocator->CellsResident() >= kSlabCells);
+    TEST(allocator->CellsResident() < 3 * kSlabCells);
+
+    // freed indexes can be reused when growing again
+    cells.clear();
+    for (TUint i=0; i<8 * kSlabCells; i++) {
+        cells.push_back(allocator->Allocate());
+    }
+    TEST(allocator->CellsResident() == 8 * kSlabCells);
+    for (auto cell : cells) {
+        cell->RemoveRef();
+    }
+
+    // destroying an allocator returns all of its memory to the (longer lived) budget
+    delete allocator;
+    TEST(budget->BytesReserved() == 0);
+    delete budget;
+}
+
+
+// SuiteAllocatorContention
+
+SuiteAllocatorContention::SuiteAllocatorContention()
+    : Suite("Allocator contention tests")
+    , iAllocator(nullptr)
+    , iNextThreadId(0)
+    , iCorruptCells(0)
+{
+}
+
+void SuiteAllocatorContention::Test()
+{
+    // several threads allocating and freeing from the same allocator never share a cell,
+    // never exhaust it and leave its statistics consistent
+    iAllocator = new Allocator<TestCell>("TestCell", kNumThreads * kCellsPerThread, iInfoAggregator);
+    ThreadFunctor* threads[kNumThreads];
+    for (TUint i=0; i<kNumThreads; i++) {
+        threads[i] = new ThreadFunctor("AllocatorContention", MakeFunctor(*this, &SuiteAllocatorContention::AllocateFreeThread));
+    }
+    const TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kNumThreads; i++) {
+        threads[i]->Start();
+    }
+    for (TUint i=0; i<kNumThreads; i++) {
+        delete threads[i];
+    }
+    const TUint64 us = std::max(Os::TimeInUs(gEnv->OsCtx()) - start, (TUint64)1);
+    TEST(iCorruptCells == 0);
+    TEST(iAllocator->CellsUsed() == 0);
+    TEST(iAllocator->CellsUsedMax() <= kNumThreads * kCellsPerThread);
+    TEST(iAllocator->CellsUsedMax() >= kCellsPerThread);
+
+    const TUint64 ops = (TUint64)kNumThreads * kIterations * kCellsPerThread;
+    Log::Print("  %u threads: %llu Kallocations/s\n", kNumThreads, (ops * 1000) / us);
+    delete iAllocator;
+    iAllocator = nullptr;
+}
+
+void SuiteAllocatorContention::AllocateFreeThread()
+{
+    const TChar fill = (TChar)('a' + iNextThreadId++);
+    TestCell* cells[kCellsPerThread];
+    for (TUint i=0; i<kIterations; i++) {
+        for (TUint j=0; j<kCellsPerThread; j++) {
+            cells[j] = iAllocator->Allocate();
+            cells[j]->Fill(fill);
+        }
+        for (TUint j=0; j<kCellsPerThread; j++) {
+            // TEST isn't thread safe so check the cell wasn't handed to another thread manually
+            if (!cells[j]->IsFilled(fill)) {
+                iCorruptCells++;
+            }
+            cells[j]->RemoveRef();
+        }
+    }
+}
+
+
 // SuiteMsgAudioEncoded
 
 SuiteMsgAudioEncoded::SuiteMsgAudioEncoded()
@@ -1527,6 +1815,40 @@ void SuiteRamp::Test()
         prevSampleVal = sampleVal;
     }
 
+    // Check that 24/32-bit subsamples retain their full precision when ramped
+    ramp.Reset();
+    TEST(!ramp.Set(Ramp::kMax, kAudioDataSize, kAudioDataSize, Ramp::EDown, split, splitPos));
+    numSamples = applicator.Start(audioBuf, 24, 2);
+    applicator.GetNextSample(sample);
+    TInt64 expected = (((TInt64)0x7f7f7f00 * kRampArray[0]) >> 15) >> 8;
+    sampleVal = (sample[0]<<16) | (sample[1]<<8) | sample[2];
+    TEST(sampleVal == (TUint)expected);
+    TEST(sample[2] != 0);
+    numSamples = applicator.Start(audioBuf, 32, 2);
+    applicator.GetNextSample(sample);
+    expected = ((TInt64)0x7f7f7f7f * kRampArray[0]) >> 15;
+    sampleVal = (sample[0]<<24) | (sample[1]<<16) | (sample[2]<<8) | (sample[3]);
+    TEST(sampleVal == (TUint)expected);
+
+    // Check that applying a ramp in blocks matches applying it a sample at a time
+    ramp.Reset();
+    TEST(!ramp.Set(Ramp::kMax, kAudioDataSize, kAudioDataSize, Ramp::EDown, split, splitPos));
+    for (TUint bitDepth=8; bitDepth<=32; bitDepth+=8) {
+        const TUint bytesPerSample = (bitDepth/8) * 2;
+        TByte rampedBlock[kAudioDataSize];
+        numSamples = applicator.Start(audioBuf, bitDepth, 2);
+        TUint blockSamples = applicator.GetNextSamples(rampedBlock, 5);
+        TEST(blockSamples == 5);
+        blockSamples += applicator.GetNextSamples(rampedBlock + (blockSamples * bytesPerSample), numSamples);
+        TEST(blockSamples == numSamples);
+        TEST(applicator.GetNextSamples(rampedBlock, numSamples) == 0);
+        (void)applicator.Start(audioBuf, bitDepth, 2);
+        for (TUint i=0; i<numSamples; i++) {
+            applicator.GetNextSample(sample);
+            TEST(memcmp(sample, rampedBlock + (i * bytesPerSample), bytesPerSample) == 0);
+        }
+    }
+
     // Apply ramp [Min...Max].  Check start/end values and that subsequent values never fall
     ramp.Reset();
     TEST(!ramp.Set(Ramp::kMin, kAudioDataSize, kAudioDataSize, Ramp::EUp, split, splitPos));
@@ -1747,6 +2069,363 @@ void SuiteRamp::Test()
 }
 
 
+// SuiteRampApplicatorPerf
+
+SuiteRampApplicatorPerf::SuiteRampApplicatorPerf()
+    : Suite("RampApplicator throughput")
+    , iAudio(kSamplesPerMsg * DecodedAudio::kMaxNumChannels * 4)
+    , iRamped(kSamplesPerMsg * DecodedAudio::kMaxNumChannels * 4)
+{
+    // non-zero samples of varying sign, so no multiply can be skipped or predicted
+    for (TUint i=0; i<iAudio.MaxBytes(); i++) {
+        iAudio.Append((TByte)((i * 31) | 0x01));
+    }
+}
+
+void SuiteRampApplicatorPerf::Test()
+{
+    static const TUint kBitDepths[] = { 16, 24, 32 };
+    for (TUint bitDepth : kBitDepths) {
+        for (TUint numChannels=2; numChannels<=DecodedAudio::kMaxNumChannels; numChannels+=2) {
+            Benchmark(bitDepth, numChannels);
+        }
+    }
+}
+
+void SuiteRampApplicatorPerf::Benchmark(TUint aBitDepth, TUint aNumChannels)
+{
+    const TUint bytes = kSamplesPerMsg * aNumChannels * (aBitDepth/8);
+    Brn audio(iAudio.Ptr(), bytes);
+    Ramp ramp, split;
+    TUint splitPos;
+    (void)ramp.Set(Ramp::kMax, bytes, bytes, Ramp::EDown, split, splitPos);
+    RampApplicator applicator(ramp);
+
+    TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kIterations; i++) {
+        const TUint numSamples = applicator.Start(audio, aBitDepth, aNumChannels);
+        TEST(applicator.GetNextSamples(const_cast<TByte*>(iRamped.Ptr()), numSamples) == numSamples);
+    }
+    const TUint64 blockUs = std::max(Os::TimeInUs(gEnv->OsCtx()) - start, (TUint64)1);
+
+    // reference: the same work with the multiply stage forced to its scalar implementation
+    const TUint numSubsamples = kSamplesPerMsg * aNumChannels;
+    // multipliers are applied in place so restore non-zero input before each pass
+    std::vector<TInt32> source(numSubsamples);
+    for (TUint i=0; i<numSubsamples; i++) {
+        source[i] = (TInt32)((((i + 1) * 0x9E3779B1u) & 0xffffff00) | 0x100);
+    }
+    std::vector<TInt32> subsamples(numSubsamples);
+    std::vector<TInt32> multipliers(numSubsamples, (TInt32)kRampArray[kRampArrayCount/2]);
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kIterations; i++) {
+        std::copy(source.begin(), source.end(), subsamples.begin());
+        RampApplicator::ApplyMultipliersScalar(subsamples.data(), multipliers.data(), numSubsamples);
+    }
+    const TUint64 scalarUs = std::max(Os::TimeInUs(gEnv->OsCtx()) - start, (TUint64)1);
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kIterations; i++) {
+        std::copy(source.begin(), source.end(), subsamples.begin());
+        RampApplicator::ApplyMultipliers(subsamples.data(), multipliers.data(), numSubsamples);
+    }
+    const TUint64 vectorUs = std::max(Os::TimeInUs(gEnv->OsCtx()) - start, (TUint64)1);
+
+    const TUint64 totalSubsamples = (TUint64)numSubsamples * kIterations;
+    Log::Print("  %2u-bit, %u channels: ramp %6llu Ksubsamples/s (%llu KB/s); multiply scalar %llu vs vector %llu Ksubsamples/s\n",
+               aBitDepth, aNumChannels,
+               (totalSubsamples * 1000) / blockUs, ((TUint64)bytes * kIterations * 1000000) / (blockUs * 1024),
+               (totalSubsamples * 1000) / scalarUs, (totalSubsamples * 1000) / vectorUs);
+}
+
+
+// ProcessorInt32Test
+
+ProcessorInt32Test::ProcessorInt32Test()
+    : iNumFragments(0)
+    , iBitDepth(0)
+{
+}
+
+const std::vector<TInt32>& ProcessorInt32Test::Subsamples() const
+{
+    return iSubsamples;
+}
+
+TUint ProcessorInt32Test::NumFragments() const
+{
+    return iNumFragments;
+}
+
+TUint ProcessorInt32Test::BitDepth() const
+{
+    return iBitDepth;
+}
+
+TInt64 ProcessorInt32Test::Sum() const
+{
+    TInt64 sum = 0;
+    for (auto subsample : iSubsamples) {
+        sum += subsample;
+    }
+    return sum;
+}
+
+void ProcessorInt32Test::BeginBlock()
+{
+    iSubsamples.clear();
+    iNumFragments = 0;
+}
+
+void ProcessorInt32Test::ProcessFragment(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint aBitDepth)
+{
+    iSubsamples.insert(iSubsamples.end(), aSubsamples, aSubsamples + (aNumSamples * aNumChannels));
+    iNumFragments++;
+    iBitDepth = aBitDepth;
+}
+
+void ProcessorInt32Test::ProcessSilence(const TInt32* aSubsamples, TUint aNumSamples, TUint aNumChannels, TUint aBitDepth)
+{
+    ProcessFragment(aSubsamples, aNumSamples, aNumChannels, aBitDepth);
+}
+
+void ProcessorInt32Test::EndBlock()
+{
+}
+
+void ProcessorInt32Test::Flush()
+{
+}
+
+
+// ProcessorPcmSum
+
+void ProcessorPcmSum::ProcessFragment(const Brx& aData, TUint /*aNumChannels*/, TUint /*aSubsampleBytes*/)
+{
+    const TByte* ptr = aData.Ptr();
+    for (TUint i=0; i<aData.Bytes(); i++) {
+        iSum += ptr[i];
+    }
+}
+
+void ProcessorPcmSum::ProcessSilence(const Brx& aData, TUint aNumChannels, TUint aSubsampleBytes)
+{
+    ProcessFragment(aData, aNumChannels, aSubsampleBytes);
+}
+
+
+// SuitePcmStorage
+
+SuitePcmStorage::SuitePcmStorage()
+    : Suite("PcmStorage::PackedBigEndian vs PcmStorage::Int32")
+    , iData(kNumSamples * kNumChannels * 4)
+{
+    MsgFactoryInitParams init;
+    init.SetMsgAudioPcmCount(kMsgCount, kMsgCount);
+    init.SetMsgSilenceCount(kMsgCount);
+    init.SetMsgPlayableCount(kMsgCount, kMsgCount, kMsgCount);
+    iFactoryPacked = new MsgFactory(iInfoAggregator, init);
+    init.SetDecodedPcmStorage(PcmStorage::Int32);
+    iFactoryInt32 = new MsgFactory(iInfoAggregator, init);
+    for (TUint i=0; i<iData.MaxBytes(); i++) {
+        iData.Append((TByte)((i * 73) ^ (i >> 3)));
+    }
+}
+
+SuitePcmStorage::~SuitePcmStorage()
+{
+    delete iFactoryPacked;
+    delete iFactoryInt32;
+}
+
+void SuitePcmStorage::Test()
+{
+    TEST(iFactoryPacked->DecodedPcmStorage() == PcmStorage::PackedBigEndian);
+    TEST(iFactoryInt32->DecodedPcmStorage() == PcmStorage::Int32);
+    static const TUint kBitDepths[] = { 8, 16, 24, 32 };
+    for (TUint bitDepth : kBitDepths) {
+        TestReadsMatch(bitDepth);
+        TestRampsMatch(bitDepth);
+    }
+    TestSplit();
+    TestSilence();
+
+    Log::Print("  codec -> driver throughput (24-bit little endian, %u channels, 5ms msgs):\n", kNumChannels);
+    Benchmark(*iFactoryPacked, "PackedBigEndian");
+    Benchmark(*iFactoryInt32, "Int32");
+}
+
+std::vector<TInt32> SuitePcmStorage::Unpack(const Brx& aData, TUint aBitDepth)
+{ // static
+    const TUint subsampleBytes = aBitDepth / 8;
+    std::vector<TInt32> subsamples;
+    for (TUint i=0; i<aData.Bytes(); i+=subsampleBytes) {
+        TUint32 subsample = 0;
+        for (TUint j=0; j<subsampleBytes; j++) {
+            subsample = (subsample << 8) | aData[i+j];
+        }
+        subsamples.push_back((TInt32)(subsample << (32 - aBitDepth)));
+    }
+    return subsamples;
+}
+
+MsgPlayable* SuitePcmStorage::CreatePlayable(MsgFactory& aFactory, TUint aBitDepth, TBool aRamp)
+{
+    Brn data(iData.Ptr(), kNumSamples * kNumChannels * (aBitDepth/8));
+    MsgAudioPcm* audio = aFactory.CreateMsgAudioPcm(data, kNumChannels, 48000, aBitDepth, AudioDataEndian::Little, 0);
+    if (aRamp) {
+        TUint remaining = audio->Jiffies();
+        MsgAudio* split = nullptr;
+        (void)audio->SetRamp(Ramp::kMax, remaining, Ramp::EDown, split);
+        TEST(split == nullptr);
+    }
+    return audio->CreatePlayable();
+}
+
+void SuitePcmStorage::TestReadsMatch(TUint aBitDepth)
+{
+    ProcessorPcmBufTest packedReader;
+    MsgPlayable* playable = CreatePlayable(*iFactoryPacked, aBitDepth, false);
+    playable->Read(packedReader);
+    playable->RemoveRef();
+    const Brn expected(packedReader.Buf());
+    const std::vector<TInt32> expectedInt32 = Unpack(expected, aBitDepth);
+
+    ProcessorPcmBufTest int32Reader;
+    playable = CreatePlayable(*iFactoryInt32, aBitDepth, false);
+    TEST(playable->Bytes() == expected.Bytes());
+    playable->Read(int32Reader);
+    playable->RemoveRef();
+    TEST(int32Reader.Buf() == expected);
+
+    ProcessorInt32Test subsampleReader;
+    playable = CreatePlayable(*iFactoryPacked, aBitDepth, false);
+    playable->Read(subsampleReader);
+    playable->RemoveRef();
+    TEST(subsampleReader.BitDepth() == aBitDepth);
+    TEST(subsampleReader.Subsamples() == expectedInt32);
+
+    playable = CreatePlayable(*iFactoryInt32, aBitDepth, false);
+    playable->Read(subsampleReader);
+    playable->RemoveRef();
+    TEST(subsampleReader.NumFragments() == 1); // storage passed on without copying
+    TEST(subsampleReader.Subsamples() == expectedInt32);
+}
+
+void SuitePcmStorage::TestRampsMatch(TUint aBitDepth)
+{
+    ProcessorPcmBufTest packedReader;
+    MsgPlayable* playable = CreatePlayable(*iFactoryPacked, aBitDepth, true);
+    playable->Read(packedReader);
+    playable->RemoveRef();
+    const Brn expected(packedReader.Buf());
+
+    ProcessorPcmBufTest int32Reader;
+    playable = CreatePlayable(*iFactoryInt32, aBitDepth, true);
+    playable->Read(int32Reader);
+    playable->RemoveRef();
+    TEST(int32Reader.Buf() == expected);
+
+    /* IPcmProcessorInt32 is passed bits below aBitDepth that packing would discard.
+       Check that the significant bits match packed output and that both storage
+       formats produce identical subsamples. */
+    const std::vector<TInt32> expectedInt32 = Unpack(expected, aBitDepth);
+    const TUint32 mask = (aBitDepth == 32? 0xffffffff : ~((1u << (32 - aBitDepth)) - 1));
+    ProcessorInt32Test subsampleReader;
+    playable = CreatePlayable(*iFactoryPacked, aBitDepth, true);
+    playable->Read(subsampleReader);
+    playable->RemoveRef();
+    const std::vector<TInt32> fromPacked = subsampleReader.Subsamples();
+    TEST(fromPacked.size() == expectedInt32.size());
+    for (TUint i=0; i<fromPacked.size() && i<expectedInt32.size(); i++) {
+        TEST(((TUint32)fromPacked[i] & mask) == (TUint32)expectedInt32[i]);
+    }
+    playable = CreatePlayable(*iFactoryInt32, aBitDepth, true);
+    playable->Read(subsampleReader);
+    playable->RemoveRef();
+    TEST(subsampleReader.Subsamples() == fromPacked);
+}
+
+void SuitePcmStorage::TestSplit()
+{
+    static const TUint kBitDepth = 24;
+    ProcessorPcmBufTest packedReader;
+    MsgPlayable* playable = CreatePlayable(*iFactoryPacked, kBitDepth, false);
+    playable->Read(packedReader);
+    playable->RemoveRef();
+    Bwh expected(packedReader.Buf().Bytes());
+    expected.Replace(packedReader.Buf());
+
+    // split both the MsgAudioPcm and the MsgPlayable; recombined output should match unsplit audio
+    Brn data(iData.Ptr(), kNumSamples * kNumChannels * (kBitDepth/8));
+    MsgAudioPcm* audio = iFactoryInt32->CreateMsgAudioPcm(data, kNumChannels, 48000, kBitDepth, AudioDataEndian::Little, 0);
+    TEST(audio->StorageBitDepth() == 32);
+    MsgAudio* remainingAudio = audio->Split(audio->Jiffies() / 3);
+    TEST(static_cast<MsgAudioPcm*>(remainingAudio)->StorageBitDepth() == 32);
+    playable = audio->CreatePlayable();
+    MsgPlayable* remainingPlayable = remainingAudio->CreatePlayable();
+    MsgPlayable* remainingPlayable2 = remainingPlayable->Split(remainingPlayable->Bytes() / 2);
+    Bwh output(expected.Bytes());
+    ProcessorPcmBufTest reader;
+    MsgPlayable* playables[] = { playable, remainingPlayable, remainingPlayable2 };
+    for (auto p : playables) {
+        TEST(p != nullptr);
+        p->Read(reader);
+        p->RemoveRef();
+        output.Append(reader.Buf());
+    }
+    TEST(output == expected);
+}
+
+void SuitePcmStorage::TestSilence()
+{
+    TUint jiffies = Jiffies::kPerMs * 5;
+    MsgSilence* silence = iFactoryInt32->CreateMsgSilence(jiffies, 48000, 24, kNumChannels);
+    MsgPlayable* playable = silence->CreatePlayable();
+    ProcessorInt32Test reader;
+    playable->Read(reader);
+    playable->RemoveRef();
+    TEST(reader.Subsamples().size() == 240 * kNumChannels);
+    TEST(reader.Sum() == 0);
+}
+
+void SuitePcmStorage::Benchmark(MsgFactory& aFactory, const TChar* aStorage)
+{
+    static const TUint kBitDepth = 24;
+    static const TUint kSamples = kPerfSampleRate / 200; // 5ms
+    Bwh data(kSamples * kNumChannels * (kBitDepth/8));
+    for (TUint i=0; i<data.MaxBytes(); i++) {
+        data.Append((TByte)(i * 31));
+    }
+
+    ProcessorPcmSum packedProcessor;
+    TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kPerfIterations; i++) {
+        MsgAudioPcm* audio = aFactory.CreateMsgAudioPcm(data, kNumChannels, kPerfSampleRate, kBitDepth, AudioDataEndian::Little, 0);
+        MsgPlayable* playable = audio->CreatePlayable();
+        playable->Read(packedProcessor);
+        playable->RemoveRef();
+    }
+    const TUint64 packedUs = std::max(Os::TimeInUs(gEnv->OsCtx()) - start, (TUint64)1);
+
+    ProcessorInt32Test int32Processor;
+    TInt64 sum = 0;
+    start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kPerfIterations; i++) {
+        MsgAudioPcm* audio = aFactory.CreateMsgAudioPcm(data, kNumChannels, kPerfSampleRate, kBitDepth, AudioDataEndian::Little, 0);
+        MsgPlayable* playable = audio->CreatePlayable();
+        playable->Read(int32Processor);
+        playable->RemoveRef();
+        sum += int32Processor.Sum();
+    }
+    const TUint64 int32Us = std::max(Os::TimeInUs(gEnv->OsCtx()) - start, (TUint64)1);
+
+    const TUint64 totalSamples = (TUint64)kSamples * kPerfIterations;
+    Log::Print("    %-16s IPcmProcessor %7llu Ksamples/s, IPcmProcessorInt32 %7llu Ksamples/s (checksums %llu, %lld)\n",
+               aStorage, (totalSamples * 1000) / packedUs, (totalSamples * 1000) / int32Us,
+               packedProcessor.Sum(), sum);
+}
+
+
 // SuiteMsgAudioDsd
 
 SuiteMsgAudioDsd::SuiteMsgAudioDsd()
@@ -3124,6 +3803,189 @@ void SuiteMsgQueueLite::Test()
 }
 
 
+// SuiteMsgQueueSpsc
+
+SuiteMsgQueueSpsc::SuiteMsgQueueSpsc()
+    : Suite("MsgQueueSpsc tests")
+    , iQueueSpsc(nullptr)
+    , iQueueLocked(nullptr)
+{
+    MsgFactoryInitParams init;
+    init.SetMsgFlushCount(kNumFlushes);
+    init.SetMsgHaltCount(64);
+    iMsgFactory = new MsgFactory(iInfoAggregator, init);
+    iTrackFactory = new TrackFactory(iInfoAggregator, 1);
+}
+
+SuiteMsgQueueSpsc::~SuiteMsgQueueSpsc()
+{
+    delete iMsgFactory;
+    delete iTrackFactory;
+}
+
+void SuiteMsgQueueSpsc::Test()
+{
+    TestFifo();
+    TestEnqueueAtHead();
+    TestClear();
+    TestProducerBlocksWhenFull();
+    TestContention();
+}
+
+void SuiteMsgQueueSpsc::TestFifo()
+{
+    MsgQueueSpsc queue;
+    TEST(queue.IsEmpty());
+    TEST(queue.NumMsgs() == 0);
+
+    Track* track = iTrackFactory->CreateTrack(Brx::Empty(), Brx::Empty());
+    queue.Enqueue(iMsgFactory->CreateMsgTrack(*track));
+    track->RemoveRef();
+    queue.Enqueue(iMsgFactory->CreateMsgMetaText(Brn("Test metatext")));
+    queue.Enqueue(iMsgFactory->CreateMsgHalt());
+    queue.Enqueue(iMsgFactory->CreateMsgWait());
+    queue.Enqueue(iMsgFactory->CreateMsgQuit());
+    TEST(!queue.IsEmpty());
+    TEST(queue.NumMsgs() == 5);
+
+    const ProcessorMsgType::EMsgType expected[] = { ProcessorMsgType::EMsgTrack, ProcessorMsgType::EMsgMetaText,
+                                                    ProcessorMsgType::EMsgHalt, ProcessorMsgType::EMsgWait,
+                                                    ProcessorMsgType::EMsgQuit };
+    ProcessorMsgType processor;
+    for (TUint i=0; i<sizeof(expected)/sizeof(expected[0]); i++) {
+        Msg* msg = queue.Dequeue();
+        msg->Process(processor);
+        TEST(processor.LastMsgType() == expected[i]);
+        msg->RemoveRef();
+    }
+    TEST(queue.IsEmpty());
+    TEST(queue.NumMsgs() == 0);
+}
+
+void SuiteMsgQueueSpsc::TestEnqueueAtHead()
+{
+    MsgQueueSpsc queue;
+    queue.Enqueue(iMsgFactory->CreateMsgMetaText(Brn("blah")));
+    queue.Enqueue(iMsgFactory->CreateMsgHalt());
+    ProcessorMsgType processor;
+
+    // a dequeued msg can be pushed back and is then read before other queued msgs
+    Msg* msg = queue.Dequeue();
+    queue.EnqueueAtHead(msg);
+    queue.EnqueueAtHead(iMsgFactory->CreateMsgFlush(1));
+    TEST(queue.NumMsgs() == 3);
+    msg = queue.Dequeue();
+    msg->Process(processor);
+    TEST(processor.LastMsgType() == ProcessorMsgType::EMsgFlush);
+    msg->RemoveRef();
+    msg = queue.Dequeue();
+    msg->Process(processor);
+    TEST(processor.LastMsgType() == ProcessorMsgType::EMsgMetaText);
+    msg->RemoveRef();
+    msg = queue.Dequeue();
+    msg->Process(processor);
+    TEST(processor.LastMsgType() == ProcessorMsgType::EMsgHalt);
+    msg->RemoveRef();
+    TEST(queue.IsEmpty());
+
+    // EnqueueAtHead on an empty queue
+    queue.EnqueueAtHead(iMsgFactory->CreateMsgWait());
+    TEST(!queue.IsEmpty());
+    TEST(queue.NumMsgs() == 1);
+    msg = queue.Dequeue();
+    msg->Process(processor);
+    TEST(processor.LastMsgType() == ProcessorMsgType::EMsgWait);
+    msg->RemoveRef();
+    TEST(queue.IsEmpty());
+}
+
+void SuiteMsgQueueSpsc::TestClear()
+{
+    MsgQueueSpsc queue(kSmallCapacity);
+    queue.Enqueue(iMsgFactory->CreateMsgHalt());
+    queue.Enqueue(iMsgFactory->CreateMsgWait());
+    queue.EnqueueAtHead(iMsgFactory->CreateMsgFlush(1));
+    TEST(queue.NumMsgs() == 3);
+    queue.Clear();
+    TEST(queue.IsEmpty());
+    TEST(queue.NumMsgs() == 0);
+
+    // remaining msgs are released when the queue is deleted
+    MsgQueueSpsc* queue2 = new MsgQueueSpsc(kSmallCapacity);
+    queue2->Enqueue(iMsgFactory->CreateMsgHalt());
+    queue2->EnqueueAtHead(iMsgFactory->CreateMsgWait());
+    delete queue2;
+}
+
+void SuiteMsgQueueSpsc::TestProducerBlocksWhenFull()
+{
+    // a producer of more msgs than the ring holds blocks until the consumer catches up
+    // Wraps the ring several times; order is preserved throughout
+    iQueueSpsc = new MsgQueueSpsc(kSmallCapacity);
+    ThreadFunctor* producer = new ThreadFunctor("SpscProducer", MakeFunctor(*this, &SuiteMsgQueueSpsc::FlushProducer));
+    producer->Start();
+    for (TUint i=0; i<kNumFlushes; i++) {
+        TEST(iQueueSpsc->NumMsgs() <= kSmallCapacity);
+        MsgFlush* msg = static_cast<MsgFlush*>(iQueueSpsc->Dequeue());
+        TEST(msg->Id() == i + 1);
+        msg->RemoveRef();
+    }
+    delete producer;
+    TEST(iQueueSpsc->IsEmpty());
+    delete iQueueSpsc;
+    iQueueSpsc = nullptr;
+}
+
+void SuiteMsgQueueSpsc::TestContention()
+{
+    // hand off msgs between a producer and consumer thread, comparing against the locked MsgQueue
+    TUint64 us[2];
+    for (TUint i=0; i<2; i++) {
+        if (i == 0) {
+            iQueueLocked = new MsgQueue();
+        }
+        else {
+            iQueueSpsc = new MsgQueueSpsc();
+        }
+        ThreadFunctor* producer = new ThreadFunctor("SpscBenchmark", MakeFunctor(*this, &SuiteMsgQueueSpsc::BenchmarkProducer));
+        const TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+        producer->Start();
+        for (TUint j=0; j<kNumBenchmarkMsgs; j++) {
+            Msg* msg = (iQueueSpsc != nullptr? iQueueSpsc->Dequeue() : iQueueLocked->Dequeue());
+            msg->RemoveRef();
+        }
+        us[i] = std::max(Os::TimeInUs(gEnv->OsCtx()) - start, (TUint64)1);
+        delete producer;
+        delete iQueueLocked;
+        iQueueLocked = nullptr;
+        delete iQueueSpsc;
+        iQueueSpsc = nullptr;
+    }
+    Log::Print("  %u msgs: MsgQueue %llu Kmsgs/s, MsgQueueSpsc %llu Kmsgs/s\n", kNumBenchmarkMsgs,
+               ((TUint64)kNumBenchmarkMsgs * 1000) / us[0], ((TUint64)kNumBenchmarkMsgs * 1000) / us[1]);
+}
+
+void SuiteMsgQueueSpsc::FlushProducer()
+{
+    for (TUint i=0; i<kNumFlushes; i++) {
+        iQueueSpsc->Enqueue(iMsgFactory->CreateMsgFlush(i + 1));
+    }
+}
+
+void SuiteMsgQueueSpsc::BenchmarkProducer()
+{
+    for (TUint i=0; i<kNumBenchmarkMsgs; i++) {
+        Msg* msg = iMsgFactory->CreateMsgHalt();
+        if (iQueueSpsc != nullptr) {
+            iQueueSpsc->Enqueue(msg);
+        }
+        else {
+            iQueueLocked->Enqueue(msg);
+        }
+    }
+}
+
+
 // SuiteMsgReservoir
 
 SuiteMsgReservoir::SuiteMsgReservoir()
@@ -3692,8 +4554,11 @@ void TestMsg()
 {
     Runner runner("Basic Msg tests\n");
     runner.Add(new SuiteAllocator());
+    runner.Add(new SuiteAllocatorElastic());
+    runner.Add(new SuiteAllocatorContention());
     runner.Add(new SuiteMsgAudioEncoded());
     runner.Add(new SuiteRamp());
+    runner.Add(new SuitePcmStorage());
     runner.Add(new SuiteMsgAudio());
     runner.Add(new SuiteMsgPlayable());
     runner.Add(new SuiteMsgAudioDsd());
@@ -3708,7 +4573,15 @@ void TestMsg()
     runner.Add(new SuiteMsgProcessor());
     runner.Add(new SuiteMsgQueue());
     runner.Add(new SuiteMsgQueueLite());
+    runner.Add(new SuiteMsgQueueSpsc());
     runner.Add(new SuiteMsgReservoir());
     runner.Add(new SuitePipelineElement());
     runner.Run();
 }
+
+void TestMsgBenchmark()
+{
+    Runner runner("Msg benchmark\n");
+    runner.Add(new SuiteRampApplicatorPerf());
+    runner.Run();
+}
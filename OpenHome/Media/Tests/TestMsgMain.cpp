@@ -1,15 +1,29 @@
 #include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/OptionParser.h>
 
 using namespace OpenHome;
 using namespace OpenHome::TestFramework;
 
 extern void TestMsg();
+extern void TestMsgBenchmark();
 
-void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
 {
+    OptionParser parser;
+    OptionBool optionBenchmark("-b", "--benchmark", "Measure ramp throughput at each bit depth and channel count");
+    parser.AddOption(&optionBenchmark);
+    if (!parser.Parse(aArgc, aArgv)) {
+        delete aInitParams;
+        return;
+    }
+
     Net::UpnpLibrary::InitialiseMinimal(aInitParams);
-    TestMsg();
+    if (optionBenchmark.Value()) {
+        TestMsgBenchmark();
+    }
+    else {
+        TestMsg();
+    }
     delete aInitParams;
     Net::UpnpLibrary::Close();
 }
-
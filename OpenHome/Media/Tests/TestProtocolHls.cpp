@@ -5,6 +5,7 @@
 #include <OpenHome/Media/Utils/AllocatorInfoLogger.h>
 #include <OpenHome/Net/Private/Globals.h>
 #include <OpenHome/OsWrapper.h>
+#include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Network.h>
 #include <OpenHome/Private/Printer.h>
 #include <OpenHome/Private/Stream.h>
@@ -14,6 +15,7 @@
 #include <OpenHome/Tests/Mock.h>
 
 #include <limits>
+#include <vector>
 
 namespace OpenHome {
 namespace Media {
@@ -196,6 +198,85 @@ private:
     SegmentStreamer* iStreamer;
 };
 
+class MockSegmentUriProvider : public ISegmentUriProvider
+{
+public:
+    MockSegmentUriProvider();
+    void QueueSegmentUri(const Brn aUri);
+    void SetStreamEnd();
+    void SetLatencyMs(TUint aLatencyMs); // delay (not interruptible) after a uri has been taken, before it is returned
+    TUint UrisProvided() const;
+public: // from ISegmentUriProvider
+    TUint NextSegmentUri(Uri& aUri) override;
+    void InterruptSegmentUriProvider(TBool aInterrupt) override;
+private:
+    mutable Mutex iLock;
+    std::vector<Brn> iUris;
+    TUint iIndex;
+    TBool iStreamEnd;
+    TBool iInterrupted;
+    TUint iLatencyMs;
+};
+
+// Simulates a server with a fixed per-request latency.  Records peak number of concurrent requests.
+class MockSlowSegmentServer
+{
+public:
+    MockSlowSegmentServer(TUint aLatencyMs);
+    void AddSegment(const Brn aUri, const Brn aContent);
+    Brn Request(const Uri& aUri); // THROWS UriLoaderError
+    TUint PeakConcurrentRequests() const;
+private:
+    mutable Mutex iLock;
+    const TUint iLatencyMs;
+    std::vector<std::pair<Brn, Brn>> iSegments;
+    TUint iConcurrentRequests;
+    TUint iPeakConcurrentRequests;
+};
+
+class MockUriLoader : public IUriLoader
+{
+public:
+    MockUriLoader(MockSlowSegmentServer& aServer);
+public: // from IUriLoader
+    IReader& Load(const Uri& aUri) override;
+    void Reset() override;
+    void Interrupt(TBool aInterrupt) override;
+private:
+    MockSlowSegmentServer& iServer;
+    ReaderBuffer iReader;
+    TBool iInterrupted;
+};
+
+class SuiteHlsSegmentPrefetcher : public OpenHome::TestFramework::SuiteUnitTest
+{
+    static const TUint kLookahead = 3;
+    static const TUint kLatencyMs = 50;
+    static const TUint kBufferBytes = 64;
+public:
+    SuiteHlsSegmentPrefetcher();
+public: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void ReadSegment(Bwx& aBuf, TUint aReadBytes);
+    void WaitForUrisProvided(TUint aCount);
+    void TestSegmentsInOrder();
+    void TestFetchesConcurrently();
+    void TestSegmentLargerThanBuffer();
+    void TestLoadError();
+    void TestEndOfStream();
+    void TestInterrupt();
+    void TestResetReportsDiscarded();
+    void TestResetDuringUriFetch();
+private:
+    MockSlowSegmentServer* iServer;
+    MockSegmentUriProvider* iUriProvider;
+    std::vector<IUriLoader*> iLoaders;
+    SegmentPrefetcher* iPrefetcher;
+    SegmentStreamer* iStreamer;
+};
+
 } // namespace Test
 } // namespace Media
 } // namespace OpenHome
@@ -1743,6 +1824,358 @@ void SuiteHlsSegmentStreamer::TestEndOfStreamReadMoreThan()
     TEST_THROWS(iStreamer->Read(28), ReaderError);
 }
 
+// MockSegmentUriProvider
+
+MockSegmentUriProvider::MockSegmentUriProvider()
+    : iLock("MSUP")
+    , iIndex(0)
+    , iStreamEnd(false)
+    , iInterrupted(false)
+    , iLatencyMs(0)
+{
+}
+
+void MockSegmentUriProvider::QueueSegmentUri(const Brn aUri)
+{
+    AutoMutex _(iLock);
+    iUris.push_back(aUri);
+}
+
+void MockSegmentUriProvider::SetStreamEnd()
+{
+    AutoMutex _(iLock);
+    iStreamEnd = true;
+}
+
+void MockSegmentUriProvider::SetLatencyMs(TUint aLatencyMs)
+{
+    AutoMutex _(iLock);
+    iLatencyMs = aLatencyMs;
+}
+
+TUint MockSegmentUriProvider::UrisProvided() const
+{
+    AutoMutex _(iLock);
+    return iIndex;
+}
+
+TUint MockSegmentUriProvider::NextSegmentUri(Uri& aUri)
+{
+    TUint latencyMs;
+    {
+        AutoMutex _(iLock);
+        if (iInterrupted) {
+            THROW(HlsSegmentUriError);
+        }
+        if (iIndex >= iUris.size()) {
+            if (iStreamEnd) {
+                THROW(HlsEndOfStream);
+            }
+            THROW(HlsSegmentUriError);
+        }
+        aUri.Replace(iUris[iIndex++]);
+        latencyMs = iLatencyMs;
+    }
+    if (latencyMs > 0) {
+        Thread::Sleep(latencyMs);
+    }
+    return 1000;
+}
+
+void MockSegmentUriProvider::InterruptSegmentUriProvider(TBool aInterrupt)
+{
+    AutoMutex _(iLock);
+    iInterrupted = aInterrupt;
+}
+
+
+// MockSlowSegmentServer
+
+MockSlowSegmentServer::MockSlowSegmentServer(TUint aLatencyMs)
+    : iLock("MSSS")
+    , iLatencyMs(aLatencyMs)
+    , iConcurrentRequests(0)
+    , iPeakConcurrentRequests(0)
+{
+}
+
+void MockSlowSegmentServer::AddSegment(const Brn aUri, const Brn aContent)
+{
+    AutoMutex _(iLock);
+    iSegments.push_back(std::pair<Brn, Brn>(aUri, aContent));
+}
+
+Brn MockSlowSegmentServer::Request(const Uri& aUri)
+{
+    {
+        AutoMutex _(iLock);
+        iConcurrentRequests++;
+        if (iConcurrentRequests > iPeakConcurrentRequests) {
+            iPeakConcurrentRequests = iConcurrentRequests;
+        }
+    }
+    Thread::Sleep(iLatencyMs);
+    AutoMutex _(iLock);
+    iConcurrentRequests--;
+    for (const auto& segment : iSegments) {
+        if (segment.first == aUri.AbsoluteUri()) {
+            return segment.second;
+        }
+    }
+    THROW(UriLoaderError);
+}
+
+TUint MockSlowSegmentServer::PeakConcurrentRequests() const
+{
+    AutoMutex _(iLock);
+    return iPeakConcurrentRequests;
+}
+
+
+// MockUriLoader
+
+MockUriLoader::MockUriLoader(MockSlowSegmentServer& aServer)
+    : iServer(aServer)
+    , iInterrupted(false)
+{
+}
+
+IReader& MockUriLoader::Load(const Uri& aUri)
+{
+    if (iInterrupted) {
+        THROW(UriLoaderError);
+    }
+    iReader.Set(iServer.Request(aUri));
+    return iReader;
+}
+
+void MockUriLoader::Reset()
+{
+}
+
+void MockUriLoader::Interrupt(TBool aInterrupt)
+{
+    iInterrupted = aInterrupt;
+    if (aInterrupt) {
+        iReader.ReadInterrupt();
+    }
+}
+
+
+// SuiteHlsSegmentPrefetcher
+
+SuiteHlsSegmentPrefetcher::SuiteHlsSegmentPrefetcher()
+    : SuiteUnitTest("SuiteHlsSegmentPrefetcher")
+{
+    AddTest(MakeFunctor(*this, &SuiteHlsSegmentPrefetcher::TestSegmentsInOrder), "TestSegmentsInOrder");
+    AddTest(MakeFunctor(*this, &SuiteHlsSegmentPrefetcher::TestFetchesConcurrently), "TestFetchesConcurrently");
+    AddTest(MakeFunctor(*this, &SuiteHlsSegmentPrefetcher::TestSegmentLargerThanBuffer), "TestSegmentLargerThanBuffer");
+    AddTest(MakeFunctor(*this, &SuiteHlsSegmentPrefetcher::TestLoadError), "TestLoadError");
+    AddTest(MakeFunctor(*this, &SuiteHlsSegmentPrefetcher::TestEndOfStream), "TestEndOfStream");
+    AddTest(MakeFunctor(*this, &SuiteHlsSegmentPrefetcher::TestInterrupt), "TestInterrupt");
+    AddTest(MakeFunctor(*this, &SuiteHlsSegmentPrefetcher::TestResetReportsDiscarded), "TestResetReportsDiscarded");
+    AddTest(MakeFunctor(*this, &SuiteHlsSegmentPrefetcher::TestResetDuringUriFetch), "TestResetDuringUriFetch");
+}
+
+void SuiteHlsSegmentPrefetcher::Setup()
+{
+    iServer = new MockSlowSegmentServer(kLatencyMs);
+    iUriProvider = new MockSegmentUriProvider();
+    for (TUint i=0; i<kLookahead; i++) {
+        iLoaders.push_back(new MockUriLoader(*iServer));
+    }
+    iPrefetcher = new SegmentPrefetcher(*iUriProvider, iLoaders, kBufferBytes);
+    iStreamer = new SegmentStreamer(*iPrefetcher);
+}
+
+void SuiteHlsSegmentPrefetcher::TearDown()
+{
+    delete iStreamer;
+    delete iPrefetcher;
+    for (auto loader : iLoaders) {
+        delete loader;
+    }
+    iLoaders.clear();
+    delete iUriProvider;
+    delete iServer;
+}
+
+void SuiteHlsSegmentPrefetcher::ReadSegment(Bwx& aBuf, TUint aReadBytes)
+{
+    // Mimics ProtocolHls::OutputAudio(), which resets streamer at end of each segment.
+    for (;;) {
+        auto buf = iStreamer->Read(aReadBytes);
+        if (buf.Bytes() == 0) {
+            break;
+        }
+        aBuf.Append(buf);
+    }
+    iStreamer->Reset();
+}
+
+void SuiteHlsSegmentPrefetcher::WaitForUrisProvided(TUint aCount)
+{
+    for (TUint i=0; i<200 && iUriProvider->UrisProvided() < aCount; i++) {
+        Thread::Sleep(10);
+    }
+}
+
+void SuiteHlsSegmentPrefetcher::TestSegmentsInOrder()
+{
+    const Brn kUris[] = { Brn("http://host/s0.ts"), Brn("http://host/s1.ts"), Brn("http://host/s2.ts"), Brn("http://host/s3.ts"), Brn("http://host/s4.ts") };
+    const Brn kContent[] = { Brn("00000000"), Brn("1111"), Brn("222222222222"), Brn("3"), Brn("4444444444") };
+    for (TUint i=0; i<5; i++) {
+        iServer->AddSegment(kUris[i], kContent[i]);
+        iUriProvider->QueueSegmentUri(kUris[i]);
+    }
+    iUriProvider->SetStreamEnd();
+
+    for (TUint i=0; i<5; i++) {
+        Bws<32> buf;
+        ReadSegment(buf, 5);
+        TEST(buf == kContent[i]);
+    }
+}
+
+void SuiteHlsSegmentPrefetcher::TestFetchesConcurrently()
+{
+    static const TUint kSegments = 6;
+    Bws<32> uris[kSegments];
+    for (TUint i=0; i<kSegments; i++) {
+        uris[i].Replace("http://host/seg");
+        Ascii::AppendDec(uris[i], i);
+        iServer->AddSegment(Brn(uris[i]), Brn("0123456789"));
+        iUriProvider->QueueSegmentUri(Brn(uris[i]));
+    }
+    iUriProvider->SetStreamEnd();
+
+    const TUint64 start = Os::TimeInMs(gEnv->OsCtx());
+    for (TUint i=0; i<kSegments; i++) {
+        Bws<16> buf;
+        ReadSegment(buf, 16);
+        TEST(buf == Brn("0123456789"));
+    }
+    const TUint elapsedMs = static_cast<TUint>(Os::TimeInMs(gEnv->OsCtx()) - start);
+
+    // Fetching in series would take at least kSegments * kLatencyMs.
+    TEST(iServer->PeakConcurrentRequests() > 1);
+    TEST(iServer->PeakConcurrentRequests() <= kLookahead);
+    Print("SuiteHlsSegmentPrefetcher: %u segments with %ums latency read in %ums (serial fetch >= %ums)\n",
+          kSegments, kLatencyMs, elapsedMs, kSegments * kLatencyMs);
+}
+
+void SuiteHlsSegmentPrefetcher::TestSegmentLargerThanBuffer()
+{
+    Bwh content(kBufferBytes * 10 + 3);
+    for (TUint i=0; i<content.MaxBytes(); i++) {
+        content.Append(static_cast<TByte>('a' + (i % 26)));
+    }
+    iServer->AddSegment(Brn("http://host/big.ts"), Brn(content));
+    iUriProvider->QueueSegmentUri(Brn("http://host/big.ts"));
+    iUriProvider->SetStreamEnd();
+
+    Bwh buf(content.Bytes());
+    ReadSegment(buf, 7); // odd read size so reads straddle wrap point in ring buffer
+    TEST(buf == content);
+}
+
+void SuiteHlsSegmentPrefetcher::TestLoadError()
+{
+    iServer->AddSegment(Brn("http://host/s0.ts"), Brn("000"));
+    iUriProvider->QueueSegmentUri(Brn("http://host/s0.ts"));
+    iUriProvider->QueueSegmentUri(Brn("http://host/missing.ts"));
+    iUriProvider->SetStreamEnd();
+
+    Bws<8> buf;
+    ReadSegment(buf, 8);
+    TEST(buf == Brn("000"));
+    TEST_THROWS(iStreamer->Read(8), ReaderError);
+    TEST(iStreamer->Error());
+}
+
+void SuiteHlsSegmentPrefetcher::TestEndOfStream()
+{
+    iServer->AddSegment(Brn("http://host/s0.ts"), Brn("000"));
+    iUriProvider->QueueSegmentUri(Brn("http://host/s0.ts"));
+    iUriProvider->SetStreamEnd();
+
+    Bws<8> buf;
+    ReadSegment(buf, 8);
+    TEST(buf == Brn("000"));
+    auto eos = iStreamer->Read(8);
+    TEST(eos.Bytes() == 0);
+    TEST(!iStreamer->Error());
+    TEST_THROWS(iStreamer->Read(8), ReaderError);
+}
+
+void SuiteHlsSegmentPrefetcher::TestInterrupt()
+{
+    iServer->AddSegment(Brn("http://host/s0.ts"), Brn("000"));
+    iUriProvider->QueueSegmentUri(Brn("http://host/s0.ts"));
+    iUriProvider->SetStreamEnd();
+
+    iStreamer->Interrupt(true);
+    TEST_THROWS(iStreamer->Read(8), ReaderError);
+    iStreamer->Interrupt(false);
+    iPrefetcher->Reset();
+}
+
+void SuiteHlsSegmentPrefetcher::TestResetReportsDiscarded()
+{
+    const Brn kUris[] = { Brn("http://host/s0.ts"), Brn("http://host/s1.ts"), Brn("http://host/s2.ts"), Brn("http://host/s3.ts"), Brn("http://host/s4.ts") };
+    const Brn kContent[] = { Brn("000"), Brn("111"), Brn("222"), Brn("333"), Brn("444") };
+    for (TUint i=0; i<5; i++) {
+        iServer->AddSegment(kUris[i], kContent[i]);
+        iUriProvider->QueueSegmentUri(kUris[i]);
+    }
+    iUriProvider->SetStreamEnd();
+
+    Bws<8> buf;
+    ReadSegment(buf, 8);
+    TEST(buf == kContent[0]);
+    // Slot holding first segment is only freed on next NextSegment() call, so other slots prefetch the following 2.
+    WaitForUrisProvided(kLookahead);
+    TEST(iUriProvider->UrisProvided() == kLookahead);
+
+    iPrefetcher->Reset();
+    TEST(iPrefetcher->SegmentsDiscarded() == kLookahead - 1);
+
+    // Fetching resumes from next URI the provider hands out.
+    buf.SetBytes(0);
+    ReadSegment(buf, 8);
+    TEST(buf == kContent[kLookahead]);
+}
+
+void SuiteHlsSegmentPrefetcher::TestResetDuringUriFetch()
+{
+    const Brn kUris[] = { Brn("http://host/s0.ts"), Brn("http://host/s1.ts"), Brn("http://host/s2.ts"), Brn("http://host/s3.ts"), Brn("http://host/s4.ts") };
+    const Brn kContent[] = { Brn("000"), Brn("111"), Brn("222"), Brn("333"), Brn("444") };
+    for (TUint i=0; i<5; i++) {
+        iServer->AddSegment(kUris[i], kContent[i]);
+        iUriProvider->QueueSegmentUri(kUris[i]);
+    }
+    iUriProvider->SetStreamEnd();
+    iUriProvider->SetLatencyMs(kLatencyMs);
+
+    Bws<8> buf;
+    ReadSegment(buf, 8);
+    TEST(buf == kContent[0]);
+    // Reset while a NextSegmentUri() call is likely to have taken a uri but not yet returned.
+    // That uri must still be reported as discarded.
+    WaitForUrisProvided(2);
+    iPrefetcher->Reset();
+    const TUint provided = iUriProvider->UrisProvided();
+    TEST(iPrefetcher->SegmentsDiscarded() == provided - 1);
+
+    if (provided < 5) {
+        iUriProvider->SetLatencyMs(0);
+        buf.SetBytes(0);
+        ReadSegment(buf, 8);
+        TEST(buf == kContent[provided]);
+    }
+}
+
+
 
 
 void TestProtocolHls(Environment& /*aEnv*/)
@@ -1752,5 +2185,6 @@ void TestProtocolHls(Environment& /*aEnv*/)
     runner.Add(new SuiteHlsPlaylistParser());
     runner.Add(new SuiteHlsM3uReader());
     runner.Add(new SuiteHlsSegmentStreamer());
+    runner.Add(new SuiteHlsSegmentPrefetcher());
     runner.Run();
 }
@@ -164,6 +164,16 @@ private:
     EMode iMode;
 };
 
+class TestHttpSessionKeepAlive : public TestHttpSession
+{
+public:
+    TestHttpSessionKeepAlive();
+private: // from TestHttpSession
+    void Respond();
+private: // from SocketTcpSession
+    void Run();
+};
+
 class TestHttpSessionSeek : public SocketTcpSession
 {
 public:
@@ -222,7 +232,8 @@ public:
         eReconnect        = 2,
         eStreamLive       = 3,
         eLiveReconnect    = 4,
-        eChunked          = 5
+        eChunked          = 5,
+        eKeepAlive        = 6
     };
 public:
     static TestHttpSession* Create(ESession aSession);
@@ -396,6 +407,14 @@ private: // from SuiteHttp
     void Test();
 };
 
+class SuiteHttpKeepAlive : public SuiteHttpStreamBase
+{
+public:
+    SuiteHttpKeepAlive();
+private: // from SuiteHttp
+    void Test();
+};
+
 class SuiteHttpChunked : public Suite
 {
 public:
@@ -527,10 +546,6 @@ void TestHttpSession::WaitOnReadRequest()
 {
     iReaderRequest->Flush();
     iReaderRequest->Read(kReadTimeoutMs);
-
-    if (!iHeaderConnection.Received()) {
-        ASSERTS();
-    }
 }
 
 void TestHttpSession::Stream(TUint aStartPos, TUint aEndPos)
@@ -656,6 +671,42 @@ void TestHttpSessionReconnect::Respond()
 }
 
 
+// TestHttpSessionKeepAlive
+
+TestHttpSessionKeepAlive::TestHttpSessionKeepAlive()
+    : TestHttpSession()
+{
+}
+
+void TestHttpSessionKeepAlive::Respond()
+{
+    ASSERT(iHeaderRange.Received());
+    const TUint startByte = static_cast<TUint>(iHeaderRange.Start());
+    const TUint endByte = static_cast<TUint>(iHeaderRange.End());
+    const TUint bytes = endByte - startByte + 1;
+    iWriterResponse->WriteStatus(HttpStatus::kPartialContent, Http::eHttp11);
+    TestHttpServer::WriteHeaderPartialContent(*iWriterResponse, startByte, endByte, kStreamLen);
+    Http::WriteHeaderContentLength(*iWriterResponse, bytes);
+    iWriterResponse->WriteFlush();
+    Stream(startByte, endByte + 1);
+}
+
+void TestHttpSessionKeepAlive::Run()
+{
+    // Serve requests until the client closes the connection (or leaves it idle beyond our read timeout).
+    try {
+        for (;;) {
+            WaitOnReadRequest();
+            Respond();
+        }
+    }
+    catch (ReaderError&) {}
+    catch (HttpError&) {ASSERTS();}
+    catch (WriterError&) {ASSERTS();}
+    catch (NetworkError&) {ASSERTS();}
+}
+
+
 // TestHttpSessionStreamLive
 
 TestHttpSessionStreamLive::TestHttpSessionStreamLive()
@@ -778,10 +829,6 @@ void TestHttpSessionSeek::WaitOnReadRequest()
 {
     iReaderRequest->Flush();
     iReaderRequest->Read(kReadTimeoutMs);
-
-    if (!iHeaderConnection.Received()) {
-        ASSERTS();
-    }
 }
 
 void TestHttpSessionSeek::Stream(TUint aStartByte, TUint aEndByte, TUint aWaitByte)
@@ -879,6 +926,8 @@ TestHttpSession* SessionFactory::Create(ESession aSession)
         return new TestHttpSessionLiveReconnect();
     case eChunked:
         return new TestHttpSessionChunked();
+    case eKeepAlive:
+        return new TestHttpSessionKeepAlive();
     default:
         ASSERTS();
         return nullptr;    // Will never reach here.
@@ -1289,6 +1338,60 @@ void SuiteHttpReconnect::Test()
 }
 
 
+// SuiteHttpKeepAlive
+
+SuiteHttpKeepAlive::SuiteHttpKeepAlive()
+    : SuiteHttpStreamBase("HTTP keep-alive tests", SessionFactory::eKeepAlive)
+{
+}
+
+void SuiteHttpKeepAlive::Test()
+{
+    // Series of small range requests, as made by codecs seeking within a file.
+    // All after the first should reuse the pooled connection.
+    static const TUint kRequests = 50;
+    static const TUint kRequestBytes = 4 * 1024;
+    Bwh buf(kRequestBytes);
+    WriterBuffer writer(buf);
+    const Brx& uri = iServer->ServingUri().AbsoluteUri();
+
+    const TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+    for (TUint i=0; i<kRequests; i++) {
+        buf.SetBytes(0);
+        const TUint64 offset = (i * 7919 * kRequestBytes) % (TestHttpSession::kStreamLen - kRequestBytes);
+        TEST(iProtocolManager->Get(writer, uri, offset, kRequestBytes));
+        TEST(buf.Bytes() == kRequestBytes);
+    }
+    const TUint64 elapsedUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+    Print("Keep-alive: %u range requests, mean latency %llu us (pool hits=%u, misses=%u)\n",
+          kRequests, elapsedUs / kRequests, iSsl->PoolHits(), iSsl->PoolMisses());
+
+    TEST(iSsl->PoolMisses() == 1);
+    TEST(iSsl->PoolHits() == kRequests - 1);
+
+    // An interrupted socket must not take (and so lose the interrupt on) a pooled connection.
+    const Uri& servingUri = iServer->ServingUri();
+    Endpoint ep;
+    ep.SetAddress(servingUri.Host());
+    ep.SetPort(servingUri.Port());
+    SocketSsl socket(*gEnv, *iSsl, kRequestBytes);
+    socket.SetSecure(false);
+    socket.Interrupt(true);
+    try {
+        socket.Connect(ep, servingUri.Host(), 1000);
+    }
+    catch (NetworkError&) {}
+    catch (NetworkTimeout&) {}
+    TEST(iSsl->PoolHits() == kRequests - 1);
+    socket.Close();
+    socket.Interrupt(false);
+    socket.Connect(ep, servingUri.Host(), 1000);
+    TEST(socket.IsReused());
+    TEST(iSsl->PoolHits() == kRequests);
+    socket.Close();
+}
+
+
 // SuiteHttpStreamLive
 
 SuiteHttpStreamLive::SuiteHttpStreamLive()
@@ -1490,5 +1593,6 @@ void TestProtocolHttp()
     runner.Add(new SuiteHttpLiveReconnect());
     runner.Add(new SuiteHttpChunked());
     runner.Add(new SuiteHttpSeekInvalid());
+    runner.Add(new SuiteHttpKeepAlive());
     runner.Run();
 }
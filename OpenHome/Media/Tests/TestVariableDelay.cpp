@@ -172,6 +172,10 @@ private:
     void TestDelayShorterThanMinimum();
     void TestAnimatorCalledOnStreamChange();
     void TestClockPuller();
+    void TestMinDelayIncreasedWhileRunning();
+    void TestMinDelayBelowRequestedDelay();
+private:
+    void StartRunning(TUint aDelay);
 private:
     TUint iAnimatorDelayJiffies;
     mutable TUint iNumAnimatorDelayJiffiesCalls;
@@ -921,6 +925,8 @@ SuiteVariableDelayRight::SuiteVariableDelayRight()
     AddTest(MakeFunctor(*this, &SuiteVariableDelayRight::TestDelayShorterThanMinimum), "TestDelayShorterThanMinimum");
     AddTest(MakeFunctor(*this, &SuiteVariableDelayRight::TestAnimatorCalledOnStreamChange), "TestAnimatorCalledOnStreamChange");
     AddTest(MakeFunctor(*this, &SuiteVariableDelayRight::TestClockPuller), "TestClockPuller");
+    AddTest(MakeFunctor(*this, &SuiteVariableDelayRight::TestMinDelayIncreasedWhileRunning), "TestMinDelayIncreasedWhileRunning");
+    AddTest(MakeFunctor(*this, &SuiteVariableDelayRight::TestMinDelayBelowRequestedDelay), "TestMinDelayBelowRequestedDelay");
 }
 
 void SuiteVariableDelayRight::DoSetup()
@@ -1022,6 +1028,62 @@ void SuiteVariableDelayRight::TestClockPuller()
     TEST(iClockPullStopCount == 2);
 }
 
+void SuiteVariableDelayRight::StartRunning(TUint aDelay)
+{
+    PullNext(EMsgMode);
+    PullNext(EMsgTrack);
+    PullNext(EMsgDecodedStream);
+    iNextDelayAbsoluteJiffies = aDelay;
+    PullNext(EMsgDelay);
+    while (iJiffies < aDelay) {
+        PullNext();
+        TEST(iLastMsg == EMsgSilence);
+    }
+    PullNext(EMsgAudioPcm);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERunning);
+}
+
+void SuiteVariableDelayRight::TestMinDelayIncreasedWhileRunning()
+{
+    StartRunning(kMinDelay);
+
+    static const TUint kIncrease = 20 * Jiffies::kPerMs;
+    static_cast<VariableDelayRight*>(iVariableDelay)->SetMinDelay(kMinDelay + kIncrease);
+    iJiffies = 0;
+    do {
+        PullNext(EMsgAudioPcm);
+    } while (iVariableDelay->iStatus == VariableDelayBase::ERampingDown);
+    TEST(iJiffies == kRampDuration);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERampedDown);
+
+    iJiffies = 0;
+    while (iJiffies < kIncrease) {
+        PullNext(EMsgSilence);
+    }
+    TEST(iJiffies == kIncrease);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERampingUp);
+
+    iJiffies = 0;
+    do {
+        PullNext(EMsgAudioPcm);
+    } while (iVariableDelay->iStatus == VariableDelayBase::ERampingUp);
+    TEST(iJiffies == kRampDuration);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERunning);
+}
+
+void SuiteVariableDelayRight::TestMinDelayBelowRequestedDelay()
+{
+    static const TUint kDelay = kMinDelay + 20 * Jiffies::kPerMs;
+    StartRunning(kDelay);
+
+    // the delay requested by the last MsgDelay still applies
+    static_cast<VariableDelayRight*>(iVariableDelay)->SetMinDelay(kDelay - Jiffies::kPerMs);
+    PullNext(EMsgAudioPcm);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERunning);
+    PullNext(EMsgAudioPcm);
+    TEST(iVariableDelay->iStatus == VariableDelayBase::ERunning);
+}
+
 
 void TestVariableDelay()
 {
@@ -143,6 +143,7 @@ SocketHttp::SocketHttp(Environment& aEnv,
     , iBytesRemaining(-1)
     , iMethod(Http::kMethodGet)
     , iPersistConnection(true)
+    , iResponseComplete(false)
     , iRequestChunked(false)
     , iRequestContentLengthSet(false)
     , iRequestContentLength(0)
@@ -319,9 +320,16 @@ void SocketHttp::Connect()
 void SocketHttp::Disconnect()
 {
     LOG(kHttp, "SocketHttp::Disconnect\n");
+    // A connection whose last response was read to completion can be handed to the shared pool rather than closed.
+    const TBool reusable = iPersistConnection && iResponseComplete;
     ResetResponseState();
     if (iConnected) {
-        iSocket.Close();
+        if (reusable) {
+            iSocket.CloseKeepAlive();
+        }
+        else {
+            iSocket.Close();
+        }
         iConnected = false;
     }
 }
@@ -391,6 +399,7 @@ Brn SocketHttp::Read(TUint aBytes)
         if (iBytesRemaining == 0) {
             // End-of-stream signifier.
             iBytesRemaining = -1;
+            iResponseComplete = true;
 
             if (!iPersistConnection) {
                 // We're done reading from this stream and cannot re-use connection. Close connection and free up underlying resources.
@@ -417,6 +426,9 @@ Brn SocketHttp::Read(TUint aBytes)
 
         // Dechunker returns a buffer of 0 bytes in length when end-of-stream reached (conforming to IReader interface).
         if (buf.Bytes() == 0) {
+            if (iHeaderTransferEncoding.IsChunked()) {
+                iResponseComplete = true;
+            }
             if (!iPersistConnection) {
                 // We're done reading from this stream and cannot re-use connection. Close connection and free up underlying resources.
                 Disconnect();
@@ -521,7 +533,22 @@ void SocketHttp::ProcessResponse()
     if (!iResponseReceived) {
         try {
             for (;;) { // loop until we don't get a redirection response (i.e. normally don't loop at all!)
-                const TUint code = ReadResponse();
+                TUint code = 0;
+                try {
+                    code = ReadResponse();
+                }
+                catch (const SocketHttpResponseError&) {
+                    // A pooled connection may have been closed by the server while idle.
+                    // GET is idempotent so can safely be repeated on a new connection.
+                    if (!iSocket.IsReused() || iMethod != Http::kMethodGet) {
+                        throw;
+                    }
+                    LOG(kHttp, "SocketHttp::ProcessResponse reused connection failed, retrying\n");
+                    Disconnect();
+                    Connect();
+                    SendRequestHeaders();
+                    continue;
+                }
 
                 // Check for redirection
                 if (code >= HttpStatus::kRedirectionCodes && code < HttpStatus::kClientErrorCodes) {
@@ -619,4 +646,5 @@ void SocketHttp::ResetResponseState()
 
     // Persistence is per-connection; not a global client-settable state of this socket.
     iPersistConnection = true;
+    iResponseComplete = false;
 }
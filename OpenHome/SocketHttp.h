@@ -202,6 +202,7 @@ private:
     Uri iUri;
     Endpoint iEndpoint;
     TBool iPersistConnection;
+    TBool iResponseComplete;
 
     TBool iRequestChunked;
     TBool iRequestContentLengthSet;
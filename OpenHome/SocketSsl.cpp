@@ -6,6 +6,9 @@
 #include <OpenHome/Private/Env.h>
 #include <OpenHome/Private/Printer.h>
 #include <OpenHome/Debug-ohMediaPlayer.h>
+#include <OpenHome/Private/Thread.h>
+#include <OpenHome/Private/TIpAddressUtils.h>
+#include <OpenHome/Os.h>
 
 #include "openssl/bio.h"
 #include "openssl/ssl.h"
@@ -13,32 +16,81 @@
 #include "openssl/engine.h"
 
 #include <stdlib.h>
+#include <iterator>
+#include <vector>
 
 namespace OpenHome {
 
 class SslImpl
 {
+    static const TUint kMaxIdleConnections = 8;
+    static const TUint kIdleTimeoutMs = 5 * 1000; // conservative; many servers drop idle connections after 5-15s
+    static const TUint kMaxSessions = 16;
 public:
     SslImpl();
     ~SslImpl();
+    SocketSslImpl* TryReuse(const Endpoint& aEndpoint, TBool aSecure, const Brx& aHostname, TUint aMemBufSize, TUint aNowMs);
+    void Park(SocketSslImpl* aSocket, TUint aNowMs);
+    void ApplySession(SSL* aSsl, const Endpoint& aEndpoint, const Brx& aHostname);
+    void StoreSession(SSL* aSsl, const Endpoint& aEndpoint, const Brx& aHostname);
+    TUint PoolHits() const;
+    TUint PoolMisses() const;
+    TUint SessionsResumed() const;
+    TUint FullHandshakes() const;
+private:
+    void RemoveExpiredLocked(TUint aNowMs, std::vector<SocketSslImpl*>& aExpired);
+    static TBool Matches(const Endpoint& aEndpoint, const Brx& aHostname, const Endpoint& aEndpoint2, const Brx& aHostname2);
+private:
+    class IdleConnection
+    {
+    public:
+        IdleConnection(SocketSslImpl* aSocket, TUint aParkedMs);
+    public:
+        SocketSslImpl* iSocket;
+        TUint iParkedMs;
+    };
+    class Session
+    {
+    public:
+        Session(const Endpoint& aEndpoint, const Brx& aHostname, SSL_SESSION* aSession);
+    public:
+        Endpoint iEndpoint;
+        Bwh iHostname;
+        SSL_SESSION* iSession;
+    };
 public:
     SSL_CTX* iCtx;
+private:
+    mutable Mutex iLock;
+    std::vector<IdleConnection> iIdle;     // oldest first
+    std::vector<Session*> iSessions;       // least recently stored first
+    TUint iPoolHits;
+    TUint iPoolMisses;
+    TUint iSessionsResumed;
+    TUint iFullHandshakes;
 };
 
 class SocketSslImpl : public IWriter, public IReaderSource
 {
+    friend class SslImpl;
     static const TUint kMinReadBytes = 8 * 1024;
     static const TUint kDefaultHostNameBytes = 128;
 public:
     SocketSslImpl(Environment& aEnv, SslContext& aSsl, TUint aReadBytes);
     ~SocketSslImpl();
     void SetSecure(TBool aSecure);
+    TBool IsSecure() const;
     void Connect(const Endpoint& aEndpoint, TUint aTimeoutMs);
     void Connect(const Endpoint& aEndpoint, const Brx& aHostname, TUint aTimeoutMs);
     void Close();
     void Interrupt(TBool aInterrupt);
+    TBool IsInterrupted() const;
     void LogVerbose(TBool aVerbose);
+    TBool IsVerbose() const;
     TBool IsConnected() const;
+    void SetReused();
+    TBool IsReused() const;
+    TUint MemBufSize() const;
 public: // from IWriter
     void Write(TByte aValue) override;
     void Write(const Brx& aBuffer) override;
@@ -51,6 +103,7 @@ private:
     static long BioCallback(BIO *b, int oper, const char *argp, int argi, long argl, long retvalue);
 private:
     Environment& iEnv;
+    SslImpl& iSslImpl;
     SocketTcpClient iSocketTcp;
     SSL_CTX* iCtx;
     SSL* iSsl;
@@ -59,6 +112,9 @@ private:
     TBool iSecure;
     TBool iConnected;
     TBool iVerbose;
+    TBool iInterrupted;
+    TBool iReused;
+    Endpoint iEndpoint;
     Bwh iHostname;
 };
 
@@ -86,10 +142,48 @@ SslContext::~SslContext()
     sslInitialised = false;
 }
 
+TUint SslContext::PoolHits() const
+{
+    return iImpl->PoolHits();
+}
+
+TUint SslContext::PoolMisses() const
+{
+    return iImpl->PoolMisses();
+}
+
+TUint SslContext::SessionsResumed() const
+{
+    return iImpl->SessionsResumed();
+}
+
+TUint SslContext::FullHandshakes() const
+{
+    return iImpl->FullHandshakes();
+}
+
 
 // SslImpl
 
+SslImpl::IdleConnection::IdleConnection(SocketSslImpl* aSocket, TUint aParkedMs)
+    : iSocket(aSocket)
+    , iParkedMs(aParkedMs)
+{
+}
+
+SslImpl::Session::Session(const Endpoint& aEndpoint, const Brx& aHostname, SSL_SESSION* aSession)
+    : iEndpoint(aEndpoint)
+    , iHostname(aHostname)
+    , iSession(aSession)
+{
+}
+
 SslImpl::SslImpl()
+    : iLock("SSLP")
+    , iPoolHits(0)
+    , iPoolMisses(0)
+    , iSessionsResumed(0)
+    , iFullHandshakes(0)
 {
     SSL_library_init();
     SSL_load_error_strings();
@@ -101,6 +195,13 @@ SslImpl::SslImpl()
 
 SslImpl::~SslImpl()
 {
+    for (auto& idle : iIdle) {
+        delete idle.iSocket;
+    }
+    for (auto session : iSessions) {
+        SSL_SESSION_free(session->iSession);
+        delete session;
+    }
     SSL_CTX_free(iCtx);
     iCtx = nullptr;
     CRYPTO_cleanup_all_ex_data();
@@ -111,9 +212,151 @@ SslImpl::~SslImpl()
 }
 
 
+SocketSslImpl* SslImpl::TryReuse(const Endpoint& aEndpoint, TBool aSecure, const Brx& aHostname, TUint aMemBufSize, TUint aNowMs)
+{
+    std::vector<SocketSslImpl*> expired;
+    SocketSslImpl* socket = nullptr;
+    {
+        AutoMutex _(iLock);
+        RemoveExpiredLocked(aNowMs, expired);
+        // search newest first - most likely to still be alive
+        for (auto it = iIdle.rbegin(); it != iIdle.rend(); ++it) {
+            SocketSslImpl* candidate = it->iSocket;
+            if (candidate->iSecure == aSecure
+                && candidate->iMemBufSize >= aMemBufSize
+                && Matches(candidate->iEndpoint, candidate->iHostname, aEndpoint, aHostname)) {
+                socket = candidate;
+                iIdle.erase(std::next(it).base());
+                break;
+            }
+        }
+        if (socket == nullptr) {
+            iPoolMisses++;
+        }
+        else {
+            iPoolHits++;
+        }
+    }
+    for (auto s : expired) {
+        delete s;
+    }
+    return socket;
+}
+
+void SslImpl::Park(SocketSslImpl* aSocket, TUint aNowMs)
+{
+    std::vector<SocketSslImpl*> expired;
+    {
+        AutoMutex _(iLock);
+        RemoveExpiredLocked(aNowMs, expired);
+        if (iIdle.size() == kMaxIdleConnections) {
+            expired.push_back(iIdle[0].iSocket);
+            iIdle.erase(iIdle.begin());
+        }
+        iIdle.push_back(IdleConnection(aSocket, aNowMs));
+    }
+    for (auto s : expired) {
+        delete s;
+    }
+}
+
+void SslImpl::ApplySession(SSL* aSsl, const Endpoint& aEndpoint, const Brx& aHostname)
+{
+    AutoMutex _(iLock);
+    for (auto session : iSessions) {
+        if (Matches(session->iEndpoint, session->iHostname, aEndpoint, aHostname)) {
+            (void)SSL_set_session(aSsl, session->iSession); // takes its own reference
+            break;
+        }
+    }
+}
+
+void SslImpl::StoreSession(SSL* aSsl, const Endpoint& aEndpoint, const Brx& aHostname)
+{
+    const TBool reused = (SSL_session_reused(aSsl) != 0);
+    SSL_SESSION* sslSession = SSL_get1_session(aSsl);
+    SSL_SESSION* evicted = nullptr;
+    Session* evictedEntry = nullptr;
+    {
+        AutoMutex _(iLock);
+        if (reused) {
+            iSessionsResumed++;
+        }
+        else {
+            iFullHandshakes++;
+        }
+        if (sslSession == nullptr) {
+            return;
+        }
+        for (auto it = iSessions.begin(); it != iSessions.end(); ++it) {
+            if (Matches((*it)->iEndpoint, (*it)->iHostname, aEndpoint, aHostname)) {
+                evictedEntry = *it;
+                iSessions.erase(it);
+                break;
+            }
+        }
+        if (evictedEntry == nullptr && iSessions.size() == kMaxSessions) {
+            evictedEntry = iSessions[0];
+            iSessions.erase(iSessions.begin());
+        }
+        if (evictedEntry != nullptr) {
+            evicted = evictedEntry->iSession;
+        }
+        iSessions.push_back(new Session(aEndpoint, aHostname, sslSession));
+    }
+    if (evictedEntry != nullptr) {
+        SSL_SESSION_free(evicted);
+        delete evictedEntry;
+    }
+}
+
+TUint SslImpl::PoolHits() const
+{
+    AutoMutex _(iLock);
+    return iPoolHits;
+}
+
+TUint SslImpl::PoolMisses() const
+{
+    AutoMutex _(iLock);
+    return iPoolMisses;
+}
+
+TUint SslImpl::SessionsResumed() const
+{
+    AutoMutex _(iLock);
+    return iSessionsResumed;
+}
+
+TUint SslImpl::FullHandshakes() const
+{
+    AutoMutex _(iLock);
+    return iFullHandshakes;
+}
+
+void SslImpl::RemoveExpiredLocked(TUint aNowMs, std::vector<SocketSslImpl*>& aExpired)
+{
+    while (iIdle.size() > 0 && aNowMs - iIdle[0].iParkedMs >= kIdleTimeoutMs) {
+        aExpired.push_back(iIdle[0].iSocket);
+        iIdle.erase(iIdle.begin());
+    }
+}
+
+TBool SslImpl::Matches(const Endpoint& aEndpoint, const Brx& aHostname, const Endpoint& aEndpoint2, const Brx& aHostname2)
+{ // static
+    return aEndpoint.Port() == aEndpoint2.Port()
+        && TIpAddressUtils::Equals(aEndpoint.Address(), aEndpoint2.Address())
+        && aHostname == aHostname2;
+}
+
+
 // SocketSsl
 
 SocketSsl::SocketSsl(Environment& aEnv, SslContext& aSsl, TUint aReadBytes)
+    : iEnv(aEnv)
+    , iSsl(aSsl)
+    , iReadBytes(aReadBytes)
+    , iLock("SSLS")
 {
     iImpl = new SocketSslImpl(aEnv, aSsl, aReadBytes);
 }
@@ -125,69 +368,138 @@ SocketSsl::~SocketSsl()
 
 void SocketSsl::SetSecure(TBool aSecure)
 {
-    iImpl->SetSecure(aSecure);
+    Impl()->SetSecure(aSecure);
 }
 
 void SocketSsl::ConnectNoSni(const Endpoint& aEndpoint, TUint aTimeoutMs)
 {
-    iImpl->Connect(aEndpoint, aTimeoutMs);
+    Impl()->Connect(aEndpoint, aTimeoutMs);
 }
 
 void SocketSsl::Connect(const Endpoint& aEndpoint, const Brx& aHostname, TUint aTimeoutMs)
 {
-    iImpl->Connect(aEndpoint, aHostname, aTimeoutMs);
+    SocketSslImpl* impl = Impl();
+    SocketSslImpl* pooled = nullptr;
+    if (!impl->IsConnected() && !impl->IsInterrupted()) {
+        const TUint nowMs = Os::TimeInMs(iEnv.OsCtx());
+        pooled = iSsl.iImpl->TryReuse(aEndpoint, impl->IsSecure(), aHostname, impl->MemBufSize(), nowMs);
+    }
+    if (pooled == nullptr) {
+        impl->Connect(aEndpoint, aHostname, aTimeoutMs);
+        return;
+    }
+    LOG(kSsl, "SocketSsl::Connect reusing pooled connection to %.*s\n", PBUF(aHostname));
+    pooled->LogVerbose(impl->IsVerbose());
+    pooled->SetReused();
+    TBool interrupted;
+    {
+        AutoMutex _(iLock);
+        // an Interrupt() since the check above must apply to the connection we return
+        interrupted = iImpl->IsInterrupted();
+        if (interrupted) {
+            pooled->Interrupt(true);
+        }
+        iImpl = pooled;
+    }
+    delete impl;
+    if (interrupted) {
+        THROW(NetworkError);
+    }
 }
 
 void SocketSsl::Close()
 {
-    iImpl->Close();
+    Impl()->Close();
+}
+
+void SocketSsl::CloseKeepAlive()
+{
+    SocketSslImpl* impl = Impl();
+    if (!impl->IsConnected()) {
+        return;
+    }
+    SocketSslImpl* fresh = new SocketSslImpl(iEnv, iSsl, iReadBytes);
+    fresh->SetSecure(impl->IsSecure());
+    fresh->LogVerbose(impl->IsVerbose());
+    TBool park;
+    {
+        AutoMutex _(iLock);
+        park = !iImpl->IsInterrupted();
+        if (park) {
+            iImpl = fresh;
+        }
+    }
+    if (park) {
+        iSsl.iImpl->Park(impl, Os::TimeInMs(iEnv.OsCtx()));
+    }
+    else {
+        delete fresh;
+        impl->Close();
+    }
 }
 
 void SocketSsl::Interrupt(TBool aInterrupt)
 {
+    AutoMutex _(iLock);
     iImpl->Interrupt(aInterrupt);
 }
 
 void SocketSsl::LogVerbose(TBool aVerbose)
 {
-    iImpl->LogVerbose(aVerbose);
+    Impl()->LogVerbose(aVerbose);
 }
 
 TBool SocketSsl::IsConnected() const
 {
-    return iImpl->IsConnected();
+    return Impl()->IsConnected();
+}
+
+TBool SocketSsl::IsReused() const
+{
+    return Impl()->IsReused();
 }
 
 void SocketSsl::Write(TByte aValue)
 {
-    iImpl->Write(aValue);
+    Impl()->Write(aValue);
 }
 
 void SocketSsl::Write(const Brx& aBuffer)
 {
-    iImpl->Write(aBuffer);
+    Impl()->Write(aBuffer);
 }
 
 void SocketSsl::WriteFlush()
 {
-    iImpl->WriteFlush();
+    Impl()->WriteFlush();
 }
 
 void SocketSsl::Read(Bwx& aBuffer)
 {
-    iImpl->Read(aBuffer);
+    Impl()->Read(aBuffer);
 }
 
 void SocketSsl::ReadFlush()
 {
-    iImpl->ReadFlush();
+    Impl()->ReadFlush();
 }
 
 void SocketSsl::ReadInterrupt()
 {
+    AutoMutex _(iLock);
     iImpl->ReadInterrupt();
 }
 
+SocketSslImpl* SocketSsl::Impl() const
+{
+    /* iImpl is only replaced (and the old impl deleted) by Connect() and CloseKeepAlive(),
+       which run on the thread that owns this socket and so can't overlap its other
+       calls.  Interrupt() and ReadInterrupt() may be called from any thread so hold
+       iLock for their duration rather than using this. */
+    AutoMutex _(iLock);
+    return iImpl;
+}
+
 
 // SocketSslImpl
 
@@ -210,11 +522,14 @@ static void SslInfoCallback(const SSL* ssl, int flag, int ret)
 
 SocketSslImpl::SocketSslImpl(Environment& aEnv, SslContext& aSsl, TUint aReadBytes)
     : iEnv(aEnv)
+    , iSslImpl(*aSsl.iImpl)
     , iCtx(aSsl.iImpl->iCtx)
     , iSsl(nullptr)
     , iSecure(true)
     , iConnected(false)
     , iVerbose(false)
+    , iInterrupted(false)
+    , iReused(false)
     , iHostname(kDefaultHostNameBytes)
 {
     iMemBufSize = (kMinReadBytes<aReadBytes? aReadBytes : kMinReadBytes);
@@ -236,6 +551,11 @@ void SocketSslImpl::SetSecure(TBool aSecure)
     iSecure = aSecure;
 }
 
+TBool SocketSslImpl::IsSecure() const
+{
+    return iSecure;
+}
+
 void SocketSslImpl::Connect(const Endpoint& aEndpoint, TUint aTimeoutMs)
 {
     Connect(aEndpoint, Brx::Empty(), aTimeoutMs);
@@ -255,6 +575,15 @@ void SocketSslImpl::Connect(const Endpoint& aEndpoint, const Brx& aHostname, TUi
         iSocketTcp.Close();
         throw;
     }
+    iEndpoint.Replace(aEndpoint);
+    iHostname.SetBytes(0);
+    if (aHostname.Bytes() > 0) {
+        const TUint cStringBytes = aHostname.Bytes() + 1; // +1 for '\0'.
+        if (cStringBytes > iHostname.MaxBytes()) {
+            iHostname.Grow(cStringBytes);
+        }
+        iHostname.Replace(aHostname);
+    }
     if (iSecure) {
         ASSERT(iSsl == nullptr);
         iSsl = SSL_new(iCtx);
@@ -271,14 +600,11 @@ void SocketSslImpl::Connect(const Endpoint& aEndpoint, const Brx& aHostname, TUi
         SSL_set_mode(iSsl, SSL_MODE_AUTO_RETRY);
 
         // Use "Server Name Indication" if hostname is specified.
-        if (aHostname.Bytes() > 0) {
-            const TUint cStringBytes = aHostname.Bytes() + 1; // +1 for '\0'.
-            if (cStringBytes > iHostname.MaxBytes()) {
-                iHostname.Grow(cStringBytes);
-            }
-            iHostname.Replace(aHostname);
+        if (iHostname.Bytes() > 0) {
             SSL_set_tlsext_host_name(iSsl, iHostname.PtrZ());
         }
+        // Offer any cached session for this host, allowing an abbreviated handshake.
+        iSslImpl.ApplySession(iSsl, iEndpoint, iHostname);
 
         if (1 != SSL_connect(iSsl)) {
             SSL_free(iSsl);
@@ -286,6 +612,7 @@ void SocketSslImpl::Connect(const Endpoint& aEndpoint, const Brx& aHostname, TUi
             iSocketTcp.Close();
             THROW(NetworkError);
         }
+        iSslImpl.StoreSession(iSsl, iEndpoint, iHostname);
     }
     iConnected = true;
 }
@@ -302,6 +629,7 @@ void SocketSslImpl::Close()
             iSsl = nullptr;
         }
         iConnected = false;
+        iReused = false;
         iHostname.SetBytes(0);
         try {
             iSocketTcp.Close();
@@ -312,19 +640,45 @@ void SocketSslImpl::Close()
 
 void SocketSslImpl::Interrupt(TBool aInterrupt)
 {
+    iInterrupted = aInterrupt;
     iSocketTcp.Interrupt(aInterrupt);
 }
 
+TBool SocketSslImpl::IsInterrupted() const
+{
+    return iInterrupted;
+}
+
 void SocketSslImpl::LogVerbose(TBool aVerbose)
 {
     iVerbose = aVerbose;
 }
 
+TBool SocketSslImpl::IsVerbose() const
+{
+    return iVerbose;
+}
+
 TBool SocketSslImpl::IsConnected() const
 {
     return iConnected;
 }
 
+void SocketSslImpl::SetReused()
+{
+    iReused = true;
+}
+
+TBool SocketSslImpl::IsReused() const
+{
+    return iReused;
+}
+
+TUint SocketSslImpl::MemBufSize() const
+{
+    return iMemBufSize;
+}
+
 void SocketSslImpl::Write(TByte aValue)
 {
     Brn buf(&aValue, 1);
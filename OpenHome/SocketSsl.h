@@ -5,6 +5,7 @@
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Types.h>
 #include <OpenHome/Private/Standard.h>
+#include <OpenHome/Private/Thread.h>
 
 namespace OpenHome {
 
@@ -12,12 +13,22 @@ class Environment;
 class SocketSslImpl;
 class SslImpl;
 
+/*
+ * Shared by all SocketSsl instances.  Owns a per-host pool of idle keep-alive
+ * connections and a cache of TLS sessions so that reconnecting to a recently
+ * used host can skip the TCP and/or full TLS handshake.
+ */
 class SslContext
 {
+    friend class SocketSsl;
     friend class SocketSslImpl;
 public:
     SslContext();
     ~SslContext();
+    TUint PoolHits() const;
+    TUint PoolMisses() const;
+    TUint SessionsResumed() const;
+    TUint FullHandshakes() const;
 private:
     SslImpl* iImpl;
 };
@@ -33,11 +44,27 @@ public:
      * A bit fragile, may be broken by server-side changes without warning.
      */
     void ConnectNoSni(const Endpoint& aEndpoint, TUint aTimeoutMs);
+    /*
+     * Reuses an idle connection to the same endpoint from SslContext's pool if one is available.
+     */
     void Connect(const Endpoint& aEndpoint, const Brx& aHostname, TUint aTimeoutMs);
     void Close();
+    /*
+     * Alternative to Close() for use when the caller has consumed a complete
+     * response on a persistent connection.  Returns the connection to
+     * SslContext's pool for reuse by a later Connect() to the same host.
+     * Falls back to Close() if the socket has been interrupted.
+     */
+    void CloseKeepAlive();
     void Interrupt(TBool aInterrupt);
     void LogVerbose(TBool aVerbose);
     TBool IsConnected() const;
+    /*
+     * Returns true if the current connection was taken from the pool.
+     * A server may close an idle connection at any time so callers should be
+     * prepared to retry a request that fails on a reused connection.
+     */
+    TBool IsReused() const;
 public: // from IWriter
     void Write(TByte aValue) override;
     void Write(const Brx& aBuffer) override;
@@ -47,6 +74,12 @@ public: // from IReaderSource
     void ReadFlush() override;
     void ReadInterrupt() override;
 private:
+    SocketSslImpl* Impl() const;
+private:
+    Environment& iEnv;
+    SslContext& iSsl;
+    TUint iReadBytes;
+    mutable Mutex iLock; // guards iImpl, which Connect() and CloseKeepAlive() may replace
     SocketSslImpl* iImpl;
 };
 
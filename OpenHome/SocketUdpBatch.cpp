@@ -0,0 +1,491 @@
+#include <OpenHome/SocketUdpBatch.h>
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Arch.h>
+
+#include <atomic>
+#include <string.h>
+
+#if defined(__linux__)
+# include <sys/types.h>
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <poll.h>
+# include <unistd.h>
+# include <fcntl.h>
+# include <errno.h>
+# define SOCKET_UDP_BATCH_NATIVE
+#endif
+
+namespace OpenHome {
+
+class SocketUdpBatchImpl
+{
+public:
+    virtual ~SocketUdpBatchImpl() {}
+    virtual TUint Port() const = 0;
+    virtual void SetTtl(TUint aTtl) = 0;
+    virtual void SetRecvBufBytes(TUint aBytes) = 0;
+    virtual void Interrupt(TBool aInterrupt) = 0;
+    virtual void Send(const Brx& aBuffer, const Endpoint& aEndpoint) = 0;
+    virtual TUint Send(const Brx& aBuffer, const Endpoint* aEndpoints, TUint aCount) = 0;
+    virtual Endpoint Receive(Bwx& aBuffer) = 0;
+    virtual TBool Batched() const = 0;
+    virtual TUint64 SendCalls() const = 0;
+    virtual TUint64 ReceiveCalls() const = 0;
+};
+
+// One ohNet call per datagram.  Used where native batching isn't available.
+class SocketUdpBatchOhNet : public SocketUdpBatchImpl
+{
+public:
+    SocketUdpBatchOhNet(Environment& aEnv, TUint aPort, TIpAddress aInterface);
+private: // from SocketUdpBatchImpl
+    TUint Port() const override;
+    void SetTtl(TUint aTtl) override;
+    void SetRecvBufBytes(TUint aBytes) override;
+    void Interrupt(TBool aInterrupt) override;
+    void Send(const Brx& aBuffer, const Endpoint& aEndpoint) override;
+    TUint Send(const Brx& aBuffer, const Endpoint* aEndpoints, TUint aCount) override;
+    Endpoint Receive(Bwx& aBuffer) override;
+    TBool Batched() const override;
+    TUint64 SendCalls() const override;
+    TUint64 ReceiveCalls() const override;
+private:
+    SocketUdp iSocket;
+    std::atomic<TUint64> iSendCalls;
+    std::atomic<TUint64> iReceiveCalls;
+};
+
+#ifdef SOCKET_UDP_BATCH_NATIVE
+// IPv4 socket using sendmmsg/recvmmsg.  Interrupts are signalled through a pipe
+// that Receive() polls alongside the socket.
+class SocketUdpBatchNative : public SocketUdpBatchImpl
+{
+    static const TUint kMaxBatch = SocketUdpBatch::kMaxBatch;
+    static const TUint kMaxEndpoints = SocketUdpBatch::kMaxEndpoints;
+public:
+    SocketUdpBatchNative(TUint aMaxDatagramBytes, TUint aPort, TIpAddress aInterface);
+    ~SocketUdpBatchNative();
+private: // from SocketUdpBatchImpl
+    TUint Port() const override;
+    void SetTtl(TUint aTtl) override;
+    void SetRecvBufBytes(TUint aBytes) override;
+    void Interrupt(TBool aInterrupt) override;
+    void Send(const Brx& aBuffer, const Endpoint& aEndpoint) override;
+    TUint Send(const Brx& aBuffer, const Endpoint* aEndpoints, TUint aCount) override;
+    Endpoint Receive(Bwx& aBuffer) override;
+    TBool Batched() const override;
+    TUint64 SendCalls() const override;
+    TUint64 ReceiveCalls() const override;
+private:
+    void Fill();
+    static TBool ToSockAddr(const Endpoint& aEndpoint, struct sockaddr_in& aAddr);
+private:
+    const TUint iMaxDatagramBytes;
+    int iFd;
+    int iPipe[2];
+    TUint iPort;
+    std::atomic<bool> iInterrupted;
+    TByte* iRxData;
+    struct mmsghdr iRxMsgs[kMaxBatch];
+    struct iovec iRxIov[kMaxBatch];
+    struct sockaddr_in iRxAddr[kMaxBatch];
+    TUint iRxCount;
+    TUint iRxIndex;
+    std::atomic<TUint64> iSendCalls;
+    std::atomic<TUint64> iReceiveCalls;
+};
+#endif // SOCKET_UDP_BATCH_NATIVE
+
+} // namespace OpenHome
+
+using namespace OpenHome;
+
+
+// SocketUdpBatch
+
+SocketUdpBatch::SocketUdpBatch(Environment& aEnv, TUint aMaxDatagramBytes, TUint aPort, TIpAddress aInterface)
+{
+#ifdef SOCKET_UDP_BATCH_NATIVE
+    if (aInterface.iFamily == kFamilyV4) {
+        iImpl = new SocketUdpBatchNative(aMaxDatagramBytes, aPort, aInterface);
+        return;
+    }
+#else
+    (void)aMaxDatagramBytes;
+#endif
+    iImpl = new SocketUdpBatchOhNet(aEnv, aPort, aInterface);
+}
+
+SocketUdpBatch::~SocketUdpBatch()
+{
+    delete iImpl;
+}
+
+TUint SocketUdpBatch::Port() const
+{
+    return iImpl->Port();
+}
+
+void SocketUdpBatch::SetTtl(TUint aTtl)
+{
+    iImpl->SetTtl(aTtl);
+}
+
+void SocketUdpBatch::SetRecvBufBytes(TUint aBytes)
+{
+    iImpl->SetRecvBufBytes(aBytes);
+}
+
+void SocketUdpBatch::Interrupt(TBool aInterrupt)
+{
+    iImpl->Interrupt(aInterrupt);
+}
+
+void SocketUdpBatch::Send(const Brx& aBuffer, const Endpoint& aEndpoint)
+{
+    iImpl->Send(aBuffer, aEndpoint);
+}
+
+TUint SocketUdpBatch::Send(const Brx& aBuffer, const Endpoint* aEndpoints, TUint aCount)
+{
+    ASSERT(aCount <= kMaxEndpoints);
+    return iImpl->Send(aBuffer, aEndpoints, aCount);
+}
+
+Endpoint SocketUdpBatch::Receive(Bwx& aBuffer)
+{
+    return iImpl->Receive(aBuffer);
+}
+
+TBool SocketUdpBatch::Batched() const
+{
+    return iImpl->Batched();
+}
+
+TUint64 SocketUdpBatch::SendCalls() const
+{
+    return iImpl->SendCalls();
+}
+
+TUint64 SocketUdpBatch::ReceiveCalls() const
+{
+    return iImpl->ReceiveCalls();
+}
+
+
+// SocketUdpBatchOhNet
+
+SocketUdpBatchOhNet::SocketUdpBatchOhNet(Environment& aEnv, TUint aPort, TIpAddress aInterface)
+    : iSocket(aEnv, aPort, aInterface)
+    , iSendCalls(0)
+    , iReceiveCalls(0)
+{
+}
+
+TUint SocketUdpBatchOhNet::Port() const
+{
+    return const_cast<SocketUdp&>(iSocket).Port();
+}
+
+void SocketUdpBatchOhNet::SetTtl(TUint aTtl)
+{
+    iSocket.SetTtl(aTtl);
+}
+
+void SocketUdpBatchOhNet::SetRecvBufBytes(TUint aBytes)
+{
+    iSocket.SetRecvBufBytes(aBytes);
+}
+
+void SocketUdpBatchOhNet::Interrupt(TBool aInterrupt)
+{
+    iSocket.Interrupt(aInterrupt);
+}
+
+void SocketUdpBatchOhNet::Send(const Brx& aBuffer, const Endpoint& aEndpoint)
+{
+    iSendCalls++;
+    iSocket.Send(aBuffer, aEndpoint);
+}
+
+TUint SocketUdpBatchOhNet::Send(const Brx& aBuffer, const Endpoint* aEndpoints, TUint aCount)
+{
+    TUint failed = 0;
+    for (TUint i = 0; i < aCount; i++) {
+        iSendCalls++;
+        try {
+            iSocket.Send(aBuffer, aEndpoints[i]);
+        }
+        catch (NetworkError&) {
+            failed |= 1u << i;
+        }
+    }
+    return failed;
+}
+
+Endpoint SocketUdpBatchOhNet::Receive(Bwx& aBuffer)
+{
+    iReceiveCalls++;
+    return iSocket.Receive(aBuffer);
+}
+
+TBool SocketUdpBatchOhNet::Batched() const
+{
+    return false;
+}
+
+TUint64 SocketUdpBatchOhNet::SendCalls() const
+{
+    return iSendCalls;
+}
+
+TUint64 SocketUdpBatchOhNet::ReceiveCalls() const
+{
+    return iReceiveCalls;
+}
+
+
+#ifdef SOCKET_UDP_BATCH_NATIVE
+
+// SocketUdpBatchNative
+
+SocketUdpBatchNative::SocketUdpBatchNative(TUint aMaxDatagramBytes, TUint aPort, TIpAddress aInterface)
+    : iMaxDatagramBytes(aMaxDatagramBytes)
+    , iFd(-1)
+    , iPort(0)
+    , iInterrupted(false)
+    , iRxData(nullptr)
+    , iRxCount(0)
+    , iRxIndex(0)
+    , iSendCalls(0)
+    , iReceiveCalls(0)
+{
+    iPipe[0] = iPipe[1] = -1;
+    iFd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (iFd < 0) {
+        THROW(NetworkError);
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)aPort);
+    addr.sin_addr.s_addr = aInterface.iV4;
+    socklen_t len = sizeof(addr);
+    if (::bind(iFd, (struct sockaddr*)&addr, sizeof(addr)) != 0
+        || ::getsockname(iFd, (struct sockaddr*)&addr, &len) != 0
+        || ::pipe2(iPipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        if (iPipe[0] >= 0) {
+            ::close(iPipe[0]);
+            ::close(iPipe[1]);
+        }
+        ::close(iFd);
+        THROW(NetworkError);
+    }
+    iPort = ntohs(addr.sin_port);
+
+    iRxData = new TByte[kMaxBatch * iMaxDatagramBytes];
+    memset(iRxMsgs, 0, sizeof(iRxMsgs));
+    for (TUint i = 0; i < kMaxBatch; i++) {
+        iRxIov[i].iov_base = iRxData + (i * iMaxDatagramBytes);
+        iRxIov[i].iov_len = iMaxDatagramBytes;
+        iRxMsgs[i].msg_hdr.msg_iov = &iRxIov[i];
+        iRxMsgs[i].msg_hdr.msg_iovlen = 1;
+        iRxMsgs[i].msg_hdr.msg_name = &iRxAddr[i];
+    }
+}
+
+SocketUdpBatchNative::~SocketUdpBatchNative()
+{
+    ::close(iFd);
+    ::close(iPipe[0]);
+    ::close(iPipe[1]);
+    delete[] iRxData;
+}
+
+TUint SocketUdpBatchNative::Port() const
+{
+    return iPort;
+}
+
+void SocketUdpBatchNative::SetTtl(TUint aTtl)
+{
+    const int ttl = (int)aTtl;
+    (void)::setsockopt(iFd, IPPROTO_IP, IP_TTL, &ttl, sizeof(ttl));
+    (void)::setsockopt(iFd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+}
+
+void SocketUdpBatchNative::SetRecvBufBytes(TUint aBytes)
+{
+    const int bytes = (int)aBytes;
+    (void)::setsockopt(iFd, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof(bytes));
+}
+
+void SocketUdpBatchNative::Interrupt(TBool aInterrupt)
+{
+    iInterrupted = aInterrupt;
+    if (aInterrupt) {
+        const TByte b = 0;
+        (void)::write(iPipe[1], &b, 1);
+    }
+    else {
+        TByte drain[16];
+        while (::read(iPipe[0], drain, sizeof(drain)) > 0) {
+        }
+    }
+}
+
+void SocketUdpBatchNative::Send(const Brx& aBuffer, const Endpoint& aEndpoint)
+{
+    struct sockaddr_in addr;
+    if (!ToSockAddr(aEndpoint, addr)) {
+        THROW(NetworkError);
+    }
+    for (;;) {
+        iSendCalls++;
+        const ssize_t sent = ::sendto(iFd, aBuffer.Ptr(), aBuffer.Bytes(), 0, (struct sockaddr*)&addr, sizeof(addr));
+        if (sent >= 0) {
+            return;
+        }
+        if (errno != EINTR) {
+            THROW(NetworkError);
+        }
+    }
+}
+
+TUint SocketUdpBatchNative::Send(const Brx& aBuffer, const Endpoint* aEndpoints, TUint aCount)
+{
+    struct mmsghdr msgs[kMaxEndpoints];
+    struct sockaddr_in addrs[kMaxEndpoints];
+    struct iovec iov;
+    iov.iov_base = const_cast<TByte*>(aBuffer.Ptr());
+    iov.iov_len = aBuffer.Bytes();
+
+    // gather sendable endpoints; msgIndex[] maps each back to its bit in the result
+    TUint failed = 0;
+    TUint msgIndex[kMaxEndpoints];
+    TUint count = 0;
+    for (TUint i = 0; i < aCount; i++) {
+        if (!ToSockAddr(aEndpoints[i], addrs[count])) {
+            failed |= 1u << i;
+            continue;
+        }
+        memset(&msgs[count], 0, sizeof(msgs[count]));
+        msgs[count].msg_hdr.msg_name = &addrs[count];
+        msgs[count].msg_hdr.msg_namelen = sizeof(addrs[count]);
+        msgs[count].msg_hdr.msg_iov = &iov;
+        msgs[count].msg_hdr.msg_iovlen = 1;
+        msgIndex[count] = i;
+        count++;
+    }
+
+    /* sendmmsg stops at the first datagram it can't send, returning the number sent so far
+       (or -1 if that was the first).  Skip the failed datagram and carry on with the rest. */
+    TUint next = 0;
+    while (next < count) {
+        iSendCalls++;
+        const int sent = ::sendmmsg(iFd, &msgs[next], count - next, 0);
+        if (sent > 0) {
+            next += (TUint)sent;
+        }
+        else if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        else {
+            failed |= 1u << msgIndex[next];
+            next++;
+        }
+    }
+    return failed;
+}
+
+Endpoint SocketUdpBatchNative::Receive(Bwx& aBuffer)
+{
+    while (iRxIndex == iRxCount) {
+        Fill();
+    }
+    const TUint i = iRxIndex++;
+    TUint bytes = iRxMsgs[i].msg_len;
+    if (bytes > iMaxDatagramBytes) {
+        bytes = iMaxDatagramBytes; // MSG_TRUNC; kernel reports the untruncated length
+    }
+    if (bytes > aBuffer.MaxBytes()) {
+        bytes = aBuffer.MaxBytes();
+    }
+    aBuffer.Replace(iRxData + (i * iMaxDatagramBytes), bytes);
+    TIpAddress addr;
+    addr.iFamily = kFamilyV4;
+    addr.iV4 = iRxAddr[i].sin_addr.s_addr;
+    return Endpoint(ntohs(iRxAddr[i].sin_port), addr);
+}
+
+void SocketUdpBatchNative::Fill()
+{
+    struct pollfd fds[2];
+    fds[0].fd = iFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = iPipe[0];
+    fds[1].events = POLLIN;
+    for (;;) {
+        if (iInterrupted) {
+            THROW(NetworkError);
+        }
+        fds[0].revents = fds[1].revents = 0;
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            THROW(NetworkError);
+        }
+        if (fds[1].revents != 0 || iInterrupted) {
+            THROW(NetworkError);
+        }
+        for (TUint i = 0; i < kMaxBatch; i++) {
+            iRxMsgs[i].msg_hdr.msg_namelen = sizeof(iRxAddr[i]);
+            iRxMsgs[i].msg_hdr.msg_flags = 0;
+        }
+        iReceiveCalls++;
+        const int received = ::recvmmsg(iFd, iRxMsgs, kMaxBatch, MSG_DONTWAIT, nullptr);
+        if (received > 0) {
+            iRxCount = (TUint)received;
+            iRxIndex = 0;
+            return;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            continue;
+        }
+        THROW(NetworkError);
+    }
+}
+
+TBool SocketUdpBatchNative::ToSockAddr(const Endpoint& aEndpoint, struct sockaddr_in& aAddr)
+{
+    const TIpAddress address = aEndpoint.Address();
+    if (address.iFamily != kFamilyV4) {
+        return false;
+    }
+    memset(&aAddr, 0, sizeof(aAddr));
+    aAddr.sin_family = AF_INET;
+    aAddr.sin_port = htons((uint16_t)aEndpoint.Port());
+    aAddr.sin_addr.s_addr = address.iV4;
+    return true;
+}
+
+TBool SocketUdpBatchNative::Batched() const
+{
+    return true;
+}
+
+TUint64 SocketUdpBatchNative::SendCalls() const
+{
+    return iSendCalls;
+}
+
+TUint64 SocketUdpBatchNative::ReceiveCalls() const
+{
+    return iReceiveCalls;
+}
+
+#endif // SOCKET_UDP_BATCH_NATIVE
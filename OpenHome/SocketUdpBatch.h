@@ -0,0 +1,49 @@
+#pragma once
+
+#include <OpenHome/Types.h>
+#include <OpenHome/Buffer.h>
+#include <OpenHome/Private/Network.h>
+#include <OpenHome/Private/Standard.h>
+
+namespace OpenHome {
+
+class Environment;
+class SocketUdpBatchImpl;
+
+/*
+ * Unicast UDP socket that sends and receives several datagrams per system call
+ * where the platform allows it (sendmmsg/recvmmsg on Linux, IPv4 only).
+ * Elsewhere, it falls back to one ohNet SocketUdp call per datagram.
+ *
+ * Receive() returns one datagram per call, but fills a ring of up to kMaxBatch
+ * datagrams each time the socket is read.  Only one thread may Receive() at a
+ * time; Send() may be called from any thread.
+ */
+class SocketUdpBatch : private INonCopyable
+{
+public:
+    static const TUint kMaxBatch = 16;
+    static const TUint kMaxEndpoints = 32;
+public:
+    SocketUdpBatch(Environment& aEnv, TUint aMaxDatagramBytes, TUint aPort, TIpAddress aInterface); // THROWS NetworkError
+    ~SocketUdpBatch();
+    TUint Port() const;
+    void SetTtl(TUint aTtl);
+    void SetRecvBufBytes(TUint aBytes);
+    void Interrupt(TBool aInterrupt);
+    void Send(const Brx& aBuffer, const Endpoint& aEndpoint); // THROWS NetworkError
+    /*
+     * Sends the same datagram to each of aCount (<= kMaxEndpoints) endpoints.
+     * A failure for one endpoint doesn't prevent sends to the remainder.
+     * Returns a bitmask of endpoints that could not be sent to (bit n => aEndpoints[n]).
+     */
+    TUint Send(const Brx& aBuffer, const Endpoint* aEndpoints, TUint aCount);
+    Endpoint Receive(Bwx& aBuffer); // THROWS NetworkError
+    TBool Batched() const;          // false if this platform makes one system call per datagram
+    TUint64 SendCalls() const;      // System calls made by Send()s so far
+    TUint64 ReceiveCalls() const;   // System calls made to read datagrams so far
+private:
+    SocketUdpBatchImpl* iImpl;
+};
+
+} // namespace OpenHome
@@ -4,7 +4,11 @@
 #include <OpenHome/Private/Ascii.h>
 #include <OpenHome/Private/Converter.h>
 #include <OpenHome/Private/Stream.h>
+#include <OpenHome/Net/Private/Globals.h>
+#include <OpenHome/Private/Env.h>
+#include <OpenHome/OsWrapper.h>
 #include <functional>
+#include <vector>
 
 using namespace OpenHome;
 using namespace OpenHome::TestFramework;
@@ -149,6 +153,44 @@ private:
     void TestArrayConclusion();
 };
 
+class SuiteJsonTape : public SuiteUnitTest
+{
+public:
+    SuiteJsonTape();
+public: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestScalars();
+    void TestObject();
+    void TestNestedObject();
+    void TestArray();
+    void TestEmptyContainers();
+    void TestEscapedStrings();
+    void TestNull();
+    void TestMissingKey();
+    void TestWrongType();
+    void TestCorrupt();
+    void TestReuse();
+    void TestMatchesJsonParser();
+    void TestParserAdapter();
+    void TestParserAdapterUnescape();
+private:
+    JsonTape* iTape;
+};
+
+class SuiteJsonTapeBenchmark : public Suite
+{
+    static const TUint kIterations = 10;
+public:
+    SuiteJsonTapeBenchmark();
+    void Test() override;
+private:
+    static void CreateResponse(Bwh& aBuf, TUint aMinBytes);
+    static TUint ReadWithJsonParser(const Brx& aJson);
+    static TUint ReadWithJsonTape(JsonTape& aTape, const Brx& aJson);
+};
+
 } // namespace OpenHome
 
 
@@ -1408,6 +1450,455 @@ void SuiteParserJsonArray::TestArrayConclusion()
     TEST(result.Bytes() == 0);
 }
 
+// SuiteJsonTape
+
+SuiteJsonTape::SuiteJsonTape()
+    : SuiteUnitTest("SuiteJsonTape")
+{
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestScalars), "TestScalars");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestObject), "TestObject");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestNestedObject), "TestNestedObject");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestArray), "TestArray");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestEmptyContainers), "TestEmptyContainers");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestEscapedStrings), "TestEscapedStrings");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestNull), "TestNull");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestMissingKey), "TestMissingKey");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestWrongType), "TestWrongType");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestCorrupt), "TestCorrupt");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestReuse), "TestReuse");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestMatchesJsonParser), "TestMatchesJsonParser");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestParserAdapter), "TestParserAdapter");
+    AddTest(MakeFunctor(*this, &SuiteJsonTape::TestParserAdapterUnescape), "TestParserAdapterUnescape");
+}
+
+void SuiteJsonTape::Setup()
+{
+    iTape = new JsonTape();
+}
+
+void SuiteJsonTape::TearDown()
+{
+    delete iTape;
+}
+
+void SuiteJsonTape::TestScalars()
+{
+    iTape->Parse(Brn("  -123 "));
+    TEST(iTape->Entries() == 1);
+    TEST(iTape->Root().Type() == JsonTape::Type::Num);
+    TEST(iTape->Root().Num() == -123);
+
+    iTape->Parse(Brn("true"));
+    TEST(iTape->Root().Type() == JsonTape::Type::Bool);
+    TEST(iTape->Root().Bool());
+
+    iTape->Parse(Brn("\"str\""));
+    TEST(iTape->Root().Type() == JsonTape::Type::String);
+    TEST(iTape->Root().String() == Brn("str"));
+    TEST(iTape->Root().Raw() == Brn("\"str\""));
+
+    iTape->Parse(Brn("null"));
+    TEST(iTape->Root().IsNull());
+    TEST_THROWS(iTape->Root().String(), JsonValueNull);
+}
+
+void SuiteJsonTape::TestObject()
+{
+    iTape->Parse(Brn("{\"key1\":\"str\", \"key2\" : 12, \"key3\":false, \"key4\":1.5}"));
+    const JsonTapeValue root = iTape->Root();
+    TEST(root.Type() == JsonTape::Type::Object);
+    TEST(root.Count() == 4);
+    TEST(root.HasKey("key1"));
+    TEST(!root.HasKey("key"));
+    TEST(root.String("key1") == Brn("str"));
+    TEST(root.Num("key2") == 12);
+    TEST(root.String("key2") == Brn("12"));
+    TEST(!root.Bool("key3"));
+    TEST(root.String("key4") == Brn("1.5"));
+    TEST_THROWS(root.Num("key1"), JsonCorrupt);
+    TEST_THROWS(root.Bool("key2"), JsonCorrupt);
+
+    std::vector<Brn> keys;
+    root.GetKeys(keys);
+    TEST(keys.size() == 4);
+    TEST(keys[0] == Brn("key1"));
+    TEST(keys[3] == Brn("key4"));
+
+    Brn key;
+    JsonTapeValue val;
+    JsonTapeIterator it = root.Iterate();
+    TEST(it.Next(key, val));
+    TEST(key == Brn("key1"));
+    TEST(val.String() == Brn("str"));
+    TEST(it.Next(val));
+    TEST(val.Num() == 12);
+    TEST(it.Next(key, val));
+    TEST(key == Brn("key3"));
+    TEST(it.Next(key, val));
+    TEST(key == Brn("key4"));
+    TEST(!it.Next(key, val));
+    TEST(!it.Next(val));
+}
+
+void SuiteJsonTape::TestNestedObject()
+{
+    const Brn json("{\"item\":{\"id\":5,\"album\":{\"title\":\"t\",\"artists\":[{\"name\":\"a\"},{\"name\":\"b\"}]}},\"after\":\"x\"}");
+    iTape->Parse(json);
+    const JsonTapeValue root = iTape->Root();
+    TEST(root.Count() == 2);
+    TEST(root.String("after") == Brn("x")); // nested values are skipped
+
+    const JsonTapeValue item = root.Get("item");
+    TEST(item.Num("id") == 5);
+    const JsonTapeValue album = item.Get("album");
+    TEST(album.String("title") == Brn("t"));
+    TEST(!album.HasKey("id"));
+    TEST(item.String("album") == Brn("{\"title\":\"t\",\"artists\":[{\"name\":\"a\"},{\"name\":\"b\"}]}"));
+
+    JsonTapeIterator it = album.Get("artists").Iterate();
+    JsonTapeValue artist;
+    TEST(it.Next(artist));
+    TEST(artist.String("name") == Brn("a"));
+    TEST(it.Next(artist));
+    TEST(artist.String("name") == Brn("b"));
+    TEST(!it.Next(artist));
+
+    // nested values can be handed to the existing parsers
+    JsonParser parser;
+    parser.Parse(item.Raw());
+    TEST(parser.Num("id") == 5);
+}
+
+void SuiteJsonTape::TestArray()
+{
+    iTape->Parse(Brn("[1, \"two\", true, null, [3, 4], {\"five\":5}]"));
+    const JsonTapeValue root = iTape->Root();
+    TEST(root.Type() == JsonTape::Type::Array);
+    TEST(root.Count() == 6);
+
+    JsonTapeIterator it = root.Iterate();
+    JsonTapeValue val;
+    TEST(it.Next(val));
+    TEST(val.Num() == 1);
+    TEST(it.Next(val));
+    TEST(val.String() == Brn("two"));
+    TEST(it.Next(val));
+    TEST(val.Bool());
+    TEST(it.Next(val));
+    TEST(val.IsNull());
+    TEST(it.Next(val));
+    TEST(val.Type() == JsonTape::Type::Array);
+    TEST(val.Raw() == Brn("[3, 4]"));
+    TEST(val.Count() == 2);
+    TEST(it.Next(val));
+    TEST(val.Num("five") == 5);
+    TEST(!it.Next(val));
+
+    Brn key;
+    it = root.Iterate();
+    TEST_THROWS(it.Next(key, val), JsonWrongType);
+}
+
+void SuiteJsonTape::TestEmptyContainers()
+{
+    iTape->Parse(Brn("{ }"));
+    TEST(iTape->Root().Count() == 0);
+    TEST(!iTape->Root().HasKey("key"));
+
+    iTape->Parse(Brn("{\"a\":[],\"b\":{},\"c\":1}"));
+    const JsonTapeValue root = iTape->Root();
+    TEST(root.Get("a").Count() == 0);
+    TEST(root.Get("b").Count() == 0);
+    TEST(root.Num("c") == 1);
+    JsonTapeValue val;
+    TEST(!root.Get("a").Iterate().Next(val));
+}
+
+void SuiteJsonTape::TestEscapedStrings()
+{
+    iTape->Parse(Brn("{\"plain\":\"abc\",\"quote\":\"a\\\"}b\",\"uni\":\"\\u00e9\"}"));
+    const JsonTapeValue root = iTape->Root();
+    TEST(root.String("quote") == Brn("a\\\"}b"));
+
+    Bws<16> buf;
+    const Brn plain = root.Get("plain").StringUnescaped(buf);
+    TEST(plain == Brn("abc"));
+    TEST(buf.Bytes() == 0); // nothing to unescape so no copy made
+    TEST(root.Get("quote").StringUnescaped(buf) == Brn("a\"}b"));
+    TEST(root.Get("uni").StringUnescaped(buf) == Brn("\xe9"));
+    TEST(root.Get("uni").StringUnescaped(buf, Json::Encoding::Utf16) == Brn("\xc3\xa9"));
+
+    Bws<2> tooSmall;
+    TEST_THROWS(root.Get("quote").StringUnescaped(tooSmall), BufferOverflow);
+}
+
+void SuiteJsonTape::TestNull()
+{
+    iTape->Parse(Brn("{\"key\":null}"));
+    const JsonTapeValue root = iTape->Root();
+    TEST(root.HasKey("key"));
+    TEST(root.IsNull("key"));
+    TEST_THROWS(root.String("key"), JsonValueNull);
+    TEST(root.StringOptional("key") == Brx::Empty());
+}
+
+void SuiteJsonTape::TestMissingKey()
+{
+    iTape->Parse(Brn("{\"key\":\"val\"}"));
+    const JsonTapeValue root = iTape->Root();
+    TEST_THROWS(root.Get("missing"), JsonKeyNotFound);
+    TEST_THROWS(root.String("missing"), JsonKeyNotFound);
+    TEST_THROWS(root.Num("missing"), JsonKeyNotFound);
+    TEST_THROWS(root.IsNull("missing"), JsonKeyNotFound);
+    TEST(root.StringOptional("missing") == Brx::Empty());
+    JsonTapeValue val;
+    TEST(!root.TryGet(Brn("val"), val)); // values aren't matched as keys
+}
+
+void SuiteJsonTape::TestWrongType()
+{
+    iTape->Parse(Brn("[1]"));
+    TEST_THROWS(iTape->Root().HasKey("key"), JsonWrongType);
+    iTape->Parse(Brn("\"str\""));
+    TEST_THROWS(iTape->Root().Iterate(), JsonWrongType);
+    TEST_THROWS(iTape->Root().Count(), JsonWrongType);
+}
+
+void SuiteJsonTape::TestCorrupt()
+{
+    const TChar* corrupt[] = {
+        "",
+        "   ",
+        "{",
+        "{\"key\"}",
+        "{\"key\":}",
+        "{\"key\":1,}",
+        "{\"key\" 1}",
+        "{key:1}",
+        "[1,2",
+        "[1 2]",
+        "[1,]",
+        "[}",
+        "{\"key\":[1}",
+        "{\"key\":\"unterminated}",
+        "{\"key\":\"escaped end\\\"}",
+        "{\"key\":tru}",
+        "{} {}",
+        "1 2",
+        "abc",
+    };
+    for (auto json : corrupt) {
+        TEST_THROWS(iTape->Parse(Brn(json)), JsonCorrupt);
+        TEST(iTape->Entries() == 0);
+    }
+}
+
+void SuiteJsonTape::TestReuse()
+{
+    iTape->Parse(Brn("{\"a\":[1,2,3,4,5,6,7,8]}"));
+    TEST(iTape->Entries() == 11);
+    iTape->Parse(Brn("{\"b\":1}"));
+    TEST(iTape->Entries() == 3);
+    TEST(!iTape->Root().HasKey("a"));
+    TEST(iTape->Root().Num("b") == 1);
+    iTape->Reset();
+    TEST(iTape->Entries() == 0);
+}
+
+void SuiteJsonTape::TestMatchesJsonParser()
+{
+    const Brn json("{\"id\":\"1234\",\"title\":\"Track \\\"1\\\"\",\"duration\":321,\"streamReady\":true,"
+                   "\"album\":{\"id\":99,\"title\":\"Album\",\"cover\":\"ab-cd\"},\"version\":null,\"empty\":\"\"}");
+    JsonParser parser;
+    parser.Parse(json);
+    iTape->Parse(json);
+    const JsonTapeValue root = iTape->Root();
+
+    const TChar* keys[] = { "id", "title", "duration", "streamReady", "album", "empty" };
+    for (auto key : keys) {
+        TEST(root.String(key) == parser.String(key));
+    }
+    TEST(root.Num("duration") == parser.Num("duration"));
+    TEST(root.Bool("streamReady") == parser.Bool("streamReady"));
+    TEST(root.IsNull("version") == parser.IsNull("version"));
+    TEST(root.StringOptional("version") == parser.StringOptional("version"));
+    TEST_THROWS(root.String("version"), JsonValueNull);
+    TEST_THROWS(parser.String("version"), JsonValueNull);
+
+    std::vector<Brn> tapeKeys;
+    root.GetKeys(tapeKeys);
+    std::vector<Brn> parserKeys;
+    parser.GetKeys(parserKeys);
+    TEST(tapeKeys.size() == parserKeys.size());
+}
+
+void SuiteJsonTape::TestParserAdapter()
+{
+    JsonParserTape parser;
+    const TChar* empty[] = { "", "  ", "null" };
+    for (auto json : empty) {
+        parser.Parse(Brn(json));
+        TEST(!parser.HasKey("key"));
+        TEST_THROWS(parser.String("key"), JsonKeyNotFound);
+        TEST(parser.StringOptional("key") == Brx::Empty());
+        std::vector<Brn> keys;
+        parser.GetKeys(keys);
+        TEST(keys.size() == 0);
+    }
+    TEST_THROWS(parser.Parse(Brn("[1,2]")), JsonCorrupt);
+    TEST(!parser.HasKey("key"));
+    TEST_THROWS(parser.Parse(Brn("{\"key\":")), JsonCorrupt);
+
+    parser.Parse(Brn("{\"num\":12,\"bool\":false,\"null\":null,\"user\":{\"id\":7,\"credential\":{\"id\":null}},\"items\":[{\"id\":1},{\"id\":2}]}"));
+    TEST(parser.Num("num") == 12);
+    TEST(!parser.Bool("bool"));
+    TEST(parser.IsNull("null"));
+    TEST_THROWS(parser.String("null"), JsonValueNull);
+    TEST(parser.String("user") == Brn("{\"id\":7,\"credential\":{\"id\":null}}"));
+    const JsonTapeValue user = parser.Get("user");
+    TEST(user.Num("id") == 7);
+    TEST(user.Get("credential").IsNull("id"));
+    JsonTapeIterator it = parser.Get("items").Iterate();
+    JsonTapeValue item;
+    TUint id = 1;
+    while (it.Next(item)) {
+        TEST(item.Num("id") == (TInt)id++);
+    }
+    TEST(id == 3);
+    TEST_THROWS(parser.Get("missing"), JsonKeyNotFound);
+
+    parser.Reset();
+    TEST(!parser.HasKey("num"));
+}
+
+void SuiteJsonTape::TestParserAdapterUnescape()
+{
+    const Brn kJson("{\"url\":\"http:\\/\\/a\\/b\",\"plain\":\"abc\",\"nested\":{\"url\":\"c\\/d\"},\"last\":\"x\\ty\"}");
+    Bwh json(kJson);
+    Bwh json2(kJson);
+    JsonParser expected;
+    expected.ParseAndUnescape(json);
+    JsonParserTape parser;
+    parser.ParseAndUnescape(json2);
+
+    TEST(parser.String("url") == Brn("http://a/b"));
+    TEST(parser.String("url") == expected.String("url"));
+    TEST(parser.String("plain") == expected.String("plain"));
+    TEST(parser.String("last") == Brn("x\ty"));
+    TEST(parser.String("last") == expected.String("last"));
+    // as JsonParser, only members of the outer object are unescaped
+    TEST(parser.Get("nested").String("url") == Brn("c\\/d"));
+}
+
+
+// SuiteJsonTapeBenchmark
+
+SuiteJsonTapeBenchmark::SuiteJsonTapeBenchmark()
+    : Suite("JsonTape benchmark")
+{
+}
+
+void SuiteJsonTapeBenchmark::Test()
+{
+    static const TUint kResponseBytes[] = { 100 * 1024, 500 * 1024, 2 * 1024 * 1024 };
+    JsonTape tape;
+    for (auto bytes : kResponseBytes) {
+        Bwh json(bytes + 1024);
+        CreateResponse(json, bytes);
+
+        TUint64 start = Os::TimeInUs(gEnv->OsCtx());
+        TUint parserItems = 0;
+        for (TUint i=0; i<kIterations; i++) {
+            parserItems = ReadWithJsonParser(json);
+        }
+        const TUint64 parserUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+
+        start = Os::TimeInUs(gEnv->OsCtx());
+        TUint tapeItems = 0;
+        for (TUint i=0; i<kIterations; i++) {
+            tapeItems = ReadWithJsonTape(tape, json);
+        }
+        const TUint64 tapeUs = Os::TimeInUs(gEnv->OsCtx()) - start;
+        TEST(tapeItems == parserItems);
+
+        Log::Print("  %ukB, %u items: JsonParser %lluus, JsonTape %lluus (%u entries)\n",
+                   json.Bytes() / 1024, tapeItems, parserUs / kIterations, tapeUs / kIterations, tape.Entries());
+    }
+}
+
+void SuiteJsonTapeBenchmark::CreateResponse(Bwh& aBuf, TUint aMinBytes)
+{ // static
+    // shaped like a Tidal/Qobuz page of tracks: each item has nested album and artist objects
+    aBuf.Replace("{\"limit\":0,\"offset\":0,\"totalNumberOfItems\":0,\"items\":[");
+    TUint id = 10000000;
+    while (aBuf.Bytes() < aMinBytes) {
+        if (id != 10000000) {
+            aBuf.Append(',');
+        }
+        Bws<Ascii::kMaxUintStringBytes> idBuf;
+        Ascii::AppendDec(idBuf, id++);
+        aBuf.Append("{\"item\":{\"id\":");
+        aBuf.Append(idBuf);
+        aBuf.Append(",\"title\":\"Track \\\"");
+        aBuf.Append(idBuf);
+        aBuf.Append("\\\" (Remastered \\u00e9dition)\",\"duration\":245,\"trackNumber\":3,\"volumeNumber\":1,"
+                    "\"allowStreaming\":true,\"streamReady\":true,\"explicit\":false,\"popularity\":42,\"isrc\":\"GBAYE0601498\","
+                    "\"audioQuality\":\"LOSSLESS\",\"mediaMetadata\":{\"tags\":[\"LOSSLESS\",\"HIRES_LOSSLESS\"]},\"version\":null,"
+                    "\"artist\":{\"id\":1566,\"name\":\"The Artist\",\"type\":\"MAIN\",\"picture\":null},"
+                    "\"artists\":[{\"id\":1566,\"name\":\"The Artist\",\"type\":\"MAIN\"},{\"id\":1567,\"name\":\"Guest \\/ Other\",\"type\":\"FEATURED\"}],"
+                    "\"album\":{\"id\":77554412,\"title\":\"Album Title\",\"cover\":\"24f52ab0-e7d6-414d-a650-20a4c686aa57\",\"releaseDate\":\"2017-03-24\"}},"
+                    "\"created\":\"2020-01-01T00:00:00.000+0000\"}");
+    }
+    aBuf.Append("]}");
+}
+
+TUint SuiteJsonTapeBenchmark::ReadWithJsonParser(const Brx& aJson)
+{ // static
+    // as service clients used JsonParser: re-parse each nested object to reach its fields
+    TUint items = 0;
+    JsonParser parser;
+    parser.Parse(aJson);
+    (void)parser.Num("totalNumberOfItems");
+    auto parserItems = JsonParserArray::Create(parser.String("items"));
+    JsonParser parserItem;
+    JsonParser nestedParser;
+    Brn obj;
+    while (parserItems.TryNextObject(obj)) {
+        parserItem.Parse(obj);
+        parserItem.Parse(parserItem.String("item"));
+        (void)parserItem.String("id");
+        (void)parserItem.String("title");
+        (void)parserItem.Num("duration");
+        nestedParser.Parse(parserItem.String("album"));
+        (void)nestedParser.String("cover");
+        nestedParser.Parse(parserItem.String("artist"));
+        (void)nestedParser.String("name");
+        items++;
+    }
+    return items;
+}
+
+TUint SuiteJsonTapeBenchmark::ReadWithJsonTape(JsonTape& aTape, const Brx& aJson)
+{ // static
+    TUint items = 0;
+    aTape.Parse(aJson);
+    const JsonTapeValue root = aTape.Root();
+    (void)root.Num("totalNumberOfItems");
+    JsonTapeIterator it = root.Get("items").Iterate();
+    JsonTapeValue obj;
+    while (it.Next(obj)) {
+        const JsonTapeValue item = obj.Get("item");
+        (void)item.String("id");
+        (void)item.String("title");
+        (void)item.Num("duration");
+        (void)item.Get("album").String("cover");
+        (void)item.Get("artist").String("name");
+        items++;
+    }
+    return items;
+}
+
+
 void TestJson()
 {
     Runner runner("JSON tests\n");
@@ -1418,5 +1909,13 @@ void TestJson()
     runner.Add(new SuiteWriterJsonObject());
     runner.Add(new SuiteWriterJsonArray());
     runner.Add(new SuiteParserJsonArray());
+    runner.Add(new SuiteJsonTape());
+    runner.Run();
+}
+
+void TestJsonBenchmark()
+{
+    Runner runner("JSON parser benchmark\n");
+    runner.Add(new SuiteJsonTapeBenchmark());
     runner.Run();
 }
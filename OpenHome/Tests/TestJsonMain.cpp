@@ -1,14 +1,29 @@
 #include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/OptionParser.h>
 
 using namespace OpenHome;
 using namespace OpenHome::TestFramework;
 
 extern void TestJson();
+extern void TestJsonBenchmark();
 
-void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
 {
+    OptionParser parser;
+    OptionBool optionBenchmark("-b", "--benchmark", "Time parsing of large service responses");
+    parser.AddOption(&optionBenchmark);
+    if (!parser.Parse(aArgc, aArgv)) {
+        delete aInitParams;
+        return;
+    }
+
     Net::UpnpLibrary::InitialiseMinimal(aInitParams);
-    TestJson();
+    if (optionBenchmark.Value()) {
+        TestJsonBenchmark();
+    }
+    else {
+        TestJson();
+    }
     delete aInitParams;
     Net::UpnpLibrary::Close();
 }
@@ -309,7 +309,7 @@ AllocatorConfigValBuf::AllocatorConfigValBuf(const TChar* aName, TUint aNumCells
     : AllocatorBase(aName, aNumCells, sizeof(ConfigValBuf), aInfoAggregator)
 {
     for (TUint i=0; i<aNumCells; i++) {
-        iFree.Write(new ConfigValBuf(*this, aBufBytes));
+        AddCell(new ConfigValBuf(*this, aBufBytes));
     }
 }
 
@@ -1611,6 +1611,7 @@ ConfigAppBase::ConfigAppBase(IInfoAggregator& aInfoAggregator, IConfigManager& a
     iMsgAllocator = new ConfigMessageAllocator(aInfoAggregator, aSendQueueSize, aMsgBufCount, aMsgBufBytes, *this);
 
     iResourceManager = new BlockingResourceManager(aResourceHandlerFactory, aResourceHandlersCount, aResourceDir);
+    iResourceCache = new ResourceCache(*iResourceManager, aResourceHandlersCount, kMaxResourceCacheBytes);
 
     for (TUint i=0; i<aMaxTabs; i++) {
         iTabs.push_back(new ConfigTab(i, *iMsgAllocator, iConfigManager, aRebootHandler));
@@ -1630,6 +1631,7 @@ ConfigAppBase::~ConfigAppBase()
         delete iTabs[i];
     }
 
+    delete iResourceCache;
     delete iResourceManager;
 
     for (auto val : iUiVals) {
@@ -1677,7 +1679,7 @@ IResourceHandler* ConfigAppBase::CreateResourceHandler(const Brx& aResource)
     }
 
     // Blocks until an IResourceHandler is available.
-    return iResourceManager->CreateResourceHandler(resource);
+    return iResourceCache->CreateResourceHandler(resource);
 }
 
 ILanguageResourceReader& ConfigAppBase::CreateLanguageResourceHandler(const Brx& aResourceUriTail, std::vector<Bws<10>>& aLanguageList)
@@ -648,6 +648,7 @@ class ConfigAppBase : public IConfigApp, public ILanguageResourceManager
 {
 private:
     static const TUint kMaxResourcePrefixBytes = 25;
+    static const TUint kMaxResourceCacheBytes = 2 * 1024 * 1024;
     static const Brn kLangRoot;
     static const Brn kDefaultLanguage;
     typedef std::pair<Brn, Brn> ResourcePair;
@@ -686,6 +687,7 @@ private:
     Bwh iLangResourceDir;
     const Bws<kMaxResourcePrefixBytes> iResourcePrefix;
     BlockingResourceManager* iResourceManager;
+    ResourceCache* iResourceCache;
     std::vector<ILanguageResourceReader*> iLanguageResourceHandlers;
     std::vector<ConfigTab*> iTabs;
     std::vector<IConfigUiVal*> iUiVals;
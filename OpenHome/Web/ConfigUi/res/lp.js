@@ -114,11 +114,15 @@ WebUi = function() {
         this.kSessionIdStart = 0;
         this.kSessionIdInvalid = Number.MAX_SAFE_INTEGER;
         this.kResponseTimeoutMs = 10000; // Long poll duration is 5s. Pick a time greater than that to avoid false-positive timeouts.
+        this.kStreamRetryTimeoutMs = 30000; // Server limits how many streams may be open. Long poll for this long after a stream is refused.
 
         this.iSessionId = this.kSessionIdStart;
         this.iNextRequestId = 1;
         this.iPendingRequestsLongPoll = [];
         this.iPendingRequestsUpdate = [];
+        this.iStream = null;
+        this.iStreamSupported = (typeof(EventSource) !== "undefined"); // Updates are pushed over a stream, where possible, instead of being long polled.
+        this.iStreamRetryTime = 0;
         this.iCallbackStarted = aCallbackStarted;
         this.iCallbackSuccess = aCallbackSuccess;
         this.iCallbackFailure = aCallbackFailure;
@@ -222,6 +226,10 @@ WebUi = function() {
             var req = this.iPendingRequestsLongPoll.shift();
             req.Abort();
         }
+        if (this.iStream !== null) {
+            this.iStream.close();
+            this.iStream = null;
+        }
     }
 
     LongPoll.prototype.AbortAllUpdateRequests = function()
@@ -250,13 +258,15 @@ WebUi = function() {
             // Long poll request is in pending list. Act on it.
             this.iPendingRequestsLongPoll.splice(longPollRequestIdx, 1);
 
-            if (aRequest.Type() == HttpRequest.EType.eCreate) {
-                console.log("LongPoll.ResponseSuccess received reponse to eCreate call. Sending eLongPoll");
-                setTimeout(function SendPollCallback() {longPoll.SendPoll();}, 1);
-            }
-            else if (aRequest.Type() == HttpRequest.EType.eLongPoll) {
-                console.log("LongPoll.ResponseSuccess received reponse to eLongPoll call. Sending eLongPoll");
-                setTimeout(function SendPollCallback() {longPoll.SendPoll();}, 1);
+            if (aRequest.Type() == HttpRequest.EType.eCreate || aRequest.Type() == HttpRequest.EType.eLongPoll) {
+                if (this.CanStream()) {
+                    console.log("LongPoll.ResponseSuccess received reponse to %s call. Opening stream", aRequest.Type());
+                    setTimeout(function SendStreamCallback() {longPoll.SendStream();}, 1);
+                }
+                else {
+                    console.log("LongPoll.ResponseSuccess received reponse to %s call. Sending eLongPoll", aRequest.Type());
+                    setTimeout(function SendPollCallback() {longPoll.SendPoll();}, 1);
+                }
             }
             else {
                 // Nothing further to do for eTerminate types.
@@ -297,6 +307,27 @@ WebUi = function() {
         }
     }
 
+    LongPoll.prototype.CanStream = function()
+    {
+        return this.iStreamSupported && Date.now() >= this.iStreamRetryTime;
+    }
+
+    LongPoll.prototype.StreamError = function(aStream)
+    {
+        var longPoll = this;
+        if (aStream === this.iStream) {
+            console.log("LongPoll.StreamError from current stream");
+            // As for ResponseError(), recreate the session.
+            this.AbortAllRequests();
+            this.iSessionId = this.kSessionIdStart;
+            console.log("LongPoll.StreamError sending new eCreate in %d ms", this.kRetryTimeoutMs);
+            setTimeout(function SendCreateCallback() {longPoll.SendCreate();}, this.kRetryTimeoutMs);
+        }
+        else {
+            console.log("LongPoll.StreamError from closed stream");
+        }
+    }
+
     LongPoll.prototype.Terminate = function()
     {
         this.AbortAllRequests();
@@ -446,6 +477,55 @@ WebUi = function() {
         request.Send(sessionId+"\r\n");
     }
 
+    LongPoll.prototype.SendStream = function()
+    {
+        console.log("LongPoll.SendStream\n");
+        var longPoll = this;
+        var opened = false;
+        this.AbortAllLongPollRequests();
+        var stream = new EventSource("lpstream?session-id=" + this.iSessionId);
+        this.iStream = stream;
+
+        stream.onopen = function StreamOpenCallback() {
+            opened = true;
+        };
+        stream.onmessage = function StreamMessageCallback(aEvent) {
+            // Each event carries all updates that were pending for a session: {"session-id": <id>, "messages": [...]}
+            console.log("LongPoll.SendStream.StreamMessageCallback data: " + aEvent.data);
+            try {
+                var json = JSON.parse(aEvent.data);
+                if (json["session-id"] == longPoll.iSessionId) {
+                    longPoll.iCallbackSuccess(json["messages"]);
+                }
+            }
+            catch (err) {
+                console.log("LongPoll.SendStream.StreamMessageCallback " + err);
+                longPoll.StreamError(stream);
+            }
+        };
+        stream.onerror = function StreamErrorCallback() {
+            if (stream !== longPoll.iStream) {
+                console.log("LongPoll.SendStream.StreamErrorCallback from closed stream");
+                return;
+            }
+            // Don't let EventSource reconnect by itself. Each stream occupies a
+            // server session, so long poll until the stream can be reopened.
+            stream.close();
+            longPoll.iStream = null;
+            if (!opened) {
+                // Server refused the stream (e.g., too many are already open) or doesn't support streaming.
+                console.log("LongPoll.SendStream.StreamErrorCallback unable to open stream. Sending eLongPoll for %d ms", longPoll.kStreamRetryTimeoutMs);
+                longPoll.iStreamRetryTime = Date.now() + longPoll.kStreamRetryTimeoutMs;
+            }
+            else {
+                // Server ends streams after a while, or connection was lost.
+                // If session is no longer valid, eLongPoll will fail and a new session will be created.
+                console.log("LongPoll.SendStream.StreamErrorCallback stream ended. Sending eLongPoll");
+            }
+            setTimeout(function SendPollCallback() {longPoll.SendPoll();}, 1);
+        };
+    }
+
     LongPoll.prototype.SendUpdate = function(aString, aCallbackResponse, aCallbackError)
     {
         console.log("LongPoll.SendUpdate " + aString);
@@ -3,10 +3,32 @@
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Private/Debug.h>
 #include <OpenHome/Private/Printer.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Parser.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Thread.h>
 
 using namespace OpenHome;
 using namespace OpenHome::Web;
 
+namespace OpenHome {
+namespace Web {
+
+class WriterResourceCache : public IWriter
+{
+public:
+    WriterResourceCache(Bwx& aBuffer);
+public: // from IWriter
+    void Write(TByte aValue) override;
+    void Write(const Brx& aBuffer) override;
+    void WriteFlush() override;
+private:
+    Bwx& iBuffer;
+};
+
+} // namespace Web
+} // namespace OpenHome
+
 
 // ResourceHandlerBase
 
@@ -59,3 +81,387 @@ void BlockingResourceManager::Deallocate(ResourceHandlerBase* aResourceHandler)
 {
     iFifo.Write(aResourceHandler);
 }
+
+
+// ResourceEncoding
+
+const Brn ResourceEncoding::kNameGzip("gzip");
+const Brn ResourceEncoding::kNameBrotli("br");
+const Brn ResourceEncoding::kExtensionGzip(".gz");
+const Brn ResourceEncoding::kExtensionBrotli(".br");
+
+TUint ResourceEncoding::FromAcceptEncoding(const Brx& aAcceptEncoding)
+{ // static
+    static const TUint kAll = kGzip | kBrotli;
+    TUint accepted = kIdentity;
+    TUint rejected = kIdentity;
+    TBool wildcard = false;
+    Parser parser(aAcceptEncoding);
+    while (!parser.Finished()) {
+        Parser coding(parser.Next(','));
+        const Brn name = Ascii::Trim(coding.Next(';'));
+        TBool allowed = true;
+        while (!coding.Finished()) {
+            Parser param(coding.Next(';'));
+            if (Ascii::Trim(param.Next('=')) == Brn("q")) {
+                // a q-value of zero ("0", "0.0" etc.) means the coding is not acceptable
+                const Brn qvalue = Ascii::Trim(param.Remaining());
+                allowed = false;
+                for (TUint i=0; i<qvalue.Bytes(); i++) {
+                    if (qvalue[i] != '0' && qvalue[i] != '.') {
+                        allowed = true;
+                        break;
+                    }
+                }
+            }
+        }
+        TUint encoding = kIdentity;
+        if (Ascii::CaseInsensitiveEquals(name, kNameGzip) || Ascii::CaseInsensitiveEquals(name, Brn("x-gzip"))) {
+            encoding = kGzip;
+        }
+        else if (Ascii::CaseInsensitiveEquals(name, kNameBrotli)) {
+            encoding = kBrotli;
+        }
+        else if (name == Brn("*")) {
+            wildcard = allowed;
+            continue;
+        }
+        if (allowed) {
+            accepted |= encoding;
+        }
+        else {
+            rejected |= encoding;
+        }
+    }
+    if (wildcard) {
+        accepted |= kAll;
+    }
+    return accepted & ~rejected;
+}
+
+
+// WriterResourceCache
+
+WriterResourceCache::WriterResourceCache(Bwx& aBuffer)
+    : iBuffer(aBuffer)
+{
+}
+
+void WriterResourceCache::Write(TByte aValue)
+{
+    if (iBuffer.Bytes() == iBuffer.MaxBytes()) {
+        THROW(WriterError); // resource is larger than it claimed to be
+    }
+    iBuffer.Append(aValue);
+}
+
+void WriterResourceCache::Write(const Brx& aBuffer)
+{
+    if (iBuffer.BytesRemaining() < aBuffer.Bytes()) {
+        THROW(WriterError);
+    }
+    iBuffer.Append(aBuffer);
+}
+
+void WriterResourceCache::WriteFlush()
+{
+}
+
+
+// ResourceCache::Entry
+
+ResourceCache::Entry::Entry(const Brx& aName)
+    : iName(aName)
+{
+    for (TUint i=0; i<kEncodingCount; i++) {
+        iData[i] = nullptr;
+    }
+}
+
+ResourceCache::Entry::~Entry()
+{
+    for (TUint i=0; i<kEncodingCount; i++) {
+        delete iData[i];
+    }
+}
+
+const Brx& ResourceCache::Entry::Name() const
+{
+    return iName;
+}
+
+TUint ResourceCache::Entry::Bytes() const
+{
+    TUint bytes = 0;
+    for (TUint i=0; i<kEncodingCount; i++) {
+        if (iData[i] != nullptr) {
+            bytes += iData[i]->Bytes();
+        }
+    }
+    return bytes;
+}
+
+void ResourceCache::Entry::Set(TUint aIndex, Bwh* aData, const Brx& aETag)
+{
+    ASSERT(aIndex < kEncodingCount);
+    ASSERT(iData[aIndex] == nullptr);
+    iData[aIndex] = aData;
+    iETag[aIndex].Replace(aETag);
+}
+
+TUint ResourceCache::Entry::Select(TUint aAcceptedEncodings) const
+{
+    // brotli generally compresses text better than gzip so is preferred where both are available
+    if ((aAcceptedEncodings & ResourceEncoding::kBrotli) && iData[2] != nullptr) {
+        return 2;
+    }
+    if ((aAcceptedEncodings & ResourceEncoding::kGzip) && iData[1] != nullptr) {
+        return 1;
+    }
+    return 0;
+}
+
+const Brx& ResourceCache::Entry::Data(TUint aIndex) const
+{
+    ASSERT(iData[aIndex] != nullptr);
+    return *iData[aIndex];
+}
+
+const Brx& ResourceCache::Entry::ETag(TUint aIndex) const
+{
+    return iETag[aIndex];
+}
+
+
+// ResourceCache::Handler
+
+ResourceCache::Handler::Handler(ResourceCache& aCache)
+    : iCache(aCache)
+    , iEntry(nullptr)
+    , iIndex(0)
+{
+}
+
+void ResourceCache::Handler::Set(const Entry& aEntry)
+{
+    iEntry = &aEntry;
+    iIndex = 0;
+}
+
+TUint ResourceCache::Handler::Bytes()
+{
+    return iEntry->Data(iIndex).Bytes();
+}
+
+void ResourceCache::Handler::Write(IWriter& aWriter)
+{
+    aWriter.Write(iEntry->Data(iIndex));
+}
+
+void ResourceCache::Handler::Destroy()
+{
+    iEntry = nullptr;
+    iCache.Release(this);
+}
+
+void ResourceCache::Handler::SetAcceptedEncodings(TUint aEncodings)
+{
+    iIndex = iEntry->Select(aEncodings);
+}
+
+const Brx& ResourceCache::Handler::ContentEncoding()
+{
+    switch (iIndex)
+    {
+    case 1:
+        return ResourceEncoding::kNameGzip;
+    case 2:
+        return ResourceEncoding::kNameBrotli;
+    default:
+        return Brx::Empty();
+    }
+}
+
+const Brx& ResourceCache::Handler::ETag()
+{
+    return iEntry->ETag(iIndex);
+}
+
+
+// ResourceCache
+
+ResourceCache::ResourceCache(IResourceManager& aResourceManager, TUint aHandlerCount, TUint aMaxBytes)
+    : iResourceManager(aResourceManager)
+    , iMaxBytes(aMaxBytes)
+    , iLock("RSCA")
+    , iBytes(0)
+    , iHandlers(aHandlerCount)
+{
+    for (TUint i=0; i<aHandlerCount; i++) {
+        iHandlers.Write(new Handler(*this));
+    }
+}
+
+ResourceCache::~ResourceCache()
+{
+    ASSERT(iHandlers.SlotsFree() == 0); // All resource handlers must have been returned.
+    while (iHandlers.SlotsUsed() > 0) {
+        delete iHandlers.Read();
+    }
+    for (auto it=iEntries.begin(); it!=iEntries.end(); ++it) {
+        delete it->second;
+    }
+}
+
+TUint ResourceCache::Bytes() const
+{
+    AutoMutex _(iLock);
+    return iBytes;
+}
+
+IResourceHandler* ResourceCache::CreateResourceHandler(const Brx& aResourceTail)
+{
+    const Entry* cached = nullptr;
+    {
+        AutoMutex _(iLock);
+        auto it = iEntries.find(Brn(aResourceTail));
+        if (it != iEntries.end()) {
+            cached = it->second;
+        }
+    }
+    if (cached != nullptr) { // entries are never removed so can be used without holding iLock
+        return CreateHandler(*cached);
+    }
+
+    // Not cached yet.  Resources are read without holding iLock so that other resources can still be served.
+    IResourceHandler* handler = iResourceManager.CreateResourceHandler(aResourceTail); // THROWS ResourceInvalid
+    const TUint bytes = handler->Bytes();
+    if (!TryReserve(bytes)) {
+        LOG(kHttp, "ResourceCache::CreateResourceHandler not caching %.*s (%u bytes)\n", PBUF(aResourceTail), bytes);
+        return handler;
+    }
+    Bwh* data = Read(*handler, bytes);
+    const TUint64 hash = Hash(*data);
+    Bws<kMaxETagBytes> etag;
+    FormatETag(etag, hash, Brx::Empty());
+    Entry* entry = new Entry(aResourceTail);
+    entry->Set(0, data, etag);
+    LoadVariant(*entry, 1, ResourceEncoding::kExtensionGzip, Brn("-gzip"), hash);
+    LoadVariant(*entry, 2, ResourceEncoding::kExtensionBrotli, Brn("-br"), hash);
+
+    cached = entry;
+    {
+        AutoMutex _(iLock);
+        auto it = iEntries.find(Brn(aResourceTail));
+        if (it == iEntries.end()) {
+            iEntries.insert(std::pair<Brn, Entry*>(Brn(entry->Name()), entry));
+            entry = nullptr;
+        }
+        else { // another session loaded the same resource at the same time
+            cached = it->second;
+        }
+    }
+    if (entry != nullptr) {
+        Unreserve(entry->Bytes());
+        delete entry;
+    }
+    return CreateHandler(*cached);
+}
+
+IResourceHandler* ResourceCache::CreateHandler(const Entry& aEntry)
+{
+    // Blocks until a Handler is available.
+    Handler* handler = iHandlers.Read();
+    handler->Set(aEntry);
+    return handler;
+}
+
+void ResourceCache::Release(Handler* aHandler)
+{
+    iHandlers.Write(aHandler);
+}
+
+TBool ResourceCache::TryReserve(TUint aBytes)
+{
+    AutoMutex _(iLock);
+    if (aBytes == 0 || aBytes > iMaxBytes - iBytes) {
+        return false;
+    }
+    iBytes += aBytes;
+    return true;
+}
+
+void ResourceCache::Unreserve(TUint aBytes)
+{
+    AutoMutex _(iLock);
+    ASSERT(iBytes >= aBytes);
+    iBytes -= aBytes;
+}
+
+Bwh* ResourceCache::Read(IResourceHandler& aHandler, TUint aBytes)
+{
+    Bwh* data = new Bwh(aBytes);
+    WriterResourceCache writer(*data);
+    try {
+        aHandler.Write(writer);
+    }
+    catch (WriterError&) {
+    }
+    aHandler.Destroy();
+    if (data->Bytes() != aBytes) {
+        LOG_ERROR(kHttp, "ResourceCache::Read expected %u bytes, read %u\n", aBytes, data->Bytes());
+        delete data;
+        Unreserve(aBytes);
+        THROW(ResourceInvalid);
+    }
+    return data;
+}
+
+void ResourceCache::LoadVariant(Entry& aEntry, TUint aIndex, const Brx& aExtension, const Brx& aSuffix, TUint64 aHash)
+{
+    Bwh name(aEntry.Name().Bytes() + aExtension.Bytes());
+    name.Replace(aEntry.Name());
+    name.Append(aExtension);
+    IResourceHandler* handler = nullptr;
+    try {
+        handler = iResourceManager.CreateResourceHandler(name);
+    }
+    catch (ResourceInvalid&) {
+        return; // no variant in this encoding
+    }
+    const TUint bytes = handler->Bytes();
+    if (!TryReserve(bytes)) {
+        handler->Destroy();
+        return;
+    }
+    try {
+        Bwh* data = Read(*handler, bytes);
+        Bws<kMaxETagBytes> etag;
+        FormatETag(etag, aHash, aSuffix);
+        aEntry.Set(aIndex, data, etag);
+    }
+    catch (ResourceInvalid&) {
+    }
+}
+
+TUint64 ResourceCache::Hash(const Brx& aData)
+{ // static
+    // 64-bit FNV-1a.  Only needs to tell different versions of a resource apart, not resist attack.
+    TUint64 hash = 0xcbf29ce484222325ULL;
+    const TByte* ptr = aData.Ptr();
+    const TByte* end = ptr + aData.Bytes();
+    while (ptr < end) {
+        hash ^= *ptr++;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void ResourceCache::FormatETag(Bwx& aETag, TUint64 aHash, const Brx& aSuffix)
+{ // static
+    aETag.Replace("\"");
+    Ascii::AppendHex(aETag, (TUint)(aHash >> 32));
+    Ascii::AppendHex(aETag, (TUint)aHash);
+    aETag.Append(aSuffix);
+    aETag.Append('"');
+}
@@ -3,6 +3,10 @@
 #include <OpenHome/Types.h>
 #include <OpenHome/Buffer.h>
 #include <OpenHome/Private/Fifo.h>
+#include <OpenHome/Private/Standard.h>
+#include <OpenHome/Private/Thread.h>
+
+#include <map>
 
 EXCEPTION(ResourceInvalid);
 
@@ -18,6 +22,28 @@ public:
     virtual void Write(IWriter& aWriter) = 0;   // THROWS WriterError
     virtual void Destroy() = 0;
     virtual ~IResourceHandler() {}
+public: // optional; handlers that don't support encodings or entity tags needn't implement these
+    virtual void SetAcceptedEncodings(TUint /*aEncodings*/) {}          // ResourceEncoding flags; called before Bytes() or Write()
+    virtual const Brx& ContentEncoding() { return Brx::Empty(); }       // coding of the data Write() outputs.  Empty => identity
+    virtual const Brx& ETag() { return Brx::Empty(); }                  // quoted strong entity tag.  Empty => none
+};
+
+/**
+ * Content codings a client may accept (from its Accept-Encoding header) and
+ * that a resource may also be stored in, pre-compressed, as <resource><extension>.
+ */
+class ResourceEncoding
+{
+public:
+    static const TUint kIdentity = 0;
+    static const TUint kGzip     = 1<<0;
+    static const TUint kBrotli   = 1<<1;
+    static const Brn kNameGzip;
+    static const Brn kNameBrotli;
+    static const Brn kExtensionGzip;
+    static const Brn kExtensionBrotli;
+public:
+    static TUint FromAcceptEncoding(const Brx& aAcceptEncoding);
 };
 
 class IResourceManager
@@ -78,5 +104,80 @@ private:
     Fifo<ResourceHandlerBase*> iFifo;
 };
 
+/**
+ * ResourceManager that holds complete copies of another ResourceManager's
+ * resources in memory, so that each is only read once.
+ *
+ * Any pre-compressed variants of a resource (see ResourceEncoding) are read
+ * alongside it.  Each variant is given an entity tag from a hash of the
+ * uncompressed content, allowing clients to make conditional requests.
+ * Resources are assumed not to change for the lifetime of the cache.
+ *
+ * Resources of unknown size, or that would take the cache beyond aMaxBytes,
+ * are streamed from the underlying ResourceManager as before.
+ */
+class ResourceCache : public IResourceManager, private INonCopyable
+{
+    static const TUint kEncodingCount = 3;  // identity, gzip, brotli
+    static const TUint kMaxETagBytes = 24;  // quotes + 16 hex digits + longest suffix
+private:
+    class Entry : private INonCopyable
+    {
+    public:
+        Entry(const Brx& aName);
+        ~Entry();
+        const Brx& Name() const;
+        TUint Bytes() const;
+        void Set(TUint aIndex, Bwh* aData, const Brx& aETag); // takes ownership of aData
+        TUint Select(TUint aAcceptedEncodings) const;        // returns index of preferred variant
+        const Brx& Data(TUint aIndex) const;
+        const Brx& ETag(TUint aIndex) const;
+    private:
+        Brh iName;
+        Bwh* iData[kEncodingCount];
+        Bws<kMaxETagBytes> iETag[kEncodingCount];
+    };
+    class Handler : public IResourceHandler
+    {
+    public:
+        Handler(ResourceCache& aCache);
+        void Set(const Entry& aEntry);
+    public: // from IResourceHandler
+        TUint Bytes() override;
+        void Write(IWriter& aWriter) override;
+        void Destroy() override;
+        void SetAcceptedEncodings(TUint aEncodings) override;
+        const Brx& ContentEncoding() override;
+        const Brx& ETag() override;
+    private:
+        ResourceCache& iCache;
+        const Entry* iEntry;
+        TUint iIndex;
+    };
+    typedef std::map<Brn, Entry*, BufferCmp> EntryMap;
+public:
+    ResourceCache(IResourceManager& aResourceManager, TUint aHandlerCount, TUint aMaxBytes);
+    ~ResourceCache();
+    TUint Bytes() const;    // total size of all cached data
+public: // from IResourceManager
+    IResourceHandler* CreateResourceHandler(const Brx& aResourceTail) override;
+private:
+    IResourceHandler* CreateHandler(const Entry& aEntry);
+    void Release(Handler* aHandler);
+    TBool TryReserve(TUint aBytes);
+    void Unreserve(TUint aBytes);
+    Bwh* Read(IResourceHandler& aHandler, TUint aBytes); // destroys aHandler.  THROWS ResourceInvalid
+    void LoadVariant(Entry& aEntry, TUint aIndex, const Brx& aExtension, const Brx& aSuffix, TUint64 aHash);
+    static TUint64 Hash(const Brx& aData);
+    static void FormatETag(Bwx& aETag, TUint64 aHash, const Brx& aSuffix);
+private:
+    IResourceManager& iResourceManager;
+    const TUint iMaxBytes;
+    mutable Mutex iLock;
+    EntryMap iEntries;
+    TUint iBytes;
+    Fifo<Handler*> iHandlers;
+};
+
 } // namespace Web
 } // namespace OpenHome
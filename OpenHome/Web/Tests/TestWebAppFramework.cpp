@@ -3,10 +3,19 @@
 #include <OpenHome/Private/TestFramework.h>
 #include <OpenHome/Private/SuiteUnitTest.h>
 #include <OpenHome/Private/Standard.h>
+#include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Http.h>
+#include <OpenHome/Private/Ascii.h>
+#include <OpenHome/Private/Printer.h>
+#include <OpenHome/Private/Parser.h>
+#include <OpenHome/OsWrapper.h>
 
 #include <OpenHome/Web/WebAppFramework.h>
+#include <OpenHome/Web/ResourceHandler.h>
 #include <OpenHome/ThreadPool.h>
 
+#include <algorithm>
+
 namespace OpenHome {
 namespace Web {
 namespace Test {
@@ -131,6 +140,16 @@ private:
     ITestPipeWritable& iTestPipe;
 };
 
+class TestHelperPushObserver : public ITabPushObserver
+{
+public:
+    TestHelperPushObserver(ITestPipeWritable& aTestPipe);
+private: // from ITabPushObserver
+    void MessagesPending() override;
+private:
+    ITestPipeWritable& iTestPipe;
+};
+
 class MockWriterThrowsWriterError : public OpenHome::IWriter
 {
 public: // from IWriter
@@ -139,6 +158,25 @@ public: // from IWriter
     void WriteFlush() override;
 };
 
+/*
+ * Sends a msg to a tab from within the first call to Write(), then passes all writes on to another writer.
+ */
+class HelperWriterSendsMessage : public OpenHome::IWriter, private INonCopyable
+{
+public:
+    HelperWriterSendsMessage(ITabHandler& aTabHandler, ITabMessage& aMessage, IWriter& aWriter);
+public: // from IWriter
+    void Write(TByte aValue) override;
+    void Write(const OpenHome::Brx& aBuffer) override;
+    void WriteFlush() override;
+private:
+    void SendIfNotSent();
+private:
+    ITabHandler& iTabHandler;
+    ITabMessage* iMessage;
+    IWriter& iWriter;
+};
+
 class SuiteFrameworkTabHandler : public OpenHome::TestFramework::SuiteUnitTest
 {
 public:
@@ -161,6 +199,9 @@ private:
     void TestBlockingSendQueueFull();
     void TestBlockingSendNewMessageQueued();
     void TestWriterDisconnected();
+    void TestPushObserverNotified();
+    void TestPushObserverMessagesQueued();
+    void TestSendWhileWriting();
 private:
     void LongPollThread();
 private:
@@ -171,6 +212,7 @@ private:
     TestHelperFrameworkSemaphore* iSemWrite;
     TestHelperFrameworkTimer* iTimer;
     FrameworkTabHandler* iTabHandler;
+    TestHelperPushObserver* iPushObserver;
     Semaphore* iSemLpComplete;
 };
 
@@ -256,6 +298,8 @@ public:
 private: // from IFrameworkTabHandler
     void Send(ITabMessage& aMessage);
     void LongPoll(IWriter& aWriter);
+    void SetPushObserver(ITabPushObserver* aObserver);
+    void WritePending(IWriter& aWriter);
     void Enable();
     void Disable();
 private:
@@ -385,6 +429,9 @@ public: // from IFrameworkTab
     void RemoveRef() override;
     void Receive(const Brx& aMessage) override;
     void LongPoll(IWriter& aWriter) override;
+    void StreamStart(ITabPushObserver& aObserver) override;
+    void StreamEnd() override;
+    void WritePending(IWriter& aWriter) override;
     void Interrupt() override;
 private:
     ITestPipeWritable& iTestPipe;
@@ -392,6 +439,7 @@ private:
     TUint iSessionId;
     ITabDestroyHandler* iDestroyHandler;
     TUint iRefCount;
+    TBool iStreaming;
 };
 
 class TestHelperFrameworkTabFull: public IFrameworkTab, private INonCopyable
@@ -403,6 +451,9 @@ public: // from IFrameworkTab
     void RemoveRef() override;
     void Receive(const Brx& aMessage) override;
     void LongPoll(IWriter& aWriter) override;
+    void StreamStart(ITabPushObserver& aObserver) override;
+    void StreamEnd() override;
+    void WritePending(IWriter& aWriter) override;
     void Interrupt() override;
 };
 
@@ -423,11 +474,15 @@ private:
     void TestCreateTabAllocatorEmpty();
     void TestInvalidTabId();
     void TestDeleteWhileTabsAllocated();
+    void TestStream();
+    void TestStreamInvalidTabId();
+    void TestStreamInProgress();
 private:
     TestPipeDynamic* iTestPipe;
     std::vector<TestHelperFrameworkTab*> iTabs;
     TabManager* iTabManager;
     TestHelperWebApp* iWebApp;
+    TestHelperPushObserver* iPushObserver;
 };
 
 class SuiteWebAppFramework : public TestFramework::SuiteUnitTest, private INonCopyable
@@ -452,6 +507,383 @@ private:
     WebAppFramework* iFramework;
 };
 
+class TestHelperMemResourceManager : public IResourceManager, private INonCopyable
+{
+private:
+    class Resource : private INonCopyable
+    {
+    public:
+        Resource(const Brx& aName, const Brx& aData, TUint aBytes);
+    public:
+        Brh iName;
+        Brh iData;
+        TUint iBytes;   // as reported by handlers; may differ from iData
+        TUint iCreateCount;
+    };
+    class Handler : public IResourceHandler
+    {
+    public:
+        Handler(TestHelperMemResourceManager& aManager, const Resource& aResource);
+    public: // from IResourceHandler
+        TUint Bytes() override;
+        void Write(IWriter& aWriter) override;
+        void Destroy() override;
+    private:
+        TestHelperMemResourceManager& iManager;
+        const Resource& iResource;
+    };
+public:
+    TestHelperMemResourceManager();
+    ~TestHelperMemResourceManager();
+    void Add(const Brx& aName, const Brx& aData);
+    void Add(const Brx& aName, const Brx& aData, TUint aBytes);
+    TUint CreateCount(const Brx& aName) const;
+    TUint HandlersOutstanding() const;
+public: // from IResourceManager
+    IResourceHandler* CreateResourceHandler(const Brx& aResourceTail) override;
+private:
+    void Released();
+private:
+    std::vector<Resource*> iResources;
+    TUint iHandlersOutstanding;
+    mutable Mutex iLock;
+};
+
+class TestHelperCachedWebApp : public IWebApp, private INonCopyable
+{
+public:
+    static const TUint kHandlerCount = 4;
+    static const TUint kMaxCacheBytes = 256 * 1024;
+public:
+    TestHelperCachedWebApp(const Brx& aPrefix, TBool aCache);
+    ~TestHelperCachedWebApp();
+    TestHelperMemResourceManager& Resources();
+public: // from IWebApp
+    IResourceHandler* CreateResourceHandler(const Brx& aResource) override;
+    ITab& Create(ITabHandler& aHandler, const std::vector<Bws<10>>& aLanguageList) override;
+    const Brx& ResourcePrefix() const override;
+private:
+    Brh iPrefix;
+    TestHelperMemResourceManager iResources;
+    ResourceCache* iCache;
+};
+
+class TestHelperHeaderValue : public HttpHeader
+{
+    static const TUint kMaxValueBytes = 64;
+public:
+    TestHelperHeaderValue(const TChar* aName);
+    const Brx& Value() const;
+private: // from HttpHeader
+    TBool Recognise(const Brx& aHeader) override;
+    void Process(const Brx& aValue) override;
+private:
+    Brn iName;
+    Bws<kMaxValueBytes> iValue;
+};
+
+/*
+ * Makes a single GET request per connection, as the framework closes the
+ * connection after each response, optionally with conditional or
+ * content-encoding request headers.
+ */
+class TestHelperResourceClient : private INonCopyable
+{
+    static const TUint kReadBufferBytes = 4 * 1024;
+    static const TUint kWriteBufferBytes = 1024;
+    static const TUint kConnectTimeoutMs = 3000;
+    static const TUint kResponseTimeoutMs = 5 * 1000;
+    static const TUint kMaxBodyBytes = 128 * 1024;
+public:
+    TestHelperResourceClient(Environment& aEnv, const Endpoint& aEndpoint);
+    // aIfNoneMatch and aAcceptEncoding are only sent if non-empty.  Returns status code, or 0 on error.
+    TUint Get(const Brx& aPath, const Brx& aIfNoneMatch, const Brx& aAcceptEncoding);
+    const Brx& ETag() const;
+    const Brx& ContentEncoding() const;
+    const Brx& Body() const;
+private:
+    Environment& iEnv;
+    Endpoint iEndpoint;
+    HttpHeaderTransferEncoding iHeaderTransferEncoding;
+    TestHelperHeaderValue iHeaderETag;
+    TestHelperHeaderValue iHeaderContentEncoding;
+    Bwh iBody;
+};
+
+class SuiteResourceCache : public TestFramework::SuiteUnitTest, private INonCopyable
+{
+    static const TUint kHandlerCount = 2;
+    static const TUint kMaxBytes = 1024;
+public:
+    SuiteResourceCache();
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void Get(const Brx& aResource, TUint aEncodings, Bwx& aData, Bwx& aETag, Bwx& aContentEncoding);
+    void TestAcceptEncoding();
+    void TestIfNoneMatch();
+    void TestResourceReadOnce();
+    void TestResourceInvalid();
+    void TestETag();
+    void TestVariantSelection();
+    void TestUnknownSizeNotCached();
+    void TestTooLargeNotCached();
+    void TestShortResource();
+private:
+    TestHelperMemResourceManager* iResources;
+    ResourceCache* iCache;
+};
+
+class SuiteWebAppFrameworkResources : public TestFramework::SuiteUnitTest, private INonCopyable
+{
+public:
+    SuiteWebAppFrameworkResources(Environment& aEnv);
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void PresentationUrlChanged(const Brx& aUrl);
+    void TestGetCached();
+    void TestConditionalGet();
+    void TestGetEncoded();
+    void TestGetUncacheable();
+private:
+    Environment& iEnv;
+    ThreadPool* iThreadPool;
+    WebAppFramework* iFramework;
+    TestHelperCachedWebApp* iWebApp;
+    TestHelperResourceClient* iClient;
+};
+
+class SuiteWebAppFrameworkResourcesBenchmark : public TestFramework::Suite, private INonCopyable
+{
+    static const TUint kRequests = 1000;
+    static const TUint kServerThreads = 4;
+public:
+    SuiteWebAppFrameworkResourcesBenchmark(Environment& aEnv);
+    void Test() override;
+private:
+    void PresentationUrlChanged(const Brx& aUrl);
+    void Run(TestHelperResourceClient& aClient, const TChar* aDescription, const Brx& aPath,
+             TBool aConditional, const Brx& aAcceptEncoding, TUint aExpectedStatus);
+private:
+    Environment& iEnv;
+};
+
+class TestHelperValueMessage : public ITabMessage
+{
+public:
+    TestHelperValueMessage(TUint aValue);
+public: // from ITabMessage
+    void Send(IWriter& aWriter) override;
+    void Destroy() override;    // Deletes this.
+private:
+    const TUint iValue;
+};
+
+/*
+ * Pushes msgs to its tabs, which are identified by the order they were created in.
+ */
+class TestHelperPushWebApp : public IWebApp, private INonCopyable
+{
+public:
+    TestHelperPushWebApp(const Brx& aPrefix);
+    void Send(TUint aIndex, TUint aValue);  // Blocks while tab's send queue is full.
+public: // from IWebApp
+    IResourceHandler* CreateResourceHandler(const Brx& aResource) override;
+    ITab& Create(ITabHandler& aHandler, const std::vector<Bws<10>>& aLanguageList) override;
+    const Brx& ResourcePrefix() const override;
+private:
+    Brh iPrefix;
+    MockTab iTab;
+    std::vector<ITabHandler*> iHandlers;
+    Mutex iLock;
+};
+
+/*
+ * Makes "lpcreate" and "lp" requests, one per connection.
+ */
+class TestHelperLongPollClient : private INonCopyable
+{
+    static const TUint kReadBufferBytes = 4 * 1024;
+    static const TUint kWriteBufferBytes = 1024;
+    static const TUint kConnectTimeoutMs = 3000;
+    static const TUint kResponseTimeoutMs = 10 * 1000;
+    static const TUint kMaxBodyBytes = 16 * 1024;
+public:
+    TestHelperLongPollClient(Environment& aEnv, const Endpoint& aEndpoint, const Brx& aPrefix);
+    TUint Create();                     // Returns session id, or 0 on error.
+    TUint LongPoll(TUint aSessionId);   // Returns status code, or 0 on error.
+    const Brx& Messages() const;        // JSON array from last successful LongPoll(); empty if there were none.
+private:
+    TUint Post(const Brx& aTail, const Brx& aBody);
+private:
+    Environment& iEnv;
+    Endpoint iEndpoint;
+    Brh iPrefix;
+    HttpHeaderTransferEncoding iHeaderTransferEncoding;
+    Bwh iBody;
+    Brn iMessages;
+};
+
+/*
+ * Holds a single "lpstream" request open, reading the events sent for its tabs.
+ */
+class TestHelperStreamClient : private INonCopyable
+{
+    static const TUint kReadBufferBytes = 4 * 1024;
+    static const TUint kWriteBufferBytes = 1024;
+    static const TUint kConnectTimeoutMs = 3000;
+    static const TUint kResponseTimeoutMs = 5 * 1000;
+    static const TUint kMaxEventBytes = 16 * 1024;
+public:
+    TestHelperStreamClient(Environment& aEnv, const Endpoint& aEndpoint);
+    ~TestHelperStreamClient();
+    // Can only be called once.  Returns status code, or 0 on error.  Stream remains open if 200 returned.
+    TUint Open(const Brx& aPath);
+    Brn ReadEvent();    // Returns data of next event, skipping keep-alives.  THROWS ReaderError.
+    void Interrupt();   // Unblocks ReadEvent() from another thread.
+    void Close();
+private:
+    Environment& iEnv;
+    Endpoint iEndpoint;
+    SocketTcpClient iSocket;
+    Srs<kReadBufferBytes> iReadBuffer;
+    ReaderUntilS<kReadBufferBytes> iReaderUntil;
+    ReaderHttpResponse iReaderResponse;
+    HttpHeaderTransferEncoding iHeaderTransferEncoding;
+    ReaderHttpChunked iDechunker;
+    ReaderUntilS<kReadBufferBytes> iReaderEvent;
+    Sws<kWriteBufferBytes> iWriteBuffer;
+    WriterHttpRequest iWriterRequest;
+    Bwh iEvent;
+    TBool iOpen;
+};
+
+/*
+ * Server end of a connection whose client has stopped reading.  The first write blocks until the connection is interrupted.
+ */
+class TestHelperStalledConnection : public IWriter, public IReader, private INonCopyable
+{
+public:
+    TestHelperStalledConnection();
+    void WaitUntilWriting();
+    TBool Interrupted() const;
+public: // from IWriter
+    void Write(TByte aValue) override;
+    void Write(const Brx& aBuffer) override;
+    void WriteFlush() override;
+public: // from IReader
+    Brn Read(TUint aBytes) override;
+    void ReadFlush() override;
+    void ReadInterrupt() override;
+private:
+    void Block();
+private:
+    Semaphore iSemWriting;
+    Semaphore iSemInterrupted;
+    std::atomic<TBool> iInterrupted;
+};
+
+class SuiteTabEventDispatcher : public TestFramework::SuiteUnitTest, private INonCopyable
+{
+public:
+    SuiteTabEventDispatcher(Environment& aEnv);
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void TestMaxStreams();
+    void TestRemoveStalledStream();
+private:
+    Environment& iEnv;
+    std::vector<IFrameworkTab*> iTabs;  // Streams don't need any tabs to write response headers and keep-alives.
+};
+
+class SuiteWebAppFrameworkStream : public TestFramework::SuiteUnitTest, private INonCopyable
+{
+    static const TUint kMaxTabs = 4;
+    static const TUint kTabTimeoutMs = 500;
+public:
+    SuiteWebAppFrameworkStream(Environment& aEnv);
+private: // from SuiteUnitTest
+    void Setup() override;
+    void TearDown() override;
+private:
+    void PresentationUrlChanged(const Brx& aUrl);
+    void StreamPath(const std::vector<TUint>& aIds, Bwx& aPath);
+    void Event(TUint aSessionId, const TChar* aMessages, Bwx& aEvent);
+    void TestStreamMessages();
+    void TestStreamMessagesBatched();
+    void TestStreamMultipleTabs();
+    void TestStreamInvalid();
+    void TestStreamInProgress();
+    void TestStreamTabTimeout();
+private:
+    Environment& iEnv;
+    ThreadPool* iThreadPool;
+    WebAppFramework* iFramework;
+    TestHelperPushWebApp* iWebApp;
+    TestHelperLongPollClient* iClient;
+};
+
+/*
+ * Client thread that receives msgs for one or more tabs, either by long polling
+ * (one tab only) or from a stream, until it has received all that are expected.
+ * As lp.js does, a single tab that can't be streamed is long polled instead.
+ */
+class TestHelperTabReceiver : private INonCopyable
+{
+public:
+    TestHelperTabReceiver(Environment& aEnv, const Endpoint& aEndpoint, const Brx& aPrefix,
+                          const std::vector<TUint>& aIds, TBool aStream, TUint aExpectedMsgs, Semaphore& aSemDone);
+    ~TestHelperTabReceiver();
+    void Start();
+    void Stop();        // Gives up on any msgs not yet received.
+    TUint Msgs() const;
+    TUint Responses() const;    // Long poll responses or stream events carrying msgs.
+    TUint Requests() const;
+    TUint64 LastMsgUs() const;
+    TBool FellBack() const;     // Long polled because the stream was refused.
+private:
+    void Run();
+    void RunLongPoll();
+    void RunStream();
+    void Received(const Brx& aJson);
+private:
+    Environment& iEnv;
+    TestHelperLongPollClient iLongPollClient;
+    TestHelperStreamClient iStreamClient;
+    const std::vector<TUint> iIds;
+    const TBool iStream;
+    const TUint iExpectedMsgs;
+    Semaphore& iSemDone;
+    std::atomic<TBool> iStop;
+    TUint iMsgs;
+    TUint iResponses;
+    TUint iRequests;
+    TUint64 iLastMsgUs;
+    TBool iFellBack;
+    ThreadFunctor* iThread;
+};
+
+class SuiteWebAppFrameworkStreamBenchmark : public TestFramework::Suite, private INonCopyable
+{
+    static const TUint kTabs = 50;
+    static const TUint kRounds = 100;
+    static const TUint kRoundIntervalMs = 5;
+    static const TUint kTimeoutMs = 30 * 1000;
+public:
+    SuiteWebAppFrameworkStreamBenchmark(Environment& aEnv);
+    void Test() override;
+private:
+    void PresentationUrlChanged(const Brx& aUrl);
+    void Run(const TChar* aDescription, TBool aStream);
+private:
+    Environment& iEnv;
+};
+
 } // namespace Test
 } // namespace Web
 } // namespace OpenHome
@@ -579,6 +1011,42 @@ void MockWriterThrowsWriterError::WriteFlush()
 }
 
 
+// HelperWriterSendsMessage
+
+HelperWriterSendsMessage::HelperWriterSendsMessage(ITabHandler& aTabHandler, ITabMessage& aMessage, IWriter& aWriter)
+    : iTabHandler(aTabHandler)
+    , iMessage(&aMessage)
+    , iWriter(aWriter)
+{
+}
+
+void HelperWriterSendsMessage::Write(TByte aValue)
+{
+    SendIfNotSent();
+    iWriter.Write(aValue);
+}
+
+void HelperWriterSendsMessage::Write(const Brx& aBuffer)
+{
+    SendIfNotSent();
+    iWriter.Write(aBuffer);
+}
+
+void HelperWriterSendsMessage::WriteFlush()
+{
+    iWriter.WriteFlush();
+}
+
+void HelperWriterSendsMessage::SendIfNotSent()
+{
+    if (iMessage != nullptr) {
+        ITabMessage& msg = *iMessage;
+        iMessage = nullptr;
+        iTabHandler.Send(msg);
+    }
+}
+
+
 // MockThreadPoolHandle
 
 MockThreadPoolHandle::MockThreadPoolHandle(ITestPipeWritable& aTestPipe, Functor aFunctor)
@@ -730,6 +1198,9 @@ SuiteFrameworkTabHandler::SuiteFrameworkTabHandler()
     AddTest(MakeFunctor(*this, &SuiteFrameworkTabHandler::TestBlockingSendQueueFull), "TestBlockingSendQueueFull");
     AddTest(MakeFunctor(*this, &SuiteFrameworkTabHandler::TestBlockingSendNewMessageQueued), "TestBlockingSendNewMessageQueued");
     AddTest(MakeFunctor(*this, &SuiteFrameworkTabHandler::TestWriterDisconnected), "TestWriterDisconnected");
+    AddTest(MakeFunctor(*this, &SuiteFrameworkTabHandler::TestPushObserverNotified), "TestPushObserverNotified");
+    AddTest(MakeFunctor(*this, &SuiteFrameworkTabHandler::TestPushObserverMessagesQueued), "TestPushObserverMessagesQueued");
+    AddTest(MakeFunctor(*this, &SuiteFrameworkTabHandler::TestSendWhileWriting), "TestSendWhileWriting");
 }
 
 void SuiteFrameworkTabHandler::Setup()
@@ -741,6 +1212,7 @@ void SuiteFrameworkTabHandler::Setup()
     iSemWrite = new TestHelperFrameworkSemaphore("WRITE", *iTestPipe);
     iTimer = new TestHelperFrameworkTimer(*iTestPipe);
     iTabHandler = new FrameworkTabHandler(*iSemRead, *iSemWrite, *iTimer, kSendQueueSize, kSendTimeoutMs);
+    iPushObserver = new TestHelperPushObserver(*iTestPipe);
     iSemLpComplete = new Semaphore("FTHS", 0);
 
     TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Clear READ")));
@@ -756,6 +1228,7 @@ void SuiteFrameworkTabHandler::TearDown()
     tabHandler.Disable();
 
     delete iSemLpComplete;
+    delete iPushObserver;
     delete iTabHandler;
     delete iTimer;
     delete iSemWrite;
@@ -989,38 +1462,145 @@ void SuiteFrameworkTabHandler::TestWriterDisconnected()
     TEST(iTestPipe->ExpectEmpty());
 }
 
-void SuiteFrameworkTabHandler::LongPollThread()
+void SuiteFrameworkTabHandler::TestPushObserverNotified()
 {
     IFrameworkTabHandler& tabHandler = *iTabHandler;
-    tabHandler.LongPoll(*iHelperBufferWriter);
-    iSemLpComplete->Signal();
-}
+    tabHandler.Enable();
+    tabHandler.SetPushObserver(iPushObserver);
+    TEST(iTestPipe->ExpectEmpty());
 
+    HelperTabMessage& msg1 = iTabAllocator->Allocate();
+    msg1.Set(0);
+    tabHandler.Send(msg1);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Wait WRITE")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal READ")));
+    TEST(iTestPipe->Expect(Brn("TestHelperPushObserver::MessagesPending")));
 
-// TestHelperResourceHandler
+    HelperTabMessage& msg2 = iTabAllocator->Allocate();
+    msg2.Set(1);
+    tabHandler.Send(msg2);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Wait WRITE")));
+    // Only expect observer to be notified of first message into FIFO.
+    TEST(iTestPipe->ExpectEmpty());
 
-TUint TestHelperResourceHandler::Bytes()
-{
-    return 0;
-}
+    // Queued msgs are written without blocking or starting a timer.
+    tabHandler.WritePending(*iHelperBufferWriter);
+    TEST(iHelperBufferWriter->Buffer() == Brn("[0,1]"));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Clear READ")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal WRITE")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal WRITE")));
+    TEST(iTestPipe->ExpectEmpty());
 
-void TestHelperResourceHandler::Write(IWriter& /*aWriter*/)
-{
+    // Nothing written if no msgs queued.
+    iHelperBufferWriter->Clear();
+    tabHandler.WritePending(*iHelperBufferWriter);
+    TEST(iHelperBufferWriter->Buffer().Bytes() == 0);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Clear READ")));
+    TEST(iTestPipe->ExpectEmpty());
+
+    // Observer no longer notified once removed.
+    tabHandler.SetPushObserver(nullptr);
+    HelperTabMessage& msg3 = iTabAllocator->Allocate();
+    msg3.Set(2);
+    tabHandler.Send(msg3);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Wait WRITE")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal READ")));
+    TEST(iTestPipe->ExpectEmpty());
 }
 
-void TestHelperResourceHandler::Destroy()
+void SuiteFrameworkTabHandler::TestPushObserverMessagesQueued()
 {
-}
+    IFrameworkTabHandler& tabHandler = *iTabHandler;
+    tabHandler.Enable();
 
+    HelperTabMessage& msg = iTabAllocator->Allocate();
+    msg.Set(0);
+    tabHandler.Send(msg);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Wait WRITE")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal READ")));
 
-// MockTab
+    // Msg was queued before observer was set, so observer must be notified straight away.
+    tabHandler.SetPushObserver(iPushObserver);
+    TEST(iTestPipe->Expect(Brn("TestHelperPushObserver::MessagesPending")));
 
-void MockTab::Receive(const Brx& /*aMessage*/)
-{
-}
+    tabHandler.WritePending(*iHelperBufferWriter);
+    TEST(iHelperBufferWriter->Buffer() == Brn("[0]"));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Clear READ")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal WRITE")));
+    TEST(iTestPipe->ExpectEmpty());
 
-void MockTab::Destroy()
-{
+    tabHandler.SetPushObserver(nullptr);
+}
+
+void SuiteFrameworkTabHandler::TestSendWhileWriting()
+{
+    // Msgs are written without the tab's lock held, so a msg can be queued while others are being written.
+    IFrameworkTabHandler& tabHandler = *iTabHandler;
+    tabHandler.Enable();
+    tabHandler.SetPushObserver(iPushObserver);
+
+    HelperTabMessage& msg1 = iTabAllocator->Allocate();
+    msg1.Set(0);
+    tabHandler.Send(msg1);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Wait WRITE")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal READ")));
+    TEST(iTestPipe->Expect(Brn("TestHelperPushObserver::MessagesPending")));
+
+    HelperTabMessage& msg2 = iTabAllocator->Allocate();
+    msg2.Set(1);
+    HelperWriterSendsMessage writer(tabHandler, msg2, *iHelperBufferWriter);
+    tabHandler.WritePending(writer);
+    TEST(iHelperBufferWriter->Buffer() == Brn("[0]"));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Clear READ")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Wait WRITE")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal READ")));
+    TEST(iTestPipe->Expect(Brn("TestHelperPushObserver::MessagesPending")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal WRITE")));
+    TEST(iTestPipe->ExpectEmpty());
+
+    // Msg queued during the write is picked up by the next one.
+    iHelperBufferWriter->Clear();
+    tabHandler.WritePending(*iHelperBufferWriter);
+    TEST(iHelperBufferWriter->Buffer() == Brn("[1]"));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Clear READ")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkSemaphore::Signal WRITE")));
+    TEST(iTestPipe->ExpectEmpty());
+
+    tabHandler.SetPushObserver(nullptr);
+}
+
+void SuiteFrameworkTabHandler::LongPollThread()
+{
+    IFrameworkTabHandler& tabHandler = *iTabHandler;
+    tabHandler.LongPoll(*iHelperBufferWriter);
+    iSemLpComplete->Signal();
+}
+
+
+// TestHelperResourceHandler
+
+TUint TestHelperResourceHandler::Bytes()
+{
+    return 0;
+}
+
+void TestHelperResourceHandler::Write(IWriter& /*aWriter*/)
+{
+}
+
+void TestHelperResourceHandler::Destroy()
+{
+}
+
+
+// MockTab
+
+void MockTab::Receive(const Brx& /*aMessage*/)
+{
+}
+
+void MockTab::Destroy()
+{
 }
 
 
@@ -1408,6 +1988,19 @@ void TestHelperFrameworkTimer::Cancel()
 }
 
 
+// TestHelperPushObserver
+
+TestHelperPushObserver::TestHelperPushObserver(ITestPipeWritable& aTestPipe)
+    : iTestPipe(aTestPipe)
+{
+}
+
+void TestHelperPushObserver::MessagesPending()
+{
+    iTestPipe.Write(Brn("TestHelperPushObserver::MessagesPending"));
+}
+
+
 // TestHelperTabHandler
 
 TestHelperTabHandler::TestHelperTabHandler(ITestPipeWritable& aTestPipe)
@@ -1429,6 +2022,21 @@ void TestHelperTabHandler::LongPoll(IWriter& /*aWriter*/)
     iTestPipe.Write(Brn("TabHandler::LongPoll"));
 }
 
+void TestHelperTabHandler::SetPushObserver(ITabPushObserver* aObserver)
+{
+    if (aObserver == nullptr) {
+        iTestPipe.Write(Brn("TabHandler::SetPushObserver null"));
+    }
+    else {
+        iTestPipe.Write(Brn("TabHandler::SetPushObserver"));
+    }
+}
+
+void TestHelperTabHandler::WritePending(IWriter& /*aWriter*/)
+{
+    iTestPipe.Write(Brn("TabHandler::WritePending"));
+}
+
 void TestHelperTabHandler::Enable()
 {
     iTestPipe.Write(Brn("TabHandler::Enable"));
@@ -1710,6 +2318,7 @@ TestHelperFrameworkTab::TestHelperFrameworkTab(ITestPipeWritable& aTestPipe, TUi
     , iSessionId(IFrameworkTab::kInvalidTabId)
     , iDestroyHandler(nullptr)
     , iRefCount(0)
+    , iStreaming(false)
 {
 }
 
@@ -1781,6 +2390,33 @@ void TestHelperFrameworkTab::LongPoll(IWriter& /*aWriter*/)
     iTestPipe.Write(buf);
 }
 
+void TestHelperFrameworkTab::StreamStart(ITabPushObserver& /*aObserver*/)
+{
+    Bws<50> buf("TestHelperFrameworkTab::StreamStart ");
+    Ascii::AppendDec(buf, iId);
+    iTestPipe.Write(buf);
+    if (iStreaming) {
+        THROW(WebAppLongPollInProgress);
+    }
+    iStreaming = true;
+}
+
+void TestHelperFrameworkTab::StreamEnd()
+{
+    Bws<50> buf("TestHelperFrameworkTab::StreamEnd ");
+    Ascii::AppendDec(buf, iId);
+    iTestPipe.Write(buf);
+    ASSERT(iStreaming);
+    iStreaming = false;
+}
+
+void TestHelperFrameworkTab::WritePending(IWriter& /*aWriter*/)
+{
+    Bws<50> buf("TestHelperFrameworkTab::WritePending ");
+    Ascii::AppendDec(buf, iId);
+    iTestPipe.Write(buf);
+}
+
 void TestHelperFrameworkTab::Interrupt()
 {
     Bws<50> buf("TestHelperFrameworkTab::Interrupt ");
@@ -1821,6 +2457,21 @@ void TestHelperFrameworkTabFull::LongPoll(IWriter& /*aWriter*/)
     ASSERTS();
 }
 
+void TestHelperFrameworkTabFull::StreamStart(ITabPushObserver& /*aObserver*/)
+{
+    ASSERTS();
+}
+
+void TestHelperFrameworkTabFull::StreamEnd()
+{
+    ASSERTS();
+}
+
+void TestHelperFrameworkTabFull::WritePending(IWriter& /*aWriter*/)
+{
+    ASSERTS();
+}
+
 void TestHelperFrameworkTabFull::Interrupt()
 {
     ASSERTS();
@@ -1841,12 +2492,16 @@ SuiteTabManager::SuiteTabManager()
     AddTest(MakeFunctor(*this, &SuiteTabManager::TestCreateTabAllocatorEmpty), "TestCreateTabAllocatorEmpty");
     AddTest(MakeFunctor(*this, &SuiteTabManager::TestInvalidTabId), "TestInvalidTabId");
     AddTest(MakeFunctor(*this, &SuiteTabManager::TestDeleteWhileTabsAllocated), "TestDeleteWhileTabsAllocated");
+    AddTest(MakeFunctor(*this, &SuiteTabManager::TestStream), "TestStream");
+    AddTest(MakeFunctor(*this, &SuiteTabManager::TestStreamInvalidTabId), "TestStreamInvalidTabId");
+    AddTest(MakeFunctor(*this, &SuiteTabManager::TestStreamInProgress), "TestStreamInProgress");
 }
 
 void SuiteTabManager::Setup()
 {
     iTestPipe = new TestPipeDynamic();
     iWebApp = new TestHelperWebApp();
+    iPushObserver = new TestHelperPushObserver(*iTestPipe);
     for (TUint i=0; i<4; i++) {
         iTabs.push_back(new TestHelperFrameworkTab(*iTestPipe, i));
     }
@@ -1863,6 +2518,7 @@ void SuiteTabManager::TearDown()
 {
     delete iTabManager;
     iTabs.clear();
+    delete iPushObserver;
     delete iWebApp;
     delete iTestPipe;
 }
@@ -2122,6 +2778,103 @@ void SuiteTabManager::TestDeleteWhileTabsAllocated()
     iTabManager->Disable();
 }
 
+void SuiteTabManager::TestStream()
+{
+    std::vector<char*> languages;
+    const TUint id1 = iTabManager->CreateTab(*iWebApp, languages);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::Initialise 0 1")));
+    const TUint id2 = iTabManager->CreateTab(*iWebApp, languages);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::Initialise 1 2")));
+
+    // Refs are held on all tabs until stream ends.
+    const std::vector<TUint> ids = { id1, id2 };
+    std::vector<IFrameworkTab*> tabs;
+    iTabManager->StreamStart(ids, *iPushObserver, tabs);
+    TEST(tabs.size() == 2);
+    TEST(tabs[0] == iTabs[0]);
+    TEST(tabs[1] == iTabs[1]);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::SessionId 0 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::SessionId 0 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::SessionId 1 2")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::AddRef 0")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::AddRef 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::StreamStart 0")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::StreamStart 1")));
+    TEST(iTestPipe->ExpectEmpty());
+
+    iTabManager->StreamEnd(tabs);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::StreamEnd 0")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::RemoveRef 0")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::StreamEnd 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::RemoveRef 1")));
+    TEST(iTestPipe->ExpectEmpty());
+
+    iTabManager->Disable();
+}
+
+void SuiteTabManager::TestStreamInvalidTabId()
+{
+    std::vector<char*> languages;
+    std::vector<IFrameworkTab*> tabs;
+    const std::vector<TUint> ids = { 1 };
+    TEST_THROWS(iTabManager->StreamStart(ids, *iPushObserver, tabs), InvalidTabId);
+    TEST(tabs.size() == 0);
+
+    const TUint id1 = iTabManager->CreateTab(*iWebApp, languages);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::Initialise 0 1")));
+
+    // No refs are taken if any tab is invalid.
+    const std::vector<TUint> idsInvalid = { id1, 3 };
+    TEST_THROWS(iTabManager->StreamStart(idsInvalid, *iPushObserver, tabs), InvalidTabId);
+    TEST(tabs.size() == 0);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::SessionId 0 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::SessionId 0 1")));
+    TEST(iTestPipe->ExpectEmpty());
+
+    iTabManager->Disable();
+}
+
+void SuiteTabManager::TestStreamInProgress()
+{
+    std::vector<char*> languages;
+    const TUint id1 = iTabManager->CreateTab(*iWebApp, languages);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::Initialise 0 1")));
+    const TUint id2 = iTabManager->CreateTab(*iWebApp, languages);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::Initialise 1 2")));
+
+    const std::vector<TUint> ids1 = { id1 };
+    std::vector<IFrameworkTab*> tabs1;
+    iTabManager->StreamStart(ids1, *iPushObserver, tabs1);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::SessionId 0 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::AddRef 0")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::StreamStart 0")));
+
+    // A second stream (from a misbehaving client) including a tab that is already streamed.
+    // Tabs that were started must be ended again and all refs released.
+    const std::vector<TUint> ids2 = { id2, id1 };
+    std::vector<IFrameworkTab*> tabs2;
+    TEST_THROWS(iTabManager->StreamStart(ids2, *iPushObserver, tabs2), WebAppLongPollInProgress);
+    TEST(tabs2.size() == 0);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::SessionId 0 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::SessionId 1 2")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::SessionId 0 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::AddRef 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::AddRef 0")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::StreamStart 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::StreamStart 0")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::StreamEnd 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::RemoveRef 1")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::RemoveRef 0")));
+    TEST(iTestPipe->ExpectEmpty());
+
+    iTabManager->StreamEnd(tabs1);
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::StreamEnd 0")));
+    TEST(iTestPipe->Expect(Brn("TestHelperFrameworkTab::RemoveRef 0")));
+    TEST(iTestPipe->ExpectEmpty());
+
+    iTabManager->Disable();
+}
+
 
 // SuiteWebAppFramework
 
@@ -2253,13 +3006,1477 @@ void SuiteWebAppFramework::TestPostLongPollRequestBeforeStarted()
 }
 
 
+// TestHelperMemResourceManager::Resource
 
-void TestWebAppFramework(Environment& aEnv)
+TestHelperMemResourceManager::Resource::Resource(const Brx& aName, const Brx& aData, TUint aBytes)
+    : iName(aName)
+    , iData(aData)
+    , iBytes(aBytes)
+    , iCreateCount(0)
 {
-    Runner runner("WebApp Framework tests\n");
-    runner.Add(new SuiteFrameworkTabHandler());
-    runner.Add(new SuiteFrameworkTab());
-    runner.Add(new SuiteTabManager());
-    runner.Add(new SuiteWebAppFramework(aEnv));
+}
+
+
+// TestHelperMemResourceManager::Handler
+
+TestHelperMemResourceManager::Handler::Handler(TestHelperMemResourceManager& aManager, const Resource& aResource)
+    : iManager(aManager)
+    , iResource(aResource)
+{
+}
+
+TUint TestHelperMemResourceManager::Handler::Bytes()
+{
+    return iResource.iBytes;
+}
+
+void TestHelperMemResourceManager::Handler::Write(IWriter& aWriter)
+{
+    aWriter.Write(iResource.iData);
+}
+
+void TestHelperMemResourceManager::Handler::Destroy()
+{
+    iManager.Released();
+    delete this;
+}
+
+
+// TestHelperMemResourceManager
+
+TestHelperMemResourceManager::TestHelperMemResourceManager()
+    : iHandlersOutstanding(0)
+    , iLock("TMRM")
+{
+}
+
+TestHelperMemResourceManager::~TestHelperMemResourceManager()
+{
+    ASSERT(iHandlersOutstanding == 0);
+    for (auto resource : iResources) {
+        delete resource;
+    }
+}
+
+void TestHelperMemResourceManager::Add(const Brx& aName, const Brx& aData)
+{
+    Add(aName, aData, aData.Bytes());
+}
+
+void TestHelperMemResourceManager::Add(const Brx& aName, const Brx& aData, TUint aBytes)
+{
+    AutoMutex _(iLock);
+    iResources.push_back(new Resource(aName, aData, aBytes));
+}
+
+TUint TestHelperMemResourceManager::CreateCount(const Brx& aName) const
+{
+    AutoMutex _(iLock);
+    for (auto resource : iResources) {
+        if (resource->iName == aName) {
+            return resource->iCreateCount;
+        }
+    }
+    return 0;
+}
+
+TUint TestHelperMemResourceManager::HandlersOutstanding() const
+{
+    AutoMutex _(iLock);
+    return iHandlersOutstanding;
+}
+
+IResourceHandler* TestHelperMemResourceManager::CreateResourceHandler(const Brx& aResourceTail)
+{
+    AutoMutex _(iLock);
+    for (auto resource : iResources) {
+        if (resource->iName == aResourceTail) {
+            resource->iCreateCount++;
+            iHandlersOutstanding++;
+            return new Handler(*this, *resource);
+        }
+    }
+    THROW(ResourceInvalid);
+}
+
+void TestHelperMemResourceManager::Released()
+{
+    AutoMutex _(iLock);
+    ASSERT(iHandlersOutstanding > 0);
+    iHandlersOutstanding--;
+}
+
+
+// TestHelperCachedWebApp
+
+TestHelperCachedWebApp::TestHelperCachedWebApp(const Brx& aPrefix, TBool aCache)
+    : iPrefix(aPrefix)
+    , iCache(nullptr)
+{
+    if (aCache) {
+        iCache = new ResourceCache(iResources, kHandlerCount, kMaxCacheBytes);
+    }
+}
+
+TestHelperCachedWebApp::~TestHelperCachedWebApp()
+{
+    delete iCache;
+}
+
+TestHelperMemResourceManager& TestHelperCachedWebApp::Resources()
+{
+    return iResources;
+}
+
+IResourceHandler* TestHelperCachedWebApp::CreateResourceHandler(const Brx& aResource)
+{
+    if (iCache != nullptr) {
+        return iCache->CreateResourceHandler(aResource);
+    }
+    return iResources.CreateResourceHandler(aResource);
+}
+
+ITab& TestHelperCachedWebApp::Create(ITabHandler& /*aHandler*/, const std::vector<Bws<10>>& /*aLanguageList*/)
+{
+    THROW(TabAllocatorFull);
+}
+
+const Brx& TestHelperCachedWebApp::ResourcePrefix() const
+{
+    return iPrefix;
+}
+
+
+// TestHelperHeaderValue
+
+TestHelperHeaderValue::TestHelperHeaderValue(const TChar* aName)
+    : iName(aName)
+{
+}
+
+const Brx& TestHelperHeaderValue::Value() const
+{
+    if (Received()) {
+        return iValue;
+    }
+    return Brx::Empty();
+}
+
+TBool TestHelperHeaderValue::Recognise(const Brx& aHeader)
+{
+    return Ascii::CaseInsensitiveEquals(aHeader, iName);
+}
+
+void TestHelperHeaderValue::Process(const Brx& aValue)
+{
+    if (aValue.Bytes() <= iValue.MaxBytes()) {
+        iValue.Replace(aValue);
+        SetReceived();
+    }
+}
+
+
+// TestHelperResourceClient
+
+TestHelperResourceClient::TestHelperResourceClient(Environment& aEnv, const Endpoint& aEndpoint)
+    : iEnv(aEnv)
+    , iEndpoint(aEndpoint)
+    , iHeaderETag("ETag")
+    , iHeaderContentEncoding("Content-Encoding")
+    , iBody(kMaxBodyBytes)
+{
+}
+
+TUint TestHelperResourceClient::Get(const Brx& aPath, const Brx& aIfNoneMatch, const Brx& aAcceptEncoding)
+{
+    iBody.SetBytes(0);
+    SocketTcpClient socket;
+    socket.Open(iEnv);
+    Srs<kReadBufferBytes> readBuffer(socket);
+    ReaderUntilS<kReadBufferBytes> readerUntil(readBuffer);
+    ReaderHttpResponse readerResponse(iEnv, readerUntil);
+    readerResponse.AddHeader(iHeaderTransferEncoding);
+    readerResponse.AddHeader(iHeaderETag);
+    readerResponse.AddHeader(iHeaderContentEncoding);
+    ReaderHttpChunked dechunker(readerUntil);
+    Sws<kWriteBufferBytes> writeBuffer(socket);
+    WriterHttpRequest writerRequest(writeBuffer);
+
+    TUint code = 0;
+    try {
+        socket.Connect(iEndpoint, kConnectTimeoutMs);
+        Endpoint::AddressBuf host;
+        iEndpoint.AppendAddress(host);
+        writerRequest.WriteMethod(Http::kMethodGet, aPath, Http::eHttp11);
+        Http::WriteHeaderHostAndPort(writerRequest, host, iEndpoint.Port());
+        if (aIfNoneMatch.Bytes() > 0) {
+            writerRequest.WriteHeader(Brn("If-None-Match"), aIfNoneMatch);
+        }
+        if (aAcceptEncoding.Bytes() > 0) {
+            writerRequest.WriteHeader(Brn("Accept-Encoding"), aAcceptEncoding);
+        }
+        Http::WriteHeaderConnectionClose(writerRequest);
+        writerRequest.WriteFlush();
+
+        readerResponse.Read(kResponseTimeoutMs);
+        code = readerResponse.Status().Code();
+        if (code != HttpStatus::kNotModified.Code()) {
+            dechunker.SetChunked(iHeaderTransferEncoding.IsChunked());
+            for (;;) {
+                Brn buf = dechunker.Read(kReadBufferBytes);
+                if (buf.Bytes() == 0) {
+                    break;
+                }
+                if (buf.Bytes() > iBody.BytesRemaining()) {
+                    code = 0;
+                    break;
+                }
+                iBody.Append(buf);
+            }
+        }
+    }
+    catch (NetworkTimeout&) {
+        code = 0;
+    }
+    catch (NetworkError&) {
+        code = 0;
+    }
+    catch (WriterError&) {
+        code = 0;
+    }
+    catch (HttpError&) {
+        code = 0;
+    }
+    catch (ReaderError&) {
+        // Unchunked responses end when the server closes the connection.
+        if (iHeaderTransferEncoding.IsChunked()) {
+            code = 0;
+        }
+    }
+    socket.Close();
+    return code;
+}
+
+const Brx& TestHelperResourceClient::ETag() const
+{
+    return iHeaderETag.Value();
+}
+
+const Brx& TestHelperResourceClient::ContentEncoding() const
+{
+    return iHeaderContentEncoding.Value();
+}
+
+const Brx& TestHelperResourceClient::Body() const
+{
+    return iBody;
+}
+
+
+// SuiteResourceCache
+
+SuiteResourceCache::SuiteResourceCache()
+    : SuiteUnitTest("SuiteResourceCache")
+{
+    AddTest(MakeFunctor(*this, &SuiteResourceCache::TestAcceptEncoding), "TestAcceptEncoding");
+    AddTest(MakeFunctor(*this, &SuiteResourceCache::TestIfNoneMatch), "TestIfNoneMatch");
+    AddTest(MakeFunctor(*this, &SuiteResourceCache::TestResourceReadOnce), "TestResourceReadOnce");
+    AddTest(MakeFunctor(*this, &SuiteResourceCache::TestResourceInvalid), "TestResourceInvalid");
+    AddTest(MakeFunctor(*this, &SuiteResourceCache::TestETag), "TestETag");
+    AddTest(MakeFunctor(*this, &SuiteResourceCache::TestVariantSelection), "TestVariantSelection");
+    AddTest(MakeFunctor(*this, &SuiteResourceCache::TestUnknownSizeNotCached), "TestUnknownSizeNotCached");
+    AddTest(MakeFunctor(*this, &SuiteResourceCache::TestTooLargeNotCached), "TestTooLargeNotCached");
+    AddTest(MakeFunctor(*this, &SuiteResourceCache::TestShortResource), "TestShortResource");
+}
+
+void SuiteResourceCache::Setup()
+{
+    iResources = new TestHelperMemResourceManager();
+    iResources->Add(Brn("index.html"), Brn("<html>index</html>"));
+    iResources->Add(Brn("copy.html"), Brn("<html>index</html>"));
+    iResources->Add(Brn("app.js"), Brn("var app = 1;"));
+    iResources->Add(Brn("app.js.gz"), Brn("gzip-app"));
+    iResources->Add(Brn("app.js.br"), Brn("br-app"));
+    iResources->Add(Brn("style.css"), Brn("body {}"));
+    iResources->Add(Brn("style.css.gz"), Brn("gzip-style"));
+    iResources->Add(Brn("unknown.txt"), Brn("unknown size"), 0);
+    iResources->Add(Brn("short.txt"), Brn("short"), 10);
+    Bwh large(kMaxBytes + 1);
+    large.SetBytes(large.MaxBytes());
+    large.Fill('x');
+    iResources->Add(Brn("large.bin"), large);
+    iCache = new ResourceCache(*iResources, kHandlerCount, kMaxBytes);
+}
+
+void SuiteResourceCache::TearDown()
+{
+    delete iCache;
+    TEST(iResources->HandlersOutstanding() == 0);
+    delete iResources;
+}
+
+void SuiteResourceCache::Get(const Brx& aResource, TUint aEncodings, Bwx& aData, Bwx& aETag, Bwx& aContentEncoding)
+{
+    IResourceHandler* handler = iCache->CreateResourceHandler(aResource);
+    handler->SetAcceptedEncodings(aEncodings);
+    const TUint bytes = handler->Bytes();
+    aETag.Replace(handler->ETag());
+    aContentEncoding.Replace(handler->ContentEncoding());
+    aData.SetBytes(0);
+    WriterBuffer writer(aData);
+    handler->Write(writer);
+    handler->Destroy();
+    TEST(bytes == 0 || bytes == aData.Bytes());
+}
+
+void SuiteResourceCache::TestAcceptEncoding()
+{
+    const TUint kBoth = ResourceEncoding::kGzip | ResourceEncoding::kBrotli;
+    TEST(ResourceEncoding::FromAcceptEncoding(Brx::Empty()) == ResourceEncoding::kIdentity);
+    TEST(ResourceEncoding::FromAcceptEncoding(Brn("identity, deflate")) == ResourceEncoding::kIdentity);
+    TEST(ResourceEncoding::FromAcceptEncoding(Brn("gzip")) == ResourceEncoding::kGzip);
+    TEST(ResourceEncoding::FromAcceptEncoding(Brn("GZIP;q=0.5")) == ResourceEncoding::kGzip);
+    TEST(ResourceEncoding::FromAcceptEncoding(Brn("gzip, deflate, br")) == kBoth);
+    TEST(ResourceEncoding::FromAcceptEncoding(Brn("br;q=0, gzip")) == ResourceEncoding::kGzip);
+    TEST(ResourceEncoding::FromAcceptEncoding(Brn("br;q=0.001")) == ResourceEncoding::kBrotli);
+    TEST(ResourceEncoding::FromAcceptEncoding(Brn("*")) == kBoth);
+    TEST(ResourceEncoding::FromAcceptEncoding(Brn("*, gzip; q=0.000")) == ResourceEncoding::kBrotli);
+    TEST(ResourceEncoding::FromAcceptEncoding(Brn("*;q=0")) == ResourceEncoding::kIdentity);
+}
+
+void SuiteResourceCache::TestIfNoneMatch()
+{
+    HeaderIfNoneMatch ifNoneMatch;
+    IHttpHeader& header = ifNoneMatch;
+    const Brn etag("\"0123456789abcdef\"");
+    header.Reset();
+    TEST(!ifNoneMatch.Matches(etag));
+    header.Process(etag);
+    TEST(ifNoneMatch.Matches(etag));
+    TEST(!ifNoneMatch.Matches(Brn("\"0123456789abcdee\"")));
+    header.Process(Brn("\"fedcba9876543210\", W/\"0123456789abcdef\""));
+    TEST(ifNoneMatch.Matches(etag));
+    header.Process(Brn("*"));
+    TEST(ifNoneMatch.Matches(etag));
+    header.Reset();
+    TEST(!ifNoneMatch.Matches(etag));
+}
+
+void SuiteResourceCache::TestResourceReadOnce()
+{
+    Bws<64> data;
+    Bws<32> etag;
+    Bws<8> encoding;
+    for (TUint i=0; i<3; i++) {
+        Get(Brn("index.html"), ResourceEncoding::kIdentity, data, etag, encoding);
+        TEST(data == Brn("<html>index</html>"));
+    }
+    TEST(iResources->CreateCount(Brn("index.html")) == 1);
+    TEST(iCache->Bytes() == data.Bytes());
+}
+
+void SuiteResourceCache::TestResourceInvalid()
+{
+    TEST_THROWS(iCache->CreateResourceHandler(Brn("missing.html")), ResourceInvalid);
+    TEST_THROWS(iCache->CreateResourceHandler(Brn("missing.html")), ResourceInvalid);
+    TEST(iCache->Bytes() == 0);
+}
+
+void SuiteResourceCache::TestETag()
+{
+    Bws<64> data;
+    Bws<32> etagIndex;
+    Bws<32> etagCopy;
+    Bws<32> etagApp;
+    Bws<32> etag;
+    Bws<8> encoding;
+    Get(Brn("index.html"), ResourceEncoding::kIdentity, data, etagIndex, encoding);
+    TEST(etagIndex.Bytes() == 18); // 64-bit hash as hex, quoted
+    TEST(etagIndex[0] == '"');
+    TEST(etagIndex[etagIndex.Bytes()-1] == '"');
+    Get(Brn("index.html"), ResourceEncoding::kIdentity, data, etag, encoding);
+    TEST(etag == etagIndex);
+    Get(Brn("copy.html"), ResourceEncoding::kIdentity, data, etagCopy, encoding);
+    TEST(etagCopy == etagIndex); // same content
+    Get(Brn("app.js"), ResourceEncoding::kIdentity, data, etagApp, encoding);
+    TEST(etagApp != etagIndex);
+}
+
+void SuiteResourceCache::TestVariantSelection()
+{
+    Bws<64> data;
+    Bws<32> etagIdentity;
+    Bws<32> etag;
+    Bws<8> encoding;
+    Get(Brn("app.js"), ResourceEncoding::kIdentity, data, etagIdentity, encoding);
+    TEST(data == Brn("var app = 1;"));
+    TEST(encoding.Bytes() == 0);
+
+    Get(Brn("app.js"), ResourceEncoding::kGzip, data, etag, encoding);
+    TEST(data == Brn("gzip-app"));
+    TEST(encoding == ResourceEncoding::kNameGzip);
+    TEST(etag != etagIdentity);
+
+    Get(Brn("app.js"), ResourceEncoding::kGzip | ResourceEncoding::kBrotli, data, etag, encoding);
+    TEST(data == Brn("br-app"));
+    TEST(encoding == ResourceEncoding::kNameBrotli);
+    TEST(etag != etagIdentity);
+
+    Get(Brn("style.css"), ResourceEncoding::kBrotli, data, etag, encoding);
+    TEST(data == Brn("body {}"));
+    TEST(encoding.Bytes() == 0);
+    Get(Brn("style.css"), ResourceEncoding::kGzip | ResourceEncoding::kBrotli, data, etag, encoding);
+    TEST(data == Brn("gzip-style"));
+    TEST(encoding == ResourceEncoding::kNameGzip);
+
+    // variants are only read once, along with the resource
+    TEST(iResources->CreateCount(Brn("app.js")) == 1);
+    TEST(iResources->CreateCount(Brn("app.js.gz")) == 1);
+    TEST(iResources->CreateCount(Brn("app.js.br")) == 1);
+}
+
+void SuiteResourceCache::TestUnknownSizeNotCached()
+{
+    Bws<64> data;
+    Bws<32> etag;
+    Bws<8> encoding;
+    for (TUint i=0; i<2; i++) {
+        Get(Brn("unknown.txt"), ResourceEncoding::kGzip, data, etag, encoding);
+        TEST(data == Brn("unknown size"));
+        TEST(etag.Bytes() == 0);
+        TEST(encoding.Bytes() == 0);
+    }
+    TEST(iResources->CreateCount(Brn("unknown.txt")) == 2);
+    TEST(iCache->Bytes() == 0);
+}
+
+void SuiteResourceCache::TestTooLargeNotCached()
+{
+    Bws<2 * kMaxBytes> data;
+    Bws<32> etag;
+    Bws<8> encoding;
+    for (TUint i=0; i<2; i++) {
+        Get(Brn("large.bin"), ResourceEncoding::kIdentity, data, etag, encoding);
+        TEST(data.Bytes() == kMaxBytes + 1);
+        TEST(etag.Bytes() == 0);
+    }
+    TEST(iResources->CreateCount(Brn("large.bin")) == 2);
+    TEST(iCache->Bytes() == 0);
+}
+
+void SuiteResourceCache::TestShortResource()
+{
+    // Handler claims more bytes than it writes.  Should be treated as a read error, not cached.
+    TEST_THROWS(iCache->CreateResourceHandler(Brn("short.txt")), ResourceInvalid);
+    TEST(iCache->Bytes() == 0);
+}
+
+
+// SuiteWebAppFrameworkResources
+
+SuiteWebAppFrameworkResources::SuiteWebAppFrameworkResources(Environment& aEnv)
+    : SuiteUnitTest("SuiteWebAppFrameworkResources")
+    , iEnv(aEnv)
+{
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkResources::TestGetCached), "TestGetCached");
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkResources::TestConditionalGet), "TestConditionalGet");
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkResources::TestGetEncoded), "TestGetEncoded");
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkResources::TestGetUncacheable), "TestGetUncacheable");
+}
+
+void SuiteWebAppFrameworkResources::Setup()
+{
+    iThreadPool = new ThreadPool(1, 1, 1);
+    WebAppFrameworkInitParams* initParams = new WebAppFrameworkInitParams();
+    iFramework = new WebAppFramework(iEnv, initParams, *iThreadPool);
+    iWebApp = new TestHelperCachedWebApp(Brn("CachedApp"), true);
+    TestHelperMemResourceManager& resources = iWebApp->Resources();
+    resources.Add(Brn("index.html"), Brn("<html>index</html>"));
+    resources.Add(Brn("app.js"), Brn("var app = 1;"));
+    resources.Add(Brn("app.js.gz"), Brn("gzip-app"));
+    resources.Add(Brn("app.js.br"), Brn("br-app"));
+    resources.Add(Brn("unknown.txt"), Brn("unknown size"), 0);
+    iFramework->Add(iWebApp, MakeFunctorGeneric(*this, &SuiteWebAppFrameworkResources::PresentationUrlChanged));
+    iFramework->Start();
+    iClient = new TestHelperResourceClient(iEnv, Endpoint(iFramework->Port(), iFramework->Interface()));
+}
+
+void SuiteWebAppFrameworkResources::TearDown()
+{
+    delete iClient;
+    delete iFramework;
+    delete iThreadPool;
+}
+
+void SuiteWebAppFrameworkResources::PresentationUrlChanged(const Brx& /*aUrl*/)
+{
+}
+
+void SuiteWebAppFrameworkResources::TestGetCached()
+{
+    const Brn path("/CachedApp/index.html");
+    TEST(iClient->Get(path, Brx::Empty(), Brx::Empty()) == HttpStatus::kOk.Code());
+    TEST(iClient->Body() == Brn("<html>index</html>"));
+    Bws<64> etag(iClient->ETag());
+    TEST(etag.Bytes() > 0);
+    TEST(iClient->ContentEncoding().Bytes() == 0);
+
+    TEST(iClient->Get(path, Brx::Empty(), Brx::Empty()) == HttpStatus::kOk.Code());
+    TEST(iClient->Body() == Brn("<html>index</html>"));
+    TEST(iClient->ETag() == etag);
+    TEST(iWebApp->Resources().CreateCount(Brn("index.html")) == 1);
+}
+
+void SuiteWebAppFrameworkResources::TestConditionalGet()
+{
+    const Brn path("/CachedApp/index.html");
+    TEST(iClient->Get(path, Brx::Empty(), Brx::Empty()) == HttpStatus::kOk.Code());
+    Bws<64> etag(iClient->ETag());
+
+    TEST(iClient->Get(path, etag, Brx::Empty()) == HttpStatus::kNotModified.Code());
+    TEST(iClient->Body().Bytes() == 0);
+    TEST(iClient->ETag() == etag);
+
+    Bws<80> etags("\"0000000000000000\", W/");
+    etags.Append(etag);
+    TEST(iClient->Get(path, etags, Brx::Empty()) == HttpStatus::kNotModified.Code());
+
+    TEST(iClient->Get(path, Brn("\"0000000000000000\""), Brx::Empty()) == HttpStatus::kOk.Code());
+    TEST(iClient->Body() == Brn("<html>index</html>"));
+}
+
+void SuiteWebAppFrameworkResources::TestGetEncoded()
+{
+    const Brn path("/CachedApp/app.js");
+    TEST(iClient->Get(path, Brx::Empty(), Brn("gzip, deflate")) == HttpStatus::kOk.Code());
+    TEST(iClient->Body() == Brn("gzip-app"));
+    TEST(iClient->ContentEncoding() == Brn("gzip"));
+    Bws<64> etagGzip(iClient->ETag());
+
+    TEST(iClient->Get(path, Brx::Empty(), Brn("gzip, deflate, br")) == HttpStatus::kOk.Code());
+    TEST(iClient->Body() == Brn("br-app"));
+    TEST(iClient->ContentEncoding() == Brn("br"));
+    TEST(iClient->ETag() != etagGzip);
+
+    TEST(iClient->Get(path, etagGzip, Brn("gzip")) == HttpStatus::kNotModified.Code());
+    // client no longer accepts gzip so its copy can't be reused
+    TEST(iClient->Get(path, etagGzip, Brx::Empty()) == HttpStatus::kOk.Code());
+    TEST(iClient->Body() == Brn("var app = 1;"));
+    TEST(iClient->ContentEncoding().Bytes() == 0);
+}
+
+void SuiteWebAppFrameworkResources::TestGetUncacheable()
+{
+    const Brn path("/CachedApp/unknown.txt");
+    TEST(iClient->Get(path, Brx::Empty(), Brx::Empty()) == HttpStatus::kOk.Code());
+    TEST(iClient->Body() == Brn("unknown size"));
+    TEST(iClient->ETag().Bytes() == 0);
+    TEST(iClient->Get(path, Brn("*"), Brx::Empty()) == HttpStatus::kOk.Code());
+}
+
+
+// SuiteWebAppFrameworkResourcesBenchmark
+
+SuiteWebAppFrameworkResourcesBenchmark::SuiteWebAppFrameworkResourcesBenchmark(Environment& aEnv)
+    : Suite("WebAppFramework static resources load test")
+    , iEnv(aEnv)
+{
+}
+
+void SuiteWebAppFrameworkResourcesBenchmark::Test()
+{
+    // A typical script, plus compressed variants of the sizes gzip and brotli would produce.
+    static const TUint kScriptBytes = 96 * 1024;
+    Bwh script(kScriptBytes);
+    while (script.Bytes() + 32 <= script.MaxBytes()) {
+        script.Append("function f");
+        Ascii::AppendDec(script, script.Bytes());
+        script.Append("() { return 1; }\n");
+    }
+    Bwh gzip(script.Bytes() / 4);
+    gzip.SetBytes(gzip.MaxBytes());
+    gzip.Fill('g');
+    Bwh brotli(script.Bytes() / 5);
+    brotli.SetBytes(brotli.MaxBytes());
+    brotli.Fill('b');
+
+    ThreadPool* threadPool = new ThreadPool(1, 1, 1);
+    WebAppFrameworkInitParams* initParams = new WebAppFrameworkInitParams();
+    initParams->SetMinServerThreadsResources(kServerThreads);
+    WebAppFramework* framework = new WebAppFramework(iEnv, initParams, *threadPool);
+    const TBool kCached[] = { false, true };
+    const TChar* kPrefixes[] = { "Uncached", "Cached" };
+    for (TUint i=0; i<2; i++) {
+        TestHelperCachedWebApp* webApp = new TestHelperCachedWebApp(Brn(kPrefixes[i]), kCached[i]);
+        webApp->Resources().Add(Brn("app.js"), script);
+        webApp->Resources().Add(Brn("app.js.gz"), gzip);
+        webApp->Resources().Add(Brn("app.js.br"), brotli);
+        framework->Add(webApp, MakeFunctorGeneric(*this, &SuiteWebAppFrameworkResourcesBenchmark::PresentationUrlChanged));
+    }
+    framework->Start();
+
+    // Resources are held in memory by both apps, so this measures the framework, not disk access.
+    TestHelperResourceClient client(iEnv, Endpoint(framework->Port(), framework->Interface()));
+    Log::Print("  %u requests for a %u byte resource:\n", kRequests, script.Bytes());
+    Run(client, "uncached", Brn("/Uncached/app.js"), false, Brx::Empty(), HttpStatus::kOk.Code());
+    Run(client, "cached", Brn("/Cached/app.js"), false, Brx::Empty(), HttpStatus::kOk.Code());
+    Run(client, "cached, gzip", Brn("/Cached/app.js"), false, Brn("gzip, deflate"), HttpStatus::kOk.Code());
+    Run(client, "cached, br", Brn("/Cached/app.js"), false, Brn("gzip, deflate, br"), HttpStatus::kOk.Code());
+    Run(client, "cached, If-None-Match", Brn("/Cached/app.js"), true, Brn("gzip, deflate, br"), HttpStatus::kNotModified.Code());
+
+    delete framework;
+    delete threadPool;
+}
+
+void SuiteWebAppFrameworkResourcesBenchmark::PresentationUrlChanged(const Brx& /*aUrl*/)
+{
+}
+
+void SuiteWebAppFrameworkResourcesBenchmark::Run(TestHelperResourceClient& aClient, const TChar* aDescription, const Brx& aPath,
+                                                 TBool aConditional, const Brx& aAcceptEncoding, TUint aExpectedStatus)
+{
+    Bws<64> etag;
+    if (aConditional) {
+        TEST(aClient.Get(aPath, Brx::Empty(), aAcceptEncoding) == HttpStatus::kOk.Code());
+        etag.Replace(aClient.ETag());
+    }
+    TUint64 bytes = 0;
+    TUint failures = 0;
+    const TUint64 start = Os::TimeInUs(iEnv.OsCtx());
+    for (TUint i=0; i<kRequests; i++) {
+        if (aClient.Get(aPath, etag, aAcceptEncoding) != aExpectedStatus) {
+            failures++;
+        }
+        bytes += aClient.Body().Bytes();
+    }
+    const TUint64 us = Os::TimeInUs(iEnv.OsCtx()) - start;
+    TEST(failures == 0);
+    const TUint64 requestsPerSec = (us == 0? 0 : (TUint64)kRequests * 1000000 / us);
+    Log::Print("    %-24s %llu requests/s, %llu body bytes sent (%llu per request)\n",
+               aDescription, requestsPerSec, bytes, bytes / kRequests);
+}
+
+
+// TestHelperValueMessage
+
+TestHelperValueMessage::TestHelperValueMessage(TUint aValue)
+    : iValue(aValue)
+{
+}
+
+void TestHelperValueMessage::Send(IWriter& aWriter)
+{
+    Bws<Ascii::kMaxUintStringBytes> buf;
+    Ascii::AppendDec(buf, iValue);
+    aWriter.Write(buf);
+}
+
+void TestHelperValueMessage::Destroy()
+{
+    delete this;
+}
+
+
+// TestHelperPushWebApp
+
+TestHelperPushWebApp::TestHelperPushWebApp(const Brx& aPrefix)
+    : iPrefix(aPrefix)
+    , iLock("TPWA")
+{
+}
+
+void TestHelperPushWebApp::Send(TUint aIndex, TUint aValue)
+{
+    ITabHandler* handler = nullptr;
+    {
+        AutoMutex _(iLock);
+        ASSERT(aIndex < iHandlers.size());
+        handler = iHandlers[aIndex];
+    }
+    // Handler outlives tab, so can be sent to even if tab has been destroyed (msg is then dropped).
+    handler->Send(*new TestHelperValueMessage(aValue));
+}
+
+IResourceHandler* TestHelperPushWebApp::CreateResourceHandler(const Brx& /*aResource*/)
+{
+    THROW(ResourceInvalid);
+}
+
+ITab& TestHelperPushWebApp::Create(ITabHandler& aHandler, const std::vector<Bws<10>>& /*aLanguageList*/)
+{
+    AutoMutex _(iLock);
+    iHandlers.push_back(&aHandler);
+    return iTab;
+}
+
+const Brx& TestHelperPushWebApp::ResourcePrefix() const
+{
+    return iPrefix;
+}
+
+
+// TestHelperLongPollClient
+
+TestHelperLongPollClient::TestHelperLongPollClient(Environment& aEnv, const Endpoint& aEndpoint, const Brx& aPrefix)
+    : iEnv(aEnv)
+    , iEndpoint(aEndpoint)
+    , iPrefix(aPrefix)
+    , iBody(kMaxBodyBytes)
+{
+}
+
+TUint TestHelperLongPollClient::Create()
+{
+    if (Post(Brn("lpcreate"), Brx::Empty()) != HttpStatus::kOk.Code()) {
+        return 0;
+    }
+    Parser parser(iBody);
+    (void)parser.Next('\n');    // "lpcreate"
+    if (parser.Next() != Brn("session-id:")) {
+        return 0;
+    }
+    try {
+        return Ascii::Uint(Ascii::Trim(parser.Next()));
+    }
+    catch (AsciiError&) {
+        return 0;
+    }
+}
+
+TUint TestHelperLongPollClient::LongPoll(TUint aSessionId)
+{
+    iMessages.Set(Brx::Empty());
+    Bws<32> body("session-id: ");
+    Ascii::AppendDec(body, aSessionId);
+    body.Append("\r\n");
+    const TUint code = Post(Brn("lp"), body);
+    if (code == HttpStatus::kOk.Code()) {
+        Parser parser(iBody);
+        (void)parser.Next('\n');    // "lp"
+        iMessages.Set(parser.Remaining());
+    }
+    return code;
+}
+
+const Brx& TestHelperLongPollClient::Messages() const
+{
+    return iMessages;
+}
+
+TUint TestHelperLongPollClient::Post(const Brx& aTail, const Brx& aBody)
+{
+    iBody.SetBytes(0);
+    SocketTcpClient socket;
+    socket.Open(iEnv);
+    Srs<kReadBufferBytes> readBuffer(socket);
+    ReaderUntilS<kReadBufferBytes> readerUntil(readBuffer);
+    ReaderHttpResponse readerResponse(iEnv, readerUntil);
+    readerResponse.AddHeader(iHeaderTransferEncoding);
+    ReaderHttpChunked dechunker(readerUntil);
+    Sws<kWriteBufferBytes> writeBuffer(socket);
+    WriterHttpRequest writerRequest(writeBuffer);
+
+    Bws<Uri::kMaxUriBytes> path("/");
+    path.Append(iPrefix);
+    path.Append("/");
+    path.Append(aTail);
+
+    TUint code = 0;
+    try {
+        socket.Connect(iEndpoint, kConnectTimeoutMs);
+        Endpoint::AddressBuf host;
+        iEndpoint.AppendAddress(host);
+        writerRequest.WriteMethod(Http::kMethodPost, path, Http::eHttp11);
+        Http::WriteHeaderHostAndPort(writerRequest, host, iEndpoint.Port());
+        Http::WriteHeaderContentLength(writerRequest, aBody.Bytes());
+        Http::WriteHeaderConnectionClose(writerRequest);
+        writerRequest.WriteFlush();
+        writeBuffer.Write(aBody);
+        writeBuffer.WriteFlush();
+
+        readerResponse.Read(kResponseTimeoutMs);
+        code = readerResponse.Status().Code();
+        dechunker.SetChunked(iHeaderTransferEncoding.IsChunked());
+        for (;;) {
+            Brn buf = dechunker.Read(kReadBufferBytes);
+            if (buf.Bytes() == 0) {
+                break;
+            }
+            if (buf.Bytes() > iBody.BytesRemaining()) {
+                code = 0;
+                break;
+            }
+            iBody.Append(buf);
+        }
+    }
+    catch (NetworkTimeout&) {
+        code = 0;
+    }
+    catch (NetworkError&) {
+        code = 0;
+    }
+    catch (WriterError&) {
+        code = 0;
+    }
+    catch (HttpError&) {
+        code = 0;
+    }
+    catch (ReaderError&) {
+        // Unchunked responses end when the server closes the connection.
+        if (iHeaderTransferEncoding.IsChunked()) {
+            code = 0;
+        }
+    }
+    socket.Close();
+    return code;
+}
+
+
+// TestHelperStreamClient
+
+TestHelperStreamClient::TestHelperStreamClient(Environment& aEnv, const Endpoint& aEndpoint)
+    : iEnv(aEnv)
+    , iEndpoint(aEndpoint)
+    , iReadBuffer(iSocket)
+    , iReaderUntil(iReadBuffer)
+    , iReaderResponse(aEnv, iReaderUntil)
+    , iDechunker(iReaderUntil)
+    , iReaderEvent(iDechunker)
+    , iWriteBuffer(iSocket)
+    , iWriterRequest(iWriteBuffer)
+    , iEvent(kMaxEventBytes)
+    , iOpen(false)
+{
+    iReaderResponse.AddHeader(iHeaderTransferEncoding);
+}
+
+TestHelperStreamClient::~TestHelperStreamClient()
+{
+    Close();
+}
+
+TUint TestHelperStreamClient::Open(const Brx& aPath)
+{
+    ASSERT(!iOpen);
+    iSocket.Open(iEnv);
+    iOpen = true;
+
+    TUint code = 0;
+    try {
+        iSocket.Connect(iEndpoint, kConnectTimeoutMs);
+        Endpoint::AddressBuf host;
+        iEndpoint.AppendAddress(host);
+        iWriterRequest.WriteMethod(Http::kMethodGet, aPath, Http::eHttp11);
+        Http::WriteHeaderHostAndPort(iWriterRequest, host, iEndpoint.Port());
+        iWriterRequest.WriteHeader(Brn("Accept"), Brn("text/event-stream"));
+        Http::WriteHeaderConnectionClose(iWriterRequest);
+        iWriterRequest.WriteFlush();
+
+        iReaderResponse.Read(kResponseTimeoutMs);
+        code = iReaderResponse.Status().Code();
+        iDechunker.SetChunked(iHeaderTransferEncoding.IsChunked());
+    }
+    catch (NetworkTimeout&) {}
+    catch (NetworkError&) {}
+    catch (WriterError&) {}
+    catch (HttpError&) {}
+    catch (ReaderError&) {}
+    if (code != HttpStatus::kOk.Code()) {
+        Close();
+    }
+    return code;
+}
+
+Brn TestHelperStreamClient::ReadEvent()
+{
+    static const Brn kData("data: ");
+    iEvent.SetBytes(0);
+    for (;;) {
+        Brn line = iReaderEvent.ReadUntil('\n');
+        if (line.Bytes() == 0) {
+            // Blank line ends an event.  (Keep-alives are comments, which end no event.)
+            if (iEvent.Bytes() > 0) {
+                return Brn(iEvent);
+            }
+        }
+        else if (line.Bytes() >= kData.Bytes() && line.Split(0, kData.Bytes()) == kData) {
+            if (iEvent.Bytes() > 0) {
+                iEvent.Append('\n');
+            }
+            iEvent.Append(line.Split(kData.Bytes()));
+        }
+    }
+}
+
+void TestHelperStreamClient::Interrupt()
+{
+    iSocket.Interrupt(true);
+}
+
+void TestHelperStreamClient::Close()
+{
+    if (iOpen) {
+        iOpen = false;
+        iSocket.Close();
+    }
+}
+
+
+// TestHelperStalledConnection
+
+TestHelperStalledConnection::TestHelperStalledConnection()
+    : iSemWriting("THSW", 0)
+    , iSemInterrupted("THSI", 0)
+    , iInterrupted(false)
+{
+}
+
+void TestHelperStalledConnection::WaitUntilWriting()
+{
+    iSemWriting.Wait();
+}
+
+TBool TestHelperStalledConnection::Interrupted() const
+{
+    return iInterrupted;
+}
+
+void TestHelperStalledConnection::Write(TByte /*aValue*/)
+{
+    Block();
+}
+
+void TestHelperStalledConnection::Write(const Brx& /*aBuffer*/)
+{
+    Block();
+}
+
+void TestHelperStalledConnection::WriteFlush()
+{
+    Block();
+}
+
+Brn TestHelperStalledConnection::Read(TUint /*aBytes*/)
+{
+    THROW(ReaderError);
+}
+
+void TestHelperStalledConnection::ReadFlush()
+{
+}
+
+void TestHelperStalledConnection::ReadInterrupt()
+{
+    iInterrupted = true;
+    iSemInterrupted.Signal();
+}
+
+void TestHelperStalledConnection::Block()
+{
+    if (!iInterrupted) {
+        iSemWriting.Signal();
+        iSemInterrupted.Wait();
+    }
+    THROW(WriterError);
+}
+
+
+// SuiteTabEventDispatcher
+
+SuiteTabEventDispatcher::SuiteTabEventDispatcher(Environment& aEnv)
+    : SuiteUnitTest("SuiteTabEventDispatcher")
+    , iEnv(aEnv)
+{
+    AddTest(MakeFunctor(*this, &SuiteTabEventDispatcher::TestMaxStreams), "TestMaxStreams");
+    AddTest(MakeFunctor(*this, &SuiteTabEventDispatcher::TestRemoveStalledStream), "TestRemoveStalledStream");
+}
+
+void SuiteTabEventDispatcher::Setup()
+{
+}
+
+void SuiteTabEventDispatcher::TearDown()
+{
+}
+
+void SuiteTabEventDispatcher::TestMaxStreams()
+{
+    TabEventDispatcher dispatcher(iEnv, 1);
+    TestHelperStalledConnection connection1;
+    WriterHttpResponseContentLengthUnknown writer1(connection1);
+    TabEventStream stream1(writer1, connection1, connection1);
+    stream1.Set(iTabs, Http::eHttp11);
+    TestHelperStalledConnection connection2;
+    WriterHttpResponseContentLengthUnknown writer2(connection2);
+    TabEventStream stream2(writer2, connection2, connection2);
+    stream2.Set(iTabs, Http::eHttp11);
+
+    TEST(dispatcher.TryAdd(stream1));
+    TEST(!dispatcher.TryAdd(stream2));
+    TEST(!connection2.Interrupted());
+
+    // Another stream can be added once one has been removed.
+    dispatcher.Remove(stream1);
+    TEST(dispatcher.TryAdd(stream2));
+    dispatcher.Remove(stream2);
+}
+
+void SuiteTabEventDispatcher::TestRemoveStalledStream()
+{
+    TabEventDispatcher dispatcher(iEnv, 1);
+    TestHelperStalledConnection connection;
+    WriterHttpResponseContentLengthUnknown writer(connection);
+    TabEventStream stream(writer, connection, connection);
+    stream.Set(iTabs, Http::eHttp11);
+
+    TEST(dispatcher.TryAdd(stream));
+    // Dispatcher is now blocked writing the response header.
+    connection.WaitUntilWriting();
+    // Remove() interrupts the write rather than waiting for the client to read.
+    dispatcher.Remove(stream);
+    TEST(connection.Interrupted());
+}
+
+
+// SuiteWebAppFrameworkStream
+
+SuiteWebAppFrameworkStream::SuiteWebAppFrameworkStream(Environment& aEnv)
+    : SuiteUnitTest("SuiteWebAppFrameworkStream")
+    , iEnv(aEnv)
+{
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkStream::TestStreamMessages), "TestStreamMessages");
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkStream::TestStreamMessagesBatched), "TestStreamMessagesBatched");
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkStream::TestStreamMultipleTabs), "TestStreamMultipleTabs");
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkStream::TestStreamInvalid), "TestStreamInvalid");
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkStream::TestStreamInProgress), "TestStreamInProgress");
+    AddTest(MakeFunctor(*this, &SuiteWebAppFrameworkStream::TestStreamTabTimeout), "TestStreamTabTimeout");
+}
+
+void SuiteWebAppFrameworkStream::Setup()
+{
+    iThreadPool = new ThreadPool(1, 1, 1);
+    WebAppFrameworkInitParams* initParams = new WebAppFrameworkInitParams();
+    // One tab per long poll server thread, so several tabs can be streamed at once.
+    initParams->SetMaxServerThreadsLongPoll(kMaxTabs);
+    initParams->SetLongPollTimeoutMs(kTabTimeoutMs);
+    iFramework = new WebAppFramework(iEnv, initParams, *iThreadPool);
+    iWebApp = new TestHelperPushWebApp(Brn("PushApp"));
+    iFramework->Add(iWebApp, MakeFunctorGeneric(*this, &SuiteWebAppFrameworkStream::PresentationUrlChanged));
+    iFramework->Start();
+    iClient = new TestHelperLongPollClient(iEnv, Endpoint(iFramework->Port(), iFramework->Interface()), Brn("PushApp"));
+}
+
+void SuiteWebAppFrameworkStream::TearDown()
+{
+    delete iClient;
+    delete iFramework;
+    delete iThreadPool;
+}
+
+void SuiteWebAppFrameworkStream::PresentationUrlChanged(const Brx& /*aUrl*/)
+{
+}
+
+void SuiteWebAppFrameworkStream::StreamPath(const std::vector<TUint>& aIds, Bwx& aPath)
+{
+    aPath.Replace("/PushApp/lpstream?session-id=");
+    for (TUint i=0; i<aIds.size(); i++) {
+        if (i > 0) {
+            aPath.Append(',');
+        }
+        Ascii::AppendDec(aPath, aIds[i]);
+    }
+}
+
+void SuiteWebAppFrameworkStream::Event(TUint aSessionId, const TChar* aMessages, Bwx& aEvent)
+{
+    aEvent.Replace("{\"session-id\": ");
+    Ascii::AppendDec(aEvent, aSessionId);
+    aEvent.Append(", \"messages\": ");
+    aEvent.Append(aMessages);
+    aEvent.Append('}');
+}
+
+void SuiteWebAppFrameworkStream::TestStreamMessages()
+{
+    const TUint id = iClient->Create();
+    TEST(id != 0);
+    TestHelperStreamClient stream(iEnv, Endpoint(iFramework->Port(), iFramework->Interface()));
+    Bws<Uri::kMaxUriBytes> path;
+    StreamPath({ id }, path);
+    TEST(stream.Open(path) == HttpStatus::kOk.Code());
+
+    Bws<128> expected;
+    iWebApp->Send(0, 1);
+    Event(id, "[1]", expected);
+    TEST(stream.ReadEvent() == expected);
+    iWebApp->Send(0, 2);
+    Event(id, "[2]", expected);
+    TEST(stream.ReadEvent() == expected);
+}
+
+void SuiteWebAppFrameworkStream::TestStreamMessagesBatched()
+{
+    const TUint id = iClient->Create();
+    TEST(id != 0);
+    // Msgs queued before the stream starts are all sent in its first event.
+    iWebApp->Send(0, 1);
+    iWebApp->Send(0, 2);
+    iWebApp->Send(0, 3);
+
+    TestHelperStreamClient stream(iEnv, Endpoint(iFramework->Port(), iFramework->Interface()));
+    Bws<Uri::kMaxUriBytes> path;
+    StreamPath({ id }, path);
+    TEST(stream.Open(path) == HttpStatus::kOk.Code());
+    Bws<128> expected;
+    Event(id, "[1,2,3]", expected);
+    TEST(stream.ReadEvent() == expected);
+}
+
+void SuiteWebAppFrameworkStream::TestStreamMultipleTabs()
+{
+    const TUint id1 = iClient->Create();
+    const TUint id2 = iClient->Create();
+    const TUint id3 = iClient->Create();
+    TEST(id1 != 0);
+    TEST(id2 != 0);
+    TEST(id3 != 0);
+
+    // Several tabs can be streamed on a single connection.
+    TestHelperStreamClient stream(iEnv, Endpoint(iFramework->Port(), iFramework->Interface()));
+    Bws<Uri::kMaxUriBytes> path;
+    StreamPath({ id1, id2, id3 }, path);
+    TEST(stream.Open(path) == HttpStatus::kOk.Code());
+
+    // Tabs are always written in the order they were requested.
+    Bws<128> expected;
+    iWebApp->Send(0, 1);
+    Event(id1, "[1]", expected);
+    TEST(stream.ReadEvent() == expected);
+    iWebApp->Send(2, 3);
+    Event(id3, "[3]", expected);
+    TEST(stream.ReadEvent() == expected);
+    iWebApp->Send(1, 2);
+    Event(id2, "[2]", expected);
+    TEST(stream.ReadEvent() == expected);
+}
+
+void SuiteWebAppFrameworkStream::TestStreamInvalid()
+{
+    const Endpoint endpoint(iFramework->Port(), iFramework->Interface());
+    {
+        TestHelperStreamClient stream(iEnv, endpoint);
+        TEST(stream.Open(Brn("/PushApp/lpstream?session-id=99")) == HttpStatus::kNotFound.Code());
+    }
+    {
+        TestHelperStreamClient stream(iEnv, endpoint);
+        TEST(stream.Open(Brn("/PushApp/lpstream")) == HttpStatus::kBadRequest.Code());
+    }
+    {
+        TestHelperStreamClient stream(iEnv, endpoint);
+        TEST(stream.Open(Brn("/PushApp/lpstream?session-id=1,abc")) == HttpStatus::kBadRequest.Code());
+    }
+}
+
+void SuiteWebAppFrameworkStream::TestStreamInProgress()
+{
+    const TUint id = iClient->Create();
+    TEST(id != 0);
+    const Endpoint endpoint(iFramework->Port(), iFramework->Interface());
+    Bws<Uri::kMaxUriBytes> path;
+    StreamPath({ id }, path);
+    TestHelperStreamClient stream1(iEnv, endpoint);
+    TEST(stream1.Open(path) == HttpStatus::kOk.Code());
+    TestHelperStreamClient stream2(iEnv, endpoint);
+    TEST(stream2.Open(path) == HttpStatus::kBadRequest.Code());
+
+    // First stream is unaffected.
+    Bws<128> expected;
+    iWebApp->Send(0, 1);
+    Event(id, "[1]", expected);
+    TEST(stream1.ReadEvent() == expected);
+}
+
+void SuiteWebAppFrameworkStream::TestStreamTabTimeout()
+{
+    const TUint id = iClient->Create();
+    TEST(id != 0);
+    const Endpoint endpoint(iFramework->Port(), iFramework->Interface());
+    Bws<Uri::kMaxUriBytes> path;
+    StreamPath({ id }, path);
+    {
+        // Tab can't time out while it is streamed.
+        TestHelperStreamClient stream(iEnv, endpoint);
+        TEST(stream.Open(path) == HttpStatus::kOk.Code());
+        Thread::Sleep(2 * kTabTimeoutMs);
+        Bws<128> expected;
+        iWebApp->Send(0, 1);
+        Event(id, "[1]", expected);
+        TEST(stream.ReadEvent() == expected);
+    }
+
+    // Tab times out as usual once client has closed stream and stopped polling.
+    Thread::Sleep(3 * kTabTimeoutMs);
+    TestHelperStreamClient stream(iEnv, endpoint);
+    TEST(stream.Open(path) == HttpStatus::kNotFound.Code());
+}
+
+
+// TestHelperTabReceiver
+
+TestHelperTabReceiver::TestHelperTabReceiver(Environment& aEnv, const Endpoint& aEndpoint, const Brx& aPrefix,
+                                             const std::vector<TUint>& aIds, TBool aStream, TUint aExpectedMsgs, Semaphore& aSemDone)
+    : iEnv(aEnv)
+    , iLongPollClient(aEnv, aEndpoint, aPrefix)
+    , iStreamClient(aEnv, aEndpoint)
+    , iIds(aIds)
+    , iStream(aStream)
+    , iExpectedMsgs(aExpectedMsgs)
+    , iSemDone(aSemDone)
+    , iStop(false)
+    , iMsgs(0)
+    , iResponses(0)
+    , iRequests(0)
+    , iLastMsgUs(0)
+    , iFellBack(false)
+{
+    ASSERT(iStream || iIds.size() == 1);
+    iThread = new ThreadFunctor("TabReceiver", MakeFunctor(*this, &TestHelperTabReceiver::Run));
+}
+
+TestHelperTabReceiver::~TestHelperTabReceiver()
+{
+    delete iThread;
+}
+
+void TestHelperTabReceiver::Start()
+{
+    iThread->Start();
+}
+
+void TestHelperTabReceiver::Stop()
+{
+    iStop = true;
+    if (iStream) {
+        iStreamClient.Interrupt();
+    }
+}
+
+TUint TestHelperTabReceiver::Msgs() const
+{
+    return iMsgs;
+}
+
+TUint TestHelperTabReceiver::Responses() const
+{
+    return iResponses;
+}
+
+TUint TestHelperTabReceiver::Requests() const
+{
+    return iRequests;
+}
+
+TUint64 TestHelperTabReceiver::LastMsgUs() const
+{
+    return iLastMsgUs;
+}
+
+TBool TestHelperTabReceiver::FellBack() const
+{
+    return iFellBack;
+}
+
+void TestHelperTabReceiver::Run()
+{
+    if (iStream) {
+        RunStream();
+    }
+    else {
+        RunLongPoll();
+    }
+    iSemDone.Signal();
+}
+
+void TestHelperTabReceiver::RunLongPoll()
+{
+    while (!iStop && iMsgs < iExpectedMsgs) {
+        iRequests++;
+        if (iLongPollClient.LongPoll(iIds[0]) != HttpStatus::kOk.Code()) {
+            break;
+        }
+        Received(iLongPollClient.Messages());
+    }
+}
+
+void TestHelperTabReceiver::RunStream()
+{
+    Bws<Uri::kMaxUriBytes> path("/PushApp/lpstream?session-id=");
+    for (TUint i=0; i<iIds.size(); i++) {
+        if (i > 0) {
+            path.Append(',');
+        }
+        Ascii::AppendDec(path, iIds[i]);
+    }
+    iRequests++;
+    if (iStreamClient.Open(path) != HttpStatus::kOk.Code()) {
+        iStreamClient.Close();
+        if (iIds.size() == 1) {
+            iFellBack = true;
+            RunLongPoll();
+        }
+        return;
+    }
+    try {
+        while (!iStop && iMsgs < iExpectedMsgs) {
+            Received(iStreamClient.ReadEvent());
+        }
+    }
+    catch (ReaderError&) {}
+    iStreamClient.Close();
+}
+
+void TestHelperTabReceiver::Received(const Brx& aJson)
+{
+    // Msgs are all integers, so are separated by the only commas in their array.
+    Parser parser(aJson);
+    (void)parser.Next('[');
+    const Brn msgs = parser.Next(']');
+    if (msgs.Bytes() == 0) {
+        return;
+    }
+    TUint count = 1;
+    for (TUint i=0; i<msgs.Bytes(); i++) {
+        if (msgs[i] == ',') {
+            count++;
+        }
+    }
+    iMsgs += count;
+    iResponses++;
+    iLastMsgUs = Os::TimeInUs(iEnv.OsCtx());
+}
+
+
+// SuiteWebAppFrameworkStreamBenchmark
+
+SuiteWebAppFrameworkStreamBenchmark::SuiteWebAppFrameworkStreamBenchmark(Environment& aEnv)
+    : Suite("WebAppFramework tab update load test")
+    , iEnv(aEnv)
+{
+}
+
+void SuiteWebAppFrameworkStreamBenchmark::Test()
+{
+    Log::Print("  %u tabs, each sent %u msgs, one every %ums:\n", kTabs, kRounds, kRoundIntervalMs);
+    // Each tab is received as lp.js would: by its own long poll or its own stream.
+    // Both occupy one server thread per tab.
+    Run("long poll", false);
+    Run("stream per tab", true);
+}
+
+void SuiteWebAppFrameworkStreamBenchmark::PresentationUrlChanged(const Brx& /*aUrl*/)
+{
+}
+
+void SuiteWebAppFrameworkStreamBenchmark::Run(const TChar* aDescription, TBool aStream)
+{
+    ThreadPool* threadPool = new ThreadPool(1, 1, 1);
+    WebAppFrameworkInitParams* initParams = new WebAppFrameworkInitParams();
+    initParams->SetMaxServerThreadsLongPoll(kTabs);
+    WebAppFramework* framework = new WebAppFramework(iEnv, initParams, *threadPool);
+    TestHelperPushWebApp* webApp = new TestHelperPushWebApp(Brn("PushApp"));
+    framework->Add(webApp, MakeFunctorGeneric(*this, &SuiteWebAppFrameworkStreamBenchmark::PresentationUrlChanged));
+    framework->Start();
+    const Endpoint endpoint(framework->Port(), framework->Interface());
+
+    std::vector<TUint> ids;
+    TestHelperLongPollClient client(iEnv, endpoint, Brn("PushApp"));
+    for (TUint i=0; i<kTabs; i++) {
+        const TUint id = client.Create();
+        TEST(id != 0);
+        ids.push_back(id);
+    }
+
+    Semaphore semDone("TRXD", 0);
+    std::vector<TestHelperTabReceiver*> receivers;
+    for (TUint i=0; i<kTabs; i++) {
+        std::vector<TUint> receiverIds(1, ids[i]);
+        receivers.push_back(new TestHelperTabReceiver(iEnv, endpoint, Brn("PushApp"), receiverIds, aStream, kRounds, semDone));
+    }
+    for (auto* receiver : receivers) {
+        receiver->Start();
+    }
+
+    const TUint64 startUs = Os::TimeInUs(iEnv.OsCtx());
+    for (TUint i=0; i<kRounds; i++) {
+        for (TUint j=0; j<kTabs; j++) {
+            webApp->Send(j, i);
+        }
+        Thread::Sleep(kRoundIntervalMs);
+    }
+    const TUint64 lastSendUs = Os::TimeInUs(iEnv.OsCtx());
+
+    TBool timedOut = false;
+    for (TUint i=0; i<receivers.size(); i++) {
+        try {
+            semDone.Wait(kTimeoutMs);
+        }
+        catch (Timeout&) {
+            timedOut = true;
+            for (auto* receiver : receivers) {
+                receiver->Stop();
+            }
+        }
+    }
+    TEST(!timedOut);
+
+    TUint msgs = 0;
+    TUint responses = 0;
+    TUint requests = 0;
+    TUint fellBack = 0;
+    TUint64 lastMsgUs = startUs;
+    for (auto* receiver : receivers) {
+        if (receiver->FellBack()) {
+            fellBack++;
+        }
+        msgs += receiver->Msgs();
+        responses += receiver->Responses();
+        requests += receiver->Requests();
+        lastMsgUs = std::max(lastMsgUs, receiver->LastMsgUs());
+        delete receiver;
+    }
+    TEST(msgs == kTabs * kRounds);
+
+    const TUint64 us = lastMsgUs - startUs;
+    const TUint64 msgsPerSec = (us == 0? 0 : (TUint64)msgs * 1000000 / us);
+    const TUint64 lagUs = (lastMsgUs > lastSendUs? lastMsgUs - lastSendUs : 0);
+    Log::Print("    %-16s %u server threads, %u requests, %u streams refused, %llu msgs/s, %u msgs per response, last msg received %llums after last sent\n",
+               aDescription, 1 + kTabs, requests, fellBack, msgsPerSec, (responses == 0? 0 : msgs / responses), lagUs / 1000);
+
+    delete framework;
+    delete threadPool;
+}
+
+
+
+void TestWebAppFramework(Environment& aEnv)
+{
+    Runner runner("WebApp Framework tests\n");
+    runner.Add(new SuiteFrameworkTabHandler());
+    runner.Add(new SuiteFrameworkTab());
+    runner.Add(new SuiteTabManager());
+    runner.Add(new SuiteWebAppFramework(aEnv));
+    runner.Add(new SuiteResourceCache());
+    runner.Add(new SuiteWebAppFrameworkResources(aEnv));
+    runner.Add(new SuiteTabEventDispatcher(aEnv));
+    runner.Add(new SuiteWebAppFrameworkStream(aEnv));
+    runner.Run();
+}
+
+void TestWebAppFrameworkBenchmark(Environment& aEnv)
+{
+    Runner runner("WebApp Framework benchmark\n");
+    runner.Add(new SuiteWebAppFrameworkResourcesBenchmark(aEnv));
+    runner.Add(new SuiteWebAppFrameworkStreamBenchmark(aEnv));
     runner.Run();
 }
@@ -1,10 +1,28 @@
 #include <OpenHome/Private/TestFramework.h>
+#include <OpenHome/Private/OptionParser.h>
+
+using namespace OpenHome;
+using namespace OpenHome::TestFramework;
 
 extern void TestWebAppFramework(OpenHome::Environment& aEnv);
+extern void TestWebAppFrameworkBenchmark(OpenHome::Environment& aEnv);
 
-void OpenHome::TestFramework::Runner::Main(TInt /*aArgc*/, TChar* /*aArgv*/[], Net::InitialisationParams* aInitParams)
+void OpenHome::TestFramework::Runner::Main(TInt aArgc, TChar* aArgv[], Net::InitialisationParams* aInitParams)
 {
+    OptionParser parser;
+    OptionBool optionBenchmark("-b", "--benchmark", "Measure requests/s and bytes sent when serving static resources");
+    parser.AddOption(&optionBenchmark);
+    if (!parser.Parse(aArgc, aArgv)) {
+        delete aInitParams;
+        return;
+    }
+
     Net::Library* lib = new Net::Library(aInitParams);
-    TestWebAppFramework(lib->Env());
+    if (optionBenchmark.Value()) {
+        TestWebAppFrameworkBenchmark(lib->Env());
+    }
+    else {
+        TestWebAppFramework(lib->Env());
+    }
     delete lib;
 }
@@ -17,7 +17,9 @@
 #include <OpenHome/Private/NetworkAdapterList.h>
 #include <OpenHome/Configuration/ConfigManager.h>
 #include <OpenHome/ThreadPool.h>
+#include <OpenHome/OsWrapper.h>
 
+#include <algorithm>
 #include <functional>
 #include <limits>
 
@@ -25,6 +27,16 @@ using namespace OpenHome;
 using namespace OpenHome::Configuration;
 using namespace OpenHome::Web;
 
+static const Brn kHeaderETag("ETag");
+static const Brn kHeaderCacheControl("Cache-Control");
+static const Brn kHeaderVary("Vary");
+static const Brn kHeaderContentEncoding("Content-Encoding");
+static const Brn kHeaderAcceptEncoding("Accept-Encoding");
+static const Brn kHeaderIfNoneMatch("If-None-Match");
+static const Brn kCacheControlNoCache("no-cache");
+static const Brn kContentTypeEventStream("text/event-stream");
+static const Brn kEventDataField("data: ");
+
 
 // FrameworkTabHandler
 
@@ -33,11 +45,14 @@ FrameworkTabHandler::FrameworkTabHandler(IFrameworkSemaphore& aSemRead, IFramewo
     , iFifo(aSendQueueSize)
     , iEnabled(false)
     , iPolling(false)
+    , iWriting(false)
+    , iPushObserver(nullptr)
     , iLock("FTHL")
     , iSemRead(aSemRead)
     , iSemWrite(aSemWrite)
     , iTimer(aTimer)
 {
+    iPending.reserve(aSendQueueSize);
     iSemRead.Clear();
     iSemWrite.Clear();
     // Allow msgs to be queued via Send().
@@ -50,6 +65,7 @@ FrameworkTabHandler::~FrameworkTabHandler()
 {
     AutoMutex a(iLock);
     ASSERT(iFifo.SlotsUsed() == 0);
+    ASSERT(iPending.size() == 0);
 }
 
 void FrameworkTabHandler::LongPoll(IWriter& aWriter)
@@ -62,7 +78,7 @@ void FrameworkTabHandler::LongPoll(IWriter& aWriter)
         // Don't accept any long polls if in an interrupted state.
         // Don't accept long polls if already polling (i.e., misbehaving client is making overlapping long polls).
         AutoMutex a(iLock);
-        if (!iEnabled || iPolling) {
+        if (!iEnabled || iPolling || iWriting) {
             return;
         }
         iPolling = true;
@@ -74,13 +90,42 @@ void FrameworkTabHandler::LongPoll(IWriter& aWriter)
     iTimer.Cancel();    // Cancel timer here, in case it wasn't timer that signalled iSemRead.
 
     // Check if ::Disable() was called.
-    AutoMutex a(iLock);
-    // Code below may throw exception, so clear state here while lock is held.
-    iPolling = false;
-    iSemRead.Clear();
+    {
+        AutoMutex a(iLock);
+        // Code below may throw exception, so clear state here while lock is held.
+        iPolling = false;
+        iSemRead.Clear();
+        TakeMessagesLocked();
+    }
 
     // Output messages, if any (there will be none if timer callback signalled iSemRead (i.e., timeout) or if ::Disable() was called).
-    WriteMessagesLocked(aWriter);   // May throw WriterError.
+    WriteMessages(aWriter);   // May throw WriterError.
+}
+
+void FrameworkTabHandler::SetPushObserver(ITabPushObserver* aObserver)
+{
+    {
+        AutoMutex a(iLock);
+        iPushObserver = aObserver;
+        if (iPushObserver == nullptr || iFifo.SlotsUsed() == 0) {
+            return;
+        }
+    }
+    // Msgs were queued before streaming started.
+    aObserver->MessagesPending();
+}
+
+void FrameworkTabHandler::WritePending(IWriter& aWriter)
+{
+    {
+        AutoMutex a(iLock);
+        if (!iEnabled || iPolling || iWriting) {
+            return;
+        }
+        iSemRead.Clear();
+        TakeMessagesLocked();
+    }
+    WriteMessages(aWriter);   // May throw WriterError.
 }
 
 void FrameworkTabHandler::Disable()
@@ -117,18 +162,25 @@ void FrameworkTabHandler::Send(ITabMessage& aMessage)
     // Blocks until message can be sent.
 
     iSemWrite.Wait();
-    AutoMutex a(iLock);
-    if (!iEnabled) {
-        aMessage.Destroy();
-        iSemWrite.Signal(); // Dropped message instead of putting in FIFO, so can just resignal.
-    }
-    else {
+    ITabPushObserver* observer = nullptr;
+    {
+        AutoMutex a(iLock);
+        if (!iEnabled) {
+            aMessage.Destroy();
+            iSemWrite.Signal(); // Dropped message instead of putting in FIFO, so can just resignal.
+            return;
+        }
         iFifo.Write(&aMessage);
         // Only need to signal first message going into queue.
         if (iFifo.SlotsUsed() == 1) {
             iSemRead.Signal();
+            observer = iPushObserver;
         }
     }
+    // Observer may write out queued msgs, so isn't called with iLock held.
+    if (observer != nullptr) {
+        observer->MessagesPending();
+    }
 }
 
 void FrameworkTabHandler::Complete()
@@ -136,46 +188,58 @@ void FrameworkTabHandler::Complete()
     iSemRead.Signal();
 }
 
-void FrameworkTabHandler::WriteMessagesLocked(IWriter& aWriter)
+void FrameworkTabHandler::TakeMessagesLocked()
 {
-    // This writes nothing if there are no messages to be sent.
-    TBool msgOutput = false;
+    // Msgs are written without iLock held, so that a client that is slow to
+    // read can't block Send() or Disable().
+    ASSERT(!iWriting);
     while (iFifo.SlotsUsed() > 0) {
-        ITabMessage* msg = iFifo.Read();
-        try {
-            if (!msgOutput) {
-                aWriter.Write(Brn("["));
-                msgOutput = true;
-            }
+        iPending.push_back(iFifo.Read());
+    }
+    iWriting = true;
+}
 
+void FrameworkTabHandler::WriteMessages(IWriter& aWriter)
+{
+    // This writes nothing if there are no messages to be sent.
+    TUint written = 0;
+    try {
+        for (auto* msg : iPending) {
+            // All but last msg should be followed by "," in a JSON array.
+            aWriter.Write(written == 0? Brn("[") : Brn(","));
             msg->Send(aWriter); // May throw WriterError.
             msg->Destroy();
+            written++;
             iSemWrite.Signal();
-
-            // All but last msg should be followed by "," in a JSON array.
-            if (iFifo.SlotsUsed() > 0) {
-                aWriter.Write(Brn(","));
-            }
         }
-        catch (const WriterError&) {
-            // Destroy msg and rethrow so that higher level can take
-            // appropriate action.
-            msg->Destroy();
+    }
+    catch (const WriterError&) {
+        // Destroy msgs and rethrow so that higher level can take
+        // appropriate action.
+        for (TUint i=written; i<iPending.size(); i++) {
+            iPending[i]->Destroy();
             iSemWrite.Signal();
+        }
+        iPending.clear();
 
-            // Empty remaining messages from FIFO.
-            while (iFifo.SlotsUsed() > 0) {
-                ITabMessage* msgDiscard = iFifo.Read();
-                msgDiscard->Destroy();
-                iSemWrite.Signal(); // Unblock any Send() calls.
-            }
-
-            throw;
+        AutoMutex a(iLock);
+        iWriting = false;
+        // Empty remaining messages from FIFO.
+        while (iFifo.SlotsUsed() > 0) {
+            ITabMessage* msgDiscard = iFifo.Read();
+            msgDiscard->Destroy();
+            iSemWrite.Signal(); // Unblock any Send() calls.
         }
+        throw;
+    }
+    iPending.clear();
+    {
+        AutoMutex a(iLock);
+        iWriting = false;
     }
 
-    // Doesn't matter if this throws WriterError here, as FIFO has been emptied so nothing to clean up.
-    if (msgOutput) {
+    // Doesn't matter if this throws WriterError here, as all msgs have been destroyed so nothing to clean up.
+    if (written > 0) {
         aWriter.Write(Brn("]"));
     }
 }
@@ -324,6 +388,7 @@ FrameworkTab::FrameworkTab(TUint aTabId, IFrameworkTabHandler& aTabHandler)
     , iDestroyHandler(nullptr)
     , iTab(nullptr)
     , iPollActive(false)
+    , iStreamActive(false)
     , iLock("FRTL")
     , iRefCount(0)
 {
@@ -393,7 +458,7 @@ void FrameworkTab::LongPoll(IWriter& aWriter)
         AutoMutex a(iLock);
         ASSERT(iTab != nullptr);
 
-        if (iPollActive) {
+        if (iPollActive || iStreamActive) {
             THROW(WebAppLongPollInProgress);
         }
         iPollActive = true;
@@ -405,6 +470,31 @@ void FrameworkTab::LongPoll(IWriter& aWriter)
     iPollActive = false;
 }
 
+void FrameworkTab::StreamStart(ITabPushObserver& aObserver)
+{
+    {
+        AutoMutex a(iLock);
+        ASSERT(iTab != nullptr);
+        if (iPollActive || iStreamActive) {
+            THROW(WebAppLongPollInProgress);
+        }
+        iStreamActive = true;
+    }
+    iHandler.SetPushObserver(&aObserver);
+}
+
+void FrameworkTab::StreamEnd()
+{
+    iHandler.SetPushObserver(nullptr);
+    AutoMutex a(iLock);
+    iStreamActive = false;
+}
+
+void FrameworkTab::WritePending(IWriter& aWriter)
+{
+    iHandler.WritePending(aWriter);
+}
+
 void FrameworkTab::Interrupt()
 {
     // Can't be uninterrupted; destroying and creating new tab clears interrupted state.
@@ -487,6 +577,21 @@ void FrameworkTabFull::LongPoll(IWriter& aWriter)
     iTab.LongPoll(aWriter);
 }
 
+void FrameworkTabFull::StreamStart(ITabPushObserver& aObserver)
+{
+    iTab.StreamStart(aObserver);
+}
+
+void FrameworkTabFull::StreamEnd()
+{
+    iTab.StreamEnd();
+}
+
+void FrameworkTabFull::WritePending(IWriter& aWriter)
+{
+    iTab.WritePending(aWriter);
+}
+
 void FrameworkTabFull::Interrupt()
 {
     iTab.Interrupt();
@@ -607,6 +712,64 @@ void TabManager::LongPoll(TUint aId, IWriter& aWriter)
     tab->RemoveRef();   // Note: iLock not held, so tab must do internal locking.
 }
 
+void TabManager::StreamStart(const std::vector<TUint>& aIds, ITabPushObserver& aObserver, std::vector<IFrameworkTab*>& aTabs)
+{
+    LOG(kHttp, "TabManager::StreamStart tabs: %u\n", (TUint)aIds.size());
+    aTabs.clear();
+    {
+        AutoMutex amx(iLock);
+        if (!iEnabled) {
+            THROW(InvalidTabId);
+        }
+
+        for (auto id : aIds) {
+            if (id == IFrameworkTab::kInvalidTabId) {
+                break;
+            }
+            for (auto* t : iTabsActive) {
+                if (t->SessionId() == id) {
+                    aTabs.push_back(t);
+                    break;
+                }
+            }
+        }
+        if (aTabs.size() != aIds.size()) {
+            aTabs.clear();
+            THROW(InvalidTabId);
+        }
+        for (auto* t : aTabs) {
+            t->AddRef();
+        }
+    }
+
+    // Note: iLock not held, so tabs must do internal locking.
+    TUint started = 0;
+    try {
+        for (auto* t : aTabs) {
+            t->StreamStart(aObserver);
+            started++;
+        }
+    }
+    catch (const WebAppLongPollInProgress&) {
+        for (TUint i=0; i<aTabs.size(); i++) {
+            if (i < started) {
+                aTabs[i]->StreamEnd();
+            }
+            aTabs[i]->RemoveRef();
+        }
+        aTabs.clear();
+        throw;
+    }
+}
+
+void TabManager::StreamEnd(const std::vector<IFrameworkTab*>& aTabs)
+{
+    for (auto* t : aTabs) {
+        t->StreamEnd();
+        t->RemoveRef();
+    }
+}
+
 void TabManager::Receive(TUint aId, const Brx& aMessage)
 {
     if (aId == IFrameworkTab::kInvalidTabId) {
@@ -749,27 +912,27 @@ TUint TabManagerTimed::CreateTab(ITabCreator& aTabCreator, const std::vector<cha
 
 void TabManagerTimed::LongPoll(TUint aId, IWriter& aWriter)
 {
-    {
-        AutoMutex amx(iLock);
-        for (auto* timeout : iTimeoutsActive) {
-            if (timeout->Id() == aId) {
-                timeout->Timer().Cancel();
-                break;
-            }
-        }
-    }
+    CancelTimeout(aId);
     iTabManager.LongPoll(aId, aWriter); // May throw exception (so will not attempt to start timer below).
+    StartTimeout(aId);
+}
 
-    // Tab may have been deallocated between cancelling timer above and here, so need to check if timeout still exists.
-    {
-        AutoMutex amx(iLock);
-        for (auto* timeout : iTimeoutsActive) {
-            if (timeout->Id() == aId) {
-                timeout->Timer().Start(aId);
-                break;
-            }
-        }
+void TabManagerTimed::StreamStart(const std::vector<TUint>& aIds, ITabPushObserver& aObserver, std::vector<IFrameworkTab*>& aTabs)
+{
+    iTabManager.StreamStart(aIds, aObserver, aTabs); // May throw exception (so will not cancel timers below).
+    for (auto id : aIds) {
+        CancelTimeout(id);
+    }
+}
+
+void TabManagerTimed::StreamEnd(const std::vector<IFrameworkTab*>& aTabs)
+{
+    // Client must now resume polling or streaming before the tabs time out.
+    // Refs are still held, so session ids remain valid until iTabManager.StreamEnd() is called.
+    for (auto* t : aTabs) {
+        StartTimeout(t->SessionId());
     }
+    iTabManager.StreamEnd(aTabs);
 }
 
 void TabManagerTimed::Receive(TUint aId, const Brx& aMessage)
@@ -809,6 +972,29 @@ void TabManagerTimed::DestroyTab(TUint aId, TBool aCancelTimeout)
     iTabManager.DestroyTab(aId);
 }
 
+void TabManagerTimed::CancelTimeout(TUint aId)
+{
+    AutoMutex amx(iLock);
+    for (auto* timeout : iTimeoutsActive) {
+        if (timeout->Id() == aId) {
+            timeout->Timer().Cancel();
+            break;
+        }
+    }
+}
+
+void TabManagerTimed::StartTimeout(TUint aId)
+{
+    // Tab may have been deallocated since its timeout was cancelled, so need to check if timeout still exists.
+    AutoMutex amx(iLock);
+    for (auto* timeout : iTimeoutsActive) {
+        if (timeout->Id() == aId) {
+            timeout->Timer().Start(aId);
+            break;
+        }
+    }
+}
+
 
 // WebAppFramework::BrxPtrCmp
 
@@ -935,6 +1121,7 @@ WebAppFramework::WebAppFramework(Environment& aEnv, WebAppFrameworkInitParams* a
     : iEnv(aEnv)
     , iInitParams(aInitParams)
     , iServer(nullptr)
+    , iEventDispatcher(nullptr)
     , iDefaultApp(nullptr)
     , iStarted(false)
     , iCurrentAdapter(nullptr)
@@ -959,6 +1146,10 @@ WebAppFramework::WebAppFramework(Environment& aEnv, WebAppFrameworkInitParams* a
     //iTabManager = new TabManager(tabs); // Takes ownership.
     TimerFactory timerFactory(aEnv);
     iTabManager = new TabManagerTimed(tabs, iInitParams->LongPollTimeoutMs(), timerFactory, aThreadPool); // Takes ownership of tabs.
+    // Each stream occupies a session for as long as it is open, so never allow
+    // more streams than there are long poll sessions. That leaves at least
+    // MinServerThreadsResources() sessions free to serve other requests.
+    iEventDispatcher = new TabEventDispatcher(aEnv, iInitParams->MaxServerThreadsLongPoll());
 
     Functor functor = MakeFunctor(*this, &WebAppFramework::CurrentAdapterChanged);
     NetworkAdapterList& nifList = iEnv.NetworkAdapterList();
@@ -985,6 +1176,8 @@ WebAppFramework::~WebAppFramework()
 
     // Delete TabManager before WebApps to allow it to free up any WebApp tabs that it may hold reference for.
     delete iTabManager;
+    // No sessions remain to stream tabs.
+    delete iEventDispatcher;
 
     WebAppMap::iterator it;
     for (it=iWebApps.begin(); it!=iWebApps.end(); ++it) {
@@ -1123,7 +1316,7 @@ void WebAppFramework::AddSessions()
     for (TUint i=0; i<iInitParams->MinServerThreadsResources()+iInitParams->MaxServerThreadsLongPoll(); i++) {
         Bws<kMaxSessionNameBytes> name(kSessionPrefix);
         Ascii::AppendDec(name, i+1);
-        auto* session = new HttpSession(iEnv, *this, *iTabManager, *this);
+        auto* session = new HttpSession(iEnv, *this, *iTabManager, *this, *iEventDispatcher);
         iSessions.push_back(*session);
         iServer->Add(name.PtrZ(), session);
     }
@@ -1201,11 +1394,38 @@ WriterHttpResponseContentLengthUnknown::WriterHttpResponseContentLengthUnknown(I
 
 void WriterHttpResponseContentLengthUnknown::WriteHeader(Http::EVersion aVersion, HttpStatus aStatus, const Brx& aContentType)
 {
-    /*
-     * In HTTP/1.0, if content length is not known, it appears to be valid to merely omit the content-length header in a response, and use the fact that the connection must be closed at the end of the response to identify end-of-response.
-     *
-     * In HTTP/1.1, chunking must be used if content-length is not known in advance.
-     */
+    WriteStatus(aVersion, aStatus, aContentType);
+    WriteTransferEncoding(aVersion);
+    iWriterResponse.WriteFlush();
+}
+
+void WriterHttpResponseContentLengthUnknown::WriteHeader(Http::EVersion aVersion, HttpStatus aStatus, const Brx& aContentType, const Brx& aETag, const Brx& aContentEncoding)
+{
+    WriteStatus(aVersion, aStatus, aContentType);
+    if (aETag.Bytes() > 0) {
+        WriteCacheHeaders(aETag);
+        // Response depends on Accept-Encoding even where a resource has no compressed variants, as they may be added later.
+        iWriterResponse.WriteHeader(kHeaderVary, kHeaderAcceptEncoding);
+    }
+    if (aContentEncoding.Bytes() > 0) {
+        iWriterResponse.WriteHeader(kHeaderContentEncoding, aContentEncoding);
+    }
+    WriteTransferEncoding(aVersion);
+    iWriterResponse.WriteFlush();
+}
+
+void WriterHttpResponseContentLengthUnknown::WriteHeaderNotModified(Http::EVersion aVersion, const Brx& aETag)
+{
+    ASSERT_VA(aVersion == Http::eHttp10 || aVersion == Http::eHttp11, "WriterHttpResponseContentLengthUnknown::WriteHeaderNotModified aVersion: %u\n", aVersion);
+    iWriterResponse.WriteStatus(HttpStatus::kNotModified, aVersion);
+    WriteCacheHeaders(aETag);
+    iWriterChunked.SetChunked(false); // 304 responses never have a body, so don't terminate one
+    iWriterResponse.WriteHeader(Http::kHeaderConnection, Http::kConnectionClose);
+    iWriterResponse.WriteFlush();
+}
+
+void WriterHttpResponseContentLengthUnknown::WriteStatus(Http::EVersion aVersion, HttpStatus aStatus, const Brx& aContentType)
+{
     ASSERT_VA(aVersion == Http::eHttp10 || aVersion == Http::eHttp11, "WriterHttpResponseContentLengthUnknown::WriteHeader aVersion: %u\n", aVersion);
 
     iWriterResponse.WriteStatus(aStatus, aVersion);
@@ -1216,7 +1436,22 @@ void WriterHttpResponseContentLengthUnknown::WriteHeader(Http::EVersion aVersion
         writer.Write(aContentType);
         writer.WriteFlush();
     }
+}
 
+void WriterHttpResponseContentLengthUnknown::WriteCacheHeaders(const Brx& aETag)
+{
+    // Clients may keep resources but must revalidate them (cheaply, via If-None-Match) before each use.
+    iWriterResponse.WriteHeader(kHeaderETag, aETag);
+    iWriterResponse.WriteHeader(kHeaderCacheControl, kCacheControlNoCache);
+}
+
+void WriterHttpResponseContentLengthUnknown::WriteTransferEncoding(Http::EVersion aVersion)
+{
+    /*
+     * In HTTP/1.0, if content length is not known, it appears to be valid to merely omit the content-length header in a response, and use the fact that the connection must be closed at the end of the response to identify end-of-response.
+     *
+     * In HTTP/1.1, chunking must be used if content-length is not known in advance.
+     */
     if (aVersion == Http::eHttp11) {
         iWriterResponse.WriteHeader(Http::kHeaderTransferEncoding, Http::kTransferEncodingChunked);
         iWriterChunked.SetChunked(true);
@@ -1227,7 +1462,6 @@ void WriterHttpResponseContentLengthUnknown::WriteHeader(Http::EVersion aVersion
 
     // Always going to close connection, regardless of HTTP/1.0 or HTTP/1.1.
     iWriterResponse.WriteHeader(Http::kHeaderConnection, Http::kConnectionClose);
-    iWriterResponse.WriteFlush();
 }
 
 void WriterHttpResponseContentLengthUnknown::Write(TByte aValue)
@@ -1317,12 +1551,422 @@ void WriterLongPollDelayed::WriteHeaderIfNotWritten()
 }
 
 
+// WriterStreamChunked
+
+WriterStreamChunked::WriterStreamChunked(IWriter& aWriter)
+    : iWriter(aWriter)
+    , iChunked(false)
+{
+}
+
+void WriterStreamChunked::SetChunked(TBool aChunked)
+{
+    iBuf.SetBytes(0);   // Discard anything left from a previous response that failed.
+    iChunked = aChunked;
+}
+
+void WriterStreamChunked::Write(TByte aValue)
+{
+    if (iBuf.BytesRemaining() == 0) {
+        WriteChunk(iBuf);
+        iBuf.SetBytes(0);
+    }
+    iBuf.Append(aValue);
+}
+
+void WriterStreamChunked::Write(const Brx& aBuffer)
+{
+    if (iBuf.BytesRemaining() < aBuffer.Bytes()) {
+        WriteChunk(iBuf);
+        iBuf.SetBytes(0);
+    }
+    if (aBuffer.Bytes() > iBuf.MaxBytes()) {
+        WriteChunk(aBuffer);
+    }
+    else {
+        iBuf.Append(aBuffer);
+    }
+}
+
+void WriterStreamChunked::WriteFlush()
+{
+    WriteChunk(iBuf);
+    iBuf.SetBytes(0);
+    iWriter.WriteFlush();
+}
+
+void WriterStreamChunked::WriteChunk(const Brx& aBuffer)
+{
+    if (aBuffer.Bytes() == 0) {
+        return; // A zero-length chunk would terminate the response.
+    }
+    if (iChunked) {
+        Bws<2 * sizeof(TUint)> chunkSize;
+        Ascii::AppendHex(chunkSize, aBuffer.Bytes());
+        iWriter.Write(chunkSize);
+        iWriter.Write(Brn("\r\n"));
+        iWriter.Write(aBuffer);
+        iWriter.Write(Brn("\r\n"));
+    }
+    else {
+        iWriter.Write(aBuffer);
+    }
+}
+
+
+// TabEventStream
+
+TabEventStream::TabEventStream(WriterHttpResponseContentLengthUnknown& aWriterResponse, IWriter& aWriter, IReader& aReader)
+    : iWriterResponse(aWriterResponse)
+    , iWriter(aWriter)
+    , iReader(aReader)
+    , iTab(nullptr)
+    , iVersion(Http::eHttp11)
+    , iStartTimeMs(0)
+    , iHeaderWritten(false)
+    , iEventStarted(false)
+{
+}
+
+void TabEventStream::Set(const std::vector<IFrameworkTab*>& aTabs, Http::EVersion aVersion)
+{
+    iTabs = aTabs;
+    iVersion = aVersion;
+    iHeaderWritten = false;
+    iWriter.SetChunked(aVersion == Http::eHttp11);
+}
+
+void TabEventStream::Clear()
+{
+    iTabs.clear();
+}
+
+void TabEventStream::SetStartTime(TUint aTimeMs)
+{
+    iStartTimeMs = aTimeMs;
+}
+
+TUint TabEventStream::StartTime() const
+{
+    return iStartTimeMs;
+}
+
+void TabEventStream::WriteEvents()
+{
+    WriteHeaderIfNotWritten();
+    TBool written = false;
+    for (auto* tab : iTabs) {
+        iTab = tab;
+        iEventStarted = false;
+        tab->WritePending(*this);   // Writes nothing if tab has no msgs queued.
+        if (iEventStarted) {
+            iWriter.Write(Brn("}\n\n"));
+            written = true;
+        }
+    }
+    iTab = nullptr;
+    if (written) {
+        iWriter.WriteFlush();
+    }
+}
+
+void TabEventStream::WriteKeepAlive()
+{
+    WriteHeaderIfNotWritten();
+    iWriter.Write(Brn(":\n\n")); // Comment line; ignored by clients.
+    iWriter.WriteFlush();
+}
+
+void TabEventStream::Close()
+{
+    iReader.ReadInterrupt();
+}
+
+void TabEventStream::Write(TByte aValue)
+{
+    StartEventIfNotStarted();
+    // Any line break ends a field, so continue the data on a new field.
+    // (Msgs are JSON, so this only introduces whitespace.)
+    if (aValue == '\r' || aValue == '\n') {
+        iWriter.Write('\n');
+        iWriter.Write(kEventDataField);
+    }
+    else {
+        iWriter.Write(aValue);
+    }
+}
+
+void TabEventStream::Write(const Brx& aBuffer)
+{
+    StartEventIfNotStarted();
+    TUint start = 0;
+    for (TUint i=0; i<aBuffer.Bytes(); i++) {
+        if (aBuffer[i] == '\r' || aBuffer[i] == '\n') {
+            iWriter.Write(aBuffer.Split(start, i - start));
+            iWriter.Write('\n');
+            iWriter.Write(kEventDataField);
+            start = i + 1;
+        }
+    }
+    iWriter.Write(aBuffer.Split(start));
+}
+
+void TabEventStream::WriteFlush()
+{
+    // Events are flushed together once all tabs have been written.
+}
+
+void TabEventStream::WriteHeaderIfNotWritten()
+{
+    if (!iHeaderWritten) {
+        iHeaderWritten = true;
+        iWriterResponse.WriteHeader(iVersion, HttpStatus::kOk, kContentTypeEventStream);
+    }
+}
+
+void TabEventStream::StartEventIfNotStarted()
+{
+    if (!iEventStarted) {
+        iEventStarted = true;
+        Bws<Ascii::kMaxUintStringBytes> idBuf;
+        Ascii::AppendDec(idBuf, iTab->SessionId());
+        iWriter.Write(kEventDataField);
+        iWriter.Write(Brn("{\"session-id\": "));
+        iWriter.Write(idBuf);
+        iWriter.Write(Brn(", \"messages\": "));
+    }
+}
+
+
+// TabEventDispatcher
+
+TabEventDispatcher::TabEventDispatcher(Environment& aEnv, TUint aMaxStreams)
+    : iEnv(aEnv)
+    , iMaxStreams(aMaxStreams)
+    , iLock("TEDL")
+    , iSem("TEDS", 0)
+    , iSemWriteEnded("TEDW", 0)
+    , iStreamWriting(nullptr)
+    , iWriteStartMs(0)
+    , iRemovePending(false)
+    , iQuit(false)
+    , iLastKeepAliveMs(Os::TimeInMs(aEnv.OsCtx()))
+    , iTimerWrite(aEnv, MakeFunctor(*this, &TabEventDispatcher::WriteTimeout), "TabEventDispatcher")
+{
+    iStreams.reserve(iMaxStreams);
+    iStreamsWrite.reserve(iMaxStreams);
+    iThread = new ThreadFunctor("WebUiEvents", MakeFunctor(*this, &TabEventDispatcher::Run));
+    iThread->Start();
+}
+
+TabEventDispatcher::~TabEventDispatcher()
+{
+    iQuit = true;
+    iSem.Signal();
+    delete iThread;
+    iTimerWrite.Cancel();
+    ASSERT(iStreams.size() == 0);   // All sessions must have ended.
+}
+
+TBool TabEventDispatcher::TryAdd(TabEventStream& aStream)
+{
+    {
+        AutoMutex a(iLock);
+        if (iStreams.size() == iMaxStreams) {
+            return false;
+        }
+        aStream.SetStartTime(Os::TimeInMs(iEnv.OsCtx()));
+        iStreams.push_back(&aStream);
+    }
+    // Response header is written on next pass.  Tabs may also have had msgs queued before streaming started.
+    iSem.Signal();
+    return true;
+}
+
+void TabEventDispatcher::Remove(TabEventStream& aStream)
+{
+    iLock.Wait();
+    auto it = std::find(iStreams.begin(), iStreams.end(), &aStream);
+    ASSERT(it != iStreams.end());
+    iStreams.erase(it);
+    const TBool writing = (iStreamWriting == &aStream);
+    if (writing) {
+        // Don't wait for a client that has stopped reading.
+        aStream.Close();
+        iSemWriteEnded.Clear();
+        iRemovePending = true;
+    }
+    iLock.Signal();
+    if (writing) {
+        iSemWriteEnded.Wait();
+    }
+}
+
+void TabEventDispatcher::MessagesPending()
+{
+    iSem.Signal();
+}
+
+void TabEventDispatcher::Run()
+{
+    while (!iQuit) {
+        try {
+            iSem.Wait(kKeepAliveMs);
+        }
+        catch (Timeout&) {}
+        if (iQuit) {
+            break;
+        }
+        // Any msgs queued after this will signal iSem again, so will be picked up on next pass, if not this one.
+        (void)iSem.Clear();
+
+        const TUint nowMs = Os::TimeInMs(iEnv.OsCtx());
+        const TBool keepAlive = (nowMs - iLastKeepAliveMs >= kKeepAliveMs);
+        if (keepAlive) {
+            iLastKeepAliveMs = nowMs;
+        }
+        Write(keepAlive);
+    }
+}
+
+void TabEventDispatcher::Write(TBool aKeepAlive)
+{
+    {
+        AutoMutex a(iLock);
+        iStreamsWrite = iStreams;
+    }
+    for (auto* stream : iStreamsWrite) {
+        if (!TryStartWrite(*stream)) {
+            continue;   // Removed since this pass started.
+        }
+        try {
+            if (iWriteStartMs - stream->StartTime() >= kMaxStreamDurationMs) {
+                // Free up its session.  Client will long poll before opening a new stream.
+                LOG(kHttp, "TabEventDispatcher::Write closing stream after %ums\n", kMaxStreamDurationMs);
+                stream->Close();
+            }
+            else {
+                iTimerWrite.FireIn(kWriteTimeoutMs);
+                stream->WriteEvents();
+                if (aKeepAlive) {
+                    stream->WriteKeepAlive();
+                }
+            }
+        }
+        catch (WriterError&) {
+            // Client has gone.  Its session will Remove() the stream once unblocked.
+            LOG(kHttp, "TabEventDispatcher::Write WriterError\n");
+            stream->Close();
+        }
+        iTimerWrite.Cancel();
+        EndWrite();
+    }
+}
+
+TBool TabEventDispatcher::TryStartWrite(TabEventStream& aStream)
+{
+    AutoMutex a(iLock);
+    if (std::find(iStreams.begin(), iStreams.end(), &aStream) == iStreams.end()) {
+        return false;
+    }
+    iStreamWriting = &aStream;
+    iWriteStartMs = Os::TimeInMs(iEnv.OsCtx());
+    return true;
+}
+
+void TabEventDispatcher::EndWrite()
+{
+    AutoMutex a(iLock);
+    iStreamWriting = nullptr;
+    if (iRemovePending) {
+        iRemovePending = false;
+        iSemWriteEnded.Signal();
+    }
+}
+
+void TabEventDispatcher::WriteTimeout()
+{
+    AutoMutex a(iLock);
+    // Timer may have fired just as a write ended, so check that the current write really has taken too long.
+    if (iStreamWriting != nullptr && Os::TimeInMs(iEnv.OsCtx()) - iWriteStartMs >= kWriteTimeoutMs) {
+        LOG(kHttp, "TabEventDispatcher::WriteTimeout closing stalled stream\n");
+        iStreamWriting->Close();
+    }
+}
+
+
+// HeaderIfNoneMatch
+
+TBool HeaderIfNoneMatch::Matches(const Brx& aETag) const
+{
+    if (!Received()) {
+        return false;
+    }
+    static const Brn kWeakPrefix("W/");
+    Brn etag(aETag);
+    if (etag.BeginsWith(kWeakPrefix)) {
+        etag.Set(etag.Split(kWeakPrefix.Bytes()));
+    }
+    Parser parser(iValue);
+    while (!parser.Finished()) {
+        Brn candidate = Ascii::Trim(parser.Next(','));
+        if (candidate == Brn("*")) {
+            return true;
+        }
+        if (candidate.BeginsWith(kWeakPrefix)) {
+            candidate.Set(candidate.Split(kWeakPrefix.Bytes()));
+        }
+        if (candidate == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TBool HeaderIfNoneMatch::Recognise(const Brx& aHeader)
+{
+    return Ascii::CaseInsensitiveEquals(aHeader, kHeaderIfNoneMatch);
+}
+
+void HeaderIfNoneMatch::Process(const Brx& aValue)
+{
+    // Ignore implausibly long lists of tags.  The client will just receive the full resource.
+    if (aValue.Bytes() <= iValue.MaxBytes()) {
+        iValue.Replace(aValue);
+        SetReceived();
+    }
+}
+
+
+// HeaderAcceptEncoding
+
+TUint HeaderAcceptEncoding::Encodings() const
+{
+    if (Received()) {
+        return iEncodings;
+    }
+    return ResourceEncoding::kIdentity;
+}
+
+TBool HeaderAcceptEncoding::Recognise(const Brx& aHeader)
+{
+    return Ascii::CaseInsensitiveEquals(aHeader, kHeaderAcceptEncoding);
+}
+
+void HeaderAcceptEncoding::Process(const Brx& aValue)
+{
+    iEncodings = ResourceEncoding::FromAcceptEncoding(aValue);
+    SetReceived();
+}
+
+
 // HttpSession
 
-HttpSession::HttpSession(Environment& aEnv, IWebAppManager& aAppManager, ITabManager& aTabManager, IResourceManager& aResourceManager)
+HttpSession::HttpSession(Environment& aEnv, IWebAppManager& aAppManager, ITabManager& aTabManager, IResourceManager& aResourceManager, TabEventDispatcher& aEventDispatcher)
     : iAppManager(aAppManager)
     , iTabManager(aTabManager)
     , iResourceManager(aResourceManager)
+    , iEventDispatcher(aEventDispatcher)
     , iResponseStarted(false)
     , iResponseEnded(false)
     , iResourceWriterHeadersOnly(false)
@@ -1337,6 +1981,9 @@ HttpSession::HttpSession(Environment& aEnv, IWebAppManager& aAppManager, ITabMan
     iWriterBuffer = new Sws<kMaxResponseBytes>(*this);
     iWriterResponse = new WriterHttpResponseContentLengthUnknown(*iWriterBuffer);
     iWriterResponseLongPoll = new WriterLongPollResponse(*iWriterResponse);
+    iEventStream = new TabEventStream(*iWriterResponse, *iWriterBuffer, *iReadBuffer);
+    iStreamIds.reserve(kMaxStreamTabs);
+    iStreamTabs.reserve(kMaxStreamTabs);
 
     iReaderRequest->AddMethod(Http::kMethodGet);
     iReaderRequest->AddMethod(Http::kMethodPost);
@@ -1346,10 +1993,13 @@ HttpSession::HttpSession(Environment& aEnv, IWebAppManager& aAppManager, ITabMan
     iReaderRequest->AddHeader(iHeaderTransferEncoding);
     iReaderRequest->AddHeader(iHeaderConnection);
     iReaderRequest->AddHeader(iHeaderAcceptLanguage);
+    iReaderRequest->AddHeader(iHeaderIfNoneMatch);
+    iReaderRequest->AddHeader(iHeaderAcceptEncoding);
 }
 
 HttpSession::~HttpSession()
 {
+    delete iEventStream;
     delete iWriterResponseLongPoll;
     delete iWriterResponse;
     delete iWriterBuffer;
@@ -1491,20 +2141,33 @@ void HttpSession::Error(const HttpStatus& aStatus)
 
 void HttpSession::Get()
 {
-    // Try access requested resource.
     const Brx& uri = iReaderRequest->Uri();
+    if (!iResourceWriterHeadersOnly && TryStream(uri)) {
+        return;
+    }
+
+    // Try access requested resource.
     IResourceHandler* resourceHandler = iResourceManager.CreateResourceHandler(uri);    // throws ResourceInvalid
 
     try {
         Brn mimeType = MimeUtils::MimeTypeFromUri(uri);
         LOG(kHttp, "HttpSession::Get URI: %.*s  Content-Type: %.*s\n", PBUF(uri), PBUF(mimeType));
 
-        // Write response headers.
+        resourceHandler->SetAcceptedEncodings(iHeaderAcceptEncoding.Encodings());
+        const Brx& etag = resourceHandler->ETag();
+        const auto version = iReaderRequest->Version();
         iResponseStarted = true;
-        iWriterResponse->WriteHeader(iReaderRequest->Version(), HttpStatus::kOk, mimeType);
+        if (etag.Bytes() > 0 && iHeaderIfNoneMatch.Matches(etag)) {
+            // Client already has this version of the resource.
+            iWriterResponse->WriteHeaderNotModified(version, etag);
+        }
+        else {
+            // Write response headers.
+            iWriterResponse->WriteHeader(version, HttpStatus::kOk, mimeType, etag, resourceHandler->ContentEncoding());
 
-        // Write content.
-        resourceHandler->Write(*iWriterResponse);
+            // Write content.
+            resourceHandler->Write(*iWriterResponse);
+        }
         iWriterResponse->WriteFlush(); // FIXME - move into iResourceWriter.Write()?
         resourceHandler->Destroy();
         iResponseEnded = true;
@@ -1516,6 +2179,89 @@ void HttpSession::Get()
     }
 }
 
+TBool HttpSession::TryStream(const Brx& aUri)
+{
+    // Streams are requested using GET (as that is all an EventSource can use), with a URI of the form:
+    // [/<prefix>]/lpstream?session-id=<id>[,<id>...]
+    Parser uriParser(aUri);
+    Parser pathParser(uriParser.Next('?'));
+    Brn uriTail;
+    while (!pathParser.Finished()) {
+        uriTail = pathParser.Next('/');
+    }
+    if (uriTail != Brn("lpstream")) {
+        return false;
+    }
+
+    Brn sessionIds;
+    while (!uriParser.Finished()) {
+        Parser paramParser(uriParser.Next('&'));
+        if (paramParser.Next('=') == Brn("session-id")) {
+            sessionIds.Set(paramParser.Remaining());
+        }
+    }
+    iStreamIds.clear();
+    Parser idParser(sessionIds);
+    while (!idParser.Finished()) {
+        if (iStreamIds.size() == kMaxStreamTabs) {
+            Error(HttpStatus::kBadRequest);
+        }
+        try {
+            iStreamIds.push_back(Ascii::Uint(idParser.Next(',')));
+        }
+        catch (AsciiError&) {
+            Error(HttpStatus::kBadRequest);
+        }
+    }
+    if (iStreamIds.size() == 0) {
+        Error(HttpStatus::kBadRequest);
+    }
+
+    Stream(iReaderRequest->Version());
+    return true;
+}
+
+void HttpSession::Stream(Http::EVersion aVersion)
+{
+    try {
+        iTabManager.StreamStart(iStreamIds, iEventDispatcher, iStreamTabs);
+    }
+    catch (const InvalidTabId&) {
+        Error(HttpStatus::kNotFound);
+    }
+    catch (const WebAppLongPollInProgress&) {
+        // Tab is already being polled or streamed by (a misbehaving) client.
+        Error(HttpStatus::kBadRequest);
+    }
+
+    iEventStream->Set(iStreamTabs, aVersion);
+    if (!iEventDispatcher.TryAdd(*iEventStream)) {
+        // Too many streams already occupy sessions.  Client will long poll instead.
+        LOG(kHttp, "HttpSession::Stream refused, tabs: %u\n", (TUint)iStreamTabs.size());
+        iEventStream->Clear();
+        iTabManager.StreamEnd(iStreamTabs);
+        iStreamTabs.clear();
+        Error(HttpStatus::kServiceUnavailable);
+    }
+
+    LOG(kHttp, "HttpSession::Stream started, tabs: %u\n", (TUint)iStreamTabs.size());
+    // iEventDispatcher writes the response header along with any msgs, so
+    // this thread has nothing to do other than notice the client closing the
+    // connection (or iEventDispatcher closing the stream).
+    iResponseStarted = true;
+    try {
+        for (;;) {
+            (void)iReadBuffer->Read(kMaxRequestBytes);
+        }
+    }
+    catch (const ReaderError&) {}
+    iEventDispatcher.Remove(*iEventStream);
+    iEventStream->Clear();
+    iTabManager.StreamEnd(iStreamTabs);
+    iStreamTabs.clear();
+    LOG(kHttp, "HttpSession::Stream ended\n");
+}
+
 void HttpSession::Post()
 {
     const Brx& uri = iReaderRequest->Uri();
@@ -7,6 +7,7 @@
 #include <OpenHome/Private/Fifo.h>
 #include <OpenHome/Private/File.h>
 #include <OpenHome/Private/Stream.h>
+#include <OpenHome/Private/Thread.h>
 #include <OpenHome/Net/Private/DviServerUpnp.h>
 #include <OpenHome/Web/ResourceHandler.h>
 
@@ -120,6 +121,17 @@ public:
     virtual ~IFrameworkSemaphore() {}
 };
 
+/**
+ * Notified when msgs are queued for a tab whose msgs are pushed to a stream
+ * rather than collected by long polls.
+ */
+class ITabPushObserver
+{
+public:
+    virtual void MessagesPending() = 0; // Called without any tab lock held. Must not block.
+    virtual ~ITabPushObserver() {}
+};
+
 class IFrameworkTabHandler : public ITabHandler
 {
 public: // from ITabHandler
@@ -127,6 +139,8 @@ public: // from ITabHandler
 public:
     // FIXME - need an Interrupt() method to interrupt any in-progress LongPoll()s?
     virtual void LongPoll(IWriter& aWriter) = 0;    // THROWS WriterError.
+    virtual void SetPushObserver(ITabPushObserver* aObserver) = 0; // nullptr reverts to long polling.
+    virtual void WritePending(IWriter& aWriter) = 0;    // Writes any queued msgs without blocking. THROWS WriterError.
     virtual void Enable() = 0;
     virtual void Disable() = 0; // Disallow LongPoll()/Send() calls.
     virtual ~IFrameworkTabHandler() {}
@@ -143,17 +157,23 @@ public:
 private: // from IFrameworkTabHandler
     void Send(ITabMessage& aMessage) override;
     void LongPoll(IWriter& aWriter) override;   // THROWS WriterError.
+    void SetPushObserver(ITabPushObserver* aObserver) override;
+    void WritePending(IWriter& aWriter) override;   // THROWS WriterError.
     void Enable() override;  // Allow new polls/sends to take place.
     void Disable() override; // Cancel blocking send and clear FIFO.
 private: // from IFrameworkTimerHandler
     void Complete() override;
 private:
-    void WriteMessagesLocked(IWriter& aWriter);
+    void TakeMessagesLocked();
+    void WriteMessages(IWriter& aWriter);   // Writes msgs from TakeMessagesLocked() without iLock held. THROWS WriterError.
 private:
     const TUint iSendTimeoutMs;
     FifoLiteDynamic<ITabMessage*> iFifo;
+    std::vector<ITabMessage*> iPending; // Msgs taken from iFifo that are being written.
     TBool iEnabled;
     TBool iPolling;
+    TBool iWriting;
+    ITabPushObserver* iPushObserver;
     Mutex iLock;
     IFrameworkSemaphore& iSemRead;
     IFrameworkSemaphore& iSemWrite;
@@ -198,6 +218,15 @@ public:
 
     virtual void Receive(const Brx& aMessage) = 0;
     virtual void LongPoll(IWriter& aWriter) = 0;    // Terminates poll timer on entry; restarts poll timer on exit. THROWS WriterError.
+    /*
+     * Between StreamStart() and StreamEnd(), msgs are no longer collected by
+     * LongPoll() but written by WritePending() whenever aObserver is notified.
+     * StreamStart() THROWS WebAppLongPollInProgress if the tab is already being
+     * long polled or streamed.
+     */
+    virtual void StreamStart(ITabPushObserver& aObserver) = 0;
+    virtual void StreamEnd() = 0;
+    virtual void WritePending(IWriter& aWriter) = 0;    // THROWS WriterError.
 
     /*
      * Can't be uninterrupted without remaining refs being removed and tab being reinitialised.
@@ -268,6 +297,9 @@ public: // from IFrameworkTab
     void RemoveRef() override;
     void Receive(const Brx& aMessage) override;
     void LongPoll(IWriter& aWriter) override;   // THROWS WriterError.
+    void StreamStart(ITabPushObserver& aObserver) override;
+    void StreamEnd() override;
+    void WritePending(IWriter& aWriter) override;   // THROWS WriterError.
     void Interrupt() override;
 private: // from ITabHandler
     void Send(ITabMessage& aMessage) override;
@@ -283,6 +315,7 @@ private:
     ITab* iTab;
     std::vector<Bws<10>> iLanguages; // Takes ownership of pointers.
     TBool iPollActive;  // FIXME - can this be an atomic?
+    TBool iStreamActive;
     mutable Mutex iLock;
     std::atomic<TUint> iRefCount;
 };
@@ -302,6 +335,9 @@ public: // from IFrameworkTab
     void RemoveRef() override;
     void Receive(const Brx& aMessage) override;
     void LongPoll(IWriter& aWriter) override;   // THROWS WriterError.
+    void StreamStart(ITabPushObserver& aObserver) override;
+    void StreamEnd() override;
+    void WritePending(IWriter& aWriter) override;   // THROWS WriterError.
     void Interrupt() override;
 private: // from ITabDestroyHandler
     void Destroy(IFrameworkTab* aTab) override;
@@ -324,6 +360,13 @@ public:
     virtual TUint CreateTab(ITabCreator& aTabCreator, const std::vector<char*>& aLanguageList) = 0;    // Returns tab ID; THROWS TabManagerFull, TabAllocatorFull.
     // Following calls may all throw InvalidTabId.
     virtual void LongPoll(TUint aId, IWriter& aWriter) = 0;  // Will block until something is written or poll timeout. THROWS WriterError on write failure.
+    /*
+     * Push msgs for all tabs in aIds to aObserver rather than waiting for them to be long polled.
+     * Adds a ref to each tab, returning them in aTabs, which must later be passed to StreamEnd().
+     * THROWS WebAppLongPollInProgress if any tab is already being polled or streamed.
+     */
+    virtual void StreamStart(const std::vector<TUint>& aIds, ITabPushObserver& aObserver, std::vector<IFrameworkTab*>& aTabs) = 0;
+    virtual void StreamEnd(const std::vector<IFrameworkTab*>& aTabs) = 0;
     virtual void Receive(TUint aId, const Brx& aMessage) = 0;
     virtual void DestroyTab(TUint aId) = 0;
 };
@@ -337,6 +380,8 @@ public:
 public: // from ITabManager
     TUint CreateTab(ITabCreator& aTabCreator, const std::vector<char*>& aLanguageList) override;
     void LongPoll(TUint aId, IWriter& aWriter) override;    // THROWS WriterError.
+    void StreamStart(const std::vector<TUint>& aIds, ITabPushObserver& aObserver, std::vector<IFrameworkTab*>& aTabs) override;
+    void StreamEnd(const std::vector<IFrameworkTab*>& aTabs) override;
     void Receive(TUint aId, const Brx& aMessage) override;
     void DestroyTab(TUint aId) override;    // Must be called to tell this to remove its reference to a tab.
 public: // from ITabDestroyHandler
@@ -372,12 +417,16 @@ public:
 public: // from ITabManager
     TUint CreateTab(ITabCreator& aTabCreator, const std::vector<char*>& aLanguageList) override;
     void LongPoll(TUint aId, IWriter& aWriter) override;    // THROWS WriterError.
+    void StreamStart(const std::vector<TUint>& aIds, ITabPushObserver& aObserver, std::vector<IFrameworkTab*>& aTabs) override; // Tabs can't time out while streamed.
+    void StreamEnd(const std::vector<IFrameworkTab*>& aTabs) override;
     void Receive(TUint aId, const Brx& aMessage) override;
     void DestroyTab(TUint aId) override;    // Must be called to tell this to remove its reference to a tab.
 private: // from ITabTimeoutObserver
     void TabTimedOut(TUint aId) override;
 private:
     void DestroyTab(TUint aId, TBool aCancelTimeout);
+    void CancelTimeout(TUint aId);
+    void StartTimeout(TUint aId);
 private:
     TabManager iTabManager;
     std::vector<Timeout*> iTimeoutsActive;
@@ -428,6 +477,7 @@ private:
 };
 
 class HttpSession;
+class TabEventDispatcher;
 
 class WebAppFrameworkInitParams
 {
@@ -529,6 +579,7 @@ private:
     TUint iAdapterListenerId;
     SocketTcpServer* iServer;
     TabManagerTimed* iTabManager; // One tab manager for all tabs. All tabs must have same poll interval timeout.
+    TabEventDispatcher* iEventDispatcher;
     WebAppMap iWebApps;
     std::vector<std::reference_wrapper<HttpSession>> iSessions;
     IWebApp* iDefaultApp;
@@ -555,10 +606,18 @@ class WriterHttpResponseContentLengthUnknown : public IWriter
 public:
     WriterHttpResponseContentLengthUnknown(IWriter& aWriter);
     void WriteHeader(Http::EVersion aVersion, HttpStatus aStatus, const Brx& aContentType);
+    // Headers for a cacheable resource.  aETag and aContentEncoding are omitted if empty.
+    void WriteHeader(Http::EVersion aVersion, HttpStatus aStatus, const Brx& aContentType, const Brx& aETag, const Brx& aContentEncoding);
+    // 304 (Not Modified) response.  Has no body so only WriteFlush() should follow.
+    void WriteHeaderNotModified(Http::EVersion aVersion, const Brx& aETag);
 public: // from IWriter
     void Write(TByte aValue) override;
     void Write(const Brx& aBuffer) override;
     void WriteFlush() override;
+private:
+    void WriteStatus(Http::EVersion aVersion, HttpStatus aStatus, const Brx& aContentType);
+    void WriteCacheHeaders(const Brx& aETag);
+    void WriteTransferEncoding(Http::EVersion aVersion);
 private:
     IWriter& iWriter;
     WriterHttpResponse iWriterResponse;
@@ -608,9 +667,140 @@ private:
     TBool iStarted;
 };
 
+/*
+ * Writes the body of a long-lived response, such as a text/event-stream.
+ *
+ * Unlike WriterHttpChunked, WriteFlush() sends any buffered data as a chunk without terminating the response, so the response can remain open for as long as the client wishes.
+ */
+class WriterStreamChunked : public IWriter
+{
+    static const TUint kMaxBufferBytes = 1024;
+public:
+    WriterStreamChunked(IWriter& aWriter);
+    void SetChunked(TBool aChunked);
+public: // from IWriter
+    void Write(TByte aValue) override;
+    void Write(const Brx& aBuffer) override;
+    void WriteFlush() override;
+private:
+    void WriteChunk(const Brx& aBuffer);
+private:
+    IWriter& iWriter;
+    Bws<kMaxBufferBytes> iBuf;
+    TBool iChunked;
+};
+
+/*
+ * Server end of a single "lpstream" connection, carrying msgs for one or more tabs as Server-Sent Events.
+ *
+ * Each event carries every msg queued for a tab when it was written, as:
+ *     data: {"session-id": <id>, "messages": [<msg>,<msg>,...]}
+ *
+ * Only written to by TabEventDispatcher, between a successful call to TabEventDispatcher::TryAdd() and a call to TabEventDispatcher::Remove().
+ * The response header is written by the first write, so a client refused a stream can still be sent an error response instead.
+ */
+class TabEventStream : private IWriter, private INonCopyable
+{
+public:
+    TabEventStream(WriterHttpResponseContentLengthUnknown& aWriterResponse, IWriter& aWriter, IReader& aReader);
+    void Set(const std::vector<IFrameworkTab*>& aTabs, Http::EVersion aVersion);
+    void Clear();
+    void SetStartTime(TUint aTimeMs);
+    TUint StartTime() const;
+    void WriteEvents();     // THROWS WriterError.
+    void WriteKeepAlive();  // THROWS WriterError.
+    void Close();           // Unblocks the session reading from the client and any write in progress.  No further events can be written.
+private: // from IWriter
+    void Write(TByte aValue) override;
+    void Write(const Brx& aBuffer) override;
+    void WriteFlush() override;
+private:
+    void WriteHeaderIfNotWritten();
+    void StartEventIfNotStarted();
+private:
+    WriterHttpResponseContentLengthUnknown& iWriterResponse;
+    WriterStreamChunked iWriter;
+    IReader& iReader;
+    std::vector<IFrameworkTab*> iTabs;
+    IFrameworkTab* iTab;    // Tab currently being written.
+    Http::EVersion iVersion;
+    TUint iStartTimeMs;
+    TBool iHeaderWritten;
+    TBool iEventStarted;
+};
+
+/*
+ * Single thread that writes msgs for all streamed tabs.
+ *
+ * Wakes whenever any streamed tab has msgs queued.  On each wake, every msg that is queued for a tab is written as a single event, and all the events for a stream are written to its socket together.  Msgs queued while a stream is being written are picked up on the next wake, so the more frequently tabs are updated, the larger the batches become.
+ *
+ * A keep-alive comment is written to every stream if no tab has been updated for kKeepAliveMs, so that connections the client has lost are eventually noticed.
+ *
+ * Each stream occupies an HttpSession, and so a server thread, for as long as it is open.  ohNet's SocketTcpServer closes a session's socket when its thread returns, so streams can't be handed to this thread to serve alone.  Streaming therefore saves a request per update but not a thread per tab.  No more than aMaxStreams may be open at once, and streams are closed after kMaxStreamDurationMs.  Clients long poll while they are unable to stream.
+ *
+ * Streams are written without iLock held, so Add()/Remove() and MessagesPending() never wait on a client.  A stream whose write takes longer than kWriteTimeoutMs is closed.
+ */
+class TabEventDispatcher : public ITabPushObserver, private INonCopyable
+{
+    static const TUint kKeepAliveMs = 15 * 1000;
+    static const TUint kWriteTimeoutMs = 5 * 1000;
+    static const TUint kMaxStreamDurationMs = 60 * 1000;
+public:
+    TabEventDispatcher(Environment& aEnv, TUint aMaxStreams);
+    ~TabEventDispatcher();
+    TBool TryAdd(TabEventStream& aStream);  // Returns false if aMaxStreams streams are already open.
+    void Remove(TabEventStream& aStream);   // aStream won't be written to once this returns.
+private: // from ITabPushObserver
+    void MessagesPending() override;
+private:
+    void Run();
+    void Write(TBool aKeepAlive);
+    TBool TryStartWrite(TabEventStream& aStream);
+    void EndWrite();
+    void WriteTimeout();
+private:
+    Environment& iEnv;
+    const TUint iMaxStreams;
+    Mutex iLock;
+    Semaphore iSem;
+    Semaphore iSemWriteEnded;
+    std::vector<TabEventStream*> iStreams;
+    std::vector<TabEventStream*> iStreamsWrite;  // Copy of iStreams taken at the start of each pass.  Only accessed by iThread.
+    TabEventStream* iStreamWriting;
+    TUint iWriteStartMs;
+    TBool iRemovePending;   // Remove() is waiting for iStreamWriting to end its write.
+    std::atomic<TBool> iQuit;
+    TUint iLastKeepAliveMs;
+    Timer iTimerWrite;
+    ThreadFunctor* iThread;
+};
+
+class HeaderIfNoneMatch : public HttpHeader
+{
+    static const TUint kMaxValueBytes = 512;
+public:
+    TBool Matches(const Brx& aETag) const;  // weak comparison, as required for If-None-Match
+private: // from HttpHeader
+    TBool Recognise(const Brx& aHeader) override;
+    void Process(const Brx& aValue) override;
+private:
+    Bws<kMaxValueBytes> iValue;
+};
+
+class HeaderAcceptEncoding : public HttpHeader
+{
+public:
+    TUint Encodings() const;    // ResourceEncoding flags
+private: // from HttpHeader
+    TBool Recognise(const Brx& aHeader) override;
+    void Process(const Brx& aValue) override;
+private:
+    TUint iEncodings;
+};
+
 /**
  * HttpSession that handles serving files (via GET), processing POST requests
- * and allows long polling.
+ * and allows long polling or streaming of tab msgs.
  */
 class HttpSession : public SocketTcpSession
 {
@@ -621,8 +811,9 @@ private:
     static const TUint kPollTimeoutMs = 5 * 1000;
     static const TUint kPollPeriodTimeoutMs = 5*1000;
     static const TUint kModerationTimeMs = 10;  // Time to delay before servicing request, to limit effect of misbehaving clients (or other bad actors) that may be hammering server.
+    static const TUint kMaxStreamTabs = 64;
 public:
-    HttpSession(Environment& aEnv, IWebAppManager& aAppManager, ITabManager& aTabManager, IResourceManager& aResourceManager);
+    HttpSession(Environment& aEnv, IWebAppManager& aAppManager, ITabManager& aTabManager, IResourceManager& aResourceManager, TabEventDispatcher& aEventDispatcher);
     ~HttpSession();
     // Will return 503 (Service Unavailable) to all requests until StartSession() is called.
     void StartSession();    // Avoid clash with SocketTcpSession::Start().
@@ -631,11 +822,14 @@ private: // from SocketTcpSession
 private:
     void Error(const HttpStatus& aStatus);
     void Get();
+    TBool TryStream(const Brx& aUri);
+    void Stream(Http::EVersion aVersion);
     void Post();
 private:
     IWebAppManager& iAppManager;
     ITabManager& iTabManager;
     IResourceManager& iResourceManager;
+    TabEventDispatcher& iEventDispatcher;
     Srx* iReadBuffer;
     ReaderUntil* iReaderUntilPreChunker;
     ReaderHttpRequest* iReaderRequest;
@@ -644,10 +838,15 @@ private:
     Sws<kMaxResponseBytes>* iWriterBuffer;
     WriterHttpResponseContentLengthUnknown* iWriterResponse;
     WriterLongPollResponse* iWriterResponseLongPoll;
+    TabEventStream* iEventStream;
+    std::vector<TUint> iStreamIds;
+    std::vector<IFrameworkTab*> iStreamTabs;
     HttpHeaderHost iHeaderHost;
     HttpHeaderTransferEncoding iHeaderTransferEncoding;
     HttpHeaderConnection iHeaderConnection;
     Net::HeaderAcceptLanguage iHeaderAcceptLanguage;
+    HeaderIfNoneMatch iHeaderIfNoneMatch;
+    HeaderAcceptEncoding iHeaderAcceptEncoding;
     const HttpStatus* iErrorStatus;
     TBool iResponseStarted;
     TBool iResponseEnded;